@@ -0,0 +1,486 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    struct Entry
+    {
+        std::string               Name;
+        BenchmarkThreading::EType Threading;
+        BenchmarkFunction         Function;
+    };
+
+    struct Options
+    {
+        std::string           Filter;
+        std::vector<uint32_t> ThreadCounts;
+        double                MinTime = 0.5;
+        std::string           JsonFile;
+    };
+
+    // One benchmark at one thread count, over the final run's iterations.
+    struct Result
+    {
+        std::string Name;
+        uint32_t    ThreadCount;
+        uint64_t    Iterations;
+        double      Seconds;        // Wall time of the timed sections
+        double      BytesPerSecond;
+        std::vector<std::pair<std::string, double>> Rates; // Counters per second
+        std::string Error;
+    };
+
+    // Further runs stop at this many iterations, however short each one is.
+    const uint64_t c_maxIterations = 1000000000;
+
+    std::vector<Entry>& GetRegistry()
+    {
+        static std::vector<Entry> registry;
+        return registry;
+    }
+
+    std::vector<uint32_t> GetDefaultThreadCounts()
+    {
+        const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+        std::vector<uint32_t> counts;
+        for (uint32_t count = 1; count < cores; count *= 2)
+        {
+            counts.push_back(count);
+        }
+        counts.push_back(cores);
+
+        return counts;
+    }
+
+    bool ParseThreadCounts(const char* text, std::vector<uint32_t>& counts)
+    {
+        counts.clear();
+
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            const unsigned long count = std::strtoul(item.c_str(), nullptr, 10);
+            if (count == 0 || count > 1024)
+                return false;
+
+            counts.push_back(static_cast<uint32_t>(count));
+        }
+
+        return !counts.empty();
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        options.ThreadCounts = GetDefaultThreadCounts();
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+            if (arg == "--filter" && value != nullptr)
+            {
+                options.Filter = value;
+            }
+            else if (arg == "--threads" && value != nullptr)
+            {
+                if (!ParseThreadCounts(value, options.ThreadCounts))
+                {
+                    std::cerr << "Invalid thread counts: " << value << "\n";
+                    return false;
+                }
+            }
+            else if (arg == "--min-time" && value != nullptr)
+            {
+                options.MinTime = std::atof(value);
+                if (!(options.MinTime > 0.0))
+                {
+                    std::cerr << "Invalid minimum time: " << value << "\n";
+                    return false;
+                }
+            }
+            else if (arg == "--json" && value != nullptr)
+            {
+                options.JsonFile = value;
+            }
+            else
+            {
+                std::cerr << "Unknown option " << arg << "\n"
+                    << "Usage: " << argv[0] << " [--filter text] [--threads n,...] [--min-time seconds] [--json file]\n";
+                return false;
+            }
+
+            ++i;
+        }
+
+        return true;
+    }
+
+    Result Run(const Entry& entry, uint32_t threadCount, uint64_t iterations)
+    {
+        Result result = {};
+        result.Name = entry.Name + "/threads:" + std::to_string(threadCount);
+        result.ThreadCount = threadCount;
+        result.Iterations = iterations;
+
+        std::vector<BenchmarkState> states;
+        if (entry.Threading == BenchmarkThreading::Internal)
+        {
+            states.emplace_back(iterations, threadCount, 0);
+            entry.Function(states[0]);
+        }
+        else
+        {
+            for (uint32_t t = 0; t < threadCount; ++t)
+            {
+                states.emplace_back(iterations, threadCount, t);
+            }
+
+            // Threads start their timed sections together, once every one of them is running.
+            std::atomic<uint32_t> ready(0);
+            auto worker = [&](uint32_t t)
+            {
+                ++ready;
+                while (ready.load() < threadCount)
+                {
+                    std::this_thread::yield();
+                }
+
+                entry.Function(states[t]);
+            };
+
+            std::vector<std::thread> threads;
+            for (uint32_t t = 1; t < threadCount; ++t)
+            {
+                threads.emplace_back(worker, t);
+            }
+
+            worker(0);
+
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // The slowest thread bounds the run; the threads' work adds up.
+        double bytes = 0.0;
+        for (const BenchmarkState& state : states)
+        {
+            if (!state.GetError().empty())
+            {
+                result.Error = state.GetError();
+                return result;
+            }
+
+            result.Seconds = std::max(result.Seconds, state.GetElapsedSeconds());
+            bytes += double(state.GetBytesPerIteration()) * iterations;
+
+            for (const auto& counter : state.GetCounters())
+            {
+                auto it = std::find_if(result.Rates.begin(), result.Rates.end(), [&](const std::pair<std::string, double>& rate) { return rate.first == counter.first; });
+                if (it == result.Rates.end())
+                {
+                    it = result.Rates.insert(result.Rates.end(), std::make_pair(counter.first, 0.0));
+                }
+                it->second += counter.second * iterations;
+            }
+        }
+
+        const double seconds = std::max(result.Seconds, 1e-9);
+        result.BytesPerSecond = bytes / seconds;
+        for (auto& rate : result.Rates)
+        {
+            rate.second /= seconds;
+        }
+
+        return result;
+    }
+
+    // Grows the iteration count until a run is timed for at least the minimum duration, as
+    // Google Benchmark does: by the predicted factor once a run is long enough to predict from.
+    Result RunFor(const Entry& entry, uint32_t threadCount, double minTime)
+    {
+        uint64_t iterations = 1;
+        for (;;)
+        {
+            Result result = Run(entry, threadCount, iterations);
+            if (!result.Error.empty() || result.Seconds >= minTime || iterations >= c_maxIterations)
+                return result;
+
+            double multiplier = 10.0;
+            if (result.Seconds > minTime * 0.1)
+            {
+                multiplier = std::min(multiplier, minTime * 1.4 / result.Seconds);
+            }
+
+            iterations = std::min(c_maxIterations, std::max(iterations + 1, static_cast<uint64_t>(iterations * multiplier)));
+        }
+    }
+
+    std::string FormatRate(double perSecond)
+    {
+        const char* units[] = { "", "k", "M", "G", "T" };
+
+        uint32_t unit = 0;
+        while (perSecond >= 1000.0 && unit + 1 < sizeof(units) / sizeof(units[0]))
+        {
+            perSecond /= 1000.0;
+            ++unit;
+        }
+
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(perSecond < 10.0 ? 2 : 1) << perSecond << units[unit];
+        return text.str();
+    }
+
+    void PrintResult(const Result& result)
+    {
+        std::cout << std::left << std::setw(48) << result.Name << std::right;
+
+        if (!result.Error.empty())
+        {
+            std::cout << " ERROR: " << result.Error << std::endl;
+            return;
+        }
+
+        const double nanoseconds = result.Seconds * 1e9 / result.Iterations;
+        std::cout << std::setw(14) << std::fixed << std::setprecision(0) << nanoseconds << " ns"
+            << std::setw(12) << result.Iterations;
+
+        if (result.BytesPerSecond > 0.0)
+        {
+            std::cout << "  " << std::setprecision(1) << result.BytesPerSecond / 1e6 << " MB/s";
+        }
+
+        for (const auto& rate : result.Rates)
+        {
+            std::cout << "  " << FormatRate(rate.second) << " " << rate.first << "/s";
+        }
+
+        std::cout << std::endl;
+    }
+
+    std::string EscapeJson(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", c);
+                escaped += code;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    bool WriteJson(const std::string& filename, const char* executable, const std::vector<Result>& results)
+    {
+        std::ofstream file(filename);
+        if (!file)
+            return false;
+
+        char date[32] = {};
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        file << std::setprecision(17);
+        file << "{\n"
+            << "  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"executable\": \"" << EscapeJson(executable) << "\",\n"
+            << "    \"num_cpus\": " << std::max(1u, std::thread::hardware_concurrency()) << ",\n"
+#ifdef NDEBUG
+            << "    \"library_build_type\": \"release\"\n"
+#else
+            << "    \"library_build_type\": \"debug\"\n"
+#endif
+            << "  },\n"
+            << "  \"benchmarks\": [";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& result = results[i];
+
+            file << (i == 0 ? "\n" : ",\n")
+                << "    {\n"
+                << "      \"name\": \"" << EscapeJson(result.Name) << "\",\n"
+                << "      \"run_name\": \"" << EscapeJson(result.Name) << "\",\n"
+                << "      \"run_type\": \"iteration\",\n"
+                << "      \"threads\": " << result.ThreadCount << ",\n"
+                << "      \"iterations\": " << result.Iterations << ",\n";
+
+            if (!result.Error.empty())
+            {
+                file << "      \"error_occurred\": true,\n"
+                    << "      \"error_message\": \"" << EscapeJson(result.Error) << "\"\n"
+                    << "    }";
+                continue;
+            }
+
+            const double nanoseconds = result.Seconds * 1e9 / result.Iterations;
+            file << "      \"real_time\": " << nanoseconds << ",\n"
+                << "      \"cpu_time\": " << nanoseconds << ",\n"
+                << "      \"time_unit\": \"ns\"";
+
+            if (result.BytesPerSecond > 0.0)
+            {
+                file << ",\n      \"bytes_per_second\": " << result.BytesPerSecond;
+            }
+
+            for (const auto& rate : result.Rates)
+            {
+                file << ",\n      \"" << EscapeJson(rate.first) << "_per_second\": " << rate.second;
+            }
+
+            file << "\n    }";
+        }
+
+        file << "\n  ]\n}\n";
+        return file.good();
+    }
+}
+
+BenchmarkState::BenchmarkState(uint64_t iterations, uint32_t threadCount, uint32_t threadIndex) :
+    m_iterations(iterations),
+    m_remaining(iterations),
+    m_threadCount(threadCount),
+    m_threadIndex(threadIndex),
+    m_running(false),
+    m_elapsed(0.0),
+    m_bytesPerIteration(0)
+{ }
+
+bool BenchmarkState::KeepRunning()
+{
+    if (!m_running && m_remaining == m_iterations && m_error.empty())
+    {
+        m_running = true;
+        m_start = Clock::now();
+    }
+
+    if (m_remaining > 0 && m_error.empty())
+    {
+        --m_remaining;
+        return true;
+    }
+
+    PauseTiming();
+    return false;
+}
+
+void BenchmarkState::PauseTiming()
+{
+    if (m_running)
+    {
+        m_elapsed += Clock::now() - m_start;
+        m_running = false;
+    }
+}
+
+void BenchmarkState::ResumeTiming()
+{
+    if (!m_running)
+    {
+        m_running = true;
+        m_start = Clock::now();
+    }
+}
+
+void BenchmarkState::SetCounter(const char* name, double perIteration)
+{
+    for (auto& counter : m_counters)
+    {
+        if (counter.first == name)
+        {
+            counter.second = perIteration;
+            return;
+        }
+    }
+
+    m_counters.emplace_back(name, perIteration);
+}
+
+void BenchmarkState::SkipWithError(const std::string& message)
+{
+    m_error = message;
+    m_remaining = 0;
+}
+
+void UseBenchmarkResult(const volatile void* /*value*/)
+{
+}
+
+void RegisterBenchmark(const std::string& name, BenchmarkThreading::EType threading, BenchmarkFunction function)
+{
+    GetRegistry().push_back(Entry { name, threading, std::move(function) });
+}
+
+int RunBenchmarks(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 2;
+
+    std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+        << std::setw(17) << "Time" << std::setw(12) << "Iterations" << "  Throughput" << std::endl;
+
+    std::vector<Result> results;
+    bool failed = false;
+
+    for (const Entry& entry : GetRegistry())
+    {
+        if (entry.Name.find(options.Filter) == std::string::npos)
+            continue;
+
+        for (uint32_t threadCount : options.ThreadCounts)
+        {
+            results.push_back(RunFor(entry, threadCount, options.MinTime));
+            PrintResult(results.back());
+
+            failed = failed || !results.back().Error.empty();
+        }
+    }
+
+    if (!options.JsonFile.empty() && !WriteJson(options.JsonFile, argv[0], results))
+    {
+        std::cerr << "Failed to write " << options.JsonFile << "\n";
+        return 1;
+    }
+
+    return failed ? 1 : 0;
+}
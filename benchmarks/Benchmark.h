@@ -0,0 +1,104 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A minimal harness in the manner of Google Benchmark, which this repo can't fetch: each
+// benchmark runs for more iterations until it has been timed for a minimum duration, and
+// reports the work its iterations did as rates. Results print as a table and can be written
+// as JSON in Google Benchmark's layout, so its compare.py can diff two runs.
+
+struct BenchmarkThreading
+{
+    enum EType : uint32_t
+    {
+        Replicated, // Each of the thread count's threads runs the benchmark; work adds up
+        Internal,   // One thread runs the benchmark, which spreads its work over the thread count
+    };
+};
+
+class BenchmarkState
+{
+public:
+    BenchmarkState(uint64_t iterations, uint32_t threadCount, uint32_t threadIndex);
+
+    // Loop condition of the timed section: returns true until the run's iterations are done.
+    // Time before the first call and after the last isn't counted.
+    bool KeepRunning();
+
+    // Excludes per-iteration setup from the timing.
+    void PauseTiming();
+    void ResumeTiming();
+
+    uint32_t GetThreadCount() const { return m_threadCount; }
+    uint32_t GetThreadIndex() const { return m_threadIndex; }
+
+    // Work done by each iteration, reported per second as MB/s and as counters/s.
+    void SetBytesPerIteration(uint64_t bytes) { m_bytesPerIteration = bytes; }
+    void SetCounter(const char* name, double perIteration);
+
+    // Stops the benchmark and reports 'message' in place of its results.
+    void SkipWithError(const std::string& message);
+
+    // Results of the run.
+    uint64_t GetIterations() const { return m_iterations; }
+    double GetElapsedSeconds() const { return m_elapsed.count(); }
+    uint64_t GetBytesPerIteration() const { return m_bytesPerIteration; }
+    const std::vector<std::pair<std::string, double>>& GetCounters() const { return m_counters; }
+    const std::string& GetError() const { return m_error; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t m_iterations;
+    uint64_t m_remaining;
+    uint32_t m_threadCount;
+    uint32_t m_threadIndex;
+    bool     m_running;
+
+    Clock::time_point                     m_start;
+    std::chrono::duration<double>         m_elapsed;
+
+    uint64_t                                    m_bytesPerIteration;
+    std::vector<std::pair<std::string, double>> m_counters;
+    std::string                                 m_error;
+};
+
+using BenchmarkFunction = std::function<void(BenchmarkState&)>;
+
+void RegisterBenchmark(const std::string& name, BenchmarkThreading::EType threading, BenchmarkFunction function);
+
+// Runs the registered benchmarks under the options in argv:
+//   --filter <text>     only benchmarks whose name contains text
+//   --threads <n,...>   thread counts to run each benchmark at (default: 1, 2, 4... up to every core)
+//   --min-time <s>      minimum timed seconds per result (default 0.5)
+//   --json <file>       also write the results as JSON
+// Returns the process exit code: nonzero when an option is invalid or a benchmark failed.
+int RunBenchmarks(int argc, char** argv);
+
+// Takes the address of a result out of the optimizer's sight; see DoNotOptimize().
+void UseBenchmarkResult(const volatile void* value);
+
+// Keeps the compiler from optimizing away a result the benchmark doesn't otherwise use.
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+    UseBenchmarkResult(&value);
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
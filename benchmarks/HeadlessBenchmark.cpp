@@ -0,0 +1,411 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "CameraPath.h"
+#include "FixedFunctionContext.h"
+#include "FrameTimeLog.h"
+#include "MeshShaderExecutor.h"
+#include "Model.h"
+#include "NullRhi.h"
+#include "PrimitiveCulling.h"
+#include "RhiDrawTarget.h"
+#include "StepTimer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace DirectX;
+
+// Renders a fixed number of frames of a model along a camera path with no window and no
+// device, and writes each frame's times as CSV. The simulation clock advances one fixed step
+// per frame, so every run sees the same camera at the same frame whatever the frame rate.
+//
+// CPU time is the frame's recording: draws translated through the fixed-function context onto
+// a null RHI command list, then submitted. GPU time is the frame's mesh shader work run on
+// the CPU executor, which stands in for the device.
+namespace
+{
+    const uint32_t c_frameCount = 2;                 // Frames in flight, as the renderer has
+    const uint32_t c_viewportWidth = 1920;
+    const uint32_t c_viewportHeight = 1080;
+    const uint32_t c_descriptorsPerFrame = 256;
+    const uint32_t c_drawRecordBytesPerFrame = 64 * 1024;
+    const uint32_t c_constantBufferSize = 256;       // One aligned constant buffer per frame
+    const uint32_t c_sceneConstantsRootIndex = 0;
+
+    struct Options
+    {
+        std::string  ModelPath = "Assets/Dragon_LOD1.bin";
+        std::string  CameraPath;
+        std::string  CsvPath = "frametimes.csv";
+        uint32_t     FrameCount = 600;
+        double       StepSeconds = 1.0 / 60.0;
+        uint32_t     ThreadCount = 0;
+    };
+
+    // A mesh drawn each frame: its buffers on the null device, the views the draw binds, and
+    // the commands the executor runs, which don't change from frame to frame.
+    struct MeshDraw
+    {
+        VertexLayout                              Layout;
+        std::vector<std::unique_ptr<RhiBuffer>>   VertexBuffers;
+        std::unique_ptr<RhiBuffer>                IndexBuffer;
+        D3D12_VERTEX_BUFFER_VIEW                  VertexBufferViews[c_maxVertexSlots];
+        uint32_t                                  VertexBufferCount;
+        D3D12_INDEX_BUFFER_VIEW                   IndexBufferView;
+        uint32_t                                  IndexCount;
+        MeshShaderExecutor                        Executor;
+        std::vector<RecordingDrawTarget::Command> Commands;
+    };
+
+    // Paths are passed through byte for byte, which is enough for ASCII ones.
+    std::wstring Widen(const std::string& text)
+    {
+        std::wstring wide;
+        for (char c : text)
+        {
+            wide += static_cast<wchar_t>(static_cast<unsigned char>(c));
+        }
+        return wide;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const bool hasValue = i + 1 < argc;
+
+            if (strcmp(argv[i], "--model") == 0 && hasValue)
+            {
+                options.ModelPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--camera") == 0 && hasValue)
+            {
+                options.CameraPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--csv") == 0 && hasValue)
+            {
+                options.CsvPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+            {
+                options.FrameCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+            else if (strcmp(argv[i], "--step") == 0 && hasValue)
+            {
+                options.StepSeconds = atof(argv[++i]);
+            }
+            else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+            {
+                options.ThreadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+            else
+            {
+                std::cerr << "Unknown option " << argv[i] << ".\n"
+                    << "Usage: MeshHeadless [--model <file>] [--camera <path file>] [--frames <n>] [--step <seconds>]\n"
+                    << "                    [--threads <n>] [--csv <file>]\n";
+                return false;
+            }
+        }
+
+        if (options.FrameCount == 0 || !(options.StepSeconds > 0.0))
+        {
+            std::cerr << "--frames and --step must be positive.\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    // Without a path file the camera circles the model once every ten seconds.
+    void BuildOrbit(const BoundingSphere& bounds, CameraPath& path)
+    {
+        const uint32_t keyCount = 9;
+        const float distance = bounds.Radius * 2.5f;
+
+        std::vector<CameraKey> keys(keyCount);
+        for (uint32_t i = 0; i < keyCount; ++i)
+        {
+            const float angle = XM_2PI * i / (keyCount - 1);
+
+            keys[i].Time = 10.0f * i / (keyCount - 1);
+            keys[i].Position = XMFLOAT3(
+                bounds.Center.x + distance * XMScalarSin(angle),
+                bounds.Center.y + bounds.Radius * 0.5f,
+                bounds.Center.z + distance * XMScalarCos(angle));
+            keys[i].Target = bounds.Center;
+            keys[i].FovY = XM_PI / 3.0f;
+        }
+
+        path.SetKeys(keys);
+    }
+
+    HRESULT CreateUploadBuffer(RhiDevice& device, const void* data, uint64_t size, std::unique_ptr<RhiBuffer>& buffer)
+    {
+        const RhiBufferDesc desc = { size, RhiHeapType::Upload, RhiBufferState::GenericRead, false };
+
+        HRESULT hr = device.CreateBuffer(desc, buffer);
+        if (FAILED(hr))
+            return hr;
+
+        memcpy(buffer->Map(), data, static_cast<size_t>(size));
+        return S_OK;
+    }
+
+    HRESULT CreateMeshDraw(RhiDevice& device, const Mesh& mesh, MeshDraw& draw)
+    {
+        const uint32_t slotCount = static_cast<uint32_t>(mesh.Vertices.size());
+        if (slotCount > c_maxVertexSlots)
+            return E_INVALIDARG;
+
+        HRESULT hr = ResolveInputLayout(mesh.LayoutDesc, mesh.VertexStrides.data(), slotCount, draw.Layout);
+        if (FAILED(hr))
+            return hr;
+
+        memset(draw.VertexBufferViews, 0, sizeof(draw.VertexBufferViews));
+        draw.VertexBufferCount = slotCount;
+        draw.VertexBuffers.resize(slotCount);
+
+        draw.Executor.SetVertexLayout(draw.Layout);
+
+        for (uint32_t slot = 0; slot < slotCount; ++slot)
+        {
+            hr = CreateUploadBuffer(device, mesh.Vertices[slot].data(), mesh.Vertices[slot].size(), draw.VertexBuffers[slot]);
+            if (FAILED(hr))
+                return hr;
+
+            RhiBuffer* buffer = draw.VertexBuffers[slot].get();
+            draw.VertexBufferViews[slot].BufferLocation = buffer->GetGpuAddress();
+            draw.VertexBufferViews[slot].SizeInBytes = static_cast<uint32_t>(buffer->GetSize());
+            draw.VertexBufferViews[slot].StrideInBytes = mesh.VertexStrides[slot];
+
+            draw.Executor.RegisterBuffer(buffer->GetGpuAddress(), buffer->GetSize(), buffer->Map());
+        }
+
+        hr = CreateUploadBuffer(device, mesh.Indices.data(), mesh.Indices.size(), draw.IndexBuffer);
+        if (FAILED(hr))
+            return hr;
+
+        draw.IndexBufferView.BufferLocation = draw.IndexBuffer->GetGpuAddress();
+        draw.IndexBufferView.SizeInBytes = static_cast<uint32_t>(draw.IndexBuffer->GetSize());
+        draw.IndexBufferView.Format = mesh.IndexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+        draw.IndexCount = mesh.IndexCount;
+
+        draw.Executor.RegisterBuffer(draw.IndexBuffer->GetGpuAddress(), draw.IndexBuffer->GetSize(), draw.IndexBuffer->Map());
+
+        return S_OK;
+    }
+
+    // Issues the mesh's draw as the renderer would, onto whichever target is recording.
+    void DrawMesh(const MeshDraw& draw, MeshDrawTarget& target)
+    {
+        FixedFunctionContext context(target);
+        context.SetVertexLayout(draw.Layout);
+        context.IASetVertexBuffers(0, draw.VertexBufferCount, draw.VertexBufferViews);
+        context.IASetIndexBuffer(&draw.IndexBufferView);
+        context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        context.DrawIndexedInstanced(draw.IndexCount, 1, 0, 0, 0);
+    }
+
+    double ToMilliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    void PrintStats(const char* name, const FrameTimeStats& stats)
+    {
+        char line[160];
+        snprintf(line, sizeof(line), "%-4s min %8.3f  mean %8.3f  p50 %8.3f  p95 %8.3f  p99 %8.3f  max %8.3f ms",
+            name, stats.Min, stats.Mean, stats.P50, stats.P95, stats.P99, stats.Max);
+        std::cout << line << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    Model model;
+    if (FAILED(model.LoadFromFile(Widen(options.ModelPath).c_str())))
+    {
+        std::cerr << "Failed to load the model " << options.ModelPath << ".\n";
+        return 1;
+    }
+
+    CameraPath path;
+    if (options.CameraPath.empty())
+    {
+        BuildOrbit(model.GetBoundingSphere(), path);
+    }
+    else if (FAILED(path.LoadFromFile(Widen(options.CameraPath).c_str())) || path.IsEmpty())
+    {
+        std::cerr << "Failed to load the camera path " << options.CameraPath << ".\n";
+        return 1;
+    }
+
+    NullRhiDevice device(c_frameCount);
+
+    std::vector<std::unique_ptr<MeshDraw>> draws;
+    for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+    {
+        std::unique_ptr<MeshDraw> draw(new MeshDraw());
+        if (FAILED(CreateMeshDraw(device, model.GetMesh(m), *draw)))
+        {
+            std::cerr << "Mesh " << m << " has an input layout the mesh shader can't fetch.\n";
+            return 1;
+        }
+
+        RecordingDrawTarget recording;
+        DrawMesh(*draw, recording);
+        draw->Commands = recording.GetCommands();
+
+        draws.push_back(std::move(draw));
+    }
+
+    // Per-frame slices of the descriptors, packed draw records and scene constants.
+    std::unique_ptr<RhiDescriptorHeap> heap;
+    std::unique_ptr<RhiBuffer> recordBuffer;
+    std::unique_ptr<RhiBuffer> constantBuffer;
+    std::unique_ptr<RhiCommandList> commandLists[c_frameCount];
+    std::unique_ptr<RhiFence> fence;
+
+    const RhiBufferDesc recordDesc = { c_frameCount * c_drawRecordBytesPerFrame, RhiHeapType::Upload, RhiBufferState::GenericRead, false };
+    const RhiBufferDesc constantDesc = { c_frameCount * c_constantBufferSize, RhiHeapType::Upload, RhiBufferState::GenericRead, false };
+
+    if (FAILED(device.CreateDescriptorHeap(c_frameCount * c_descriptorsPerFrame, heap)) ||
+        FAILED(device.CreateBuffer(recordDesc, recordBuffer)) ||
+        FAILED(device.CreateBuffer(constantDesc, constantBuffer)) ||
+        FAILED(device.CreateFence(0, fence)))
+    {
+        std::cerr << "Failed to create the frame resources.\n";
+        return 1;
+    }
+
+    for (auto& commandList : commandLists)
+    {
+        if (FAILED(device.CreateCommandList(commandList)))
+        {
+            std::cerr << "Failed to create the command lists.\n";
+            return 1;
+        }
+    }
+
+    uint8_t* recordData = static_cast<uint8_t*>(recordBuffer->Map());
+    uint8_t* constantData = static_cast<uint8_t*>(constantBuffer->Map());
+    uint64_t fenceValues[c_frameCount] = {};
+    uint64_t nextFenceValue = 1;
+
+    const float aspectRatio = static_cast<float>(c_viewportWidth) / static_cast<float>(c_viewportHeight);
+    const XMFLOAT2 viewportSize(static_cast<float>(c_viewportWidth), static_cast<float>(c_viewportHeight));
+
+    StepTimer timer;
+    timer.SetFixedTimeStep(true);
+    timer.SetTargetElapsedSeconds(options.StepSeconds);
+
+    FrameTimeLog log;
+    log.Reserve(options.FrameCount);
+
+    MeshShaderOutput output;
+    uint64_t triangleCount = 0;
+
+    for (uint32_t frame = 0; frame < options.FrameCount; ++frame)
+    {
+        const uint32_t frameIndex = frame % c_frameCount;
+
+        timer.TickFixed();
+        const double time = timer.GetTotalSeconds();
+
+        const auto cpuStart = std::chrono::steady_clock::now();
+
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, path.GetViewMatrix(time) * path.GetProjectionMatrix(time, aspectRatio));
+
+        // The slot's previous frame must be done with its constants and descriptors.
+        fence->Wait(fenceValues[frameIndex]);
+
+        XMFLOAT4X4 constants;
+        XMStoreFloat4x4(&constants, XMMatrixTranspose(XMLoadFloat4x4(&viewProj)));
+        memcpy(constantData + frameIndex * c_constantBufferSize, &constants, sizeof(constants));
+
+        RhiCommandList* commandList = commandLists[frameIndex].get();
+        commandList->Reset();
+        commandList->SetDescriptorHeap(heap.get());
+        commandList->SetGraphicsRootConstantBufferView(c_sceneConstantsRootIndex, constantBuffer->GetGpuAddress() + frameIndex * c_constantBufferSize);
+
+        {
+            RhiDrawTarget target(
+                commandList,
+                heap.get(), frameIndex * c_descriptorsPerFrame, c_descriptorsPerFrame,
+                recordBuffer.get(), recordData, frameIndex * c_drawRecordBytesPerFrame, c_drawRecordBytesPerFrame);
+
+            for (auto& draw : draws)
+            {
+                for (auto& buffer : draw->VertexBuffers)
+                {
+                    target.RegisterBuffer(buffer.get());
+                }
+                target.RegisterBuffer(draw->IndexBuffer.get());
+            }
+
+            for (auto& draw : draws)
+            {
+                DrawMesh(*draw, target);
+            }
+        }
+
+        commandList->Close();
+        device.GetQueue()->Submit(&commandList, 1);
+
+        fenceValues[frameIndex] = nextFenceValue++;
+        device.GetQueue()->Signal(fence.get(), fenceValues[frameIndex]);
+
+        const auto cpuEnd = std::chrono::steady_clock::now();
+
+        // The device's work for the frame, run on the CPU.
+        output.Clear();
+        for (auto& draw : draws)
+        {
+            draw->Executor.SetConstants(viewProj, viewportSize, PrimitiveCull::All);
+            if (FAILED(draw->Executor.Execute(draw->Commands, output, options.ThreadCount)))
+            {
+                std::cerr << "Mesh shader execution failed at frame " << frame << ".\n";
+                return 1;
+            }
+        }
+
+        const auto gpuEnd = std::chrono::steady_clock::now();
+
+        triangleCount += output.Indices.size() / 3;
+        device.ClearLog();
+
+        log.Record(time, ToMilliseconds(cpuEnd - cpuStart), ToMilliseconds(gpuEnd - cpuEnd));
+    }
+
+    if (FAILED(log.WriteCsv(Widen(options.CsvPath).c_str())))
+    {
+        std::cerr << "Failed to write " << options.CsvPath << ".\n";
+        return 1;
+    }
+
+    std::cout << options.FrameCount << " frames over " << timer.GetTotalSeconds() << " s of camera path, "
+        << triangleCount / options.FrameCount << " visible triangles per frame\n";
+    PrintStats("CPU", log.GetCpuStats());
+    PrintStats("GPU", log.GetGpuStats());
+
+    return 0;
+}
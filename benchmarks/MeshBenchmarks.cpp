@@ -0,0 +1,626 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Benchmark.h"
+#include "DrawPacker.h"
+#include "FixedFunctionContext.h"
+#include "MeshData.h"
+#include "Meshletizer.h"
+#include "MeshShaderExecutor.h"
+#include "Model.h"
+#include "OcclusionCuller.h"
+#include "PrimitiveCulling.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+using namespace DirectX;
+
+// Benchmarks of the CPU-side work of getting a model on screen: loading it, building its
+// meshlets and their cull data, culling and occlusion, packing draws into groups, and the mesh
+// shader itself run on the CPU. Each runs over every model in the assets directory, and
+// reports the rates the work is done at.
+namespace
+{
+    const uint32_t c_viewportWidth = 1920;
+    const uint32_t c_viewportHeight = 1080;
+
+    // A mesh's geometry in the form the meshlet builder and cullers take, and the meshlets
+    // built from it.
+    struct MeshInput
+    {
+        MeshData                    Data;
+        std::vector<XMFLOAT3>       Positions;
+        std::vector<XMFLOAT4>       ClipPositions; // Positions under the asset's view
+        std::vector<Meshlet>        Meshlets;
+        std::vector<uint32_t>       UniqueVertexIndices;
+        std::vector<PackedTriangle> PrimitiveIndices;
+        std::vector<CullData>       CullingData;
+    };
+
+    struct Asset
+    {
+        std::string            Name;
+        std::wstring           Path;
+        uint64_t               FileSize;
+        Model                  Geometry;
+        std::vector<MeshInput> Meshes;
+        uint32_t               TriangleCount;
+        uint32_t               MeshletCount;     // Of the meshlets stored in the file
+        XMFLOAT4X4             ViewProj;         // Row-vector convention, as DirectXMath multiplies
+    };
+
+    std::vector<std::string> ListAssets(const std::string& directory)
+    {
+        std::vector<std::string> names;
+
+#ifdef _WIN32
+        WIN32_FIND_DATAA findData;
+        HANDLE find = FindFirstFileA((directory + "\\*.bin").c_str(), &findData);
+        if (find != INVALID_HANDLE_VALUE)
+        {
+            do
+            {
+                names.push_back(findData.cFileName);
+            } while (FindNextFileA(find, &findData));
+
+            FindClose(find);
+        }
+#else
+        if (DIR* dir = opendir(directory.c_str()))
+        {
+            while (dirent* entry = readdir(dir))
+            {
+                const std::string name = entry->d_name;
+                if (name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0)
+                {
+                    names.push_back(name);
+                }
+            }
+
+            closedir(dir);
+        }
+#endif
+
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    // Views the model from outside its bounds, near enough that part of it falls outside the
+    // frustum, so the cullers see a mix of visible and rejected work.
+    XMFLOAT4X4 GetAssetViewProj(const Model& model)
+    {
+        const BoundingSphere& bounds = model.GetBoundingSphere();
+        const float radius = std::max(bounds.Radius, 1e-3f);
+
+        const XMVECTOR center = XMLoadFloat3(&bounds.Center);
+        const XMVECTOR eye = XMVectorAdd(center, XMVectorSet(radius * 0.5f, radius * 0.25f, radius * 1.5f, 0.0f));
+
+        const XMMATRIX view = XMMatrixLookAtRH(eye, center, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        const XMMATRIX proj = XMMatrixPerspectiveFovRH(XM_PI / 3.0f, float(c_viewportWidth) / c_viewportHeight, radius * 0.01f, radius * 10.0f);
+
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, XMMatrixMultiply(view, proj));
+        return viewProj;
+    }
+
+    bool LoadAsset(const std::string& directory, const std::string& name, Asset& asset)
+    {
+        const std::string path = directory + "/" + name;
+
+        asset.Name = name;
+        asset.Path.assign(path.begin(), path.end());
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        asset.FileSize = file ? static_cast<uint64_t>(file.tellg()) : 0;
+
+        if (FAILED(asset.Geometry.LoadFromFile(asset.Path.c_str())))
+            return false;
+
+        asset.ViewProj = GetAssetViewProj(asset.Geometry);
+        const XMMATRIX viewProj = XMLoadFloat4x4(&asset.ViewProj);
+
+        asset.TriangleCount = 0;
+        asset.MeshletCount = 0;
+        asset.Meshes.resize(asset.Geometry.GetMeshCount());
+
+        for (uint32_t m = 0; m < asset.Geometry.GetMeshCount(); ++m)
+        {
+            const Mesh& mesh = asset.Geometry.GetMesh(m);
+            MeshInput& input = asset.Meshes[m];
+
+            ExtractMeshData(mesh, input.Data);
+
+            input.Positions.resize(input.Data.VertexCount);
+            input.ClipPositions.resize(input.Data.VertexCount);
+            for (uint32_t v = 0; v < input.Data.VertexCount; ++v)
+            {
+                input.Positions[v] = input.Data.GetPosition(v);
+                XMStoreFloat4(&input.ClipPositions[v], XMVector3Transform(XMLoadFloat3(&input.Positions[v]), viewProj));
+            }
+
+            for (const Subset& subset : input.Data.IndexSubsets)
+            {
+                ComputeMeshlets(input.Data.Indices.data() + subset.Offset, subset.Count, input.Data.VertexCount, c_maxMeshletVerts, c_maxMeshletPrims,
+                    input.Meshlets, input.UniqueVertexIndices, input.PrimitiveIndices);
+            }
+
+            input.CullingData.resize(input.Meshlets.size());
+            ComputeCullData(input.Positions.data(), input.Meshlets.data(), static_cast<uint32_t>(input.Meshlets.size()),
+                input.UniqueVertexIndices.data(), input.PrimitiveIndices.data(), input.CullingData.data());
+
+            asset.TriangleCount += mesh.IndexCount / 3;
+            asset.MeshletCount += static_cast<uint32_t>(mesh.Meshlets.size());
+        }
+
+        return true;
+    }
+
+    void BenchmarkLoadFromFile(BenchmarkState& state, const Asset& asset)
+    {
+        while (state.KeepRunning())
+        {
+            Model model;
+            if (FAILED(model.LoadFromFile(asset.Path.c_str())))
+            {
+                state.SkipWithError("Failed to load " + asset.Name);
+                return;
+            }
+
+            DoNotOptimize(model.GetBoundingSphere());
+        }
+
+        state.SetBytesPerIteration(asset.FileSize);
+        state.SetCounter("triangles", asset.TriangleCount);
+        state.SetCounter("meshlets", asset.MeshletCount);
+    }
+
+    void BenchmarkBuildMeshlets(BenchmarkState& state, const Asset& asset)
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> uniqueVertexIndices;
+        std::vector<PackedTriangle> primitiveIndices;
+
+        uint64_t meshletCount = 0;
+        while (state.KeepRunning())
+        {
+            meshletCount = 0;
+            for (const MeshInput& input : asset.Meshes)
+            {
+                meshlets.clear();
+                uniqueVertexIndices.clear();
+                primitiveIndices.clear();
+
+                for (const Subset& subset : input.Data.IndexSubsets)
+                {
+                    ComputeMeshlets(input.Data.Indices.data() + subset.Offset, subset.Count, input.Data.VertexCount, c_maxMeshletVerts, c_maxMeshletPrims,
+                        meshlets, uniqueVertexIndices, primitiveIndices);
+                }
+
+                meshletCount += meshlets.size();
+                DoNotOptimize(meshlets.data());
+            }
+        }
+
+        state.SetCounter("triangles", asset.TriangleCount);
+        state.SetCounter("meshlets", double(meshletCount));
+    }
+
+    void BenchmarkComputeCullData(BenchmarkState& state, const Asset& asset)
+    {
+        std::vector<CullData> cullData;
+
+        uint64_t meshletCount = 0;
+        uint64_t triangleCount = 0;
+        for (const MeshInput& input : asset.Meshes)
+        {
+            meshletCount += input.Meshlets.size();
+            triangleCount += input.PrimitiveIndices.size();
+        }
+
+        while (state.KeepRunning())
+        {
+            for (const MeshInput& input : asset.Meshes)
+            {
+                cullData.resize(input.Meshlets.size());
+                ComputeCullData(input.Positions.data(), input.Meshlets.data(), static_cast<uint32_t>(input.Meshlets.size()),
+                    input.UniqueVertexIndices.data(), input.PrimitiveIndices.data(), cullData.data());
+
+                DoNotOptimize(cullData.data());
+            }
+        }
+
+        state.SetCounter("triangles", double(triangleCount));
+        state.SetCounter("meshlets", double(meshletCount));
+    }
+
+    // Meshlet bounds against the view frustum. The occlusion culler is given no occluders, so
+    // only its frustum test rejects anything.
+    void BenchmarkCullMeshlets(BenchmarkState& state, const Asset& asset)
+    {
+        OcclusionCuller culler;
+        culler.Init(c_viewportWidth, c_viewportHeight);
+        culler.SetViewProjection(asset.ViewProj);
+        culler.RenderOccluders(1);
+
+        std::vector<uint32_t> visible;
+
+        uint64_t meshletCount = 0;
+        for (const MeshInput& input : asset.Meshes)
+        {
+            meshletCount += input.CullingData.size();
+        }
+
+        while (state.KeepRunning())
+        {
+            visible.clear();
+            for (const MeshInput& input : asset.Meshes)
+            {
+                for (const CullData& cull : input.CullingData)
+                {
+                    const XMFLOAT3 center(cull.BoundingSphere.x, cull.BoundingSphere.y, cull.BoundingSphere.z);
+                    if (culler.IsSphereVisible(center, cull.BoundingSphere.w))
+                    {
+                        visible.push_back(static_cast<uint32_t>(&cull - input.CullingData.data()));
+                    }
+                }
+            }
+
+            DoNotOptimize(visible.data());
+        }
+
+        state.SetCounter("meshlets", double(meshletCount));
+    }
+
+    // Adds every mesh of the asset as an occluder of itself. Its triangles are far smaller than
+    // the coarse occluders the culler is meant for, which makes for a heavy load to rasterize.
+    void AddAssetOccluders(OcclusionCuller& culler, const Asset& asset)
+    {
+        XMFLOAT4X4 world;
+        XMStoreFloat4x4(&world, XMMatrixIdentity());
+
+        culler.Init(c_viewportWidth, c_viewportHeight);
+        culler.SetViewProjection(asset.ViewProj);
+        for (uint32_t m = 0; m < asset.Geometry.GetMeshCount(); ++m)
+        {
+            culler.AddOccluder(asset.Geometry.GetMesh(m), world);
+        }
+    }
+
+    // Rasterizes the asset as occluders, spread over the benchmark's thread count.
+    void BenchmarkRenderOccluders(BenchmarkState& state, const Asset& asset)
+    {
+        OcclusionCuller culler;
+        AddAssetOccluders(culler, asset);
+
+        while (state.KeepRunning())
+        {
+            culler.RenderOccluders(state.GetThreadCount());
+            DoNotOptimize(culler.GetDepthBuffer());
+        }
+
+        state.SetCounter("triangles", asset.TriangleCount);
+    }
+
+    // Meshlet bounds against the asset rasterized as occluders, so that meshlets on its far
+    // side are hidden by its near side and both of the culler's tests reject work.
+    void BenchmarkOccludeMeshlets(BenchmarkState& state, const Asset& asset)
+    {
+        OcclusionCuller culler;
+        AddAssetOccluders(culler, asset);
+        culler.RenderOccluders(1);
+
+        XMFLOAT4X4 world;
+        XMStoreFloat4x4(&world, XMMatrixIdentity());
+
+        std::vector<uint32_t> visible;
+        while (state.KeepRunning())
+        {
+            for (uint32_t m = 0; m < asset.Geometry.GetMeshCount(); ++m)
+            {
+                visible.clear();
+                culler.CullMeshlets(asset.Geometry.GetMesh(m), world, visible);
+                DoNotOptimize(visible.data());
+            }
+        }
+
+        state.SetCounter("meshlets", asset.MeshletCount);
+    }
+
+    // Bins the asset's meshlets into groups of two meshlets' budget, as draws too small for a
+    // group each are binned by the fixed-function translation.
+    void BenchmarkPackMeshlets(BenchmarkState& state, const Asset& asset, PackMode::EType mode)
+    {
+        const PackLimits limits = { 2 * c_maxMeshletVerts, 2 * c_maxMeshletPrims };
+
+        std::vector<PackItem> items;
+        for (const MeshInput& input : asset.Meshes)
+        {
+            for (const Meshlet& meshlet : input.Meshlets)
+            {
+                items.push_back(PackItem{ meshlet.VertCount, meshlet.PrimCount });
+            }
+        }
+
+        std::vector<PackGroup> groups;
+        std::vector<uint32_t> order;
+        while (state.KeepRunning())
+        {
+            if (!PackItems(items.data(), static_cast<uint32_t>(items.size()), limits, mode, groups, order))
+            {
+                state.SkipWithError("Failed to pack the meshlets of " + asset.Name);
+                return;
+            }
+
+            DoNotOptimize(groups.data());
+        }
+
+        state.SetCounter("meshlets", double(items.size()));
+        state.SetCounter("groups", double(groups.size()));
+    }
+
+    void BenchmarkPackInOrder(BenchmarkState& state, const Asset& asset)
+    {
+        BenchmarkPackMeshlets(state, asset, PackMode::InOrder);
+    }
+
+    void BenchmarkPackBestFit(BenchmarkState& state, const Asset& asset)
+    {
+        BenchmarkPackMeshlets(state, asset, PackMode::BestFitDecreasing);
+    }
+
+    // The mesh shader's per-triangle culling of clip-space triangles, every test enabled.
+    void BenchmarkCullPrimitives(BenchmarkState& state, const Asset& asset)
+    {
+        const XMFLOAT2 viewportSize(static_cast<float>(c_viewportWidth), static_cast<float>(c_viewportHeight));
+        std::vector<uint32_t> survivors;
+
+        while (state.KeepRunning())
+        {
+            for (const MeshInput& input : asset.Meshes)
+            {
+                survivors.clear();
+                CullPrimitives(input.ClipPositions.data(), input.Data.Indices.data(), static_cast<uint32_t>(input.Data.Indices.size() / 3),
+                    viewportSize, PrimitiveCull::All, survivors);
+
+                DoNotOptimize(survivors.data());
+            }
+        }
+
+        state.SetCounter("triangles", asset.TriangleCount);
+    }
+
+    // Draws every mesh with one indexed draw through the fixed-function translation and runs
+    // the recorded dispatches on the CPU, spread over the benchmark's thread count.
+    void BenchmarkMeshShaderExecutor(BenchmarkState& state, const Asset& asset)
+    {
+        struct MeshDraw
+        {
+            MeshShaderExecutor                         Executor;
+            std::vector<RecordingDrawTarget::Command>  Commands;
+        };
+
+        std::vector<std::unique_ptr<MeshDraw>> draws;
+        uint64_t bytes = 0;
+
+        // Buffers are given made-up GPU addresses for the executor to resolve views against.
+        D3D12_GPU_VIRTUAL_ADDRESS nextAddress = 0x100000000ull;
+
+        for (uint32_t m = 0; m < asset.Geometry.GetMeshCount(); ++m)
+        {
+            const Mesh& mesh = asset.Geometry.GetMesh(m);
+            const uint32_t slotCount = static_cast<uint32_t>(mesh.Vertices.size());
+
+            VertexLayout layout;
+            if (FAILED(ResolveInputLayout(mesh.LayoutDesc, mesh.VertexStrides.data(), slotCount, layout)))
+            {
+                state.SkipWithError("Unsupported input layout in " + asset.Name);
+                return;
+            }
+
+            std::unique_ptr<MeshDraw> draw(new MeshDraw());
+            draw->Executor.SetVertexLayout(layout);
+            draw->Executor.SetConstants(asset.ViewProj, XMFLOAT2(float(c_viewportWidth), float(c_viewportHeight)), PrimitiveCull::All);
+
+            D3D12_VERTEX_BUFFER_VIEW vertexBuffers[c_maxVertexSlots] = {};
+            for (uint32_t slot = 0; slot < slotCount && slot < c_maxVertexSlots; ++slot)
+            {
+                vertexBuffers[slot].BufferLocation = nextAddress;
+                vertexBuffers[slot].SizeInBytes = static_cast<uint32_t>(mesh.Vertices[slot].size());
+                vertexBuffers[slot].StrideInBytes = mesh.VertexStrides[slot];
+
+                draw->Executor.RegisterBuffer(nextAddress, mesh.Vertices[slot].size(), mesh.Vertices[slot].data());
+                nextAddress += (mesh.Vertices[slot].size() + 0xffff) & ~0xffffull;
+                bytes += mesh.Vertices[slot].size();
+            }
+
+            D3D12_INDEX_BUFFER_VIEW indexBuffer = {};
+            indexBuffer.BufferLocation = nextAddress;
+            indexBuffer.SizeInBytes = static_cast<uint32_t>(mesh.Indices.size());
+            indexBuffer.Format = mesh.IndexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+            draw->Executor.RegisterBuffer(nextAddress, mesh.Indices.size(), mesh.Indices.data());
+            nextAddress += (mesh.Indices.size() + 0xffff) & ~0xffffull;
+            bytes += mesh.Indices.size();
+
+            RecordingDrawTarget target;
+            FixedFunctionContext context(target);
+            context.SetVertexLayout(layout);
+            context.IASetVertexBuffers(0, std::min(slotCount, c_maxVertexSlots), vertexBuffers);
+            context.IASetIndexBuffer(&indexBuffer);
+            context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            context.DrawIndexedInstanced(mesh.IndexCount, 1, 0, 0, 0);
+
+            draw->Commands = target.GetCommands();
+            draws.push_back(std::move(draw));
+        }
+
+        MeshShaderOutput output;
+        while (state.KeepRunning())
+        {
+            output.Clear();
+            for (auto& draw : draws)
+            {
+                if (FAILED(draw->Executor.Execute(draw->Commands, output, state.GetThreadCount())))
+                {
+                    state.SkipWithError("Mesh shader execution failed for " + asset.Name);
+                    return;
+                }
+            }
+
+            DoNotOptimize(output.Indices.data());
+        }
+
+        state.SetBytesPerIteration(bytes);
+        state.SetCounter("triangles", output.PrimitiveCount);
+    }
+
+    // Reads each mesh's indices as one triangle strip with restart enabled but never cut, the
+    // worst case for finding where each group's strip starts: every group's is the draw's.
+    MeshDrawParams GetUncutStripParams(const MeshInput& input)
+    {
+        MeshDrawParams params = {};
+        params.IndexSize = 4;
+        params.VertexCount = static_cast<uint32_t>(input.Data.Indices.size());
+        params.CutIndex = ~0u;
+        return params;
+    }
+
+    // Scans back from every group's window, as FindStripStart() in MeshletMS.hlsl does: the
+    // groups of a strip cost the square of its length between them.
+    void BenchmarkScanStripStarts(BenchmarkState& state, const Asset& asset)
+    {
+        const PrimitiveTopologyInfo& info = *GetPrimitiveTopologyInfo(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        uint64_t groupCount = 0;
+
+        while (state.KeepRunning())
+        {
+            groupCount = 0;
+            for (const MeshInput& input : asset.Meshes)
+            {
+                const MeshDrawParams params = GetUncutStripParams(input);
+                const uint32_t groups = GetDispatchGroupCount(GetPrimitiveSlotCount(info, params.VertexCount), info.GroupPrimitives);
+                for (uint32_t group = 0; group < groups; ++group)
+                {
+                    DoNotOptimize(FindGroupStripStart(info, params, group, input.Data.Indices.data()));
+                }
+                groupCount += groups;
+            }
+        }
+
+        state.SetCounter("groups", static_cast<double>(groupCount));
+    }
+
+    // Finds every group's strip start in one pass over the indices, as the executor does.
+    void BenchmarkGetStripStarts(BenchmarkState& state, const Asset& asset)
+    {
+        const PrimitiveTopologyInfo& info = *GetPrimitiveTopologyInfo(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        std::vector<uint32_t> stripStarts;
+        uint64_t groupCount = 0;
+
+        while (state.KeepRunning())
+        {
+            groupCount = 0;
+            for (const MeshInput& input : asset.Meshes)
+            {
+                const MeshDrawParams params = GetUncutStripParams(input);
+                stripStarts.resize(GetDispatchGroupCount(GetPrimitiveSlotCount(info, params.VertexCount), info.GroupPrimitives));
+                GetGroupStripStarts(info, params, input.Data.Indices.data(), static_cast<uint32_t>(stripStarts.size()), stripStarts.data());
+
+                DoNotOptimize(stripStarts.data());
+                groupCount += stripStarts.size();
+            }
+        }
+
+        state.SetCounter("groups", static_cast<double>(groupCount));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --assets <dir> is ours; the remaining options go to the harness.
+    std::string directory = "Assets";
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--assets") == 0 && i + 1 < argc)
+        {
+            directory = argv[++i];
+            continue;
+        }
+
+        args.push_back(argv[i]);
+    }
+
+    const std::vector<std::string> names = ListAssets(directory);
+    if (names.empty())
+    {
+        std::cerr << "No .bin models found in " << directory << "; pass --assets <dir>.\n";
+        return 1;
+    }
+
+    std::vector<std::shared_ptr<Asset>> assets;
+    for (const std::string& name : names)
+    {
+        std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+        if (!LoadAsset(directory, name, *asset))
+        {
+            std::cerr << "Skipping " << name << ": not a model this build can load.\n";
+            continue;
+        }
+
+        assets.push_back(asset);
+    }
+
+    struct Suite
+    {
+        const char*               Name;
+        BenchmarkThreading::EType Threading;
+        void                    (*Function)(BenchmarkState&, const Asset&);
+    };
+
+    const Suite suites[] =
+    {
+        { "LoadFromFile",       BenchmarkThreading::Replicated, BenchmarkLoadFromFile },
+        { "BuildMeshlets",      BenchmarkThreading::Replicated, BenchmarkBuildMeshlets },
+        { "ComputeCullData",    BenchmarkThreading::Replicated, BenchmarkComputeCullData },
+        { "CullMeshlets",       BenchmarkThreading::Replicated, BenchmarkCullMeshlets },
+        { "RenderOccluders",    BenchmarkThreading::Internal,   BenchmarkRenderOccluders },
+        { "OccludeMeshlets",    BenchmarkThreading::Replicated, BenchmarkOccludeMeshlets },
+        { "CullPrimitives",     BenchmarkThreading::Replicated, BenchmarkCullPrimitives },
+        { "PackInOrder",        BenchmarkThreading::Replicated, BenchmarkPackInOrder },
+        { "PackBestFit",        BenchmarkThreading::Replicated, BenchmarkPackBestFit },
+        { "MeshShaderExecutor", BenchmarkThreading::Internal,   BenchmarkMeshShaderExecutor },
+        { "ScanStripStarts",    BenchmarkThreading::Replicated, BenchmarkScanStripStarts },
+        { "GetStripStarts",     BenchmarkThreading::Replicated, BenchmarkGetStripStarts },
+    };
+
+    for (const Suite& suite : suites)
+    {
+        for (const std::shared_ptr<Asset>& asset : assets)
+        {
+            auto function = suite.Function;
+            RegisterBenchmark(std::string(suite.Name) + "/" + asset->Name, suite.Threading, [function, asset](BenchmarkState& state)
+            {
+                function(state, *asset);
+            });
+        }
+    }
+
+    return RunBenchmarks(static_cast<int>(args.size()), args.data());
+}
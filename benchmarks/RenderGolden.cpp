@@ -0,0 +1,361 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "CameraPath.h"
+#include "FixedFunctionContext.h"
+#include "MeshShaderExecutor.h"
+#include "Model.h"
+#include "PngImage.h"
+#include "PrimitiveCulling.h"
+#include "SoftwareRasterizer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace DirectX;
+
+// Renders one frame of a model with the CPU mesh shader executor and the software rasterizer,
+// and checks it against a golden PNG, so render output can be verified on machines without a
+// GPU. Exits with 0 when the image matches, 1 on errors, and 2 when it differs. CTest runs it
+// as RenderGolden.
+//
+// A pixel differs when any channel is further than --tolerance from the golden; the image
+// matches while the fraction of differing pixels is at most --max-differing. The default,
+// 0.01%, leaves room for rounding along edges but not for drawing another LOD: the dragon's
+// next one differs in 0.023% of the default frame. --update writes the rendered image over the
+// golden instead of comparing.
+//
+// Golden/Dragon_LOD1.png is the default model from the default view at the default size, and
+// is the golden when the render is left at those defaults:
+//
+//   MeshRender --diff diff.png
+//
+// run from dx12_simple_mesh, where the Assets are. Other renders compare only against a
+// --golden given for them.
+namespace
+{
+    const float c_clearColor[4] = { 0.0f, 0.2f, 0.4f, 1.0f }; // The sample's clear color
+    const char* const c_defaultGoldenPath = "../benchmarks/Golden/Dragon_LOD1.png";
+
+    struct Options
+    {
+        std::string  ModelPath = "Assets/Dragon_LOD1.bin";
+        std::string  CameraPath;
+        std::string  OutputPath;
+        std::string  GoldenPath;
+        std::string  DiffPath;
+        double       Time = 0.0;
+        uint32_t     Width = 1280;
+        uint32_t     Height = 720;
+        uint32_t     Tolerance = 2;
+        double       MaxDiffering = 0.0001;
+        uint32_t     ThreadCount = 0;
+        bool         Update = false;
+    };
+
+    // Paths are passed through byte for byte, which is enough for ASCII ones.
+    std::wstring Widen(const std::string& text)
+    {
+        std::wstring wide;
+        for (char c : text)
+        {
+            wide += static_cast<wchar_t>(static_cast<unsigned char>(c));
+        }
+        return wide;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const bool hasValue = i + 1 < argc;
+
+            if (strcmp(argv[i], "--model") == 0 && hasValue)
+            {
+                options.ModelPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--camera") == 0 && hasValue)
+            {
+                options.CameraPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--time") == 0 && hasValue)
+            {
+                options.Time = atof(argv[++i]);
+            }
+            else if (strcmp(argv[i], "--width") == 0 && hasValue)
+            {
+                options.Width = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+            else if (strcmp(argv[i], "--height") == 0 && hasValue)
+            {
+                options.Height = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+            else if (strcmp(argv[i], "--output") == 0 && hasValue)
+            {
+                options.OutputPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--golden") == 0 && hasValue)
+            {
+                options.GoldenPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--diff") == 0 && hasValue)
+            {
+                options.DiffPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--tolerance") == 0 && hasValue)
+            {
+                options.Tolerance = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+            else if (strcmp(argv[i], "--max-differing") == 0 && hasValue)
+            {
+                options.MaxDiffering = atof(argv[++i]);
+            }
+            else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+            {
+                options.ThreadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+            else if (strcmp(argv[i], "--update") == 0)
+            {
+                options.Update = true;
+            }
+            else
+            {
+                std::cerr << "Unknown option " << argv[i] << ".\n"
+                    << "Usage: MeshRender [--model <file>] [--camera <path file> [--time <seconds>]] [--width <n>] [--height <n>]\n"
+                    << "                  [--output <png>] [--golden <png> [--update] [--diff <png>] [--tolerance <n>]\n"
+                    << "                  [--max-differing <fraction>]] [--threads <n>]\n";
+                return false;
+            }
+        }
+
+        if (options.Width == 0 || options.Height == 0)
+        {
+            std::cerr << "--width and --height must be positive.\n";
+            return false;
+        }
+
+        // The committed golden only holds for the render it was made from.
+        const Options defaults;
+        if (options.GoldenPath.empty() &&
+            options.ModelPath == defaults.ModelPath &&
+            options.CameraPath.empty() &&
+            options.Time == defaults.Time &&
+            options.Width == defaults.Width &&
+            options.Height == defaults.Height)
+        {
+            options.GoldenPath = c_defaultGoldenPath;
+        }
+
+        if (options.Update && options.GoldenPath.empty())
+        {
+            std::cerr << "--update needs --golden.\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    // Without a path file the camera looks at the model from the front and a little above,
+    // far enough back for its bounding sphere to fill the view vertically.
+    void BuildDefaultView(const BoundingSphere& bounds, CameraPath& path)
+    {
+        const float fovY = XM_PI / 3.0f;
+        const float distance = bounds.Radius / XMScalarSin(fovY * 0.5f);
+
+        CameraKey key;
+        key.Time = 0.0f;
+        key.Position = XMFLOAT3(bounds.Center.x, bounds.Center.y + distance * 0.25f, bounds.Center.z + distance);
+        key.Target = bounds.Center;
+        key.FovY = fovY;
+
+        path.SetKeys(std::vector<CameraKey>(1, key));
+    }
+
+    // Runs the mesh's whole index buffer through the executor as one indexed draw, reading the
+    // model's memory in place.
+    HRESULT ExecuteMesh(const Mesh& mesh, const XMFLOAT4X4& viewProj, const XMFLOAT2& viewportSize, uint32_t threadCount, MeshShaderOutput& output)
+    {
+        const uint32_t slotCount = static_cast<uint32_t>(mesh.Vertices.size());
+        if (slotCount > c_maxVertexSlots)
+            return E_INVALIDARG;
+
+        VertexLayout layout;
+        HRESULT hr = ResolveInputLayout(mesh.LayoutDesc, mesh.VertexStrides.data(), slotCount, layout);
+        if (FAILED(hr))
+            return hr;
+
+        // Stand-in GPU addresses for the executor to resolve the views against.
+        const uint64_t addressStride = 1ull << 32;
+        uint64_t address = addressStride;
+
+        MeshShaderExecutor executor;
+        executor.SetVertexLayout(layout);
+        executor.SetConstants(viewProj, viewportSize, PrimitiveCull::All);
+
+        D3D12_VERTEX_BUFFER_VIEW vertexBufferViews[c_maxVertexSlots] = {};
+        for (uint32_t slot = 0; slot < slotCount; ++slot, address += addressStride)
+        {
+            vertexBufferViews[slot].BufferLocation = address;
+            vertexBufferViews[slot].SizeInBytes = static_cast<uint32_t>(mesh.Vertices[slot].size());
+            vertexBufferViews[slot].StrideInBytes = mesh.VertexStrides[slot];
+
+            executor.RegisterBuffer(address, mesh.Vertices[slot].size(), mesh.Vertices[slot].data());
+        }
+
+        D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
+        indexBufferView.BufferLocation = address;
+        indexBufferView.SizeInBytes = static_cast<uint32_t>(mesh.Indices.size());
+        indexBufferView.Format = mesh.IndexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+        executor.RegisterBuffer(address, mesh.Indices.size(), mesh.Indices.data());
+
+        RecordingDrawTarget recording;
+        {
+            FixedFunctionContext context(recording);
+            context.SetVertexLayout(layout);
+            context.IASetVertexBuffers(0, slotCount, vertexBufferViews);
+            context.IASetIndexBuffer(&indexBufferView);
+            context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            context.DrawIndexedInstanced(mesh.IndexCount, 1, 0, 0, 0);
+        }
+
+        return executor.Execute(recording.GetCommands(), output, threadCount);
+    }
+
+    double ToMilliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    Model model;
+    if (FAILED(model.LoadFromFile(Widen(options.ModelPath).c_str())))
+    {
+        std::cerr << "Failed to load the model " << options.ModelPath << ".\n";
+        return 1;
+    }
+
+    CameraPath path;
+    if (options.CameraPath.empty())
+    {
+        BuildDefaultView(model.GetBoundingSphere(), path);
+    }
+    else if (FAILED(path.LoadFromFile(Widen(options.CameraPath).c_str())) || path.IsEmpty())
+    {
+        std::cerr << "Failed to load the camera path " << options.CameraPath << ".\n";
+        return 1;
+    }
+
+    const float aspectRatio = static_cast<float>(options.Width) / static_cast<float>(options.Height);
+    const XMFLOAT2 viewportSize(static_cast<float>(options.Width), static_cast<float>(options.Height));
+
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, path.GetViewMatrix(options.Time) * path.GetProjectionMatrix(options.Time, aspectRatio));
+
+    const auto executeStart = std::chrono::steady_clock::now();
+
+    MeshShaderOutput output;
+    output.Clear();
+    for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+    {
+        if (FAILED(ExecuteMesh(model.GetMesh(m), viewProj, viewportSize, options.ThreadCount, output)))
+        {
+            std::cerr << "Mesh " << m << " could not be executed.\n";
+            return 1;
+        }
+    }
+
+    const auto rasterStart = std::chrono::steady_clock::now();
+
+    SoftwareRasterizer rasterizer;
+    rasterizer.Init(options.Width, options.Height);
+    rasterizer.Clear(c_clearColor);
+    rasterizer.Draw(output, options.ThreadCount);
+
+    const auto rasterEnd = std::chrono::steady_clock::now();
+
+    std::vector<uint8_t> image;
+    rasterizer.ReadPixels(image);
+
+    char line[160];
+    snprintf(line, sizeof(line), "%ux%u, %u triangles: execute %.2f ms, rasterize %.2f ms",
+        options.Width, options.Height, static_cast<uint32_t>(output.Indices.size() / 3),
+        ToMilliseconds(rasterStart - executeStart), ToMilliseconds(rasterEnd - rasterStart));
+    std::cout << line << "\n";
+
+    if (!options.OutputPath.empty() && FAILED(WritePng(Widen(options.OutputPath).c_str(), options.Width, options.Height, image.data())))
+    {
+        std::cerr << "Failed to write " << options.OutputPath << ".\n";
+        return 1;
+    }
+
+    if (options.GoldenPath.empty())
+        return 0;
+
+    if (options.Update)
+    {
+        if (FAILED(WritePng(Widen(options.GoldenPath).c_str(), options.Width, options.Height, image.data())))
+        {
+            std::cerr << "Failed to write " << options.GoldenPath << ".\n";
+            return 1;
+        }
+
+        std::cout << "Updated " << options.GoldenPath << "\n";
+        return 0;
+    }
+
+    uint32_t goldenWidth, goldenHeight;
+    std::vector<uint8_t> golden;
+    if (FAILED(ReadPng(Widen(options.GoldenPath).c_str(), goldenWidth, goldenHeight, golden)))
+    {
+        std::cerr << "Failed to read " << options.GoldenPath << ".\n";
+        return 1;
+    }
+
+    if (goldenWidth != options.Width || goldenHeight != options.Height)
+    {
+        std::cerr << options.GoldenPath << " is " << goldenWidth << "x" << goldenHeight << ", not "
+            << options.Width << "x" << options.Height << ".\n";
+        return 2;
+    }
+
+    const size_t pixelCount = size_t(options.Width) * options.Height;
+
+    std::vector<uint8_t> differences;
+    const ImageDifference difference = CompareImages(image.data(), golden.data(), pixelCount, options.Tolerance,
+        options.DiffPath.empty() ? nullptr : &differences);
+
+    if (!options.DiffPath.empty() && FAILED(WritePng(Widen(options.DiffPath).c_str(), options.Width, options.Height, differences.data())))
+    {
+        std::cerr << "Failed to write " << options.DiffPath << ".\n";
+        return 1;
+    }
+
+    const double fraction = static_cast<double>(difference.DifferingPixels) / static_cast<double>(pixelCount);
+    const bool matches = fraction <= options.MaxDiffering;
+
+    snprintf(line, sizeof(line), "%s: %llu pixels differ by more than %u (%.4f%%), largest difference %u",
+        matches ? "Match" : "Mismatch", static_cast<unsigned long long>(difference.DifferingPixels),
+        options.Tolerance, fraction * 100.0, difference.MaxChannelDifference);
+    std::cout << line << "\n";
+
+    return matches ? 0 : 2;
+}
@@ -0,0 +1,160 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace DirectX;
+
+namespace
+{
+    const float c_defaultFovDegrees = 60.0f;
+
+    XMVECTOR CatmullRom(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2, const XMFLOAT3& p3, float t)
+    {
+        return XMVectorCatmullRom(XMLoadFloat3(&p0), XMLoadFloat3(&p1), XMLoadFloat3(&p2), XMLoadFloat3(&p3), t);
+    }
+}
+
+HRESULT CameraPath::LoadFromFile(const wchar_t* filename)
+{
+    std::ifstream stream(GetStreamPath(filename));
+    if (!stream.is_open())
+    {
+        return E_INVALIDARG;
+    }
+
+    std::vector<CameraKey> keys;
+
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+        {
+            line.erase(comment);
+        }
+
+        std::istringstream fields(line);
+
+        CameraKey key;
+        if (!(fields >> key.Time))
+        {
+            // Only blank lines may hold no keyframe.
+            if (line.find_first_not_of(" \t\r") != std::string::npos)
+                return E_INVALIDARG;
+
+            continue;
+        }
+
+        if (!(fields >> key.Position.x >> key.Position.y >> key.Position.z >> key.Target.x >> key.Target.y >> key.Target.z))
+            return E_INVALIDARG;
+
+        float fovDegrees = c_defaultFovDegrees;
+        if (!(fields >> fovDegrees))
+        {
+            if (!fields.eof())
+                return E_INVALIDARG;
+
+            fovDegrees = c_defaultFovDegrees;
+        }
+
+        key.FovY = XMConvertToRadians(fovDegrees);
+        keys.push_back(key);
+    }
+
+    return SetKeys(keys);
+}
+
+HRESULT CameraPath::SetKeys(const std::vector<CameraKey>& keys)
+{
+    for (size_t i = 1; i < keys.size(); ++i)
+    {
+        if (!(keys[i].Time > keys[i - 1].Time))
+            return E_INVALIDARG;
+    }
+
+    for (auto& key : keys)
+    {
+        if (!(key.FovY > 0.0f && key.FovY < XM_PI))
+            return E_INVALIDARG;
+    }
+
+    m_keys = keys;
+    return S_OK;
+}
+
+CameraKey CameraPath::Evaluate(double seconds) const
+{
+    if (m_keys.empty())
+    {
+        CameraKey key = {};
+        key.Target = XMFLOAT3(0.0f, 0.0f, -1.0f);
+        key.FovY = XMConvertToRadians(c_defaultFovDegrees);
+        return key;
+    }
+
+    const float time = static_cast<float>(seconds);
+    if (m_keys.size() == 1 || time <= m_keys.front().Time)
+        return m_keys.front();
+    if (time >= m_keys.back().Time)
+        return m_keys.back();
+
+    // The segment [k1, k2] holding 'time'; the spline's outer control points repeat the ends.
+    auto next = std::upper_bound(m_keys.begin(), m_keys.end(), time, [](float t, const CameraKey& key) { return t < key.Time; });
+    const size_t i2 = static_cast<size_t>(next - m_keys.begin());
+    const size_t i1 = i2 - 1;
+    const size_t i0 = i1 > 0 ? i1 - 1 : i1;
+    const size_t i3 = std::min(i2 + 1, m_keys.size() - 1);
+
+    const CameraKey& k0 = m_keys[i0];
+    const CameraKey& k1 = m_keys[i1];
+    const CameraKey& k2 = m_keys[i2];
+    const CameraKey& k3 = m_keys[i3];
+
+    const float t = (time - k1.Time) / (k2.Time - k1.Time);
+
+    CameraKey key;
+    key.Time = time;
+    XMStoreFloat3(&key.Position, CatmullRom(k0.Position, k1.Position, k2.Position, k3.Position, t));
+    XMStoreFloat3(&key.Target, CatmullRom(k0.Target, k1.Target, k2.Target, k3.Target, t));
+    key.FovY = k1.FovY + (k2.FovY - k1.FovY) * t;
+
+    return key;
+}
+
+XMMATRIX CameraPath::GetViewMatrix(double seconds) const
+{
+    const CameraKey key = Evaluate(seconds);
+
+    XMVECTOR eye = XMLoadFloat3(&key.Position);
+    XMVECTOR focus = XMLoadFloat3(&key.Target);
+
+    // A path looking straight up or down needs another up vector.
+    XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+    XMVECTOR direction = XMVector3Normalize(XMVectorSubtract(focus, eye));
+    if (fabsf(XMVectorGetY(direction)) > 0.999f)
+    {
+        up = XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f);
+    }
+
+    return XMMatrixLookAtRH(eye, focus, up);
+}
+
+XMMATRIX CameraPath::GetProjectionMatrix(double seconds, float aspectRatio, float nearPlane, float farPlane) const
+{
+    return XMMatrixPerspectiveFovRH(Evaluate(seconds).FovY, aspectRatio, nearPlane, farPlane);
+}
@@ -0,0 +1,58 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Platform.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// A camera flown through a list of keyframes, for runs that must see the same frames every
+// time. Paths are text files with one keyframe per line:
+//
+//     time  px py pz  tx ty tz  [fov]
+//
+// giving the time in seconds, the eye position, the point looked at and optionally the vertical
+// field of view in degrees (60 if absent). Blank lines and everything after a '#' are ignored.
+// Keyframe times must increase.
+//
+// Positions and targets follow a Catmull-Rom spline through the keyframes and the field of view
+// is interpolated linearly. Times before the first keyframe or after the last are clamped.
+struct CameraKey
+{
+    float             Time;
+    DirectX::XMFLOAT3 Position;
+    DirectX::XMFLOAT3 Target;
+    float             FovY;     // Radians
+};
+
+class CameraPath
+{
+public:
+    HRESULT LoadFromFile(const wchar_t* filename);
+
+    // Replaces the path with 'keys', which must be in increasing time order.
+    HRESULT SetKeys(const std::vector<CameraKey>& keys);
+
+    bool IsEmpty() const { return m_keys.empty(); }
+    float GetDuration() const { return m_keys.empty() ? 0.0f : m_keys.back().Time - m_keys.front().Time; }
+    const std::vector<CameraKey>& GetKeys() const { return m_keys; }
+
+    // The camera at 'seconds'. An empty path gives a camera at the origin looking down -Z.
+    CameraKey Evaluate(double seconds) const;
+
+    // Right-handed view and projection matrices at 'seconds', as SimpleCamera builds them.
+    DirectX::XMMATRIX GetViewMatrix(double seconds) const;
+    DirectX::XMMATRIX GetProjectionMatrix(double seconds, float aspectRatio, float nearPlane = 1.0f, float farPlane = 1000.0f) const;
+
+private:
+    std::vector<CameraKey> m_keys;
+};
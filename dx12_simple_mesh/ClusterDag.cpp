@@ -0,0 +1,524 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "ClusterDag.h"
+
+#include "MeshSimplifier.h"
+#include "Meshletizer.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    const uint32_t c_invalid = ~0u;
+
+    // Clusters merged into one group before simplifying; the result splits back into about half as many.
+    const uint32_t c_groupSize = 4;
+
+    // Stop building once a level keeps more than this fraction of the previous level's triangles.
+    const float c_minReduction = 0.85f;
+
+    const uint32_t c_maxLevels = 32;
+
+    // Distances closer than this are clamped to avoid blowing up the projected error.
+    const float c_minProjectionDistance = 1e-3f;
+
+    // Range of pixel thresholds searched by SelectClustersWithBudget().
+    const float c_minBudgetThreshold = 1.0f / 16.0f;
+    const float c_maxBudgetThreshold = 65536.0f;
+    const uint32_t c_budgetIterations = 16;
+
+    struct GroupResult
+    {
+        std::vector<Meshlet>        Meshlets;
+        std::vector<uint32_t>       UniqueVertexIndices;
+        std::vector<PackedTriangle> PrimitiveIndices;
+        XMFLOAT4                    Bounds;
+        float                       Error;
+    };
+
+    // Maps every vertex to the first vertex with bit-identical position, so that seams
+    // duplicated for attributes do not look like open borders to the simplifier.
+    void WeldPositions(const XMFLOAT3* positions, uint32_t vertexCount, std::vector<uint32_t>& remap)
+    {
+        std::vector<uint32_t> order(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            order[i] = i;
+        }
+
+        auto less = [&](uint32_t a, uint32_t b)
+        {
+            const int c = std::memcmp(&positions[a], &positions[b], sizeof(XMFLOAT3));
+            return c < 0 || (c == 0 && a < b);
+        };
+        std::sort(order.begin(), order.end(), less);
+
+        remap.resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            const bool same = i > 0 && std::memcmp(&positions[order[i]], &positions[order[i - 1]], sizeof(XMFLOAT3)) == 0;
+            remap[order[i]] = same ? remap[order[i - 1]] : order[i];
+        }
+    }
+}
+
+ClusterDag::ClusterDag()
+    : m_levelCount(0)
+{ }
+
+void ClusterDag::Build(const XMFLOAT3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t threadCount)
+{
+    m_meshlets.clear();
+    m_uniqueVertexIndices.clear();
+    m_primitiveIndices.clear();
+    m_cullData.clear();
+    m_lods.clear();
+    m_levelCount = 0;
+
+    std::vector<uint32_t> remap;
+    WeldPositions(positions, vertexCount, remap);
+
+    std::vector<uint32_t> welded;
+    welded.reserve(indexCount);
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const uint32_t a = remap[indices[i + 0]];
+        const uint32_t b = remap[indices[i + 1]];
+        const uint32_t c = remap[indices[i + 2]];
+
+        if (a != b && b != c && c != a)
+        {
+            welded.push_back(a);
+            welded.push_back(b);
+            welded.push_back(c);
+        }
+    }
+
+    if (welded.empty())
+        return;
+
+    // Level 0 is the source mesh; each cluster's error is zero and projects from its own bounds.
+    std::vector<uint32_t> level;
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> uniqueVertexIndices;
+        std::vector<PackedTriangle> primitiveIndices;
+        ComputeMeshlets(welded.data(), static_cast<uint32_t>(welded.size()), vertexCount, c_maxMeshletVerts, c_maxMeshletPrims,
+            meshlets, uniqueVertexIndices, primitiveIndices);
+
+        AppendClusters(positions, meshlets, uniqueVertexIndices, primitiveIndices, nullptr, 0.0f, 0, level);
+    }
+    m_levelCount = 1;
+
+    std::vector<uint32_t> vertexGroup(vertexCount);
+    std::vector<uint8_t> locked(vertexCount);
+
+    while (level.size() > 1 && m_levelCount < c_maxLevels)
+    {
+        std::vector<std::vector<uint32_t>> groups;
+        PartitionClusters(level, groups);
+
+        // Vertices shared between groups form the group borders and must not move.
+        std::fill(vertexGroup.begin(), vertexGroup.end(), c_invalid);
+        std::fill(locked.begin(), locked.end(), uint8_t(0));
+        for (uint32_t g = 0; g < groups.size(); ++g)
+        {
+            for (uint32_t cluster : groups[g])
+            {
+                const Meshlet& m = m_meshlets[cluster];
+                for (uint32_t i = 0; i < m.VertCount; ++i)
+                {
+                    const uint32_t v = m_uniqueVertexIndices[m.VertOffset + i];
+                    if (vertexGroup[v] == c_invalid)
+                    {
+                        vertexGroup[v] = g;
+                    }
+                    else if (vertexGroup[v] != g)
+                    {
+                        locked[v] = 1;
+                    }
+                }
+            }
+        }
+
+        std::vector<GroupResult> results(groups.size());
+
+        ParallelFor(static_cast<uint32_t>(groups.size()), [&](uint32_t g, uint32_t)
+        {
+            GroupResult& result = results[g];
+
+            // Gather the group's triangles over a compact local vertex array. Clusters share
+            // vertices, so sort the global indices first to give each one a single local slot.
+            std::vector<uint32_t> localToGlobal;
+            for (uint32_t cluster : groups[g])
+            {
+                const Meshlet& m = m_meshlets[cluster];
+                localToGlobal.insert(localToGlobal.end(),
+                    m_uniqueVertexIndices.begin() + m.VertOffset, m_uniqueVertexIndices.begin() + m.VertOffset + m.VertCount);
+            }
+            std::sort(localToGlobal.begin(), localToGlobal.end());
+            localToGlobal.erase(std::unique(localToGlobal.begin(), localToGlobal.end()), localToGlobal.end());
+
+            std::vector<XMFLOAT3> localPositions(localToGlobal.size());
+            std::vector<uint8_t> localLocked(localToGlobal.size());
+            for (size_t i = 0; i < localToGlobal.size(); ++i)
+            {
+                localPositions[i] = positions[localToGlobal[i]];
+                localLocked[i] = locked[localToGlobal[i]];
+            }
+
+            auto toLocal = [&](uint32_t v)
+            {
+                return static_cast<uint32_t>(std::lower_bound(localToGlobal.begin(), localToGlobal.end(), v) - localToGlobal.begin());
+            };
+
+            std::vector<uint32_t> localIndices;
+            result.Bounds = m_lods[groups[g][0]].Bounds;
+            result.Error = 0.0f;
+
+            for (uint32_t cluster : groups[g])
+            {
+                const Meshlet& m = m_meshlets[cluster];
+                const uint32_t* verts = &m_uniqueVertexIndices[m.VertOffset];
+
+                for (uint32_t i = 0; i < m.PrimCount; ++i)
+                {
+                    const PackedTriangle& tri = m_primitiveIndices[m.PrimOffset + i];
+                    localIndices.push_back(toLocal(verts[tri.i0]));
+                    localIndices.push_back(toLocal(verts[tri.i1]));
+                    localIndices.push_back(toLocal(verts[tri.i2]));
+                }
+
+                result.Bounds = MergeSpheres(result.Bounds, m_lods[cluster].Bounds);
+                result.Error = std::max(result.Error, m_lods[cluster].Error);
+            }
+
+            SimplifyDesc desc = {};
+            desc.Positions = localPositions.data();
+            desc.VertexCount = static_cast<uint32_t>(localPositions.size());
+            desc.Indices = localIndices.data();
+            desc.IndexCount = static_cast<uint32_t>(localIndices.size());
+            desc.LockedVertices = localLocked.data();
+            desc.TargetIndexCount = (desc.IndexCount / 6) * 3;
+            desc.TargetError = FLT_MAX;
+
+            std::vector<uint32_t> simplified;
+            const float error = SimplifyMesh(desc, simplified);
+
+            // Errors only grow towards the roots so the cut test stays consistent.
+            result.Error = std::max(result.Error, error);
+
+            ComputeMeshlets(simplified.data(), static_cast<uint32_t>(simplified.size()), desc.VertexCount, c_maxMeshletVerts, c_maxMeshletPrims,
+                result.Meshlets, result.UniqueVertexIndices, result.PrimitiveIndices);
+
+            for (uint32_t& v : result.UniqueVertexIndices)
+            {
+                v = localToGlobal[v];
+            }
+        }, threadCount);
+
+        uint32_t oldTriangles = 0;
+        for (uint32_t cluster : level)
+        {
+            oldTriangles += m_meshlets[cluster].PrimCount;
+        }
+
+        uint32_t newTriangles = 0;
+        for (const GroupResult& result : results)
+        {
+            for (const Meshlet& m : result.Meshlets)
+            {
+                newTriangles += m.PrimCount;
+            }
+        }
+
+        // The current level stays the root of the hierarchy if simplification has stalled.
+        if (newTriangles > oldTriangles * c_minReduction)
+            break;
+
+        std::vector<uint32_t> nextLevel;
+        for (uint32_t g = 0; g < groups.size(); ++g)
+        {
+            const GroupResult& result = results[g];
+
+            for (uint32_t cluster : groups[g])
+            {
+                m_lods[cluster].ParentBounds = result.Bounds;
+                m_lods[cluster].ParentError = result.Error;
+            }
+
+            AppendClusters(positions, result.Meshlets, result.UniqueVertexIndices, result.PrimitiveIndices, &result.Bounds, result.Error, m_levelCount, nextLevel);
+        }
+
+        level.swap(nextLevel);
+        ++m_levelCount;
+    }
+}
+
+void ClusterDag::AppendClusters(
+    const XMFLOAT3* positions,
+    const std::vector<Meshlet>& meshlets,
+    const std::vector<uint32_t>& uniqueVertexIndices,
+    const std::vector<PackedTriangle>& primitiveIndices,
+    const XMFLOAT4* bounds,
+    float error,
+    uint32_t level,
+    std::vector<uint32_t>& clusters)
+{
+    const uint32_t vertBase = static_cast<uint32_t>(m_uniqueVertexIndices.size());
+    const uint32_t primBase = static_cast<uint32_t>(m_primitiveIndices.size());
+    const uint32_t first = static_cast<uint32_t>(m_meshlets.size());
+
+    m_uniqueVertexIndices.insert(m_uniqueVertexIndices.end(), uniqueVertexIndices.begin(), uniqueVertexIndices.end());
+    m_primitiveIndices.insert(m_primitiveIndices.end(), primitiveIndices.begin(), primitiveIndices.end());
+
+    for (Meshlet m : meshlets)
+    {
+        m.VertOffset += vertBase;
+        m.PrimOffset += primBase;
+        m_meshlets.push_back(m);
+    }
+
+    m_cullData.resize(m_meshlets.size());
+    ComputeCullData(positions, &m_meshlets[first], static_cast<uint32_t>(meshlets.size()),
+        m_uniqueVertexIndices.data(), m_primitiveIndices.data(), &m_cullData[first]);
+
+    for (uint32_t i = first; i < m_meshlets.size(); ++i)
+    {
+        ClusterLod lod = {};
+        lod.Bounds = bounds ? *bounds : m_cullData[i].BoundingSphere;
+        lod.ParentBounds = lod.Bounds;
+        lod.Error = error;
+        lod.ParentError = FLT_MAX;
+        lod.Level = level;
+
+        m_lods.push_back(lod);
+        clusters.push_back(i);
+    }
+}
+
+void ClusterDag::PartitionClusters(const std::vector<uint32_t>& clusters, std::vector<std::vector<uint32_t>>& groups) const
+{
+    const uint32_t count = static_cast<uint32_t>(clusters.size());
+
+    // Cluster adjacency weighted by the number of shared vertices.
+    std::vector<std::pair<uint32_t, uint32_t>> vertexClusters;
+    for (uint32_t c = 0; c < count; ++c)
+    {
+        const Meshlet& m = m_meshlets[clusters[c]];
+        for (uint32_t i = 0; i < m.VertCount; ++i)
+        {
+            vertexClusters.emplace_back(m_uniqueVertexIndices[m.VertOffset + i], c);
+        }
+    }
+    std::sort(vertexClusters.begin(), vertexClusters.end());
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> neighbours(count);
+    for (size_t i = 0; i < vertexClusters.size(); )
+    {
+        size_t j = i + 1;
+        while (j < vertexClusters.size() && vertexClusters[j].first == vertexClusters[i].first)
+        {
+            ++j;
+        }
+
+        for (size_t a = i; a < j; ++a)
+        {
+            for (size_t b = i; b < j; ++b)
+            {
+                if (vertexClusters[a].second != vertexClusters[b].second)
+                {
+                    neighbours[vertexClusters[a].second].emplace_back(vertexClusters[b].second, 1u);
+                }
+            }
+        }
+
+        i = j;
+    }
+
+    // Merge duplicate neighbour entries into weights.
+    for (auto& list : neighbours)
+    {
+        std::sort(list.begin(), list.end());
+
+        size_t write = 0;
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            if (write > 0 && list[write - 1].first == list[i].first)
+            {
+                list[write - 1].second += list[i].second;
+            }
+            else
+            {
+                list[write++] = list[i];
+            }
+        }
+        list.resize(write);
+    }
+
+    // Greedily grow groups from each unassigned cluster towards its most connected neighbours.
+    std::vector<uint32_t> groupOf(count, c_invalid);
+    std::vector<uint32_t> weights(count, 0);
+    std::vector<uint32_t> frontier;
+
+    for (uint32_t seed = 0; seed < count; ++seed)
+    {
+        if (groupOf[seed] != c_invalid)
+            continue;
+
+        const uint32_t groupIndex = static_cast<uint32_t>(groups.size());
+        std::vector<uint32_t> members;
+
+        auto add = [&](uint32_t c)
+        {
+            groupOf[c] = groupIndex;
+            members.push_back(c);
+
+            for (const auto& n : neighbours[c])
+            {
+                if (groupOf[n.first] != c_invalid)
+                    continue;
+
+                if (weights[n.first] == 0)
+                {
+                    frontier.push_back(n.first);
+                }
+                weights[n.first] += n.second;
+            }
+        };
+
+        add(seed);
+        while (members.size() < c_groupSize)
+        {
+            uint32_t best = c_invalid;
+            for (uint32_t c : frontier)
+            {
+                if (groupOf[c] == c_invalid && (best == c_invalid || weights[c] > weights[best]))
+                {
+                    best = c;
+                }
+            }
+
+            if (best == c_invalid)
+                break;
+
+            add(best);
+        }
+
+        for (uint32_t c : frontier)
+        {
+            weights[c] = 0;
+        }
+        frontier.clear();
+
+        // A lone cluster is locked on every side and cannot simplify; fold it into its
+        // most connected neighbouring group instead.
+        if (members.size() == 1)
+        {
+            uint32_t bestGroup = c_invalid;
+            uint32_t bestWeight = 0;
+            for (const auto& n : neighbours[seed])
+            {
+                if (groupOf[n.first] != groupIndex && n.second > bestWeight)
+                {
+                    bestGroup = groupOf[n.first];
+                    bestWeight = n.second;
+                }
+            }
+
+            if (bestGroup != c_invalid)
+            {
+                groupOf[seed] = bestGroup;
+                groups[bestGroup].push_back(clusters[seed]);
+                continue;
+            }
+        }
+
+        groups.emplace_back();
+        for (uint32_t c : members)
+        {
+            groups.back().push_back(clusters[c]);
+        }
+    }
+}
+
+uint32_t ClusterDag::SelectClusters(const XMFLOAT4X4& worldView, float fovY, float viewportHeight, float pixelThreshold, std::vector<uint32_t>& selected) const
+{
+    selected.clear();
+
+    const XMMATRIX m = XMLoadFloat4x4(&worldView);
+    const float scale = std::max(
+        XMVectorGetX(XMVector3Length(m.r[0])),
+        std::max(XMVectorGetX(XMVector3Length(m.r[1])), XMVectorGetX(XMVector3Length(m.r[2]))));
+    const float pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+
+    auto project = [&](const XMFLOAT4& bounds, float error)
+    {
+        const XMVECTOR center = XMVector3Transform(XMVectorSet(bounds.x, bounds.y, bounds.z, 1.0f), m);
+        const float distance = std::max(XMVectorGetX(XMVector3Length(center)) - bounds.w * scale, c_minProjectionDistance);
+        return error * scale * pixelsPerUnit / distance;
+    };
+
+    uint32_t triangles = 0;
+    for (uint32_t i = 0; i < m_lods.size(); ++i)
+    {
+        const ClusterLod& lod = m_lods[i];
+
+        // Too coarse for this view; some descendant will be selected instead.
+        if (project(lod.Bounds, lod.Error) > pixelThreshold)
+            continue;
+
+        // Fine enough, but so is the parent; an ancestor will be selected instead.
+        if (lod.ParentError != FLT_MAX && project(lod.ParentBounds, lod.ParentError) <= pixelThreshold)
+            continue;
+
+        selected.push_back(i);
+        triangles += m_meshlets[i].PrimCount;
+    }
+
+    return triangles;
+}
+
+float ClusterDag::SelectClustersWithBudget(const XMFLOAT4X4& worldView, float fovY, float viewportHeight, uint32_t maxTriangles, std::vector<uint32_t>& selected) const
+{
+    float low = c_minBudgetThreshold;
+    if (SelectClusters(worldView, fovY, viewportHeight, low, selected) <= maxTriangles)
+        return low;
+
+    float high = low;
+    do
+    {
+        high = std::min(high * 4.0f, c_maxBudgetThreshold);
+    } while (high < c_maxBudgetThreshold && SelectClusters(worldView, fovY, viewportHeight, high, selected) > maxTriangles);
+
+    // Triangle count only falls as the threshold rises; bisect in log space.
+    for (uint32_t i = 0; i < c_budgetIterations; ++i)
+    {
+        const float mid = std::sqrt(low * high);
+        if (SelectClusters(worldView, fovY, viewportHeight, mid, selected) > maxTriangles)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    SelectClusters(worldView, fovY, viewportHeight, high, selected);
+    return high;
+}
@@ -0,0 +1,90 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "MeshletTypes.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// LOD information for one cluster of a ClusterDag.
+//
+// A cluster is drawn when its own error is acceptable but its parent's is not. Every
+// cluster produced from the same group shares Bounds/Error with the ParentBounds/
+// ParentError of that group's children, so the two tests always agree on which side
+// of the cut a group is and neighbouring clusters never leave cracks.
+struct ClusterLod
+{
+    DirectX::XMFLOAT4 Bounds;       // Sphere the error is projected from (xyz = center, w = radius)
+    DirectX::XMFLOAT4 ParentBounds;
+    float             Error;        // Object-space error relative to the source mesh
+    float             ParentError;  // FLT_MAX for clusters that were never simplified further
+    uint32_t          Level;
+};
+
+// Cluster-level LOD hierarchy (meshlet DAG).
+//
+// Build() meshletizes the source mesh, then repeatedly groups neighbouring clusters,
+// simplifies each group to half its triangles with the group's outer border locked, and
+// splits the result back into clusters. Locking the border is what lets neighbouring
+// groups switch LOD independently. Errors grow monotonically towards the roots and
+// bounds nest, so the projected error of a parent is never below that of its children.
+//
+// The meshlet arrays follow the same layout as Mesh, with vertex indices referring to
+// the vertex array passed to Build().
+class ClusterDag
+{
+public:
+    ClusterDag();
+
+    // Builds the hierarchy from an indexed triangle list. A threadCount of 0 uses every
+    // hardware thread.
+    void Build(const DirectX::XMFLOAT3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t threadCount = 0);
+
+    uint32_t GetClusterCount() const { return static_cast<uint32_t>(m_meshlets.size()); }
+    uint32_t GetLevelCount() const { return m_levelCount; }
+
+    const std::vector<Meshlet>&        GetMeshlets() const { return m_meshlets; }
+    const std::vector<uint32_t>&       GetUniqueVertexIndices() const { return m_uniqueVertexIndices; }
+    const std::vector<PackedTriangle>& GetPrimitiveIndices() const { return m_primitiveIndices; }
+    const std::vector<CullData>&       GetCullData() const { return m_cullData; }
+    const std::vector<ClusterLod>&     GetClusterLods() const { return m_lods; }
+
+    // Selects the clusters forming the coarsest cut whose projected error stays within
+    // pixelThreshold. worldView uses DirectXMath's row-vector convention. Returns the
+    // number of triangles selected.
+    uint32_t SelectClusters(const DirectX::XMFLOAT4X4& worldView, float fovY, float viewportHeight, float pixelThreshold, std::vector<uint32_t>& selected) const;
+
+    // Selects the finest cut that fits in maxTriangles by searching for the smallest
+    // usable pixel threshold. Returns the threshold that was used.
+    float SelectClustersWithBudget(const DirectX::XMFLOAT4X4& worldView, float fovY, float viewportHeight, uint32_t maxTriangles, std::vector<uint32_t>& selected) const;
+
+private:
+    void AppendClusters(
+        const DirectX::XMFLOAT3* positions,
+        const std::vector<Meshlet>& meshlets,
+        const std::vector<uint32_t>& uniqueVertexIndices,
+        const std::vector<PackedTriangle>& primitiveIndices,
+        const DirectX::XMFLOAT4* bounds,
+        float error,
+        uint32_t level,
+        std::vector<uint32_t>& clusters);
+
+    void PartitionClusters(const std::vector<uint32_t>& clusters, std::vector<std::vector<uint32_t>>& groups) const;
+
+    std::vector<Meshlet>        m_meshlets;
+    std::vector<uint32_t>       m_uniqueVertexIndices;
+    std::vector<PackedTriangle> m_primitiveIndices;
+    std::vector<CullData>       m_cullData;
+    std::vector<ClusterLod>     m_lods;
+
+    uint32_t m_levelCount;
+};
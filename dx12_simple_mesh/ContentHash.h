@@ -0,0 +1,96 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// 128 bits of hash, naming cached data by everything it was built from.
+struct ContentHash
+{
+    uint64_t Hash[2];
+
+    bool operator==(const ContentHash& other) const { return Hash[0] == other.Hash[0] && Hash[1] == other.Hash[1]; }
+    bool operator!=(const ContentHash& other) const { return !(*this == other); }
+
+    // 32 hex digits.
+    std::string ToString() const
+    {
+        char text[33];
+        snprintf(text, sizeof(text), "%016llx%016llx",
+            static_cast<unsigned long long>(Hash[0]), static_cast<unsigned long long>(Hash[1]));
+        return text;
+    }
+};
+
+// Two lanes of byte-wise multiplicative hashing, FNV-1a and one with a golden ratio multiplier,
+// each finished with a 64-bit mix so every input bit reaches every output bit. Numbers are
+// added little-endian whatever the host, and strings are prefixed with their length so that
+// fields can't run into each other. Not cryptographic.
+class ContentHasher
+{
+public:
+    ContentHasher()
+    {
+        m_hash[0] = 0xcbf29ce484222325ull;
+        m_hash[1] = 0x6a09e667f3bcc908ull;
+    }
+
+    void AddBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            m_hash[0] = (m_hash[0] ^ bytes[i]) * 0x100000001b3ull;
+            m_hash[1] = (m_hash[1] ^ bytes[i]) * 0x9e3779b97f4a7c15ull;
+        }
+    }
+
+    void AddNumber(uint64_t value)
+    {
+        uint8_t bytes[8];
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(value >> (i * 8));
+        }
+
+        AddBytes(bytes, sizeof(bytes));
+    }
+
+    void AddString(const std::string& value)
+    {
+        AddNumber(value.size());
+        AddBytes(value.data(), value.size());
+    }
+
+    ContentHash GetHash() const
+    {
+        ContentHash hash;
+        hash.Hash[0] = Mix(m_hash[0]);
+        hash.Hash[1] = Mix(m_hash[1] ^ m_hash[0]);
+        return hash;
+    }
+
+private:
+    static uint64_t Mix(uint64_t x)
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    uint64_t m_hash[2];
+};
@@ -12,10 +12,18 @@
 #include "stdafx.h"
 #include "D3D12MeshletRender.h"
 
-const wchar_t* D3D12MeshletRender::c_meshFilename = L".\\Assets\\Dragon_LOD0.bin";
+#include <DirectXPackedVector.h>
 
-const wchar_t* D3D12MeshletRender::c_meshShaderFilename = L"MeshletMS.cso";
-const wchar_t* D3D12MeshletRender::c_pixelShaderFilename = L"MeshletPS.cso";
+const wchar_t* D3D12MeshletRender::c_lodFilenames[] =
+{
+    L".\\Assets\\Dragon_LOD1.bin",
+    L".\\Assets\\Dragon_LOD2.bin",
+    L".\\Assets\\Dragon_LOD3.bin",
+    L".\\Assets\\Dragon_LOD4.bin",
+    L".\\Assets\\Dragon_LOD5.bin",
+};
+
+const wchar_t* D3D12MeshletRender::c_pipelineLibraryFilename = L"PipelineLibrary.bin";
 
 D3D12MeshletRender::D3D12MeshletRender(UINT width, UINT height, std::wstring name)
     : DXSample(width, height, name)
@@ -25,10 +33,24 @@ D3D12MeshletRender::D3D12MeshletRender(UINT width, UINT height, std::wstring nam
     , m_dsvDescriptorSize(0)
     , m_constantBufferData{}
     , m_cbvDataBegin(nullptr)
+    , m_drawRecordData(nullptr)
+    , m_uploadRing(DynamicBytesPerFrame * (FrameCount + 1))
+    , m_streamOut(StreamOutVertexCapacity, StreamOutPrimitiveCapacity, FrameCount)
+    , m_streamOutFlags{}
+    , m_streamOutResults{}
+    , m_streamOutSupported(false)
     , m_frameIndex(0)
     , m_frameCounter(0)
     , m_fenceEvent{}
     , m_fenceValues{}
+    , m_meshShaderCache([this](const std::string& source)
+        {
+            // Includes resolve next to MeshletMS.hlsl, which the generated source builds on.
+            return CompileShaderAsync(source, L"MeshletMS.Specialized.hlsl", L"main", L"ms_6_6");
+        })
+    , m_pipelineLibrary(c_pipelineLibraryFilename)
+    , m_timestampFrequency(0)
+    , m_pendingFrameTimes{}
 { }
 
 void D3D12MeshletRender::OnInit()
@@ -36,6 +58,19 @@ void D3D12MeshletRender::OnInit()
     m_camera.Init({ 0, 75, 150 });
     m_camera.SetMoveSpeed(150.0f);
 
+    if (IsHeadless())
+    {
+        // Step the same simulation times on every run, however long each frame takes.
+        m_timer.SetFixedTimeStep(true);
+        m_timer.SetTargetElapsedSeconds(1.0 / 60.0);
+        m_frameTimes.Reserve(GetHeadlessFrameCount());
+
+        if (!m_cameraPathFile.empty())
+        {
+            ThrowIfFailed(m_cameraPath.LoadFromFile(m_cameraPathFile.c_str()));
+        }
+    }
+
     LoadPipeline();
     LoadAssets();
 }
@@ -92,12 +127,12 @@ void D3D12MeshletRender::LoadPipeline()
             ));
     }
 
-    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_5 };
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_6 };
     if (FAILED(m_device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel)))
-        || (shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_5))
+        || (shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_6))
     {
-        OutputDebugStringA("ERROR: Shader Model 6.5 is not supported\n");
-        throw std::exception("Shader Model 6.5 is not supported");
+        OutputDebugStringA("ERROR: Shader Model 6.6 is not supported\n");
+        throw std::exception("Shader Model 6.6 is not supported");
     }
 
     D3D12_FEATURE_DATA_D3D12_OPTIONS7 features = {};
@@ -108,6 +143,20 @@ void D3D12MeshletRender::LoadPipeline()
         throw std::exception("Mesh Shaders aren't supported!");
     }
 
+    // Stream output reserves its room with a 64-bit atomic add on a root UAV, which needs 64-bit
+    // integer shader ops and a runtime that reports the Shader Model 6.6 atomics in OPTIONS9.
+    // Without them the mesh shader is compiled without stream output and 'O' does nothing.
+    D3D12_FEATURE_DATA_D3D12_OPTIONS1 options1 = {};
+    D3D12_FEATURE_DATA_D3D12_OPTIONS9 options9 = {};
+    m_streamOutSupported = SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS1, &options1, sizeof(options1)))
+        && options1.Int64ShaderOps
+        && SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS9, &options9, sizeof(options9)));
+    if (!m_streamOutSupported)
+    {
+        OutputDebugStringA("WARNING: 64-bit shader atomics aren't supported; stream output is disabled\n");
+        m_shaderDefines.push_back("STREAM_OUT=0");
+    }
+
     // Describe and create the command queue.
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
     queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
@@ -115,31 +164,34 @@ void D3D12MeshletRender::LoadPipeline()
 
     ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue)));
 
-    // Describe and create the swap chain.
-    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-    swapChainDesc.BufferCount = FrameCount;
-    swapChainDesc.Width = m_width;
-    swapChainDesc.Height = m_height;
-    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-    swapChainDesc.SampleDesc.Count = 1;
-
-    ComPtr<IDXGISwapChain1> swapChain;
-    ThrowIfFailed(factory->CreateSwapChainForHwnd(
-        m_commandQueue.Get(),        // Swap chain needs the queue so that it can force a flush on it.
-        Win32Application::GetHwnd(),
-        &swapChainDesc,
-        nullptr,
-        nullptr,
-        &swapChain
-        ));
+    // Describe and create the swap chain. Headless runs render offscreen and have none.
+    if (!IsHeadless())
+    {
+        DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+        swapChainDesc.BufferCount = FrameCount;
+        swapChainDesc.Width = m_width;
+        swapChainDesc.Height = m_height;
+        swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+        swapChainDesc.SampleDesc.Count = 1;
+
+        ComPtr<IDXGISwapChain1> swapChain;
+        ThrowIfFailed(factory->CreateSwapChainForHwnd(
+            m_commandQueue.Get(),        // Swap chain needs the queue so that it can force a flush on it.
+            Win32Application::GetHwnd(),
+            &swapChainDesc,
+            nullptr,
+            nullptr,
+            &swapChain
+            ));
 
-    // This sample does not support fullscreen transitions.
-    ThrowIfFailed(factory->MakeWindowAssociation(Win32Application::GetHwnd(), DXGI_MWA_NO_ALT_ENTER));
+        // This sample does not support fullscreen transitions.
+        ThrowIfFailed(factory->MakeWindowAssociation(Win32Application::GetHwnd(), DXGI_MWA_NO_ALT_ENTER));
 
-    ThrowIfFailed(swapChain.As(&m_swapChain));
-    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+        ThrowIfFailed(swapChain.As(&m_swapChain));
+        m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    }
 
     // Create descriptor heaps.
     {
@@ -161,9 +213,9 @@ void D3D12MeshletRender::LoadPipeline()
 
         m_dsvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 
-        // create dbg vtx output heap
+        // create dbg vtx output heap, which also holds the draw buffer SRVs
         D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-        heapDesc.NumDescriptors = 1; // You only need 1 UAV
+        heapDesc.NumDescriptors = 1 + FrameCount * DrawDescriptorsPerFrame; // 1 UAV, then each frame's SRVs
         heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
         heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE; // Needed for root descriptor tables
 
@@ -177,7 +229,26 @@ void D3D12MeshletRender::LoadPipeline()
         // Create a RTV and a command allocator for each frame.
         for (UINT n = 0; n < FrameCount; n++)
         {
-            ThrowIfFailed(m_swapChain->GetBuffer(n, IID_PPV_ARGS(&m_renderTargets[n])));
+            if (m_swapChain)
+            {
+                ThrowIfFailed(m_swapChain->GetBuffer(n, IID_PPV_ARGS(&m_renderTargets[n])));
+            }
+            else
+            {
+                // Offscreen targets start in the state back buffers are handed out in, so
+                // frames transition them the same way.
+                const CD3DX12_HEAP_PROPERTIES renderTargetHeapProps(D3D12_HEAP_TYPE_DEFAULT);
+                const CD3DX12_RESOURCE_DESC renderTargetDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, m_width, m_height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+                ThrowIfFailed(m_device->CreateCommittedResource(
+                    &renderTargetHeapProps,
+                    D3D12_HEAP_FLAG_NONE,
+                    &renderTargetDesc,
+                    D3D12_RESOURCE_STATE_PRESENT,
+                    nullptr,
+                    IID_PPV_ARGS(&m_renderTargets[n])));
+            }
+
             m_device->CreateRenderTargetView(m_renderTargets[n].Get(), nullptr, rtvHandle);
             rtvHandle.Offset(1, m_rtvDescriptorSize);
 
@@ -185,6 +256,29 @@ void D3D12MeshletRender::LoadPipeline()
         }
     }
 
+    // Timestamps bracketing each frame's command list, for headless runs' GPU times. Each frame
+    // in flight has its pair, read back when the frame's fence has completed.
+    if (IsHeadless())
+    {
+        D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+        queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        queryHeapDesc.Count = 2 * FrameCount;
+        ThrowIfFailed(m_device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_timestampHeap)));
+
+        const CD3DX12_HEAP_PROPERTIES readbackHeapProps(D3D12_HEAP_TYPE_READBACK);
+        const CD3DX12_RESOURCE_DESC readbackDesc = CD3DX12_RESOURCE_DESC::Buffer(queryHeapDesc.Count * sizeof(UINT64));
+
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &readbackHeapProps,
+            D3D12_HEAP_FLAG_NONE,
+            &readbackDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(&m_timestampReadback)));
+
+        ThrowIfFailed(m_commandQueue->GetTimestampFrequency(&m_timestampFrequency));
+    }
+
     // Create the depth stencil view.
     {
         D3D12_DEPTH_STENCIL_VIEW_DESC depthStencilDesc = {};
@@ -216,7 +310,7 @@ void D3D12MeshletRender::LoadPipeline()
 
     // Create the constant buffer.
     {
-        const UINT64 constantBufferSize = sizeof(SceneConstantBuffer) * FrameCount;
+        const UINT64 constantBufferSize = sizeof(SceneConstantBuffer) * SceneConstantBuffersPerFrame * FrameCount;
 
         const CD3DX12_HEAP_PROPERTIES constantBufferHeapProps(D3D12_HEAP_TYPE_UPLOAD);
         const CD3DX12_RESOURCE_DESC constantBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(constantBufferSize);
@@ -239,41 +333,259 @@ void D3D12MeshletRender::LoadPipeline()
         CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
         ThrowIfFailed(m_constantBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_cbvDataBegin)));
     }    
+
+    // Create the packed draw record buffer, kept mapped like the constant buffer.
+    {
+        const CD3DX12_HEAP_PROPERTIES recordBufferHeapProps(D3D12_HEAP_TYPE_UPLOAD);
+        const CD3DX12_RESOURCE_DESC recordBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(DrawRecordBytesPerFrame * FrameCount);
+
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &recordBufferHeapProps,
+            D3D12_HEAP_FLAG_NONE,
+            &recordBufferDesc,
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&m_drawRecordBuffer)));
+
+        NAME_D3D12_OBJECT(m_drawRecordBuffer);
+
+        CD3DX12_RANGE readRange(0, 0);
+        ThrowIfFailed(m_drawRecordBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_drawRecordData)));
+    }
+
+    // Frames in flight each get DynamicBytesPerFrame of the ring, less alignment. The frame
+    // more covers the bytes skipped when an allocation wraps, which stay held until the frame
+    // before it retires.
+    m_uploadRing.Create(m_device.Get());
+
+    m_streamOut.Create(m_device.Get());
+    m_constantBufferData.StreamOutVertexCapacity = m_streamOut.GetVertexCapacity();
+    m_constantBufferData.StreamOutPrimitiveCapacity = m_streamOut.GetPrimitiveCapacity();
+}
+
+// Builds the model on the CPU; its input layout decides which mesh shader permutation is used.
+void D3D12MeshletRender::LoadModel()
+{
+    std::vector<XMFLOAT3> positions = {
+        {-0.1f,  0.1f, 0.0f},
+        {0.0f,  0.3f, 0.0f},
+        {0.1f,  0.1f, 0.0f},
+        
+        // Triangle 2
+        {-0.1f, -0.1f, 0.0f},
+        {0.1f, -0.1f, 0.0f},
+        {0.0f,  0.1f, 0.0f},
+        
+        // Triangle 3
+        {-0.2f,  0.0f, 0.0f},
+        {-0.1f, -0.2f, 0.0f},
+        {0.0f,  0.0f, 0.0f}, };
+
+    // A D3D11-era vertex format: positions in slot 0 (W comes from the format default) and
+    // compact attributes in slot 1, the way the input assembler would consume them.
+    struct PackedAttributes
+    {
+        PackedVector::XMUDECN4  Normal;   // R10G10B10A2_UNORM
+        PackedVector::XMUBYTEN4 Color;    // R8G8B8A8_UNORM
+        PackedVector::XMHALF2   TexCoord; // R16G16_FLOAT
+    };
+
+    std::vector<PackedAttributes> attributes(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        attributes[i].Normal = PackedVector::XMUDECN4(0.5f, 0.5f, 1.0f, 0.0f);
+        attributes[i].Color = PackedVector::XMUBYTEN4(i % 3 == 0 ? 1.0f : 0.0f, i % 3 == 1 ? 1.0f : 0.0f, i % 3 == 2 ? 1.0f : 0.0f, 1.0f);
+        attributes[i].TexCoord = PackedVector::XMHALF2(positions[i].x + 0.5f, positions[i].y + 0.5f);
+    }
+
+    const D3D12_INPUT_ELEMENT_DESC inputElements[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,   0, 0,                            D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "NORMAL",   0, DXGI_FORMAT_R10G10B10A2_UNORM, 1, 0,                            D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM,    1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,      1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    };
+
+    const D3D12_INPUT_LAYOUT_DESC inputLayout = { inputElements, _countof(inputElements) };
+    const void* vertexBuffers[] = { positions.data(), attributes.data() };
+    const uint32_t vertexStrides[] = { sizeof(XMFLOAT3), sizeof(PackedAttributes) };
+
+    ThrowIfFailed(m_model.LoadFromVertexBuffers(inputLayout, vertexBuffers, vertexStrides, _countof(vertexBuffers), static_cast<uint32_t>(positions.size())));
+}
+
+// Queues the compile of the mesh shader drawing triangle lists of a vertex layout.
+ShaderTask D3D12MeshletRender::CompileMeshShader(const VertexLayout& layout)
+{
+    // Prefer a mesh shader specialized for the input layout; fall back to the generic one,
+    // which reads the layout from a constant buffer, for topologies without a permutation.
+    ShaderTask meshShader;
+    HRESULT hr = m_meshShaderCache.Compile(layout, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, meshShader);
+    if (hr == E_NOTIMPL)
+    {
+        // The generic mesh shader includes its vertex format decoder, generated from the same table as the CPU one.
+        ThrowIfFailed(WriteVertexFetchHlsl(L"VertexFetch.hlsli"));
+        meshShader = CompileShaderAsync(L"MeshletMS.hlsl", L"main", L"ms_6_6");
+    }
+    else
+    {
+        ThrowIfFailed(hr);
+    }
+
+    return meshShader;
+}
+
+// Queues the compiles of the shaders drawing the model and every LOD mesh, indexed by LOD then
+// mesh. Shaders built into the archive load from it; BuildShaderArchive() runs this too, so the
+// archive holds the same compiles.
+void D3D12MeshletRender::CompileShaders(ShaderTask& meshShader, std::vector<std::vector<ShaderTask>>& lodMeshShaders, ShaderTask& pixelShader)
+{
+    meshShader = CompileMeshShader(m_model.GetPrims().Layout);
+
+    lodMeshShaders.resize(m_lodGroup.GetLodCount());
+    for (uint32_t lod = 0; lod < m_lodGroup.GetLodCount(); ++lod)
+    {
+        const Model& model = m_lodGroup.GetLod(lod);
+        for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+        {
+            VertexLayout layout;
+            ThrowIfFailed(ResolveMeshLayout(model.GetMesh(m), layout));
+            lodMeshShaders[lod].push_back(CompileMeshShader(layout));
+        }
+    }
+
+    pixelShader = CompileShaderAsync(L"MeshletPS.hlsl", L"main", L"ps_6_5");
+}
+
+void D3D12MeshletRender::OnBuildShaders()
+{
+    LoadModel();
+    ThrowIfFailed(m_lodGroup.LoadFromFiles(c_lodFilenames, _countof(c_lodFilenames)));
+    ShaderTask meshShader;
+    std::vector<std::vector<ShaderTask>> lodMeshShaders;
+    ShaderTask pixelShader;
+    CompileShaders(meshShader, lodMeshShaders, pixelShader);
+}
+
+// The vertex layout of a mesh loaded from a file, with its offsets resolved.
+HRESULT D3D12MeshletRender::ResolveMeshLayout(const Mesh& mesh, VertexLayout& layout)
+{
+    return ResolveInputLayout(mesh.LayoutDesc, mesh.VertexStrides.data(), static_cast<uint32_t>(mesh.VertexStrides.size()), layout);
+}
+
+// Queues the creation of a pipeline state drawing with the root signature once its shaders
+// have compiled. Pipeline states compiled by earlier runs load from the library.
+ShaderJobSystem::Task<ComPtr<ID3D12PipelineState>> D3D12MeshletRender::CreatePipelineState(
+    const ComPtr<ID3DBlob>& signature,
+    const ShaderTask& meshShaderTask,
+    const ShaderTask& pixelShaderTask)
+{
+    D3DX12_MESH_SHADER_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature        = m_rootSignature.Get();
+    psoDesc.NumRenderTargets      = 1;
+    psoDesc.RTVFormats[0]         = m_renderTargets[0]->GetDesc().Format;
+    psoDesc.DSVFormat             = m_depthStencil->GetDesc().Format;
+    psoDesc.RasterizerState       = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);    // CW front; cull back
+    psoDesc.BlendState            = CD3DX12_BLEND_DESC(D3D12_DEFAULT);         // Opaque
+    psoDesc.DepthStencilState     = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT); // Less-equal depth test w/ writes; no stencil
+    psoDesc.SampleMask            = UINT_MAX;
+    psoDesc.SampleDesc            = DefaultSampleDesc();
+
+    PipelineLibrary* library = &m_pipelineLibrary;
+    return m_shaderJobs.Then<ComPtr<ID3D12PipelineState>>({ meshShaderTask.Job, pixelShaderTask.Job },
+        [library, psoDesc, signature, meshShaderTask, pixelShaderTask]() mutable
+        {
+            const std::vector<uint8_t>* meshShader = nullptr;
+            const std::vector<uint8_t>* pixelShader = nullptr;
+            ThrowIfFailed(GetShaderBytecode(meshShaderTask, &meshShader));
+            ThrowIfFailed(GetShaderBytecode(pixelShaderTask, &pixelShader));
+
+            psoDesc.MS = { meshShader->data(), meshShader->size() };
+            psoDesc.PS = { pixelShader->data(), pixelShader->size() };
+
+            ComPtr<ID3D12PipelineState> pipelineState;
+            ThrowIfFailed(library->CreatePipelineState(psoDesc, signature->GetBufferPointer(), signature->GetBufferSize(), &pipelineState));
+            return pipelineState;
+        });
+}
+
+// Creates the constant buffer holding a layout's VertexLayoutConstants, for the generic mesh
+// shader and the decoder.
+void D3D12MeshletRender::CreateVertexLayoutBuffer(const VertexLayout& layout, ComPtr<ID3D12Resource>& buffer)
+{
+    VertexLayoutConstants layoutConstants;
+    PackVertexLayout(layout, layoutConstants);
+
+    const CD3DX12_HEAP_PROPERTIES layoutHeapProps(D3D12_HEAP_TYPE_UPLOAD);
+    const CD3DX12_RESOURCE_DESC layoutDesc = CD3DX12_RESOURCE_DESC::Buffer(
+        (sizeof(layoutConstants) + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1) & ~(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1));
+
+    ThrowIfFailed(m_device->CreateCommittedResource(
+        &layoutHeapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &layoutDesc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&buffer)));
+
+    CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
+    void* layoutData = nullptr;
+    ThrowIfFailed(buffer->Map(0, &readRange, &layoutData));
+    memcpy(layoutData, &layoutConstants, sizeof(layoutConstants));
+    buffer->Unmap(0, nullptr);
 }
 
 // Load the sample assets.
 void D3D12MeshletRender::LoadAssets()
-{   
+{
+    // The model and LODs are loaded first so the mesh shaders can be specialized for their
+    // input layouts.
+    LoadModel();
+    ThrowIfFailed(m_lodGroup.LoadFromFiles(c_lodFilenames, _countof(c_lodFilenames)));
 
-    // Create the pipeline state, which includes compiling and loading shaders.
+    // Create the pipeline state. The shaders compile on the job system while the root signature
+    // is built, and the pipeline state is created once both have finished.
     {
-        
-        ComPtr<IDxcBlob> meshShaderBlob;
-        ComPtr<IDxcBlob> pixelShaderBlob;
+        ShaderTask meshShaderTask;
+        std::vector<std::vector<ShaderTask>> lodMeshShaderTasks;
+        ShaderTask pixelShaderTask;
+        CompileShaders(meshShaderTask, lodMeshShaderTasks, pixelShaderTask);
 
-        ThrowIfFailed(CompileShaderToBlob(L"MeshletMS.hlsl", L"main", L"ms_6_6", &meshShaderBlob));
-        ThrowIfFailed(CompileShaderToBlob(L"MeshletPS.hlsl", L"main", L"ps_6_5", &pixelShaderBlob));        
+        m_pipelineLibrary.Open(m_device.Get());
+
+        // Keys the pipeline state in the library along with the shaders.
+        ComPtr<ID3DBlob> signature;
 
         // Pull root signature from the precompiled mesh shader.
         //ThrowIfFailed(m_device->CreateRootSignature(0, meshShaderBlob->GetBufferPointer(), meshShaderBlob->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature)));
         {
            // 2. Define root parameters array (adjust size as needed)
-            CD3DX12_ROOT_PARAMETER rootParameters[4];
+            CD3DX12_ROOT_PARAMETER rootParameters[8];
 
             // 0 - CBV: Scene constant buffer (register b0)
             rootParameters[0].InitAsConstantBufferView(0);
 
-            // 1 - 32-bit constants (2 values, register b1)
-            rootParameters[1].InitAsConstants(2, 1);
+            // 1 - 32-bit constants: MeshDrawParams (register b1)
+            rootParameters[c_drawParamsRootIndex].InitAsConstants(sizeof(MeshDrawParams) / sizeof(uint32_t), 1);
 
-            // 2 - SRV: Vertex buffer (register t0)
-            rootParameters[2].InitAsShaderResourceView(0);
+            // 2 - Unbounded descriptor table of raw SRVs: packed draw records, then sets of one per
+            //     vertex slot and the index buffer (registers t0..)
+            CD3DX12_DESCRIPTOR_RANGE srvRange;
+            srvRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0);
+            rootParameters[c_drawBuffersRootIndex].InitAsDescriptorTable(1, &srvRange);
 
             // 3 - Descriptor table with UAV (register u0)
             CD3DX12_DESCRIPTOR_RANGE uavRange;
             uavRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0); // 1 UAV at register(u0)
             rootParameters[3].InitAsDescriptorTable(1, &uavRange);
 
+            // 4 - CBV: Vertex layout (register b2)
+            rootParameters[4].InitAsConstantBufferView(2);
+
+            // 5..7 - Root UAVs: stream output counters, vertices and indices (registers u1..u3)
+            rootParameters[c_streamOutRootIndex + 0].InitAsUnorderedAccessView(1);
+            rootParameters[c_streamOutRootIndex + 1].InitAsUnorderedAccessView(2);
+            rootParameters[c_streamOutRootIndex + 2].InitAsUnorderedAccessView(3);
+
             // 4. Create the root signature descriptor
             CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
             rootSignatureDesc.Init(_countof(rootParameters), rootParameters,
@@ -281,7 +593,6 @@ void D3D12MeshletRender::LoadAssets()
                 D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
             // 5. Serialize and create the root signature
-            ComPtr<ID3DBlob> signature;
             ComPtr<ID3DBlob> error;
             ThrowIfFailed(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1,
                 &signature, &error));
@@ -292,26 +603,36 @@ void D3D12MeshletRender::LoadAssets()
                 IID_PPV_ARGS(&m_rootSignature)));
         }
 
-        D3DX12_MESH_SHADER_PIPELINE_STATE_DESC psoDesc = {};
-        psoDesc.pRootSignature        = m_rootSignature.Get();
-        psoDesc.MS                    = { meshShaderBlob->GetBufferPointer(), meshShaderBlob->GetBufferSize() };
-        psoDesc.PS                    = { pixelShaderBlob->GetBufferPointer(), pixelShaderBlob->GetBufferSize() };
-        psoDesc.NumRenderTargets      = 1;
-        psoDesc.RTVFormats[0]         = m_renderTargets[0]->GetDesc().Format;
-        psoDesc.DSVFormat             = m_depthStencil->GetDesc().Format;
-        psoDesc.RasterizerState       = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);    // CW front; cull back
-        psoDesc.BlendState            = CD3DX12_BLEND_DESC(D3D12_DEFAULT);         // Opaque
-        psoDesc.DepthStencilState     = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT); // Less-equal depth test w/ writes; no stencil
-        psoDesc.SampleMask            = UINT_MAX;
-        psoDesc.SampleDesc            = DefaultSampleDesc();
+        // Every pipeline state compiles on the job system as its shaders finish.
+        auto pso = CreatePipelineState(signature, meshShaderTask, pixelShaderTask);
 
-        auto psoStream = CD3DX12_PIPELINE_MESH_STATE_STREAM(psoDesc);
+        std::vector<std::vector<ShaderJobSystem::Task<ComPtr<ID3D12PipelineState>>>> lodPsos(lodMeshShaderTasks.size());
+        for (size_t lod = 0; lod < lodMeshShaderTasks.size(); ++lod)
+        {
+            for (const ShaderTask& lodMeshShaderTask : lodMeshShaderTasks[lod])
+            {
+                lodPsos[lod].push_back(CreatePipelineState(signature, lodMeshShaderTask, pixelShaderTask));
+            }
+        }
 
-        D3D12_PIPELINE_STATE_STREAM_DESC streamDesc;
-        streamDesc.pPipelineStateSubobjectStream = &psoStream;
-        streamDesc.SizeInBytes                   = sizeof(psoStream);
+        // Rethrows whatever the job threw.
+        m_pipelineState = pso.Result.get();
 
-        ThrowIfFailed(m_device->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&m_pipelineState)));
+        m_lodMeshes.resize(lodPsos.size());
+        for (size_t lod = 0; lod < lodPsos.size(); ++lod)
+        {
+            m_lodMeshes[lod].resize(lodPsos[lod].size());
+            for (size_t m = 0; m < lodPsos[lod].size(); ++m)
+            {
+                m_lodMeshes[lod][m].PipelineState = lodPsos[lod][m].Result.get();
+            }
+        }
+
+        // A failed save only costs the next run its compiles.
+        if (FAILED(m_pipelineLibrary.Save()))
+        {
+            OutputDebugStringA("Failed to save the pipeline library.\n");
+        }
     }
 
     // Create the command list.
@@ -321,73 +642,76 @@ void D3D12MeshletRender::LoadAssets()
     // to record yet. The main loop expects it to be closed, so close it now.
     ThrowIfFailed(m_commandList->Close());
 
-    std::vector<XMFLOAT4> positions = {
-        {-0.1,  0.1, 0.0, 1.0},
-        {0.0,  0.3, 0.0 , 1.0},
-        {0.1,  0.1, 0.0 , 1.0},
-        
-        // Triangle 2
-        {-0.1, -0.1, 0.0, 1.0},
-        {0.1, -0.1, 0.0 , 1.0},
-        {0.0,  0.1, 0.0 , 1.0},
-        
-        // Triangle 3
-        {-0.2,  0.0, 0.0, 1.0},
-        {-0.1, -0.2, 0.0, 1.0},
-        {0.0,  0.0, 0.0 , 1.0}, };
-
-    m_model.LoadFromVtxBuffer(positions);
+    // The objects code recording through the RHI uses: the command list, once per frame's
+    // allocator, the draw heap and the buffers draws read from.
+    m_rhiDevice.reset(new D3D12RhiDevice(m_device.Get(), m_commandQueue.Get()));
+    for (UINT n = 0; n < FrameCount; n++)
+    {
+        m_rhiCommandLists[n].reset(new D3D12RhiCommandList(m_commandList.Get(), m_commandAllocators[n].Get()));
+    }
+    m_rhiDrawHeap.reset(new D3D12RhiDescriptorHeap(m_device.Get(), m_dbgVtxHeap.Get()));
+    m_rhiDrawRecordBuffer.reset(new D3D12RhiBuffer(m_drawRecordBuffer.Get(), RhiHeapType::Upload));
+    m_rhiUploadRing.reset(new D3D12RhiBuffer(m_uploadRing.GetResource(), RhiHeapType::Upload));
 
+    // Create the buffer the mesh shader writes its fetched elements to under -checkfetch, and
+    // the buffer they're read back through.
+    if (IsCheckingVertexFetch())
     {
-        // create dbg vtx buffer resources
-        {
-            const size_t dbgVtxSize = m_model.GetPrims().Vertices.size() * sizeof(m_model.GetPrims().Vertices[0]);
-            // create a UAV buffer to get mesh shader vertex output
-            D3D12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(dbgVtxSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
-            CD3DX12_HEAP_PROPERTIES heap1(D3D12_HEAP_TYPE_DEFAULT);
-            CD3DX12_HEAP_PROPERTIES heap2(D3D12_HEAP_TYPE_READBACK);
-
-            ThrowIfFailed(m_device->CreateCommittedResource(
-                &heap1,
-                D3D12_HEAP_FLAG_NONE,
-                &bufferDesc,
-                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, // Important!
-                nullptr,
-                IID_PPV_ARGS(&m_dbgVtxWriteBuffer)));
-
-            bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(dbgVtxSize);
-
-            // create a CPU readback buffer
-            ThrowIfFailed(m_device->CreateCommittedResource(
-                &heap2,
-                D3D12_HEAP_FLAG_NONE,
-                &bufferDesc,
-                D3D12_RESOURCE_STATE_COPY_DEST,
-                nullptr,
-                IID_PPV_ARGS(&m_dbgVtxReadbackBuffer)));
+        // One uint4 per decoded element per vertex.
+        const auto& prim = m_model.GetPrims();
+        const size_t dbgVtxSize = size_t(prim.VertexCount) * prim.Layout.Elements.size() * sizeof(uint32_t) * 4;
 
-        }
+        D3D12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(dbgVtxSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+        const CD3DX12_HEAP_PROPERTIES defaultHeapProps(D3D12_HEAP_TYPE_DEFAULT);
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &defaultHeapProps,
+            D3D12_HEAP_FLAG_NONE,
+            &bufferDesc,
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            nullptr,
+            IID_PPV_ARGS(&m_dbgVtxWriteBuffer)));
+
+        bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(dbgVtxSize);
+        const CD3DX12_HEAP_PROPERTIES readbackHeapProps(D3D12_HEAP_TYPE_READBACK);
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &readbackHeapProps,
+            D3D12_HEAP_FLAG_NONE,
+            &bufferDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(&m_dbgVtxReadbackBuffer)));
+
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_UNKNOWN;
+        uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = prim.VertexCount * static_cast<UINT>(prim.Layout.Elements.size());
+        uavDesc.Buffer.StructureByteStride = sizeof(uint32_t) * 4;
+        uavDesc.Buffer.CounterOffsetInBytes = 0;
+        uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
+        m_device->CreateUnorderedAccessView(m_dbgVtxWriteBuffer.Get(), nullptr, &uavDesc, m_dbgVtxHeap->GetCPUDescriptorHandleForHeapStart());
     }
 
-    m_model.UploadGpuResources(m_device.Get(), m_commandQueue.Get(), m_commandAllocators[m_frameIndex].Get(), m_commandList.Get());
+    ThrowIfFailed(m_modelBuffers.Upload(m_model, *m_rhiDevice, *m_rhiCommandLists[m_frameIndex]));
 
-#ifdef _DEBUG
-    // Mesh shader file expects a certain vertex layout; assert our mesh conforms to that layout.
-    const D3D12_INPUT_ELEMENT_DESC c_elementDescs[] =
-    {
-        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 1 },
-        //{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 1 },
-    };
+    CreateVertexLayoutBuffer(m_model.GetPrims().Layout, m_vertexLayoutBuffer);
 
+    // Upload each LOD's meshes, with the layout each is drawn with.
+    for (uint32_t lod = 0; lod < m_lodGroup.GetLodCount(); ++lod)
     {
-        auto& prim = m_model.GetPrims();
-        //assert(mesh.LayoutDesc.NumElements == 1);
+        const Model& model = m_lodGroup.GetLod(lod);
+        for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+        {
+            const Mesh& mesh = model.GetMesh(m);
+            LodMesh& lodMesh = m_lodMeshes[lod][m];
 
-        for (uint32_t i = 0; i < _countof(c_elementDescs); ++i)
-            std::memcmp(&prim.LayoutElems[i], &c_elementDescs[i], sizeof(D3D12_INPUT_ELEMENT_DESC));
+            ThrowIfFailed(lodMesh.Buffers.Upload(mesh, *m_rhiDevice, *m_rhiCommandLists[m_frameIndex]));
+            ThrowIfFailed(ResolveMeshLayout(mesh, lodMesh.Layout));
+            CreateVertexLayoutBuffer(lodMesh.Layout, lodMesh.LayoutBuffer);
+            lodMesh.IndexCount = mesh.IndexCount;
+        }
     }
-#endif
-    
+
     // Create synchronization objects and wait until assets have been uploaded to the GPU.
     {
         ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
@@ -410,13 +734,30 @@ void D3D12MeshletRender::LoadAssets()
 // Update frame-based values.
 void D3D12MeshletRender::OnUpdate()
 {
-    m_timer.Tick(NULL);
+    m_frameStartTime = std::chrono::steady_clock::now();
+
+    if (IsHeadless())
+    {
+        m_timer.TickFixed();
+    }
+    else
+    {
+        m_timer.Tick(NULL);
+    }
 
     if (m_frameCounter++ % 30 == 0)
     {
-        // Update window text with FPS value.
-        wchar_t fps[64];
-        swprintf_s(fps, L"%ufps", m_timer.GetFramesPerSecond());
+        // Update window text with FPS value, the worst frames of the last few seconds, the
+        // selected LOD and, while stream output is on, what the last capture held.
+        const FrameTimeStats frameTimes = m_timer.GetFrameTimeStats();
+
+        wchar_t fps[160];
+        int length = swprintf_s(fps, L"%ufps p99 %.1fms max %.1fms LOD%u", m_timer.GetFramesPerSecond(), frameTimes.P99, frameTimes.Max, m_lodGroup.GetCurrentLod() + 1);
+        if (m_constantBufferData.StreamOutFlags != 0 && length > 0)
+        {
+            swprintf_s(fps + length, _countof(fps) - length, L" SO %u/%u tris %u verts",
+                m_streamOutResults.PrimitivesWritten, m_streamOutResults.PrimitivesNeeded, m_streamOutResults.VertexCount);
+        }
         SetCustomWindowText(fps);
     }
 
@@ -427,13 +768,57 @@ void D3D12MeshletRender::OnUpdate()
     XMMATRIX view = XMMATRIX(g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2, g_XMIdentityR3);;
     //XMMATRIX proj = m_camera.GetProjectionMatrix(XM_PI / 3.0f, m_aspectRatio);
     XMMATRIX proj = XMMATRIX(g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2, g_XMIdentityR3);;
+    float fovY = XM_PI / 3.0f;
+
+    // The LODs are viewed through the camera, the test triangles as they are in clip space.
+    XMMATRIX lodView = m_camera.GetViewMatrix();
+    XMMATRIX lodProj = m_camera.GetProjectionMatrix(fovY, m_aspectRatio);
+
+    if (!m_cameraPath.IsEmpty())
+    {
+        const double time = m_timer.GetTotalSeconds();
+        view = m_cameraPath.GetViewMatrix(time);
+        proj = m_cameraPath.GetProjectionMatrix(time, m_aspectRatio);
+        fovY = m_cameraPath.Evaluate(time).FovY;
+        lodView = view;
+        lodProj = proj;
+    }
     
+    XMFLOAT4X4 worldView;
+    XMStoreFloat4x4(&worldView, world * lodView);
+    m_lodGroup.SelectLod(worldView, fovY, m_viewport.Height);
+
     XMStoreFloat4x4(&m_constantBufferData.World, XMMatrixTranspose(world));
     XMStoreFloat4x4(&m_constantBufferData.WorldView, XMMatrixTranspose(world * view));
     XMStoreFloat4x4(&m_constantBufferData.WorldViewProj, XMMatrixTranspose(world * view * proj));
     m_constantBufferData.DrawMeshlets = true;
+    m_constantBufferData.ViewportSize = XMFLOAT2(m_viewport.Width, m_viewport.Height);
 
-    memcpy(m_cbvDataBegin + sizeof(SceneConstantBuffer) * m_frameIndex, &m_constantBufferData, sizeof(m_constantBufferData));
+    UINT8* sceneData = m_cbvDataBegin + sizeof(SceneConstantBuffer) * SceneConstantBuffersPerFrame * m_frameIndex;
+    memcpy(sceneData, &m_constantBufferData, sizeof(m_constantBufferData));
+
+    // The LOD shares the triangles' settings, but never streams out.
+    SceneConstantBuffer lodConstantBufferData = m_constantBufferData;
+    XMStoreFloat4x4(&lodConstantBufferData.WorldView, XMMatrixTranspose(world * lodView));
+    XMStoreFloat4x4(&lodConstantBufferData.WorldViewProj, XMMatrixTranspose(world * lodView * lodProj));
+    lodConstantBufferData.StreamOutFlags = StreamOut::None;
+    memcpy(sceneData + sizeof(SceneConstantBuffer), &lodConstantBufferData, sizeof(lodConstantBufferData));
+}
+
+// Wave the model's positions, as cloth or particle ribbons would be animated on the CPU. Each
+// position is written once and never read back, since the ring is write-combined memory.
+void D3D12MeshletRender::AnimatePositions(XMFLOAT3* positions) const
+{
+    const auto& prim = m_model.GetPrims();
+    const XMFLOAT3* source = reinterpret_cast<const XMFLOAT3*>(prim.Vertices[0].data());
+    const float time = static_cast<float>(m_timer.GetTotalSeconds());
+
+    for (uint32_t v = 0; v < prim.VertexCount; ++v)
+    {
+        XMFLOAT3 position = source[v];
+        position.y += 0.02f * XMScalarSin(2.0f * time + position.x * 20.0f);
+        positions[v] = position;
+    }
 }
 
 // Render the scene.
@@ -445,54 +830,28 @@ void D3D12MeshletRender::OnRender()
     ID3D12CommandList* cmdLists[] = { m_commandList.Get() };
     m_commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
 
-    // 3. Wait for GPU to finish execution before reading
-    WaitForGpu();
+    // The frame's CPU time runs from its update through submission.
+    const double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_frameStartTime).count();
 
-    // Copy dbg Vtx data From GPU to Readback Buffer        
+    // The frame's times are recorded once it completes, when its slot comes around again.
+    if (IsHeadless())
     {
-        // 4. Start a new command list for copy
-        ThrowIfFailed(m_commandAllocators[m_frameIndex]->Reset());
-
-        // However, when ExecuteCommandList() is called on a particular command 
-        // list, that command list can then be reset at any time and must be before 
-        // re-recording.
-        ThrowIfFailed(m_commandList->Reset(m_commandAllocators[m_frameIndex].Get(), m_pipelineState.Get()));
-
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_dbgVtxWriteBuffer.Get(),
-            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-            D3D12_RESOURCE_STATE_COPY_SOURCE);
-        m_commandList->ResourceBarrier(1, &barrier);
-
-        m_commandList->CopyResource(m_dbgVtxReadbackBuffer.Get(), m_dbgVtxWriteBuffer.Get());        
+        m_pendingFrameTimes[m_frameIndex].TimeSeconds = m_timer.GetTotalSeconds();
+        m_pendingFrameTimes[m_frameIndex].CpuMs = cpuMs;
+        m_pendingFrameTimes[m_frameIndex].Pending = true;
     }
 
-    // Execute the command list.
-    // 7. Close and execute
-    ThrowIfFailed(m_commandList->Close());
-    ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
-
+    // The first frame's fetched elements are checked once; later frames fetch the same way.
+    if (IsCheckingVertexFetch() && m_frameCounter == 1)
     {
-        WaitForGpu();
-
-        void* pData = nullptr;
-        CD3DX12_RANGE readRange(0, m_model.GetPrims().VertexCount * sizeof(DirectX::XMFLOAT4));
-        m_dbgVtxReadbackBuffer->Map(0, &readRange, &pData);
-
-        // Cast and print
-        DirectX::XMFLOAT4* debugData = reinterpret_cast<DirectX::XMFLOAT4*>(pData);
-        for (int i = 0; i < m_model.GetPrims().VertexCount; ++i)
-        {
-            std::cout << "Pos: " << debugData[i].x << ", "
-                << debugData[i].y << ", "
-                << debugData[i].z << ", "
-                << debugData[i].w << std::endl;
-        }
-        m_dbgVtxReadbackBuffer->Unmap(0, nullptr);
+        CheckVertexFetch();
     }
 
     // Present the frame.
-    ThrowIfFailed(m_swapChain->Present(1, 0));
+    if (m_swapChain)
+    {
+        ThrowIfFailed(m_swapChain->Present(1, 0));
+    }
 
     MoveToNextFrame();
 }
@@ -504,10 +863,132 @@ void D3D12MeshletRender::OnDestroy()
     WaitForGpu();
 
     CloseHandle(m_fenceEvent);
+
+    if (IsHeadless())
+    {
+        // Every frame has completed; record those still in flight, oldest first.
+        for (UINT n = 0; n < FrameCount; n++)
+        {
+            RecordFrameTimes((m_frameIndex + n) % FrameCount);
+        }
+
+        if (FAILED(m_frameTimes.WriteCsv(m_frameTimesFile.c_str())))
+        {
+            std::wcerr << L"Failed to write the frame times to " << m_frameTimesFile << std::endl;
+        }
+
+        const FrameTimeStats cpu = m_frameTimes.GetCpuStats();
+        const FrameTimeStats gpu = m_frameTimes.GetGpuStats();
+        std::cout << m_frameTimes.GetFrameCount() << " frames; CPU p50 " << cpu.P50 << " p95 " << cpu.P95 << " p99 " << cpu.P99
+            << " ms; GPU p50 " << gpu.P50 << " p95 " << gpu.P95 << " p99 " << gpu.P99 << " ms" << std::endl;
+    }
+}
+
+// Records the times of the frame pending in a slot, reading back the timestamps bracketing its
+// command list. The frame's fence must have completed.
+void D3D12MeshletRender::RecordFrameTimes(UINT slot)
+{
+    PendingFrameTimes& frame = m_pendingFrameTimes[slot];
+    if (!frame.Pending)
+        return;
+
+    UINT64* timestamps = nullptr;
+    const CD3DX12_RANGE readRange(2 * slot * sizeof(UINT64), 2 * (slot + 1) * sizeof(UINT64));
+    ThrowIfFailed(m_timestampReadback->Map(0, &readRange, reinterpret_cast<void**>(&timestamps)));
+
+    const UINT64* frameTimestamps = timestamps + 2 * slot;
+    const double gpuMs = 1000.0 * static_cast<double>(frameTimestamps[1] - frameTimestamps[0]) / static_cast<double>(m_timestampFrequency);
+
+    const CD3DX12_RANGE writeRange(0, 0);
+    m_timestampReadback->Unmap(0, &writeRange);
+
+    m_frameTimes.Record(frame.TimeSeconds, frame.CpuMs, gpuMs);
+    frame.Pending = false;
+}
+
+// Reads back the elements the frame's mesh shader fetched and compares them with the CPU
+// decoder bit for bit, printing the first mismatches and a summary.
+void D3D12MeshletRender::CheckVertexFetch()
+{
+    WaitForGpu();
+
+    ThrowIfFailed(m_commandAllocators[m_frameIndex]->Reset());
+    ThrowIfFailed(m_commandList->Reset(m_commandAllocators[m_frameIndex].Get(), m_pipelineState.Get()));
+
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_dbgVtxWriteBuffer.Get(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    m_commandList->ResourceBarrier(1, &barrier);
+    m_commandList->CopyResource(m_dbgVtxReadbackBuffer.Get(), m_dbgVtxWriteBuffer.Get());
+
+    barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_dbgVtxWriteBuffer.Get(),
+        D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    m_commandList->ResourceBarrier(1, &barrier);
+
+    ThrowIfFailed(m_commandList->Close());
+    ID3D12CommandList* cmdLists[] = { m_commandList.Get() };
+    m_commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+    WaitForGpu();
+
+    const auto& prim = m_model.GetPrims();
+    const uint32_t elementCount = static_cast<uint32_t>(prim.Layout.Elements.size());
+
+    void* pData = nullptr;
+    const CD3DX12_RANGE readRange(0, size_t(prim.VertexCount) * elementCount * sizeof(uint32_t) * 4);
+    ThrowIfFailed(m_dbgVtxReadbackBuffer->Map(0, &readRange, &pData));
+
+    // Slot 0 was drawn from the frame's animated positions, animated again here since the
+    // ring holding them can't be read.
+    std::vector<XMFLOAT3> animatedPositions(prim.VertexCount);
+    AnimatePositions(animatedPositions.data());
+
+    const uint8_t* buffers[c_maxVertexSlots] = {};
+    for (uint32_t slot = 0; slot < prim.Vertices.size(); ++slot)
+    {
+        buffers[slot] = prim.Vertices[slot].data();
+    }
+    buffers[0] = reinterpret_cast<const uint8_t*>(animatedPositions.data());
+
+    const uint32_t* debugData = reinterpret_cast<const uint32_t*>(pData);
+    uint32_t mismatches = 0;
+    for (uint32_t v = 0; v < prim.VertexCount; ++v)
+    {
+        for (uint32_t e = 0; e < elementCount; ++e)
+        {
+            uint32_t expected[4];
+            FetchVertexElement(prim.Layout, e, buffers, v, 0, 0, expected);
+
+            const uint32_t* actual = debugData + (size_t(v) * elementCount + e) * 4;
+            if (memcmp(expected, actual, sizeof(expected)) != 0 && mismatches++ < 8)
+            {
+                std::cout << "Vertex " << v << " " << prim.LayoutElems[e].SemanticName << std::hex
+                    << ": GPU " << actual[0] << ", " << actual[1] << ", " << actual[2] << ", " << actual[3]
+                    << " CPU " << expected[0] << ", " << expected[1] << ", " << expected[2] << ", " << expected[3]
+                    << std::dec << std::endl;
+            }
+        }
+    }
+
+    const CD3DX12_RANGE writeRange(0, 0);
+    m_dbgVtxReadbackBuffer->Unmap(0, &writeRange);
+
+    std::cout << "Vertex fetch: " << mismatches << " of " << prim.VertexCount * elementCount
+        << " elements differ from the CPU decoder" << std::endl;
 }
 
 void D3D12MeshletRender::OnKeyDown(UINT8 key)
 {
+    // Toggle mesh shader primitive culling.
+    if (key == 'C')
+    {
+        m_constantBufferData.CullFlags = m_constantBufferData.CullFlags ? PrimitiveCull::None : PrimitiveCull::All;
+    }
+
+    // Toggle capturing the model's triangles, in world space, with stream output.
+    if (key == 'O' && m_streamOutSupported)
+    {
+        m_constantBufferData.StreamOutFlags = m_constantBufferData.StreamOutFlags ? StreamOut::None : (StreamOut::Enabled | StreamOut::Indexed | StreamOut::WorldSpace);
+    }
+
     m_camera.OnKeyDown(key);
 }
 
@@ -528,11 +1009,23 @@ void D3D12MeshletRender::PopulateCommandList()
     // re-recording.
     ThrowIfFailed(m_commandList->Reset(m_commandAllocators[m_frameIndex].Get(), m_pipelineState.Get()));
 
+    // The frame that last used this slot has completed, so its timestamps can be read before
+    // they're overwritten.
+    if (m_timestampHeap)
+    {
+        RecordFrameTimes(m_frameIndex);
+    }
+
     // Set necessary state.
     m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
     m_commandList->RSSetViewports(1, &m_viewport);
     m_commandList->RSSetScissorRects(1, &m_scissorRect);
 
+    if (m_timestampHeap)
+    {
+        m_commandList->EndQuery(m_timestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * m_frameIndex);
+    }
+
     // Indicate that the back buffer will be used as a render target.
     const auto toRenderTargetBarrier = CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
     m_commandList->ResourceBarrier(1, &toRenderTargetBarrier);
@@ -546,47 +1039,118 @@ void D3D12MeshletRender::PopulateCommandList()
     m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
     m_commandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
-    m_commandList->SetGraphicsRootConstantBufferView(0, m_constantBuffer->GetGPUVirtualAddress() + sizeof(SceneConstantBuffer) * m_frameIndex);
+    const D3D12_GPU_VIRTUAL_ADDRESS sceneAddress = m_constantBuffer->GetGPUVirtualAddress() + sizeof(SceneConstantBuffer) * SceneConstantBuffersPerFrame * m_frameIndex;
+    m_commandList->SetGraphicsRootConstantBufferView(0, sceneAddress);
 
     auto& prim = m_model.GetPrims();
     {
-        m_commandList->SetGraphicsRoot32BitConstant(1, prim.IndexSize, 0);
-        m_commandList->SetGraphicsRootShaderResourceView(2, prim.VertexResources[0]->GetGPUVirtualAddress());
+        m_commandList->SetGraphicsRootConstantBufferView(4, m_vertexLayoutBuffer->GetGPUVirtualAddress());
 
-        m_commandList->SetGraphicsRoot32BitConstant(1, 0, 1);
+        ID3D12DescriptorHeap* heaps[] = { m_dbgVtxHeap.Get() };
+        m_commandList->SetDescriptorHeaps(1, heaps);
 
-        // setup debug
+        // Only shaders compiled with CHECK_VERTEX_FETCH declare the debug UAV.
+        if (IsCheckingVertexFetch())
         {
-            // create UAV
-            D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-            uavDesc.Format = DXGI_FORMAT_UNKNOWN;
-            uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
-            uavDesc.Buffer.FirstElement = 0;
-            uavDesc.Buffer.NumElements = prim.Vertices.size();
-            uavDesc.Buffer.StructureByteStride = sizeof(prim.Vertices[0]);
-            uavDesc.Buffer.CounterOffsetInBytes = 0;
-            uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
-
-            m_device->CreateUnorderedAccessView(
-                m_dbgVtxWriteBuffer.Get(), 
-                nullptr, 
-                &uavDesc,
-                m_dbgVtxHeap->GetCPUDescriptorHandleForHeapStart());
-
-            ID3D12DescriptorHeap* heaps[] = { m_dbgVtxHeap.Get() };
-            m_commandList->SetDescriptorHeaps(1, heaps);
-
             m_commandList->SetGraphicsRootDescriptorTable(3, m_dbgVtxHeap->GetGPUDescriptorHandleForHeapStart());
-            
         }
-        
-        m_commandList->DispatchMesh(prim.Vertices.size(), 1, 1);        
+
+        // Draw through the input assembler API, the way a ported renderer would.
+        RhiDrawTarget drawTarget(
+            m_rhiCommandLists[m_frameIndex].get(),
+            m_rhiDrawHeap.get(), 1 + m_frameIndex * DrawDescriptorsPerFrame, DrawDescriptorsPerFrame,
+            m_rhiDrawRecordBuffer.get(), m_drawRecordData, m_frameIndex * DrawRecordBytesPerFrame, DrawRecordBytesPerFrame);
+        for (const auto& buffer : m_modelBuffers.GetVertexBuffers())
+        {
+            drawTarget.RegisterBuffer(buffer.get());
+        }
+        drawTarget.RegisterBuffer(m_modelBuffers.GetIndexBuffer());
+        drawTarget.RegisterBuffer(m_rhiUploadRing.get());
+
+        // Positions are animated straight into this frame's slice of the upload ring. Memory of
+        // frames the GPU has finished with is reused.
+        m_uploadRing.Reclaim(m_fence->GetCompletedValue());
+
+        const UINT positionsSize = static_cast<UINT>(prim.Vertices[0].size());
+        const UploadAllocation positions = m_uploadRing.Allocate(positionsSize, 16);
+        AnimatePositions(reinterpret_cast<XMFLOAT3*>(positions.Data));
+
+        std::vector<D3D12_VERTEX_BUFFER_VIEW> vertexBuffers = m_modelBuffers.GetVertexBufferViews();
+        vertexBuffers[0].BufferLocation = positions.GpuAddress;
+        vertexBuffers[0].SizeInBytes = positionsSize;
+
+        // Read back what this slot captured FrameCount frames ago, then capture into it anew.
+        if (m_streamOutFlags[m_frameIndex] != 0)
+        {
+            m_streamOut.Read(m_frameIndex, m_streamOutFlags[m_frameIndex], 3, m_streamOutResults);
+        }
+
+        m_streamOutFlags[m_frameIndex] = m_constantBufferData.StreamOutFlags;
+        if (m_streamOutFlags[m_frameIndex] != 0)
+        {
+            m_streamOut.Begin(m_commandList.Get());
+        }
+        m_streamOut.Bind(m_commandList.Get());
+
+        FixedFunctionContext context(drawTarget);
+        context.SetVertexLayout(prim.Layout);
+        context.IASetVertexBuffers(0, static_cast<uint32_t>(vertexBuffers.size()), vertexBuffers.data());
+        context.IASetIndexBuffer(&m_modelBuffers.GetIndexBufferView());
+        context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        // One draw per triangle, as a UI or decal pass would issue them; the batch packs them
+        // into a single group.
+        context.BeginDrawBatch(PackMode::InOrder);
+        for (uint32_t first = 0; first + 3 <= prim.IndexCount; first += 3)
+        {
+            context.DrawIndexedInstanced(3, 1, first, 0, 0);
+        }
+        context.EndDrawBatch();
+
+        if (m_streamOutFlags[m_frameIndex] != 0)
+        {
+            m_streamOut.End(m_commandList.Get(), m_frameIndex);
+        }
+
+        // Then the selected LOD's meshes, each with its layout's mesh shader. They're left out
+        // of the frame whose fetched elements -checkfetch compares, as they'd overwrite them.
+        if (!IsCheckingVertexFetch() || m_frameCounter != 1)
+        {
+            m_commandList->SetGraphicsRootConstantBufferView(0, sceneAddress + sizeof(SceneConstantBuffer));
+            for (const LodMesh& lodMesh : m_lodMeshes[m_lodGroup.GetCurrentLod()])
+            {
+                for (const auto& buffer : lodMesh.Buffers.GetVertexBuffers())
+                {
+                    drawTarget.RegisterBuffer(buffer.get());
+                }
+                drawTarget.RegisterBuffer(lodMesh.Buffers.GetIndexBuffer());
+
+                m_commandList->SetPipelineState(lodMesh.PipelineState.Get());
+                m_commandList->SetGraphicsRootConstantBufferView(4, lodMesh.LayoutBuffer->GetGPUVirtualAddress());
+
+                const std::vector<D3D12_VERTEX_BUFFER_VIEW>& lodVertexBuffers = lodMesh.Buffers.GetVertexBufferViews();
+
+                FixedFunctionContext lodContext(drawTarget);
+                lodContext.SetVertexLayout(lodMesh.Layout);
+                lodContext.IASetVertexBuffers(0, static_cast<uint32_t>(lodVertexBuffers.size()), lodVertexBuffers.data());
+                lodContext.IASetIndexBuffer(&lodMesh.Buffers.GetIndexBufferView());
+                lodContext.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                lodContext.DrawIndexedInstanced(lodMesh.IndexCount, 1, 0, 0, 0);
+            }
+        }
     }
 
     // Indicate that the back buffer will now be used to present.
     const auto toPresentBarrier = CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
     m_commandList->ResourceBarrier(1, &toPresentBarrier);
 
+    if (m_timestampHeap)
+    {
+        m_commandList->EndQuery(m_timestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * m_frameIndex + 1);
+        m_commandList->ResolveQueryData(m_timestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * m_frameIndex, 2,
+            m_timestampReadback.Get(), 2 * m_frameIndex * sizeof(UINT64));
+    }
+
     ThrowIfFailed(m_commandList->Close());
 }
 
@@ -610,9 +1174,10 @@ void D3D12MeshletRender::MoveToNextFrame()
     // Schedule a Signal command in the queue.
     const UINT64 currentFenceValue = m_fenceValues[m_frameIndex];
     ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), currentFenceValue));
+    m_uploadRing.FinishFrame(currentFenceValue);
 
-    // Update the frame index.
-    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    // Update the frame index. Without a swap chain the offscreen targets are used in turn.
+    m_frameIndex = m_swapChain ? m_swapChain->GetCurrentBackBufferIndex() : (m_frameIndex + 1) % FrameCount;
 
     // If the next frame is not ready to be rendered yet, wait until it is ready.
     if (m_fence->GetCompletedValue() < m_fenceValues[m_frameIndex])
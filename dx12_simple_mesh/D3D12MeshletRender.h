@@ -13,8 +13,21 @@
 
 #include "DXSample.h"
 #include "Model.h"
+#include "ModelBuffers.h"
+#include "MeshShaderPermutation.h"
+#include "D3D12Rhi.h"
+#include "RhiDrawTarget.h"
+#include "LodGroup.h"
 #include "StepTimer.h"
 #include "SimpleCamera.h"
+#include "PrimitiveCulling.h"
+#include "UploadRing.h"
+#include "StreamOutBuffer.h"
+#include "PipelineLibrary.h"
+#include "CameraPath.h"
+#include "FrameTimeLog.h"
+
+#include <chrono>
 
 using namespace DirectX;
 
@@ -36,9 +49,20 @@ public:
     virtual void OnDestroy();
     virtual void OnKeyDown(UINT8 key);
     virtual void OnKeyUp(UINT8 key);
+    virtual void OnBuildShaders();
+
+    // The last stream output capture read back, which the window title also summarizes.
+    // Empty until a capture has completed.
+    const StreamOutResults& GetStreamOutResults() const { return m_streamOutResults; }
 
 private:
     static const UINT FrameCount = 2;
+    static const UINT SceneConstantBuffersPerFrame = 2;     // The test triangles', then the LOD's
+    static const UINT DrawDescriptorsPerFrame = 4096;
+    static const UINT DrawRecordBytesPerFrame = 256 * 1024; // Packed draw records of each frame's batches
+    static const UINT DynamicBytesPerFrame = 64 * 1024;     // Vertices the CPU writes each frame
+    static const UINT StreamOutVertexCapacity = 256 * 1024;
+    static const UINT StreamOutPrimitiveCapacity = 128 * 1024;
 
     _declspec(align(256u)) struct SceneConstantBuffer
     {
@@ -46,6 +70,11 @@ private:
         XMFLOAT4X4 WorldView;
         XMFLOAT4X4 WorldViewProj;
         uint32_t   DrawMeshlets;
+        uint32_t   CullFlags;    // PrimitiveCull::EFlags applied per-primitive in the mesh shader
+        XMFLOAT2   ViewportSize;
+        uint32_t   StreamOutFlags; // StreamOut::EFlags of the geometry the mesh shader captures
+        uint32_t   StreamOutVertexCapacity;
+        uint32_t   StreamOutPrimitiveCapacity;
     };
 
     // Pipeline objects.
@@ -63,9 +92,11 @@ private:
     ComPtr<ID3D12PipelineState> m_pipelineState;
     ComPtr<ID3D12Resource> m_constantBuffer;
 
-    ComPtr<ID3D12DescriptorHeap> m_dbgVtxHeap;
-    ComPtr<ID3D12Resource>       m_dbgVtxWriteBuffer;
+    ComPtr<ID3D12DescriptorHeap> m_dbgVtxHeap;           // Debug UAV followed by each frame's draw buffer SRVs
+    ComPtr<ID3D12Resource>       m_dbgVtxWriteBuffer;    // Elements the mesh shader fetched; -checkfetch only
     ComPtr<ID3D12Resource>       m_dbgVtxReadbackBuffer;
+    ComPtr<ID3D12Resource>       m_vertexLayoutBuffer;   // VertexLayoutConstants of the model's input layout
+    ComPtr<ID3D12Resource>       m_drawRecordBuffer;     // Each frame's packed draw records, persistently mapped
 
     UINT m_rtvDescriptorSize;
     UINT m_dsvDescriptorSize;
@@ -73,11 +104,42 @@ private:
     ComPtr<ID3D12GraphicsCommandList6> m_commandList;
     SceneConstantBuffer m_constantBufferData;
     UINT8* m_cbvDataBegin;
+    UINT8* m_drawRecordData;
+
+    // Animated vertices are written to the ring each frame.
+    UploadRing m_uploadRing;
+
+    // Captures each frame's transformed geometry while stream output is on. A frame's capture
+    // is read back when its slot comes around again, by which time its fence has completed.
+    StreamOutBuffer m_streamOut;
+    uint32_t m_streamOutFlags[FrameCount]; // Of the capture pending in each readback slot, or 0
+    StreamOutResults m_streamOutResults;
+    bool m_streamOutSupported; // The device has the 64-bit atomics MeshletMS.hlsl reserves room with
 
     StepTimer m_timer;
     SimpleCamera m_camera;
     Model m_model;
+    ModelBuffers m_modelBuffers;
+    LodGroup m_lodGroup;
+
+    // The GPU copy of each LOD's meshes, indexed by LOD then mesh, with what each is drawn with.
+    struct LodMesh
+    {
+        ModelBuffers                Buffers;
+        VertexLayout                Layout;
+        ComPtr<ID3D12Resource>      LayoutBuffer;   // VertexLayoutConstants of Layout
+        ComPtr<ID3D12PipelineState> PipelineState;  // With the mesh shader specialized for Layout
+        uint32_t                    IndexCount;
+    };
+    std::vector<std::vector<LodMesh>> m_lodMeshes;
     
+    // RHI wrappers of the device objects above.
+    std::unique_ptr<D3D12RhiDevice> m_rhiDevice;
+    std::unique_ptr<D3D12RhiCommandList> m_rhiCommandLists[FrameCount];
+    std::unique_ptr<D3D12RhiDescriptorHeap> m_rhiDrawHeap;
+    std::unique_ptr<D3D12RhiBuffer> m_rhiDrawRecordBuffer;
+    std::unique_ptr<D3D12RhiBuffer> m_rhiUploadRing;
+
     // Synchronization objects.
     UINT m_frameIndex;
     UINT m_frameCounter;
@@ -85,14 +147,49 @@ private:
     ComPtr<ID3D12Fence> m_fence;
     UINT64 m_fenceValues[FrameCount];
 
+    // Mesh shaders specialized per input layout, compiled on first use.
+    MeshShaderCache m_meshShaderCache;
+
+    // Pipeline states compiled by earlier runs on this adapter and driver.
+    PipelineLibrary m_pipelineLibrary;
+
+    // Headless runs: the camera path flown, each frame's times, and the timestamps bracketing
+    // each frame's command list, resolved to a readback buffer with a pair per frame in flight.
+    // A frame's times are recorded when its slot comes around again, without waiting on the GPU.
+    struct PendingFrameTimes
+    {
+        double TimeSeconds;
+        double CpuMs;
+        bool   Pending;
+    };
+
+    CameraPath m_cameraPath;
+    FrameTimeLog m_frameTimes;
+    std::chrono::steady_clock::time_point m_frameStartTime;
+    ComPtr<ID3D12QueryHeap> m_timestampHeap;
+    ComPtr<ID3D12Resource> m_timestampReadback;
+    UINT64 m_timestampFrequency;
+    PendingFrameTimes m_pendingFrameTimes[FrameCount];
+
     void LoadPipeline();
+    void LoadModel();
+    ShaderTask CompileMeshShader(const VertexLayout& layout);
+    void CompileShaders(ShaderTask& meshShader, std::vector<std::vector<ShaderTask>>& lodMeshShaders, ShaderTask& pixelShader);
+    static HRESULT ResolveMeshLayout(const Mesh& mesh, VertexLayout& layout);
+    ShaderJobSystem::Task<ComPtr<ID3D12PipelineState>> CreatePipelineState(
+        const ComPtr<ID3DBlob>& signature,
+        const ShaderTask& meshShaderTask,
+        const ShaderTask& pixelShaderTask);
+    void CreateVertexLayoutBuffer(const VertexLayout& layout, ComPtr<ID3D12Resource>& buffer);
     void LoadAssets();
     void PopulateCommandList();
     void MoveToNextFrame();
     void WaitForGpu();
+    void RecordFrameTimes(UINT slot);
+    void CheckVertexFetch();
+    void AnimatePositions(XMFLOAT3* positions) const;
 
 private:
-    static const wchar_t* c_meshFilename;
-    static const wchar_t* c_meshShaderFilename;
-    static const wchar_t* c_pixelShaderFilename;
+    static const wchar_t* c_lodFilenames[];
+    static const wchar_t* c_pipelineLibraryFilename;
 };
@@ -0,0 +1,281 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "stdafx.h"
+#include "D3D12Rhi.h"
+
+#include "DXSampleHelper.h"
+
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+D3D12_RESOURCE_STATES GetD3D12ResourceState(RhiBufferState::EType state)
+{
+    switch (state)
+    {
+    case RhiBufferState::CopyDest:        return D3D12_RESOURCE_STATE_COPY_DEST;
+    case RhiBufferState::CopySource:      return D3D12_RESOURCE_STATE_COPY_SOURCE;
+    case RhiBufferState::ShaderResource:  return D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    case RhiBufferState::UnorderedAccess: return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    case RhiBufferState::GenericRead:     return D3D12_RESOURCE_STATE_GENERIC_READ;
+    default:                              return D3D12_RESOURCE_STATE_COMMON;
+    }
+}
+
+D3D12RhiBuffer::D3D12RhiBuffer(ID3D12Resource* resource, RhiHeapType::EType heap)
+    : m_resource(resource)
+    , m_heap(heap)
+    , m_size(resource->GetDesc().Width)
+    , m_gpuAddress(resource->GetGPUVirtualAddress())
+{ }
+
+void* D3D12RhiBuffer::Map()
+{
+    // The CPU doesn't read upload buffers, nor write readback ones.
+    const CD3DX12_RANGE noRange(0, 0);
+
+    void* data = nullptr;
+    ThrowIfFailed(m_resource->Map(0, m_heap == RhiHeapType::Upload ? &noRange : nullptr, &data));
+    return data;
+}
+
+void D3D12RhiBuffer::Unmap()
+{
+    const CD3DX12_RANGE noRange(0, 0);
+    m_resource->Unmap(0, m_heap == RhiHeapType::Readback ? &noRange : nullptr);
+}
+
+D3D12RhiDescriptorHeap::D3D12RhiDescriptorHeap(ID3D12Device* device, ID3D12DescriptorHeap* heap)
+    : m_device(device)
+    , m_heap(heap)
+    , m_descriptorCount(heap->GetDesc().NumDescriptors)
+    , m_descriptorSize(device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV))
+{ }
+
+void D3D12RhiDescriptorHeap::CreateRawBufferView(uint32_t index, RhiBuffer* buffer, uint64_t firstDword, uint32_t dwordCount)
+{
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+    srvDesc.Buffer.FirstElement = firstDword;
+    srvDesc.Buffer.NumElements = dwordCount;
+
+    ID3D12Resource* resource = buffer ? static_cast<D3D12RhiBuffer*>(buffer)->GetResource() : nullptr;
+    const CD3DX12_CPU_DESCRIPTOR_HANDLE handle(m_heap->GetCPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+
+    m_device->CreateShaderResourceView(resource, &srvDesc, handle);
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE D3D12RhiDescriptorHeap::GetGpuHandle(uint32_t index) const
+{
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heap->GetGPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+}
+
+D3D12RhiFence::D3D12RhiFence(ID3D12Fence* fence)
+    : m_fence(fence)
+    , m_event(CreateEvent(nullptr, FALSE, FALSE, nullptr))
+{
+    if (m_event == nullptr)
+    {
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+}
+
+D3D12RhiFence::~D3D12RhiFence()
+{
+    CloseHandle(m_event);
+}
+
+void D3D12RhiFence::Wait(uint64_t value)
+{
+    if (m_fence->GetCompletedValue() < value)
+    {
+        ThrowIfFailed(m_fence->SetEventOnCompletion(value, m_event));
+        WaitForSingleObjectEx(m_event, INFINITE, FALSE);
+    }
+}
+
+D3D12RhiCommandList::D3D12RhiCommandList(ID3D12GraphicsCommandList6* commandList, ID3D12CommandAllocator* allocator)
+    : m_commandList(commandList)
+    , m_allocator(allocator)
+{ }
+
+HRESULT D3D12RhiCommandList::Reset()
+{
+    HRESULT hr = m_allocator->Reset();
+    if (FAILED(hr))
+        return hr;
+
+    return m_commandList->Reset(m_allocator.Get(), nullptr);
+}
+
+HRESULT D3D12RhiCommandList::Close()
+{
+    return m_commandList->Close();
+}
+
+void D3D12RhiCommandList::CopyBuffer(RhiBuffer* dest, uint64_t destOffset, RhiBuffer* source, uint64_t sourceOffset, uint64_t size)
+{
+    ID3D12Resource* destResource = static_cast<D3D12RhiBuffer*>(dest)->GetResource();
+    ID3D12Resource* sourceResource = static_cast<D3D12RhiBuffer*>(source)->GetResource();
+
+    // Whole buffer copies take the cheaper path.
+    if (destOffset == 0 && sourceOffset == 0 && size == dest->GetSize() && size == source->GetSize())
+    {
+        m_commandList->CopyResource(destResource, sourceResource);
+    }
+    else
+    {
+        m_commandList->CopyBufferRegion(destResource, destOffset, sourceResource, sourceOffset, size);
+    }
+}
+
+void D3D12RhiCommandList::Barrier(RhiBuffer* buffer, RhiBufferState::EType before, RhiBufferState::EType after)
+{
+    const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+        static_cast<D3D12RhiBuffer*>(buffer)->GetResource(),
+        GetD3D12ResourceState(before),
+        GetD3D12ResourceState(after));
+
+    m_commandList->ResourceBarrier(1, &barrier);
+}
+
+void D3D12RhiCommandList::SetDescriptorHeap(RhiDescriptorHeap* heap)
+{
+    ID3D12DescriptorHeap* heaps[] = { static_cast<D3D12RhiDescriptorHeap*>(heap)->GetHeap() };
+    m_commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+}
+
+void D3D12RhiCommandList::SetGraphicsRootDescriptorTable(uint32_t rootIndex, RhiDescriptorHeap* heap, uint32_t firstDescriptor)
+{
+    m_commandList->SetGraphicsRootDescriptorTable(rootIndex, static_cast<D3D12RhiDescriptorHeap*>(heap)->GetGpuHandle(firstDescriptor));
+}
+
+void D3D12RhiCommandList::SetGraphicsRoot32BitConstants(uint32_t rootIndex, uint32_t count, const void* data, uint32_t firstConstant)
+{
+    m_commandList->SetGraphicsRoot32BitConstants(rootIndex, count, data, firstConstant);
+}
+
+void D3D12RhiCommandList::SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t gpuAddress)
+{
+    m_commandList->SetGraphicsRootConstantBufferView(rootIndex, gpuAddress);
+}
+
+void D3D12RhiCommandList::DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    m_commandList->DispatchMesh(groupCountX, groupCountY, groupCountZ);
+}
+
+D3D12RhiQueue::D3D12RhiQueue(ID3D12CommandQueue* queue)
+    : m_queue(queue)
+{ }
+
+void D3D12RhiQueue::Submit(RhiCommandList* const* commandLists, uint32_t count)
+{
+    std::vector<ID3D12CommandList*> lists(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        lists[i] = static_cast<D3D12RhiCommandList*>(commandLists[i])->GetCommandList();
+    }
+
+    m_queue->ExecuteCommandLists(count, lists.data());
+}
+
+HRESULT D3D12RhiQueue::Signal(RhiFence* fence, uint64_t value)
+{
+    return m_queue->Signal(static_cast<D3D12RhiFence*>(fence)->GetFence(), value);
+}
+
+D3D12RhiDevice::D3D12RhiDevice(ID3D12Device2* device, ID3D12CommandQueue* queue)
+    : m_device(device)
+    , m_queue(queue)
+{ }
+
+HRESULT D3D12RhiDevice::CreateBuffer(const RhiBufferDesc& desc, std::unique_ptr<RhiBuffer>& buffer)
+{
+    D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+    switch (desc.Heap)
+    {
+    case RhiHeapType::Upload:   heapType = D3D12_HEAP_TYPE_UPLOAD; break;
+    case RhiHeapType::Readback: heapType = D3D12_HEAP_TYPE_READBACK; break;
+    default:                    break;
+    }
+
+    const CD3DX12_HEAP_PROPERTIES heapProps(heapType);
+    const CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(
+        desc.Size,
+        desc.AllowUnorderedAccess ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE);
+
+    ComPtr<ID3D12Resource> resource;
+    HRESULT hr = m_device->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &resourceDesc,
+        GetD3D12ResourceState(desc.InitialState),
+        nullptr,
+        IID_PPV_ARGS(&resource));
+
+    if (FAILED(hr))
+        return hr;
+
+    buffer.reset(new D3D12RhiBuffer(resource.Get(), desc.Heap));
+    return S_OK;
+}
+
+HRESULT D3D12RhiDevice::CreateDescriptorHeap(uint32_t descriptorCount, std::unique_ptr<RhiDescriptorHeap>& heap)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = descriptorCount;
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+    ComPtr<ID3D12DescriptorHeap> descriptorHeap;
+    HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&descriptorHeap));
+    if (FAILED(hr))
+        return hr;
+
+    heap.reset(new D3D12RhiDescriptorHeap(m_device.Get(), descriptorHeap.Get()));
+    return S_OK;
+}
+
+HRESULT D3D12RhiDevice::CreateCommandList(std::unique_ptr<RhiCommandList>& commandList)
+{
+    ComPtr<ID3D12CommandAllocator> allocator;
+    HRESULT hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator));
+    if (FAILED(hr))
+        return hr;
+
+    ComPtr<ID3D12GraphicsCommandList6> list;
+    hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator.Get(), nullptr, IID_PPV_ARGS(&list));
+    if (FAILED(hr))
+        return hr;
+
+    // Command lists are created open; RHI ones start closed.
+    hr = list->Close();
+    if (FAILED(hr))
+        return hr;
+
+    commandList.reset(new D3D12RhiCommandList(list.Get(), allocator.Get()));
+    return S_OK;
+}
+
+HRESULT D3D12RhiDevice::CreateFence(uint64_t initialValue, std::unique_ptr<RhiFence>& fence)
+{
+    ComPtr<ID3D12Fence> d3dFence;
+    HRESULT hr = m_device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&d3dFence));
+    if (FAILED(hr))
+        return hr;
+
+    fence.reset(new D3D12RhiFence(d3dFence.Get()));
+    return S_OK;
+}
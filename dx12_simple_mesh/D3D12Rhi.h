@@ -0,0 +1,130 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Rhi.h"
+
+// The RHI over D3D12. Each object can wrap one the renderer already created, so that code
+// recording through the RHI and code calling D3D12 directly can share a command list, heap
+// or buffer; wrappers hold a reference to what they wrap.
+
+class D3D12RhiBuffer : public RhiBuffer
+{
+public:
+    D3D12RhiBuffer(ID3D12Resource* resource, RhiHeapType::EType heap);
+
+    uint64_t GetSize() const override { return m_size; }
+    uint64_t GetGpuAddress() const override { return m_gpuAddress; }
+
+    void* Map() override;
+    void Unmap() override;
+
+    ID3D12Resource* GetResource() const { return m_resource.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_resource;
+    RhiHeapType::EType                     m_heap;
+    uint64_t                               m_size;
+    uint64_t                               m_gpuAddress;
+};
+
+class D3D12RhiDescriptorHeap : public RhiDescriptorHeap
+{
+public:
+    D3D12RhiDescriptorHeap(ID3D12Device* device, ID3D12DescriptorHeap* heap);
+
+    uint32_t GetDescriptorCount() const override { return m_descriptorCount; }
+    void CreateRawBufferView(uint32_t index, RhiBuffer* buffer, uint64_t firstDword, uint32_t dwordCount) override;
+
+    ID3D12DescriptorHeap* GetHeap() const { return m_heap.Get(); }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t index) const;
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device>         m_device;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_heap;
+    uint32_t                                     m_descriptorCount;
+    uint32_t                                     m_descriptorSize;
+};
+
+class D3D12RhiFence : public RhiFence
+{
+public:
+    explicit D3D12RhiFence(ID3D12Fence* fence);
+    ~D3D12RhiFence();
+
+    uint64_t GetCompletedValue() override { return m_fence->GetCompletedValue(); }
+    void Wait(uint64_t value) override;
+
+    ID3D12Fence* GetFence() const { return m_fence.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+    HANDLE                              m_event;
+};
+
+class D3D12RhiCommandList : public RhiCommandList
+{
+public:
+    // Reset() resets 'allocator' and the list with no pipeline state.
+    D3D12RhiCommandList(ID3D12GraphicsCommandList6* commandList, ID3D12CommandAllocator* allocator);
+
+    HRESULT Reset() override;
+    HRESULT Close() override;
+
+    void CopyBuffer(RhiBuffer* dest, uint64_t destOffset, RhiBuffer* source, uint64_t sourceOffset, uint64_t size) override;
+    void Barrier(RhiBuffer* buffer, RhiBufferState::EType before, RhiBufferState::EType after) override;
+
+    void SetDescriptorHeap(RhiDescriptorHeap* heap) override;
+    void SetGraphicsRootDescriptorTable(uint32_t rootIndex, RhiDescriptorHeap* heap, uint32_t firstDescriptor) override;
+    void SetGraphicsRoot32BitConstants(uint32_t rootIndex, uint32_t count, const void* data, uint32_t firstConstant) override;
+    void SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t gpuAddress) override;
+
+    void DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+
+    ID3D12GraphicsCommandList6* GetCommandList() const { return m_commandList.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList6> m_commandList;
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator>     m_allocator;
+};
+
+class D3D12RhiQueue : public RhiQueue
+{
+public:
+    explicit D3D12RhiQueue(ID3D12CommandQueue* queue);
+
+    void Submit(RhiCommandList* const* commandLists, uint32_t count) override;
+    HRESULT Signal(RhiFence* fence, uint64_t value) override;
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_queue;
+};
+
+class D3D12RhiDevice : public RhiDevice
+{
+public:
+    D3D12RhiDevice(ID3D12Device2* device, ID3D12CommandQueue* queue);
+
+    HRESULT CreateBuffer(const RhiBufferDesc& desc, std::unique_ptr<RhiBuffer>& buffer) override;
+    HRESULT CreateDescriptorHeap(uint32_t descriptorCount, std::unique_ptr<RhiDescriptorHeap>& heap) override;
+    HRESULT CreateCommandList(std::unique_ptr<RhiCommandList>& commandList) override;
+    HRESULT CreateFence(uint64_t initialValue, std::unique_ptr<RhiFence>& fence) override;
+
+    RhiQueue* GetQueue() override { return &m_queue; }
+
+    ID3D12Device2* GetDevice() const { return m_device.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device2> m_device;
+    D3D12RhiQueue                         m_queue;
+};
+
+D3D12_RESOURCE_STATES GetD3D12ResourceState(RhiBufferState::EType state);
@@ -18,8 +18,22 @@ DXSample::DXSample(UINT width, UINT height, std::wstring name) :
     m_width(width),
     m_height(height),
     m_title(name),
-    m_useWarpDevice(false)
+    m_useWarpDevice(false),
+    m_headlessFrameCount(0),
+    m_frameTimesFile(L"FrameTimes.csv"),
+    m_checkVertexFetch(false),
+    m_shaderCache("ShaderCache", 256ull * 1024 * 1024),
+    m_shaderJobs([this]()
+        {
+            return std::unique_ptr<ShaderCompiler>(new ArchiveShaderCompiler(&m_shaderArchive, [this]()
+                {
+                    return std::unique_ptr<ShaderCompiler>(new DxcShaderCompiler(&m_shaderCache));
+                }));
+        })
 {
+    // Built by the post-build step; without it, every shader compiles at run time.
+    m_shaderArchive.Open("ShaderArchive.bin");
+
     WCHAR assetsPath[512];
     GetAssetsPath(assetsPath, _countof(assetsPath));
     m_assetsPath = assetsPath;
@@ -117,79 +131,111 @@ std::vector<char> DXSample::ReadFile(const std::wstring& filename)
     return buffer;
 }
 
-HRESULT DXSample::CompileShaderToBlob(
+static std::string ToUtf8(const wchar_t* text)
+{
+    const int size = WideCharToMultiByte(CP_UTF8, 0, text, -1, nullptr, 0, nullptr, nullptr);
+    if (size <= 1)
+        return std::string();
+
+    std::string utf8(size - 1, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, text, -1, &utf8[0], size, nullptr, nullptr);
+    return utf8;
+}
+
+ShaderTask DXSample::CompileShaderAsync(
     const wchar_t* filename,
     const wchar_t* entryPoint,
-    const wchar_t* targetProfile,
-    IDxcBlob** shaderBlob)
+    const wchar_t* targetProfile)
 {
-    HRESULT hr;
+    std::vector<char> sourceData = ReadFile(filename);
 
-    ComPtr<IDxcCompiler> compiler;
-    ComPtr<IDxcLibrary> library;
-    ComPtr<IDxcIncludeHandler> includeHandler;
+    return CompileShaderAsync(std::string(sourceData.begin(), sourceData.end()), filename, entryPoint, targetProfile);
+}
 
-    hr = DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler));
-    if (FAILED(hr)) return hr;
-    hr = DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&library));
-    if (FAILED(hr)) return hr;
+ShaderTask DXSample::CompileShaderAsync(
+    const std::string& source,
+    const wchar_t* sourceName,
+    const wchar_t* entryPoint,
+    const wchar_t* targetProfile)
+{
+    ShaderCompileRequest request;
+    request.Source = source;
+    request.SourceName = ToUtf8(sourceName);
+    request.EntryPoint = ToUtf8(entryPoint);
+    request.Profile = ToUtf8(targetProfile);
+    request.Arguments = { "-Zi", "-Qembed_debug" };
+    if (IsCheckingVertexFetch())
+    {
+        request.Arguments.push_back("-DCHECK_VERTEX_FETCH");
+    }
+    for (const std::string& define : m_shaderDefines)
+    {
+        request.Arguments.push_back("-D" + define);
+    }
 
-    hr = library->CreateIncludeHandler(&includeHandler);
-    if (FAILED(hr)) return hr;
+    const ContentHash archiveKey = ComputeShaderArchiveKey(request);
+    ShaderTask task = m_shaderJobs.Compile(std::move(request));
 
-    std::vector<char> sourceData = ReadFile(filename);
+    if (IsBuildingShaderArchive())
+    {
+        m_archiveCompiles.emplace_back(archiveKey, task);
+    }
+
+    return task;
+}
+
+HRESULT DXSample::GetShaderBytecode(const ShaderTask& task, const std::vector<uint8_t>** bytecode)
+{
+    const ShaderCompileResult& result = task.Result.get();
+    if (!result.Errors.empty())
+    {
+        std::cerr << "Shader compilation errors:\n" << result.Errors;
+    }
 
-    ComPtr<IDxcBlobEncoding> sourceBlob;
-    hr = library->CreateBlobWithEncodingOnHeapCopy(sourceData.data(), (UINT32)sourceData.size(), CP_UTF8, &sourceBlob);
-    if (FAILED(hr)) return hr;
-
-    LPCWSTR arguments[] = {
-        L"-E", entryPoint,
-        L"-T", targetProfile,
-        L"-Zi",
-        L"-Qembed_debug"
-    };
-
-    ComPtr<IDxcOperationResult> result;
-    hr = compiler->Compile(
-        sourceBlob.Get(),
-        filename,
-        entryPoint,
-        targetProfile,
-        arguments,
-        _countof(arguments),
-        nullptr,
-        0,
-        includeHandler.Get(),
-        &result);
-
-    if (FAILED(hr))
-        return hr;
-
-    HRESULT status;
-    hr = result->GetStatus(&status);
-    if (FAILED(hr))
-        return hr;
-
-    if (FAILED(status))
+    *bytecode = SUCCEEDED(result.Status) ? &result.Bytecode : nullptr;
+    return result.Status;
+}
+
+int DXSample::BuildShaderArchive()
+{
+    OnBuildShaders();
+
+    ShaderArchiveWriter writer;
+    uint32_t failedCount = 0;
+    for (const auto& compile : m_archiveCompiles)
     {
-        ComPtr<IDxcBlobEncoding> errors;
-        hr = result->GetErrorBuffer(&errors);
-        if (SUCCEEDED(hr) && errors)
+        const std::vector<uint8_t>* bytecode = nullptr;
+        if (FAILED(GetShaderBytecode(compile.second, &bytecode)))
         {
-            std::cerr << "Shader compilation errors:\n";
-            std::cerr.write((const char*)errors->GetBufferPointer(), errors->GetBufferSize());
+            ++failedCount;
+            continue;
         }
-        return status;
+
+        writer.Add(compile.first, *bytecode);
+    }
+
+    if (failedCount != 0)
+    {
+        std::cerr << failedCount << " shaders failed to compile; no archive written.\n";
+        return 1;
+    }
+
+    if (!writer.Write(ToUtf8(m_shaderArchiveOutput.c_str())))
+    {
+        std::cerr << "Failed to write the shader archive.\n";
+        return 1;
     }
 
-    hr = result->GetResult(shaderBlob);
-    return hr;
+    return 0;
 }
 
 // Helper function for setting the window's title text.
 void DXSample::SetCustomWindowText(LPCWSTR text)
 {
+    // Headless runs have no window to title.
+    if (Win32Application::GetHwnd() == nullptr)
+        return;
+
     std::wstring windowText = m_title + L": " + text;
     SetWindowText(Win32Application::GetHwnd(), windowText.c_str());
 }
@@ -206,5 +252,28 @@ void DXSample::ParseCommandLineArgs(WCHAR* argv[], int argc)
             m_useWarpDevice = true;
             m_title = m_title + L" (WARP)";
         }
+        else if ((_wcsicmp(argv[i], L"-buildshaders") == 0 || _wcsicmp(argv[i], L"/buildshaders") == 0) && i + 1 < argc)
+        {
+            m_shaderArchiveOutput = argv[++i];
+
+            // The archive being built mustn't serve its own compiles.
+            m_shaderArchive.Close();
+        }
+        else if ((_wcsicmp(argv[i], L"-headless") == 0 || _wcsicmp(argv[i], L"/headless") == 0) && i + 1 < argc)
+        {
+            m_headlessFrameCount = static_cast<UINT>(wcstoul(argv[++i], nullptr, 10));
+        }
+        else if ((_wcsicmp(argv[i], L"-camerapath") == 0 || _wcsicmp(argv[i], L"/camerapath") == 0) && i + 1 < argc)
+        {
+            m_cameraPathFile = argv[++i];
+        }
+        else if ((_wcsicmp(argv[i], L"-frametimes") == 0 || _wcsicmp(argv[i], L"/frametimes") == 0) && i + 1 < argc)
+        {
+            m_frameTimesFile = argv[++i];
+        }
+        else if (_wcsicmp(argv[i], L"-checkfetch") == 0 || _wcsicmp(argv[i], L"/checkfetch") == 0)
+        {
+            m_checkVertexFetch = true;
+        }
     }
 }
@@ -12,6 +12,8 @@
 #pragma once
 
 #include "DXSampleHelper.h"
+#include "DxcShaderCompiler.h"
+#include "ShaderArchive.h"
 #include "Win32Application.h"
 #include <windows.h>            // MUST include before dxcapi.h for COM and Windows types
 #include <wrl/client.h>         // For Microsoft::WRL::ComPtr
@@ -35,6 +37,9 @@ public:
     virtual void OnKeyDown(UINT8 /*key*/)   {}
     virtual void OnKeyUp(UINT8 /*key*/)     {}
 
+    // Samples override this to queue every compile they can request, for BuildShaderArchive().
+    virtual void OnBuildShaders()           {}
+
     // Accessors.
     UINT GetWidth() const           { return m_width; }
     UINT GetHeight() const          { return m_height; }
@@ -42,13 +47,41 @@ public:
 
     void ParseCommandLineArgs(_In_reads_(argc) WCHAR* argv[], int argc);
 
+    // Set by -buildshaders <archive>: compile every shader OnBuildShaders() queues into the
+    // archive and exit, without a window or device. Returns the process exit code.
+    bool IsBuildingShaderArchive() const { return !m_shaderArchiveOutput.empty(); }
+    int BuildShaderArchive();
+
+    // Set by -headless <frames>: render that many frames offscreen with no window or present,
+    // advancing the timer one fixed step per frame, then exit. -camerapath <file> flies the
+    // camera along a CameraPath and -frametimes <file> names the CSV the frame times go to.
+    bool IsHeadless() const { return m_headlessFrameCount != 0; }
+    UINT GetHeadlessFrameCount() const { return m_headlessFrameCount; }
+
+    // Set by -checkfetch: shaders are compiled with CHECK_VERTEX_FETCH, writing the elements
+    // they fetch to a debug UAV that the first frame reads back and compares with the CPU decoder.
+    bool IsCheckingVertexFetch() const { return m_checkVertexFetch; }
+
 protected:
     static std::vector<char> ReadFile(const std::wstring& filename);
-    HRESULT CompileShaderToBlob(
+
+    // Queues a compile on m_shaderJobs; includes resolve next to the file. Bytecode is taken from
+    // m_shaderArchive if it holds the compile, else from m_shaderCache when every input of the
+    // compile matches; DXC is loaded only when both miss.
+    ShaderTask CompileShaderAsync(
         const wchar_t* filename,
         const wchar_t* entryPoint,
-        const wchar_t* targetProfile,
-        IDxcBlob** shaderBlob);
+        const wchar_t* targetProfile);
+
+    // Compiles in-memory source; includes resolve as if it were the file 'sourceName'.
+    ShaderTask CompileShaderAsync(
+        const std::string& source,
+        const wchar_t* sourceName,
+        const wchar_t* entryPoint,
+        const wchar_t* targetProfile);
+
+    // Waits for a compile, printing its diagnostics. The bytecode lives as long as the task.
+    static HRESULT GetShaderBytecode(const ShaderTask& task, const std::vector<uint8_t>** bytecode);
 
     std::wstring GetAssetFullPath(LPCWSTR assetName);
 
@@ -67,10 +100,31 @@ protected:
     // Adapter info.
     bool m_useWarpDevice;
 
+    // Headless runs.
+    UINT m_headlessFrameCount;
+    std::wstring m_cameraPathFile;
+    std::wstring m_frameTimesFile;
+
+    // Debug checks.
+    bool m_checkVertexFetch;
+
+    // Preprocessor definitions passed to every compile, for features the device lacks.
+    std::vector<std::string> m_shaderDefines;
+
+    // Compiled shaders kept across runs, shaders compiled at build time, and the threads
+    // compiling them.
+    ShaderCache m_shaderCache;
+    ShaderArchive m_shaderArchive;
+    ShaderJobSystem m_shaderJobs;
+
 private:
     // Root assets path.
     std::wstring m_assetsPath;
 
     // Window title.
     std::wstring m_title;
+
+    // Where -buildshaders writes the archive, and the compiles queued for it.
+    std::wstring m_shaderArchiveOutput;
+    std::vector<std::pair<ContentHash, ShaderTask>> m_archiveCompiles;
 };
@@ -0,0 +1,58 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "DispatchPlanner.h"
+
+namespace
+{
+    uint32_t DivRoundUp(uint32_t a, uint32_t b)
+    {
+        return a / b + (a % b != 0 ? 1 : 0);
+    }
+}
+
+uint32_t GetDispatchGroupCount(uint32_t itemCount, uint32_t itemsPerGroup)
+{
+    return itemsPerGroup == 0 ? 0 : DivRoundUp(itemCount, itemsPerGroup);
+}
+
+bool PlanDispatch(uint32_t groupCount, DispatchPlan& plan)
+{
+    plan = {};
+    if (groupCount > c_maxDispatchGroups)
+        return false;
+
+    plan.GroupCount = groupCount;
+    if (groupCount == 0)
+        return true;
+
+    // The fewest rows that fit, each as short as the rows allow, so the spare groups of the
+    // last row are fewer than the rows. Near the total limit, rounding rows up could exceed
+    // it; row counts dividing c_maxDispatchGroups never do, so more rows always end this.
+    uint32_t rowCount = DivRoundUp(groupCount, c_maxDispatchGroupsPerDimension);
+    while (uint64_t(DivRoundUp(groupCount, rowCount)) * rowCount > c_maxDispatchGroups)
+    {
+        ++rowCount;
+    }
+
+    // Rows beyond one dimension go to slices, though the total limit keeps them within it.
+    const uint32_t sliceCount = DivRoundUp(rowCount, c_maxDispatchGroupsPerDimension);
+
+    plan.GridSize[2] = sliceCount;
+    plan.GridSize[1] = DivRoundUp(rowCount, sliceCount);
+    plan.GridSize[0] = DivRoundUp(groupCount, plan.GridSize[1] * sliceCount);
+
+    return true;
+}
+
+uint32_t GetLinearGroupId(const DispatchPlan& plan, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+    return groupX + plan.GridSize[0] * (groupY + plan.GridSize[1] * groupZ);
+}
@@ -0,0 +1,38 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <cstdint>
+
+// Lays out a linear count of mesh shader groups as the X, Y and Z group counts of a
+// DispatchMesh(). Kept free of D3D12 types so it builds on any platform.
+
+// DispatchMesh() limits: groups per dimension, and in total.
+const uint32_t c_maxDispatchGroupsPerDimension = 65535;
+const uint32_t c_maxDispatchGroups = 1u << 22;
+
+struct DispatchPlan
+{
+    uint32_t GroupCount;        // Groups that do work; the rest of the grid exits at once
+    uint32_t GridSize[3];       // Arguments of DispatchMesh()
+};
+
+// Groups needed for 'itemCount' meshlets, vertices, primitives or instances, 'itemsPerGroup'
+// to a group.
+uint32_t GetDispatchGroupCount(uint32_t itemCount, uint32_t itemsPerGroup);
+
+// Spreads 'groupCount' groups over X, then Y, then Z, with fewer than one row of X spare.
+// Returns false for counts above c_maxDispatchGroups.
+bool PlanDispatch(uint32_t groupCount, DispatchPlan& plan);
+
+// Linear ID of a group of the grid, as the mesh shader computes it from SV_GroupID. IDs at
+// or past plan.GroupCount are spare.
+uint32_t GetLinearGroupId(const DispatchPlan& plan, uint32_t groupX, uint32_t groupY, uint32_t groupZ);
@@ -0,0 +1,141 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "DrawPacker.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    void AddItem(PackGroup& group, const PackItem& item)
+    {
+        ++group.ItemCount;
+        group.VertexCount += item.VertexCount;
+        group.PrimitiveCount += item.PrimitiveCount;
+    }
+
+    void PackInOrder(const PackItem* items, uint32_t itemCount, const PackLimits& limits, std::vector<PackGroup>& groups, std::vector<uint32_t>& itemGroups)
+    {
+        for (uint32_t i = 0; i < itemCount; ++i)
+        {
+            const PackItem& item = items[i];
+
+            if (groups.empty()
+                || groups.back().VertexCount + item.VertexCount > limits.MaxVertices
+                || groups.back().PrimitiveCount + item.PrimitiveCount > limits.MaxPrimitives)
+            {
+                groups.push_back(PackGroup());
+            }
+
+            AddItem(groups.back(), item);
+            itemGroups[i] = static_cast<uint32_t>(groups.size() - 1);
+        }
+    }
+
+    void PackBestFitDecreasing(const PackItem* items, uint32_t itemCount, const PackLimits& limits, std::vector<PackGroup>& groups, std::vector<uint32_t>& itemGroups)
+    {
+        std::vector<uint32_t> sorted(itemCount);
+        std::iota(sorted.begin(), sorted.end(), 0u);
+        std::stable_sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b)
+        {
+            if (items[a].VertexCount != items[b].VertexCount)
+                return items[a].VertexCount > items[b].VertexCount;
+
+            return items[a].PrimitiveCount > items[b].PrimitiveCount;
+        });
+
+        // Open groups bucketed by the vertices they have room for, so the best fit is the
+        // first group with room for the primitives in the smallest bucket that fits.
+        std::vector<std::vector<uint32_t>> open(limits.MaxVertices + 1);
+
+        for (uint32_t i : sorted)
+        {
+            const PackItem& item = items[i];
+
+            uint32_t group = ~0u;
+            for (uint32_t room = item.VertexCount; room <= limits.MaxVertices && group == ~0u; ++room)
+            {
+                std::vector<uint32_t>& bucket = open[room];
+                for (size_t k = 0; k < bucket.size(); ++k)
+                {
+                    if (groups[bucket[k]].PrimitiveCount + item.PrimitiveCount <= limits.MaxPrimitives)
+                    {
+                        group = bucket[k];
+                        bucket[k] = bucket.back();
+                        bucket.pop_back();
+                        break;
+                    }
+                }
+            }
+
+            if (group == ~0u)
+            {
+                group = static_cast<uint32_t>(groups.size());
+                groups.push_back(PackGroup());
+            }
+
+            AddItem(groups[group], item);
+            open[limits.MaxVertices - groups[group].VertexCount].push_back(group);
+            itemGroups[i] = group;
+        }
+    }
+}
+
+bool PackItems(
+    const PackItem* items,
+    uint32_t itemCount,
+    const PackLimits& limits,
+    PackMode::EType mode,
+    std::vector<PackGroup>& groups,
+    std::vector<uint32_t>& order)
+{
+    groups.clear();
+    order.clear();
+
+    for (uint32_t i = 0; i < itemCount; ++i)
+    {
+        if (items[i].VertexCount > limits.MaxVertices || items[i].PrimitiveCount > limits.MaxPrimitives)
+            return false;
+    }
+
+    std::vector<uint32_t> itemGroups(itemCount);
+    if (mode == PackMode::InOrder)
+    {
+        PackInOrder(items, itemCount, limits, groups, itemGroups);
+    }
+    else
+    {
+        PackBestFitDecreasing(items, itemCount, limits, groups, itemGroups);
+    }
+
+    // Lay out each group's items contiguously, in submission order.
+    uint32_t firstItem = 0;
+    for (PackGroup& group : groups)
+    {
+        group.FirstItem = firstItem;
+        firstItem += group.ItemCount;
+    }
+
+    std::vector<uint32_t> cursors(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        cursors[g] = groups[g].FirstItem;
+    }
+
+    order.resize(itemCount);
+    for (uint32_t i = 0; i < itemCount; ++i)
+    {
+        order[cursors[itemGroups[i]]++] = i;
+    }
+
+    return true;
+}
@@ -0,0 +1,62 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Vertex and primitive budget of one threadgroup.
+struct PackLimits
+{
+    uint32_t MaxVertices;
+    uint32_t MaxPrimitives;
+};
+
+// A unit of work that must land whole in one group: a small draw with all its instances, or
+// a meshlet.
+struct PackItem
+{
+    uint32_t VertexCount;
+    uint32_t PrimitiveCount;
+};
+
+// A group's items are order[FirstItem, FirstItem + ItemCount) of PackItems().
+struct PackGroup
+{
+    uint32_t FirstItem;
+    uint32_t ItemCount;
+    uint32_t VertexCount;
+    uint32_t PrimitiveCount;
+};
+
+struct PackMode
+{
+    enum EType : uint32_t
+    {
+        // Next fit: groups and the items within them follow submission order, so primitives
+        // rasterize in the order they were drawn. Needed when blending.
+        InOrder,
+
+        // Best fit decreasing: largest items first, each into the open group it leaves the
+        // least room in. Fewer groups for order-independent work.
+        BestFitDecreasing,
+    };
+};
+
+// Bins items into groups within the limits. Items keep submission order within each group
+// in either mode. Returns false, leaving the outputs empty, if an item exceeds the limits.
+bool PackItems(
+    const PackItem* items,
+    uint32_t itemCount,
+    const PackLimits& limits,
+    PackMode::EType mode,
+    std::vector<PackGroup>& groups,
+    std::vector<uint32_t>& order);
@@ -0,0 +1,180 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "stdafx.h"
+#include "DxcShaderCompiler.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    std::wstring ToWide(const std::string& text)
+    {
+        const int size = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, nullptr, 0);
+        if (size <= 1)
+            return std::wstring();
+
+        std::wstring wide(size - 1, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &wide[0], size);
+        return wide;
+    }
+
+    // Identifies the compiler build, so that cached bytecode isn't reused across compiler updates.
+    std::string GetCompilerVersion(IDxcCompiler* compiler)
+    {
+        std::string version;
+
+        ComPtr<IDxcVersionInfo> versionInfo;
+        if (SUCCEEDED(compiler->QueryInterface(IID_PPV_ARGS(&versionInfo))))
+        {
+            UINT32 major = 0;
+            UINT32 minor = 0;
+            if (SUCCEEDED(versionInfo->GetVersion(&major, &minor)))
+            {
+                version = std::to_string(major) + "." + std::to_string(minor);
+            }
+        }
+
+        ComPtr<IDxcVersionInfo2> versionInfo2;
+        if (SUCCEEDED(compiler->QueryInterface(IID_PPV_ARGS(&versionInfo2))))
+        {
+            UINT32 commitCount = 0;
+            char* commitHash = nullptr;
+            if (SUCCEEDED(versionInfo2->GetCommitInfo(&commitCount, &commitHash)))
+            {
+                version += " " + std::to_string(commitCount) + " " + commitHash;
+                CoTaskMemFree(commitHash);
+            }
+        }
+
+        return version;
+    }
+}
+
+DxcShaderCompiler::DxcShaderCompiler(ShaderCache* cache)
+    : m_cache(cache)
+{
+    // dxcompiler.dll is delay-loaded, and builds running from a shader archive may ship without
+    // it; a missing DLL fails each compile instead of faulting on the first call into it.
+    if (LoadLibraryW(L"dxcompiler.dll") == nullptr)
+    {
+        m_createResult = HRESULT_FROM_WIN32(GetLastError());
+        return;
+    }
+
+    m_createResult = DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_compiler));
+    if (SUCCEEDED(m_createResult))
+    {
+        m_createResult = DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&m_library));
+    }
+    if (SUCCEEDED(m_createResult))
+    {
+        m_createResult = m_library->CreateIncludeHandler(&m_includeHandler);
+    }
+    if (SUCCEEDED(m_createResult))
+    {
+        m_version = GetCompilerVersion(m_compiler.Get());
+    }
+}
+
+void DxcShaderCompiler::Compile(const ShaderCompileRequest& request, ShaderCompileResult& result)
+{
+    result.Bytecode.clear();
+    result.Errors.clear();
+
+    result.Status = m_createResult;
+    if (FAILED(result.Status))
+        return;
+
+    // Skip DXC when the same inputs were compiled before, in this run or an earlier one.
+    ShaderCacheKey cacheKey = {};
+    if (m_cache != nullptr)
+    {
+        ShaderCompileInputs inputs;
+        inputs.Source = request.Source;
+        inputs.SourceName = request.SourceName;
+        inputs.EntryPoint = request.EntryPoint;
+        inputs.Profile = request.Profile;
+        inputs.Arguments = request.Arguments;
+        inputs.CompilerVersion = m_version;
+
+        cacheKey = ComputeShaderCacheKey(inputs);
+        if (m_cache->Load(cacheKey, result.Bytecode))
+        {
+            result.Status = S_OK;
+            return;
+        }
+    }
+
+    const std::wstring sourceName = ToWide(request.SourceName);
+    const std::wstring entryPoint = ToWide(request.EntryPoint);
+    const std::wstring profile = ToWide(request.Profile);
+
+    std::vector<std::wstring> wideArguments;
+    for (const std::string& argument : request.Arguments)
+    {
+        wideArguments.push_back(ToWide(argument));
+    }
+
+    std::vector<LPCWSTR> arguments = { L"-E", entryPoint.c_str(), L"-T", profile.c_str() };
+    for (const std::wstring& argument : wideArguments)
+    {
+        arguments.push_back(argument.c_str());
+    }
+
+    ComPtr<IDxcBlobEncoding> sourceBlob;
+    result.Status = m_library->CreateBlobWithEncodingOnHeapCopy(request.Source.data(), (UINT32)request.Source.size(), CP_UTF8, &sourceBlob);
+    if (FAILED(result.Status))
+        return;
+
+    ComPtr<IDxcOperationResult> operation;
+    result.Status = m_compiler->Compile(
+        sourceBlob.Get(),
+        sourceName.c_str(),
+        entryPoint.c_str(),
+        profile.c_str(),
+        arguments.data(),
+        static_cast<UINT32>(arguments.size()),
+        nullptr,
+        0,
+        m_includeHandler.Get(),
+        &operation);
+
+    if (FAILED(result.Status))
+        return;
+
+    HRESULT status;
+    result.Status = operation->GetStatus(&status);
+    if (FAILED(result.Status))
+        return;
+
+    ComPtr<IDxcBlobEncoding> errors;
+    if (SUCCEEDED(operation->GetErrorBuffer(&errors)) && errors && errors->GetBufferSize() != 0)
+    {
+        result.Errors.assign(static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize());
+    }
+
+    result.Status = status;
+    if (FAILED(status))
+        return;
+
+    ComPtr<IDxcBlob> bytecode;
+    result.Status = operation->GetResult(&bytecode);
+    if (FAILED(result.Status))
+        return;
+
+    const uint8_t* data = static_cast<const uint8_t*>(bytecode->GetBufferPointer());
+    result.Bytecode.assign(data, data + bytecode->GetBufferSize());
+
+    if (m_cache != nullptr)
+    {
+        m_cache->Store(cacheKey, result.Bytecode.data(), result.Bytecode.size());
+    }
+}
@@ -0,0 +1,35 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "ShaderCache.h"
+#include "ShaderJobSystem.h"
+
+#include <dxcapi.h>
+
+// Compiles with its own DXC compiler, library and include handler, as a ShaderJobSystem
+// worker needs. Compiles whose inputs match an entry of 'cache', which may be null, take the
+// entry's bytecode instead, and new bytecode is stored there.
+class DxcShaderCompiler : public ShaderCompiler
+{
+public:
+    explicit DxcShaderCompiler(ShaderCache* cache);
+
+    void Compile(const ShaderCompileRequest& request, ShaderCompileResult& result) override;
+
+private:
+    ShaderCache*                               m_cache;
+    HRESULT                                    m_createResult;
+    Microsoft::WRL::ComPtr<IDxcCompiler>       m_compiler;
+    Microsoft::WRL::ComPtr<IDxcLibrary>        m_library;
+    Microsoft::WRL::ComPtr<IDxcIncludeHandler> m_includeHandler;
+    std::string                                m_version;       // Compiler build, part of each cache key
+};
@@ -0,0 +1,243 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "DynamicMesh.h"
+#include "Meshletizer.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+DynamicMesh::DynamicMesh()
+    : m_vertexCount(0)
+    , m_anyMoved(false)
+{ }
+
+void DynamicMesh::SetTriangles(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+    const uint32_t triangleCount = indexCount / 3;
+
+    m_indices.assign(indices, indices + triangleCount * 3);
+    m_vertexCount = vertexCount;
+    m_chunks.assign((triangleCount + c_dynamicChunkTriangles - 1) / c_dynamicChunkTriangles, Chunk{ 0, 0, true });
+
+    m_meshlets.clear();
+    m_uniqueVertexIndices.clear();
+    m_primitiveIndices.clear();
+    m_cullData.clear();
+
+    m_movedVertices.assign(vertexCount, 0);
+    m_anyMoved = false;
+}
+
+void DynamicMesh::UpdateTriangles(uint32_t firstTriangle, const uint32_t* indices, uint32_t triangleCount)
+{
+    if (triangleCount == 0)
+        return;
+
+    std::copy(indices, indices + triangleCount * 3, m_indices.begin() + firstTriangle * 3);
+
+    const uint32_t lastTriangle = firstTriangle + triangleCount - 1;
+    for (uint32_t c = firstTriangle / c_dynamicChunkTriangles; c <= lastTriangle / c_dynamicChunkTriangles; ++c)
+    {
+        m_chunks[c].Dirty = true;
+    }
+}
+
+void DynamicMesh::MoveVertices(uint32_t firstVertex, uint32_t vertexCount)
+{
+    std::fill(m_movedVertices.begin() + firstVertex, m_movedVertices.begin() + firstVertex + vertexCount, uint8_t(1));
+    m_anyMoved = m_anyMoved || vertexCount > 0;
+}
+
+DynamicMeshRefresh DynamicMesh::Refresh(const XMFLOAT3* positions)
+{
+    DynamicMeshRefresh refresh = {};
+
+    std::vector<uint8_t> stale(m_meshlets.size(), 0);
+
+    if (std::any_of(m_chunks.begin(), m_chunks.end(), [](const Chunk& chunk) { return chunk.Dirty; }))
+    {
+        // Rebuilt chunks are spliced between the clean ones, whose meshlets are copied over
+        // with their offsets moved.
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> uniqueVertexIndices;
+        std::vector<PackedTriangle> primitiveIndices;
+        std::vector<CullData> cullData;
+        std::vector<uint8_t> newStale;
+
+        for (uint32_t c = 0; c < m_chunks.size(); ++c)
+        {
+            Chunk& chunk = m_chunks[c];
+            const uint32_t firstMeshlet = static_cast<uint32_t>(meshlets.size());
+
+            if (chunk.Dirty)
+            {
+                RebuildChunk(c, meshlets, uniqueVertexIndices, primitiveIndices);
+                ++refresh.RebuiltChunks;
+            }
+            else
+            {
+                for (uint32_t m = chunk.FirstMeshlet; m < chunk.FirstMeshlet + chunk.MeshletCount; ++m)
+                {
+                    Meshlet meshlet = m_meshlets[m];
+                    uniqueVertexIndices.insert(uniqueVertexIndices.end(),
+                        m_uniqueVertexIndices.begin() + meshlet.VertOffset,
+                        m_uniqueVertexIndices.begin() + meshlet.VertOffset + meshlet.VertCount);
+                    primitiveIndices.insert(primitiveIndices.end(),
+                        m_primitiveIndices.begin() + meshlet.PrimOffset,
+                        m_primitiveIndices.begin() + meshlet.PrimOffset + meshlet.PrimCount);
+
+                    meshlet.VertOffset = static_cast<uint32_t>(uniqueVertexIndices.size()) - meshlet.VertCount;
+                    meshlet.PrimOffset = static_cast<uint32_t>(primitiveIndices.size()) - meshlet.PrimCount;
+                    meshlets.push_back(meshlet);
+                }
+            }
+
+            const uint32_t meshletCount = static_cast<uint32_t>(meshlets.size()) - firstMeshlet;
+            if (chunk.Dirty)
+            {
+                cullData.resize(meshlets.size());
+                newStale.resize(meshlets.size(), 1);
+            }
+            else
+            {
+                cullData.insert(cullData.end(), m_cullData.begin() + chunk.FirstMeshlet, m_cullData.begin() + chunk.FirstMeshlet + chunk.MeshletCount);
+                newStale.insert(newStale.end(), stale.begin() + chunk.FirstMeshlet, stale.begin() + chunk.FirstMeshlet + chunk.MeshletCount);
+            }
+
+            chunk.FirstMeshlet = firstMeshlet;
+            chunk.MeshletCount = meshletCount;
+            chunk.Dirty = false;
+        }
+
+        m_meshlets.swap(meshlets);
+        m_uniqueVertexIndices.swap(uniqueVertexIndices);
+        m_primitiveIndices.swap(primitiveIndices);
+        m_cullData.swap(cullData);
+        stale.swap(newStale);
+
+        RebuildVertexMeshlets();
+        refresh.LayoutChanged = true;
+    }
+
+    if (m_anyMoved)
+    {
+        for (uint32_t v = 0; v < m_vertexCount; ++v)
+        {
+            if (!m_movedVertices[v])
+                continue;
+
+            for (uint32_t i = m_vertexMeshletStart[v]; i < m_vertexMeshletStart[v + 1]; ++i)
+            {
+                stale[m_vertexMeshlets[i]] = 1;
+            }
+
+            m_movedVertices[v] = 0;
+        }
+
+        m_anyMoved = false;
+    }
+
+    // Recompute runs of stale meshlets at once.
+    for (uint32_t m = 0; m < m_meshlets.size(); )
+    {
+        if (!stale[m])
+        {
+            ++m;
+            continue;
+        }
+
+        uint32_t end = m + 1;
+        while (end < m_meshlets.size() && stale[end])
+        {
+            ++end;
+        }
+
+        ComputeCullData(positions, &m_meshlets[m], end - m, m_uniqueVertexIndices.data(), m_primitiveIndices.data(), &m_cullData[m]);
+        refresh.RefreshedMeshlets += end - m;
+        m = end;
+    }
+
+    return refresh;
+}
+
+void DynamicMesh::RebuildChunk(uint32_t c, std::vector<Meshlet>& meshlets, std::vector<uint32_t>& uniqueVertexIndices, std::vector<PackedTriangle>& primitiveIndices)
+{
+    const uint32_t firstIndex = c * c_dynamicChunkTriangles * 3;
+    const uint32_t indexCount = std::min(c_dynamicChunkTriangles * 3, static_cast<uint32_t>(m_indices.size()) - firstIndex);
+
+    // ComputeMeshlets() works in time proportional to the vertex count it is given, so the
+    // chunk's vertices are renumbered from 0 and mapped back after.
+    std::vector<uint32_t> localIndices(indexCount);
+    std::vector<uint32_t> chunkVertices;
+
+    if (m_localVertex.size() != m_vertexCount)
+    {
+        m_localVertex.assign(m_vertexCount, ~0u);
+    }
+
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        const uint32_t v = m_indices[firstIndex + i];
+        if (m_localVertex[v] == ~0u)
+        {
+            m_localVertex[v] = static_cast<uint32_t>(chunkVertices.size());
+            chunkVertices.push_back(v);
+        }
+
+        localIndices[i] = m_localVertex[v];
+    }
+
+    for (uint32_t v : chunkVertices)
+    {
+        m_localVertex[v] = ~0u;
+    }
+
+    // ComputeMeshlets() appends, offsetting into the arrays it is given.
+    const size_t firstUnique = uniqueVertexIndices.size();
+    ComputeMeshlets(localIndices.data(), indexCount, static_cast<uint32_t>(chunkVertices.size()), c_maxMeshletVerts, c_maxMeshletPrims,
+        meshlets, uniqueVertexIndices, primitiveIndices);
+
+    for (size_t i = firstUnique; i < uniqueVertexIndices.size(); ++i)
+    {
+        uniqueVertexIndices[i] = chunkVertices[uniqueVertexIndices[i]];
+    }
+}
+
+void DynamicMesh::RebuildVertexMeshlets()
+{
+    m_vertexMeshletStart.assign(m_vertexCount + 1, 0);
+
+    for (const Meshlet& meshlet : m_meshlets)
+    {
+        for (uint32_t i = 0; i < meshlet.VertCount; ++i)
+        {
+            ++m_vertexMeshletStart[m_uniqueVertexIndices[meshlet.VertOffset + i] + 1];
+        }
+    }
+
+    for (uint32_t v = 0; v < m_vertexCount; ++v)
+    {
+        m_vertexMeshletStart[v + 1] += m_vertexMeshletStart[v];
+    }
+
+    m_vertexMeshlets.resize(m_vertexMeshletStart[m_vertexCount]);
+
+    std::vector<uint32_t> cursors(m_vertexMeshletStart.begin(), m_vertexMeshletStart.end() - 1);
+    for (uint32_t m = 0; m < m_meshlets.size(); ++m)
+    {
+        const Meshlet& meshlet = m_meshlets[m];
+        for (uint32_t i = 0; i < meshlet.VertCount; ++i)
+        {
+            m_vertexMeshlets[cursors[m_uniqueVertexIndices[meshlet.VertOffset + i]]++] = m;
+        }
+    }
+}
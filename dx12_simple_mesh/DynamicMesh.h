@@ -0,0 +1,81 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "MeshletTypes.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// Triangles meshletized together; changing a triangle rebuilds only its chunk's meshlets.
+const uint32_t c_dynamicChunkTriangles = 1024;
+
+struct DynamicMeshRefresh
+{
+    uint32_t RebuiltChunks;
+    uint32_t RefreshedMeshlets; // Meshlets whose CullData was recomputed
+    bool     LayoutChanged;     // Meshlet arrays were rebuilt; otherwise only CullData changed
+};
+
+// Meshlets of a mesh whose vertices move every frame, such as cloth or particle ribbons,
+// kept current incrementally. Moving vertices recomputes the CullData of only the meshlets
+// that use them; rewriting triangles rebuilds only the chunks that hold them. Changes are
+// applied by Refresh(). Kept free of D3D12 types so the tools build on any platform.
+class DynamicMesh
+{
+public:
+    DynamicMesh();
+
+    // Replaces the mesh; every chunk is rebuilt on the next Refresh().
+    void SetTriangles(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+    // Rewrites triangles [firstTriangle, firstTriangle + triangleCount) in place.
+    void UpdateTriangles(uint32_t firstTriangle, const uint32_t* indices, uint32_t triangleCount);
+
+    // Vertices [firstVertex, firstVertex + vertexCount) have new positions.
+    void MoveVertices(uint32_t firstVertex, uint32_t vertexCount);
+
+    DynamicMeshRefresh Refresh(const DirectX::XMFLOAT3* positions);
+
+    // Meshlet::VertOffset and PrimOffset index the arrays of the whole mesh.
+    const std::vector<Meshlet>&        GetMeshlets() const { return m_meshlets; }
+    const std::vector<uint32_t>&       GetUniqueVertexIndices() const { return m_uniqueVertexIndices; }
+    const std::vector<PackedTriangle>& GetPrimitiveIndices() const { return m_primitiveIndices; }
+    const std::vector<CullData>&       GetCullData() const { return m_cullData; }
+
+private:
+    struct Chunk
+    {
+        uint32_t FirstMeshlet;  // In the arrays of the whole mesh
+        uint32_t MeshletCount;
+        bool     Dirty;
+    };
+
+    void RebuildChunk(uint32_t c, std::vector<Meshlet>& meshlets, std::vector<uint32_t>& uniqueVertexIndices, std::vector<PackedTriangle>& primitiveIndices);
+    void RebuildVertexMeshlets();
+
+    std::vector<uint32_t>       m_indices;
+    uint32_t                    m_vertexCount;
+    std::vector<Chunk>          m_chunks;
+
+    std::vector<Meshlet>        m_meshlets;
+    std::vector<uint32_t>       m_uniqueVertexIndices;
+    std::vector<PackedTriangle> m_primitiveIndices;
+    std::vector<CullData>       m_cullData;
+
+    // Meshlets using each vertex: m_vertexMeshlets[m_vertexMeshletStart[v], m_vertexMeshletStart[v + 1]).
+    std::vector<uint32_t>       m_vertexMeshletStart;
+    std::vector<uint32_t>       m_vertexMeshlets;
+
+    std::vector<uint8_t>        m_movedVertices;
+    bool                        m_anyMoved;
+    std::vector<uint32_t>       m_localVertex; // RebuildChunk() scratch, ~0u between calls
+};
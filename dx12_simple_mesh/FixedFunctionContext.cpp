@@ -0,0 +1,610 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "FixedFunctionContext.h"
+
+#include <algorithm>
+
+namespace
+{
+    uint32_t GetIndexSize(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R16_UINT: return 2;
+        case DXGI_FORMAT_R32_UINT: return 4;
+        default:                   return 0;
+        }
+    }
+
+    bool SameBuffers(const DrawBufferSet& a, const DrawBufferSet& b)
+    {
+        for (uint32_t slot = 0; slot < c_maxVertexSlots; ++slot)
+        {
+            if (a.VertexBuffers[slot].BufferLocation != b.VertexBuffers[slot].BufferLocation
+                || a.VertexBuffers[slot].SizeInBytes != b.VertexBuffers[slot].SizeInBytes
+                || a.VertexBuffers[slot].StrideInBytes != b.VertexBuffers[slot].StrideInBytes)
+                return false;
+        }
+
+        return a.IndexBuffer.BufferLocation == b.IndexBuffer.BufferLocation
+            && a.IndexBuffer.SizeInBytes == b.IndexBuffer.SizeInBytes
+            && a.IndexBuffer.Format == b.IndexBuffer.Format;
+    }
+}
+
+bool GetDispatchGroup(
+    const MeshDrawParams& params,
+    uint32_t gridX,
+    uint32_t gridY,
+    uint32_t gridZ,
+    uint32_t& groupX,
+    uint32_t& groupY)
+{
+    const uint32_t linearGroup = gridX + params.GridSizeX * (gridY + params.GridSizeY * gridZ);
+    if (linearGroup >= params.GroupCount)
+        return false;
+
+    groupX = linearGroup % params.GroupsPerRow;
+    groupY = linearGroup / params.GroupsPerRow;
+    return true;
+}
+
+bool GetGroupThreadInput(
+    const MeshDrawParams& params,
+    uint32_t groupX,
+    uint32_t groupY,
+    uint32_t thread,
+    uint32_t& location,
+    uint32_t& instance)
+{
+    uint32_t vertexCount;
+    if (params.InstancesPerGroup > 1)
+    {
+        const uint32_t firstInstance = groupX * params.InstancesPerGroup;
+        const uint32_t instanceCount = firstInstance < params.InstanceCount ? std::min(params.InstanceCount - firstInstance, params.InstancesPerGroup) : 0;
+
+        vertexCount = instanceCount * params.VertexCount;
+        location = params.StartLocation + thread % params.VertexCount;
+        instance = params.FirstInstance + firstInstance + thread / params.VertexCount;
+    }
+    else
+    {
+        const uint32_t firstVertex = groupX * c_groupVertexCount;
+
+        vertexCount = firstVertex < params.VertexCount ? std::min(params.VertexCount - firstVertex, c_groupVertexCount) : 0;
+        location = params.StartLocation + firstVertex + thread;
+        instance = params.FirstInstance + groupY;
+    }
+
+    return thread < vertexCount;
+}
+
+uint32_t FindGroupStripStart(const PrimitiveTopologyInfo& info, const MeshDrawParams& params, uint32_t groupX, const uint32_t* indices)
+{
+    if (indices == nullptr || params.CutIndex == 0)
+        return params.StripStart;
+
+    const uint32_t windowStart = params.StartLocation + groupX * info.GroupPrimitives * info.Step;
+    for (uint32_t l = windowStart; l > params.StripStart; --l)
+    {
+        if (indices[l - 1] == params.CutIndex)
+            return l;
+    }
+
+    return params.StripStart;
+}
+
+void GetGroupStripStarts(const PrimitiveTopologyInfo& info, const MeshDrawParams& params, const uint32_t* indices, uint32_t groupCount, uint32_t* stripStarts)
+{
+    uint32_t stripStart = params.StripStart;
+    uint32_t location = params.StripStart;
+
+    for (uint32_t groupX = 0; groupX < groupCount; ++groupX)
+    {
+        const uint32_t windowStart = params.StartLocation + groupX * info.GroupPrimitives * info.Step;
+        for (; indices != nullptr && params.CutIndex != 0 && location < windowStart; ++location)
+        {
+            if (indices[location] == params.CutIndex)
+            {
+                stripStart = location + 1;
+            }
+        }
+
+        stripStarts[groupX] = stripStart;
+    }
+}
+
+bool GetGroupPrimitive(
+    const PrimitiveTopologyInfo& info,
+    const MeshDrawParams& params,
+    uint32_t groupX,
+    uint32_t slot,
+    const uint32_t* indices,
+    uint32_t groupStripStart,
+    AssembledPrimitive& primitive)
+{
+    const uint32_t slotCount = GetPrimitiveSlotCount(info, params.VertexCount);
+    const uint32_t firstSlot = groupX * info.GroupPrimitives;
+    if (slot >= info.GroupPrimitives || firstSlot >= slotCount || slot >= slotCount - firstSlot)
+        return false;
+
+    const uint32_t windowStart = params.StartLocation + firstSlot * info.Step;
+    const uint32_t location = windowStart + slot * info.Step;
+
+    for (uint32_t k = 0; k < 3; ++k)
+    {
+        primitive.Locations[k] = k < info.VertexCount ? location + info.Offsets[k] : ~0u;
+    }
+
+    if (info.StripStride == 0)
+        return true;
+
+    uint32_t stripStart = groupStripStart;
+    if (indices != nullptr && params.CutIndex != 0)
+    {
+        for (uint32_t k = 0; k < info.Span; ++k)
+        {
+            if (indices[location + k] == params.CutIndex)
+                return false;
+        }
+
+        // Slots look for cuts within the window before them, past the strip the group starts in.
+        for (uint32_t l = location; l > windowStart; --l)
+        {
+            if (indices[l - 1] == params.CutIndex)
+            {
+                stripStart = l;
+                break;
+            }
+        }
+    }
+
+    const uint32_t stripSlot = location - stripStart;
+    if (stripSlot % info.StripStride != 0)
+        return false;
+
+    if (info.AlternateWinding && (stripSlot / info.StripStride) % 2 == 1)
+    {
+        std::swap(primitive.Locations[0], primitive.Locations[1]);
+    }
+
+    if (info.Fan)
+    {
+        primitive.Locations[2] = stripStart;
+    }
+
+    return true;
+}
+
+bool GetPackedThreadInput(
+    const PackedDrawGroup* groups,
+    const PackedDraw* draws,
+    uint32_t groupX,
+    uint32_t thread,
+    uint32_t& draw,
+    uint32_t& location,
+    uint32_t& instance)
+{
+    const PackedDrawGroup& group = groups[groupX];
+
+    for (uint32_t d = group.FirstDraw; d < group.FirstDraw + group.DrawCount; ++d)
+    {
+        const PackedDraw& packed = draws[d];
+
+        const uint32_t local = thread - packed.GroupOffset; // Wraps for threads before the draw
+        if (local < packed.VertexCount * packed.InstanceCount)
+        {
+            draw = d;
+            location = packed.StartLocation + local % packed.VertexCount;
+            instance = local / packed.VertexCount;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void RecordingDrawTarget::SetBuffers(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer)
+{
+    Command command = {};
+    command.Type = Command::SetBuffers;
+    std::copy(vertexBuffers, vertexBuffers + c_maxVertexSlots, command.VertexBuffers);
+    command.IndexBuffer = indexBuffer;
+
+    m_commands.push_back(command);
+}
+
+void RecordingDrawTarget::SetPackedDraws(
+    const DrawBufferSet* bufferSets,
+    uint32_t bufferSetCount,
+    const PackedDraw* draws,
+    uint32_t drawCount,
+    const PackedDrawGroup* groups,
+    uint32_t groupCount)
+{
+    Command command = {};
+    command.Type = Command::SetPackedDraws;
+    command.BufferSets.assign(bufferSets, bufferSets + bufferSetCount);
+    command.Draws.assign(draws, draws + drawCount);
+    command.Groups.assign(groups, groups + groupCount);
+
+    m_commands.push_back(command);
+}
+
+void RecordingDrawTarget::SetDrawParams(const MeshDrawParams& params)
+{
+    Command command = {};
+    command.Type = Command::SetDrawParams;
+    command.Params = params;
+
+    m_commands.push_back(command);
+}
+
+void RecordingDrawTarget::DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    Command command = {};
+    command.Type = Command::DispatchMesh;
+    command.GroupCount[0] = groupCountX;
+    command.GroupCount[1] = groupCountY;
+    command.GroupCount[2] = groupCountZ;
+
+    m_commands.push_back(command);
+}
+
+FixedFunctionContext::FixedFunctionContext(MeshDrawTarget& target)
+    : m_target(target)
+    , m_layout()
+    , m_vertexBuffers{}
+    , m_indexBuffer{}
+    , m_topology(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED)
+    , m_cutIndex(0)
+    , m_buffersDirty(true)
+    , m_skippedDrawCount(0)
+    , m_batching(false)
+    , m_batchMode(PackMode::InOrder)
+    , m_batchBufferSets()
+    , m_batchDraws()
+    , m_batchBufferSet(~0u)
+{
+    std::fill(m_layout.Strides, m_layout.Strides + c_maxVertexSlots, 0u);
+    m_layout.PositionElement = ~0u;
+}
+
+void FixedFunctionContext::SetVertexLayout(const VertexLayout& layout)
+{
+    m_layout = layout;
+}
+
+void FixedFunctionContext::SetIndexBufferStripCutValue(D3D12_INDEX_BUFFER_STRIP_CUT_VALUE cutValue)
+{
+    switch (cutValue)
+    {
+    case D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF:     m_cutIndex = 0xffff; break;
+    case D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFFFFFF: m_cutIndex = 0xffffffff; break;
+    default:                                            m_cutIndex = 0; break;
+    }
+}
+
+void FixedFunctionContext::IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const D3D12_VERTEX_BUFFER_VIEW* views)
+{
+    for (uint32_t i = 0; i < numViews && startSlot + i < c_maxVertexSlots; ++i)
+    {
+        // A null array unbinds the slots, as on a command list.
+        m_vertexBuffers[startSlot + i] = views ? views[i] : D3D12_VERTEX_BUFFER_VIEW{};
+    }
+
+    m_buffersDirty = true;
+    m_batchBufferSet = ~0u;
+}
+
+void FixedFunctionContext::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+{
+    m_indexBuffer = view ? *view : D3D12_INDEX_BUFFER_VIEW{};
+    m_buffersDirty = true;
+    m_batchBufferSet = ~0u;
+}
+
+void FixedFunctionContext::IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+    m_topology = topology;
+}
+
+void FixedFunctionContext::DrawInstanced(
+    uint32_t vertexCountPerInstance,
+    uint32_t instanceCount,
+    uint32_t startVertexLocation,
+    uint32_t startInstanceLocation)
+{
+    if (!CanDraw(false))
+    {
+        ++m_skippedDrawCount;
+        return;
+    }
+
+    MeshDrawParams params = {};
+    params.StartLocation = startVertexLocation;
+    params.StartInstance = startInstanceLocation;
+
+    Dispatch(vertexCountPerInstance, instanceCount, params);
+}
+
+void FixedFunctionContext::DrawIndexedInstanced(
+    uint32_t indexCountPerInstance,
+    uint32_t instanceCount,
+    uint32_t startIndexLocation,
+    int32_t baseVertexLocation,
+    uint32_t startInstanceLocation)
+{
+    if (!CanDraw(true))
+    {
+        ++m_skippedDrawCount;
+        return;
+    }
+
+    MeshDrawParams params = {};
+    params.IndexSize = GetIndexSize(m_indexBuffer.Format);
+    params.BaseVertex = baseVertexLocation;
+    params.StartInstance = startInstanceLocation;
+    params.CutIndex = m_cutIndex;
+
+    // The index buffer is bound from its location rounded down to 4 bytes.
+    params.StartLocation = startIndexLocation + static_cast<uint32_t>(m_indexBuffer.BufferLocation & 3) / params.IndexSize;
+
+    Dispatch(indexCountPerInstance, instanceCount, params);
+}
+
+void FixedFunctionContext::BeginDrawBatch(PackMode::EType mode)
+{
+    FlushDrawBatch();
+
+    m_batching = true;
+    m_batchMode = mode;
+}
+
+void FixedFunctionContext::EndDrawBatch()
+{
+    FlushDrawBatch();
+
+    m_batching = false;
+}
+
+bool FixedFunctionContext::CanDraw(bool indexed) const
+{
+    if (GetPrimitiveTopologyInfo(m_topology) == nullptr)
+        return false;
+
+    if (indexed)
+    {
+        const uint32_t indexSize = GetIndexSize(m_indexBuffer.Format);
+        if (indexSize == 0 || m_indexBuffer.BufferLocation % indexSize != 0)
+            return false;
+    }
+
+    for (const VertexElement& elem : m_layout.Elements)
+    {
+        const D3D12_VERTEX_BUFFER_VIEW& view = m_vertexBuffers[elem.Slot];
+        if (view.SizeInBytes == 0)
+            continue; // Unbound slots read as zero
+
+        if (view.StrideInBytes != m_layout.Strides[elem.Slot] || view.BufferLocation % 4 != 0)
+            return false;
+    }
+
+    return true;
+}
+
+void FixedFunctionContext::Dispatch(uint32_t vertexCount, uint32_t instanceCount, const MeshDrawParams& params)
+{
+    const PrimitiveTopologyInfo& info = *GetPrimitiveTopologyInfo(m_topology);
+
+    // Incomplete primitives are discarded, as by the input assembler.
+    const uint32_t slotCount = GetPrimitiveSlotCount(info, vertexCount);
+    if (slotCount == 0 || instanceCount == 0)
+        return;
+
+    vertexCount = (slotCount - 1) * info.Step + info.Span;
+
+    // Only triangle lists pack; their primitives never share vertices.
+    const bool packable = m_topology == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+    if (m_batching)
+    {
+        if (packable && instanceCount <= c_groupVertexCount / vertexCount)
+        {
+            QueuePackedDraw(vertexCount, instanceCount, params);
+            return;
+        }
+
+        if (m_batchMode == PackMode::InOrder)
+        {
+            FlushDrawBatch();
+        }
+    }
+
+    if (m_buffersDirty)
+    {
+        m_target.SetBuffers(m_vertexBuffers, m_indexBuffer);
+        m_buffersDirty = false;
+    }
+
+    // Pack instances of small meshes into groups; triangles never straddle instances, as
+    // vertexCount is a multiple of 3.
+    if (packable && vertexCount <= c_groupVertexCount / 2)
+    {
+        const uint32_t instancesPerGroup = c_groupVertexCount / vertexCount;
+        const uint32_t maxInstances = c_maxDispatchGroups * instancesPerGroup;
+
+        for (uint32_t instance = 0; instance < instanceCount; )
+        {
+            const uint32_t runInstances = std::min(instanceCount - instance, maxInstances);
+
+            MeshDrawParams dispatchParams = params;
+            dispatchParams.VertexCount = vertexCount;
+            dispatchParams.FirstInstance = instance;
+            dispatchParams.InstanceCount = runInstances;
+            dispatchParams.InstancesPerGroup = instancesPerGroup;
+
+            DispatchGroups(dispatchParams, GetDispatchGroupCount(runInstances, instancesPerGroup), 1);
+
+            instance += runInstances;
+        }
+
+        return;
+    }
+
+    // Runs of whole groups keep primitives from straddling dispatches. Strips and fans are
+    // assembled relative to the draw's first location, whichever run they fall in.
+    const uint32_t maxRunSlots = c_maxDispatchGroups * info.GroupPrimitives;
+
+    for (uint32_t first = 0; first < slotCount; )
+    {
+        const uint32_t runSlots = std::min(slotCount - first, maxRunSlots);
+        const uint32_t groupCount = GetDispatchGroupCount(runSlots, info.GroupPrimitives);
+        const uint32_t maxInstances = c_maxDispatchGroups / groupCount;
+
+        for (uint32_t instance = 0; instance < instanceCount; )
+        {
+            const uint32_t rowCount = std::min(instanceCount - instance, maxInstances);
+
+            MeshDrawParams dispatchParams = params;
+            dispatchParams.VertexCount = (runSlots - 1) * info.Step + info.Span;
+            dispatchParams.StartLocation += first * info.Step;
+            dispatchParams.FirstInstance = instance;
+            dispatchParams.InstanceCount = rowCount;
+            dispatchParams.InstancesPerGroup = 1;
+            dispatchParams.StripStart = params.StartLocation;
+
+            DispatchGroups(dispatchParams, groupCount, rowCount);
+
+            instance += rowCount;
+        }
+
+        first += runSlots;
+    }
+}
+
+void FixedFunctionContext::DispatchGroups(MeshDrawParams params, uint32_t groupsPerRow, uint32_t rowCount)
+{
+    // Callers keep the groups within c_maxDispatchGroups, so planning cannot fail.
+    DispatchPlan plan;
+    PlanDispatch(groupsPerRow * rowCount, plan);
+
+    params.GroupCount = plan.GroupCount;
+    params.GridSizeX = plan.GridSize[0];
+    params.GridSizeY = plan.GridSize[1];
+    params.GroupsPerRow = groupsPerRow;
+
+    m_target.SetDrawParams(params);
+    m_target.DispatchMesh(plan.GridSize[0], plan.GridSize[1], plan.GridSize[2]);
+}
+
+void FixedFunctionContext::QueuePackedDraw(uint32_t vertexCount, uint32_t instanceCount, const MeshDrawParams& params)
+{
+    if (m_batchDraws.size() == c_maxPackedDraws)
+    {
+        FlushDrawBatch();
+    }
+
+    if (m_batchBufferSet == ~0u)
+    {
+        DrawBufferSet bufferSet;
+        std::copy(m_vertexBuffers, m_vertexBuffers + c_maxVertexSlots, bufferSet.VertexBuffers);
+        bufferSet.IndexBuffer = m_indexBuffer;
+
+        // Draws that share bindings share a buffer set.
+        auto it = std::find_if(m_batchBufferSets.begin(), m_batchBufferSets.end(), [&](const DrawBufferSet& s) { return SameBuffers(s, bufferSet); });
+        if (it == m_batchBufferSets.end())
+        {
+            if (m_batchBufferSets.size() == c_maxPackedBufferSets)
+            {
+                FlushDrawBatch();
+            }
+
+            m_batchBufferSets.push_back(bufferSet);
+            it = m_batchBufferSets.end() - 1;
+        }
+
+        m_batchBufferSet = static_cast<uint32_t>(it - m_batchBufferSets.begin());
+    }
+
+    PackedDraw draw = {};
+    draw.BufferSet = m_batchBufferSet;
+    draw.IndexSize = params.IndexSize;
+    draw.StartLocation = params.StartLocation;
+    draw.BaseVertex = params.BaseVertex;
+    draw.VertexCount = vertexCount;
+    draw.StartInstance = params.StartInstance;
+    draw.InstanceCount = instanceCount;
+
+    m_batchDraws.push_back(draw);
+}
+
+void FixedFunctionContext::FlushDrawBatch()
+{
+    if (m_batchDraws.empty())
+        return;
+
+    const uint32_t drawCount = static_cast<uint32_t>(m_batchDraws.size());
+
+    std::vector<PackItem> items(drawCount);
+    for (uint32_t i = 0; i < drawCount; ++i)
+    {
+        items[i].VertexCount = m_batchDraws[i].VertexCount * m_batchDraws[i].InstanceCount;
+        items[i].PrimitiveCount = items[i].VertexCount / 3;
+    }
+
+    // Queued draws all fit a group, so packing cannot fail.
+    const PackLimits limits = { c_groupVertexCount, c_groupVertexCount / 3 };
+
+    std::vector<PackGroup> packGroups;
+    std::vector<uint32_t> order;
+    PackItems(items.data(), drawCount, limits, m_batchMode, packGroups, order);
+
+    // Each group's draws take consecutive runs of its threads.
+    std::vector<PackedDraw> draws(drawCount);
+    std::vector<PackedDrawGroup> groups(packGroups.size());
+
+    for (size_t g = 0; g < packGroups.size(); ++g)
+    {
+        const PackGroup& packGroup = packGroups[g];
+
+        groups[g].FirstDraw = packGroup.FirstItem;
+        groups[g].DrawCount = packGroup.ItemCount;
+        groups[g].VertexCount = packGroup.VertexCount;
+        groups[g].Padding = 0;
+
+        uint32_t offset = 0;
+        for (uint32_t i = packGroup.FirstItem; i < packGroup.FirstItem + packGroup.ItemCount; ++i)
+        {
+            draws[i] = m_batchDraws[order[i]];
+            draws[i].GroupOffset = offset;
+            offset += items[order[i]].VertexCount;
+        }
+    }
+
+    m_target.SetPackedDraws(
+        m_batchBufferSets.data(), static_cast<uint32_t>(m_batchBufferSets.size()),
+        draws.data(), drawCount,
+        groups.data(), static_cast<uint32_t>(groups.size()));
+
+    MeshDrawParams params = {};
+    params.PackedGroups = drawCount * sizeof(PackedDraw);
+
+    DispatchGroups(params, static_cast<uint32_t>(groups.size()), 1);
+
+    m_batchBufferSets.clear();
+    m_batchDraws.clear();
+    m_batchBufferSet = ~0u;
+
+    // The packed dispatch replaced the bound buffers.
+    m_buffersDirty = true;
+}
@@ -0,0 +1,279 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "DispatchPlanner.h"
+#include "DrawPacker.h"
+#include "PrimitiveAssembly.h"
+#include "VertexFormat.h"
+
+#include <vector>
+
+// Vertices each mesh shader group consumes of a triangle list; must match GROUP_PRIMS * 3 of
+// the triangle list shader in MeshletMS.hlsl.
+const uint32_t c_groupVertexCount = 63;
+
+// Raw buffers the mesh shader reads a draw from: the vertex slots, then the index buffer.
+const uint32_t c_drawBufferCount = c_maxVertexSlots + 1;
+
+// Most draws, and distinct buffer bindings, a packed dispatch covers. Bounds the descriptors
+// and records a draw target writes for it.
+const uint32_t c_maxPackedDraws = 1024;
+const uint32_t c_maxPackedBufferSets = 64;
+
+// Mirrors DrawParams in MeshletMS.hlsl, set as root constants.
+struct MeshDrawParams
+{
+    uint32_t IndexSize;         // 2 or 4 for indexed draws, 0 otherwise
+    uint32_t VertexCount;       // Vertices (or indices) per instance covered by this dispatch
+    uint32_t StartLocation;     // First vertex, or first index, of this dispatch
+    int32_t  BaseVertex;        // Added to every index
+    uint32_t FirstInstance;     // Instance ID of the dispatch's first instance
+    uint32_t StartInstance;     // StartInstanceLocation of the draw
+    uint32_t InstanceCount;     // Instances covered by this dispatch
+    uint32_t InstancesPerGroup; // Whole instances packed into each group along X, or 1
+    uint32_t PackedGroups;      // Byte offset of the PackedDrawGroup records for packed dispatches, 0 otherwise
+    uint32_t StripStart;        // First location of the draw, where its first strip or fan starts
+    uint32_t CutIndex;          // Index value that restarts strips and fans, 0 when restart is disabled
+    uint32_t GroupCount;        // Groups of the dispatch that do work; the rest of the grid exits
+    uint32_t GridSizeX;         // DispatchMesh() group counts, to linearize SV_GroupID with
+    uint32_t GridSizeY;
+    uint32_t GroupsPerRow;      // Groups along the draw per instance row; rows are instances
+};
+
+// The buffers a draw reads.
+struct DrawBufferSet
+{
+    D3D12_VERTEX_BUFFER_VIEW VertexBuffers[c_maxVertexSlots];
+    D3D12_INDEX_BUFFER_VIEW  IndexBuffer;
+};
+
+// Mirrors PackedDraw in MeshletMS.hlsl: one draw of a packed dispatch, all of whose instances
+// are drawn by one group.
+struct PackedDraw
+{
+    uint32_t BufferSet;     // Index of the DrawBufferSet the draw reads
+    uint32_t IndexSize;     // 2 or 4 for indexed draws, 0 otherwise
+    uint32_t StartLocation; // First vertex, or first index
+    int32_t  BaseVertex;    // Added to every index
+    uint32_t VertexCount;   // Vertices (or indices) per instance
+    uint32_t StartInstance; // StartInstanceLocation of the draw
+    uint32_t InstanceCount;
+    uint32_t GroupOffset;   // Group thread of the draw's first vertex
+};
+
+// Mirrors PackedDrawGroup in MeshletMS.hlsl: the draws of one group of a packed dispatch.
+struct PackedDrawGroup
+{
+    uint32_t FirstDraw;
+    uint32_t DrawCount;
+    uint32_t VertexCount;   // Threads the group's draws occupy
+    uint32_t Padding;
+};
+
+// CPU reference of how main() in MeshletMS.hlsl places a group of the dispatch's grid: its
+// position along the draw (or the packed groups) and its row. Returns false for spare groups.
+bool GetDispatchGroup(
+    const MeshDrawParams& params,
+    uint32_t gridX,
+    uint32_t gridY,
+    uint32_t gridZ,
+    uint32_t& groupX,
+    uint32_t& groupY);
+
+// CPU reference of how main() in MeshletMS.hlsl assigns work to a group thread of a triangle
+// list: the location in the draw's vertex or index stream it reads, and its instance ID.
+// Returns false for threads left idle.
+bool GetGroupThreadInput(
+    const MeshDrawParams& params,
+    uint32_t groupX,
+    uint32_t groupY,
+    uint32_t thread,
+    uint32_t& location,
+    uint32_t& instance);
+
+// The same for a packed dispatch: the draw a group thread works on, the location in that
+// draw's stream and the instance ID.
+bool GetPackedThreadInput(
+    const PackedDrawGroup* groups,
+    const PackedDraw* draws,
+    uint32_t groupX,
+    uint32_t thread,
+    uint32_t& draw,
+    uint32_t& location,
+    uint32_t& instance);
+
+// CPU reference of FindStripStart() in MeshletMS.hlsl: where the strip (or fan) holding the
+// first location of a group's window starts, one past the last cut before the window, else
+// params.StripStart. 'indices' holds the draw's index values by location for indexed draws,
+// or is null. Scans back from the window, so the groups of a strip cost the
+// square of its length between them; GetGroupStripStarts() finds them all in one pass.
+uint32_t FindGroupStripStart(const PrimitiveTopologyInfo& info, const MeshDrawParams& params, uint32_t groupX, const uint32_t* indices);
+
+// FindGroupStripStart() of groups 0 to groupCount - 1, in one pass over the indices.
+void GetGroupStripStarts(const PrimitiveTopologyInfo& info, const MeshDrawParams& params, const uint32_t* indices, uint32_t groupCount, uint32_t* stripStarts);
+
+// CPU reference of how main() in MeshletMS.hlsl assembles primitive slot 'slot' of a group
+// outside packed dispatches: the locations of its vertices, with the fan's first vertex last.
+// 'indices' is as for FindGroupStripStart() and 'groupStripStart' is what it returns for the
+// group. Returns false for slots past the draw and slots a cut index or strip alignment
+// discards.
+bool GetGroupPrimitive(
+    const PrimitiveTopologyInfo& info,
+    const MeshDrawParams& params,
+    uint32_t groupX,
+    uint32_t slot,
+    const uint32_t* indices,
+    uint32_t groupStripStart,
+    AssembledPrimitive& primitive);
+
+// The commands a translated draw is made of, implemented over a command list or recorded.
+class MeshDrawTarget
+{
+public:
+    virtual ~MeshDrawTarget() {}
+
+    // Binds c_maxVertexSlots vertex buffers and an index buffer for the mesh shader to read
+    // raw. Views are bound from their BufferLocation rounded down to 4 bytes; views with no
+    // size are unbound.
+    virtual void SetBuffers(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer) = 0;
+
+    // Binds the buffer sets and records of a packed dispatch in place of SetBuffers(). The
+    // draws are laid out first and the groups after them, at byte offset
+    // drawCount * sizeof(PackedDraw), as MeshDrawParams::PackedGroups expects.
+    virtual void SetPackedDraws(
+        const DrawBufferSet* bufferSets,
+        uint32_t bufferSetCount,
+        const PackedDraw* draws,
+        uint32_t drawCount,
+        const PackedDrawGroup* groups,
+        uint32_t groupCount) = 0;
+
+    virtual void SetDrawParams(const MeshDrawParams& params) = 0;
+    virtual void DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
+};
+
+// Keeps the commands it receives so a translation can be inspected.
+class RecordingDrawTarget : public MeshDrawTarget
+{
+public:
+    struct Command
+    {
+        enum EType : uint32_t
+        {
+            SetBuffers,
+            SetPackedDraws,
+            SetDrawParams,
+            DispatchMesh,
+        };
+
+        EType                        Type;
+        D3D12_VERTEX_BUFFER_VIEW     VertexBuffers[c_maxVertexSlots]; // SetBuffers
+        D3D12_INDEX_BUFFER_VIEW      IndexBuffer;                     // SetBuffers
+        std::vector<DrawBufferSet>   BufferSets;                      // SetPackedDraws
+        std::vector<PackedDraw>      Draws;                           // SetPackedDraws
+        std::vector<PackedDrawGroup> Groups;                          // SetPackedDraws
+        MeshDrawParams               Params;                          // SetDrawParams
+        uint32_t                     GroupCount[3];                   // DispatchMesh
+    };
+
+    void SetBuffers(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer) override;
+    void SetPackedDraws(
+        const DrawBufferSet* bufferSets,
+        uint32_t bufferSetCount,
+        const PackedDraw* draws,
+        uint32_t drawCount,
+        const PackedDrawGroup* groups,
+        uint32_t groupCount) override;
+    void SetDrawParams(const MeshDrawParams& params) override;
+    void DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+
+    const std::vector<Command>& GetCommands() const { return m_commands; }
+    void Clear() { m_commands.clear(); }
+
+private:
+    std::vector<Command> m_commands;
+};
+
+// The input assembler's draw API on top of the mesh shader in MeshletMS.hlsl. Each draw
+// becomes DispatchMesh() calls of PrimitiveTopologyInfo::GroupPrimitives primitives per group
+// and one row of groups per instance, laid out over the grid by PlanDispatch() and split
+// where a single dispatch would exceed c_maxDispatchGroups. Groups of indexed triangle lists
+// fetch and transform each distinct index value of their window once (see VertexReuse.h).
+// Triangle lists small enough for several copies to fit a group are instead packed whole
+// instances per group, so instanced small meshes don't leave most of each group idle. Within
+// a draw batch, small triangle lists are packed with each other, across buffer bindings, the
+// same way.
+class FixedFunctionContext
+{
+public:
+    explicit FixedFunctionContext(MeshDrawTarget& target);
+
+    // Stands in for the input layout of the bound pipeline state; the mesh shader fetches
+    // with its strides, so bound views must agree with them.
+    void SetVertexLayout(const VertexLayout& layout);
+
+    // Stands in for IBStripCutValue of the bound pipeline state: the index value that restarts
+    // strips and fans. The pipeline's mesh shader must be generated for the topology set
+    // with IASetPrimitiveTopology().
+    void SetIndexBufferStripCutValue(D3D12_INDEX_BUFFER_STRIP_CUT_VALUE cutValue);
+
+    void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const D3D12_VERTEX_BUFFER_VIEW* views);
+    void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view);
+    void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+
+    void DrawInstanced(
+        uint32_t vertexCountPerInstance,
+        uint32_t instanceCount,
+        uint32_t startVertexLocation,
+        uint32_t startInstanceLocation);
+
+    void DrawIndexedInstanced(
+        uint32_t indexCountPerInstance,
+        uint32_t instanceCount,
+        uint32_t startIndexLocation,
+        int32_t baseVertexLocation,
+        uint32_t startInstanceLocation);
+
+    // Draws the mesh shader cannot perform as specified (patch list topologies, unsupported
+    // index formats, views that disagree with the vertex layout) are skipped and counted.
+    uint32_t GetSkippedDrawCount() const { return m_skippedDrawCount; }
+
+    // Draws between BeginDrawBatch() and EndDrawBatch() whose instances all fit one group are
+    // queued and packed into shared groups, whatever buffers each reads, then issued as one
+    // DispatchMesh() when the batch ends or fills up. Larger draws go out as they come; with
+    // PackMode::InOrder the queue is flushed ahead of them so drawing order holds. The
+    // pipeline state must stay unchanged within a batch.
+    void BeginDrawBatch(PackMode::EType mode);
+    void EndDrawBatch();
+
+private:
+    bool CanDraw(bool indexed) const;
+    void Dispatch(uint32_t vertexCount, uint32_t instanceCount, const MeshDrawParams& params);
+    void DispatchGroups(MeshDrawParams params, uint32_t groupsPerRow, uint32_t rowCount);
+    void QueuePackedDraw(uint32_t vertexCount, uint32_t instanceCount, const MeshDrawParams& params);
+    void FlushDrawBatch();
+
+    MeshDrawTarget&            m_target;
+    VertexLayout               m_layout;
+    D3D12_VERTEX_BUFFER_VIEW   m_vertexBuffers[c_maxVertexSlots];
+    D3D12_INDEX_BUFFER_VIEW    m_indexBuffer;
+    D3D12_PRIMITIVE_TOPOLOGY   m_topology;
+    uint32_t                   m_cutIndex;
+    bool                       m_buffersDirty;
+    uint32_t                   m_skippedDrawCount;
+
+    bool                       m_batching;
+    PackMode::EType            m_batchMode;
+    std::vector<DrawBufferSet> m_batchBufferSets;
+    std::vector<PackedDraw>    m_batchDraws;
+    uint32_t                   m_batchBufferSet; // Current bindings in m_batchBufferSets, or ~0u
+};
@@ -0,0 +1,113 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "FrameTimeLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+double ComputePercentile(const double* sorted, size_t count, double percentile)
+{
+    if (count == 0)
+        return 0.0;
+
+    const double rank = std::min(std::max(percentile, 0.0), 100.0) / 100.0 * static_cast<double>(count - 1);
+    const size_t lower = static_cast<size_t>(std::floor(rank));
+    const size_t upper = std::min(lower + 1, count - 1);
+    const double t = rank - static_cast<double>(lower);
+
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * t;
+}
+
+FrameTimeStats ComputeFrameTimeStats(std::vector<double>& samples)
+{
+    FrameTimeStats stats = {};
+    if (samples.empty())
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double sample : samples)
+    {
+        sum += sample;
+    }
+
+    stats.Min = samples.front();
+    stats.Mean = sum / static_cast<double>(samples.size());
+    stats.P50 = ComputePercentile(samples.data(), samples.size(), 50.0);
+    stats.P95 = ComputePercentile(samples.data(), samples.size(), 95.0);
+    stats.P99 = ComputePercentile(samples.data(), samples.size(), 99.0);
+    stats.Max = samples.back();
+
+    return stats;
+}
+
+FrameTimeStats FrameTimeLog::GetCpuStats() const
+{
+    std::vector<double> samples(m_frames.size());
+    std::transform(m_frames.begin(), m_frames.end(), samples.begin(), [](const Frame& frame) { return frame.CpuMs; });
+    return ComputeFrameTimeStats(samples);
+}
+
+FrameTimeStats FrameTimeLog::GetGpuStats() const
+{
+    std::vector<double> samples(m_frames.size());
+    std::transform(m_frames.begin(), m_frames.end(), samples.begin(), [](const Frame& frame) { return frame.GpuMs; });
+    return ComputeFrameTimeStats(samples);
+}
+
+HRESULT FrameTimeLog::WriteCsv(const wchar_t* filename) const
+{
+    std::ofstream stream(GetStreamPath(filename));
+    if (!stream.is_open())
+    {
+        return E_INVALIDARG;
+    }
+
+    char line[128];
+
+    stream << "frame,time_s,cpu_ms,gpu_ms\n";
+    for (size_t i = 0; i < m_frames.size(); ++i)
+    {
+        const Frame& frame = m_frames[i];
+        snprintf(line, sizeof(line), "%zu,%.6f,%.4f,%.4f\n", i, frame.TimeSeconds, frame.CpuMs, frame.GpuMs);
+        stream << line;
+    }
+
+    const FrameTimeStats cpu = GetCpuStats();
+    const FrameTimeStats gpu = GetGpuStats();
+
+    const struct
+    {
+        const char* Name;
+        double      Cpu;
+        double      Gpu;
+    } rows[] =
+    {
+        { "min",  cpu.Min,  gpu.Min },
+        { "mean", cpu.Mean, gpu.Mean },
+        { "p50",  cpu.P50,  gpu.P50 },
+        { "p95",  cpu.P95,  gpu.P95 },
+        { "p99",  cpu.P99,  gpu.P99 },
+        { "max",  cpu.Max,  gpu.Max },
+    };
+
+    for (auto& row : rows)
+    {
+        snprintf(line, sizeof(line), "%s,,%.4f,%.4f\n", row.Name, row.Cpu, row.Gpu);
+        stream << line;
+    }
+
+    return stream.good() ? S_OK : E_FAIL;
+}
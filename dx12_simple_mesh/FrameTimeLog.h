@@ -0,0 +1,70 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Platform.h"
+
+#include <cstddef>
+#include <vector>
+
+// Summary of a set of frame times, in whatever unit they were recorded in.
+struct FrameTimeStats
+{
+    double Min;
+    double Mean;
+    double P50;
+    double P95;
+    double P99;
+    double Max;
+};
+
+// The 'percentile' (0 to 100) of 'count' ascending samples, interpolating linearly between the
+// two nearest ranks. Returns 0 for no samples.
+double ComputePercentile(const double* sorted, size_t count, double percentile);
+
+// Sorts 'samples' and summarizes them.
+FrameTimeStats ComputeFrameTimeStats(std::vector<double>& samples);
+
+// Per-frame CPU and GPU times of a benchmark run, written out as CSV once it ends:
+//
+//     frame,time_s,cpu_ms,gpu_ms
+//     0,0.016667,1.204,0.388
+//     ...
+//     p50,,1.198,0.391
+//
+// Each frame's row gives its simulation time; the rows that follow the frames summarize them
+// (min, mean, p50, p95, p99 and max), naming the statistic in the frame column.
+class FrameTimeLog
+{
+public:
+    struct Frame
+    {
+        double TimeSeconds;  // Simulation time the frame was updated to
+        double CpuMs;        // Recording and submission on the CPU
+        double GpuMs;        // Execution of the frame's work
+    };
+
+    void Reserve(size_t frameCount) { m_frames.reserve(frameCount); }
+    void Clear() { m_frames.clear(); }
+
+    void Record(double timeSeconds, double cpuMs, double gpuMs) { m_frames.push_back({ timeSeconds, cpuMs, gpuMs }); }
+
+    size_t GetFrameCount() const { return m_frames.size(); }
+    const std::vector<Frame>& GetFrames() const { return m_frames; }
+
+    FrameTimeStats GetCpuStats() const;
+    FrameTimeStats GetGpuStats() const;
+
+    HRESULT WriteCsv(const wchar_t* filename) const;
+
+private:
+    std::vector<Frame> m_frames;
+};
@@ -0,0 +1,232 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "LodGenerator.h"
+
+#include "MeshSimplifier.h"
+#include "ParallelFor.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    // Inputs to the simplifier shared by every subset and LOD of a mesh.
+    struct SimplifyInputs
+    {
+        std::vector<XMFLOAT3> Positions;
+        std::vector<float>    Attributes;
+        std::vector<float>    Weights;
+        uint32_t              Stride;
+    };
+
+    struct SubsetTask
+    {
+        uint32_t Lod;
+        uint32_t Mesh;
+        uint32_t Subset;
+    };
+
+    void PrepareInputs(const MeshData& mesh, const LodOptions& options, SimplifyInputs& inputs)
+    {
+        inputs.Positions.resize(mesh.VertexCount);
+
+        XMFLOAT3 mn(FLT_MAX, FLT_MAX, FLT_MAX);
+        XMFLOAT3 mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (uint32_t v = 0; v < mesh.VertexCount; ++v)
+        {
+            const XMFLOAT3& p = mesh.GetPosition(v);
+            inputs.Positions[v] = p;
+
+            mn = XMFLOAT3(std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z));
+            mx = XMFLOAT3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+        }
+
+        // Attribute costs are relative to the mesh size so the options are scale independent.
+        const float dx = mx.x - mn.x, dy = mx.y - mn.y, dz = mx.z - mn.z;
+        const float radiusSq = mesh.VertexCount > 0 ? (dx * dx + dy * dy + dz * dz) * 0.25f : 0.0f;
+
+        inputs.Weights.clear();
+        if (mesh.HasAttribute(Attribute::Normal))
+        {
+            inputs.Weights.insert(inputs.Weights.end(), 3, options.NormalWeight * radiusSq);
+        }
+        if (mesh.HasAttribute(Attribute::TexCoord))
+        {
+            inputs.Weights.insert(inputs.Weights.end(), 2, options.TexCoordWeight * radiusSq);
+        }
+
+        inputs.Stride = static_cast<uint32_t>(inputs.Weights.size());
+        inputs.Attributes.resize(size_t(mesh.VertexCount) * inputs.Stride);
+
+        for (uint32_t v = 0; v < mesh.VertexCount; ++v)
+        {
+            float* dst = &inputs.Attributes[size_t(v) * inputs.Stride];
+            if (mesh.HasAttribute(Attribute::Normal))
+            {
+                const float* n = mesh.GetAttribute(Attribute::Normal, v);
+                *dst++ = n[0]; *dst++ = n[1]; *dst++ = n[2];
+            }
+            if (mesh.HasAttribute(Attribute::TexCoord))
+            {
+                const float* uv = mesh.GetAttribute(Attribute::TexCoord, v);
+                *dst++ = uv[0]; *dst++ = uv[1];
+            }
+        }
+    }
+}
+
+LodOptions::LodOptions()
+    : TriangleRatio(0.5f)
+    , NormalWeight(1e-3f)
+    , TexCoordWeight(1e-2f)
+    , ThreadCount(0)
+{ }
+
+void GenerateLodChain(
+    const std::vector<MeshData>& base,
+    uint32_t lodCount,
+    const LodOptions& options,
+    std::vector<std::vector<MeshData>>& lods,
+    std::vector<float>& errors)
+{
+    lods.assign(lodCount, std::vector<MeshData>(base.size()));
+    errors.assign(lodCount, 0.0f);
+
+    if (lodCount == 0)
+        return;
+
+    lods[0] = base;
+
+    const uint32_t meshCount = static_cast<uint32_t>(base.size());
+
+    std::vector<SimplifyInputs> inputs(meshCount);
+    for (uint32_t m = 0; m < meshCount; ++m)
+    {
+        PrepareInputs(base[m], options, inputs[m]);
+    }
+
+    // One task per subset per LOD; subsets share their mesh's vertices but not triangles.
+    std::vector<SubsetTask> tasks;
+    std::vector<uint32_t> firstTask;
+    for (uint32_t lod = 1; lod < lodCount; ++lod)
+    {
+        for (uint32_t m = 0; m < meshCount; ++m)
+        {
+            firstTask.push_back(static_cast<uint32_t>(tasks.size()));
+            for (uint32_t s = 0; s < base[m].IndexSubsets.size(); ++s)
+            {
+                tasks.push_back({ lod, m, s });
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> results(tasks.size());
+    std::vector<float> taskErrors(tasks.size(), 0.0f);
+
+    ParallelFor(static_cast<uint32_t>(tasks.size()), [&](uint32_t i, uint32_t)
+    {
+        const SubsetTask& task = tasks[i];
+        const MeshData& mesh = base[task.Mesh];
+        const SimplifyInputs& input = inputs[task.Mesh];
+        const Subset& subset = mesh.IndexSubsets[task.Subset];
+
+        const float ratio = std::pow(options.TriangleRatio, static_cast<float>(task.Lod));
+        const uint32_t targetTris = std::max(1u, static_cast<uint32_t>(subset.Count / 3 * ratio));
+
+        SimplifyDesc desc = {};
+        desc.Positions = input.Positions.data();
+        desc.VertexCount = mesh.VertexCount;
+        desc.Indices = mesh.Indices.data() + subset.Offset;
+        desc.IndexCount = subset.Count;
+        desc.Attributes = input.Stride > 0 ? input.Attributes.data() : nullptr;
+        desc.AttributeWeights = input.Weights.data();
+        desc.AttributeStride = input.Stride;
+        desc.TargetIndexCount = targetTris * 3;
+        desc.TargetError = FLT_MAX;
+
+        taskErrors[i] = SimplifyMesh(desc, results[i]);
+    }, options.ThreadCount);
+
+    // Stitch the subsets back together, drop unused vertices and rebuild the meshlets.
+    ParallelFor((lodCount - 1) * meshCount, [&](uint32_t i, uint32_t)
+    {
+        const uint32_t lod = 1 + i / meshCount;
+        const MeshData& source = base[i % meshCount];
+        MeshData& mesh = lods[lod][i % meshCount];
+
+        memcpy(mesh.AttributeOffsets, source.AttributeOffsets, sizeof(mesh.AttributeOffsets));
+        mesh.VertexStride = source.VertexStride;
+        mesh.VertexCount = source.VertexCount;
+        mesh.Vertices = source.Vertices;
+
+        for (uint32_t s = 0; s < source.IndexSubsets.size(); ++s)
+        {
+            const std::vector<uint32_t>& indices = results[firstTask[i] + s];
+
+            mesh.IndexSubsets.push_back({ static_cast<uint32_t>(mesh.Indices.size()), static_cast<uint32_t>(indices.size()) });
+            mesh.Indices.insert(mesh.Indices.end(), indices.begin(), indices.end());
+        }
+
+        CompactVertices(mesh);
+        BuildMeshlets(mesh);
+    }, options.ThreadCount);
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        errors[tasks[i].Lod] = std::max(errors[tasks[i].Lod], taskErrors[i]);
+    }
+
+    for (uint32_t lod = 1; lod < lodCount; ++lod)
+    {
+        errors[lod] = std::max(errors[lod], errors[lod - 1]);
+    }
+}
+
+HRESULT GenerateLodFiles(
+    const wchar_t* sourceFilename,
+    const wchar_t* const* filenames,
+    uint32_t lodCount,
+    const LodOptions& options,
+    std::vector<float>* errors)
+{
+    Model model;
+    HRESULT hr = model.LoadFromFile(sourceFilename);
+    if (FAILED(hr))
+        return hr;
+
+    std::vector<MeshData> base(model.GetMeshCount());
+    for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+    {
+        ExtractMeshData(model.GetMesh(m), base[m]);
+    }
+
+    std::vector<std::vector<MeshData>> lods;
+    std::vector<float> lodErrors;
+    GenerateLodChain(base, lodCount, options, lods, lodErrors);
+
+    for (uint32_t lod = 1; lod < lodCount; ++lod)
+    {
+        hr = WriteMeshFile(filenames[lod - 1], lods[lod]);
+        if (FAILED(hr))
+            return hr;
+    }
+
+    if (errors)
+    {
+        *errors = lodErrors;
+    }
+
+    return S_OK;
+}
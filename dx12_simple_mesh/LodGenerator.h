@@ -0,0 +1,47 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "MeshData.h"
+
+#include <vector>
+
+struct LodOptions
+{
+    LodOptions();
+
+    float    TriangleRatio;  // Fraction of triangles each LOD keeps from the previous one
+    float    NormalWeight;   // Cost of a unit change in normal, as a fraction of the mesh radius squared
+    float    TexCoordWeight; // Cost of a unit change in texture coordinate, likewise
+    uint32_t ThreadCount;    // 0 uses every hardware thread
+};
+
+// Simplifies every index subset of 'base' into lodCount - 1 progressively coarser LODs
+// and rebuilds their meshlets and cull data. Every LOD is simplified directly from the
+// base mesh, so its error is measured against the original surface.
+//
+// lods[0] is a copy of the base meshes. errors[i] receives the object-space error of
+// LOD i, kept non-decreasing so it can be fed to LodGroup::SetLodError().
+void GenerateLodChain(
+    const std::vector<MeshData>& base,
+    uint32_t lodCount,
+    const LodOptions& options,
+    std::vector<std::vector<MeshData>>& lods,
+    std::vector<float>& errors);
+
+// Loads an MSHL file, generates its LOD chain and writes LOD 1 through lodCount - 1 to
+// filenames[0] through filenames[lodCount - 2]. errors may be null.
+HRESULT GenerateLodFiles(
+    const wchar_t* sourceFilename,
+    const wchar_t* const* filenames,
+    uint32_t lodCount,
+    const LodOptions& options,
+    std::vector<float>* errors);
@@ -0,0 +1,164 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "LodGroup.h"
+
+#include "TriangleGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    // Upper bound on the number of vertices sampled per direction when estimating LOD error.
+    const uint32_t c_maxErrorSamples = 8192;
+
+    // Distances closer than this are clamped to avoid blowing up the projected error.
+    const float c_minProjectionDistance = 1e-3f;
+
+    void GatherTriangles(const Model& model, std::vector<XMFLOAT3>& positions, std::vector<uint32_t>& indices)
+    {
+        for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+        {
+            const Mesh& mesh = model.GetMesh(m);
+            const uint32_t base = static_cast<uint32_t>(positions.size());
+
+            for (uint32_t i = 0; i < mesh.VertexCount; ++i)
+            {
+                positions.push_back(mesh.GetPosition(i));
+            }
+
+            for (uint32_t i = 0; i < mesh.IndexCount; ++i)
+            {
+                indices.push_back(base + mesh.GetIndex(i));
+            }
+        }
+    }
+
+    // Largest distance from a subset of 'points' to the surface in 'grid'.
+    float GetMaxDistance(const std::vector<XMFLOAT3>& points, const TriangleGrid& grid)
+    {
+        const size_t step = std::max<size_t>(1, points.size() / c_maxErrorSamples);
+
+        float maxDistance = 0.0f;
+        for (size_t i = 0; i < points.size(); i += step)
+        {
+            maxDistance = std::max(maxDistance, grid.GetDistance(points[i]));
+        }
+
+        return maxDistance;
+    }
+}
+
+LodGroup::LodGroup()
+    : m_pixelThreshold(1.0f)
+    , m_hysteresis(0.25f)
+    , m_currentLod(0)
+{ }
+
+HRESULT LodGroup::LoadFromFiles(const wchar_t* const* filenames, uint32_t count)
+{
+    // Models hold spans into their own buffers, so size the container once and load in place.
+    m_lods.clear();
+    m_lods.resize(count);
+    m_errors.assign(count, 0.0f);
+    m_currentLod = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        HRESULT hr = m_lods[i].LoadFromFile(filenames[i]);
+        if (FAILED(hr))
+        {
+            m_lods.clear();
+            m_errors.clear();
+            return hr;
+        }
+    }
+
+    if (count < 2)
+        return S_OK;
+
+    // Estimate each LOD's error as the symmetric Hausdorff distance to the finest LOD.
+    std::vector<XMFLOAT3> basePositions;
+    std::vector<uint32_t> baseIndices;
+    GatherTriangles(m_lods[0], basePositions, baseIndices);
+
+    TriangleGrid baseGrid;
+    baseGrid.Build(basePositions.data(), baseIndices.data(), static_cast<uint32_t>(baseIndices.size() / 3));
+
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        std::vector<XMFLOAT3> positions;
+        std::vector<uint32_t> indices;
+        GatherTriangles(m_lods[i], positions, indices);
+
+        TriangleGrid grid;
+        grid.Build(positions.data(), indices.data(), static_cast<uint32_t>(indices.size() / 3));
+
+        const float error = std::max(GetMaxDistance(basePositions, grid), GetMaxDistance(positions, baseGrid));
+
+        // Keep errors monotonic so the selection can assume coarser never means more accurate.
+        m_errors[i] = std::max(error, m_errors[i - 1]);
+    }
+
+    return S_OK;
+}
+
+float LodGroup::GetProjectedError(uint32_t lod, const XMFLOAT4X4& worldView, float fovY, float viewportHeight) const
+{
+    const BoundingSphere& bounds = m_lods[0].GetBoundingSphere();
+    const XMMATRIX m = XMLoadFloat4x4(&worldView);
+
+    const float scale = std::max(
+        XMVectorGetX(XMVector3Length(m.r[0])),
+        std::max(XMVectorGetX(XMVector3Length(m.r[1])), XMVectorGetX(XMVector3Length(m.r[2]))));
+
+    // Distance from the eye to the nearest point of the bounding sphere in view space.
+    const XMVECTOR center = XMVector3Transform(XMLoadFloat3(&bounds.Center), m);
+    const float distance = std::max(XMVectorGetX(XMVector3Length(center)) - bounds.Radius * scale, c_minProjectionDistance);
+
+    const float pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f) * distance);
+    return m_errors[lod] * scale * pixelsPerUnit;
+}
+
+uint32_t LodGroup::SelectLod(const XMFLOAT4X4& worldView, float fovY, float viewportHeight)
+{
+    if (m_lods.empty())
+        return 0;
+
+    auto coarsestUnder = [&](float threshold)
+    {
+        uint32_t lod = 0;
+        for (uint32_t i = 1; i < GetLodCount(); ++i)
+        {
+            if (GetProjectedError(i, worldView, fovY, viewportHeight) > threshold)
+                break;
+            lod = i;
+        }
+        return lod;
+    };
+
+    // Refine immediately when the current LOD exceeds the threshold, but only coarsen
+    // once the coarser LOD is comfortably below it.
+    const uint32_t required = coarsestUnder(m_pixelThreshold);
+    if (required < m_currentLod)
+    {
+        m_currentLod = required;
+    }
+    else
+    {
+        m_currentLod = std::max(m_currentLod, coarsestUnder(m_pixelThreshold * (1.0f - m_hysteresis)));
+    }
+
+    return m_currentLod;
+}
@@ -0,0 +1,63 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Model.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// A chain of progressively coarser versions of the same model (LOD 0 = finest).
+//
+// Each LOD stores an object-space geometric error: the largest distance from the
+// finest LOD's surface to that LOD's surface. Per frame, SelectLod() projects these
+// errors to pixels and picks the coarsest LOD that stays under the pixel threshold.
+// Hysteresis keeps the selection from flickering between two LODs when the projected
+// error hovers around the threshold.
+class LodGroup
+{
+public:
+    LodGroup();
+
+    // Loads the given MSHL files, finest first, and estimates the error of every LOD
+    // against the first one.
+    HRESULT LoadFromFiles(const wchar_t* const* filenames, uint32_t count);
+
+    uint32_t GetLodCount() const { return static_cast<uint32_t>(m_lods.size()); }
+    const Model& GetLod(uint32_t lod) const { return m_lods[lod]; }
+    Model& GetLod(uint32_t lod) { return m_lods[lod]; }
+
+    // Object-space geometric error of a LOD. Overrides the estimate computed at load time.
+    float GetLodError(uint32_t lod) const { return m_errors[lod]; }
+    void SetLodError(uint32_t lod, float error) { m_errors[lod] = error; }
+
+    // Maximum projected error, in pixels, tolerated by SelectLod().
+    void SetPixelThreshold(float pixels) { m_pixelThreshold = pixels; }
+    float GetPixelThreshold() const { return m_pixelThreshold; }
+
+    // Fraction of the threshold a coarser LOD must undercut before switching to it.
+    void SetHysteresis(float fraction) { m_hysteresis = fraction; }
+
+    // Returns the error of a LOD projected to pixels for the given camera parameters.
+    float GetProjectedError(uint32_t lod, const DirectX::XMFLOAT4X4& worldView, float fovY, float viewportHeight) const;
+
+    // Updates and returns the current LOD. worldView uses DirectXMath's row-vector convention.
+    uint32_t SelectLod(const DirectX::XMFLOAT4X4& worldView, float fovY, float viewportHeight);
+    uint32_t GetCurrentLod() const { return m_currentLod; }
+
+private:
+    std::vector<Model> m_lods;
+    std::vector<float> m_errors;
+
+    float    m_pixelThreshold;
+    float    m_hysteresis;
+    uint32_t m_currentLod;
+};
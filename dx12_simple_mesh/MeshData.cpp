@@ -0,0 +1,255 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "MeshData.h"
+
+#include "Meshletizer.h"
+
+#include <cstring>
+#include <fstream>
+
+using namespace DirectX;
+
+namespace
+{
+    // Alignment of every buffer view in written files; enough for any element type we store.
+    const uint32_t c_bufferAlignment = 16;
+
+    const uint32_t c_absent = ~0u;
+
+    // Accumulates the accessor/buffer view tables and the binary blob of an MSHL file.
+    struct FileBuilder
+    {
+        std::vector<Accessor>   Accessors;
+        std::vector<BufferView> BufferViews;
+        std::vector<uint8_t>    Buffer;
+
+        uint32_t AddBufferView(const void* data, size_t size)
+        {
+            Buffer.resize((Buffer.size() + c_bufferAlignment - 1) & ~size_t(c_bufferAlignment - 1));
+
+            BufferView view = { static_cast<uint32_t>(Buffer.size()), static_cast<uint32_t>(size) };
+            Buffer.insert(Buffer.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+
+            BufferViews.push_back(view);
+            return static_cast<uint32_t>(BufferViews.size() - 1);
+        }
+
+        uint32_t AddAccessor(uint32_t bufferView, uint32_t offset, uint32_t size, uint32_t stride, uint32_t count)
+        {
+            Accessors.push_back({ bufferView, offset, size, stride, count });
+            return static_cast<uint32_t>(Accessors.size() - 1);
+        }
+
+        template <typename T>
+        uint32_t AddArray(const std::vector<T>& data)
+        {
+            const uint32_t view = AddBufferView(data.data(), data.size() * sizeof(T));
+            return AddAccessor(view, 0, sizeof(T), sizeof(T), static_cast<uint32_t>(data.size()));
+        }
+
+        // Stores 32-bit indices at the requested width.
+        uint32_t AddIndices(const std::vector<uint32_t>& indices, uint32_t indexSize)
+        {
+            if (indexSize == 4)
+                return AddArray(indices);
+
+            std::vector<uint16_t> narrow(indices.begin(), indices.end());
+            return AddArray(narrow);
+        }
+    };
+}
+
+void ExtractMeshData(const Mesh& mesh, MeshData& data)
+{
+    data = MeshData();
+
+    // Map each layout element to its attribute and its byte offset within its vertex buffer.
+    uint32_t sourceSlot[Attribute::Count];
+    uint32_t sourceOffset[Attribute::Count];
+    std::vector<uint32_t> slotSize(mesh.Vertices.size(), 0);
+
+    for (uint32_t t = 0; t < Attribute::Count; ++t)
+    {
+        data.AttributeOffsets[t] = c_absent;
+    }
+
+    data.VertexStride = 0;
+    for (uint32_t i = 0; i < mesh.LayoutDesc.NumElements; ++i)
+    {
+        const D3D12_INPUT_ELEMENT_DESC& desc = mesh.LayoutElems[i];
+
+        for (uint32_t t = 0; t < Attribute::Count; ++t)
+        {
+            if (strcmp(desc.SemanticName, c_elementDescs[t].SemanticName) != 0)
+                continue;
+
+            sourceSlot[t] = desc.InputSlot;
+            sourceOffset[t] = slotSize[desc.InputSlot];
+            slotSize[desc.InputSlot] += c_sizeMap[t];
+
+            data.AttributeOffsets[t] = data.VertexStride;
+            data.VertexStride += c_sizeMap[t];
+            break;
+        }
+    }
+
+    data.VertexCount = mesh.VertexCount;
+    data.Vertices.resize(size_t(data.VertexCount) * data.VertexStride);
+
+    for (uint32_t t = 0; t < Attribute::Count; ++t)
+    {
+        if (data.AttributeOffsets[t] == c_absent)
+            continue;
+
+        const uint8_t* src = mesh.Vertices[sourceSlot[t]].data() + sourceOffset[t];
+        const uint32_t srcStride = mesh.VertexStrides[sourceSlot[t]];
+
+        for (uint32_t v = 0; v < data.VertexCount; ++v)
+        {
+            memcpy(&data.Vertices[v * data.VertexStride + data.AttributeOffsets[t]], src + v * srcStride, c_sizeMap[t]);
+        }
+    }
+
+    data.Indices.resize(mesh.IndexCount);
+    for (uint32_t i = 0; i < mesh.IndexCount; ++i)
+    {
+        data.Indices[i] = mesh.GetIndex(i);
+    }
+
+    data.IndexSubsets.assign(mesh.IndexSubsets.begin(), mesh.IndexSubsets.end());
+    data.Meshlets.assign(mesh.Meshlets.begin(), mesh.Meshlets.end());
+    data.MeshletSubsets.assign(mesh.MeshletSubsets.begin(), mesh.MeshletSubsets.end());
+    data.PrimitiveIndices.assign(mesh.PrimitiveIndices.begin(), mesh.PrimitiveIndices.end());
+    data.CullingData.assign(mesh.CullingData.begin(), mesh.CullingData.end());
+
+    data.UniqueVertexIndices.resize(mesh.UniqueVertexIndices.size() / mesh.IndexSize);
+    for (uint32_t i = 0; i < data.UniqueVertexIndices.size(); ++i)
+    {
+        data.UniqueVertexIndices[i] = mesh.GetVertexIndex(i);
+    }
+}
+
+void BuildMeshlets(MeshData& data)
+{
+    data.Meshlets.clear();
+    data.MeshletSubsets.clear();
+    data.UniqueVertexIndices.clear();
+    data.PrimitiveIndices.clear();
+
+    for (const Subset& subset : data.IndexSubsets)
+    {
+        const uint32_t first = static_cast<uint32_t>(data.Meshlets.size());
+
+        ComputeMeshlets(data.Indices.data() + subset.Offset, subset.Count, data.VertexCount, c_maxMeshletVerts, c_maxMeshletPrims,
+            data.Meshlets, data.UniqueVertexIndices, data.PrimitiveIndices);
+
+        data.MeshletSubsets.push_back({ first, static_cast<uint32_t>(data.Meshlets.size()) - first });
+    }
+
+    std::vector<XMFLOAT3> positions(data.VertexCount);
+    for (uint32_t v = 0; v < data.VertexCount; ++v)
+    {
+        positions[v] = data.GetPosition(v);
+    }
+
+    data.CullingData.resize(data.Meshlets.size());
+    ComputeCullData(positions.data(), data.Meshlets.data(), static_cast<uint32_t>(data.Meshlets.size()),
+        data.UniqueVertexIndices.data(), data.PrimitiveIndices.data(), data.CullingData.data());
+}
+
+void CompactVertices(MeshData& data)
+{
+    std::vector<uint32_t> remap(data.VertexCount, c_absent);
+    for (uint32_t index : data.Indices)
+    {
+        remap[index] = 0;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t v = 0; v < data.VertexCount; ++v)
+    {
+        if (remap[v] == c_absent)
+            continue;
+
+        if (count != v)
+        {
+            memcpy(&data.Vertices[count * data.VertexStride], &data.Vertices[v * data.VertexStride], data.VertexStride);
+        }
+        remap[v] = count++;
+    }
+
+    for (uint32_t& index : data.Indices)
+    {
+        index = remap[index];
+    }
+    for (uint32_t& index : data.UniqueVertexIndices)
+    {
+        index = remap[index];
+    }
+
+    data.VertexCount = count;
+    data.Vertices.resize(size_t(count) * data.VertexStride);
+}
+
+HRESULT WriteMeshFile(const wchar_t* filename, const std::vector<MeshData>& meshes)
+{
+    FileBuilder builder;
+    std::vector<MeshHeader> headers(meshes.size());
+
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const MeshData& mesh = meshes[i];
+        MeshHeader& header = headers[i];
+
+        // The loader reads unique vertex indices at the same width as the index buffer.
+        const uint32_t indexSize = mesh.VertexCount > 0xffff ? 4 : 2;
+
+        header.Indices = builder.AddIndices(mesh.Indices, indexSize);
+        header.IndexSubsets = builder.AddArray(mesh.IndexSubsets);
+
+        const uint32_t vertexView = builder.AddBufferView(mesh.Vertices.data(), mesh.Vertices.size());
+        for (uint32_t t = 0; t < Attribute::Count; ++t)
+        {
+            header.Attributes[t] = mesh.HasAttribute(static_cast<Attribute::EType>(t))
+                ? builder.AddAccessor(vertexView, mesh.AttributeOffsets[t], c_sizeMap[t], mesh.VertexStride, mesh.VertexCount)
+                : c_absent;
+        }
+
+        header.Meshlets = builder.AddArray(mesh.Meshlets);
+        header.MeshletSubsets = builder.AddArray(mesh.MeshletSubsets);
+        header.UniqueVertexIndices = builder.AddIndices(mesh.UniqueVertexIndices, indexSize);
+        header.PrimitiveIndices = builder.AddArray(mesh.PrimitiveIndices);
+        header.CullData = builder.AddArray(mesh.CullingData);
+    }
+
+    FileHeader fileHeader = {};
+    fileHeader.Prolog = c_prolog;
+    fileHeader.Version = CURRENT_FILE_VERSION;
+    fileHeader.MeshCount = static_cast<uint32_t>(headers.size());
+    fileHeader.AccessorCount = static_cast<uint32_t>(builder.Accessors.size());
+    fileHeader.BufferViewCount = static_cast<uint32_t>(builder.BufferViews.size());
+    fileHeader.BufferSize = static_cast<uint32_t>(builder.Buffer.size());
+
+    std::ofstream stream(GetStreamPath(filename), std::ios::binary);
+    if (!stream.is_open())
+    {
+        return E_INVALIDARG;
+    }
+
+    stream.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+    stream.write(reinterpret_cast<const char*>(headers.data()), headers.size() * sizeof(headers[0]));
+    stream.write(reinterpret_cast<const char*>(builder.Accessors.data()), builder.Accessors.size() * sizeof(Accessor));
+    stream.write(reinterpret_cast<const char*>(builder.BufferViews.data()), builder.BufferViews.size() * sizeof(BufferView));
+    stream.write(reinterpret_cast<const char*>(builder.Buffer.data()), builder.Buffer.size());
+
+    return stream.good() ? S_OK : E_FAIL;
+}
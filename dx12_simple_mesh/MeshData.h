@@ -0,0 +1,59 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Model.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// Owning, editable counterpart of Mesh used by the asset tools. Vertices are interleaved
+// into a single stream and all indices are 32-bit regardless of the source file.
+struct MeshData
+{
+    uint32_t                    AttributeOffsets[Attribute::Count]; // Byte offset within a vertex, or ~0u if absent
+    uint32_t                    VertexStride;
+    uint32_t                    VertexCount;
+    std::vector<uint8_t>        Vertices;
+
+    std::vector<uint32_t>       Indices;
+    std::vector<Subset>         IndexSubsets;
+
+    std::vector<Meshlet>        Meshlets;
+    std::vector<Subset>         MeshletSubsets;
+    std::vector<uint32_t>       UniqueVertexIndices;
+    std::vector<PackedTriangle> PrimitiveIndices;
+    std::vector<CullData>       CullingData;
+
+    bool HasAttribute(Attribute::EType type) const { return AttributeOffsets[type] != ~0u; }
+
+    const float* GetAttribute(Attribute::EType type, uint32_t vertex) const
+    {
+        return reinterpret_cast<const float*>(Vertices.data() + vertex * VertexStride + AttributeOffsets[type]);
+    }
+
+    const DirectX::XMFLOAT3& GetPosition(uint32_t vertex) const
+    {
+        return *reinterpret_cast<const DirectX::XMFLOAT3*>(GetAttribute(Attribute::Position, vertex));
+    }
+};
+
+// Copies a loaded mesh, interleaving its vertex buffers and widening its indices.
+void ExtractMeshData(const Mesh& mesh, MeshData& data);
+
+// Regenerates the meshlets and cull data of every index subset.
+void BuildMeshlets(MeshData& data);
+
+// Drops vertices no triangle references, keeping the remaining ones in order.
+void CompactVertices(MeshData& data);
+
+// Writes meshes in the MSHL format read by Model::LoadFromFile().
+HRESULT WriteMeshFile(const wchar_t* filename, const std::vector<MeshData>& meshes);
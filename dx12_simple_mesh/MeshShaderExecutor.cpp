@@ -0,0 +1,467 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "MeshShaderExecutor.h"
+#include "ParallelFor.h"
+#include "PrimitiveCulling.h"
+#include "VertexReuse.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    // Groups executed between appends to the output, bounding the scratch held at once.
+    const uint32_t c_groupBatchSize = 1024;
+
+    // Strips and fans with restart look back for the last cut index, which needs the draw's
+    // index values by location.
+    bool NeedsStripIndices(const PrimitiveTopologyInfo& info, const MeshDrawParams& params)
+    {
+        return info.StripStride != 0 && params.IndexSize != 0 && params.CutIndex != 0;
+    }
+
+    // Index buffer reads outside the bound view read zero.
+    uint32_t ReadIndex(const uint8_t* data, uint64_t size, uint32_t location, uint32_t indexSize)
+    {
+        const uint64_t address = uint64_t(location) * indexSize;
+        if (data == nullptr || address + indexSize > size)
+            return 0;
+
+        if (indexSize == 2)
+        {
+            uint16_t index;
+            memcpy(&index, data + address, sizeof(index));
+            return index;
+        }
+
+        uint32_t index;
+        memcpy(&index, data + address, sizeof(index));
+        return index;
+    }
+}
+
+MeshShaderExecutor::MeshShaderExecutor() :
+    m_layout(),
+    m_topology(GetPrimitiveTopologyInfo(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST)),
+    m_viewportSize(1.0f, 1.0f),
+    m_cullFlags(PrimitiveCull::None)
+{
+    m_layout.PositionElement = ~0u;
+    XMStoreFloat4x4(&m_worldViewProj, XMMatrixIdentity());
+}
+
+void MeshShaderExecutor::SetVertexLayout(const VertexLayout& layout)
+{
+    m_layout = layout;
+}
+
+void MeshShaderExecutor::SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+    m_topology = GetPrimitiveTopologyInfo(topology);
+}
+
+void MeshShaderExecutor::SetConstants(const XMFLOAT4X4& worldViewProj, const XMFLOAT2& viewportSize, uint32_t cullFlags)
+{
+    m_worldViewProj = worldViewProj;
+    m_viewportSize = viewportSize;
+    m_cullFlags = cullFlags;
+}
+
+void MeshShaderExecutor::RegisterBuffer(D3D12_GPU_VIRTUAL_ADDRESS start, uint64_t size, const void* data)
+{
+    m_buffers.push_back(Buffer { start, size, static_cast<const uint8_t*>(data) });
+}
+
+void MeshShaderExecutor::ClearBuffers()
+{
+    m_buffers.clear();
+}
+
+MeshShaderExecutor::BoundView MeshShaderExecutor::Resolve(D3D12_GPU_VIRTUAL_ADDRESS location, uint64_t size) const
+{
+    if (size > 0)
+    {
+        for (const Buffer& buffer : m_buffers)
+        {
+            if (location >= buffer.Start && location < buffer.Start + buffer.Size)
+            {
+                const uint64_t offset = location - buffer.Start;
+                return BoundView { buffer.Data + offset, std::min(size, buffer.Size - offset) };
+            }
+        }
+    }
+
+    return BoundView { nullptr, 0 };
+}
+
+MeshShaderExecutor::BoundSet MeshShaderExecutor::ResolveSet(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer) const
+{
+    BoundSet set;
+    for (uint32_t slot = 0; slot < c_maxVertexSlots; ++slot)
+    {
+        set.VertexBuffers[slot] = Resolve(vertexBuffers[slot].BufferLocation, vertexBuffers[slot].SizeInBytes);
+    }
+    set.IndexBuffer = Resolve(indexBuffer.BufferLocation, indexBuffer.SizeInBytes);
+
+    return set;
+}
+
+XMFLOAT4 MeshShaderExecutor::TransformVertex(const BoundSet& set, uint32_t vertex, uint32_t instance, uint32_t startInstance) const
+{
+    XMFLOAT4 position(0.0f, 0.0f, 0.0f, 1.0f);
+
+    if (m_layout.PositionElement < m_layout.Elements.size())
+    {
+        const VertexElement& element = m_layout.Elements[m_layout.PositionElement];
+        const VertexFormatInfo* info = GetVertexFormatInfo(element.Format);
+        const BoundView& view = set.VertexBuffers[element.Slot];
+
+        const uint64_t address = uint64_t(GetElementIndex(element, vertex, instance, startInstance)) * m_layout.Strides[element.Slot] + element.Offset;
+
+        // Out of range loads read zero bits, which then decode like any other.
+        static const uint8_t zero[16] = {};
+        const uint8_t* data = zero;
+        if (info != nullptr && view.Data != nullptr && address + info->Size <= view.Size)
+        {
+            data = view.Data + address;
+        }
+
+        uint32_t bits[4];
+        DecodeVertexElement(element.Format, data, bits);
+        memcpy(&position, bits, sizeof(position));
+    }
+
+    XMFLOAT4 clipPos;
+    XMStoreFloat4(&clipPos, XMVector4Transform(XMLoadFloat4(&position), XMLoadFloat4x4(&m_worldViewProj)));
+    return clipPos;
+}
+
+void MeshShaderExecutor::CullTriangles(const AssembledPrimitive* triangles, uint32_t triangleCount, GroupOutput& output) const
+{
+    output.PrimitiveCount = triangleCount;
+    output.TriangleCount = 0;
+
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        const uint32_t* vertices = triangles[i].Locations;
+        if (IsPrimitiveCulled(output.Positions[vertices[0]], output.Positions[vertices[1]], output.Positions[vertices[2]], m_viewportSize, m_cullFlags))
+            continue;
+
+        memcpy(&output.Indices[output.TriangleCount * 3], vertices, 3 * sizeof(uint32_t));
+        ++output.TriangleCount;
+    }
+}
+
+// Mirrors the packed branch of main(): each thread runs a vertex of one of the group's small
+// draws, and every three threads make a triangle.
+void MeshShaderExecutor::ExecutePackedGroup(uint32_t groupX, GroupOutput& output) const
+{
+    output.VertexCount = 0;
+    output.TriangleCount = 0;
+    output.PrimitiveCount = 0;
+
+    if (groupX >= m_packedGroups.size())
+        return;
+
+    const uint32_t vertexCount = std::min(m_packedGroups[groupX].VertexCount, c_meshShaderGroupThreads);
+    for (uint32_t thread = 0; thread < vertexCount; ++thread)
+    {
+        uint32_t draw;
+        uint32_t location;
+        uint32_t instance;
+        if (!GetPackedThreadInput(m_packedGroups.data(), m_packedDraws.data(), groupX, thread, draw, location, instance))
+        {
+            output.Positions[thread] = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+            continue;
+        }
+
+        const PackedDraw& packed = m_packedDraws[draw];
+        const BoundSet& set = m_sets[std::min<size_t>(packed.BufferSet, m_sets.size() - 1)];
+
+        uint32_t vertex = location;
+        if (packed.IndexSize != 0)
+        {
+            vertex = ReadIndex(set.IndexBuffer.Data, set.IndexBuffer.Size, location, packed.IndexSize) + packed.BaseVertex;
+        }
+
+        output.Positions[thread] = TransformVertex(set, vertex, instance, packed.StartInstance);
+    }
+    output.VertexCount = vertexCount;
+
+    AssembledPrimitive triangles[c_meshShaderGroupThreads / 3];
+    const uint32_t triangleCount = vertexCount / 3;
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        triangles[i] = AssembledPrimitive { { i * 3, i * 3 + 1, i * 3 + 2 } };
+    }
+
+    CullTriangles(triangles, triangleCount, output);
+}
+
+// Mirrors the branch of main() packing whole instances of a small triangle list into a group.
+void MeshShaderExecutor::ExecuteInstancedGroup(const MeshDrawParams& params, uint32_t groupX, uint32_t groupY, GroupOutput& output) const
+{
+    const BoundSet& set = m_sets[0];
+
+    uint32_t vertexCount = 0;
+    for (uint32_t thread = 0; thread < c_meshShaderGroupThreads; ++thread)
+    {
+        uint32_t location;
+        uint32_t instance;
+        if (!GetGroupThreadInput(params, groupX, groupY, thread, location, instance))
+            break;
+
+        uint32_t vertex = location;
+        if (params.IndexSize != 0)
+        {
+            vertex = ReadIndex(set.IndexBuffer.Data, set.IndexBuffer.Size, location, params.IndexSize) + params.BaseVertex;
+        }
+
+        output.Positions[thread] = TransformVertex(set, vertex, instance, params.StartInstance);
+        ++vertexCount;
+    }
+    output.VertexCount = vertexCount;
+
+    AssembledPrimitive triangles[c_meshShaderGroupThreads / 3];
+    const uint32_t triangleCount = vertexCount / 3;
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        triangles[i] = AssembledPrimitive { { i * 3, i * 3 + 1, i * 3 + 2 } };
+    }
+
+    CullTriangles(triangles, triangleCount, output);
+}
+
+// Mirrors the general branch of main(): the group assembles GroupPrimitives slots from its
+// window of the draw's stream. Indexed triangle lists output each distinct index value of the
+// window once; otherwise each location is its own vertex, plus the fan's first vertex.
+void MeshShaderExecutor::ExecuteGroup(const MeshDrawParams& params, uint32_t groupX, uint32_t groupY, GroupOutput& output) const
+{
+    const PrimitiveTopologyInfo& info = *m_topology;
+    const BoundSet& set = m_sets[0];
+
+    output.VertexCount = 0;
+    output.TriangleCount = 0;
+    output.PrimitiveCount = 0;
+
+    const uint32_t slotCount = GetPrimitiveSlotCount(info, params.VertexCount);
+    const uint32_t firstSlot = groupX * info.GroupPrimitives;
+    if (firstSlot >= slotCount)
+        return;
+
+    const uint32_t primCount = std::min(slotCount - firstSlot, info.GroupPrimitives);
+    const uint32_t windowCount = (primCount - 1) * info.Step + info.Span;
+    const uint32_t windowStart = params.StartLocation + firstSlot * info.Step;
+    const uint32_t instance = params.FirstInstance + groupY;
+
+    uint32_t indices[c_meshShaderGroupThreads];
+    for (uint32_t i = 0; i < windowCount; ++i)
+    {
+        indices[i] = params.IndexSize != 0 ? ReadIndex(set.IndexBuffer.Data, set.IndexBuffer.Size, windowStart + i, params.IndexSize) : windowStart + i;
+    }
+
+    const bool reuse = info.Topology == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST && params.IndexSize != 0;
+
+    uint32_t vertexSlots[c_meshShaderGroupThreads];
+    if (reuse)
+    {
+        const uint32_t distinctCount = DedupGroupIndices(indices, windowCount, vertexSlots);
+
+        uint32_t next = 0;
+        for (uint32_t i = 0; i < windowCount && next < distinctCount; ++i)
+        {
+            if (vertexSlots[i] == next)
+            {
+                output.Positions[next++] = TransformVertex(set, indices[i] + params.BaseVertex, instance, params.StartInstance);
+            }
+        }
+        output.VertexCount = distinctCount;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < windowCount; ++i)
+        {
+            const bool cut = params.IndexSize != 0 && params.CutIndex != 0 && info.StripStride != 0 && indices[i] == params.CutIndex;
+            const uint32_t vertex = params.IndexSize != 0 ? indices[i] + params.BaseVertex : indices[i];
+
+            output.Positions[i] = cut ? XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) : TransformVertex(set, vertex, instance, params.StartInstance);
+            vertexSlots[i] = i;
+        }
+        output.VertexCount = windowCount;
+    }
+
+    const uint32_t* stripIndices = NeedsStripIndices(info, params) ? m_stripIndices.data() : nullptr;
+    const uint32_t stripStart = stripIndices != nullptr ? m_groupStripStarts[groupX] : params.StripStart;
+
+    AssembledPrimitive triangles[c_meshShaderGroupThreads];
+    uint32_t triangleCount = 0;
+    bool fanVertex = false;
+
+    for (uint32_t slot = 0; slot < primCount; ++slot)
+    {
+        AssembledPrimitive primitive;
+        if (!GetGroupPrimitive(info, params, groupX, slot, stripIndices, stripStart, primitive))
+            continue;
+
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            const uint32_t location = primitive.Locations[k];
+            if (location >= windowStart)
+            {
+                primitive.Locations[k] = vertexSlots[location - windowStart];
+                continue;
+            }
+
+            // A fan started before the window: its first vertex follows the window's.
+            if (!fanVertex)
+            {
+                uint32_t vertex = location;
+                if (params.IndexSize != 0)
+                {
+                    vertex = ReadIndex(set.IndexBuffer.Data, set.IndexBuffer.Size, location, params.IndexSize) + params.BaseVertex;
+                }
+
+                output.Positions[output.VertexCount] = TransformVertex(set, vertex, instance, params.StartInstance);
+                fanVertex = true;
+            }
+            primitive.Locations[k] = output.VertexCount;
+        }
+
+        triangles[triangleCount++] = primitive;
+    }
+
+    if (fanVertex)
+    {
+        ++output.VertexCount;
+    }
+
+    CullTriangles(triangles, triangleCount, output);
+}
+
+HRESULT MeshShaderExecutor::Execute(const std::vector<RecordingDrawTarget::Command>& commands, MeshShaderOutput& output, uint32_t threadCount)
+{
+    if (m_topology == nullptr || m_topology->VertexCount != 3)
+        return E_NOTIMPL;
+
+    MeshDrawParams params = {};
+    m_sets.assign(1, BoundSet());
+    m_packedDraws.clear();
+    m_packedGroups.clear();
+
+    std::vector<GroupOutput> groups;
+
+    for (const RecordingDrawTarget::Command& command : commands)
+    {
+        switch (command.Type)
+        {
+        case RecordingDrawTarget::Command::SetBuffers:
+            m_sets.assign(1, ResolveSet(command.VertexBuffers, command.IndexBuffer));
+            break;
+
+        case RecordingDrawTarget::Command::SetPackedDraws:
+            m_sets.clear();
+            for (const DrawBufferSet& bufferSet : command.BufferSets)
+            {
+                m_sets.push_back(ResolveSet(bufferSet.VertexBuffers, bufferSet.IndexBuffer));
+            }
+            if (m_sets.empty())
+            {
+                m_sets.push_back(BoundSet());
+            }
+            m_packedDraws = command.Draws;
+            m_packedGroups = command.Groups;
+            break;
+
+        case RecordingDrawTarget::Command::SetDrawParams:
+            params = command.Params;
+            break;
+
+        case RecordingDrawTarget::Command::DispatchMesh:
+        {
+            const uint32_t gridX = command.GroupCount[0];
+            const uint32_t gridY = command.GroupCount[1];
+            const uint64_t gridSize = uint64_t(gridX) * gridY * command.GroupCount[2];
+            const uint32_t groupCount = static_cast<uint32_t>(std::min<uint64_t>(gridSize, params.GroupCount));
+
+            const bool packed = params.PackedGroups != 0 && m_topology->Topology == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+            const bool instanced = params.InstancesPerGroup > 1 && m_topology->Topology == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+            if (NeedsStripIndices(*m_topology, params))
+            {
+                const BoundView& indexBuffer = m_sets[0].IndexBuffer;
+
+                m_stripIndices.resize(params.StartLocation + params.VertexCount);
+                for (uint32_t location = 0; location < m_stripIndices.size(); ++location)
+                {
+                    m_stripIndices[location] = ReadIndex(indexBuffer.Data, indexBuffer.Size, location, params.IndexSize);
+                }
+
+                m_groupStripStarts.resize(GetDispatchGroupCount(GetPrimitiveSlotCount(*m_topology, params.VertexCount), m_topology->GroupPrimitives));
+                GetGroupStripStarts(*m_topology, params, m_stripIndices.data(), static_cast<uint32_t>(m_groupStripStarts.size()), m_groupStripStarts.data());
+            }
+
+            for (uint32_t first = 0; first < groupCount; first += c_groupBatchSize)
+            {
+                const uint32_t batchCount = std::min(groupCount - first, c_groupBatchSize);
+                groups.resize(batchCount);
+
+                ParallelFor(batchCount, [&](uint32_t i, uint32_t)
+                {
+                    const uint32_t linearGroup = first + i;
+
+                    uint32_t groupX;
+                    uint32_t groupY;
+                    GroupOutput& group = groups[i];
+                    group.VertexCount = 0;
+                    group.TriangleCount = 0;
+                    group.PrimitiveCount = 0;
+
+                    if (!GetDispatchGroup(params, linearGroup % gridX, (linearGroup / gridX) % gridY, linearGroup / gridX / gridY, groupX, groupY))
+                        return;
+
+                    if (packed)
+                    {
+                        ExecutePackedGroup(groupX, group);
+                    }
+                    else if (instanced)
+                    {
+                        ExecuteInstancedGroup(params, groupX, groupY, group);
+                    }
+                    else
+                    {
+                        ExecuteGroup(params, groupX, groupY, group);
+                    }
+                }, threadCount);
+
+                for (const GroupOutput& group : groups)
+                {
+                    const uint32_t base = static_cast<uint32_t>(output.Positions.size());
+
+                    output.Positions.insert(output.Positions.end(), group.Positions, group.Positions + group.VertexCount);
+                    for (uint32_t i = 0; i < group.TriangleCount * 3; ++i)
+                    {
+                        output.Indices.push_back(base + group.Indices[i]);
+                    }
+
+                    output.PrimitiveCount += group.PrimitiveCount;
+                    output.GroupCount += group.VertexCount != 0 ? 1 : 0;
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    return S_OK;
+}
@@ -0,0 +1,121 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "FixedFunctionContext.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// Threads of a mesh shader group; bounds the vertices and primitives a group outputs.
+const uint32_t c_meshShaderGroupThreads = 128;
+
+// What the executed groups output, in linear group order across dispatches.
+struct MeshShaderOutput
+{
+    std::vector<DirectX::XMFLOAT4> Positions;      // SV_Position of every output vertex
+    std::vector<uint32_t>          Indices;        // Three per visible triangle, into Positions
+    uint32_t                       GroupCount;     // Groups that did work
+    uint32_t                       PrimitiveCount; // Triangles assembled, before culling
+
+    void Clear()
+    {
+        Positions.clear();
+        Indices.clear();
+        GroupCount = 0;
+        PrimitiveCount = 0;
+    }
+};
+
+// Runs the mesh shader of MeshletMS.hlsl on the CPU over the commands a FixedFunctionContext
+// recorded, so translations can be checked, rendered and timed without a device. Groups of a
+// dispatch are executed in parallel and their output gathered in linear group order, which
+// makes the output independent of the thread count.
+//
+// Vertex and index buffer views are resolved against the CPU copies of buffers registered
+// by GPU address; reads outside a registered buffer return zero, as raw views do. Only
+// triangle topologies are executed: points and lines are drawn as quads by the shader and
+// aren't needed by anything consuming the output.
+class MeshShaderExecutor
+{
+public:
+    MeshShaderExecutor();
+
+    void SetVertexLayout(const VertexLayout& layout);
+    void SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+
+    // The Globals of the shader that affect its output. The matrix uses DirectXMath's
+    // row-vector convention, untransposed.
+    void SetConstants(const DirectX::XMFLOAT4X4& worldViewProj, const DirectX::XMFLOAT2& viewportSize, uint32_t cullFlags);
+
+    void RegisterBuffer(D3D12_GPU_VIRTUAL_ADDRESS start, uint64_t size, const void* data);
+    void ClearBuffers();
+
+    // Appends what the recorded dispatches output. A threadCount of 0 uses every core.
+    // Returns E_NOTIMPL for topologies other than triangles.
+    HRESULT Execute(const std::vector<RecordingDrawTarget::Command>& commands, MeshShaderOutput& output, uint32_t threadCount = 0);
+
+private:
+    struct Buffer
+    {
+        D3D12_GPU_VIRTUAL_ADDRESS Start;
+        uint64_t                  Size;
+        const uint8_t*            Data;
+    };
+
+    // A view resolved to CPU memory; Data is null for unbound or unregistered views.
+    struct BoundView
+    {
+        const uint8_t* Data;
+        uint64_t       Size;
+    };
+
+    struct BoundSet
+    {
+        BoundView VertexBuffers[c_maxVertexSlots];
+        BoundView IndexBuffer;
+    };
+
+    // What one group outputs, before it is appended to the dispatch's output.
+    struct GroupOutput
+    {
+        uint32_t          VertexCount;
+        uint32_t          TriangleCount;
+        uint32_t          PrimitiveCount;
+        DirectX::XMFLOAT4 Positions[c_meshShaderGroupThreads];
+        uint32_t          Indices[c_meshShaderGroupThreads * 3];
+    };
+
+    BoundView Resolve(D3D12_GPU_VIRTUAL_ADDRESS location, uint64_t size) const;
+    BoundSet ResolveSet(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer) const;
+
+    DirectX::XMFLOAT4 TransformVertex(const BoundSet& set, uint32_t vertex, uint32_t instance, uint32_t startInstance) const;
+
+    void ExecutePackedGroup(uint32_t groupX, GroupOutput& output) const;
+    void ExecuteInstancedGroup(const MeshDrawParams& params, uint32_t groupX, uint32_t groupY, GroupOutput& output) const;
+    void ExecuteGroup(const MeshDrawParams& params, uint32_t groupX, uint32_t groupY, GroupOutput& output) const;
+
+    void CullTriangles(const AssembledPrimitive* triangles, uint32_t triangleCount, GroupOutput& output) const;
+
+    VertexLayout                     m_layout;
+    const PrimitiveTopologyInfo*     m_topology;
+    DirectX::XMFLOAT4X4              m_worldViewProj;
+    DirectX::XMFLOAT2                m_viewportSize;
+    uint32_t                         m_cullFlags;
+    std::vector<Buffer>              m_buffers;
+
+    // Bindings of the dispatch being executed.
+    std::vector<BoundSet>            m_sets;
+    std::vector<PackedDraw>          m_packedDraws;
+    std::vector<PackedDrawGroup>     m_packedGroups;
+    std::vector<uint32_t>            m_stripIndices; // Index values of a strip draw with restart, by location
+    std::vector<uint32_t>            m_groupStripStarts; // Where the strip each of its groups starts in begins
+};
@@ -0,0 +1,268 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "MeshShaderPermutation.h"
+#include "PrimitiveAssembly.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const char c_permutationHeader[] =
+        "//*********************************************************\n"
+        "// Generated by GenerateMeshShaderSource() in MeshShaderPermutation.cpp. Do not edit.\n"
+        "//*********************************************************\n";
+
+    uint64_t HashWords(const std::vector<uint32_t>& words)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (uint32_t word : words)
+        {
+            for (uint32_t b = 0; b < 4; ++b)
+            {
+                hash ^= (word >> (b * 8)) & 0xff;
+                hash *= 0x100000001b3ull;
+            }
+        }
+        return hash;
+    }
+
+    // The HLSL counterpart of GetElementIndex() with the step rate as a literal.
+    std::string IndexSource(const VertexElement& elem)
+    {
+        if (elem.InstanceStepRate == 0)
+            return "vertex";
+
+        if (elem.InstanceStepRate == ~0u)
+            return "s_startInstance";
+
+        if (elem.InstanceStepRate == 1)
+            return "(s_startInstance + instance)";
+
+        return "(s_startInstance + instance / " + std::to_string(elem.InstanceStepRate) + ")";
+    }
+
+    // Emits the raw load of one element. Dword-aligned elements in dword-strided slots load
+    // whole dwords directly; anything else goes through LoadElementBits().
+    std::string LoadSource(const VertexElement& elem, const VertexFormatInfo& info, uint32_t stride)
+    {
+        char address[96];
+        if (stride == 0)
+        {
+            snprintf(address, sizeof(address), "%u", elem.Offset);
+        }
+        else if (elem.Offset == 0)
+        {
+            snprintf(address, sizeof(address), "%s * %u", IndexSource(elem).c_str(), stride);
+        }
+        else
+        {
+            snprintf(address, sizeof(address), "%s * %u + %u", IndexSource(elem).c_str(), stride, elem.Offset);
+        }
+
+        char load[192];
+        if (stride % 4 == 0 && elem.Offset % 4 == 0 && info.Size % 4 == 0)
+        {
+            static const char* const c_loads[] =
+            {
+                "uint4(DRAW_BUFFER(%u).Load(%s), 0, 0, 0)",
+                "uint4(DRAW_BUFFER(%u).Load2(%s), 0, 0)",
+                "uint4(DRAW_BUFFER(%u).Load3(%s), 0)",
+                "DRAW_BUFFER(%u).Load4(%s)",
+            };
+            snprintf(load, sizeof(load), c_loads[info.Size / 4 - 1], elem.Slot, address);
+        }
+        else
+        {
+            snprintf(load, sizeof(load), "LoadElementBits(%u, %s, %u)", elem.Slot, address, info.Size);
+        }
+
+        return load;
+    }
+}
+
+MeshShaderKey::MeshShaderKey(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology)
+{
+    const uint32_t elementCount = static_cast<uint32_t>(layout.Elements.size());
+
+    Words.reserve(3 + elementCount * 5);
+    Words.push_back(static_cast<uint32_t>(topology));
+    Words.push_back(elementCount);
+    Words.push_back(layout.PositionElement);
+
+    for (const VertexElement& elem : layout.Elements)
+    {
+        Words.push_back(elem.Slot);
+        Words.push_back(elem.Offset);
+        Words.push_back(static_cast<uint32_t>(elem.Format));
+        Words.push_back(layout.Strides[elem.Slot]);
+        Words.push_back(elem.InstanceStepRate);
+    }
+
+    Hash = HashWords(Words);
+}
+
+HRESULT GenerateMeshShaderSource(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology, std::string& source)
+{
+    const PrimitiveTopologyInfo* assembly = GetPrimitiveTopologyInfo(topology);
+    if (assembly == nullptr)
+        return E_NOTIMPL;
+
+    const uint32_t elementCount = static_cast<uint32_t>(layout.Elements.size());
+    if (elementCount > c_maxVertexElements)
+        return E_INVALIDARG;
+
+    const MeshShaderKey key(layout, topology);
+
+    char line[512];
+    source = c_permutationHeader;
+
+    snprintf(line, sizeof(line), "// Layout hash 0x%016llx, topology %u\n\n",
+        static_cast<unsigned long long>(key.Hash), static_cast<uint32_t>(topology));
+    source += line;
+
+    snprintf(line, sizeof(line),
+        "#define PRIMITIVE_TOPOLOGY     %u\n"
+        "#define PRIM_VERTS             %u\n"
+        "#define PRIM_STEP              %u\n"
+        "#define PRIM_SPAN              %u\n"
+        "#define PRIM_OFFSETS           uint3(%u, %u, %u)\n"
+        "#define PRIM_STRIP_STRIDE      %u\n"
+        "#define PRIM_ALTERNATE_WINDING %u\n"
+        "#define PRIM_FAN               %u\n"
+        "#define GROUP_PRIMS            %u\n",
+        static_cast<uint32_t>(topology), assembly->VertexCount, assembly->Step, assembly->Span,
+        assembly->Offsets[0], assembly->Offsets[1], assembly->Offsets[2], assembly->StripStride,
+        assembly->AlternateWinding ? 1u : 0u, assembly->Fan ? 1u : 0u, assembly->GroupPrimitives);
+    source += line;
+
+    source += "#define SPECIALIZED_VERTEX_FETCH\n";
+    source += "#include \"MeshletMS.hlsl\"\n\n";
+    source += GetDecodeHelpersHlsl();
+    source += "\nfloat4 FetchVertex(uint vertex, uint instance)\n{\n";
+
+    for (uint32_t e = 0; e < elementCount; ++e)
+    {
+        const VertexElement& elem = layout.Elements[e];
+        const VertexFormatInfo* info = GetVertexFormatInfo(elem.Format);
+        if (info == nullptr || elem.Slot >= c_maxVertexSlots)
+            return E_INVALIDARG;
+
+        const uint32_t stride = layout.Strides[elem.Slot];
+
+        if (elem.InstanceStepRate == 0)
+        {
+            snprintf(line, sizeof(line), "    // DXGI_FORMAT_%s, slot %u, offset %u, stride %u\n", info->Name, elem.Slot, elem.Offset, stride);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "    // DXGI_FORMAT_%s, slot %u, offset %u, stride %u, per instance\n", info->Name, elem.Slot, elem.Offset, stride);
+        }
+        source += line;
+
+        snprintf(line, sizeof(line), "    uint4 raw%u = ", e);
+        source += line + LoadSource(elem, *info, stride) + ";\n";
+
+        snprintf(line, sizeof(line), "    uint4 element%u = ", e);
+        const std::string decoded = GenerateDecodeHlsl(elem.Format, ("raw" + std::to_string(e)).c_str(), static_cast<uint32_t>(strlen(line)));
+        source += line + decoded + ";\n\n";
+    }
+
+    // With CHECK_VERTEX_FETCH, the first instance's elements are checked against the CPU decoder.
+    source += "#ifdef CHECK_VERTEX_FETCH\n    if (instance == 0)\n    {\n";
+    for (uint32_t e = 0; e < elementCount; ++e)
+    {
+        snprintf(line, sizeof(line), "        debugOutput[vertex * %u + %u] = element%u;\n", elementCount, e, e);
+        source += line;
+    }
+    source += "    }\n#endif\n\n";
+
+    if (layout.PositionElement < elementCount)
+    {
+        snprintf(line, sizeof(line), "    return asfloat(element%u);\n}\n", layout.PositionElement);
+        source += line;
+    }
+    else
+    {
+        source += "    return float4(0, 0, 0, 1);\n}\n";
+    }
+
+    return S_OK;
+}
+
+MeshShaderCache::MeshShaderCache(CompileFunction compile)
+    : m_compile(std::move(compile))
+    , m_entries()
+    , m_compileCount(0)
+{ }
+
+HRESULT MeshShaderCache::Compile(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology, ShaderTask& task)
+{
+    MeshShaderKey key(layout, topology);
+
+    // A failed compile is queued again.
+    Entry* entry = Find(key);
+    if (entry != nullptr &&
+        (entry->Task.Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready || SUCCEEDED(entry->Task.Result.get().Status)))
+    {
+        task = entry->Task;
+        return S_OK;
+    }
+
+    std::string source;
+    HRESULT hr = GenerateMeshShaderSource(layout, topology, source);
+    if (FAILED(hr))
+        return hr;
+
+    if (entry == nullptr)
+    {
+        std::unique_ptr<Entry> newEntry(new Entry);
+        newEntry->Key = std::move(key.Words);
+        entry = newEntry.get();
+        m_entries.emplace(key.Hash, std::move(newEntry));
+    }
+
+    ++m_compileCount;
+    entry->Task = m_compile(source);
+
+    task = entry->Task;
+    return S_OK;
+}
+
+HRESULT MeshShaderCache::GetBytecode(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology, const std::vector<uint8_t>** bytecode)
+{
+    *bytecode = nullptr;
+
+    ShaderTask task;
+    HRESULT hr = Compile(layout, topology, task);
+    if (FAILED(hr))
+        return hr;
+
+    const ShaderCompileResult& result = task.Result.get();
+    if (FAILED(result.Status))
+        return result.Status;
+
+    *bytecode = &result.Bytecode;
+    return S_OK;
+}
+
+MeshShaderCache::Entry* MeshShaderCache::Find(const MeshShaderKey& key) const
+{
+    auto range = m_entries.equal_range(key.Hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second->Key == key.Words)
+            return it->second.get();
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,73 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Platform.h"
+#include "ShaderJobSystem.h"
+#include "VertexFormat.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Identifies the mesh shader specialized for an input layout and primitive topology. Layouts
+// that fetch identically (e.g. differing only in semantic names or unused slot strides)
+// share a key.
+struct MeshShaderKey
+{
+    MeshShaderKey(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology);
+
+    std::vector<uint32_t> Words; // Canonical description, compared on hash collisions
+    uint64_t              Hash;  // FNV-1a of Words
+};
+
+// Emits mesh shader source with the layout's strides, offsets, formats and instance step
+// rates as literals, so each vertex format gets its own branch-free fetch. The source
+// includes MeshletMS.hlsl and must be compiled as if it lived next to it, with primitive
+// assembly defined for the topology. Returns E_NOTIMPL for patch lists.
+HRESULT GenerateMeshShaderSource(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology, std::string& source);
+
+// Compiles each distinct permutation once and keeps its bytecode for the cache's lifetime.
+// Compiles are queued through the compile function, so permutations requested together with
+// Compile() build in parallel. Used from one thread.
+class MeshShaderCache
+{
+public:
+    using CompileFunction = std::function<ShaderTask(const std::string& source)>;
+
+    explicit MeshShaderCache(CompileFunction compile);
+
+    // Returns the permutation's task, queueing its compile unless it is compiled or compiling.
+    // Returns E_NOTIMPL for topologies without a permutation.
+    HRESULT Compile(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology, ShaderTask& task);
+
+    // Returns the bytecode of the permutation, waiting for its compile. Failures are not
+    // cached, so a corrected shader can be retried.
+    HRESULT GetBytecode(const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology, const std::vector<uint8_t>** bytecode);
+
+    uint32_t GetPermutationCount() const { return static_cast<uint32_t>(m_entries.size()); }
+    uint32_t GetCompileCount() const { return m_compileCount; }
+
+private:
+    struct Entry
+    {
+        std::vector<uint32_t> Key;
+        ShaderTask            Task;
+    };
+
+    Entry* Find(const MeshShaderKey& key) const;
+
+    CompileFunction                                          m_compile;
+    std::unordered_multimap<uint64_t, std::unique_ptr<Entry>> m_entries;
+    uint32_t                                                 m_compileCount;
+};
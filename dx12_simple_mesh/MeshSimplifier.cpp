@@ -0,0 +1,550 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    // Boundary planes count this much more than face planes so borders hold their shape.
+    const double c_borderWeight = 10.0;
+
+    // Reject collapses that rotate a surviving triangle's normal by more than ~75 degrees.
+    const double c_maxFlipCos = 0.25;
+
+    // Symmetric 4x4 matrix accumulating squared distances to a set of planes, with the
+    // total plane weight so the error can be normalized to an average squared distance.
+    struct Quadric
+    {
+        double a00, a01, a02, a03;
+        double a11, a12, a13;
+        double a22, a23;
+        double a33;
+        double w;
+
+        void AddPlane(double nx, double ny, double nz, double d, double weight)
+        {
+            a00 += weight * nx * nx; a01 += weight * nx * ny; a02 += weight * nx * nz; a03 += weight * nx * d;
+            a11 += weight * ny * ny; a12 += weight * ny * nz; a13 += weight * ny * d;
+            a22 += weight * nz * nz; a23 += weight * nz * d;
+            a33 += weight * d * d;
+            w += weight;
+        }
+
+        void Add(const Quadric& q)
+        {
+            a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+            a11 += q.a11; a12 += q.a12; a13 += q.a13;
+            a22 += q.a22; a23 += q.a23;
+            a33 += q.a33;
+            w += q.w;
+        }
+
+        double Evaluate(const XMFLOAT3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            const double r = x * (a00 * x + 2.0 * (a01 * y + a02 * z + a03))
+                + y * (a11 * y + 2.0 * (a12 * z + a13))
+                + z * (a22 * z + 2.0 * a23)
+                + a33;
+            return w > 0.0 ? std::fabs(r) / w : 0.0;
+        }
+    };
+
+    const uint32_t c_invalid = ~0u;
+
+    enum VertexKind : uint8_t
+    {
+        Manifold,   // Interior vertex with a single set of attributes
+        Border,     // Lies on an open edge; may only slide along it
+        Seam,       // One of two vertices sharing a position; collapses with its twin
+        Locked,     // Never moves
+    };
+
+    struct Collapse
+    {
+        double   Cost;
+        double   Error;
+        uint32_t From;
+        uint32_t To;
+        uint32_t TwinFrom; // Seam twin collapsing alongside, or c_invalid
+        uint32_t TwinTo;
+    };
+
+    void Normal(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c, double n[3])
+    {
+        const double ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        const double vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        n[0] = uy * vz - uz * vy;
+        n[1] = uz * vx - ux * vz;
+        n[2] = ux * vy - uy * vx;
+    }
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+
+    // Collects every edge as a sorted key list; keys appearing once are open borders.
+    void GatherEdges(const std::vector<uint32_t>& indices, std::vector<uint64_t>& edges)
+    {
+        edges.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            edges.push_back(EdgeKey(indices[i + 0], indices[i + 1]));
+            edges.push_back(EdgeKey(indices[i + 1], indices[i + 2]));
+            edges.push_back(EdgeKey(indices[i + 2], indices[i + 0]));
+        }
+        std::sort(edges.begin(), edges.end());
+    }
+
+    void ComputeQuadrics(const SimplifyDesc& desc, const std::vector<uint32_t>& indices, const std::vector<uint64_t>& edges, std::vector<Quadric>& quadrics)
+    {
+        const XMFLOAT3* p = desc.Positions;
+        quadrics.assign(desc.VertexCount, Quadric());
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const uint32_t v[3] = { indices[i + 0], indices[i + 1], indices[i + 2] };
+
+            double n[3];
+            Normal(p[v[0]], p[v[1]], p[v[2]], n);
+
+            const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length <= 0.0)
+                continue;
+
+            // Weight by area so slivers do not dominate their neighbours.
+            const double area = length * 0.5;
+            n[0] /= length; n[1] /= length; n[2] /= length;
+            const double d = -(n[0] * p[v[0]].x + n[1] * p[v[0]].y + n[2] * p[v[0]].z);
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                quadrics[v[k]].AddPlane(n[0], n[1], n[2], d, area);
+            }
+
+            // Add a plane perpendicular to the face through every open edge.
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t a = v[k];
+                const uint32_t b = v[(k + 1) % 3];
+
+                const uint64_t key = EdgeKey(a, b);
+                const auto range = std::equal_range(edges.begin(), edges.end(), key);
+                if (range.second - range.first != 1)
+                    continue;
+
+                const double ex = p[b].x - p[a].x, ey = p[b].y - p[a].y, ez = p[b].z - p[a].z;
+                double bn[3] = { ey * n[2] - ez * n[1], ez * n[0] - ex * n[2], ex * n[1] - ey * n[0] };
+
+                const double bnLength = std::sqrt(bn[0] * bn[0] + bn[1] * bn[1] + bn[2] * bn[2]);
+                if (bnLength <= 0.0)
+                    continue;
+
+                bn[0] /= bnLength; bn[1] /= bnLength; bn[2] /= bnLength;
+                const double bd = -(bn[0] * p[a].x + bn[1] * p[a].y + bn[2] * p[a].z);
+                const double weight = (ex * ex + ey * ey + ez * ez) * c_borderWeight;
+
+                quadrics[a].AddPlane(bn[0], bn[1], bn[2], bd, weight);
+                quadrics[b].AddPlane(bn[0], bn[1], bn[2], bd, weight);
+            }
+        }
+    }
+}
+
+float SimplifyMesh(const SimplifyDesc& desc, std::vector<uint32_t>& result)
+{
+    const XMFLOAT3* positions = desc.Positions;
+    const uint32_t vertexCount = desc.VertexCount;
+
+    result.assign(desc.Indices, desc.Indices + desc.IndexCount);
+
+    // Group vertices by bit-identical position. Topology and quadrics are computed on the
+    // first vertex of each group so attribute seams do not look like open borders.
+    std::vector<uint32_t> canonical(vertexCount);
+    std::vector<uint32_t> wedgeNext(vertexCount);
+    {
+        std::vector<uint32_t> order(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        {
+            const int c = std::memcmp(&positions[a], &positions[b], sizeof(XMFLOAT3));
+            return c < 0 || (c == 0 && a < b);
+        });
+
+        for (uint32_t i = 0; i < vertexCount; )
+        {
+            uint32_t j = i + 1;
+            while (j < vertexCount && std::memcmp(&positions[order[i]], &positions[order[j]], sizeof(XMFLOAT3)) == 0)
+            {
+                ++j;
+            }
+
+            for (uint32_t k = i; k < j; ++k)
+            {
+                canonical[order[k]] = order[i];
+                wedgeNext[order[k]] = order[k + 1 < j ? k + 1 : i];
+            }
+
+            i = j;
+        }
+    }
+
+    auto weld = [&](const std::vector<uint32_t>& indices, std::vector<uint32_t>& welded)
+    {
+        welded.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            welded[i] = canonical[indices[i]];
+        }
+    };
+
+    std::vector<uint32_t> welded;
+    std::vector<uint64_t> weldedEdges;
+    weld(result, welded);
+    GatherEdges(welded, weldedEdges);
+
+    std::vector<Quadric> quadrics;
+    ComputeQuadrics(desc, welded, weldedEdges, quadrics);
+
+    auto attributeCost = [&](uint32_t from, uint32_t to)
+    {
+        double cost = 0.0;
+        if (desc.Attributes)
+        {
+            const float* a = desc.Attributes + size_t(from) * desc.AttributeStride;
+            const float* b = desc.Attributes + size_t(to) * desc.AttributeStride;
+            for (uint32_t i = 0; i < desc.AttributeStride; ++i)
+            {
+                const double d = double(a[i]) - double(b[i]);
+                cost += desc.AttributeWeights[i] * d * d;
+            }
+        }
+        return cost;
+    };
+
+    const double maxCost = double(desc.TargetError) * double(desc.TargetError);
+    double maxApplied = 0.0;
+
+    std::vector<uint32_t> adjStart;
+    std::vector<uint32_t> adjTris;
+    std::vector<uint64_t> edges;
+    std::vector<uint8_t>  border(vertexCount);
+    std::vector<uint8_t>  referenced(vertexCount);
+    std::vector<uint8_t>  kind(vertexCount);
+    std::vector<uint8_t>  touched(vertexCount);
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<Collapse> collapses;
+
+    // Each pass collapses a set of independent edges, cheapest first, then rebuilds the
+    // topology. Passes continue until the target is met or nothing more can collapse.
+    while (result.size() > desc.TargetIndexCount)
+    {
+        const uint32_t triCount = static_cast<uint32_t>(result.size() / 3);
+
+        adjStart.assign(vertexCount + 1, 0);
+        for (uint32_t i = 0; i < triCount * 3; ++i)
+        {
+            adjStart[result[i] + 1]++;
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            adjStart[v + 1] += adjStart[v];
+            referenced[v] = adjStart[v + 1] > adjStart[v];
+        }
+
+        adjTris.resize(triCount * 3);
+        std::vector<uint32_t> cursor(adjStart.begin(), adjStart.end() - 1);
+        for (uint32_t i = 0; i < triCount * 3; ++i)
+        {
+            adjTris[cursor[result[i]]++] = i / 3;
+        }
+
+        weld(result, welded);
+        GatherEdges(welded, weldedEdges);
+        GatherEdges(result, edges);
+
+        std::fill(border.begin(), border.end(), uint8_t(0));
+        for (size_t i = 0; i < weldedEdges.size(); )
+        {
+            size_t j = i + 1;
+            while (j < weldedEdges.size() && weldedEdges[j] == weldedEdges[i])
+            {
+                ++j;
+            }
+
+            if (j - i == 1)
+            {
+                border[uint32_t(weldedEdges[i] >> 32)] = 1;
+                border[uint32_t(weldedEdges[i])] = 1;
+            }
+
+            i = j;
+        }
+
+        // Wedges are the referenced vertices at the same position as v.
+        auto forEachWedge = [&](uint32_t v, auto&& func)
+        {
+            uint32_t w = v;
+            do
+            {
+                if (referenced[w])
+                {
+                    func(w);
+                }
+                w = wedgeNext[w];
+            } while (w != v);
+        };
+
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (!referenced[v])
+                continue;
+
+            uint32_t wedges = 0;
+            bool locked = false;
+            forEachWedge(v, [&](uint32_t w)
+            {
+                ++wedges;
+                locked = locked || (desc.LockedVertices && desc.LockedVertices[w]);
+            });
+
+            const bool onBorder = border[canonical[v]] != 0;
+            if (locked || wedges > 2 || (wedges == 2 && onBorder))
+            {
+                kind[v] = Locked;
+            }
+            else if (wedges == 2)
+            {
+                kind[v] = Seam;
+            }
+            else
+            {
+                kind[v] = onBorder ? Border : Manifold;
+            }
+        }
+
+        auto hasEdge = [&](uint32_t a, uint32_t b)
+        {
+            return std::binary_search(edges.begin(), edges.end(), EdgeKey(a, b));
+        };
+
+        auto isWeldedBorderEdge = [&](uint32_t a, uint32_t b)
+        {
+            const auto range = std::equal_range(weldedEdges.begin(), weldedEdges.end(), EdgeKey(canonical[a], canonical[b]));
+            return range.second - range.first == 1;
+        };
+
+        auto makeCollapse = [&](uint32_t from, uint32_t to, Collapse& c)
+        {
+            c.From = from;
+            c.To = to;
+            c.TwinFrom = c_invalid;
+            c.TwinTo = c_invalid;
+
+            switch (kind[from])
+            {
+            case Locked:
+                return false;
+
+            case Border:
+                if (!isWeldedBorderEdge(from, to))
+                    return false;
+                break;
+
+            case Seam:
+            {
+                // The twin must have an edge to a vertex at the target position, so both
+                // sides of the seam collapse onto the same point.
+                uint32_t twin = c_invalid;
+                forEachWedge(from, [&](uint32_t w) { if (w != from) twin = w; });
+
+                forEachWedge(to, [&](uint32_t w)
+                {
+                    if (c.TwinTo == c_invalid && hasEdge(twin, w))
+                    {
+                        c.TwinTo = w;
+                    }
+                });
+
+                if (c.TwinTo == c_invalid)
+                    return false;
+
+                c.TwinFrom = twin;
+                break;
+            }
+
+            default:
+                break;
+            }
+
+            Quadric q = quadrics[canonical[from]];
+            q.Add(quadrics[canonical[to]]);
+
+            c.Error = q.Evaluate(positions[to]);
+            c.Cost = c.Error + attributeCost(from, to);
+            if (c.TwinFrom != c_invalid)
+            {
+                c.Cost += attributeCost(c.TwinFrom, c.TwinTo);
+            }
+
+            return true;
+        };
+
+        // Pick the cheaper valid direction of every unique edge.
+        collapses.clear();
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            if (i > 0 && edges[i] == edges[i - 1])
+                continue;
+
+            const uint32_t a = uint32_t(edges[i] >> 32);
+            const uint32_t b = uint32_t(edges[i]);
+
+            Collapse ab, ba;
+            const bool validAB = makeCollapse(a, b, ab);
+            const bool validBA = makeCollapse(b, a, ba);
+
+            if (validAB && (!validBA || ab.Cost <= ba.Cost))
+            {
+                collapses.push_back(ab);
+            }
+            else if (validBA)
+            {
+                collapses.push_back(ba);
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.Cost < y.Cost; });
+
+        std::fill(touched.begin(), touched.end(), uint8_t(0));
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            remap[v] = v;
+        }
+
+        auto flips = [&](uint32_t from, uint32_t to)
+        {
+            for (uint32_t j = adjStart[from]; j < adjStart[from + 1]; ++j)
+            {
+                const uint32_t* tri = &result[adjTris[j] * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                    continue;
+
+                XMFLOAT3 p[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+
+                double before[3];
+                Normal(p[0], p[1], p[2], before);
+
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    if (tri[k] == from)
+                    {
+                        p[k] = positions[to];
+                    }
+                }
+
+                double after[3];
+                Normal(p[0], p[1], p[2], after);
+
+                const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                const double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+                    * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+
+                if (dot <= c_maxFlipCos * lengths)
+                    return true;
+            }
+
+            return false;
+        };
+
+        // Marks the one-ring of 'from' as touched, since its triangles are about to change,
+        // and returns the number of triangles the collapse removes.
+        auto apply = [&](uint32_t from, uint32_t to)
+        {
+            uint32_t count = 0;
+            for (uint32_t j = adjStart[from]; j < adjStart[from + 1]; ++j)
+            {
+                const uint32_t* tri = &result[adjTris[j] * 3];
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                {
+                    ++count;
+                }
+            }
+            touched[to] = 1;
+            remap[from] = to;
+
+            return count;
+        };
+
+        uint32_t removed = 0;
+        uint32_t collapsed = 0;
+        const uint32_t targetTris = desc.TargetIndexCount / 3;
+
+        for (const Collapse& c : collapses)
+        {
+            if (c.Error > maxCost)
+                continue;
+
+            if (touched[c.From] || touched[c.To] || flips(c.From, c.To))
+                continue;
+
+            const bool twin = c.TwinFrom != c_invalid;
+            if (twin && (touched[c.TwinFrom] || touched[c.TwinTo] || flips(c.TwinFrom, c.TwinTo)))
+                continue;
+
+            removed += apply(c.From, c.To);
+            if (twin)
+            {
+                removed += apply(c.TwinFrom, c.TwinTo);
+            }
+
+            quadrics[canonical[c.To]].Add(quadrics[canonical[c.From]]);
+            maxApplied = std::max(maxApplied, c.Error);
+            ++collapsed;
+
+            if (triCount - removed <= targetTris)
+                break;
+        }
+
+        if (collapsed == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const uint32_t a = remap[result[i + 0]];
+            const uint32_t b = remap[result[i + 1]];
+            const uint32_t c = remap[result[i + 2]];
+
+            if (a == b || b == c || c == a)
+                continue;
+
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    return static_cast<float>(std::sqrt(maxApplied));
+}
@@ -0,0 +1,44 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+struct SimplifyDesc
+{
+    const DirectX::XMFLOAT3* Positions;
+    uint32_t                 VertexCount;
+    const uint32_t*          Indices;
+    uint32_t                 IndexCount;
+    const uint8_t*           LockedVertices;   // Optional; vertices with a non-zero entry never move.
+    const float*             Attributes;       // Optional; AttributeStride floats per vertex (normals, UVs, ...)
+    const float*             AttributeWeights; // AttributeStride weights scaling each attribute's squared change
+    uint32_t                 AttributeStride;
+    uint32_t                 TargetIndexCount;
+    float                    TargetError;      // Object-space error a single collapse may not exceed.
+};
+
+// Quadric error metric edge-collapse simplification (Garland & Heckbert).
+//
+// Collapses are half-edge collapses onto an existing vertex, so the output indexes the
+// input vertex array and no attribute interpolation is needed. Open borders only collapse
+// along themselves and carry extra boundary quadrics so their outline is preserved.
+//
+// Vertices sharing a position are attribute seams. A seam vertex only collapses along the
+// seam, together with its twin on the other side, so the seam never opens. Vertices where
+// more than two attribute regions meet, or where a seam meets a border, are kept. The
+// weighted attribute change of a collapse is added to its cost.
+//
+// Writes the simplified triangle list to 'result' and returns the largest geometric error of any
+// collapse performed, as a distance in the units of the input positions.
+float SimplifyMesh(const SimplifyDesc& desc, std::vector<uint32_t>& result);
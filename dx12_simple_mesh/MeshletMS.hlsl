@@ -11,9 +11,79 @@
 
 
 #define ROOT_SIG "CBV(b0), \
-                  RootConstants(b1, num32bitconstants=2), \
-                  SRV(t0),\
-                  UAV(u0),"
+                  RootConstants(b1, num32bitconstants=15), \
+                  DescriptorTable(SRV(t0, numDescriptors=unbounded)), \
+                  DescriptorTable(UAV(u0)), \
+                  CBV(b2), \
+                  UAV(u1), \
+                  UAV(u2), \
+                  UAV(u3)"
+
+#define MAX_VERTS 64
+#define MAX_WAVES 32 // 128 threads at the minimum wave size of 4
+
+// Open addressed table the distinct index values of a group's window are found with; twice the
+// window's locations keeps probe sequences short.
+#define REUSE_TABLE_SIZE 128
+#define REUSE_EMPTY      0xffffffff
+
+// D3D_PRIMITIVE_TOPOLOGY values the shader special-cases
+#define TOPOLOGY_POINTLIST    1
+#define TOPOLOGY_TRIANGLELIST 4
+
+// Primitive assembly, defined per permutation by GenerateMeshShaderSource() from
+// PrimitiveTopologyInfo in PrimitiveAssembly.cpp. The generic shader assembles triangle lists.
+#ifndef PRIMITIVE_TOPOLOGY
+#define PRIMITIVE_TOPOLOGY     TOPOLOGY_TRIANGLELIST
+#define PRIM_VERTS             3
+#define PRIM_STEP              3
+#define PRIM_SPAN              3
+#define PRIM_OFFSETS           uint3(0, 1, 2)
+#define PRIM_STRIP_STRIDE      0
+#define PRIM_ALTERNATE_WINDING 0
+#define PRIM_FAN               0
+#define GROUP_PRIMS            21
+#endif
+
+#if PRIMITIVE_TOPOLOGY == TOPOLOGY_POINTLIST
+#define OUTPUT_PRIMS (GROUP_PRIMS * 2) // Each point is drawn as a quad
+#else
+#define OUTPUT_PRIMS GROUP_PRIMS
+#endif
+
+#if PRIM_VERTS == 2
+#define OUTPUT_TOPOLOGY "line"
+#define PRIM_INDICES    uint2
+#else
+#define OUTPUT_TOPOLOGY "triangle"
+#define PRIM_INDICES    uint3
+#endif
+
+// Must match c_maxVertexSlots and c_maxVertexElements in VertexFormat.h
+#define MAX_VERTEX_SLOTS    8
+#define MAX_VERTEX_ELEMENTS 16
+
+// Must match c_drawBufferCount in FixedFunctionContext.h
+#define DRAW_BUFFER_COUNT (MAX_VERTEX_SLOTS + 1)
+
+// Must match PrimitiveCull::EFlags in PrimitiveCulling.h
+#define CULL_FRUSTUM         0x1
+#define CULL_DEGENERATE      0x2
+#define CULL_BACKFACE        0x4
+#define CULL_SMALL_PRIMITIVE 0x8
+
+// Must match StreamOut::EFlags in StreamOutBuffer.h
+#define STREAM_OUT_ENABLED     0x1
+#define STREAM_OUT_INDEXED     0x2
+#define STREAM_OUT_WORLD_SPACE 0x4
+
+#define STREAM_OUT_DROPPED 0xffffffff
+
+// Stream output reserves its room with a 64-bit atomic; devices without 64-bit shader
+// atomics compile it out with STREAM_OUT=0, and the flags are then ignored.
+#ifndef STREAM_OUT
+#define STREAM_OUT 1
+#endif
 
 struct Constants
 {
@@ -21,11 +91,64 @@ struct Constants
     float4x4 WorldView;
     float4x4 WorldViewProj;
     uint     DrawMeshlets;
+    uint     CullFlags;
+    float2   ViewportSize;
+    uint     StreamOutFlags;
+    uint     StreamOutVertexCapacity;
+    uint     StreamOutPrimitiveCapacity;
+};
+
+// Must match MeshDrawParams in FixedFunctionContext.h
+struct DrawParams
+{
+    uint IndexSize;         // 2 or 4 for indexed draws, 0 otherwise
+    uint VertexCount;       // Vertices (or indices) per instance covered by this dispatch
+    uint StartLocation;     // First vertex, or first index, of this dispatch
+    int  BaseVertex;        // Added to every index
+    uint FirstInstance;     // Instance ID of the dispatch's first instance
+    uint StartInstance;     // StartInstanceLocation of the draw
+    uint InstanceCount;     // Instances covered by this dispatch
+    uint InstancesPerGroup; // Whole instances packed into each group along X, or 1
+    uint PackedGroups;      // Byte offset of the PackedDrawGroup records for packed dispatches, 0 otherwise
+    uint StripStart;        // First location of the draw, where its first strip or fan starts
+    uint CutIndex;          // Index value that restarts strips and fans, 0 when restart is disabled
+    uint GroupCount;        // Groups of the dispatch that do work; the rest of the grid exits
+    uint GridSizeX;         // DispatchMesh() group counts, to linearize SV_GroupID with
+    uint GridSizeY;
+    uint GroupsPerRow;      // Groups along the draw per instance row; rows are instances
+};
+
+// Must match PackedDraw in FixedFunctionContext.h
+struct PackedDraw
+{
+    uint BufferSet;         // Buffer set in DrawTable the draw reads
+    uint IndexSize;         // 2 or 4 for indexed draws, 0 otherwise
+    uint StartLocation;     // First vertex, or first index
+    int  BaseVertex;        // Added to every index
+    uint VertexCount;       // Vertices (or indices) per instance
+    uint StartInstance;     // StartInstanceLocation of the draw
+    uint InstanceCount;
+    uint GroupOffset;       // Group thread of the draw's first vertex
 };
 
-struct Vertex
+// Must match PackedDrawGroup in FixedFunctionContext.h
+struct PackedDrawGroup
 {
-    float4 Position;
+    uint FirstDraw;
+    uint DrawCount;
+    uint VertexCount;       // Threads the group's draws occupy
+    uint Padding;
+};
+
+// Mirrors VertexLayoutConstants in VertexFormat.h.
+struct VertexLayout
+{
+    uint  ElementCount;
+    uint  PositionElement;
+    uint2 Padding;
+    uint4 Strides[MAX_VERTEX_SLOTS / 4];
+    uint4 Elements[MAX_VERTEX_ELEMENTS]; // Slot, Offset, Format, Size
+    uint4 StepRates[MAX_VERTEX_ELEMENTS / 4]; // 0 for per-vertex elements
 };
 
 struct VertexOut
@@ -34,28 +157,632 @@ struct VertexOut
 };
 
 ConstantBuffer<Constants> Globals             : register(b0);
-StructuredBuffer<Vertex>  Vertices            : register(t0);
-RWStructuredBuffer<float4> debugOutput        : register(u0);
+ConstantBuffer<DrawParams> DrawParams         : register(b1);
+ConstantBuffer<VertexLayout> Layout           : register(b2);
+#ifdef CHECK_VERTEX_FETCH
+RWStructuredBuffer<uint4> debugOutput         : register(u0);
+#endif
+
+// Stream output: StreamOutCounters from StreamOutBuffer.h, float4 positions, and PRIM_VERTS
+// indices per primitive.
+RWByteAddressBuffer       StreamOutCounters   : register(u1);
+RWStructuredBuffer<float4> StreamOutVertices  : register(u2);
+RWByteAddressBuffer       StreamOutIndices    : register(u3);
+
+// The packed draw and group records, then one set of DRAW_BUFFER_COUNT raw buffers (vertex
+// slots, then indices) per distinct binding of the dispatch's draws.
+ByteAddressBuffer         DrawTable[]         : register(t0);
+
+// Buffer set and StartInstanceLocation of the draw the thread fetches for. Threads of a
+// packed group read different draws, so buffer indexing is non-uniform.
+static uint s_bufferSet;
+static uint s_startInstance;
+
+#define DRAW_BUFFER(slot) DrawTable[NonUniformResourceIndex(1 + s_bufferSet * DRAW_BUFFER_COUNT + (slot))]
+
+groupshared float4 s_clipPos[MAX_VERTS];
+groupshared uint   s_waveCounts[MAX_WAVES];
+groupshared uint   s_reuseKeys[REUSE_TABLE_SIZE];   // Index values
+groupshared uint   s_reuseOwners[REUSE_TABLE_SIZE]; // First thread to read each index value
+groupshared uint   s_vertexSlot[MAX_VERTS];         // Output vertex of each location of the window
+groupshared uint   s_cutMask[2];     // Locations of the group's window holding the cut index
+groupshared uint   s_lastCut;        // One past the last cut location before the window, or 0
+groupshared float4 s_streamPos[MAX_VERTS];          // Output vertices as stream output writes them
+groupshared uint2  s_streamBase;     // First vertex and primitive the group appends at, or STREAM_OUT_DROPPED
+
+// Loads an element's bytes from any byte address. Raw loads must be dword aligned, so the
+// covering dwords are loaded one by one (each bounds checked) and funnel shifted into place.
+uint4 LoadElementBits(uint slot, uint address, uint size)
+{
+    uint aligned = address & ~3u;
+    uint shift = (address & 3u) * 8;
+    uint count = (address - aligned + size + 3) / 4;
+
+    uint w[5];
+    [unroll]
+    for (uint i = 0; i < 5; ++i)
+    {
+        w[i] = i < count ? DRAW_BUFFER(slot).Load(aligned + i * 4) : 0;
+    }
+
+    if (shift == 0)
+        return uint4(w[0], w[1], w[2], w[3]);
+
+    return uint4((w[0] >> shift) | (w[1] << (32 - shift)),
+                 (w[1] >> shift) | (w[2] << (32 - shift)),
+                 (w[2] >> shift) | (w[3] << (32 - shift)),
+                 (w[3] >> shift) | (w[4] << (32 - shift)));
+}
+
+#ifdef SPECIALIZED_VERTEX_FETCH
+// Defined after this file by the source from GenerateMeshShaderSource(), with the layout's
+// strides, offsets and formats as literals.
+float4 FetchVertex(uint vertex, uint instance);
+#else
+// Generated from the format table in VertexFormat.cpp at startup.
+#include "VertexFetch.hlsli"
+
+// Emulates the input assembler: fetches and decodes every element of the layout, returning
+// POSITION0. Per-instance elements are indexed as in GetElementIndex() in VertexFormat.cpp.
+// With CHECK_VERTEX_FETCH, the first instance's decoded elements go to debugOutput to be
+// checked against the CPU decoder.
+float4 FetchVertex(uint vertex, uint instance)
+{
+    float4 position = float4(0, 0, 0, 1);
+
+    for (uint e = 0; e < Layout.ElementCount; ++e)
+    {
+        uint4 element = Layout.Elements[e];
+        uint  stride = Layout.Strides[element.x / 4][element.x % 4];
+        uint  stepRate = Layout.StepRates[e / 4][e % 4];
+        uint  index = stepRate == 0 ? vertex : s_startInstance + instance / stepRate;
+
+        uint4 value = DecodeVertexElement(element.z, LoadElementBits(element.x, index * stride + element.y, element.w));
+        if (e == Layout.PositionElement)
+        {
+            position = asfloat(value);
+        }
+
+#ifdef CHECK_VERTEX_FETCH
+        if (instance == 0)
+        {
+            debugOutput[vertex * Layout.ElementCount + e] = value;
+        }
+#endif
+    }
+
+    return position;
+}
+#endif
+
+// The index value at a location of an indexed draw's stream.
+uint ReadIndex(uint location, uint indexSize)
+{
+    uint address = location * indexSize;
+    uint index = DRAW_BUFFER(MAX_VERTEX_SLOTS).Load(address & ~3u);
+    if (indexSize == 2)
+    {
+        index = (index >> ((address & 2) * 8)) & 0xffff;
+    }
+
+    return index;
+}
+
+#if PRIM_STRIP_STRIDE > 0
+// Returns where the strip (or fan) holding the window's first location starts: one past the
+// last cut before the window, else the draw's first location. The group scans back 128
+// locations at a time, so every thread must call this. Also clears s_cutMask.
+//
+// A group's scan costs the distance back to the last cut, so the groups of an uncut strip of
+// N locations read about N^2 / 256 indices between them: the ScanStripStarts benchmark
+// measures it against the single pass of GetStripStarts. The draw path has no CPU copy of the
+// indices to find the starts up front, so draws with long strips should cut them or be split.
+uint FindStripStart(uint gtid, uint windowStart)
+{
+    if (gtid == 0)
+    {
+        s_lastCut = 0;
+        s_cutMask[0] = 0;
+        s_cutMask[1] = 0;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    uint scanEnd = windowStart;
+    while (DrawParams.CutIndex != 0 && scanEnd > DrawParams.StripStart)
+    {
+        uint scanCount = min(scanEnd - DrawParams.StripStart, 128);
+        if (gtid < scanCount && ReadIndex(scanEnd - 1 - gtid, DrawParams.IndexSize) == DrawParams.CutIndex)
+        {
+            InterlockedMax(s_lastCut, scanEnd - gtid);
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+        bool found = s_lastCut != 0;
+        GroupMemoryBarrierWithGroupSync();
+
+        if (found)
+            break;
+
+        scanEnd -= scanCount;
+    }
+
+    return max(s_lastCut, DrawParams.StripStart);
+}
+
+bool IsCut(uint i)
+{
+    return (s_cutMask[i / 32] >> (i % 32)) & 1;
+}
+#endif
+
+float2 ToScreen(float4 c)
+{
+    float invW = 1.0 / c.w;
+    return float2((c.x * invW * 0.5 + 0.5) * Globals.ViewportSize.x,
+                  (0.5 - c.y * invW * 0.5) * Globals.ViewportSize.y);
+}
+
+// Returns the thread's position among the group's threads passing 'keep', in thread order, and
+// their count. Per-wave counts are prefix summed in wave order. Every thread must call this.
+uint CompactGroup(uint gtid, bool keep, out uint keptCount)
+{
+    uint waveIndex = gtid / WaveGetLaneCount();
+    uint laneOffset = WavePrefixCountBits(keep);
+
+    if (WaveIsFirstLane())
+    {
+        s_waveCounts[waveIndex] = WaveActiveCountBits(keep);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    uint waveOffset = 0;
+    keptCount = 0;
+    for (uint i = 0; i < 128 / WaveGetLaneCount(); ++i)
+    {
+        waveOffset += (i < waveIndex) ? s_waveCounts[i] : 0;
+        keptCount += s_waveCounts[i];
+    }
+
+    // s_waveCounts is free for the next call once every thread has summed it.
+    GroupMemoryBarrierWithGroupSync();
+
+    return waveOffset + laneOffset;
+}
+
+// Post-transform vertex reuse within a group: returns the first thread of the group whose
+// location holds the same index value, so each distinct vertex of the window is fetched and
+// transformed once. Threads with 'active' false return themselves. Every thread must call this.
+// Keep in sync with DedupGroupIndices() in VertexReuse.cpp.
+uint FindIndexOwner(uint gtid, uint index, bool active)
+{
+    if (gtid < REUSE_TABLE_SIZE)
+    {
+        s_reuseKeys[gtid] = REUSE_EMPTY;
+        s_reuseOwners[gtid] = REUSE_EMPTY;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // REUSE_EMPTY can't be a key; such a location is its own vertex.
+    uint entry = REUSE_EMPTY;
+    if (active && index != REUSE_EMPTY)
+    {
+        entry = (index * 2654435761u) >> 25;
+
+        for (;;)
+        {
+            uint previous;
+            InterlockedCompareExchange(s_reuseKeys[entry], REUSE_EMPTY, index, previous);
+            if (previous == REUSE_EMPTY || previous == index)
+                break;
+
+            entry = (entry + 1) % REUSE_TABLE_SIZE;
+        }
 
+        InterlockedMin(s_reuseOwners[entry], gtid);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    return entry == REUSE_EMPTY ? gtid : s_reuseOwners[entry];
+}
+
+// Appends the group's primitives, in slot order, and their vertices to the stream output
+// buffers. Primitives are captured before culling, as D3D stream output captures them ahead of
+// the rasterizer. StreamOut::Indexed writes the group's output vertices, each distinct vertex
+// once where the group reuses them, with indices; otherwise each primitive writes its vertices.
+// The group reserves room for both with a single 64-bit add, so once a group doesn't fit no
+// later one does. Every thread must call this.
+void StreamOutGroup(uint gtid, bool valid, uint3 prim, bool fetch, uint outVertex, uint outVertexCount)
+{
+#if STREAM_OUT
+    uint primCount;
+    uint slot = CompactGroup(gtid, valid, primCount);
+
+    bool indexed = (Globals.StreamOutFlags & STREAM_OUT_INDEXED) != 0;
+    uint vertexCount = indexed ? outVertexCount : primCount * PRIM_VERTS;
+
+    if (gtid == 0)
+    {
+        s_streamBase = STREAM_OUT_DROPPED;
+
+        if (primCount > 0)
+        {
+            uint64_t previous;
+            StreamOutCounters.InterlockedAdd64(0, (uint64_t(primCount) << 32) | vertexCount, previous);
+
+            uint vertexBase = uint(previous);
+            uint primBase = uint(previous >> 32);
+
+            if (vertexCount <= Globals.StreamOutVertexCapacity && vertexBase <= Globals.StreamOutVertexCapacity - vertexCount &&
+                primCount <= Globals.StreamOutPrimitiveCapacity && primBase <= Globals.StreamOutPrimitiveCapacity - primCount)
+            {
+                StreamOutCounters.InterlockedAdd(8, primCount);
+                StreamOutCounters.InterlockedMax(12, vertexBase + vertexCount);
+                s_streamBase = uint2(vertexBase, primBase);
+            }
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    uint2 base = s_streamBase;
+    if (base.x == STREAM_OUT_DROPPED)
+        return;
+
+    if (indexed)
+    {
+        if (fetch)
+        {
+            StreamOutVertices[base.x + outVertex] = s_streamPos[outVertex];
+        }
+
+        if (valid)
+        {
+            [unroll]
+            for (uint k = 0; k < PRIM_VERTS; ++k)
+            {
+                StreamOutIndices.Store(((base.y + slot) * PRIM_VERTS + k) * 4, base.x + prim[k]);
+            }
+        }
+    }
+    else if (valid)
+    {
+        [unroll]
+        for (uint k = 0; k < PRIM_VERTS; ++k)
+        {
+            StreamOutVertices[base.x + slot * PRIM_VERTS + k] = s_streamPos[prim[k]];
+        }
+    }
+#endif
+}
+
+// Keep in sync with IsPrimitiveCulled() in PrimitiveCulling.cpp.
+bool IsPrimitiveCulled(float4 c0, float4 c1, float4 c2, uint flags)
+{
+    if (flags == 0)
+        return false;
+
+    if (flags & CULL_FRUSTUM)
+    {
+        if ((c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) ||
+            (c0.x >  c0.w && c1.x >  c1.w && c2.x >  c2.w) ||
+            (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w) ||
+            (c0.y >  c0.w && c1.y >  c1.w && c2.y >  c2.w) ||
+            (c0.z <  0.0  && c1.z <  0.0  && c2.z <  0.0 ) ||
+            (c0.z >  c0.w && c1.z >  c1.w && c2.z >  c2.w))
+            return true;
+    }
+
+    // Screen-space tests are only valid when the whole triangle is in front of the eye.
+    if (c0.w <= 0.0 || c1.w <= 0.0 || c2.w <= 0.0)
+        return false;
+
+    float2 s0 = ToScreen(c0);
+    float2 s1 = ToScreen(c1);
+    float2 s2 = ToScreen(c2);
+
+    // Positive area is clockwise in y-down screen space (default front face).
+    float area = (s1.x - s0.x) * (s2.y - s0.y) - (s2.x - s0.x) * (s1.y - s0.y);
+
+    if ((flags & CULL_DEGENERATE) && area == 0.0)
+        return true;
+
+    if ((flags & CULL_BACKFACE) && area < 0.0)
+        return true;
+
+    if (flags & CULL_SMALL_PRIMITIVE)
+    {
+        float2 mn = floor(min(s0, min(s1, s2)) + 0.5);
+        float2 mx = floor(max(s0, max(s1, s2)) + 0.5);
+
+        // No pixel-center sample lies between the rounded bounds.
+        if (any(mn == mx))
+            return true;
+    }
+
+    return false;
+}
 
 [RootSignature(ROOT_SIG)]
 [NumThreads(128, 1, 1)]
-[OutputTopology("triangle")]
+[OutputTopology(OUTPUT_TOPOLOGY)]
 void main(
     uint gtid : SV_GroupThreadID,
-    uint gid : SV_GroupID,
-    //out indices uint3 tris[126],
-    out vertices VertexOut verts[64]
+    uint3 gid : SV_GroupID,
+    out indices PRIM_INDICES tris[OUTPUT_PRIMS],
+    out vertices VertexOut verts[MAX_VERTS]
 )
 {
+    // Groups are planned linearly by PlanDispatch() and spread over the grid to stay within
+    // the per-dimension limit; the grid's spare groups output nothing. Linear groups form rows
+    // of GroupsPerRow.
+    // Packed dispatches give each group its own list of small draws, each taking a run of the
+    // group's threads. Small meshes pack whole instances into each group along a row. Both
+    // only apply to triangle lists. Otherwise each group assembles GROUP_PRIMS primitive slots
+    // from a window of the draw's stream, and rows of groups are instances.
+    // Keep in sync with GetDispatchGroup(), GetGroupThreadInput(), GetPackedThreadInput() and
+    // GetGroupPrimitive() in FixedFunctionContext.cpp.
+    uint linearGroup = gid.x + DrawParams.GridSizeX * (gid.y + DrawParams.GridSizeY * gid.z);
+    if (linearGroup >= DrawParams.GroupCount)
+    {
+        SetMeshOutputCounts(0, 0);
+        return;
+    }
 
-    SetMeshOutputCounts(9, 3);
+    uint2 groupPos = uint2(linearGroup % DrawParams.GroupsPerRow, linearGroup / DrawParams.GroupsPerRow);
 
-    float4 output_pos = mul(Vertices[gtid].Position, Globals.WorldViewProj);
-    
-    if (gtid == 0)
-      debugOutput[0] = float4(1.0, 2.0, 3.0, 4.0);
-    
-    verts[gtid].Position = output_pos;
-    
-}
\ No newline at end of file
+    uint location = 0;
+    uint instance = 0;
+    uint vertCount;
+    uint primCount;
+    uint indexSize = DrawParams.IndexSize;
+    int  baseVertex = DrawParams.BaseVertex;
+
+    s_bufferSet = 0;
+    s_startInstance = DrawParams.StartInstance;
+
+#if PRIMITIVE_TOPOLOGY == TOPOLOGY_TRIANGLELIST
+    if (DrawParams.PackedGroups != 0)
+    {
+        PackedDrawGroup group = DrawTable[0].Load<PackedDrawGroup>(DrawParams.PackedGroups + groupPos.x * 16);
+        vertCount = group.VertexCount;
+
+        for (uint d = 0; d < group.DrawCount; ++d)
+        {
+            PackedDraw draw = DrawTable[0].Load<PackedDraw>((group.FirstDraw + d) * 32);
+
+            uint local = gtid - draw.GroupOffset; // Wraps for threads before the draw
+            if (local < draw.VertexCount * draw.InstanceCount)
+            {
+                location = draw.StartLocation + local % draw.VertexCount;
+                instance = local / draw.VertexCount;
+                indexSize = draw.IndexSize;
+                baseVertex = draw.BaseVertex;
+
+                s_bufferSet = draw.BufferSet;
+                s_startInstance = draw.StartInstance;
+            }
+        }
+
+        primCount = vertCount / 3;
+    }
+    else if (DrawParams.InstancesPerGroup > 1)
+    {
+        uint firstInstance = groupPos.x * DrawParams.InstancesPerGroup;
+        uint instanceCount = firstInstance < DrawParams.InstanceCount ? min(DrawParams.InstanceCount - firstInstance, DrawParams.InstancesPerGroup) : 0;
+
+        vertCount = instanceCount * DrawParams.VertexCount;
+        primCount = vertCount / 3;
+        location = DrawParams.StartLocation + gtid % DrawParams.VertexCount;
+        instance = DrawParams.FirstInstance + firstInstance + gtid / DrawParams.VertexCount;
+    }
+    else
+#endif
+    {
+        uint slotCount = DrawParams.VertexCount < PRIM_SPAN ? 0 : (DrawParams.VertexCount - PRIM_SPAN) / PRIM_STEP + 1;
+        uint firstSlot = groupPos.x * GROUP_PRIMS;
+
+        primCount = firstSlot < slotCount ? min(slotCount - firstSlot, GROUP_PRIMS) : 0;
+        vertCount = primCount > 0 ? (primCount - 1) * PRIM_STEP + PRIM_SPAN : 0;
+        location = DrawParams.StartLocation + firstSlot * PRIM_STEP + gtid;
+        instance = DrawParams.FirstInstance + groupPos.y;
+    }
+
+    uint windowStart = DrawParams.StartLocation + groupPos.x * GROUP_PRIMS * PRIM_STEP;
+    uint fetchCount = vertCount;
+
+#if PRIM_STRIP_STRIDE > 0
+    uint stripStart = FindStripStart(gtid, windowStart);
+
+#if PRIM_FAN
+    // One more vertex: the first of a fan started before the window.
+    if (primCount > 0)
+    {
+        fetchCount = vertCount + 1;
+        if (gtid == vertCount)
+        {
+            location = stripStart;
+        }
+    }
+#endif
+#endif
+
+    uint index = location;
+    if (gtid < fetchCount && indexSize != 0)
+    {
+        index = ReadIndex(location, indexSize);
+    }
+
+    // Each location is output as its own vertex, except that indexed triangle list windows
+    // output each distinct index value once.
+    bool fetch = gtid < fetchCount;
+    uint outVertex = gtid;
+    uint outVertexCount = fetchCount;
+
+#if PRIMITIVE_TOPOLOGY == TOPOLOGY_TRIANGLELIST
+    bool reuse = indexSize != 0 && DrawParams.PackedGroups == 0 && DrawParams.InstancesPerGroup <= 1;
+    if (reuse)
+    {
+        uint owner = FindIndexOwner(gtid, index, gtid < fetchCount);
+
+        fetch = fetch && owner == gtid;
+        outVertex = CompactGroup(gtid, fetch, outVertexCount);
+
+        if (fetch)
+        {
+            s_vertexSlot[gtid] = outVertex;
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+
+        // Owners rewrite their own entry with the same value, so this doesn't race the reads.
+        if (gtid < fetchCount)
+        {
+            s_vertexSlot[gtid] = s_vertexSlot[owner];
+        }
+    }
+#endif
+
+    float4 clipPos = 0;
+    if (fetch)
+    {
+        bool cut = false;
+        uint vertexId = indexSize != 0 ? index + baseVertex : location;
+
+#if PRIM_STRIP_STRIDE > 0
+        cut = indexSize != 0 && DrawParams.CutIndex != 0 && index == DrawParams.CutIndex && gtid < vertCount;
+        if (cut)
+        {
+            InterlockedOr(s_cutMask[gtid / 32], 1u << (gtid % 32));
+        }
+#endif
+
+        // Cut indices are not vertices.
+        float4 position = 0;
+        if (!cut)
+        {
+            position = FetchVertex(vertexId, instance);
+            clipPos = mul(position, Globals.WorldViewProj);
+        }
+
+        s_clipPos[outVertex] = clipPos;
+
+        if (Globals.StreamOutFlags & STREAM_OUT_ENABLED)
+        {
+            s_streamPos[outVertex] = (Globals.StreamOutFlags & STREAM_OUT_WORLD_SPACE) ? mul(position, Globals.World) : clipPos;
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+#if PRIMITIVE_TOPOLOGY == TOPOLOGY_POINTLIST
+    // Each point is captured as itself, not as the quad it's drawn as.
+    if (Globals.StreamOutFlags & STREAM_OUT_ENABLED)
+    {
+        StreamOutGroup(gtid, gtid < primCount, uint3(gtid, 0, 0), fetch, outVertex, outVertexCount);
+    }
+
+    // Points are drawn as pixel-sized quads, clockwise like any front-facing triangle.
+    SetMeshOutputCounts(primCount * 4, primCount * 2);
+
+    if (gtid < primCount * 4)
+    {
+        float4 c = s_clipPos[gtid / 4];
+        float2 corner = float2((gtid & 1) ? 1.0 : -1.0, (gtid & 2) ? -1.0 : 1.0);
+
+        verts[gtid].Position = float4(c.xy + corner / Globals.ViewportSize * c.w, c.zw);
+    }
+
+    if (gtid < primCount * 2)
+    {
+        tris[gtid] = (gtid / 2) * 4 + ((gtid & 1) ? uint3(2, 1, 3) : uint3(0, 1, 2));
+    }
+#else
+    // Assemble the thread's primitive slot. Strip slots covering a cut are discarded; the rest
+    // belong to the strip started after the last cut before them, which sets their winding.
+    bool valid = gtid < primCount;
+    uint base = gtid * PRIM_STEP;
+    uint3 prim = PRIM_OFFSETS + base;
+
+#if PRIM_STRIP_STRIDE > 0
+    if (valid)
+    {
+        [unroll]
+        for (uint k = 0; k < PRIM_SPAN; ++k)
+        {
+            valid = valid && !IsCut(base + k);
+        }
+
+        uint low = base >= 32 ? s_cutMask[0] : s_cutMask[0] & ((1u << base) - 1);
+        uint high = base > 32 ? s_cutMask[1] & ((1u << (base - 32)) - 1) : 0;
+
+        uint start = stripStart;
+        if (high != 0)
+        {
+            start = windowStart + 32 + firstbithigh(high) + 1;
+        }
+        else if (low != 0)
+        {
+            start = windowStart + firstbithigh(low) + 1;
+        }
+
+        uint stripSlot = windowStart + base - start;
+        valid = valid && stripSlot % PRIM_STRIP_STRIDE == 0;
+
+#if PRIM_ALTERNATE_WINDING
+        if ((stripSlot / PRIM_STRIP_STRIDE) & 1)
+        {
+            prim.xy = prim.yx;
+        }
+#endif
+
+#if PRIM_FAN
+        prim.z = start >= windowStart ? start - windowStart : vertCount;
+#endif
+    }
+#endif
+
+#if PRIMITIVE_TOPOLOGY == TOPOLOGY_TRIANGLELIST
+    if (reuse && valid)
+    {
+        prim = uint3(s_vertexSlot[prim.x], s_vertexSlot[prim.y], s_vertexSlot[prim.z]);
+    }
+#endif
+
+    if (Globals.StreamOutFlags & STREAM_OUT_ENABLED)
+    {
+        StreamOutGroup(gtid, valid, prim, fetch, outVertex, outVertexCount);
+    }
+
+    // Cull primitives and compact survivors, which keep their original relative order.
+    bool visible = valid;
+#if PRIM_VERTS == 3
+    if (valid)
+    {
+        visible = !IsPrimitiveCulled(s_clipPos[prim.x], s_clipPos[prim.y], s_clipPos[prim.z], Globals.CullFlags);
+    }
+#endif
+
+    uint survivorCount;
+    uint survivor = CompactGroup(gtid, visible, survivorCount);
+
+    SetMeshOutputCounts(outVertexCount, survivorCount);
+
+    if (fetch)
+    {
+        verts[outVertex].Position = clipPos;
+    }
+
+    if (visible)
+    {
+#if PRIM_VERTS == 3
+        tris[survivor] = prim;
+#else
+        tris[survivor] = prim.xy;
+#endif
+    }
+#endif
+}
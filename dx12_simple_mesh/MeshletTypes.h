@@ -0,0 +1,39 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+
+// Meshlet data shared by the loader and the offline meshlet tools.
+// Kept free of D3D12 types so the tools build on any platform.
+
+struct Meshlet
+{
+    uint32_t VertCount;
+    uint32_t VertOffset;
+    uint32_t PrimCount;
+    uint32_t PrimOffset;
+};
+
+struct PackedTriangle
+{
+    uint32_t i0 : 10;
+    uint32_t i1 : 10;
+    uint32_t i2 : 10;
+};
+
+struct CullData
+{
+    DirectX::XMFLOAT4 BoundingSphere; // xyz = center, w = radius
+    uint8_t           NormalCone[4];  // xyz = axis, w = -cos(a + 90)
+    float             ApexOffset;     // apex = center - axis * offset
+};
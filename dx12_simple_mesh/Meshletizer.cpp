@@ -0,0 +1,291 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Meshletizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    const uint32_t c_invalid = ~0u;
+
+    // Normal cones whose triangles spread further than this (cosine) are never culled.
+    const float c_minConeDot = 0.1f;
+
+    XMFLOAT3 Sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+    float Dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    XMFLOAT3 Cross(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+
+    uint8_t QuantizeUnorm(float v)
+    {
+        return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, v * 255.0f + 0.5f)));
+    }
+}
+
+void ComputeMeshlets(
+    const uint32_t* indices,
+    uint32_t indexCount,
+    uint32_t vertexCount,
+    uint32_t maxVerts,
+    uint32_t maxPrims,
+    std::vector<Meshlet>& meshlets,
+    std::vector<uint32_t>& uniqueVertexIndices,
+    std::vector<PackedTriangle>& primitiveIndices)
+{
+    const uint32_t triCount = indexCount / 3;
+
+    // Vertex -> triangle adjacency in compressed rows.
+    std::vector<uint32_t> adjStart(vertexCount + 1, 0);
+    for (uint32_t i = 0; i < triCount * 3; ++i)
+    {
+        adjStart[indices[i] + 1]++;
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        adjStart[v + 1] += adjStart[v];
+    }
+
+    std::vector<uint32_t> adjTris(triCount * 3);
+    std::vector<uint32_t> cursor(adjStart.begin(), adjStart.end() - 1);
+    for (uint32_t i = 0; i < triCount * 3; ++i)
+    {
+        adjTris[cursor[indices[i]]++] = i / 3;
+    }
+
+    std::vector<bool> emitted(triCount, false);
+    std::vector<uint32_t> localIndex(vertexCount, c_invalid);
+    std::vector<uint32_t> candidates;
+    uint32_t seed = 0;
+
+    Meshlet meshlet = {};
+    meshlet.VertOffset = static_cast<uint32_t>(uniqueVertexIndices.size());
+    meshlet.PrimOffset = static_cast<uint32_t>(primitiveIndices.size());
+
+    auto newVertexCount = [&](uint32_t tri)
+    {
+        return (localIndex[indices[tri * 3 + 0]] == c_invalid ? 1u : 0u)
+            + (localIndex[indices[tri * 3 + 1]] == c_invalid ? 1u : 0u)
+            + (localIndex[indices[tri * 3 + 2]] == c_invalid ? 1u : 0u);
+    };
+
+    auto fits = [&](uint32_t tri)
+    {
+        return meshlet.VertCount + newVertexCount(tri) <= maxVerts && meshlet.PrimCount + 1 <= maxPrims;
+    };
+
+    auto flush = [&]()
+    {
+        for (uint32_t i = 0; i < meshlet.VertCount; ++i)
+        {
+            localIndex[uniqueVertexIndices[meshlet.VertOffset + i]] = c_invalid;
+        }
+
+        meshlets.push_back(meshlet);
+
+        meshlet = {};
+        meshlet.VertOffset = static_cast<uint32_t>(uniqueVertexIndices.size());
+        meshlet.PrimOffset = static_cast<uint32_t>(primitiveIndices.size());
+        candidates.clear();
+    };
+
+    auto append = [&](uint32_t tri)
+    {
+        uint32_t local[3];
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            const uint32_t v = indices[tri * 3 + k];
+            if (localIndex[v] == c_invalid)
+            {
+                localIndex[v] = meshlet.VertCount++;
+                uniqueVertexIndices.push_back(v);
+            }
+            local[k] = localIndex[v];
+
+            for (uint32_t j = adjStart[v]; j < adjStart[v + 1]; ++j)
+            {
+                if (!emitted[adjTris[j]])
+                {
+                    candidates.push_back(adjTris[j]);
+                }
+            }
+        }
+
+        PackedTriangle packed = {};
+        packed.i0 = local[0];
+        packed.i1 = local[1];
+        packed.i2 = local[2];
+        primitiveIndices.push_back(packed);
+
+        emitted[tri] = true;
+        meshlet.PrimCount++;
+    };
+
+    for (;;)
+    {
+        // Pick the neighbouring triangle that needs the fewest new vertices.
+        uint32_t best = c_invalid;
+        uint32_t bestCost = c_invalid;
+        size_t write = 0;
+
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            const uint32_t tri = candidates[i];
+            if (emitted[tri])
+                continue;
+
+            candidates[write++] = tri;
+
+            const uint32_t cost = newVertexCount(tri);
+            if (cost < bestCost && fits(tri))
+            {
+                best = tri;
+                bestCost = cost;
+            }
+        }
+        candidates.resize(write);
+
+        if (best == c_invalid)
+        {
+            // Nothing adjacent fits; start a new meshlet unless this one is still empty.
+            while (seed < triCount && emitted[seed])
+            {
+                ++seed;
+            }
+
+            if (seed == triCount)
+                break;
+
+            if (meshlet.PrimCount > 0 && (!candidates.empty() || !fits(seed)))
+            {
+                flush();
+                continue;
+            }
+
+            best = seed;
+        }
+
+        append(best);
+    }
+
+    if (meshlet.PrimCount > 0)
+    {
+        flush();
+    }
+}
+
+void ComputeCullData(
+    const XMFLOAT3* positions,
+    const Meshlet* meshlets,
+    uint32_t meshletCount,
+    const uint32_t* uniqueVertexIndices,
+    const PackedTriangle* primitiveIndices,
+    CullData* cullData)
+{
+    for (uint32_t m = 0; m < meshletCount; ++m)
+    {
+        const Meshlet& meshlet = meshlets[m];
+        const uint32_t* verts = uniqueVertexIndices + meshlet.VertOffset;
+        const PackedTriangle* prims = primitiveIndices + meshlet.PrimOffset;
+        CullData& cull = cullData[m];
+
+        // Bounding sphere around the box center; loose but cheap and stable.
+        XMFLOAT3 mn(FLT_MAX, FLT_MAX, FLT_MAX);
+        XMFLOAT3 mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (uint32_t i = 0; i < meshlet.VertCount; ++i)
+        {
+            const XMFLOAT3& p = positions[verts[i]];
+            mn = XMFLOAT3(std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z));
+            mx = XMFLOAT3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+        }
+
+        const XMFLOAT3 center((mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f);
+        float radiusSq = 0.0f;
+        for (uint32_t i = 0; i < meshlet.VertCount; ++i)
+        {
+            const XMFLOAT3 d = Sub(positions[verts[i]], center);
+            radiusSq = std::max(radiusSq, Dot(d, d));
+        }
+        cull.BoundingSphere = XMFLOAT4(center.x, center.y, center.z, std::sqrt(radiusSq));
+
+        // Normal cone: average the face normals, then find the widest deviation from it.
+        std::vector<XMFLOAT3> normals(meshlet.PrimCount);
+        XMFLOAT3 axis(0, 0, 0);
+        for (uint32_t i = 0; i < meshlet.PrimCount; ++i)
+        {
+            const XMFLOAT3& p0 = positions[verts[prims[i].i0]];
+            const XMFLOAT3& p1 = positions[verts[prims[i].i1]];
+            const XMFLOAT3& p2 = positions[verts[prims[i].i2]];
+
+            XMFLOAT3 n = Cross(Sub(p1, p0), Sub(p2, p0));
+            const float length = std::sqrt(Dot(n, n));
+            n = length > 0.0f ? XMFLOAT3(n.x / length, n.y / length, n.z / length) : XMFLOAT3(0, 0, 0);
+
+            normals[i] = n;
+            axis = XMFLOAT3(axis.x + n.x, axis.y + n.y, axis.z + n.z);
+        }
+
+        const float axisLength = std::sqrt(Dot(axis, axis));
+        float minDot = 1.0f;
+        if (axisLength > 0.0f)
+        {
+            axis = XMFLOAT3(axis.x / axisLength, axis.y / axisLength, axis.z / axisLength);
+            for (uint32_t i = 0; i < meshlet.PrimCount; ++i)
+            {
+                minDot = std::min(minDot, Dot(axis, normals[i]));
+            }
+        }
+
+        if (axisLength <= 0.0f || minDot < c_minConeDot)
+        {
+            // Degenerate cone; w = 0xff tells the culling code never to reject this meshlet.
+            cull.NormalCone[0] = cull.NormalCone[1] = cull.NormalCone[2] = 127;
+            cull.NormalCone[3] = 0xff;
+            cull.ApexOffset = 0.0f;
+            continue;
+        }
+
+        // Push the apex back along the axis until it is behind every triangle's plane.
+        float maxT = 0.0f;
+        for (uint32_t i = 0; i < meshlet.PrimCount; ++i)
+        {
+            const XMFLOAT3 c = Sub(center, positions[verts[prims[i].i0]]);
+            const float dn = Dot(axis, normals[i]);
+            maxT = std::max(maxT, Dot(c, normals[i]) / dn);
+        }
+
+        // Round the cutoff up so quantization can only make the cone wider.
+        const float cutoff = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+
+        cull.NormalCone[0] = QuantizeUnorm(axis.x * 0.5f + 0.5f);
+        cull.NormalCone[1] = QuantizeUnorm(axis.y * 0.5f + 0.5f);
+        cull.NormalCone[2] = QuantizeUnorm(axis.z * 0.5f + 0.5f);
+        cull.NormalCone[3] = static_cast<uint8_t>(std::min(255.0f, std::ceil(cutoff * 255.0f)));
+        cull.ApexOffset = maxT;
+    }
+}
+
+XMFLOAT4 MergeSpheres(const XMFLOAT4& a, const XMFLOAT4& b)
+{
+    const XMFLOAT3 d(b.x - a.x, b.y - a.y, b.z - a.z);
+    const float distance = std::sqrt(Dot(d, d));
+
+    if (distance + b.w <= a.w)
+        return a;
+    if (distance + a.w <= b.w)
+        return b;
+
+    const float radius = (distance + a.w + b.w) * 0.5f;
+    const float t = (radius - a.w) / distance;
+    return XMFLOAT4(a.x + d.x * t, a.y + d.y * t, a.z + d.z * t, radius);
+}
@@ -0,0 +1,48 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "MeshletTypes.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+// Meshlet limits matching the thread group layout of the mesh shader.
+const uint32_t c_maxMeshletVerts = 64;
+const uint32_t c_maxMeshletPrims = 126;
+
+// Splits a triangle list into meshlets. Triangles are grown outward from a seed over
+// shared vertices, preferring the candidate that adds the fewest new vertices, so each
+// meshlet is spatially coherent and reuses as many vertices as possible.
+//
+// Meshlet::VertOffset/PrimOffset index into uniqueVertexIndices/primitiveIndices, which
+// are appended to (not cleared), so several index lists can share output arrays.
+void ComputeMeshlets(
+    const uint32_t* indices,
+    uint32_t indexCount,
+    uint32_t vertexCount,
+    uint32_t maxVerts,
+    uint32_t maxPrims,
+    std::vector<Meshlet>& meshlets,
+    std::vector<uint32_t>& uniqueVertexIndices,
+    std::vector<PackedTriangle>& primitiveIndices);
+
+// Computes bounding spheres and normal cones for a range of meshlets.
+void ComputeCullData(
+    const DirectX::XMFLOAT3* positions,
+    const Meshlet* meshlets,
+    uint32_t meshletCount,
+    const uint32_t* uniqueVertexIndices,
+    const PackedTriangle* primitiveIndices,
+    CullData* cullData);
+
+// Smallest sphere (xyz = center, w = radius) containing both a and b.
+DirectX::XMFLOAT4 MergeSpheres(const DirectX::XMFLOAT4& a, const DirectX::XMFLOAT4& b);
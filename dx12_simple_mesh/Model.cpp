@@ -8,16 +8,15 @@
 // PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
 //
 //*********************************************************
-#include "stdafx.h"
+#include "Platform.h"
 #include "Model.h"
 
-#include "DXSampleHelper.h"
-
+#include <cassert>
+#include <cstring>
 #include <fstream>
-#include <unordered_set>
+#include <stdexcept>
 
 using namespace DirectX;
-using namespace Microsoft::WRL;
 
 namespace
 { 
@@ -29,7 +28,7 @@ namespace
             case DXGI_FORMAT_R32G32B32_FLOAT: return 12;
             case DXGI_FORMAT_R32G32_FLOAT: return 8;
             case DXGI_FORMAT_R32_FLOAT: return 4;
-            default: throw std::exception("Unimplemented type");
+            default: throw std::runtime_error("Unimplemented type");
         }
     }
 
@@ -38,47 +37,89 @@ namespace
     {
         return (num + denom - 1) / denom;
     }
-
-    template <typename T>
-    size_t GetAlignedSize(T size)
-    {
-        const size_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
-        const size_t alignedSize = (size + alignment - 1) & ~(alignment - 1);
-        return alignedSize;
-    }
 }
 
 HRESULT Model::LoadFromVtxBuffer(const std::vector<XMFLOAT4>& positions)
 {
-    //const uint32_t vertexStride = sizeof(XMFLOAT4);
-    //const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
-    //
-    //std::vector<uint8_t> vertexBuffer(vertexCount * vertexStride);
-    //memcpy(vertexBuffer.data(), positions.data(), vertexBuffer.size());
-
-    // Simulate vertex layout: POSITION only
-    std::vector<D3D12_INPUT_ELEMENT_DESC> inputLayout = {
+    const D3D12_INPUT_ELEMENT_DESC inputElements[] =
+    {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
     };
 
-    m_prims.Indices.resize(positions.size());
-    for (int i = 0; i < positions.size(); i++) {
+    const D3D12_INPUT_LAYOUT_DESC layout = { inputElements, _countof(inputElements) };
+    const void* buffers[] = { positions.data() };
+    const uint32_t strides[] = { sizeof(XMFLOAT4) };
+
+    return LoadFromVertexBuffers(layout, buffers, strides, _countof(buffers), static_cast<uint32_t>(positions.size()));
+}
+
+HRESULT Model::LoadFromVertexBuffers(const D3D12_INPUT_LAYOUT_DESC& layout, const void* const* buffers, const uint32_t* strides, uint32_t slotCount, uint32_t vertexCount)
+{
+    VertexLayout resolved;
+    HRESULT hr = ResolveInputLayout(layout, strides, slotCount, resolved);
+    if (FAILED(hr))
+        return hr;
+
+    // A prim only holds per-vertex data; instance streams are bound by the caller.
+    for (const VertexElement& elem : resolved.Elements)
+    {
+        if (elem.InstanceStepRate != 0)
+            return E_NOTIMPL;
+    }
+
+    // Size each slot to what the layout reads from it; a zero stride holds a single vertex.
+    std::vector<size_t> slotSizes(slotCount);
+    for (uint32_t s = 0; s < slotCount; ++s)
+    {
+        slotSizes[s] = size_t(strides[s]) * vertexCount;
+        for (const VertexElement& elem : resolved.Elements)
+        {
+            if (elem.Slot == s)
+            {
+                slotSizes[s] = std::max(slotSizes[s], size_t(elem.Offset) + GetVertexFormatInfo(elem.Format)->Size);
+            }
+        }
+
+        if (slotSizes[s] == 0)
+            return E_INVALIDARG; // An unused slot with no stride; nothing to bind.
+    }
+
+    m_prims.Layout = resolved;
+
+    // Keep our own copy of the layout; the semantic names must outlive the caller's.
+    m_prims.SemanticNames.resize(layout.NumElements);
+    m_prims.LayoutElems.assign(layout.pInputElementDescs, layout.pInputElementDescs + layout.NumElements);
+    for (uint32_t i = 0; i < layout.NumElements; ++i)
+    {
+        m_prims.SemanticNames[i] = layout.pInputElementDescs[i].SemanticName;
+        m_prims.LayoutElems[i].SemanticName = m_prims.SemanticNames[i].c_str();
+    }
+
+    m_prims.LayoutDesc.pInputElementDescs = m_prims.LayoutElems.data();
+    m_prims.LayoutDesc.NumElements = layout.NumElements;
+
+    m_prims.Vertices.resize(slotCount);
+    m_prims.VertexStrides.assign(strides, strides + slotCount);
+    for (uint32_t s = 0; s < slotCount; ++s)
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(buffers[s]);
+        m_prims.Vertices[s].assign(data, data + slotSizes[s]);
+    }
+    m_prims.VertexCount = vertexCount;
+
+    m_prims.Indices.resize(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++) {
         m_prims.Indices[i] = i;
     }
-    m_prims.IndexCount = 3;
-    m_prims.IndexSize = m_prims.Indices.size();
-    
-    m_prims.Vertices.resize(positions.size());
-    std::copy(positions.begin(), positions.end(), m_prims.Vertices.begin());
-    m_prims.VertexCount = m_prims.Vertices.size();
-    
+    m_prims.IndexCount = vertexCount;
+    m_prims.IndexSize = sizeof(uint32_t);
 
     return S_OK;
 }
 
 HRESULT Model::LoadFromFile(const wchar_t* filename)
 {
-    std::ifstream stream(filename, std::ios::binary);
+    std::ifstream stream(GetStreamPath(filename), std::ios::binary);
     if (!stream.is_open())
     {
         return E_INVALIDARG;
@@ -157,7 +198,7 @@ HRESULT Model::LoadFromFile(const wchar_t* filename)
 
         for (uint32_t j = 0; j < Attribute::Count; ++j)
         {
-            if (meshView.Attributes[j] == -1)
+            if (meshView.Attributes[j] == c_noAccessor)
                 continue;
 
             Accessor& accessor = accessors[meshView.Attributes[j]];
@@ -182,7 +223,7 @@ HRESULT Model::LoadFromFile(const wchar_t* filename)
          // Populate the vertex buffer metadata from accessors.
         for (uint32_t j = 0; j < Attribute::Count; ++j)
         {
-            if (meshView.Attributes[j] == -1)
+            if (meshView.Attributes[j] == c_noAccessor)
                 continue;
 
             Accessor& accessor = accessors[meshView.Attributes[j]];
@@ -272,6 +313,9 @@ HRESULT Model::LoadFromFile(const wchar_t* filename)
             }
         }
 
+        m.PositionSlot = vbIndexPos;
+        m.PositionOffset = positionOffset;
+
         XMFLOAT3* v0 = reinterpret_cast<XMFLOAT3*>(m.Vertices[vbIndexPos].data() + positionOffset);
         uint32_t stride = m.VertexStrides[vbIndexPos];
 
@@ -289,97 +333,3 @@ HRESULT Model::LoadFromFile(const wchar_t* filename)
 
      return S_OK;
 }
-
-HRESULT Model::UploadGpuResources(ID3D12Device* device, ID3D12CommandQueue* cmdQueue, ID3D12CommandAllocator* cmdAlloc, ID3D12GraphicsCommandList* cmdList)
-{
-    auto& prim = m_prims;
-
-    // Create committed D3D resources of proper sizes
-    auto indexDesc = CD3DX12_RESOURCE_DESC::Buffer(prim.Indices.size());
-    
-    auto defaultHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-    ThrowIfFailed(device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &indexDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&prim.IndexResource)));
-    
-
-    prim.IBView.BufferLocation = prim.IndexResource->GetGPUVirtualAddress();
-    prim.IBView.Format = DXGI_FORMAT_R32_UINT;
-    prim.IBView.SizeInBytes = prim.IndexCount * prim.IndexSize;
-
-    prim.VertexResources.resize(1);
-    prim.VBViews.resize(1);
-
-    auto vertexDesc = CD3DX12_RESOURCE_DESC::Buffer(prim.Vertices.size());
-    device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &vertexDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&prim.VertexResources[0]));
-
-    prim.VBViews[0].BufferLocation = prim.VertexResources[0]->GetGPUVirtualAddress();
-    prim.VBViews[0].SizeInBytes = static_cast<uint32_t>(prim.Vertices.size());
-    prim.VBViews[0].StrideInBytes = sizeof(DirectX::XMFLOAT4);
-
-    // Create upload resources
-    std::vector<ComPtr<ID3D12Resource>> vertexUploads;
-    ComPtr<ID3D12Resource>              indexUpload;
-    
-    auto uploadHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-    ThrowIfFailed(device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &indexDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&indexUpload)));
-    
-    // Map & copy memory to upload heap
-    vertexUploads.resize(1);
-    for (uint32_t j = 0; j < 1; ++j)
-    {
-        auto vertexDesc = CD3DX12_RESOURCE_DESC::Buffer(prim.Vertices.size());
-        ThrowIfFailed(device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &vertexDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&vertexUploads[j])));
-
-        uint8_t* memory = nullptr;
-        vertexUploads[j]->Map(0, nullptr, reinterpret_cast<void**>(&memory));
-        std::memcpy(memory, prim.Vertices.data(), prim.Vertices.size());
-        vertexUploads[j]->Unmap(0, nullptr);
-        
-    }
-
-    {
-        uint8_t* memory = nullptr;
-        indexUpload->Map(0, nullptr, reinterpret_cast<void**>(&memory));
-        std::memcpy(memory, prim.Indices.data(), prim.Indices.size());
-        indexUpload->Unmap(0, nullptr);
-    }
-
-    // Populate our command list
-    cmdList->Reset(cmdAlloc, nullptr);
-
-    for (uint32_t j = 0; j < 1; ++j)
-    {
-        cmdList->CopyResource(prim.VertexResources[j].Get(), vertexUploads[j].Get());
-        const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(prim.VertexResources[j].Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-        cmdList->ResourceBarrier(1, &barrier);
-    }
-
-    D3D12_RESOURCE_BARRIER postCopyBarriers;
-
-    cmdList->CopyResource(prim.IndexResource.Get(), indexUpload.Get());
-    postCopyBarriers = CD3DX12_RESOURCE_BARRIER::Transition(prim.IndexResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-
-    cmdList->ResourceBarrier(1, &postCopyBarriers);
-
-    ThrowIfFailed(cmdList->Close());
-
-    ID3D12CommandList* ppCommandLists[] = { cmdList };
-    cmdQueue->ExecuteCommandLists(1, ppCommandLists);
-
-    // Create our sync fence
-    ComPtr<ID3D12Fence> fence;
-    ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
-
-    cmdQueue->Signal(fence.Get(), 1);
-
-    // Wait for GPU
-    if (fence->GetCompletedValue() != 1)
-    {
-        HANDLE event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        fence->SetEventOnCompletion(1, event);
-
-        WaitForSingleObjectEx(event, INFINITE, false);
-        CloseHandle(event);
-    }
-
-    return S_OK;
-}
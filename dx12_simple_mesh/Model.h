@@ -10,9 +10,15 @@
 //*********************************************************
 #pragma once
 
+#include "Platform.h"
+#include "MeshletTypes.h"
 #include "Span.h"
+#include "VertexFormat.h"
 #include <DirectXMath.h>
 #include <DirectXCollision.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 struct Attribute
 {
@@ -45,35 +51,13 @@ struct MeshInfo
     uint32_t LastMeshletPrimCount;
 };
 
-struct Meshlet
-{
-    uint32_t VertCount;
-    uint32_t VertOffset;
-    uint32_t PrimCount;
-    uint32_t PrimOffset;
-};
-
-struct PackedTriangle
-{
-    uint32_t i0 : 10;
-    uint32_t i1 : 10;
-    uint32_t i2 : 10;
-};
-
-struct CullData
-{
-    DirectX::XMFLOAT4 BoundingSphere; // xyz = center, w = radius
-    uint8_t           NormalCone[4];  // xyz = axis, w = -cos(a + 90)
-    float             ApexOffset;     // apex = center - axis * offset
-};
-
 const D3D12_INPUT_ELEMENT_DESC c_elementDescs[Attribute::Count] =
 {
-    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 1 },
-    { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 1 },
-    { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 1 },
-    { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 1 },
-    { "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 1 },
+    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    { "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 };
 
 const uint32_t c_sizeMap[] =
@@ -104,6 +88,9 @@ struct FileHeader
     uint32_t BufferSize;
 };
 
+// MeshHeader::Attributes entry of an attribute the mesh doesn't have.
+const uint32_t c_noAccessor = uint32_t(-1);
+
 struct MeshHeader
 {
     uint32_t Indices;
@@ -134,20 +121,17 @@ struct Accessor
 
 struct Prim
 {
-    D3D12_INPUT_ELEMENT_DESC   LayoutElems[Attribute::Count];
+    std::vector<D3D12_INPUT_ELEMENT_DESC> LayoutElems;
+    D3D12_INPUT_LAYOUT_DESC    LayoutDesc;
+    std::vector<std::string>   SemanticNames; // Storage for LayoutElems[i].SemanticName
+    VertexLayout               Layout;        // LayoutElems with their offsets resolved
 
     std::vector<uint32_t>      Indices;
     uint32_t                   IndexSize;
     uint32_t                   IndexCount;
-    std::vector<DirectX::XMFLOAT4> Vertices;
-    uint32_t                       VertexCount;
-
-    // D3D resource references
-    std::vector<D3D12_VERTEX_BUFFER_VIEW>  VBViews;
-    D3D12_INDEX_BUFFER_VIEW                IBView;
-
-    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> VertexResources;
-    Microsoft::WRL::ComPtr<ID3D12Resource>              IndexResource;
+    std::vector<std::vector<uint8_t>> Vertices; // One buffer per input slot
+    std::vector<uint32_t>      VertexStrides;
+    uint32_t                   VertexCount;
 };
 
 struct Mesh
@@ -158,6 +142,8 @@ struct Mesh
     std::vector<Span<uint8_t>> Vertices;
     std::vector<uint32_t>      VertexStrides;
     uint32_t                   VertexCount;
+    uint32_t                   PositionSlot;   // Vertex buffer index holding the POSITION attribute
+    uint32_t                   PositionOffset; // Byte offset of POSITION within its vertex buffer
     DirectX::BoundingSphere    BoundingSphere;
 
     Span<Subset>               IndexSubsets;
@@ -171,18 +157,6 @@ struct Mesh
     Span<PackedTriangle>       PrimitiveIndices;
     Span<CullData>             CullingData;
 
-    // D3D resource references
-    std::vector<D3D12_VERTEX_BUFFER_VIEW>  VBViews;
-    D3D12_INDEX_BUFFER_VIEW                IBView;
-
-    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> VertexResources;
-    Microsoft::WRL::ComPtr<ID3D12Resource>              IndexResource;
-    Microsoft::WRL::ComPtr<ID3D12Resource>              MeshletResource;
-    Microsoft::WRL::ComPtr<ID3D12Resource>              UniqueVertexIndexResource;
-    Microsoft::WRL::ComPtr<ID3D12Resource>              PrimitiveIndexResource;
-    Microsoft::WRL::ComPtr<ID3D12Resource>              CullDataResource;
-    Microsoft::WRL::ComPtr<ID3D12Resource>              MeshInfoResource;
-
     // Calculates the number of instances of the last meshlet which can be packed into a single threadgroup.
     uint32_t GetLastMeshletPackCount(uint32_t subsetIndex, uint32_t maxGroupVerts, uint32_t maxGroupPrims) 
     { 
@@ -192,7 +166,7 @@ struct Mesh
         auto& subset = MeshletSubsets[subsetIndex];
         auto& meshlet = Meshlets[subset.Offset + subset.Count - 1];
 
-        return min(maxGroupVerts / meshlet.VertCount, maxGroupPrims / meshlet.PrimCount);
+        return std::min(maxGroupVerts / meshlet.VertCount, maxGroupPrims / meshlet.PrimCount);
     }
 
     void GetPrimitive(uint32_t index, uint32_t& i0, uint32_t& i1, uint32_t& i2) const
@@ -203,6 +177,25 @@ struct Mesh
         i2 = prim.i2;
     }
 
+    uint32_t GetIndex(uint32_t index) const
+    {
+        const uint8_t* addr = Indices.data() + index * IndexSize;
+        if (IndexSize == 4)
+        {
+            return *reinterpret_cast<const uint32_t*>(addr);
+        }
+        else
+        {
+            return *reinterpret_cast<const uint16_t*>(addr);
+        }
+    }
+
+    const DirectX::XMFLOAT3& GetPosition(uint32_t vertex) const
+    {
+        const uint8_t* addr = Vertices[PositionSlot].data() + vertex * VertexStrides[PositionSlot] + PositionOffset;
+        return *reinterpret_cast<const DirectX::XMFLOAT3*>(addr);
+    }
+
     uint32_t GetVertexIndex(uint32_t index) const
     {
         const uint8_t* addr = UniqueVertexIndices.data() + index * IndexSize;
@@ -217,13 +210,18 @@ struct Mesh
     }
 };
 
+// CPU-side geometry: loading, layouts and bounds, with no dependence on a device. The renderer
+// copies what it draws to the GPU; see ModelBuffers.
 class Model
 {
 public:
     HRESULT LoadFromFile(const wchar_t* filename);
     HRESULT LoadFromVtxBuffer(const std::vector<DirectX::XMFLOAT4>& positions);
-    
-    HRESULT UploadGpuResources(ID3D12Device* device, ID3D12CommandQueue* cmdQueue, ID3D12CommandAllocator* cmdAlloc, ID3D12GraphicsCommandList* cmdList);
+
+    // Copies non-indexed vertex data laid out as described by 'layout', one buffer per input slot.
+    // Per-instance elements are not supported.
+    HRESULT LoadFromVertexBuffers(const D3D12_INPUT_LAYOUT_DESC& layout, const void* const* buffers, const uint32_t* strides, uint32_t slotCount, uint32_t vertexCount);
+
 
     uint32_t GetMeshCount() const { return static_cast<uint32_t>(m_meshes.size()); }
     const Mesh& GetMesh(uint32_t i) const { return m_meshes[i]; }
@@ -0,0 +1,156 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "ModelBuffers.h"
+
+#include <cstring>
+
+namespace
+{
+    // Creates an upload buffer of 'bufferSize' bytes, the first 'size' copied from 'data' and
+    // the rest zeroed.
+    HRESULT CreateFilledUploadBuffer(RhiDevice& device, const void* data, uint64_t size, uint64_t bufferSize, std::unique_ptr<RhiBuffer>& buffer)
+    {
+        const RhiBufferDesc desc = { bufferSize, RhiHeapType::Upload, RhiBufferState::GenericRead, false };
+        HRESULT hr = device.CreateBuffer(desc, buffer);
+        if (FAILED(hr))
+            return hr;
+
+        uint8_t* mapped = static_cast<uint8_t*>(buffer->Map());
+        std::memcpy(mapped, data, static_cast<size_t>(size));
+        std::memset(mapped + size, 0, static_cast<size_t>(bufferSize - size));
+        buffer->Unmap();
+        return S_OK;
+    }
+}
+
+HRESULT ModelBuffers::Upload(const Model& model, RhiDevice& device, RhiCommandList& commandList)
+{
+    const Prim& prim = model.GetPrims();
+    const uint32_t slotCount = static_cast<uint32_t>(prim.Vertices.size());
+
+    std::vector<const uint8_t*> vertexData(slotCount);
+    std::vector<uint32_t> vertexSizes(slotCount);
+    for (uint32_t j = 0; j < slotCount; ++j)
+    {
+        vertexData[j] = prim.Vertices[j].data();
+        vertexSizes[j] = static_cast<uint32_t>(prim.Vertices[j].size());
+    }
+
+    return Upload(vertexData.data(), vertexSizes.data(), prim.VertexStrides.data(), slotCount,
+        prim.Indices.data(), prim.IndexCount * prim.IndexSize, DXGI_FORMAT_R32_UINT, device, commandList);
+}
+
+HRESULT ModelBuffers::Upload(const Mesh& mesh, RhiDevice& device, RhiCommandList& commandList)
+{
+    const uint32_t slotCount = static_cast<uint32_t>(mesh.Vertices.size());
+
+    std::vector<const uint8_t*> vertexData(slotCount);
+    std::vector<uint32_t> vertexSizes(slotCount);
+    for (uint32_t j = 0; j < slotCount; ++j)
+    {
+        vertexData[j] = mesh.Vertices[j].data();
+        vertexSizes[j] = static_cast<uint32_t>(mesh.Vertices[j].size());
+    }
+
+    return Upload(vertexData.data(), vertexSizes.data(), mesh.VertexStrides.data(), slotCount,
+        mesh.Indices.data(), mesh.IndexCount * mesh.IndexSize, mesh.IndexSize == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT,
+        device, commandList);
+}
+
+HRESULT ModelBuffers::Upload(
+    const uint8_t* const* vertexData,
+    const uint32_t* vertexSizes,
+    const uint32_t* vertexStrides,
+    uint32_t slotCount,
+    const void* indexData,
+    uint32_t indexSize,
+    DXGI_FORMAT indexFormat,
+    RhiDevice& device,
+    RhiCommandList& commandList)
+{
+    // Shaders read indices through raw views, which address whole dwords.
+    const uint64_t indexBufferSize = (uint64_t(indexSize) + 3) & ~3ull;
+
+    // Create buffers of proper sizes
+    const RhiBufferDesc indexDesc = { indexBufferSize, RhiHeapType::Default, RhiBufferState::CopyDest, false };
+    HRESULT hr = device.CreateBuffer(indexDesc, m_indexBuffer);
+    if (FAILED(hr))
+        return hr;
+
+    m_ibView.BufferLocation = m_indexBuffer->GetGpuAddress();
+    m_ibView.Format = indexFormat;
+    m_ibView.SizeInBytes = indexSize;
+
+    m_vertexBuffers.resize(slotCount);
+    m_vbViews.resize(slotCount);
+
+    for (uint32_t j = 0; j < slotCount; ++j)
+    {
+        const RhiBufferDesc vertexDesc = { vertexSizes[j], RhiHeapType::Default, RhiBufferState::CopyDest, false };
+        hr = device.CreateBuffer(vertexDesc, m_vertexBuffers[j]);
+        if (FAILED(hr))
+            return hr;
+
+        m_vbViews[j].BufferLocation = m_vertexBuffers[j]->GetGpuAddress();
+        m_vbViews[j].SizeInBytes = vertexSizes[j];
+        m_vbViews[j].StrideInBytes = vertexStrides[j];
+    }
+
+    // Create and fill the upload buffers
+    std::vector<std::unique_ptr<RhiBuffer>> vertexUploads(slotCount);
+    std::unique_ptr<RhiBuffer>              indexUpload;
+
+    hr = CreateFilledUploadBuffer(device, indexData, indexSize, indexBufferSize, indexUpload);
+    if (FAILED(hr))
+        return hr;
+
+    for (uint32_t j = 0; j < slotCount; ++j)
+    {
+        hr = CreateFilledUploadBuffer(device, vertexData[j], vertexSizes[j], vertexSizes[j], vertexUploads[j]);
+        if (FAILED(hr))
+            return hr;
+    }
+
+    // Populate our command list
+    hr = commandList.Reset();
+    if (FAILED(hr))
+        return hr;
+
+    // Vertex buffers are read by the mesh shader, not the input assembler.
+    for (uint32_t j = 0; j < slotCount; ++j)
+    {
+        commandList.CopyBuffer(m_vertexBuffers[j].get(), 0, vertexUploads[j].get(), 0, m_vertexBuffers[j]->GetSize());
+        commandList.Barrier(m_vertexBuffers[j].get(), RhiBufferState::CopyDest, RhiBufferState::ShaderResource);
+    }
+
+    commandList.CopyBuffer(m_indexBuffer.get(), 0, indexUpload.get(), 0, indexBufferSize);
+    commandList.Barrier(m_indexBuffer.get(), RhiBufferState::CopyDest, RhiBufferState::ShaderResource);
+
+    hr = commandList.Close();
+    if (FAILED(hr))
+        return hr;
+
+    RhiCommandList* commandLists[] = { &commandList };
+    device.GetQueue()->Submit(commandLists, 1);
+
+    // Wait for the copies before the upload buffers go
+    std::unique_ptr<RhiFence> fence;
+    hr = device.CreateFence(0, fence);
+    if (FAILED(hr))
+        return hr;
+
+    hr = device.GetQueue()->Signal(fence.get(), 1);
+    if (FAILED(hr))
+        return hr;
+
+    fence->Wait(1);
+    return S_OK;
+}
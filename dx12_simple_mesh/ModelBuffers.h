@@ -0,0 +1,55 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Model.h"
+#include "Rhi.h"
+
+#include <memory>
+#include <vector>
+
+// The GPU copy of a Model's prim: a default-heap buffer per vertex slot and one for the
+// indices, with views over them. Model holds only CPU data; this is where it meets a device.
+class ModelBuffers
+{
+public:
+    // Creates the buffers, records the copies on 'commandList' and waits for the device's queue
+    // to finish them. The command list must be closed; it's left closed. Vertex and index
+    // buffers are left readable by non-pixel shaders.
+    HRESULT Upload(const Model& model, RhiDevice& device, RhiCommandList& commandList);
+
+    // Uploads a mesh loaded from a file the same way, with 16- or 32-bit indices.
+    HRESULT Upload(const Mesh& mesh, RhiDevice& device, RhiCommandList& commandList);
+
+    const std::vector<D3D12_VERTEX_BUFFER_VIEW>& GetVertexBufferViews() const { return m_vbViews; }
+    const D3D12_INDEX_BUFFER_VIEW& GetIndexBufferView() const { return m_ibView; }
+
+    const std::vector<std::unique_ptr<RhiBuffer>>& GetVertexBuffers() const { return m_vertexBuffers; }
+    RhiBuffer* GetIndexBuffer() const { return m_indexBuffer.get(); }
+
+private:
+    HRESULT Upload(
+        const uint8_t* const* vertexData,
+        const uint32_t* vertexSizes,
+        const uint32_t* vertexStrides,
+        uint32_t slotCount,
+        const void* indexData,
+        uint32_t indexSize,
+        DXGI_FORMAT indexFormat,
+        RhiDevice& device,
+        RhiCommandList& commandList);
+
+    std::vector<D3D12_VERTEX_BUFFER_VIEW>   m_vbViews;
+    D3D12_INDEX_BUFFER_VIEW                 m_ibView;
+
+    std::vector<std::unique_ptr<RhiBuffer>> m_vertexBuffers;
+    std::unique_ptr<RhiBuffer>              m_indexBuffer;
+};
@@ -0,0 +1,430 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "NullRhi.h"
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+namespace
+{
+    // Buffers are placed like committed resources, each on its own 64KB boundary.
+    const uint64_t c_firstGpuAddress = 0x100000000ull;
+    const uint64_t c_bufferAlignment = 64 * 1024;
+}
+
+class NullRhiDevice::Buffer : public RhiBuffer
+{
+public:
+    Buffer(NullRhiDevice* device, uint32_t id, const RhiBufferDesc& desc, uint64_t gpuAddress)
+        : m_device(device)
+        , m_id(id)
+        , m_heap(desc.Heap)
+        , m_gpuAddress(gpuAddress)
+        , m_data(static_cast<size_t>(desc.Size))
+    { }
+
+    ~Buffer()
+    {
+        m_device->m_buffers[m_id - 1] = nullptr;
+    }
+
+    uint64_t GetSize() const override { return m_data.size(); }
+    uint64_t GetGpuAddress() const override { return m_gpuAddress; }
+
+    void* Map() override
+    {
+        if (m_heap == RhiHeapType::Default)
+            throw std::logic_error("Default heap buffers can't be mapped.");
+
+        return m_data.data();
+    }
+
+    void Unmap() override { }
+
+    uint32_t GetId() const { return m_id; }
+    uint8_t* GetData() { return m_data.data(); }
+
+private:
+    NullRhiDevice*       m_device;
+    uint32_t             m_id;
+    RhiHeapType::EType   m_heap;
+    uint64_t             m_gpuAddress;
+    std::vector<uint8_t> m_data;
+};
+
+class NullRhiDevice::DescriptorHeap : public RhiDescriptorHeap
+{
+public:
+    DescriptorHeap(NullRhiDevice* device, uint32_t id, uint32_t descriptorCount)
+        : m_device(device)
+        , m_id(id)
+        , m_descriptorCount(descriptorCount)
+    { }
+
+    uint32_t GetDescriptorCount() const override { return m_descriptorCount; }
+
+    void CreateRawBufferView(uint32_t index, RhiBuffer* buffer, uint64_t firstDword, uint32_t dwordCount) override
+    {
+        if (index >= m_descriptorCount)
+            throw std::out_of_range("Descriptor index past the end of the heap.");
+
+        uint32_t bufferId = 0;
+        if (buffer != nullptr)
+        {
+            if ((firstDword + dwordCount) * 4 > buffer->GetSize())
+                throw std::out_of_range("View past the end of the buffer.");
+
+            bufferId = static_cast<Buffer*>(buffer)->GetId();
+        }
+
+        m_device->Log(NullRhiEvent::CreateView, m_id, index, bufferId, firstDword, dwordCount);
+    }
+
+    uint32_t GetId() const { return m_id; }
+
+private:
+    NullRhiDevice* m_device;
+    uint32_t       m_id;
+    uint32_t       m_descriptorCount;
+};
+
+class NullRhiDevice::CommandList : public RhiCommandList
+{
+public:
+    explicit CommandList(uint32_t id)
+        : m_id(id)
+        , m_open(false)
+    { }
+
+    HRESULT Reset() override
+    {
+        if (m_open)
+            return E_FAIL;
+
+        m_commands.clear();
+        m_constants.clear();
+        m_open = true;
+        return S_OK;
+    }
+
+    HRESULT Close() override
+    {
+        if (!m_open)
+            return E_FAIL;
+
+        m_open = false;
+        return S_OK;
+    }
+
+    void CopyBuffer(RhiBuffer* dest, uint64_t destOffset, RhiBuffer* source, uint64_t sourceOffset, uint64_t size) override
+    {
+        if (destOffset + size > dest->GetSize() || sourceOffset + size > source->GetSize())
+            throw std::out_of_range("Copy past the end of a buffer.");
+
+        Record(NullRhiEvent::Copy, IdOf(dest), destOffset, IdOf(source), sourceOffset, size);
+    }
+
+    void Barrier(RhiBuffer* buffer, RhiBufferState::EType before, RhiBufferState::EType after) override
+    {
+        Record(NullRhiEvent::Barrier, IdOf(buffer), before, after);
+    }
+
+    void SetDescriptorHeap(RhiDescriptorHeap* heap) override
+    {
+        Record(NullRhiEvent::SetDescriptorHeap, static_cast<DescriptorHeap*>(heap)->GetId());
+    }
+
+    void SetGraphicsRootDescriptorTable(uint32_t rootIndex, RhiDescriptorHeap* heap, uint32_t firstDescriptor) override
+    {
+        Record(NullRhiEvent::SetDescriptorTable, static_cast<DescriptorHeap*>(heap)->GetId(), rootIndex, firstDescriptor);
+    }
+
+    void SetGraphicsRoot32BitConstants(uint32_t rootIndex, uint32_t count, const void* data, uint32_t firstConstant) override
+    {
+        const uint32_t* values = static_cast<const uint32_t*>(data);
+        Record(NullRhiEvent::SetConstants, 0, rootIndex, firstConstant, count, m_constants.size());
+        m_constants.insert(m_constants.end(), values, values + count);
+    }
+
+    void SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t gpuAddress) override
+    {
+        Record(NullRhiEvent::SetConstantBuffer, 0, rootIndex, gpuAddress);
+    }
+
+    void DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override
+    {
+        Record(NullRhiEvent::DispatchMesh, 0, groupCountX, groupCountY, groupCountZ);
+    }
+
+    uint32_t GetId() const { return m_id; }
+    bool IsOpen() const { return m_open; }
+    const std::vector<NullRhiEvent>& GetCommands() const { return m_commands; }
+    const std::vector<uint32_t>& GetConstants() const { return m_constants; }
+
+private:
+    static uint32_t IdOf(RhiBuffer* buffer)
+    {
+        return static_cast<Buffer*>(buffer)->GetId();
+    }
+
+    void Record(NullRhiEvent::EType type, uint32_t object, uint64_t arg0 = 0, uint64_t arg1 = 0, uint64_t arg2 = 0, uint64_t arg3 = 0)
+    {
+        if (!m_open)
+            throw std::logic_error("Recording into a closed command list.");
+
+        m_commands.push_back({ type, object, { arg0, arg1, arg2, arg3 } });
+    }
+
+    uint32_t                  m_id;
+    bool                      m_open;
+    std::vector<NullRhiEvent> m_commands;
+    std::vector<uint32_t>     m_constants;
+};
+
+class NullRhiDevice::Fence : public RhiFence
+{
+public:
+    Fence(NullRhiDevice* device, uint32_t id)
+        : m_device(device)
+        , m_id(id)
+    { }
+
+    uint64_t GetCompletedValue() override { return m_device->m_fenceValues[m_id - 1]; }
+    void Wait(uint64_t value) override { m_device->WaitForFence(m_id, value); }
+
+    uint32_t GetId() const { return m_id; }
+
+private:
+    NullRhiDevice* m_device;
+    uint32_t       m_id;
+};
+
+NullRhiDevice::NullRhiDevice(uint32_t latency)
+    : m_latency(latency)
+    , m_nextGpuAddress(c_firstGpuAddress)
+    , m_heapCount(0)
+    , m_commandListCount(0)
+    , m_dispatchCount(0)
+{ }
+
+NullRhiDevice::~NullRhiDevice()
+{ }
+
+HRESULT NullRhiDevice::CreateBuffer(const RhiBufferDesc& desc, std::unique_ptr<RhiBuffer>& buffer)
+{
+    if (desc.Size == 0)
+        return E_INVALIDARG;
+
+    const uint32_t id = static_cast<uint32_t>(m_buffers.size() + 1);
+    std::unique_ptr<Buffer> created(new Buffer(this, id, desc, m_nextGpuAddress));
+
+    m_buffers.push_back(created.get());
+    m_nextGpuAddress += (desc.Size + c_bufferAlignment - 1) & ~(c_bufferAlignment - 1);
+
+    Log(NullRhiEvent::CreateBuffer, id, desc.Size, desc.Heap, desc.InitialState);
+
+    buffer = std::move(created);
+    return S_OK;
+}
+
+HRESULT NullRhiDevice::CreateDescriptorHeap(uint32_t descriptorCount, std::unique_ptr<RhiDescriptorHeap>& heap)
+{
+    const uint32_t id = ++m_heapCount;
+    heap.reset(new DescriptorHeap(this, id, descriptorCount));
+
+    Log(NullRhiEvent::CreateDescriptorHeap, id, descriptorCount);
+    return S_OK;
+}
+
+HRESULT NullRhiDevice::CreateCommandList(std::unique_ptr<RhiCommandList>& commandList)
+{
+    commandList.reset(new CommandList(++m_commandListCount));
+    return S_OK;
+}
+
+HRESULT NullRhiDevice::CreateFence(uint64_t initialValue, std::unique_ptr<RhiFence>& fence)
+{
+    m_fenceValues.push_back(initialValue);
+    fence.reset(new Fence(this, static_cast<uint32_t>(m_fenceValues.size())));
+    return S_OK;
+}
+
+void NullRhiDevice::ClearLog()
+{
+    m_log.clear();
+    m_constants.clear();
+}
+
+void NullRhiDevice::Submit(RhiCommandList* const* commandLists, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const CommandList& list = *static_cast<const CommandList*>(commandLists[i]);
+        if (list.IsOpen())
+            throw std::logic_error("Submitting a command list that wasn't closed.");
+
+        Log(NullRhiEvent::Submit, list.GetId());
+
+        // Constants are rebased onto the device's copy of them.
+        const uint64_t constantBase = m_constants.size();
+        m_constants.insert(m_constants.end(), list.GetConstants().begin(), list.GetConstants().end());
+
+        for (NullRhiEvent command : list.GetCommands())
+        {
+            switch (command.Type)
+            {
+            case NullRhiEvent::Copy:
+            {
+                Buffer* dest = m_buffers[command.Object - 1];
+                Buffer* source = m_buffers[command.Args[1] - 1];
+                if (dest == nullptr || source == nullptr)
+                    throw std::logic_error("Copy between destroyed buffers.");
+
+                memmove(dest->GetData() + command.Args[0], source->GetData() + command.Args[2], static_cast<size_t>(command.Args[3]));
+                break;
+            }
+
+            case NullRhiEvent::SetConstants:
+                command.Args[3] += constantBase;
+                break;
+
+            case NullRhiEvent::DispatchMesh:
+                ++m_dispatchCount;
+                break;
+
+            default:
+                break;
+            }
+
+            m_log.push_back(command);
+        }
+    }
+}
+
+HRESULT NullRhiDevice::Signal(RhiFence* fence, uint64_t value)
+{
+    const uint32_t id = static_cast<Fence*>(fence)->GetId();
+    Log(NullRhiEvent::Signal, id, value);
+
+    m_pendingSignals.push_back({ id, value });
+    while (m_pendingSignals.size() > m_latency)
+    {
+        CompleteOldestSignal();
+    }
+
+    return S_OK;
+}
+
+void NullRhiDevice::Log(NullRhiEvent::EType type, uint32_t object, uint64_t arg0, uint64_t arg1, uint64_t arg2, uint64_t arg3)
+{
+    m_log.push_back({ type, object, { arg0, arg1, arg2, arg3 } });
+}
+
+void NullRhiDevice::CompleteOldestSignal()
+{
+    const PendingSignal signal = m_pendingSignals.front();
+    m_pendingSignals.pop_front();
+
+    m_fenceValues[signal.Fence - 1] = signal.Value;
+    Log(NullRhiEvent::Complete, signal.Fence, signal.Value);
+}
+
+void NullRhiDevice::WaitForFence(uint32_t fence, uint64_t value)
+{
+    const bool stalled = m_fenceValues[fence - 1] < value;
+    Log(NullRhiEvent::Wait, fence, value, stalled ? 1 : 0);
+
+    while (m_fenceValues[fence - 1] < value)
+    {
+        // A real GPU would never get there.
+        if (m_pendingSignals.empty())
+            throw std::logic_error("Waiting for a fence value that was never signaled.");
+
+        CompleteOldestSignal();
+    }
+}
+
+void NullRhiDevice::WriteLog(std::ostream& stream) const
+{
+    for (const NullRhiEvent& event : m_log)
+    {
+        stream << GetNullRhiEventName(event.Type);
+        if (event.Object != 0)
+        {
+            stream << " #" << event.Object;
+        }
+
+        switch (event.Type)
+        {
+        case NullRhiEvent::SetDescriptorHeap:
+        case NullRhiEvent::Submit:
+            break;
+
+        case NullRhiEvent::CreateDescriptorHeap:
+        case NullRhiEvent::Signal:
+        case NullRhiEvent::Complete:
+            stream << ' ' << event.Args[0];
+            break;
+
+        case NullRhiEvent::Barrier:
+        case NullRhiEvent::SetDescriptorTable:
+        case NullRhiEvent::Wait:
+            stream << ' ' << event.Args[0] << ' ' << event.Args[1];
+            break;
+
+        case NullRhiEvent::SetConstantBuffer:
+            stream << ' ' << event.Args[0] << " 0x" << std::hex << event.Args[1] << std::dec;
+            break;
+
+        case NullRhiEvent::CreateBuffer:
+        case NullRhiEvent::DispatchMesh:
+            stream << ' ' << event.Args[0] << ' ' << event.Args[1] << ' ' << event.Args[2];
+            break;
+
+        case NullRhiEvent::SetConstants:
+            stream << ' ' << event.Args[0] << ' ' << event.Args[1] << ' ' << event.Args[2] << " :";
+            for (uint64_t i = 0; i < event.Args[2]; ++i)
+            {
+                stream << ' ' << m_constants[static_cast<size_t>(event.Args[3] + i)];
+            }
+            break;
+
+        default:
+            stream << ' ' << event.Args[0] << ' ' << event.Args[1] << ' ' << event.Args[2] << ' ' << event.Args[3];
+            break;
+        }
+
+        stream << '\n';
+    }
+}
+
+const char* GetNullRhiEventName(NullRhiEvent::EType type)
+{
+    switch (type)
+    {
+    case NullRhiEvent::CreateBuffer:         return "CreateBuffer";
+    case NullRhiEvent::CreateDescriptorHeap: return "CreateDescriptorHeap";
+    case NullRhiEvent::CreateView:           return "CreateView";
+    case NullRhiEvent::Submit:               return "Submit";
+    case NullRhiEvent::Copy:                 return "Copy";
+    case NullRhiEvent::Barrier:              return "Barrier";
+    case NullRhiEvent::SetDescriptorHeap:    return "SetDescriptorHeap";
+    case NullRhiEvent::SetDescriptorTable:   return "SetDescriptorTable";
+    case NullRhiEvent::SetConstants:         return "SetConstants";
+    case NullRhiEvent::SetConstantBuffer:    return "SetConstantBuffer";
+    case NullRhiEvent::DispatchMesh:         return "DispatchMesh";
+    case NullRhiEvent::Signal:               return "Signal";
+    case NullRhiEvent::Complete:             return "Complete";
+    case NullRhiEvent::Wait:                 return "Wait";
+    default:                                 return "Unknown";
+    }
+}
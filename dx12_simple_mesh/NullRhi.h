@@ -0,0 +1,108 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Rhi.h"
+
+#include <deque>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// One entry of a NullRhiDevice's log. Objects are numbered from 1 in order of creation, per
+// kind; 0 stands for none.
+struct NullRhiEvent
+{
+    enum EType : uint32_t
+    {
+        CreateBuffer,         // Object: buffer. Args: size, heap type, initial state
+        CreateDescriptorHeap, // Object: heap. Args: descriptor count
+        CreateView,           // Object: heap. Args: descriptor index, buffer, first dword, dword count
+        Submit,               // Object: command list. Followed by the commands it recorded
+        Copy,                 // Object: destination buffer. Args: destination offset, source buffer, source offset, size
+        Barrier,              // Object: buffer. Args: state before, state after
+        SetDescriptorHeap,    // Object: heap
+        SetDescriptorTable,   // Object: heap. Args: root index, first descriptor
+        SetConstants,         // Args: root index, first constant, count, offset of the values in GetConstants()
+        SetConstantBuffer,    // Args: root index, GPU address
+        DispatchMesh,         // Args: group counts
+        Signal,               // Object: fence. Args: value
+        Complete,             // Object: fence. Args: value; the simulated GPU got this far
+        Wait,                 // Object: fence. Args: value, 1 if the fence hadn't reached it yet
+    };
+
+    EType    Type;
+    uint32_t Object;
+    uint64_t Args[4];
+};
+
+// A device that runs nothing. It keeps a log of the objects created and every command
+// submitted, with resource sizes, views and barriers, so command streams can be measured and
+// compared without a GPU. Copies between buffers do happen, at submission, so data uploaded
+// through default-heap buffers can be read back by tests.
+//
+// Fences advance as if the GPU ran 'latency' signals behind the queue: a signal completes
+// once 'latency' more have been issued after it. Waiting on a fence completes the signals
+// queued ahead of the value at once, as a stalled CPU would see them.
+class NullRhiDevice : public RhiDevice, private RhiQueue
+{
+public:
+    explicit NullRhiDevice(uint32_t latency = 2);
+    ~NullRhiDevice();
+
+    HRESULT CreateBuffer(const RhiBufferDesc& desc, std::unique_ptr<RhiBuffer>& buffer) override;
+    HRESULT CreateDescriptorHeap(uint32_t descriptorCount, std::unique_ptr<RhiDescriptorHeap>& heap) override;
+    HRESULT CreateCommandList(std::unique_ptr<RhiCommandList>& commandList) override;
+    HRESULT CreateFence(uint64_t initialValue, std::unique_ptr<RhiFence>& fence) override;
+
+    RhiQueue* GetQueue() override { return this; }
+
+    const std::vector<NullRhiEvent>& GetLog() const { return m_log; }
+    const std::vector<uint32_t>& GetConstants() const { return m_constants; }
+    void ClearLog();
+
+    // One event per line, for diffing against a known good stream.
+    void WriteLog(std::ostream& stream) const;
+
+    uint64_t GetSubmittedDispatchCount() const { return m_dispatchCount; }
+
+private:
+    class Buffer;
+    class DescriptorHeap;
+    class CommandList;
+    class Fence;
+
+    struct PendingSignal
+    {
+        uint32_t Fence;
+        uint64_t Value;
+    };
+
+    void Submit(RhiCommandList* const* commandLists, uint32_t count) override;
+    HRESULT Signal(RhiFence* fence, uint64_t value) override;
+
+    void Log(NullRhiEvent::EType type, uint32_t object, uint64_t arg0 = 0, uint64_t arg1 = 0, uint64_t arg2 = 0, uint64_t arg3 = 0);
+    void CompleteOldestSignal();
+    void WaitForFence(uint32_t fence, uint64_t value);
+
+    uint32_t                  m_latency;
+    std::vector<NullRhiEvent> m_log;
+    std::vector<uint32_t>     m_constants;        // Root constants set by logged commands
+    std::vector<Buffer*>      m_buffers;          // By ID - 1; null once destroyed
+    std::vector<uint64_t>     m_fenceValues;      // Completed value, by fence ID - 1
+    std::deque<PendingSignal> m_pendingSignals;
+    uint64_t                  m_nextGpuAddress;
+    uint32_t                  m_heapCount;
+    uint32_t                  m_commandListCount;
+    uint64_t                  m_dispatchCount;
+};
+
+const char* GetNullRhiEventName(NullRhiEvent::EType type);
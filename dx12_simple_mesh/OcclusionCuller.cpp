@@ -0,0 +1,437 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "OcclusionCuller.h"
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OCCLUSION_CULLER_SSE 1
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // Vertices closer than this in w are treated as crossing the near plane.
+    const float c_minW = 1e-5f;
+
+    XMFLOAT2 ToScreen(float x, float y, float w, float width, float height)
+    {
+        const float invW = 1.0f / w;
+        return XMFLOAT2(
+            (x * invW * 0.5f + 0.5f) * width,
+            (0.5f - y * invW * 0.5f) * height);
+    }
+
+    void TransformSphere(const XMFLOAT3& center, float radius, const XMFLOAT4X4& world, XMFLOAT3& outCenter, float& outRadius)
+    {
+        const XMMATRIX m = XMLoadFloat4x4(&world);
+        XMStoreFloat3(&outCenter, XMVector3Transform(XMLoadFloat3(&center), m));
+
+        const float sx = XMVectorGetX(XMVector3Length(m.r[0]));
+        const float sy = XMVectorGetX(XMVector3Length(m.r[1]));
+        const float sz = XMVectorGetX(XMVector3Length(m.r[2]));
+
+        outRadius = radius * std::max(sx, std::max(sy, sz));
+    }
+}
+
+OcclusionCuller::OcclusionCuller()
+    : m_width(0)
+    , m_height(0)
+    , m_tilesX(0)
+    , m_tilesY(0)
+{
+    XMStoreFloat4x4(&m_viewProj, XMMatrixIdentity());
+}
+
+void OcclusionCuller::Init(uint32_t width, uint32_t height)
+{
+    m_tilesX = (width + TileSize - 1) / TileSize;
+    m_tilesY = (height + TileSize - 1) / TileSize;
+    m_width = m_tilesX * TileSize;
+    m_height = m_tilesY * TileSize;
+
+    m_depth.assign(m_width * m_height, 1.0f);
+    m_tileMaxDepth.assign(m_tilesX * m_tilesY, 1.0f);
+    m_tileBins.resize(m_tilesX * m_tilesY);
+}
+
+void OcclusionCuller::SetViewProjection(const XMFLOAT4X4& viewProj)
+{
+    m_viewProj = viewProj;
+}
+
+void OcclusionCuller::ClearOccluders()
+{
+    m_occluders.clear();
+}
+
+void OcclusionCuller::AddOccluder(const Mesh& mesh, const XMFLOAT4X4& world)
+{
+    Occluder occluder;
+    occluder.World = world;
+
+    occluder.Positions.resize(mesh.VertexCount);
+    for (uint32_t i = 0; i < mesh.VertexCount; ++i)
+    {
+        occluder.Positions[i] = mesh.GetPosition(i);
+    }
+
+    occluder.Indices.resize(mesh.IndexCount);
+    for (uint32_t i = 0; i < mesh.IndexCount; ++i)
+    {
+        occluder.Indices[i] = mesh.GetIndex(i);
+    }
+
+    m_occluders.push_back(std::move(occluder));
+}
+
+void OcclusionCuller::AddOccluder(const XMFLOAT3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const XMFLOAT4X4& world)
+{
+    Occluder occluder;
+    occluder.World = world;
+    occluder.Positions.assign(positions, positions + vertexCount);
+    occluder.Indices.assign(indices, indices + indexCount);
+
+    m_occluders.push_back(std::move(occluder));
+}
+
+void OcclusionCuller::SetupTriangles(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const
+{
+    const XMMATRIX worldViewProj = XMMatrixMultiply(XMLoadFloat4x4(&occluder.World), XMLoadFloat4x4(&m_viewProj));
+
+    std::vector<XMFLOAT4> clip(occluder.Positions.size());
+    for (size_t i = 0; i < occluder.Positions.size(); ++i)
+    {
+        XMStoreFloat4(&clip[i], XMVector3Transform(XMLoadFloat3(&occluder.Positions[i]), worldViewProj));
+    }
+
+    const float width = static_cast<float>(m_width);
+    const float height = static_cast<float>(m_height);
+
+    for (size_t i = 0; i + 2 < occluder.Indices.size(); i += 3)
+    {
+        const XMFLOAT4& c0 = clip[occluder.Indices[i + 0]];
+        const XMFLOAT4& c1 = clip[occluder.Indices[i + 1]];
+        const XMFLOAT4& c2 = clip[occluder.Indices[i + 2]];
+
+        // Occluders that cross the near plane are simply dropped; skipping an occluder is always conservative.
+        if (c0.w < c_minW || c1.w < c_minW || c2.w < c_minW)
+            continue;
+
+        const float z0 = c0.z / c0.w;
+        const float z1 = c1.z / c1.w;
+        const float z2 = c2.z / c2.w;
+
+        if (z0 < 0.0f || z1 < 0.0f || z2 < 0.0f)
+            continue;
+
+        const XMFLOAT2 s0 = ToScreen(c0.x, c0.y, c0.w, width, height);
+        const XMFLOAT2 s1 = ToScreen(c1.x, c1.y, c1.w, width, height);
+        const XMFLOAT2 s2 = ToScreen(c2.x, c2.y, c2.w, width, height);
+
+        // Clockwise (front facing) triangles have positive area in y-down screen space.
+        const float area = (s1.x - s0.x) * (s2.y - s0.y) - (s2.x - s0.x) * (s1.y - s0.y);
+        if (!(area > 0.0f))
+            continue;
+
+        // Only pixels the triangle covers entirely are written (see below), and every one of
+        // those has its center inside, so the center-sampled bounds hold them all.
+        const float minX = std::min(s0.x, std::min(s1.x, s2.x));
+        const float minY = std::min(s0.y, std::min(s1.y, s2.y));
+        const float maxX = std::max(s0.x, std::max(s1.x, s2.x));
+        const float maxY = std::max(s0.y, std::max(s1.y, s2.y));
+
+        ScreenTriangle tri;
+        tri.MinX = std::max(0, static_cast<int32_t>(std::ceil(minX - 0.5f)));
+        tri.MinY = std::max(0, static_cast<int32_t>(std::ceil(minY - 0.5f)));
+        tri.MaxX = std::min(static_cast<int32_t>(m_width) - 1, static_cast<int32_t>(std::floor(maxX - 0.5f)));
+        tri.MaxY = std::min(static_cast<int32_t>(m_height) - 1, static_cast<int32_t>(std::floor(maxY - 0.5f)));
+
+        if (tri.MinX > tri.MaxX || tri.MinY > tri.MaxY)
+            continue;
+
+        // Edge functions are positive inside. The constant term is biased by half a pixel so
+        // that evaluating at integer pixel coordinates samples the pixel center, then pulled in
+        // by the most the edge function drops from a pixel's center to its farthest corner. An
+        // edge passes only when the whole pixel is on its inner side, so a pixel the occluder
+        // covers partially is left alone and can't hide what shows through the rest of it.
+        const XMFLOAT2 v[3] = { s0, s1, s2 };
+        for (uint32_t e = 0; e < 3; ++e)
+        {
+            const XMFLOAT2& a = v[e];
+            const XMFLOAT2& b = v[(e + 1) % 3];
+
+            tri.EdgeA[e] = a.y - b.y;
+            tri.EdgeB[e] = b.x - a.x;
+            tri.EdgeC[e] = a.x * b.y - a.y * b.x + 0.5f * (tri.EdgeA[e] + tri.EdgeB[e])
+                - 0.5f * (std::fabs(tri.EdgeA[e]) + std::fabs(tri.EdgeB[e]));
+        }
+
+        // Depth plane, biased to give the farthest depth the triangle reaches within each pixel
+        // so that the stored depth never lies in front of the real occluder surface.
+        const float invArea = 1.0f / area;
+        tri.DzDx = ((z1 - z0) * (s2.y - s0.y) - (z2 - z0) * (s1.y - s0.y)) * invArea;
+        tri.DzDy = ((s1.x - s0.x) * (z2 - z0) - (s2.x - s0.x) * (z1 - z0)) * invArea;
+        tri.Z0 = z0 - tri.DzDx * s0.x - tri.DzDy * s0.y + std::max(tri.DzDx, 0.0f) + std::max(tri.DzDy, 0.0f);
+        tri.ZMax = std::max(z0, std::max(z1, z2));
+
+        triangles.push_back(tri);
+    }
+}
+
+void OcclusionCuller::RenderOccluders(uint32_t threadCount)
+{
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+    std::fill(m_tileMaxDepth.begin(), m_tileMaxDepth.end(), 1.0f);
+
+    // Transform & set up occluder triangles in parallel, one occluder per work item.
+    std::vector<std::vector<ScreenTriangle>> perOccluder(m_occluders.size());
+    ParallelFor(static_cast<uint32_t>(m_occluders.size()), [&](uint32_t i, uint32_t)
+    {
+        SetupTriangles(m_occluders[i], perOccluder[i]);
+    }, threadCount);
+
+    m_triangles.clear();
+    for (auto& tris : perOccluder)
+    {
+        m_triangles.insert(m_triangles.end(), tris.begin(), tris.end());
+    }
+
+    // Bin triangles into every tile their pixel bounds overlap.
+    for (auto& bin : m_tileBins)
+    {
+        bin.clear();
+    }
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_triangles.size()); ++i)
+    {
+        const ScreenTriangle& tri = m_triangles[i];
+
+        for (int32_t ty = tri.MinY / TileSize; ty <= tri.MaxY / static_cast<int32_t>(TileSize); ++ty)
+        {
+            for (int32_t tx = tri.MinX / TileSize; tx <= tri.MaxX / static_cast<int32_t>(TileSize); ++tx)
+            {
+                m_tileBins[ty * m_tilesX + tx].push_back(i);
+            }
+        }
+    }
+
+    ParallelFor(m_tilesX * m_tilesY, [&](uint32_t tile, uint32_t)
+    {
+        RasterizeTile(tile);
+    }, threadCount);
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tileIndex)
+{
+    const int32_t tileX = static_cast<int32_t>((tileIndex % m_tilesX) * TileSize);
+    const int32_t tileY = static_cast<int32_t>((tileIndex / m_tilesX) * TileSize);
+
+    for (uint32_t triIndex : m_tileBins[tileIndex])
+    {
+        const ScreenTriangle& tri = m_triangles[triIndex];
+
+        // Start on a 4-pixel boundary; lanes outside the triangle fail the coverage test on their own.
+        const int32_t minX = std::max(tri.MinX, tileX) & ~3;
+        const int32_t maxX = std::min(tri.MaxX, tileX + static_cast<int32_t>(TileSize) - 1);
+        const int32_t minY = std::max(tri.MinY, tileY);
+        const int32_t maxY = std::min(tri.MaxY, tileY + static_cast<int32_t>(TileSize) - 1);
+
+#if OCCLUSION_CULLER_SSE
+        const __m128 laneOffsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 zMax = _mm_set1_ps(tri.ZMax);
+
+        for (int32_t y = minY; y <= maxY; ++y)
+        {
+            float* row = m_depth.data() + y * m_width;
+            const __m128 py = _mm_set1_ps(static_cast<float>(y));
+
+            for (int32_t x = minX; x <= maxX; x += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+
+                __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (uint32_t e = 0; e < 3; ++e)
+                {
+                    const __m128 edge = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(tri.EdgeA[e])), _mm_mul_ps(py, _mm_set1_ps(tri.EdgeB[e]))),
+                        _mm_set1_ps(tri.EdgeC[e]));
+                    mask = _mm_and_ps(mask, _mm_cmpge_ps(edge, zero));
+                }
+
+                if (_mm_movemask_ps(mask) == 0)
+                    continue;
+
+                __m128 z = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(tri.DzDx)), _mm_mul_ps(py, _mm_set1_ps(tri.DzDy))),
+                    _mm_set1_ps(tri.Z0));
+                z = _mm_min_ps(z, zMax);
+
+                const __m128 depth = _mm_loadu_ps(row + x);
+                const __m128 merged = _mm_min_ps(depth, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, merged), _mm_andnot_ps(mask, depth)));
+            }
+        }
+#else
+        for (int32_t y = minY; y <= maxY; ++y)
+        {
+            float* row = m_depth.data() + y * m_width;
+
+            for (int32_t x = minX; x <= maxX; ++x)
+            {
+                bool covered = true;
+                for (uint32_t e = 0; e < 3; ++e)
+                {
+                    covered &= (tri.EdgeA[e] * x + tri.EdgeB[e] * y + tri.EdgeC[e]) >= 0.0f;
+                }
+
+                if (covered)
+                {
+                    const float z = std::min(tri.DzDx * x + tri.DzDy * y + tri.Z0, tri.ZMax);
+                    row[x] = std::min(row[x], z);
+                }
+            }
+        }
+#endif
+    }
+
+    // Update the hierarchical depth for this tile.
+    float tileMax = 0.0f;
+    for (uint32_t y = 0; y < TileSize; ++y)
+    {
+        const float* row = m_depth.data() + (tileY + y) * m_width + tileX;
+        tileMax = std::max(tileMax, *std::max_element(row, row + TileSize));
+    }
+    m_tileMaxDepth[tileIndex] = tileMax;
+}
+
+bool OcclusionCuller::IsRectOccluded(int32_t minX, int32_t minY, int32_t maxX, int32_t maxY, float nearestDepth) const
+{
+    for (int32_t ty = minY / TileSize; ty <= maxY / static_cast<int32_t>(TileSize); ++ty)
+    {
+        for (int32_t tx = minX / TileSize; tx <= maxX / static_cast<int32_t>(TileSize); ++tx)
+        {
+            // Whole tile is nearer than the query - nothing in it can be visible.
+            if (m_tileMaxDepth[ty * m_tilesX + tx] < nearestDepth)
+                continue;
+
+            const int32_t x0 = std::max(minX, tx * static_cast<int32_t>(TileSize));
+            const int32_t x1 = std::min(maxX, (tx + 1) * static_cast<int32_t>(TileSize) - 1);
+            const int32_t y0 = std::max(minY, ty * static_cast<int32_t>(TileSize));
+            const int32_t y1 = std::min(maxY, (ty + 1) * static_cast<int32_t>(TileSize) - 1);
+
+            for (int32_t y = y0; y <= y1; ++y)
+            {
+                const float* row = m_depth.data() + y * m_width;
+                for (int32_t x = x0; x <= x1; ++x)
+                {
+                    if (row[x] >= nearestDepth)
+                        return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool OcclusionCuller::IsSphereVisible(const XMFLOAT3& center, float radius) const
+{
+    const XMMATRIX viewProj = XMLoadFloat4x4(&m_viewProj);
+
+    const float width = static_cast<float>(m_width);
+    const float height = static_cast<float>(m_height);
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float nearestDepth = FLT_MAX;
+
+    // Project the corners of the sphere's bounding box. The nearest corner bounds the
+    // nearest depth on the sphere and the corners' screen extents bound its footprint.
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        const XMFLOAT3 corner(
+            center.x + ((i & 1) ? radius : -radius),
+            center.y + ((i & 2) ? radius : -radius),
+            center.z + ((i & 4) ? radius : -radius));
+
+        XMFLOAT4 clip;
+        XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), viewProj));
+
+        if (clip.w < c_minW)
+            return true; // Intersects the near plane; can't be occluded reliably.
+
+        const XMFLOAT2 s = ToScreen(clip.x, clip.y, clip.w, width, height);
+        minX = std::min(minX, s.x);
+        minY = std::min(minY, s.y);
+        maxX = std::max(maxX, s.x);
+        maxY = std::max(maxY, s.y);
+        nearestDepth = std::min(nearestDepth, clip.z / clip.w);
+    }
+
+    if (nearestDepth < 0.0f)
+        return true;
+
+    if (nearestDepth > 1.0f || maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+        return false; // Outside the view frustum.
+
+    const int32_t x0 = std::max(0, static_cast<int32_t>(std::floor(minX)));
+    const int32_t y0 = std::max(0, static_cast<int32_t>(std::floor(minY)));
+    const int32_t x1 = std::min(static_cast<int32_t>(m_width) - 1, std::max(x0, static_cast<int32_t>(std::ceil(maxX)) - 1));
+    const int32_t y1 = std::min(static_cast<int32_t>(m_height) - 1, std::max(y0, static_cast<int32_t>(std::ceil(maxY)) - 1));
+
+    return !IsRectOccluded(x0, y0, x1, y1, nearestDepth);
+}
+
+bool OcclusionCuller::IsSphereVisible(const BoundingSphere& sphere, const XMFLOAT4X4& world) const
+{
+    XMFLOAT3 center;
+    float radius;
+    TransformSphere(sphere.Center, sphere.Radius, world, center, radius);
+
+    return IsSphereVisible(center, radius);
+}
+
+void OcclusionCuller::CullMeshes(const Model& model, const XMFLOAT4X4& world, std::vector<uint32_t>& visible) const
+{
+    for (uint32_t i = 0; i < model.GetMeshCount(); ++i)
+    {
+        if (IsSphereVisible(model.GetMesh(i).BoundingSphere, world))
+        {
+            visible.push_back(i);
+        }
+    }
+}
+
+void OcclusionCuller::CullMeshlets(const Mesh& mesh, const XMFLOAT4X4& world, std::vector<uint32_t>& visible) const
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(mesh.CullingData.size()); ++i)
+    {
+        const XMFLOAT4& bounds = mesh.CullingData[i].BoundingSphere;
+
+        XMFLOAT3 center;
+        float radius;
+        TransformSphere(XMFLOAT3(bounds.x, bounds.y, bounds.z), bounds.w, world, center, radius);
+
+        if (IsSphereVisible(center, radius))
+        {
+            visible.push_back(i);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Model.h"
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <vector>
+
+// Low-resolution CPU depth rasterizer used to reject meshes and meshlets that are
+// hidden behind a set of designated occluders.
+//
+// Occluders are rasterized conservatively in both coverage and depth: a triangle writes
+// only the pixels it covers entirely, and each receives the farthest depth the triangle
+// reaches within that pixel, so no pixel is ever pushed in front of the occluder's real
+// surface. Pixels along triangle edges are covered by neither neighbor and stay empty, which
+// costs culling power but never correctness; occluders should be coarse, large-triangle
+// meshes, as is usual. Rasterization is binned into screen tiles which are processed in
+// parallel, four pixels at a time.
+//
+// All matrices use DirectXMath's row-vector convention (clip = position * matrix),
+// i.e. they are not transposed the way the shader constants are.
+class OcclusionCuller
+{
+public:
+    static const uint32_t TileSize = 32; // Square tile edge in pixels; also the unit of parallel work.
+
+    OcclusionCuller();
+
+    // Sizes the depth buffer. Dimensions are rounded up to a whole number of tiles.
+    void Init(uint32_t width, uint32_t height);
+
+    void SetViewProjection(const DirectX::XMFLOAT4X4& viewProj);
+
+    void ClearOccluders();
+    void AddOccluder(const Mesh& mesh, const DirectX::XMFLOAT4X4& world);
+    void AddOccluder(const DirectX::XMFLOAT3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const DirectX::XMFLOAT4X4& world);
+
+    // Clears the depth buffer and rasterizes every occluder. A threadCount of 0 uses all cores.
+    void RenderOccluders(uint32_t threadCount = 0);
+
+    // World-space visibility query. Returns false when the sphere is either fully outside
+    // the view or completely hidden by the rasterized occluders.
+    bool IsSphereVisible(const DirectX::XMFLOAT3& center, float radius) const;
+    bool IsSphereVisible(const DirectX::BoundingSphere& sphere, const DirectX::XMFLOAT4X4& world) const;
+
+    // Append the indices of the meshes/meshlets that pass the occlusion test to 'visible',
+    // for a renderer to build its draw list from. The sample's renderer doesn't: its draws go
+    // through the input assembler emulation, which has no per-meshlet draw list to filter.
+    void CullMeshes(const Model& model, const DirectX::XMFLOAT4X4& world, std::vector<uint32_t>& visible) const;
+    void CullMeshlets(const Mesh& mesh, const DirectX::XMFLOAT4X4& world, std::vector<uint32_t>& visible) const;
+
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+    const float* GetDepthBuffer() const { return m_depth.data(); }
+
+private:
+    struct Occluder
+    {
+        std::vector<DirectX::XMFLOAT3> Positions;
+        std::vector<uint32_t>          Indices;
+        DirectX::XMFLOAT4X4            World;
+    };
+
+    // Screen-space triangle prepared for rasterization: edge functions and a depth plane in pixel units.
+    struct ScreenTriangle
+    {
+        float EdgeA[3];
+        float EdgeB[3];
+        float EdgeC[3];
+        float Z0, DzDx, DzDy, ZMax;
+        int32_t MinX, MinY, MaxX, MaxY;
+    };
+
+    void SetupTriangles(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const;
+    void RasterizeTile(uint32_t tileIndex);
+    bool IsRectOccluded(int32_t minX, int32_t minY, int32_t maxX, int32_t maxY, float nearestDepth) const;
+
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+
+    DirectX::XMFLOAT4X4 m_viewProj;
+
+    std::vector<Occluder>                    m_occluders;
+    std::vector<ScreenTriangle>              m_triangles;
+    std::vector<std::vector<uint32_t>>       m_tileBins;
+
+    std::vector<float> m_depth;        // Per-pixel conservative occluder depth, cleared to 1.
+    std::vector<float> m_tileMaxDepth; // Per-tile maximum of m_depth for hierarchical rejection.
+};
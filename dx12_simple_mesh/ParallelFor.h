@@ -0,0 +1,112 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "ThreadCount.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Joins the threads it holds when it goes out of scope, however that happens.
+class ThreadJoiner
+{
+public:
+    explicit ThreadJoiner(std::vector<std::thread>& threads) : m_threads(threads) {}
+
+    ~ThreadJoiner()
+    {
+        for (auto& thread : m_threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread>& m_threads;
+};
+
+// Invokes func(index, threadIndex) for every index in [0, count), distributing the work
+// dynamically across threadCount threads (the calling thread participates as thread 0).
+// Passing a threadCount of 0 uses every hardware thread.
+//
+// If func throws, no further indices are handed out, every thread is joined, and the first
+// exception is rethrown on the calling thread.
+template <typename Func>
+void ParallelFor(uint32_t count, Func&& func, uint32_t threadCount = 0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = GetDefaultThreadCount();
+    }
+    threadCount = std::min(threadCount, count);
+
+    if (threadCount <= 1)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            func(i, 0u);
+        }
+        return;
+    }
+
+    std::atomic<uint32_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&](uint32_t threadIndex)
+    {
+        try
+        {
+            for (uint32_t i = next++; i < count; i = next++)
+            {
+                func(i, threadIndex);
+            }
+        }
+        catch (...)
+        {
+            next = count;
+
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+
+    {
+        // Also joins the threads already started if starting another one throws.
+        ThreadJoiner joiner(threads);
+
+        for (uint32_t t = 1; t < threadCount; ++t)
+        {
+            threads.emplace_back(worker, t);
+        }
+
+        worker(0);
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,299 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "stdafx.h"
+#include "PipelineLibrary.h"
+
+#include "DXSampleHelper.h"
+
+#include <fstream>
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    // Bumped whenever ComputePipelineStateKey() changes what it hashes.
+    const uint32_t c_keyVersion = 1;
+
+    void AddFloat(ContentHasher& hasher, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        hasher.AddNumber(bits);
+    }
+
+    void AddShader(ContentHasher& hasher, const D3D12_SHADER_BYTECODE& shader)
+    {
+        hasher.AddNumber(shader.BytecodeLength);
+        hasher.AddBytes(shader.pShaderBytecode, shader.BytecodeLength);
+    }
+
+    void AddStencilOp(ContentHasher& hasher, const D3D12_DEPTH_STENCILOP_DESC& op)
+    {
+        hasher.AddNumber(op.StencilFailOp);
+        hasher.AddNumber(op.StencilDepthFailOp);
+        hasher.AddNumber(op.StencilPassOp);
+        hasher.AddNumber(op.StencilFunc);
+    }
+
+    std::wstring ToWideString(const std::string& text)
+    {
+        return std::wstring(text.begin(), text.end());
+    }
+}
+
+ContentHash ComputePipelineStateKey(
+    const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& desc,
+    const void* rootSignature,
+    size_t rootSignatureSize)
+{
+    ContentHasher hasher;
+    hasher.AddNumber(c_keyVersion);
+
+    hasher.AddNumber(rootSignatureSize);
+    hasher.AddBytes(rootSignature, rootSignatureSize);
+
+    AddShader(hasher, desc.AS);
+    AddShader(hasher, desc.MS);
+    AddShader(hasher, desc.PS);
+
+    const D3D12_BLEND_DESC& blend = desc.BlendState;
+    hasher.AddNumber(blend.AlphaToCoverageEnable);
+    hasher.AddNumber(blend.IndependentBlendEnable);
+    for (const D3D12_RENDER_TARGET_BLEND_DESC& target : blend.RenderTarget)
+    {
+        hasher.AddNumber(target.BlendEnable);
+        hasher.AddNumber(target.LogicOpEnable);
+        hasher.AddNumber(target.SrcBlend);
+        hasher.AddNumber(target.DestBlend);
+        hasher.AddNumber(target.BlendOp);
+        hasher.AddNumber(target.SrcBlendAlpha);
+        hasher.AddNumber(target.DestBlendAlpha);
+        hasher.AddNumber(target.BlendOpAlpha);
+        hasher.AddNumber(target.LogicOp);
+        hasher.AddNumber(target.RenderTargetWriteMask);
+    }
+
+    hasher.AddNumber(desc.SampleMask);
+
+    const D3D12_RASTERIZER_DESC& rasterizer = desc.RasterizerState;
+    hasher.AddNumber(rasterizer.FillMode);
+    hasher.AddNumber(rasterizer.CullMode);
+    hasher.AddNumber(rasterizer.FrontCounterClockwise);
+    hasher.AddNumber(static_cast<uint32_t>(rasterizer.DepthBias));
+    AddFloat(hasher, rasterizer.DepthBiasClamp);
+    AddFloat(hasher, rasterizer.SlopeScaledDepthBias);
+    hasher.AddNumber(rasterizer.DepthClipEnable);
+    hasher.AddNumber(rasterizer.MultisampleEnable);
+    hasher.AddNumber(rasterizer.AntialiasedLineEnable);
+    hasher.AddNumber(rasterizer.ForcedSampleCount);
+    hasher.AddNumber(rasterizer.ConservativeRaster);
+
+    const D3D12_DEPTH_STENCIL_DESC& depthStencil = desc.DepthStencilState;
+    hasher.AddNumber(depthStencil.DepthEnable);
+    hasher.AddNumber(depthStencil.DepthWriteMask);
+    hasher.AddNumber(depthStencil.DepthFunc);
+    hasher.AddNumber(depthStencil.StencilEnable);
+    hasher.AddNumber(depthStencil.StencilReadMask);
+    hasher.AddNumber(depthStencil.StencilWriteMask);
+    AddStencilOp(hasher, depthStencil.FrontFace);
+    AddStencilOp(hasher, depthStencil.BackFace);
+
+    hasher.AddNumber(desc.PrimitiveTopologyType);
+    hasher.AddNumber(desc.NumRenderTargets);
+    for (DXGI_FORMAT format : desc.RTVFormats)
+    {
+        hasher.AddNumber(format);
+    }
+    hasher.AddNumber(desc.DSVFormat);
+    hasher.AddNumber(desc.SampleDesc.Count);
+    hasher.AddNumber(desc.SampleDesc.Quality);
+    hasher.AddNumber(desc.NodeMask);
+    hasher.AddNumber(desc.Flags);
+
+    return hasher.GetHash();
+}
+
+PipelineLibrary::PipelineLibrary(std::wstring filename)
+    : m_filename(std::move(filename))
+    , m_identity{}
+    , m_dirty(false)
+    , m_loadCount(0)
+    , m_storeCount(0)
+{ }
+
+void PipelineLibrary::Open(ID3D12Device2* device)
+{
+    m_device = device;
+    m_library.Reset();
+    m_file.clear();
+    m_dirty = false;
+
+    if (FAILED(GetIdentity(m_identity)))
+        return;
+
+    size_t libraryOffset = 0;
+    size_t librarySize = 0;
+    {
+        std::ifstream stream(m_filename, std::ios::binary | std::ios::ate);
+        if (stream)
+        {
+            m_file.resize(static_cast<size_t>(stream.tellg()));
+            stream.seekg(0, std::ios::beg);
+            stream.read(reinterpret_cast<char*>(m_file.data()), m_file.size());
+
+            if (!stream || ReadPipelineLibraryFile(m_file.data(), m_file.size(), m_identity, libraryOffset, librarySize) != PipelineLibraryFile::Valid)
+            {
+                OutputDebugStringA("Pipeline library file is stale or corrupt; starting an empty library.\n");
+                m_file.clear();
+                librarySize = 0;
+            }
+        }
+    }
+
+    if (librarySize != 0)
+    {
+        HRESULT hr = device->CreatePipelineLibrary(m_file.data() + libraryOffset, librarySize, IID_PPV_ARGS(&m_library));
+        if (SUCCEEDED(hr))
+            return;
+
+        // The identity check misses some changes the runtime catches, such as a driver
+        // reinstalled at the same version; those drop the library too.
+        m_file.clear();
+        m_dirty = true;
+    }
+
+    // Unsupported by the OS or driver (DXGI_ERROR_UNSUPPORTED) leaves m_library null.
+    if (FAILED(device->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library))))
+    {
+        m_library.Reset();
+    }
+}
+
+HRESULT PipelineLibrary::CreatePipelineState(
+    const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& desc,
+    const void* rootSignature,
+    size_t rootSignatureSize,
+    ID3D12PipelineState** pipelineState)
+{
+    *pipelineState = nullptr;
+
+    auto psoStream = CD3DX12_PIPELINE_MESH_STATE_STREAM(desc);
+
+    D3D12_PIPELINE_STATE_STREAM_DESC streamDesc;
+    streamDesc.pPipelineStateSubobjectStream = &psoStream;
+    streamDesc.SizeInBytes                   = sizeof(psoStream);
+
+    if (!m_library)
+        return m_device->CreatePipelineState(&streamDesc, IID_PPV_ARGS(pipelineState));
+
+    const std::wstring name = ToWideString(ComputePipelineStateKey(desc, rootSignature, rootSignatureSize).ToString());
+
+    // Loads of the same name must not overlap, so loads and stores are serialized; the
+    // compile between them is not.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // E_INVALIDARG if the name isn't in the library.
+        if (SUCCEEDED(m_library->LoadPipeline(name.c_str(), &streamDesc, IID_PPV_ARGS(pipelineState))))
+        {
+            ++m_loadCount;
+            return S_OK;
+        }
+    }
+
+    ComPtr<ID3D12PipelineState> created;
+    HRESULT hr = m_device->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&created));
+    if (FAILED(hr))
+        return hr;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Fails harmlessly when another thread stored the same pipeline state first.
+        if (SUCCEEDED(m_library->StorePipeline(name.c_str(), created.Get())))
+        {
+            ++m_storeCount;
+            m_dirty = true;
+        }
+    }
+
+    *pipelineState = created.Detach();
+    return S_OK;
+}
+
+HRESULT PipelineLibrary::Save()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_library || !m_dirty)
+        return S_OK;
+
+    std::vector<uint8_t> library(m_library->GetSerializedSize());
+    HRESULT hr = m_library->Serialize(library.data(), library.size());
+    if (FAILED(hr))
+        return hr;
+
+    std::vector<uint8_t> file;
+    WritePipelineLibraryFile(m_identity, library.data(), library.size(), file);
+
+    // Written aside and renamed over the old file, so a crash never leaves half a library.
+    const std::wstring temporaryFilename = m_filename + L".tmp";
+    {
+        std::ofstream stream(temporaryFilename, std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+        stream.close();
+        if (stream.fail())
+        {
+            DeleteFileW(temporaryFilename.c_str());
+            return E_FAIL;
+        }
+    }
+
+    if (!MoveFileExW(temporaryFilename.c_str(), m_filename.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+        DeleteFileW(temporaryFilename.c_str());
+        return hr;
+    }
+
+    m_dirty = false;
+    return S_OK;
+}
+
+HRESULT PipelineLibrary::GetIdentity(PipelineLibraryIdentity& identity) const
+{
+    ComPtr<IDXGIFactory4> factory;
+    HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
+    if (FAILED(hr))
+        return hr;
+
+    ComPtr<IDXGIAdapter1> adapter;
+    hr = factory->EnumAdapterByLuid(m_device->GetAdapterLuid(), IID_PPV_ARGS(&adapter));
+    if (FAILED(hr))
+        return hr;
+
+    DXGI_ADAPTER_DESC1 desc;
+    hr = adapter->GetDesc1(&desc);
+    if (FAILED(hr))
+        return hr;
+
+    LARGE_INTEGER driverVersion;
+    hr = adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+    if (FAILED(hr))
+        return hr;
+
+    identity.VendorId = desc.VendorId;
+    identity.DeviceId = desc.DeviceId;
+    identity.SubSysId = desc.SubSysId;
+    identity.Revision = desc.Revision;
+    identity.DriverVersion = static_cast<uint64_t>(driverVersion.QuadPart);
+    return S_OK;
+}
@@ -0,0 +1,67 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "ContentHash.h"
+#include "PipelineLibraryFile.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Hashes everything about a mesh shader pipeline state that decides what the driver compiles:
+// the serialized root signature 'desc.pRootSignature' was created from, the shaders' bytecode
+// and every fixed-function field, field by field so that padding can't change the key.
+// CachedPSO is left out.
+ContentHash ComputePipelineStateKey(
+    const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& desc,
+    const void* rootSignature,
+    size_t rootSignatureSize);
+
+// Pipeline states kept in an ID3D12PipelineLibrary serialized to a file, named by
+// ComputePipelineStateKey(), so that later runs load them instead of compiling them again. A
+// file written for another adapter or driver, or failing its checks, is replaced by an empty
+// library. CreatePipelineState() may be called from several threads.
+class PipelineLibrary
+{
+public:
+    explicit PipelineLibrary(std::wstring filename);
+
+    // Loads the library file. On devices without pipeline library support, CreatePipelineState()
+    // compiles every pipeline state and stores none.
+    void Open(ID3D12Device2* device);
+
+    // Loads the pipeline state from the library, or creates it and adds it to the library.
+    HRESULT CreatePipelineState(
+        const D3DX12_MESH_SHADER_PIPELINE_STATE_DESC& desc,
+        const void* rootSignature,
+        size_t rootSignatureSize,
+        ID3D12PipelineState** pipelineState);
+
+    // Writes the library back if pipeline states were added since it was opened or saved.
+    HRESULT Save();
+
+    uint32_t GetLoadCount() const { return m_loadCount; }
+    uint32_t GetStoreCount() const { return m_storeCount; }
+
+private:
+    HRESULT GetIdentity(PipelineLibraryIdentity& identity) const;
+
+    std::wstring                                   m_filename;
+    Microsoft::WRL::ComPtr<ID3D12Device2>          m_device;
+    Microsoft::WRL::ComPtr<ID3D12PipelineLibrary1> m_library;
+    PipelineLibraryIdentity                        m_identity;
+    std::vector<uint8_t>                           m_file;      // Holds the library m_library was created from, which it reads for its whole life
+    std::mutex                                     m_mutex;
+    bool                                           m_dirty;
+    uint32_t                                       m_loadCount;
+    uint32_t                                       m_storeCount;
+};
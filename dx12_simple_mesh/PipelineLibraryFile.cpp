@@ -0,0 +1,101 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "PipelineLibraryFile.h"
+
+#include "ContentHash.h"
+
+#include <cstring>
+
+namespace
+{
+    const uint32_t c_fileMagic = 0x42494c50; // "PLIB"
+    const uint32_t c_fileVersion = 1;
+
+    struct FileHeader
+    {
+        uint32_t                Magic;
+        uint32_t                Version;
+        PipelineLibraryIdentity Identity;
+        uint64_t                Size;         // Library bytes following the header
+        uint64_t                Checksum[2];  // ContentHash of the identity and library
+    };
+
+    static_assert(sizeof(FileHeader) % 8 == 0, "The library must follow the header 8-byte aligned.");
+
+    ContentHash ComputeChecksum(const PipelineLibraryIdentity& identity, const void* library, size_t size)
+    {
+        ContentHasher hasher;
+        hasher.AddNumber(identity.VendorId);
+        hasher.AddNumber(identity.DeviceId);
+        hasher.AddNumber(identity.SubSysId);
+        hasher.AddNumber(identity.Revision);
+        hasher.AddNumber(identity.DriverVersion);
+        hasher.AddBytes(library, size);
+        return hasher.GetHash();
+    }
+}
+
+void WritePipelineLibraryFile(const PipelineLibraryIdentity& identity, const void* library, size_t size, std::vector<uint8_t>& file)
+{
+    const ContentHash checksum = ComputeChecksum(identity, library, size);
+
+    FileHeader header = {};
+    header.Magic = c_fileMagic;
+    header.Version = c_fileVersion;
+    header.Identity = identity;
+    header.Size = size;
+    header.Checksum[0] = checksum.Hash[0];
+    header.Checksum[1] = checksum.Hash[1];
+
+    file.resize(sizeof(header) + size);
+    memcpy(file.data(), &header, sizeof(header));
+    if (size != 0)
+    {
+        memcpy(file.data() + sizeof(header), library, size);
+    }
+}
+
+PipelineLibraryFile::EStatus ReadPipelineLibraryFile(
+    const uint8_t* file,
+    size_t size,
+    const PipelineLibraryIdentity& identity,
+    size_t& libraryOffset,
+    size_t& librarySize)
+{
+    libraryOffset = 0;
+    librarySize = 0;
+
+    FileHeader header;
+    if (size < sizeof(header))
+        return PipelineLibraryFile::Corrupt;
+
+    memcpy(&header, file, sizeof(header));
+    if (header.Magic != c_fileMagic)
+        return PipelineLibraryFile::Corrupt;
+
+    if (header.Version != c_fileVersion)
+        return PipelineLibraryFile::OldVersion;
+
+    if (header.Size != size - sizeof(header))
+        return PipelineLibraryFile::Corrupt;
+
+    // The checksum covers the identity, so a damaged header reads as corrupt, not as another driver's.
+    const ContentHash checksum = ComputeChecksum(header.Identity, file + sizeof(header), size - sizeof(header));
+    if (checksum.Hash[0] != header.Checksum[0] || checksum.Hash[1] != header.Checksum[1])
+        return PipelineLibraryFile::Corrupt;
+
+    if (header.Identity != identity)
+        return PipelineLibraryFile::IdentityMismatch;
+
+    libraryOffset = sizeof(header);
+    librarySize = size - sizeof(header);
+    return PipelineLibraryFile::Valid;
+}
@@ -0,0 +1,60 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The container a serialized ID3D12PipelineLibrary is stored in. Serialized libraries can only
+// be loaded by the driver that wrote them, so the container records which adapter and driver
+// that was, and a run on any other starts over rather than handing the driver a stale blob.
+
+// Identifies the adapter and user mode driver a library was serialized by.
+struct PipelineLibraryIdentity
+{
+    uint32_t VendorId;
+    uint32_t DeviceId;
+    uint32_t SubSysId;
+    uint32_t Revision;
+    uint64_t DriverVersion;  // As IDXGIAdapter::CheckInterfaceSupport() reports it
+
+    bool operator==(const PipelineLibraryIdentity& other) const
+    {
+        return VendorId == other.VendorId && DeviceId == other.DeviceId && SubSysId == other.SubSysId &&
+            Revision == other.Revision && DriverVersion == other.DriverVersion;
+    }
+
+    bool operator!=(const PipelineLibraryIdentity& other) const { return !(*this == other); }
+};
+
+struct PipelineLibraryFile
+{
+    enum EStatus : uint32_t
+    {
+        Valid,
+        Corrupt,           // Truncated, not a pipeline library file, or failing its checksum
+        OldVersion,        // Written with another version of the container
+        IdentityMismatch,  // Written for another adapter or driver
+    };
+};
+
+// Replaces 'file' with a container holding 'library', serialized for 'identity'.
+void WritePipelineLibraryFile(const PipelineLibraryIdentity& identity, const void* library, size_t size, std::vector<uint8_t>& file);
+
+// Checks that 'file' is a container written for 'identity'. Valid files also return where in
+// 'file' the serialized library is; it is aligned to 8 bytes relative to the file's start.
+PipelineLibraryFile::EStatus ReadPipelineLibraryFile(
+    const uint8_t* file,
+    size_t size,
+    const PipelineLibraryIdentity& identity,
+    size_t& libraryOffset,
+    size_t& librarySize);
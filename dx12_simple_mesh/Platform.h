@@ -0,0 +1,210 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+// The Windows and D3D12 definitions the portable core uses: result codes, the DXGI formats and
+// input layouts that describe vertex data, buffer views and primitive topologies.
+// On Windows these come from the SDK; elsewhere the subset the core needs is declared here,
+// with the SDK's values, so that files and layouts mean the same on either platform. Nothing
+// here creates or talks to a device; that stays in the D3D12 sources.
+
+#ifdef _WIN32
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+#include <d3d12.h>
+
+#else
+
+#include <cstdint>
+
+typedef int32_t  HRESULT;
+typedef uint32_t UINT;
+typedef uint8_t  UINT8;
+typedef uint32_t UINT32;
+typedef uint64_t UINT64;
+
+#define S_OK            ((HRESULT)0)
+#define S_FALSE         ((HRESULT)1)
+#define E_NOTIMPL       ((HRESULT)0x80004001)
+#define E_FAIL          ((HRESULT)0x80004005)
+#define E_INVALIDARG    ((HRESULT)0x80070057)
+#define E_OUTOFMEMORY   ((HRESULT)0x8007000E)
+
+#define SUCCEEDED(hr)   (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)      (((HRESULT)(hr)) < 0)
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+enum DXGI_FORMAT
+{
+    DXGI_FORMAT_UNKNOWN                 = 0,
+    DXGI_FORMAT_R32G32B32A32_FLOAT      = 2,
+    DXGI_FORMAT_R32G32B32A32_UINT       = 3,
+    DXGI_FORMAT_R32G32B32A32_SINT       = 4,
+    DXGI_FORMAT_R32G32B32_FLOAT         = 6,
+    DXGI_FORMAT_R32G32B32_UINT          = 7,
+    DXGI_FORMAT_R32G32B32_SINT          = 8,
+    DXGI_FORMAT_R16G16B16A16_FLOAT      = 10,
+    DXGI_FORMAT_R16G16B16A16_UNORM      = 11,
+    DXGI_FORMAT_R16G16B16A16_UINT       = 12,
+    DXGI_FORMAT_R16G16B16A16_SNORM      = 13,
+    DXGI_FORMAT_R16G16B16A16_SINT       = 14,
+    DXGI_FORMAT_R32G32_FLOAT            = 16,
+    DXGI_FORMAT_R32G32_UINT             = 17,
+    DXGI_FORMAT_R32G32_SINT             = 18,
+    DXGI_FORMAT_R10G10B10A2_UNORM       = 24,
+    DXGI_FORMAT_R10G10B10A2_UINT        = 25,
+    DXGI_FORMAT_R8G8B8A8_UNORM          = 28,
+    DXGI_FORMAT_R8G8B8A8_UINT           = 30,
+    DXGI_FORMAT_R8G8B8A8_SNORM          = 31,
+    DXGI_FORMAT_R8G8B8A8_SINT           = 32,
+    DXGI_FORMAT_R16G16_FLOAT            = 34,
+    DXGI_FORMAT_R16G16_UNORM            = 35,
+    DXGI_FORMAT_R16G16_UINT             = 36,
+    DXGI_FORMAT_R16G16_SNORM            = 37,
+    DXGI_FORMAT_R16G16_SINT             = 38,
+    DXGI_FORMAT_R32_FLOAT               = 41,
+    DXGI_FORMAT_R32_UINT                = 42,
+    DXGI_FORMAT_R32_SINT                = 43,
+    DXGI_FORMAT_R8G8_UNORM              = 49,
+    DXGI_FORMAT_R8G8_UINT               = 50,
+    DXGI_FORMAT_R8G8_SNORM              = 51,
+    DXGI_FORMAT_R8G8_SINT               = 52,
+    DXGI_FORMAT_R16_FLOAT               = 54,
+    DXGI_FORMAT_R16_UNORM               = 56,
+    DXGI_FORMAT_R16_UINT                = 57,
+    DXGI_FORMAT_R16_SNORM               = 58,
+    DXGI_FORMAT_R16_SINT                = 59,
+    DXGI_FORMAT_R8_UNORM                = 61,
+    DXGI_FORMAT_R8_UINT                 = 62,
+    DXGI_FORMAT_R8_SNORM                = 63,
+    DXGI_FORMAT_R8_SINT                 = 64,
+    DXGI_FORMAT_B8G8R8A8_UNORM          = 87,
+};
+
+enum D3D12_INPUT_CLASSIFICATION
+{
+    D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA   = 0,
+    D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA = 1,
+};
+
+#define D3D12_APPEND_ALIGNED_ELEMENT 0xffffffff
+
+struct D3D12_INPUT_ELEMENT_DESC
+{
+    const char*                SemanticName;
+    UINT                       SemanticIndex;
+    DXGI_FORMAT                Format;
+    UINT                       InputSlot;
+    UINT                       AlignedByteOffset;
+    D3D12_INPUT_CLASSIFICATION InputSlotClass;
+    UINT                       InstanceDataStepRate;
+};
+
+struct D3D12_INPUT_LAYOUT_DESC
+{
+    const D3D12_INPUT_ELEMENT_DESC* pInputElementDescs;
+    UINT                            NumElements;
+};
+
+enum D3D_PRIMITIVE_TOPOLOGY
+{
+    D3D_PRIMITIVE_TOPOLOGY_UNDEFINED         = 0,
+    D3D_PRIMITIVE_TOPOLOGY_POINTLIST         = 1,
+    D3D_PRIMITIVE_TOPOLOGY_LINELIST          = 2,
+    D3D_PRIMITIVE_TOPOLOGY_LINESTRIP         = 3,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST      = 4,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP     = 5,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN       = 6,
+    D3D_PRIMITIVE_TOPOLOGY_LINELIST_ADJ      = 10,
+    D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ     = 11,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST_ADJ  = 12,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ = 13,
+};
+
+typedef D3D_PRIMITIVE_TOPOLOGY D3D12_PRIMITIVE_TOPOLOGY;
+
+enum D3D12_INDEX_BUFFER_STRIP_CUT_VALUE
+{
+    D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED   = 0,
+    D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF     = 1,
+    D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFFFFFF = 2,
+};
+
+typedef uint64_t D3D12_GPU_VIRTUAL_ADDRESS;
+
+struct D3D12_VERTEX_BUFFER_VIEW
+{
+    D3D12_GPU_VIRTUAL_ADDRESS BufferLocation;
+    UINT                      SizeInBytes;
+    UINT                      StrideInBytes;
+};
+
+struct D3D12_INDEX_BUFFER_VIEW
+{
+    D3D12_GPU_VIRTUAL_ADDRESS BufferLocation;
+    UINT                      SizeInBytes;
+    DXGI_FORMAT               Format;
+};
+
+#endif
+
+#include <string>
+
+// File streams take wide paths on Windows only; elsewhere a path is its UTF-8 bytes.
+#ifdef _WIN32
+inline std::wstring GetStreamPath(const wchar_t* path)
+{
+    return path;
+}
+#else
+inline std::string GetStreamPath(const wchar_t* path)
+{
+    std::string utf8;
+    for (; *path != 0; ++path)
+    {
+        const uint32_t c = static_cast<uint32_t>(*path);
+        if (c < 0x80)
+        {
+            utf8 += static_cast<char>(c);
+        }
+        else if (c < 0x800)
+        {
+            utf8 += static_cast<char>(0xc0 | (c >> 6));
+            utf8 += static_cast<char>(0x80 | (c & 0x3f));
+        }
+        else if (c < 0x10000)
+        {
+            utf8 += static_cast<char>(0xe0 | (c >> 12));
+            utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            utf8 += static_cast<char>(0x80 | (c & 0x3f));
+        }
+        else
+        {
+            utf8 += static_cast<char>(0xf0 | (c >> 18));
+            utf8 += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            utf8 += static_cast<char>(0x80 | (c & 0x3f));
+        }
+    }
+    return utf8;
+}
+#endif
@@ -0,0 +1,847 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "PngImage.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    const uint8_t c_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+    const uint32_t c_maxDimension = 1u << 16;
+
+    // Deflate's length and distance codes: the base value of each and its extra bits.
+    const uint16_t c_lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t  c_lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t c_distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t  c_distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    // Order the code length code lengths of a dynamic block are stored in.
+    const uint8_t c_codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    const uint32_t c_windowSize = 32768;
+    const uint32_t c_minMatch = 3;
+    const uint32_t c_maxMatch = 258;
+    const uint32_t c_maxChainLength = 16;
+    const uint32_t c_hashBits = 15;
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+    {
+        static uint32_t table[256];
+        static const bool initialized = []()
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (uint32_t k = 0; k < 8; ++k)
+                {
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                }
+                table[n] = c;
+            }
+            return true;
+        }();
+        (void)initialized;
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    uint32_t Adler32(const uint8_t* data, size_t size)
+    {
+        uint32_t a = 1, b = 0;
+        while (size > 0)
+        {
+            // 5552 bytes is the most that can be summed before the sums must be reduced.
+            const size_t chunk = std::min<size_t>(size, 5552);
+            for (size_t i = 0; i < chunk; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += chunk;
+            size -= chunk;
+        }
+        return (b << 16) | a;
+    }
+
+    void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint32_t ReadBigEndian(const uint8_t* data)
+    {
+        return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+    }
+
+    void AppendChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size)
+    {
+        AppendBigEndian(out, static_cast<uint32_t>(size));
+
+        const size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + size);
+
+        AppendBigEndian(out, Crc32(out.data() + start, size + 4));
+    }
+
+    //
+    // Deflate
+    //
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out) : m_out(out), m_bits(0), m_count(0) {}
+
+        // Writes the low 'count' bits of 'value', least significant first.
+        void Write(uint32_t value, uint32_t count)
+        {
+            m_bits |= static_cast<uint64_t>(value) << m_count;
+            m_count += count;
+            while (m_count >= 8)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_bits));
+                m_bits >>= 8;
+                m_count -= 8;
+            }
+        }
+
+        // Huffman codes are stored most significant bit first.
+        void WriteCode(uint32_t code, uint32_t length)
+        {
+            uint32_t reversed = 0;
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                reversed |= ((code >> i) & 1) << (length - 1 - i);
+            }
+            Write(reversed, length);
+        }
+
+        void Flush()
+        {
+            if (m_count > 0)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_bits));
+            }
+            m_bits = 0;
+            m_count = 0;
+        }
+
+    private:
+        std::vector<uint8_t>& m_out;
+        uint64_t              m_bits;
+        uint32_t              m_count;
+    };
+
+    void WriteFixedLiteral(BitWriter& writer, uint32_t symbol)
+    {
+        if (symbol < 144)
+            writer.WriteCode(0x30 + symbol, 8);
+        else if (symbol < 256)
+            writer.WriteCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            writer.WriteCode(symbol - 256, 7);
+        else
+            writer.WriteCode(0xc0 + symbol - 280, 8);
+    }
+
+    void WriteMatch(BitWriter& writer, uint32_t length, uint32_t distance)
+    {
+        uint32_t code = 28;
+        while (c_lengthBase[code] > length)
+        {
+            --code;
+        }
+        WriteFixedLiteral(writer, 257 + code);
+        writer.Write(length - c_lengthBase[code], c_lengthExtra[code]);
+
+        code = 29;
+        while (c_distanceBase[code] > distance)
+        {
+            --code;
+        }
+        writer.WriteCode(code, 5);
+        writer.Write(distance - c_distanceBase[code], c_distanceExtra[code]);
+    }
+
+    uint32_t Hash(const uint8_t* data)
+    {
+        const uint32_t value = data[0] | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16);
+        return (value * 2654435761u) >> (32 - c_hashBits);
+    }
+
+    // A zlib stream of 'data' as one fixed Huffman block, with greedy LZ77 matching.
+    void Deflate(const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+    {
+        out.push_back(0x78); // Deflate with a 32K window
+        out.push_back(0x01); // No dictionary, fastest compression; the header is a multiple of 31
+
+        BitWriter writer(out);
+        writer.Write(1, 1); // Final block
+        writer.Write(1, 2); // Fixed Huffman codes
+
+        const size_t size = data.size();
+        std::vector<int32_t> head(size_t(1) << c_hashBits, -1);
+        std::vector<int32_t> previous(c_windowSize, -1);
+
+        auto insert = [&](size_t position)
+        {
+            const uint32_t hash = Hash(&data[position]);
+            previous[position % c_windowSize] = head[hash];
+            head[hash] = static_cast<int32_t>(position);
+        };
+
+        size_t position = 0;
+        while (position < size)
+        {
+            uint32_t bestLength = 0;
+            uint32_t bestDistance = 0;
+
+            if (position + c_minMatch <= size)
+            {
+                const uint32_t maxLength = static_cast<uint32_t>(std::min<size_t>(c_maxMatch, size - position));
+
+                int32_t candidate = head[Hash(&data[position])];
+                for (uint32_t chain = 0; chain < c_maxChainLength && candidate >= 0; ++chain)
+                {
+                    const size_t distance = position - static_cast<size_t>(candidate);
+                    if (distance > c_windowSize)
+                        break;
+
+                    uint32_t length = 0;
+                    while (length < maxLength && data[candidate + length] == data[position + length])
+                    {
+                        ++length;
+                    }
+
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = static_cast<uint32_t>(distance);
+                        if (length == maxLength)
+                            break;
+                    }
+
+                    const int32_t next = previous[candidate % c_windowSize];
+                    if (next >= candidate)
+                        break; // The slot has been reused by a newer position
+                    candidate = next;
+                }
+            }
+
+            if (bestLength >= c_minMatch)
+            {
+                WriteMatch(writer, bestLength, bestDistance);
+                for (uint32_t i = 0; i < bestLength; ++i, ++position)
+                {
+                    if (position + c_minMatch <= size)
+                    {
+                        insert(position);
+                    }
+                }
+            }
+            else
+            {
+                WriteFixedLiteral(writer, data[position]);
+                if (position + c_minMatch <= size)
+                {
+                    insert(position);
+                }
+                ++position;
+            }
+        }
+
+        WriteFixedLiteral(writer, 256); // End of block
+        writer.Flush();
+
+        AppendBigEndian(out, Adler32(data.data(), data.size()));
+    }
+
+    //
+    // Inflate
+    //
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_position(0), m_bits(0), m_count(0) {}
+
+        bool Read(uint32_t count, uint32_t& value)
+        {
+            while (m_count < count)
+            {
+                if (m_position == m_size)
+                    return false;
+
+                m_bits |= static_cast<uint32_t>(m_data[m_position++]) << m_count;
+                m_count += 8;
+            }
+
+            value = count == 0 ? 0 : m_bits & ((1u << count) - 1);
+            m_bits = count == 32 ? 0 : m_bits >> count;
+            m_count -= count;
+            return true;
+        }
+
+        // Stored blocks start on a byte boundary.
+        void AlignToByte()
+        {
+            m_bits = 0;
+            m_count = 0;
+        }
+
+        const uint8_t* GetBytes(size_t count)
+        {
+            if (m_size - m_position < count)
+                return nullptr;
+
+            const uint8_t* bytes = m_data + m_position;
+            m_position += count;
+            return bytes;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t         m_size;
+        size_t         m_position;
+        uint32_t       m_bits;
+        uint32_t       m_count;
+    };
+
+    // A canonical Huffman code: how many codes there are of each length, and the symbols in
+    // code order.
+    struct HuffmanCode
+    {
+        uint16_t Counts[16];
+        uint16_t Symbols[288];
+
+        bool Build(const uint8_t* lengths, uint32_t symbolCount)
+        {
+            memset(Counts, 0, sizeof(Counts));
+            for (uint32_t s = 0; s < symbolCount; ++s)
+            {
+                Counts[lengths[s]]++;
+            }
+            Counts[0] = 0;
+
+            // Reject over-subscribed codes; incomplete ones are allowed, as zlib allows them.
+            int32_t left = 1;
+            for (uint32_t length = 1; length < 16; ++length)
+            {
+                left = left * 2 - Counts[length];
+                if (left < 0)
+                    return false;
+            }
+
+            uint16_t offsets[16];
+            offsets[1] = 0;
+            for (uint32_t length = 1; length < 15; ++length)
+            {
+                offsets[length + 1] = offsets[length] + Counts[length];
+            }
+
+            for (uint32_t s = 0; s < symbolCount; ++s)
+            {
+                if (lengths[s] != 0)
+                {
+                    Symbols[offsets[lengths[s]]++] = static_cast<uint16_t>(s);
+                }
+            }
+
+            return true;
+        }
+
+        bool Decode(BitReader& reader, uint32_t& symbol) const
+        {
+            int32_t code = 0;
+            int32_t first = 0;
+            int32_t index = 0;
+            for (uint32_t length = 1; length < 16; ++length)
+            {
+                uint32_t bit;
+                if (!reader.Read(1, bit))
+                    return false;
+
+                code |= static_cast<int32_t>(bit);
+                const int32_t count = Counts[length];
+                if (code - first < count)
+                {
+                    symbol = Symbols[index + code - first];
+                    return true;
+                }
+
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+
+            return false;
+        }
+    };
+
+    bool InflateCodes(BitReader& reader, const HuffmanCode& literals, const HuffmanCode& distances, std::vector<uint8_t>& out)
+    {
+        for (;;)
+        {
+            uint32_t symbol;
+            if (!literals.Decode(reader, symbol))
+                return false;
+
+            if (symbol < 256)
+            {
+                out.push_back(static_cast<uint8_t>(symbol));
+                continue;
+            }
+
+            if (symbol == 256)
+                return true;
+
+            symbol -= 257;
+            if (symbol >= 29)
+                return false;
+
+            uint32_t extra;
+            if (!reader.Read(c_lengthExtra[symbol], extra))
+                return false;
+            const uint32_t length = c_lengthBase[symbol] + extra;
+
+            if (!distances.Decode(reader, symbol) || symbol >= 30 || !reader.Read(c_distanceExtra[symbol], extra))
+                return false;
+            const size_t distance = c_distanceBase[symbol] + extra;
+
+            if (distance > out.size())
+                return false;
+
+            const size_t from = out.size() - distance;
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                out.push_back(out[from + i]);
+            }
+        }
+    }
+
+    bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+    {
+        // zlib header: deflate, no preset dictionary, and a valid check.
+        if (size < 6 || (data[0] & 0x0f) != 8 || (data[1] & 0x20) != 0 || ((data[0] << 8) | data[1]) % 31 != 0)
+            return false;
+
+        BitReader reader(data + 2, size - 6);
+
+        uint32_t final = 0;
+        while (final == 0)
+        {
+            uint32_t type;
+            if (!reader.Read(1, final) || !reader.Read(2, type))
+                return false;
+
+            if (type == 0)
+            {
+                reader.AlignToByte();
+
+                const uint8_t* header = reader.GetBytes(4);
+                if (header == nullptr)
+                    return false;
+
+                const uint32_t length = header[0] | (header[1] << 8);
+                const uint32_t inverse = header[2] | (header[3] << 8);
+                if (length != (~inverse & 0xffff))
+                    return false;
+
+                const uint8_t* bytes = reader.GetBytes(length);
+                if (bytes == nullptr)
+                    return false;
+
+                out.insert(out.end(), bytes, bytes + length);
+            }
+            else if (type == 1)
+            {
+                uint8_t lengths[288 + 30];
+                std::fill(lengths, lengths + 144, uint8_t(8));
+                std::fill(lengths + 144, lengths + 256, uint8_t(9));
+                std::fill(lengths + 256, lengths + 280, uint8_t(7));
+                std::fill(lengths + 280, lengths + 288, uint8_t(8));
+                std::fill(lengths + 288, lengths + 318, uint8_t(5));
+
+                HuffmanCode literals, distances;
+                literals.Build(lengths, 288);
+                distances.Build(lengths + 288, 30);
+
+                if (!InflateCodes(reader, literals, distances, out))
+                    return false;
+            }
+            else if (type == 2)
+            {
+                uint32_t literalCount, distanceCount, codeLengthCount;
+                if (!reader.Read(5, literalCount) || !reader.Read(5, distanceCount) || !reader.Read(4, codeLengthCount))
+                    return false;
+
+                literalCount += 257;
+                distanceCount += 1;
+                codeLengthCount += 4;
+                if (literalCount > 286 || distanceCount > 30)
+                    return false;
+
+                uint8_t codeLengths[19] = {};
+                for (uint32_t i = 0; i < codeLengthCount; ++i)
+                {
+                    uint32_t length;
+                    if (!reader.Read(3, length))
+                        return false;
+                    codeLengths[c_codeLengthOrder[i]] = static_cast<uint8_t>(length);
+                }
+
+                HuffmanCode codeLengthCode;
+                if (!codeLengthCode.Build(codeLengths, 19))
+                    return false;
+
+                uint8_t lengths[286 + 30] = {};
+                for (uint32_t i = 0; i < literalCount + distanceCount;)
+                {
+                    uint32_t symbol;
+                    if (!codeLengthCode.Decode(reader, symbol))
+                        return false;
+
+                    if (symbol < 16)
+                    {
+                        lengths[i++] = static_cast<uint8_t>(symbol);
+                        continue;
+                    }
+
+                    uint32_t repeat;
+                    uint8_t value = 0;
+                    if (symbol == 16)
+                    {
+                        if (i == 0 || !reader.Read(2, repeat))
+                            return false;
+                        value = lengths[i - 1];
+                        repeat += 3;
+                    }
+                    else if (symbol == 17)
+                    {
+                        if (!reader.Read(3, repeat))
+                            return false;
+                        repeat += 3;
+                    }
+                    else
+                    {
+                        if (!reader.Read(7, repeat))
+                            return false;
+                        repeat += 11;
+                    }
+
+                    if (i + repeat > literalCount + distanceCount)
+                        return false;
+
+                    std::fill(lengths + i, lengths + i + repeat, value);
+                    i += repeat;
+                }
+
+                HuffmanCode literals, distances;
+                if (lengths[256] == 0 || !literals.Build(lengths, literalCount) || !distances.Build(lengths + literalCount, distanceCount))
+                    return false;
+
+                if (!InflateCodes(reader, literals, distances, out))
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return ReadBigEndian(data + size - 4) == Adler32(out.data(), out.size());
+    }
+
+    //
+    // Filters
+    //
+
+    uint8_t Paeth(uint8_t a, uint8_t b, uint8_t c)
+    {
+        const int32_t p = int32_t(a) + b - c;
+        const int32_t pa = std::abs(p - a);
+        const int32_t pb = std::abs(p - b);
+        const int32_t pc = std::abs(p - c);
+
+        if (pa <= pb && pa <= pc)
+            return a;
+        return pb <= pc ? b : c;
+    }
+
+    // The predictor of 'filter' for byte i of a row, from the bytes to its left, above, and
+    // above-left; 'bpp' bytes make a pixel.
+    uint8_t Predict(uint8_t filter, const uint8_t* row, const uint8_t* prior, size_t i, size_t bpp)
+    {
+        const uint8_t left = i >= bpp ? row[i - bpp] : 0;
+        const uint8_t up = prior[i];
+        const uint8_t upLeft = i >= bpp ? prior[i - bpp] : 0;
+
+        switch (filter)
+        {
+        case 1: return left;
+        case 2: return up;
+        case 3: return static_cast<uint8_t>((uint32_t(left) + up) / 2);
+        case 4: return Paeth(left, up, upLeft);
+        default: return 0;
+        }
+    }
+}
+
+HRESULT WritePng(const wchar_t* filename, uint32_t width, uint32_t height, const uint8_t* rgba)
+{
+    if (width == 0 || height == 0 || width > c_maxDimension || height > c_maxDimension)
+        return E_INVALIDARG;
+
+    const size_t rowSize = size_t(width) * 4;
+
+    // Filter each row the way that leaves the smallest sum of absolute differences, the
+    // heuristic the PNG specification suggests.
+    std::vector<uint8_t> filtered;
+    filtered.reserve((rowSize + 1) * height);
+
+    const std::vector<uint8_t> zeroRow(rowSize, 0);
+    std::vector<uint8_t> candidate(rowSize);
+    std::vector<uint8_t> best(rowSize);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* row = rgba + y * rowSize;
+        const uint8_t* prior = y > 0 ? row - rowSize : zeroRow.data();
+
+        uint8_t bestFilter = 0;
+        uint64_t bestSum = UINT64_MAX;
+        for (uint8_t filter = 0; filter < 5; ++filter)
+        {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < rowSize; ++i)
+            {
+                candidate[i] = static_cast<uint8_t>(row[i] - Predict(filter, row, prior, i, 4));
+                sum += static_cast<uint64_t>(std::abs(static_cast<int8_t>(candidate[i])));
+            }
+
+            if (sum < bestSum)
+            {
+                bestSum = sum;
+                bestFilter = filter;
+                best.swap(candidate);
+            }
+        }
+
+        filtered.push_back(bestFilter);
+        filtered.insert(filtered.end(), best.begin(), best.end());
+    }
+
+    std::vector<uint8_t> file(c_signature, c_signature + sizeof(c_signature));
+
+    std::vector<uint8_t> header;
+    AppendBigEndian(header, width);
+    AppendBigEndian(header, height);
+    header.push_back(8); // Bit depth
+    header.push_back(6); // RGBA
+    header.push_back(0); // Deflate
+    header.push_back(0); // Adaptive filtering
+    header.push_back(0); // Not interlaced
+    AppendChunk(file, "IHDR", header.data(), header.size());
+
+    std::vector<uint8_t> compressed;
+    Deflate(filtered, compressed);
+    AppendChunk(file, "IDAT", compressed.data(), compressed.size());
+    AppendChunk(file, "IEND", nullptr, 0);
+
+    std::ofstream stream(GetStreamPath(filename), std::ios::binary);
+    if (!stream.is_open())
+    {
+        return E_INVALIDARG;
+    }
+
+    stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+    return stream.good() ? S_OK : E_FAIL;
+}
+
+HRESULT ReadPng(const wchar_t* filename, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgba)
+{
+    std::ifstream stream(GetStreamPath(filename), std::ios::binary);
+    if (!stream.is_open())
+    {
+        return E_INVALIDARG;
+    }
+
+    const std::vector<uint8_t> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    if (file.size() < sizeof(c_signature) || memcmp(file.data(), c_signature, sizeof(c_signature)) != 0)
+        return E_FAIL;
+
+    uint32_t colorType = 0;
+    bool hasHeader = false;
+    std::vector<uint8_t> compressed;
+
+    size_t offset = sizeof(c_signature);
+    for (;;)
+    {
+        if (file.size() - offset < 12)
+            return E_FAIL;
+
+        const uint32_t length = ReadBigEndian(&file[offset]);
+        if (file.size() - offset - 12 < length)
+            return E_FAIL;
+
+        const uint8_t* type = &file[offset + 4];
+        const uint8_t* data = type + 4;
+        if (ReadBigEndian(data + length) != Crc32(type, length + 4))
+            return E_FAIL;
+
+        if (memcmp(type, "IHDR", 4) == 0)
+        {
+            if (length != 13)
+                return E_FAIL;
+
+            width = ReadBigEndian(data);
+            height = ReadBigEndian(data + 4);
+            colorType = data[9];
+
+            if (width == 0 || height == 0 || width > c_maxDimension || height > c_maxDimension)
+                return E_FAIL;
+
+            // 8-bit samples, deflate, adaptive filtering, no interlacing.
+            if (data[8] != 8 || data[10] != 0 || data[11] != 0 || data[12] != 0)
+                return E_NOTIMPL;
+            if (colorType != 0 && colorType != 2 && colorType != 4 && colorType != 6)
+                return E_NOTIMPL;
+
+            hasHeader = true;
+        }
+        else if (memcmp(type, "IDAT", 4) == 0)
+        {
+            compressed.insert(compressed.end(), data, data + length);
+        }
+        else if (memcmp(type, "IEND", 4) == 0)
+        {
+            break;
+        }
+        else if ((type[0] & 0x20) == 0)
+        {
+            return E_NOTIMPL; // A critical chunk we don't know, such as a palette
+        }
+
+        offset += 12 + length;
+    }
+
+    if (!hasHeader)
+        return E_FAIL;
+
+    const size_t channels = colorType == 0 ? 1 : colorType == 2 ? 3 : colorType == 4 ? 2 : 4;
+    const size_t rowSize = size_t(width) * channels;
+
+    std::vector<uint8_t> filtered;
+    filtered.reserve((rowSize + 1) * height);
+    if (!Inflate(compressed.data(), compressed.size(), filtered) || filtered.size() != (rowSize + 1) * height)
+        return E_FAIL;
+
+    std::vector<uint8_t> pixels(rowSize * height);
+    const std::vector<uint8_t> zeroRow(rowSize, 0);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t filter = filtered[y * (rowSize + 1)];
+        if (filter > 4)
+            return E_FAIL;
+
+        const uint8_t* source = &filtered[y * (rowSize + 1) + 1];
+        uint8_t* row = &pixels[y * rowSize];
+        const uint8_t* prior = y > 0 ? row - rowSize : zeroRow.data();
+
+        for (size_t i = 0; i < rowSize; ++i)
+        {
+            row[i] = static_cast<uint8_t>(source[i] + Predict(filter, row, prior, i, channels));
+        }
+    }
+
+    rgba.resize(size_t(width) * height * 4);
+    for (size_t p = 0; p < size_t(width) * height; ++p)
+    {
+        const uint8_t* source = &pixels[p * channels];
+        uint8_t* dest = &rgba[p * 4];
+
+        switch (colorType)
+        {
+        case 0: dest[0] = dest[1] = dest[2] = source[0]; dest[3] = 255; break;
+        case 2: dest[0] = source[0]; dest[1] = source[1]; dest[2] = source[2]; dest[3] = 255; break;
+        case 4: dest[0] = dest[1] = dest[2] = source[0]; dest[3] = source[1]; break;
+        default: memcpy(dest, source, 4); break;
+        }
+    }
+
+    return S_OK;
+}
+
+ImageDifference CompareImages(const uint8_t* image, const uint8_t* reference, size_t pixelCount, uint32_t tolerance, std::vector<uint8_t>* differences)
+{
+    ImageDifference result = {};
+
+    if (differences)
+    {
+        differences->resize(pixelCount * 4);
+    }
+
+    for (size_t p = 0; p < pixelCount; ++p)
+    {
+        uint32_t pixelDifference = 0;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            const uint32_t difference = static_cast<uint32_t>(std::abs(int32_t(image[p * 4 + c]) - int32_t(reference[p * 4 + c])));
+            pixelDifference = std::max(pixelDifference, difference);
+        }
+
+        result.MaxChannelDifference = std::max(result.MaxChannelDifference, pixelDifference);
+
+        const bool differs = pixelDifference > tolerance;
+        if (differs)
+        {
+            ++result.DifferingPixels;
+        }
+
+        if (differences)
+        {
+            uint8_t* dest = &(*differences)[p * 4];
+            if (differs)
+            {
+                dest[0] = 255;
+                dest[1] = 0;
+                dest[2] = 0;
+            }
+            else
+            {
+                dest[0] = reference[p * 4 + 0] / 4;
+                dest[1] = reference[p * 4 + 1] / 4;
+                dest[2] = reference[p * 4 + 2] / 4;
+            }
+            dest[3] = 255;
+        }
+    }
+
+    return result;
+}
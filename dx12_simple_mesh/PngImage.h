@@ -0,0 +1,41 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Platform.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reading and writing of RGBA8 images as PNG, for rendered frames and the golden images they
+// are compared against.
+//
+// Written files are deflated with the fixed Huffman codes and each row takes whichever filter
+// leaves it smallest, which is enough for rendered frames to compress well. Reading handles
+// 8-bit grayscale, RGB and their alpha variants, non-interlaced, as image editors save them;
+// other formats return E_NOTIMPL.
+
+// Rows are tightly packed RGBA8, top row first.
+HRESULT WritePng(const wchar_t* filename, uint32_t width, uint32_t height, const uint8_t* rgba);
+HRESULT ReadPng(const wchar_t* filename, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgba);
+
+// How far two images of the same size are apart. A pixel differs when any of its channels
+// differs by more than the tolerance.
+struct ImageDifference
+{
+    uint64_t DifferingPixels;
+    uint32_t MaxChannelDifference;
+};
+
+// Compares 'pixelCount' RGBA8 pixels. If 'differences' isn't null it is filled with an image
+// of the comparison: differing pixels in red, over the reference darkened.
+ImageDifference CompareImages(const uint8_t* image, const uint8_t* reference, size_t pixelCount, uint32_t tolerance, std::vector<uint8_t>* differences = nullptr);
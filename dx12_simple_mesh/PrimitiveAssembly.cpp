@@ -0,0 +1,165 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "PrimitiveAssembly.h"
+
+namespace
+{
+    // Group sizes keep each group's locations within the 64 vertices a group outputs; point
+    // lists expand each point to a 4 vertex quad.
+    const PrimitiveTopologyInfo c_topologies[] =
+    {
+        // Topology                                 Verts Step Span Offsets    Strip  Alternate Fan    Group
+        { D3D_PRIMITIVE_TOPOLOGY_POINTLIST,         1,    1,   1,   { 0, 0, 0 }, 0,   false,    false, 16 },
+        { D3D_PRIMITIVE_TOPOLOGY_LINELIST,          2,    2,   2,   { 0, 1, 0 }, 0,   false,    false, 32 },
+        { D3D_PRIMITIVE_TOPOLOGY_LINESTRIP,         2,    1,   2,   { 0, 1, 0 }, 1,   false,    false, 63 },
+        { D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST,      3,    3,   3,   { 0, 1, 2 }, 0,   false,    false, 21 },
+        { D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP,     3,    1,   3,   { 0, 1, 2 }, 1,   true,     false, 62 },
+        { D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN,       3,    1,   3,   { 1, 2, 0 }, 1,   false,    true,  61 },
+        { D3D_PRIMITIVE_TOPOLOGY_LINELIST_ADJ,      2,    4,   4,   { 1, 2, 0 }, 0,   false,    false, 16 },
+        { D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ,     2,    1,   4,   { 1, 2, 0 }, 1,   false,    false, 61 },
+        { D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST_ADJ,  3,    6,   6,   { 0, 2, 4 }, 0,   false,    false, 10 },
+        { D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ, 3,    1,   6,   { 0, 2, 4 }, 2,   true,     false, 59 },
+    };
+
+    void AddPrimitive(std::vector<AssembledPrimitive>& primitives, uint32_t l0, uint32_t l1 = ~0u, uint32_t l2 = ~0u)
+    {
+        AssembledPrimitive primitive = { { l0, l1, l2 } };
+        primitives.push_back(primitive);
+    }
+
+    // Assembles the primitives of one strip, or of a whole list, of locations [first, first + n).
+    void AssembleRun(D3D_PRIMITIVE_TOPOLOGY topology, uint32_t first, uint32_t n, std::vector<AssembledPrimitive>& primitives)
+    {
+        switch (topology)
+        {
+        case D3D_PRIMITIVE_TOPOLOGY_POINTLIST:
+            for (uint32_t i = 0; i < n; ++i)
+                AddPrimitive(primitives, first + i);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_LINELIST:
+            for (uint32_t i = 0; i + 2 <= n; i += 2)
+                AddPrimitive(primitives, first + i, first + i + 1);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_LINESTRIP:
+            for (uint32_t i = 0; i + 2 <= n; ++i)
+                AddPrimitive(primitives, first + i, first + i + 1);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+            for (uint32_t i = 0; i + 3 <= n; i += 3)
+                AddPrimitive(primitives, first + i, first + i + 1, first + i + 2);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+            // Odd triangles swap their first two vertices so the whole strip keeps its winding.
+            for (uint32_t i = 0; i + 3 <= n; ++i)
+            {
+                if (i % 2 == 0)
+                    AddPrimitive(primitives, first + i, first + i + 1, first + i + 2);
+                else
+                    AddPrimitive(primitives, first + i + 1, first + i, first + i + 2);
+            }
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN:
+            // The first vertex is last, so each triangle's first vertex is a new one.
+            for (uint32_t i = 0; i + 3 <= n; ++i)
+                AddPrimitive(primitives, first + i + 1, first + i + 2, first);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_LINELIST_ADJ:
+            for (uint32_t i = 0; i + 4 <= n; i += 4)
+                AddPrimitive(primitives, first + i + 1, first + i + 2);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ:
+            for (uint32_t i = 0; i + 4 <= n; ++i)
+                AddPrimitive(primitives, first + i + 1, first + i + 2);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST_ADJ:
+            for (uint32_t i = 0; i + 6 <= n; i += 6)
+                AddPrimitive(primitives, first + i, first + i + 2, first + i + 4);
+            break;
+
+        case D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ:
+            // Triangles are made of the even vertices; odd ones are adjacency.
+            for (uint32_t k = 0; 2 * k + 6 <= n; ++k)
+            {
+                if (k % 2 == 0)
+                    AddPrimitive(primitives, first + 2 * k, first + 2 * k + 2, first + 2 * k + 4);
+                else
+                    AddPrimitive(primitives, first + 2 * k + 2, first + 2 * k, first + 2 * k + 4);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+const PrimitiveTopologyInfo* GetPrimitiveTopologyInfo(D3D_PRIMITIVE_TOPOLOGY topology)
+{
+    for (const PrimitiveTopologyInfo& info : c_topologies)
+    {
+        if (info.Topology == topology)
+            return &info;
+    }
+
+    return nullptr;
+}
+
+uint32_t GetPrimitiveSlotCount(const PrimitiveTopologyInfo& info, uint32_t locationCount)
+{
+    return locationCount < info.Span ? 0 : (locationCount - info.Span) / info.Step + 1;
+}
+
+uint32_t GetGroupLocationCount(const PrimitiveTopologyInfo& info)
+{
+    return (info.GroupPrimitives - 1) * info.Step + info.Span + (info.Fan ? 1 : 0);
+}
+
+HRESULT AssemblePrimitives(
+    D3D_PRIMITIVE_TOPOLOGY topology,
+    const uint32_t* indices,
+    uint32_t count,
+    uint32_t cutIndex,
+    std::vector<AssembledPrimitive>& primitives)
+{
+    const PrimitiveTopologyInfo* info = GetPrimitiveTopologyInfo(topology);
+    if (info == nullptr)
+        return E_NOTIMPL;
+
+    // Lists treat every index value as a vertex.
+    if (info->StripStride == 0 || indices == nullptr || cutIndex == 0)
+    {
+        AssembleRun(topology, 0, count, primitives);
+        return S_OK;
+    }
+
+    uint32_t stripStart = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (indices[i] == cutIndex)
+        {
+            AssembleRun(topology, stripStart, i - stripStart, primitives);
+            stripStart = i + 1;
+        }
+    }
+
+    AssembleRun(topology, stripStart, count - stripStart, primitives);
+
+    return S_OK;
+}
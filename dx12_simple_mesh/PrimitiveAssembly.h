@@ -0,0 +1,60 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Platform.h"
+
+#include <cstdint>
+#include <vector>
+
+// How the mesh shader assembles a topology from a draw's stream of locations (vertices, or
+// indices for indexed draws). Primitive slots start every Step locations and cover Span of
+// them, the slot's vertices being Offsets into that span. GenerateMeshShaderSource() emits
+// these as the PRIM_* defines of MeshletMS.hlsl.
+struct PrimitiveTopologyInfo
+{
+    D3D_PRIMITIVE_TOPOLOGY Topology;
+    uint32_t VertexCount;       // Vertices per primitive: 1, 2 or 3
+    uint32_t Step;              // Locations between consecutive primitive slots
+    uint32_t Span;              // Locations a slot covers, adjacency included
+    uint32_t Offsets[3];        // The slot's vertices within its span
+    uint32_t StripStride;       // Strips and fans: slots that start a primitive relative to the strip's start. 0 for lists
+    bool     AlternateWinding;  // Odd primitives of a strip swap their first two vertices
+    bool     Fan;               // The last vertex is the strip's first location
+    uint32_t GroupPrimitives;   // Primitive slots per mesh shader group
+};
+
+// Returns null for topologies the mesh shader cannot assemble (patch lists).
+const PrimitiveTopologyInfo* GetPrimitiveTopologyInfo(D3D_PRIMITIVE_TOPOLOGY topology);
+
+// Primitive slots in a run of 'locationCount' locations.
+uint32_t GetPrimitiveSlotCount(const PrimitiveTopologyInfo& info, uint32_t locationCount);
+
+// Locations a full group fetches: its slots' spans, and the fan's first vertex.
+uint32_t GetGroupLocationCount(const PrimitiveTopologyInfo& info);
+
+// A primitive's vertices as draw locations; unused entries are ~0u.
+struct AssembledPrimitive
+{
+    uint32_t Locations[3];
+};
+
+// Reference input assembler: appends the primitives, in rasterization order, formed by a draw
+// of 'count' locations, as locations from 0. 'indices' holds the draw's index values, or is
+// null for non-indexed draws. For strips and fans, index values equal to 'cutIndex' restart
+// the strip; pass 0 to disable restart. Adjacency vertices are skipped, as without a geometry
+// shader. Returns E_NOTIMPL for topologies without GetPrimitiveTopologyInfo().
+HRESULT AssemblePrimitives(
+    D3D_PRIMITIVE_TOPOLOGY topology,
+    const uint32_t* indices,
+    uint32_t count,
+    uint32_t cutIndex,
+    std::vector<AssembledPrimitive>& primitives);
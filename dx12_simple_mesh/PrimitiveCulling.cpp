@@ -0,0 +1,111 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "PrimitiveCulling.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    // Matches HLSL round-to-nearest as used by the shader (floor(x + 0.5)).
+    float RoundNearest(float x)
+    {
+        return std::floor(x + 0.5f);
+    }
+
+    XMFLOAT2 ToScreen(const XMFLOAT4& c, const XMFLOAT2& viewportSize)
+    {
+        const float invW = 1.0f / c.w;
+        return XMFLOAT2(
+            (c.x * invW * 0.5f + 0.5f) * viewportSize.x,
+            (0.5f - c.y * invW * 0.5f) * viewportSize.y);
+    }
+
+    bool IsOutsideFrustum(const XMFLOAT4& c0, const XMFLOAT4& c1, const XMFLOAT4& c2)
+    {
+        return (c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w)
+            || (c0.x >  c0.w && c1.x >  c1.w && c2.x >  c2.w)
+            || (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w)
+            || (c0.y >  c0.w && c1.y >  c1.w && c2.y >  c2.w)
+            || (c0.z <  0.0f && c1.z <  0.0f && c2.z <  0.0f)
+            || (c0.z >  c0.w && c1.z >  c1.w && c2.z >  c2.w);
+    }
+}
+
+bool IsPrimitiveCulled(const XMFLOAT4& c0, const XMFLOAT4& c1, const XMFLOAT4& c2, const XMFLOAT2& viewportSize, uint32_t cullFlags)
+{
+    if (cullFlags == PrimitiveCull::None)
+        return false;
+
+    if ((cullFlags & PrimitiveCull::Frustum) && IsOutsideFrustum(c0, c1, c2))
+        return true;
+
+    // Screen-space tests are only valid when the whole triangle is in front of the eye;
+    // triangles crossing w = 0 are left to the rasterizer's clipper.
+    if (c0.w <= 0.0f || c1.w <= 0.0f || c2.w <= 0.0f)
+        return false;
+
+    const XMFLOAT2 s0 = ToScreen(c0, viewportSize);
+    const XMFLOAT2 s1 = ToScreen(c1, viewportSize);
+    const XMFLOAT2 s2 = ToScreen(c2, viewportSize);
+
+    // Positive area is clockwise in y-down screen space, which is the default front face.
+    const float area = (s1.x - s0.x) * (s2.y - s0.y) - (s2.x - s0.x) * (s1.y - s0.y);
+
+    if ((cullFlags & PrimitiveCull::Degenerate) && area == 0.0f)
+        return true;
+
+    if ((cullFlags & PrimitiveCull::Backface) && area < 0.0f)
+        return true;
+
+    if (cullFlags & PrimitiveCull::SmallPrimitive)
+    {
+        const float minX = std::min(s0.x, std::min(s1.x, s2.x));
+        const float minY = std::min(s0.y, std::min(s1.y, s2.y));
+        const float maxX = std::max(s0.x, std::max(s1.x, s2.x));
+        const float maxY = std::max(s0.y, std::max(s1.y, s2.y));
+
+        // Sample points sit at pixel centers; if both bounds round to the same integer
+        // there is no pixel center between them and the triangle cannot produce coverage.
+        if (RoundNearest(minX) == RoundNearest(maxX) || RoundNearest(minY) == RoundNearest(maxY))
+            return true;
+    }
+
+    return false;
+}
+
+uint32_t CullPrimitives(
+    const XMFLOAT4* clipPositions,
+    const uint32_t* indices,
+    uint32_t primitiveCount,
+    const XMFLOAT2& viewportSize,
+    uint32_t cullFlags,
+    std::vector<uint32_t>& survivors)
+{
+    survivors.clear();
+    survivors.reserve(primitiveCount);
+
+    for (uint32_t i = 0; i < primitiveCount; ++i)
+    {
+        const XMFLOAT4& c0 = clipPositions[indices[i * 3 + 0]];
+        const XMFLOAT4& c1 = clipPositions[indices[i * 3 + 1]];
+        const XMFLOAT4& c2 = clipPositions[indices[i * 3 + 2]];
+
+        if (!IsPrimitiveCulled(c0, c1, c2, viewportSize, cullFlags))
+        {
+            survivors.push_back(i);
+        }
+    }
+
+    return static_cast<uint32_t>(survivors.size());
+}
@@ -0,0 +1,52 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+// CPU reference of the per-primitive culling performed in MeshletMS.hlsl.
+// The math here must be kept in lock-step with the shader so the two produce
+// identical survivor lists for the same clip-space input.
+struct PrimitiveCull
+{
+    enum EFlags : uint32_t
+    {
+        None           = 0,
+        Frustum        = 1 << 0, // All three vertices outside the same clip plane.
+        Degenerate     = 1 << 1, // Zero screen-space area.
+        Backface       = 1 << 2, // Counter-clockwise winding in screen space (D3D12 default front face is clockwise).
+        SmallPrimitive = 1 << 3, // Bounding box does not straddle any pixel-center sample.
+
+        All = Frustum | Degenerate | Backface | SmallPrimitive
+    };
+};
+
+// Returns true if the triangle with clip-space vertices c0, c1, c2 can be rejected
+// under the given cull flags when rasterized into a viewport of the given size.
+bool IsPrimitiveCulled(
+    const DirectX::XMFLOAT4& c0,
+    const DirectX::XMFLOAT4& c1,
+    const DirectX::XMFLOAT4& c2,
+    const DirectX::XMFLOAT2& viewportSize,
+    uint32_t cullFlags);
+
+// Culls a triangle list and writes the surviving primitive indices, in their
+// original order, to 'survivors'. This mirrors the compaction order of the mesh shader.
+// Returns the number of surviving primitives.
+uint32_t CullPrimitives(
+    const DirectX::XMFLOAT4* clipPositions,
+    const uint32_t* indices,
+    uint32_t primitiveCount,
+    const DirectX::XMFLOAT2& viewportSize,
+    uint32_t cullFlags,
+    std::vector<uint32_t>& survivors);
@@ -0,0 +1,137 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Platform.h"
+
+#include <cstdint>
+#include <memory>
+
+// A thin layer over the device objects the renderer records with: buffers, descriptor heaps,
+// command lists, a queue and fences. It follows D3D12 closely, so the D3D12 backend adds
+// little; the null backend (NullRhi.h) records what it's given instead, so submission can be
+// measured and command streams compared on machines without a GPU.
+//
+// Objects of one device are not thread-safe, except buffers mapped for writing.
+
+struct RhiHeapType
+{
+    enum EType : uint32_t
+    {
+        Default,  // GPU local; filled by copies
+        Upload,   // CPU writes, GPU reads
+        Readback, // GPU writes through copies, CPU reads
+    };
+};
+
+// Buffer states, as D3D12 resource states. Barriers name the state before and after.
+struct RhiBufferState
+{
+    enum EType : uint32_t
+    {
+        Common,
+        CopyDest,
+        CopySource,
+        ShaderResource,  // Read by shaders other than the pixel shader
+        UnorderedAccess,
+        GenericRead,     // The state upload buffers stay in
+    };
+};
+
+struct RhiBufferDesc
+{
+    uint64_t              Size;
+    RhiHeapType::EType    Heap;
+    RhiBufferState::EType InitialState;
+    bool                  AllowUnorderedAccess;
+};
+
+class RhiBuffer
+{
+public:
+    virtual ~RhiBuffer() {}
+
+    virtual uint64_t GetSize() const = 0;
+    virtual uint64_t GetGpuAddress() const = 0;
+
+    // Upload and readback buffers only. Mapping may be kept for the buffer's lifetime.
+    virtual void* Map() = 0;
+    virtual void Unmap() = 0;
+};
+
+// Shader visible CBV/SRV/UAV descriptors. Views are written when created, not when a command
+// list executes, so a descriptor mustn't be rewritten while commands using it are in flight.
+class RhiDescriptorHeap
+{
+public:
+    virtual ~RhiDescriptorHeap() {}
+
+    virtual uint32_t GetDescriptorCount() const = 0;
+
+    // A raw (ByteAddressBuffer) view of 'dwordCount' dwords of 'buffer' from 'firstDword'. A
+    // null buffer writes a null view, which reads as zero.
+    virtual void CreateRawBufferView(uint32_t index, RhiBuffer* buffer, uint64_t firstDword, uint32_t dwordCount) = 0;
+};
+
+class RhiFence
+{
+public:
+    virtual ~RhiFence() {}
+
+    virtual uint64_t GetCompletedValue() = 0;
+
+    // Blocks until the fence reaches 'value'.
+    virtual void Wait(uint64_t value) = 0;
+};
+
+// Root parameter indices refer to the root signature of the bound pipeline state.
+class RhiCommandList
+{
+public:
+    virtual ~RhiCommandList() {}
+
+    // Starts recording again; the commands of the previous recording must have completed.
+    virtual HRESULT Reset() = 0;
+    virtual HRESULT Close() = 0;
+
+    virtual void CopyBuffer(RhiBuffer* dest, uint64_t destOffset, RhiBuffer* source, uint64_t sourceOffset, uint64_t size) = 0;
+    virtual void Barrier(RhiBuffer* buffer, RhiBufferState::EType before, RhiBufferState::EType after) = 0;
+
+    virtual void SetDescriptorHeap(RhiDescriptorHeap* heap) = 0;
+    virtual void SetGraphicsRootDescriptorTable(uint32_t rootIndex, RhiDescriptorHeap* heap, uint32_t firstDescriptor) = 0;
+    virtual void SetGraphicsRoot32BitConstants(uint32_t rootIndex, uint32_t count, const void* data, uint32_t firstConstant) = 0;
+    virtual void SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t gpuAddress) = 0;
+
+    virtual void DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
+};
+
+class RhiQueue
+{
+public:
+    virtual ~RhiQueue() {}
+
+    virtual void Submit(RhiCommandList* const* commandLists, uint32_t count) = 0;
+    virtual HRESULT Signal(RhiFence* fence, uint64_t value) = 0;
+};
+
+class RhiDevice
+{
+public:
+    virtual ~RhiDevice() {}
+
+    virtual HRESULT CreateBuffer(const RhiBufferDesc& desc, std::unique_ptr<RhiBuffer>& buffer) = 0;
+    virtual HRESULT CreateDescriptorHeap(uint32_t descriptorCount, std::unique_ptr<RhiDescriptorHeap>& heap) = 0;
+    // Command lists are created closed; Reset() one to record.
+    virtual HRESULT CreateCommandList(std::unique_ptr<RhiCommandList>& commandList) = 0;
+    virtual HRESULT CreateFence(uint64_t initialValue, std::unique_ptr<RhiFence>& fence) = 0;
+
+    virtual RhiQueue* GetQueue() = 0;
+};
@@ -0,0 +1,151 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "RhiDrawTarget.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+RhiDrawTarget::RhiDrawTarget(
+    RhiCommandList* commandList,
+    RhiDescriptorHeap* heap,
+    uint32_t firstDescriptor,
+    uint32_t descriptorCount,
+    RhiBuffer* recordBuffer,
+    uint8_t* recordData,
+    uint64_t recordOffset,
+    uint64_t recordSize)
+    : m_commandList(commandList)
+    , m_heap(heap)
+    , m_firstDescriptor(firstDescriptor)
+    , m_descriptorCount(descriptorCount)
+    , m_nextDescriptor(0)
+    , m_recordBuffer(recordBuffer)
+    , m_recordData(recordData)
+    , m_recordOffset(recordOffset)
+    , m_recordSize(recordSize)
+    , m_nextRecord(0)
+    , m_buffers()
+{
+    // Record views are created like any other raw view.
+    RegisterBuffer(recordBuffer);
+}
+
+void RhiDrawTarget::RegisterBuffer(RhiBuffer* buffer)
+{
+    m_buffers.push_back({ buffer->GetGpuAddress(), buffer->GetSize(), buffer });
+}
+
+void RhiDrawTarget::SetBuffers(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer)
+{
+    const uint32_t first = AllocateDescriptors(1 + c_drawBufferCount);
+
+    // No records, then the one buffer set.
+    uint32_t descriptor = first;
+    CreateRawView(0, 0, descriptor++);
+
+    CreateBufferSetViews(vertexBuffers, indexBuffer, descriptor);
+
+    m_commandList->SetGraphicsRootDescriptorTable(c_drawBuffersRootIndex, m_heap, first);
+}
+
+void RhiDrawTarget::SetPackedDraws(
+    const DrawBufferSet* bufferSets,
+    uint32_t bufferSetCount,
+    const PackedDraw* draws,
+    uint32_t drawCount,
+    const PackedDrawGroup* groups,
+    uint32_t groupCount)
+{
+    const uint64_t drawsSize = uint64_t(drawCount) * sizeof(PackedDraw);
+    const uint64_t recordsSize = drawsSize + uint64_t(groupCount) * sizeof(PackedDrawGroup);
+
+    if (m_nextRecord + recordsSize > m_recordSize)
+    {
+        throw std::length_error("Out of draw record space.");
+    }
+
+    // Records are multiples of 16 bytes, so each batch's stay dword aligned for the raw view.
+    const uint64_t recordOffset = m_recordOffset + m_nextRecord;
+    m_nextRecord += recordsSize;
+
+    memcpy(m_recordData + recordOffset, draws, static_cast<size_t>(drawsSize));
+    memcpy(m_recordData + recordOffset + drawsSize, groups, static_cast<size_t>(recordsSize - drawsSize));
+
+    const uint32_t first = AllocateDescriptors(1 + bufferSetCount * c_drawBufferCount);
+
+    uint32_t descriptor = first;
+    CreateRawView(m_recordBuffer->GetGpuAddress() + recordOffset, static_cast<uint32_t>(recordsSize), descriptor++);
+
+    for (uint32_t i = 0; i < bufferSetCount; ++i)
+    {
+        CreateBufferSetViews(bufferSets[i].VertexBuffers, bufferSets[i].IndexBuffer, descriptor);
+    }
+
+    m_commandList->SetGraphicsRootDescriptorTable(c_drawBuffersRootIndex, m_heap, first);
+}
+
+void RhiDrawTarget::SetDrawParams(const MeshDrawParams& params)
+{
+    m_commandList->SetGraphicsRoot32BitConstants(c_drawParamsRootIndex, sizeof(params) / sizeof(uint32_t), &params, 0);
+}
+
+void RhiDrawTarget::DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    m_commandList->DispatchMesh(groupCountX, groupCountY, groupCountZ);
+}
+
+uint32_t RhiDrawTarget::AllocateDescriptors(uint32_t count)
+{
+    // Tables are read when the command list executes, so none may be reused while recording.
+    if (m_nextDescriptor + count > m_descriptorCount)
+    {
+        throw std::length_error("Out of draw descriptors.");
+    }
+
+    const uint32_t first = m_firstDescriptor + m_nextDescriptor;
+    m_nextDescriptor += count;
+
+    return first;
+}
+
+void RhiDrawTarget::CreateBufferSetViews(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer, uint32_t& descriptor) const
+{
+    for (uint32_t slot = 0; slot < c_maxVertexSlots; ++slot)
+    {
+        CreateRawView(vertexBuffers[slot].BufferLocation, vertexBuffers[slot].SizeInBytes, descriptor++);
+    }
+
+    CreateRawView(indexBuffer.BufferLocation, indexBuffer.SizeInBytes, descriptor++);
+}
+
+void RhiDrawTarget::CreateRawView(uint64_t location, uint32_t size, uint32_t descriptor) const
+{
+    if (size > 0)
+    {
+        for (const Buffer& buffer : m_buffers)
+        {
+            if (location >= buffer.Start && location < buffer.Start + buffer.Size)
+            {
+                // Raw views start on a dword; the view covers every whole dword of the buffer
+                // the range touches.
+                const uint64_t offset = location - buffer.Start;
+                const uint64_t endDword = std::min((offset + size + 3) / 4, buffer.Size / 4);
+
+                m_heap->CreateRawBufferView(descriptor, buffer.Resource, offset / 4, static_cast<uint32_t>(endDword - offset / 4));
+                return;
+            }
+        }
+    }
+
+    // Unbound and unregistered views read as zero.
+    m_heap->CreateRawBufferView(descriptor, nullptr, 0, 0);
+}
@@ -0,0 +1,79 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "FixedFunctionContext.h"
+#include "Rhi.h"
+
+#include <vector>
+
+// Root parameters of MeshletMS.hlsl the draw target sets.
+const uint32_t c_drawParamsRootIndex = 1;
+const uint32_t c_drawBuffersRootIndex = 2;
+
+// Records translated draws on an RHI command list. Buffer views only carry GPU virtual
+// addresses, so the buffers they point into must be registered for raw views to be created
+// over them.
+class RhiDrawTarget : public MeshDrawTarget
+{
+public:
+    // Descriptors [firstDescriptor, firstDescriptor + descriptorCount) of 'heap' are handed out
+    // in order, one table per SetBuffers() or SetPackedDraws(). Packed draw records are written
+    // to [recordOffset, recordOffset + recordSize) of 'recordBuffer', a persistently mapped
+    // upload buffer mapped at 'recordData'. The heap must be set on the command list, both
+    // ranges must outlast the command list, and running out of either throws.
+    RhiDrawTarget(
+        RhiCommandList* commandList,
+        RhiDescriptorHeap* heap,
+        uint32_t firstDescriptor,
+        uint32_t descriptorCount,
+        RhiBuffer* recordBuffer,
+        uint8_t* recordData,
+        uint64_t recordOffset,
+        uint64_t recordSize);
+
+    void RegisterBuffer(RhiBuffer* buffer);
+
+    void SetBuffers(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer) override;
+    void SetPackedDraws(
+        const DrawBufferSet* bufferSets,
+        uint32_t bufferSetCount,
+        const PackedDraw* draws,
+        uint32_t drawCount,
+        const PackedDrawGroup* groups,
+        uint32_t groupCount) override;
+    void SetDrawParams(const MeshDrawParams& params) override;
+    void DispatchMesh(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+
+private:
+    struct Buffer
+    {
+        uint64_t   Start;
+        uint64_t   Size;
+        RhiBuffer* Resource;
+    };
+
+    uint32_t AllocateDescriptors(uint32_t count);
+    void CreateBufferSetViews(const D3D12_VERTEX_BUFFER_VIEW* vertexBuffers, const D3D12_INDEX_BUFFER_VIEW& indexBuffer, uint32_t& descriptor) const;
+    void CreateRawView(uint64_t location, uint32_t size, uint32_t descriptor) const;
+
+    RhiCommandList*     m_commandList;
+    RhiDescriptorHeap*  m_heap;
+    uint32_t            m_firstDescriptor;
+    uint32_t            m_descriptorCount;
+    uint32_t            m_nextDescriptor;
+    RhiBuffer*          m_recordBuffer;
+    uint8_t*            m_recordData;
+    uint64_t            m_recordOffset;
+    uint64_t            m_recordSize;
+    uint64_t            m_nextRecord;
+    std::vector<Buffer> m_buffers;
+};
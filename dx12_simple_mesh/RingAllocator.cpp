@@ -0,0 +1,59 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(uint64_t size)
+    : m_size(size)
+    , m_head(0)
+    , m_tail(0)
+{ }
+
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0 || size > m_size)
+        return InvalidOffset;
+
+    const uint64_t offset = m_head % m_size;
+    uint64_t start = (offset + alignment - 1) & ~(alignment - 1);
+
+    // Skip to the start of the ring rather than split the allocation.
+    uint64_t padding = start - offset;
+    if (start + size > m_size)
+    {
+        padding = m_size - offset;
+        start = 0;
+    }
+
+    if (m_head + padding + size - m_tail > m_size)
+        return InvalidOffset;
+
+    m_head += padding + size;
+    return start;
+}
+
+void RingAllocator::FinishFrame(uint64_t fenceValue)
+{
+    // Frames that allocated nothing have nothing to free.
+    const uint64_t frameStart = m_frames.empty() ? m_tail : m_frames.back().End;
+    if (frameStart == m_head)
+        return;
+
+    m_frames.push_back({ fenceValue, m_head });
+}
+
+void RingAllocator::Reclaim(uint64_t completedFenceValue)
+{
+    while (!m_frames.empty() && m_frames.front().FenceValue <= completedFenceValue)
+    {
+        m_tail = m_frames.front().End;
+        m_frames.pop_front();
+    }
+}
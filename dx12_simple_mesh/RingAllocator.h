@@ -0,0 +1,51 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// Offsets into a ring of 'size' bytes handed out frame by frame. A frame's allocations are
+// freed once the fence value it was finished with completes. Kept free of D3D12 types so it
+// builds on any platform.
+class RingAllocator
+{
+public:
+    static const uint64_t InvalidOffset = ~0ull;
+
+    explicit RingAllocator(uint64_t size);
+
+    // Returns the offset of 'size' bytes aligned to 'alignment', a power of two, or
+    // InvalidOffset when in-flight frames leave no room. Allocations never wrap; the bytes
+    // skipped at the end of the ring are freed with the allocation.
+    uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+    // Everything allocated since the last call is in use until 'fenceValue' completes.
+    void FinishFrame(uint64_t fenceValue);
+
+    // Frees the frames finished with fence values up to 'completedFenceValue'.
+    void Reclaim(uint64_t completedFenceValue);
+
+    uint64_t GetSize() const { return m_size; }
+    uint64_t GetUsedSize() const { return m_head - m_tail; }
+
+private:
+    struct Frame
+    {
+        uint64_t FenceValue;
+        uint64_t End;           // m_head when the frame finished
+    };
+
+    uint64_t          m_size;
+    uint64_t          m_head;   // Bytes ever allocated; the ring offset is this modulo m_size
+    uint64_t          m_tail;   // Bytes ever freed
+    std::deque<Frame> m_frames;
+};
@@ -0,0 +1,310 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "ShaderArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct ShaderArchiveRecord
+{
+    uint64_t Key[2];
+    uint64_t Offset;    // From the start of the file
+    uint64_t Size;
+};
+
+namespace
+{
+    const uint32_t c_archiveMagic = 0x52414853; // "SHAR"
+    const uint32_t c_archiveVersion = 1;
+
+    struct ArchiveHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t EntryCount;
+    };
+
+    bool KeyLess(const ContentHash& a, const ContentHash& b)
+    {
+        return a.Hash[0] != b.Hash[0] ? a.Hash[0] < b.Hash[0] : a.Hash[1] < b.Hash[1];
+    }
+
+    uint64_t AlignUp(uint64_t value)
+    {
+        return (value + 7) & ~uint64_t(7);
+    }
+}
+
+ContentHash ComputeShaderArchiveKey(const ShaderCompileRequest& request)
+{
+    ContentHasher hasher;
+    hasher.AddNumber(c_archiveVersion);
+    hasher.AddString(request.Source);
+    hasher.AddString(request.SourceName);
+    hasher.AddString(request.EntryPoint);
+    hasher.AddString(request.Profile);
+
+    hasher.AddNumber(request.Arguments.size());
+    for (const std::string& argument : request.Arguments)
+    {
+        hasher.AddString(argument);
+    }
+
+    return hasher.GetHash();
+}
+
+void ShaderArchiveWriter::Add(const ContentHash& key, const std::vector<uint8_t>& bytecode)
+{
+    for (auto& entry : m_entries)
+    {
+        if (entry.first == key)
+        {
+            entry.second = bytecode;
+            return;
+        }
+    }
+
+    m_entries.emplace_back(key, bytecode);
+}
+
+bool ShaderArchiveWriter::Write(const std::string& path) const
+{
+    std::vector<const std::pair<ContentHash, std::vector<uint8_t>>*> sorted;
+    for (const auto& entry : m_entries)
+    {
+        sorted.push_back(&entry);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<ContentHash, std::vector<uint8_t>>* a, const std::pair<ContentHash, std::vector<uint8_t>>* b)
+        {
+            return KeyLess(a->first, b->first);
+        });
+
+    ArchiveHeader header = { c_archiveMagic, c_archiveVersion, sorted.size() };
+
+    std::vector<ShaderArchiveRecord> index;
+    uint64_t offset = sizeof(header) + sorted.size() * sizeof(ShaderArchiveRecord);
+    for (const auto* entry : sorted)
+    {
+        ShaderArchiveRecord record = { { entry->first.Hash[0], entry->first.Hash[1] }, offset, entry->second.size() };
+        index.push_back(record);
+        offset = AlignUp(offset + entry->second.size());
+    }
+
+    std::ofstream stream(path, std::ios::binary);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(ShaderArchiveRecord));
+
+    const char padding[8] = {};
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        const std::vector<uint8_t>& bytecode = sorted[i]->second;
+        stream.write(reinterpret_cast<const char*>(bytecode.data()), bytecode.size());
+        stream.write(padding, AlignUp(bytecode.size()) - bytecode.size());
+    }
+
+    stream.close();
+    return !stream.fail();
+}
+
+ShaderArchive::ShaderArchive()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_index(nullptr)
+    , m_entryCount(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#endif
+{ }
+
+ShaderArchive::~ShaderArchive()
+{
+    Close();
+}
+
+bool ShaderArchive::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < LONGLONG(sizeof(ArchiveHeader)))
+    {
+        Close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size >= off_t(sizeof(ArchiveHeader)))
+    {
+        void* data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED)
+        {
+            m_data = static_cast<const uint8_t*>(data);
+            m_size = size_t(status.st_size);
+        }
+    }
+
+    // The mapping outlives the descriptor.
+    close(file);
+#endif
+
+    if (m_data == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    // Every record is checked here, so that Find() can trust the index.
+    ArchiveHeader header;
+    memcpy(&header, m_data, sizeof(header));
+    if (header.Magic != c_archiveMagic || header.Version != c_archiveVersion ||
+        header.EntryCount > (m_size - sizeof(header)) / sizeof(ShaderArchiveRecord))
+    {
+        Close();
+        return false;
+    }
+
+    const ShaderArchiveRecord* index = reinterpret_cast<const ShaderArchiveRecord*>(m_data + sizeof(header));
+    for (uint64_t i = 0; i < header.EntryCount; ++i)
+    {
+        const ShaderArchiveRecord& record = index[i];
+        const bool inFile = record.Offset <= m_size && record.Size <= m_size - record.Offset;
+        const bool sorted = i == 0 || KeyLess(
+            ContentHash{ { index[i - 1].Key[0], index[i - 1].Key[1] } },
+            ContentHash{ { record.Key[0], record.Key[1] } });
+
+        if (!inFile || !sorted)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    m_index = index;
+    m_entryCount = static_cast<uint32_t>(header.EntryCount);
+    return true;
+}
+
+void ShaderArchive::Close()
+{
+#ifdef _WIN32
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_index = nullptr;
+    m_entryCount = 0;
+}
+
+bool ShaderArchive::Find(const ContentHash& key, const uint8_t** bytecode, size_t* size) const
+{
+    const ShaderArchiveRecord* end = m_index + m_entryCount;
+    const ShaderArchiveRecord* record = std::lower_bound(m_index, end, key, [](const ShaderArchiveRecord& a, const ContentHash& b)
+        {
+            return KeyLess(ContentHash{ { a.Key[0], a.Key[1] } }, b);
+        });
+
+    if (record == end || record->Key[0] != key.Hash[0] || record->Key[1] != key.Hash[1])
+        return false;
+
+    *bytecode = m_data + record->Offset;
+    *size = static_cast<size_t>(record->Size);
+    return true;
+}
+
+ArchiveShaderCompiler::ArchiveShaderCompiler(const ShaderArchive* archive, ShaderJobSystem::CompilerFactory fallbackFactory)
+    : m_archive(archive)
+    , m_fallbackFactory(std::move(fallbackFactory))
+    , m_fallbackCreated(false)
+{ }
+
+void ArchiveShaderCompiler::Compile(const ShaderCompileRequest& request, ShaderCompileResult& result)
+{
+    result.Bytecode.clear();
+    result.Errors.clear();
+
+    const uint8_t* bytecode = nullptr;
+    size_t size = 0;
+    if (m_archive != nullptr && m_archive->Find(ComputeShaderArchiveKey(request), &bytecode, &size))
+    {
+        result.Status = 0;
+        result.Bytecode.assign(bytecode, bytecode + size);
+        return;
+    }
+
+    if (!m_fallbackCreated)
+    {
+        m_fallback = m_fallbackFactory ? m_fallbackFactory() : nullptr;
+        m_fallbackCreated = true;
+    }
+
+    if (!m_fallback)
+    {
+        result.Status = c_shaderNotInArchive;
+        result.Errors = request.SourceName + " (" + request.EntryPoint + ", " + request.Profile + ") is not in the shader archive.\n";
+        return;
+    }
+
+    m_fallback->Compile(request, result);
+}
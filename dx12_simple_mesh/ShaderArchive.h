@@ -0,0 +1,95 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "ContentHash.h"
+#include "ShaderJobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Shaders compiled ahead of time into one file: a header, an index of (key, offset, size)
+// records sorted by key, then the bytecode, each blob 8-byte aligned. The file is memory-mapped
+// and looked up in place, so loading it costs a map and an index check, not a read.
+
+// Names a compile in an archive: a hash of the request, source text included. An edited shader
+// misses rather than running stale bytecode, but included files aren't hashed, so the archive
+// must be rebuilt along with the shaders it holds.
+ContentHash ComputeShaderArchiveKey(const ShaderCompileRequest& request);
+
+// Status of a compile an archive can't serve when there is nothing to fall back on, as
+// HRESULT_FROM_WIN32(ERROR_NOT_FOUND).
+const int32_t c_shaderNotInArchive = static_cast<int32_t>(0x80070490);
+
+class ShaderArchiveWriter
+{
+public:
+    // A key added twice keeps its last bytecode.
+    void Add(const ContentHash& key, const std::vector<uint8_t>& bytecode);
+
+    bool Write(const std::string& path) const;
+
+    uint32_t GetEntryCount() const { return static_cast<uint32_t>(m_entries.size()); }
+
+private:
+    std::vector<std::pair<ContentHash, std::vector<uint8_t>>> m_entries;
+};
+
+struct ShaderArchiveRecord;
+
+// A memory-mapped archive. Find() may be called from several threads.
+class ShaderArchive
+{
+public:
+    ShaderArchive();
+    ~ShaderArchive();
+
+    ShaderArchive(const ShaderArchive&) = delete;
+    ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+    // Returns false, leaving the archive empty, if the file is missing or fails its checks.
+    bool Open(const std::string& path);
+    void Close();
+
+    // The bytecode stays valid until Close().
+    bool Find(const ContentHash& key, const uint8_t** bytecode, size_t* size) const;
+
+    uint32_t GetEntryCount() const { return m_entryCount; }
+
+private:
+    const uint8_t*             m_data;
+    size_t                     m_size;
+    const ShaderArchiveRecord* m_index;
+    uint32_t                   m_entryCount;
+#ifdef _WIN32
+    void*                      m_file;
+    void*                      m_mapping;
+#endif
+};
+
+// Serves compiles from an archive and hands those it lacks to a compiler created on the first
+// miss, so that a fully archived run never loads the fallback (or DXC's DLL). A factory that
+// returns null makes misses fail with c_shaderNotInArchive.
+class ArchiveShaderCompiler : public ShaderCompiler
+{
+public:
+    ArchiveShaderCompiler(const ShaderArchive* archive, ShaderJobSystem::CompilerFactory fallbackFactory);
+
+    void Compile(const ShaderCompileRequest& request, ShaderCompileResult& result) override;
+
+private:
+    const ShaderArchive*             m_archive;
+    ShaderJobSystem::CompilerFactory m_fallbackFactory;
+    std::unique_ptr<ShaderCompiler>  m_fallback;
+    bool                             m_fallbackCreated;
+};
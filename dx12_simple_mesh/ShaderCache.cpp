@@ -0,0 +1,452 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <unordered_set>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <direct.h>
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    const uint32_t c_entryMagic = 0x58444853; // "SHDX"
+    const uint32_t c_indexMagic = 0x58494353; // "SCIX"
+    const uint32_t c_formatVersion = 1;
+
+    struct EntryHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Key[2];
+        uint64_t Size;      // Bytecode bytes following the header
+        uint64_t Checksum;  // FNV-1a of the bytecode
+    };
+
+    struct IndexHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t EntryCount;
+    };
+
+    struct IndexRecord
+    {
+        uint64_t Key[2];
+        uint64_t Size;
+        uint64_t LastUse;
+    };
+
+    uint64_t HashBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    std::string GetDirectory(const std::string& path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    bool IsAbsolutePath(const std::string& path)
+    {
+        return (!path.empty() && (path[0] == '/' || path[0] == '\\')) || (path.size() > 1 && path[1] == ':');
+    }
+
+    // Returns the name of an #include directive on 'line', or false if it holds none.
+    bool ParseInclude(const std::string& line, std::string& name)
+    {
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string::npos || line[i] != '#')
+            return false;
+
+        i = line.find_first_not_of(" \t", i + 1);
+        if (i == std::string::npos || line.compare(i, 7, "include") != 0)
+            return false;
+
+        i = line.find_first_not_of(" \t", i + 7);
+        if (i == std::string::npos || (line[i] != '"' && line[i] != '<'))
+            return false;
+
+        const char close = line[i] == '"' ? '"' : '>';
+        size_t end = line.find(close, i + 1);
+        if (end == std::string::npos)
+            return false;
+
+        name = line.substr(i + 1, end - i - 1);
+        return true;
+    }
+
+    bool CreateDirectoryIfMissing(const std::string& path)
+    {
+#ifdef _WIN32
+        return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+        return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+    }
+
+    // Renames 'from' to 'to' in one step, replacing any file already there.
+    bool RenameReplacing(const std::string& from, const std::string& to)
+    {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    // Writes the buffers to a uniquely named temporary file next to 'path', then renames it
+    // over 'path'.
+    bool WriteFileAtomically(const std::string& path, const void* header, size_t headerSize, const void* data, size_t size)
+    {
+        std::random_device random;
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), ".%08x%08x.tmp", random(), random());
+
+        const std::string temporaryPath = path + suffix;
+
+        bool written;
+        {
+            std::ofstream stream(temporaryPath, std::ios::binary);
+            stream.write(static_cast<const char*>(header), headerSize);
+            stream.write(static_cast<const char*>(data), size);
+            stream.close();
+            written = !stream.fail();
+        }
+
+        if (!written || !RenameReplacing(temporaryPath, path))
+        {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+}
+
+bool ReadFileContents(const std::string& path, std::string& contents)
+{
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream)
+        return false;
+
+    contents.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0, std::ios::beg);
+    return static_cast<bool>(stream.read(&contents[0], contents.size()));
+}
+
+void CollectShaderIncludes(
+    const std::string& source,
+    const std::string& sourceName,
+    const ReadFileFunction& readFile,
+    std::vector<std::pair<std::string, std::string>>& includes)
+{
+    const std::string sourceDirectory = GetDirectory(sourceName);
+
+    std::unordered_set<std::string> seen;
+    std::vector<std::pair<std::string, std::string>> pending; // Including file's directory, text
+    pending.emplace_back(sourceDirectory, source);
+
+    while (!pending.empty())
+    {
+        const std::string directory = pending.back().first;
+        const std::string text = std::move(pending.back().second);
+        pending.pop_back();
+
+        std::vector<std::pair<std::string, std::string>> found;
+
+        size_t lineStart = 0;
+        while (lineStart < text.size())
+        {
+            size_t lineEnd = text.find('\n', lineStart);
+            if (lineEnd == std::string::npos)
+            {
+                lineEnd = text.size();
+            }
+
+            std::string name;
+            if (ParseInclude(text.substr(lineStart, lineEnd - lineStart), name))
+            {
+                std::string path = IsAbsolutePath(name) ? name : directory + name;
+                std::string contents;
+                bool resolved = readFile(path, contents);
+
+                if (!resolved && !IsAbsolutePath(name) && directory != sourceDirectory)
+                {
+                    path = sourceDirectory + name;
+                    resolved = readFile(path, contents);
+                }
+
+                if (seen.insert(path).second)
+                {
+                    includes.emplace_back(path, resolved ? contents : std::string());
+                    if (resolved)
+                    {
+                        found.emplace_back(GetDirectory(path), std::move(contents));
+                    }
+                }
+            }
+
+            lineStart = lineEnd + 1;
+        }
+
+        // Visit the file's includes in the order they appear.
+        for (auto it = found.rbegin(); it != found.rend(); ++it)
+        {
+            pending.push_back(std::move(*it));
+        }
+    }
+}
+
+ShaderCacheKey ComputeShaderCacheKey(const ShaderCompileInputs& inputs, const ReadFileFunction& readFile)
+{
+    ContentHasher hasher;
+    hasher.AddNumber(c_formatVersion);
+    hasher.AddString(inputs.Source);
+    hasher.AddString(inputs.SourceName);
+    hasher.AddString(inputs.EntryPoint);
+    hasher.AddString(inputs.Profile);
+    hasher.AddString(inputs.CompilerVersion);
+
+    hasher.AddNumber(inputs.Arguments.size());
+    for (const std::string& argument : inputs.Arguments)
+    {
+        hasher.AddString(argument);
+    }
+
+    std::vector<std::pair<std::string, std::string>> includes;
+    CollectShaderIncludes(inputs.Source, inputs.SourceName, readFile, includes);
+
+    hasher.AddNumber(includes.size());
+    for (const auto& include : includes)
+    {
+        hasher.AddString(include.first);
+        hasher.AddString(include.second);
+    }
+
+    return hasher.GetHash();
+}
+
+ShaderCache::ShaderCache(const std::string& directory, uint64_t maxSize)
+    : m_directory(directory)
+    , m_maxSize(maxSize)
+    , m_size(0)
+    , m_useCounter(0)
+    , m_indexDirty(false)
+    , m_hitCount(0)
+    , m_missCount(0)
+{
+    CreateDirectoryIfMissing(m_directory);
+    LoadIndex();
+}
+
+ShaderCache::~ShaderCache()
+{
+    Flush();
+}
+
+bool ShaderCache::Load(const ShaderCacheKey& key, std::vector<uint8_t>& bytecode)
+{
+    const std::string path = GetEntryPath(key);
+
+    // Files are read outside the lock; an entry evicted meanwhile just reads as a miss.
+    bool valid = false;
+    std::ifstream stream(path, std::ios::binary);
+    if (stream)
+    {
+        EntryHeader header;
+        if (stream.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            header.Magic == c_entryMagic &&
+            header.Version == c_formatVersion &&
+            header.Key[0] == key.Hash[0] &&
+            header.Key[1] == key.Hash[1] &&
+            header.Size <= m_maxSize)
+        {
+            bytecode.resize(static_cast<size_t>(header.Size));
+            valid = stream.read(reinterpret_cast<char*>(bytecode.data()), bytecode.size()) &&
+                HashBytes(bytecode.data(), bytecode.size()) == header.Checksum;
+        }
+
+        stream.close();
+
+        if (!valid)
+        {
+            std::remove(path.c_str());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!valid)
+    {
+        Remove(key);
+        ++m_missCount;
+        return false;
+    }
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        Entry entry = { sizeof(EntryHeader) + bytecode.size(), 0 };
+        it = m_entries.emplace(key, entry).first;
+        m_size += entry.Size;
+    }
+
+    it->second.LastUse = ++m_useCounter;
+    m_indexDirty = true;
+    ++m_hitCount;
+
+    return true;
+}
+
+bool ShaderCache::Store(const ShaderCacheKey& key, const uint8_t* bytecode, size_t size)
+{
+    const uint64_t entrySize = sizeof(EntryHeader) + size;
+    if (entrySize > m_maxSize)
+        return false;
+
+    EntryHeader header = {};
+    header.Magic = c_entryMagic;
+    header.Version = c_formatVersion;
+    header.Key[0] = key.Hash[0];
+    header.Key[1] = key.Hash[1];
+    header.Size = size;
+    header.Checksum = HashBytes(bytecode, size);
+
+    if (!WriteFileAtomically(GetEntryPath(key), &header, sizeof(header), bytecode, size))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry& entry = m_entries[key];
+    m_size = m_size - entry.Size + entrySize;
+    entry.Size = entrySize;
+    entry.LastUse = ++m_useCounter;
+    m_indexDirty = true;
+
+    Evict(key);
+
+    return true;
+}
+
+void ShaderCache::Flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_indexDirty)
+        return;
+
+    std::vector<IndexRecord> records;
+    records.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+    {
+        IndexRecord record = { { entry.first.Hash[0], entry.first.Hash[1] }, entry.second.Size, entry.second.LastUse };
+        records.push_back(record);
+    }
+
+    IndexHeader header = { c_indexMagic, c_formatVersion, records.size() };
+    if (WriteFileAtomically(m_directory + "/index.bin", &header, sizeof(header), records.data(), records.size() * sizeof(IndexRecord)))
+    {
+        m_indexDirty = false;
+    }
+}
+
+std::string ShaderCache::GetEntryPath(const ShaderCacheKey& key) const
+{
+    return m_directory + "/" + key.ToString() + ".dxil";
+}
+
+void ShaderCache::LoadIndex()
+{
+    std::ifstream stream(m_directory + "/index.bin", std::ios::binary);
+    if (!stream)
+        return;
+
+    IndexHeader header;
+    if (stream.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.Magic == c_indexMagic && header.Version == c_formatVersion)
+    {
+        IndexRecord record;
+        for (uint64_t i = 0; i < header.EntryCount && stream.read(reinterpret_cast<char*>(&record), sizeof(record)); ++i)
+        {
+            ShaderCacheKey key = { { record.Key[0], record.Key[1] } };
+            Entry entry = { record.Size, record.LastUse };
+
+            if (m_entries.emplace(key, entry).second)
+            {
+                m_size += entry.Size;
+                m_useCounter = std::max(m_useCounter, entry.LastUse);
+            }
+        }
+    }
+
+    stream.close();
+
+    // Entries the index lists may have been evicted by another process since; such entries
+    // read as misses and leave the index then. Evict now in case the size limit shrank.
+    Evict(ShaderCacheKey());
+}
+
+void ShaderCache::Evict(const ShaderCacheKey& keep)
+{
+    if (m_size <= m_maxSize)
+        return;
+
+    std::vector<std::pair<uint64_t, ShaderCacheKey>> byAge;
+    byAge.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+    {
+        if (!(entry.first == keep))
+        {
+            byAge.emplace_back(entry.second.LastUse, entry.first);
+        }
+    }
+
+    std::sort(byAge.begin(), byAge.end(),
+        [](const std::pair<uint64_t, ShaderCacheKey>& a, const std::pair<uint64_t, ShaderCacheKey>& b) { return a.first < b.first; });
+
+    for (size_t i = 0; i < byAge.size() && m_size > m_maxSize; ++i)
+    {
+        std::remove(GetEntryPath(byAge[i].second).c_str());
+        Remove(byAge[i].second);
+    }
+}
+
+void ShaderCache::Remove(const ShaderCacheKey& key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return;
+
+    m_size -= it->second.Size;
+    m_entries.erase(it);
+    m_indexDirty = true;
+}
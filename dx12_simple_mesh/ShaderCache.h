@@ -0,0 +1,111 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "ContentHash.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// On-disk cache of compiled shaders, addressed by a hash of everything a compile reads. Only
+// the C runtime's file functions are used, plus directory creation and replacing renames, so
+// the cache and its keys behave the same on Windows and elsewhere.
+
+// Hash of a compile's inputs; names the cache entry.
+using ShaderCacheKey = ContentHash;
+
+// Everything besides included files that decides a compile's output.
+struct ShaderCompileInputs
+{
+    std::string              Source;
+    std::string              SourceName;      // Path the source is compiled as; includes resolve from its directory
+    std::string              EntryPoint;
+    std::string              Profile;
+    std::vector<std::string> Arguments;
+    std::string              CompilerVersion; // So that updating the compiler misses
+};
+
+// Reads a whole file; returns false if it can't be read.
+using ReadFileFunction = std::function<bool(const std::string& path, std::string& contents)>;
+
+bool ReadFileContents(const std::string& path, std::string& contents);
+
+// Follows the #include directives of 'source', compiled as 'sourceName', and those of the files
+// they name, appending each file found as its path and contents, in first-seen order. Quoted
+// names resolve relative to the including file, then to the source's directory. Directives are
+// followed whatever #if they sit in, and names that don't resolve are appended with empty
+// contents, so the set over-approximates what the compiler reads.
+void CollectShaderIncludes(
+    const std::string& source,
+    const std::string& sourceName,
+    const ReadFileFunction& readFile,
+    std::vector<std::pair<std::string, std::string>>& includes);
+
+// Hashes the inputs and every file CollectShaderIncludes() finds.
+ShaderCacheKey ComputeShaderCacheKey(const ShaderCompileInputs& inputs, const ReadFileFunction& readFile = ReadFileContents);
+
+// Compiled shaders stored one file per key in a directory. Entries are written to a temporary
+// file and renamed into place, so a reader never sees a partial entry and processes sharing
+// the directory at worst compile the same shader twice. Each entry carries a checksum; entries
+// that fail it are deleted and read as misses. Once the entries exceed 'maxSize' bytes, the
+// least recently used are evicted. Recency is kept in an index file written by Flush(), which
+// the destructor calls; entries the index doesn't know of are adopted when first loaded. Load()
+// and Store() may be called from several threads.
+class ShaderCache
+{
+public:
+    ShaderCache(const std::string& directory, uint64_t maxSize);
+    ~ShaderCache();
+
+    bool Load(const ShaderCacheKey& key, std::vector<uint8_t>& bytecode);
+
+    // Entries larger than the cache are not stored. Returns false if nothing was stored.
+    bool Store(const ShaderCacheKey& key, const uint8_t* bytecode, size_t size);
+
+    void Flush();
+
+    uint64_t GetSize() const { return m_size; }
+    uint32_t GetEntryCount() const { return static_cast<uint32_t>(m_entries.size()); }
+    uint32_t GetHitCount() const { return m_hitCount; }
+    uint32_t GetMissCount() const { return m_missCount; }
+
+private:
+    struct Entry
+    {
+        uint64_t Size;      // Of the entry's file
+        uint64_t LastUse;   // m_useCounter when last loaded or stored
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const ShaderCacheKey& key) const { return static_cast<size_t>(key.Hash[0]); }
+    };
+
+    std::string GetEntryPath(const ShaderCacheKey& key) const;
+    void LoadIndex();
+    void Evict(const ShaderCacheKey& keep);
+    void Remove(const ShaderCacheKey& key);
+
+    std::string                                            m_directory;
+    uint64_t                                               m_maxSize;
+    std::mutex                                             m_mutex;
+    std::unordered_map<ShaderCacheKey, Entry, KeyHash>     m_entries;
+    uint64_t                                               m_size;
+    uint64_t                                               m_useCounter;
+    bool                                                   m_indexDirty;
+    uint32_t                                               m_hitCount;
+    uint32_t                                               m_missCount;
+};
@@ -0,0 +1,167 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "ShaderJobSystem.h"
+#include "ThreadCount.h"
+
+struct ShaderJobSystem::Job
+{
+    std::function<void(ShaderCompiler&)> Run;
+    uint32_t                             PendingDependencies;
+    std::vector<JobRef>                  Dependents; // Jobs waiting on this one
+    bool                                 Finished;
+};
+
+ShaderJobSystem::ShaderJobSystem(CompilerFactory factory, uint32_t threadCount)
+    : m_factory(std::move(factory))
+    , m_unfinishedJobCount(0)
+    , m_stopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = GetDefaultThreadCount();
+    }
+
+    m_threads.reserve(threadCount);
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        m_threads.emplace_back(&ShaderJobSystem::WorkerMain, this);
+    }
+}
+
+ShaderJobSystem::~ShaderJobSystem()
+{
+    WaitIdle();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_jobReady.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+ShaderTask ShaderJobSystem::Compile(ShaderCompileRequest request)
+{
+    auto promise = std::make_shared<std::promise<ShaderCompileResult>>();
+
+    ShaderTask task;
+    task.Result = promise->get_future().share();
+    task.Job = Submit({}, [promise, request](ShaderCompiler& compiler)
+        {
+            try
+            {
+                ShaderCompileResult result = {};
+                compiler.Compile(request, result);
+                promise->set_value(std::move(result));
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+
+    return task;
+}
+
+void ShaderJobSystem::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_unfinishedJobCount == 0; });
+}
+
+ShaderJobSystem::JobRef ShaderJobSystem::Submit(const std::vector<JobRef>& dependencies, std::function<void(ShaderCompiler&)> run)
+{
+    JobRef job = std::make_shared<Job>();
+    job->Run = std::move(run);
+    job->PendingDependencies = 0;
+    job->Finished = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        ++m_unfinishedJobCount;
+
+        for (const JobRef& dependency : dependencies)
+        {
+            if (dependency && !dependency->Finished)
+            {
+                dependency->Dependents.push_back(job);
+                ++job->PendingDependencies;
+            }
+        }
+
+        if (job->PendingDependencies == 0)
+        {
+            m_readyJobs.push_back(job);
+        }
+    }
+
+    m_jobReady.notify_one();
+    return job;
+}
+
+void ShaderJobSystem::WorkerMain()
+{
+    std::unique_ptr<ShaderCompiler> compiler = m_factory();
+
+    for (;;)
+    {
+        JobRef job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [this] { return m_stopping || !m_readyJobs.empty(); });
+
+            if (m_readyJobs.empty())
+                return;
+
+            job = std::move(m_readyJobs.front());
+            m_readyJobs.pop_front();
+        }
+
+        job->Run(*compiler);
+
+        uint32_t readied = 0;
+        bool idle;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            job->Finished = true;
+            job->Run = nullptr; // Releases what the job captured
+
+            for (JobRef& dependent : job->Dependents)
+            {
+                if (--dependent->PendingDependencies == 0)
+                {
+                    m_readyJobs.push_back(std::move(dependent));
+                    ++readied;
+                }
+            }
+            job->Dependents.clear();
+
+            idle = --m_unfinishedJobCount == 0;
+        }
+
+        // This worker takes one of the jobs itself on its next turn.
+        for (uint32_t i = 1; i < readied; ++i)
+        {
+            m_jobReady.notify_one();
+        }
+
+        if (idle)
+        {
+            m_idle.notify_all();
+        }
+    }
+}
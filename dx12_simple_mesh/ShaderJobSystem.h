@@ -0,0 +1,128 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Shader compiles and the work that consumes them, run on a pool of threads. The compiler is
+// behind an interface, so scheduling runs the same with DXC or with a stand-in.
+
+struct ShaderCompileRequest
+{
+    std::string              Source;
+    std::string              SourceName;  // Path the source is compiled as; includes resolve from its directory
+    std::string              EntryPoint;
+    std::string              Profile;
+    std::vector<std::string> Arguments;   // Besides the entry point and profile
+};
+
+struct ShaderCompileResult
+{
+    int32_t              Status;      // Negative on failure, as an HRESULT
+    std::vector<uint8_t> Bytecode;
+    std::string          Errors;      // Compiler diagnostics
+};
+
+// A compiler owned by one worker thread, so implementations needn't be thread-safe.
+class ShaderCompiler
+{
+public:
+    virtual ~ShaderCompiler() {}
+
+    virtual void Compile(const ShaderCompileRequest& request, ShaderCompileResult& result) = 0;
+};
+
+// A thread pool whose workers each create their own ShaderCompiler. Jobs may depend on other
+// jobs and only become runnable once those have finished, so no worker ever blocks waiting
+// for another job. Each job's result is delivered through a future; exceptions a job throws
+// are rethrown from its future.
+class ShaderJobSystem
+{
+public:
+    // Called once on each worker thread as it starts. Must not throw; a compiler that can't be
+    // created should fail each compile instead.
+    using CompilerFactory = std::function<std::unique_ptr<ShaderCompiler>()>;
+
+    struct Job;
+    using JobRef = std::shared_ptr<Job>;
+
+    template <typename T>
+    struct Task
+    {
+        JobRef                Job;    // To make other jobs depend on this one
+        std::shared_future<T> Result;
+    };
+
+    // Passing a threadCount of 0 uses every hardware thread.
+    explicit ShaderJobSystem(CompilerFactory factory, uint32_t threadCount = 0);
+
+    // Waits for every job submitted, then stops the workers.
+    ~ShaderJobSystem();
+
+    Task<ShaderCompileResult> Compile(ShaderCompileRequest request);
+
+    // Runs 'function' on a worker once every job of 'dependencies' has finished, whether it
+    // succeeded or not; 'function' can read their futures without blocking. T can't be void.
+    template <typename T>
+    Task<T> Then(const std::vector<JobRef>& dependencies, std::function<T()> function);
+
+    // Blocks until every job submitted so far has finished.
+    void WaitIdle();
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+
+private:
+    JobRef Submit(const std::vector<JobRef>& dependencies, std::function<void(ShaderCompiler&)> run);
+    void WorkerMain();
+
+    CompilerFactory          m_factory;
+    std::mutex               m_mutex;
+    std::condition_variable  m_jobReady;
+    std::condition_variable  m_idle;
+    std::deque<JobRef>       m_readyJobs;
+    uint32_t                 m_unfinishedJobCount;
+    bool                     m_stopping;
+    std::vector<std::thread> m_threads;
+};
+
+template <typename T>
+ShaderJobSystem::Task<T> ShaderJobSystem::Then(const std::vector<JobRef>& dependencies, std::function<T()> function)
+{
+    auto promise = std::make_shared<std::promise<T>>();
+
+    Task<T> task;
+    task.Result = promise->get_future().share();
+    task.Job = Submit(dependencies, [promise, function](ShaderCompiler&)
+        {
+            try
+            {
+                promise->set_value(function());
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+
+    return task;
+}
+
+using ShaderTask = ShaderJobSystem::Task<ShaderCompileResult>;
@@ -0,0 +1,466 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "SoftwareRasterizer.h"
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFTWARE_RASTERIZER_SSE 1
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // Triangles are clipped to this many viewports around the real one, which keeps screen
+    // coordinates small enough for float edge functions without changing what is covered.
+    const float c_guardBand = 4.0f;
+
+    // Vertex positions snap to 1/256 of a pixel, the subpixel precision D3D12 requires.
+    const float c_subpixelSteps = 256.0f;
+
+    // Triangles of the output set up by one work item.
+    const uint32_t c_setupBatchSize = 4096;
+
+    const uint32_t c_maxClippedVertices = 9; // A triangle clipped by six planes
+
+    // Signed distance of a clip-space vertex inside each clip plane.
+    float PlaneDistance(const XMFLOAT4& v, uint32_t plane)
+    {
+        switch (plane)
+        {
+        case 0: return v.z;                         // Near
+        case 1: return v.w - v.z;                   // Far
+        case 2: return c_guardBand * v.w + v.x;     // Left
+        case 3: return c_guardBand * v.w - v.x;     // Right
+        case 4: return c_guardBand * v.w + v.y;     // Bottom
+        default: return c_guardBand * v.w - v.y;    // Top
+        }
+    }
+
+    XMFLOAT4 Lerp(const XMFLOAT4& a, const XMFLOAT4& b, float t)
+    {
+        return XMFLOAT4(
+            a.x + (b.x - a.x) * t,
+            a.y + (b.y - a.y) * t,
+            a.z + (b.z - a.z) * t,
+            a.w + (b.w - a.w) * t);
+    }
+
+    float Snap(float value)
+    {
+        return std::floor(value * c_subpixelSteps + 0.5f) / c_subpixelSteps;
+    }
+
+    // MeshletPS.hlsl: the color is SV_Position, written to an RGBA8_UNORM target.
+    uint32_t ToUnorm8(float value)
+    {
+        return static_cast<uint32_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    uint32_t ShadePixel(float x, float y, float z, float w)
+    {
+        return ToUnorm8(x) | (ToUnorm8(y) << 8) | (ToUnorm8(z) << 16) | (ToUnorm8(w) << 24);
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer()
+    : m_width(0)
+    , m_height(0)
+    , m_pitch(0)
+    , m_tilesX(0)
+    , m_tilesY(0)
+{ }
+
+void SoftwareRasterizer::Init(uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+    m_tilesX = (width + TileSize - 1) / TileSize;
+    m_tilesY = (height + TileSize - 1) / TileSize;
+    m_pitch = m_tilesX * TileSize;
+
+    m_color.assign(m_pitch * m_tilesY * TileSize, 0);
+    m_depth.assign(m_pitch * m_tilesY * TileSize, 1.0f);
+    m_tileBins.resize(m_tilesX * m_tilesY);
+}
+
+void SoftwareRasterizer::Clear(const float color[4], float depth)
+{
+    std::fill(m_color.begin(), m_color.end(), ShadePixel(color[0], color[1], color[2], color[3]));
+    std::fill(m_depth.begin(), m_depth.end(), depth);
+}
+
+void SoftwareRasterizer::SetupTriangle(const XMFLOAT4& c0, const XMFLOAT4& c1, const XMFLOAT4& c2, std::vector<ScreenTriangle>& triangles) const
+{
+    const XMFLOAT4* clip[3] = { &c0, &c1, &c2 };
+
+    const float width = static_cast<float>(m_width);
+    const float height = static_cast<float>(m_height);
+
+    XMFLOAT2 s[3];
+    float z[3];
+    float invW[3];
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        invW[i] = 1.0f / clip[i]->w;
+        s[i].x = Snap((clip[i]->x * invW[i] * 0.5f + 0.5f) * width);
+        s[i].y = Snap((0.5f - clip[i]->y * invW[i] * 0.5f) * height);
+        z[i] = clip[i]->z * invW[i];
+    }
+
+    // Clockwise (front facing) triangles have positive area in y-down screen space; the rest
+    // are culled, as are triangles with no area.
+    const float area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[2].x - s[0].x) * (s[1].y - s[0].y);
+    if (!(area > 0.0f))
+        return;
+
+    const float minX = std::min(s[0].x, std::min(s[1].x, s[2].x));
+    const float minY = std::min(s[0].y, std::min(s[1].y, s[2].y));
+    const float maxX = std::max(s[0].x, std::max(s[1].x, s[2].x));
+    const float maxY = std::max(s[0].y, std::max(s[1].y, s[2].y));
+
+    // Pixels whose centers lie within the bounds.
+    ScreenTriangle tri;
+    tri.MinX = std::max(0, static_cast<int32_t>(std::ceil(minX - 0.5f)));
+    tri.MinY = std::max(0, static_cast<int32_t>(std::ceil(minY - 0.5f)));
+    tri.MaxX = std::min(static_cast<int32_t>(m_width) - 1, static_cast<int32_t>(std::floor(maxX - 0.5f)));
+    tri.MaxY = std::min(static_cast<int32_t>(m_height) - 1, static_cast<int32_t>(std::floor(maxY - 0.5f)));
+
+    if (tri.MinX > tri.MaxX || tri.MinY > tri.MaxY)
+        return;
+
+    // Work relative to the first pixel of the bounds to keep the edge functions precise.
+    tri.OriginX = static_cast<float>(tri.MinX);
+    tri.OriginY = static_cast<float>(tri.MinY);
+
+    XMFLOAT2 v[3];
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        v[i] = XMFLOAT2(s[i].x - tri.OriginX, s[i].y - tri.OriginY);
+    }
+
+    // Edge functions are positive inside. The constant term is biased by half a pixel so that
+    // evaluating at integer offsets from the origin samples pixel centers. Pixels exactly on an
+    // edge belong to the triangle if the edge is a top edge (horizontal, with the triangle
+    // below) or a left edge.
+    tri.TopLeft = 0;
+    for (uint32_t e = 0; e < 3; ++e)
+    {
+        const XMFLOAT2& a = v[e];
+        const XMFLOAT2& b = v[(e + 1) % 3];
+
+        tri.EdgeA[e] = a.y - b.y;
+        tri.EdgeB[e] = b.x - a.x;
+        tri.EdgeC[e] = a.x * b.y - a.y * b.x + 0.5f * (tri.EdgeA[e] + tri.EdgeB[e]);
+
+        if (tri.EdgeA[e] > 0.0f || (tri.EdgeA[e] == 0.0f && tri.EdgeB[e] > 0.0f))
+        {
+            tri.TopLeft |= 1u << e;
+        }
+    }
+
+    // Depth and 1/w vary linearly in screen space. Planes are evaluated at the origin pixel's center.
+    const float invArea = 1.0f / area;
+    const float* attributes[2] = { z, invW };
+    float* planes[2] = { tri.Z, tri.InvW };
+    for (uint32_t p = 0; p < 2; ++p)
+    {
+        const float* a = attributes[p];
+        float* plane = planes[p];
+
+        plane[1] = ((a[1] - a[0]) * (v[2].y - v[0].y) - (a[2] - a[0]) * (v[1].y - v[0].y)) * invArea;
+        plane[2] = ((v[1].x - v[0].x) * (a[2] - a[0]) - (v[2].x - v[0].x) * (a[1] - a[0])) * invArea;
+        plane[0] = a[0] + plane[1] * (0.5f - v[0].x) + plane[2] * (0.5f - v[0].y);
+    }
+
+    triangles.push_back(tri);
+}
+
+void SoftwareRasterizer::SetupClippedTriangle(const XMFLOAT4* clip, std::vector<ScreenTriangle>& triangles) const
+{
+    // Most triangles need no clipping; those entirely outside one plane need no drawing.
+    uint32_t outsideAll = 0x3f;
+    uint32_t outsideAny = 0;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        uint32_t outside = 0;
+        for (uint32_t plane = 0; plane < 6; ++plane)
+        {
+            if (PlaneDistance(clip[i], plane) < 0.0f)
+            {
+                outside |= 1u << plane;
+            }
+        }
+
+        outsideAll &= outside;
+        outsideAny |= outside;
+    }
+
+    if (outsideAll != 0)
+        return;
+
+    if (outsideAny == 0)
+    {
+        SetupTriangle(clip[0], clip[1], clip[2], triangles);
+        return;
+    }
+
+    // Clip the polygon by each plane a vertex is outside of, then draw it as a fan.
+    XMFLOAT4 polygon[2][c_maxClippedVertices];
+    uint32_t count = 3;
+    std::copy(clip, clip + 3, polygon[0]);
+
+    uint32_t current = 0;
+    for (uint32_t plane = 0; plane < 6 && count >= 3; ++plane)
+    {
+        if ((outsideAny & (1u << plane)) == 0)
+            continue;
+
+        const XMFLOAT4* in = polygon[current];
+        XMFLOAT4* out = polygon[current ^ 1];
+        uint32_t outCount = 0;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const XMFLOAT4& a = in[i];
+            const XMFLOAT4& b = in[(i + 1) % count];
+            const float da = PlaneDistance(a, plane);
+            const float db = PlaneDistance(b, plane);
+
+            if (da >= 0.0f)
+            {
+                out[outCount++] = a;
+            }
+
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                out[outCount++] = Lerp(a, b, da / (da - db));
+            }
+        }
+
+        count = outCount;
+        current ^= 1;
+    }
+
+    for (uint32_t i = 1; i + 1 < count; ++i)
+    {
+        SetupTriangle(polygon[current][0], polygon[current][i], polygon[current][i + 1], triangles);
+    }
+}
+
+void SoftwareRasterizer::Draw(const MeshShaderOutput& output, uint32_t threadCount)
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(output.Indices.size() / 3);
+    const uint32_t batchCount = (triangleCount + c_setupBatchSize - 1) / c_setupBatchSize;
+
+    // Clip and set up triangles in parallel, keeping them in output order.
+    std::vector<std::vector<ScreenTriangle>> perBatch(batchCount);
+    ParallelFor(batchCount, [&](uint32_t batch, uint32_t)
+    {
+        const uint32_t first = batch * c_setupBatchSize;
+        const uint32_t last = std::min(first + c_setupBatchSize, triangleCount);
+
+        for (uint32_t t = first; t < last; ++t)
+        {
+            const XMFLOAT4 clip[3] =
+            {
+                output.Positions[output.Indices[t * 3 + 0]],
+                output.Positions[output.Indices[t * 3 + 1]],
+                output.Positions[output.Indices[t * 3 + 2]],
+            };
+
+            SetupClippedTriangle(clip, perBatch[batch]);
+        }
+    }, threadCount);
+
+    m_triangles.clear();
+    for (auto& tris : perBatch)
+    {
+        m_triangles.insert(m_triangles.end(), tris.begin(), tris.end());
+    }
+
+    // Bin triangles into every tile their pixel bounds overlap.
+    for (auto& bin : m_tileBins)
+    {
+        bin.clear();
+    }
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_triangles.size()); ++i)
+    {
+        const ScreenTriangle& tri = m_triangles[i];
+
+        for (int32_t ty = tri.MinY / TileSize; ty <= tri.MaxY / static_cast<int32_t>(TileSize); ++ty)
+        {
+            for (int32_t tx = tri.MinX / TileSize; tx <= tri.MaxX / static_cast<int32_t>(TileSize); ++tx)
+            {
+                m_tileBins[ty * m_tilesX + tx].push_back(i);
+            }
+        }
+    }
+
+    ParallelFor(m_tilesX * m_tilesY, [&](uint32_t tile, uint32_t)
+    {
+        RasterizeTile(tile);
+    }, threadCount);
+}
+
+void SoftwareRasterizer::RasterizeTile(uint32_t tileIndex)
+{
+    const int32_t tileX = static_cast<int32_t>((tileIndex % m_tilesX) * TileSize);
+    const int32_t tileY = static_cast<int32_t>((tileIndex / m_tilesX) * TileSize);
+
+    for (uint32_t triIndex : m_tileBins[tileIndex])
+    {
+        const ScreenTriangle& tri = m_triangles[triIndex];
+
+        // Start on a 4-pixel boundary; lanes outside the triangle fail the coverage test on their own.
+        const int32_t minX = std::max(tri.MinX, tileX) & ~3;
+        const int32_t maxX = std::min(tri.MaxX, tileX + static_cast<int32_t>(TileSize) - 1);
+        const int32_t minY = std::max(tri.MinY, tileY);
+        const int32_t maxY = std::min(tri.MaxY, tileY + static_cast<int32_t>(TileSize) - 1);
+
+#if SOFTWARE_RASTERIZER_SSE
+        const __m128 laneOffsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 unormScale = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        __m128 topLeft[3];
+        for (uint32_t e = 0; e < 3; ++e)
+        {
+            topLeft[e] = _mm_castsi128_ps(_mm_set1_epi32((tri.TopLeft >> e) & 1 ? -1 : 0));
+        }
+
+        // The shader's color channels, saturated and scaled to UNORM8.
+        auto toUnorm8 = [&](__m128 value)
+        {
+            value = _mm_min_ps(_mm_max_ps(value, zero), one);
+            return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, unormScale), half));
+        };
+
+        for (int32_t y = minY; y <= maxY; ++y)
+        {
+            uint32_t* colorRow = m_color.data() + y * m_pitch;
+            float* depthRow = m_depth.data() + y * m_pitch;
+
+            const __m128 py = _mm_set1_ps(static_cast<float>(y) - tri.OriginY);
+            const __m128i green = toUnorm8(_mm_set1_ps(static_cast<float>(y) + 0.5f));
+
+            for (int32_t x = minX; x <= maxX; x += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x) - tri.OriginX), laneOffsets);
+
+                __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (uint32_t e = 0; e < 3; ++e)
+                {
+                    const __m128 edge = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(tri.EdgeA[e])), _mm_mul_ps(py, _mm_set1_ps(tri.EdgeB[e]))),
+                        _mm_set1_ps(tri.EdgeC[e]));
+                    const __m128 inside = _mm_or_ps(_mm_cmpgt_ps(edge, zero), _mm_and_ps(_mm_cmpeq_ps(edge, zero), topLeft[e]));
+                    mask = _mm_and_ps(mask, inside);
+                }
+
+                if (_mm_movemask_ps(mask) == 0)
+                    continue;
+
+                __m128 z = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(tri.Z[1])), _mm_mul_ps(py, _mm_set1_ps(tri.Z[2]))),
+                    _mm_set1_ps(tri.Z[0]));
+                z = _mm_min_ps(_mm_max_ps(z, zero), one);
+
+                const __m128 depth = _mm_loadu_ps(depthRow + x);
+                mask = _mm_and_ps(mask, _mm_cmplt_ps(z, depth));
+
+                if (_mm_movemask_ps(mask) == 0)
+                    continue;
+
+                _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, depth)));
+
+                const __m128 invW = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(tri.InvW[1])), _mm_mul_ps(py, _mm_set1_ps(tri.InvW[2]))),
+                    _mm_set1_ps(tri.InvW[0]));
+                const __m128 w = _mm_div_ps(one, invW);
+
+                const __m128i red = toUnorm8(_mm_add_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets), half));
+                const __m128i blue = toUnorm8(z);
+                const __m128i alpha = toUnorm8(w);
+
+                const __m128i shaded = _mm_or_si128(
+                    _mm_or_si128(red, _mm_slli_epi32(green, 8)),
+                    _mm_or_si128(_mm_slli_epi32(blue, 16), _mm_slli_epi32(alpha, 24)));
+
+                const __m128i color = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colorRow + x));
+                const __m128i colorMask = _mm_castps_si128(mask);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(colorRow + x),
+                    _mm_or_si128(_mm_and_si128(colorMask, shaded), _mm_andnot_si128(colorMask, color)));
+            }
+        }
+#else
+        for (int32_t y = minY; y <= maxY; ++y)
+        {
+            uint32_t* colorRow = m_color.data() + y * m_pitch;
+            float* depthRow = m_depth.data() + y * m_pitch;
+
+            const float py = static_cast<float>(y) - tri.OriginY;
+
+            for (int32_t x = minX; x <= maxX; ++x)
+            {
+                const float px = static_cast<float>(x) - tri.OriginX;
+
+                bool covered = true;
+                for (uint32_t e = 0; e < 3; ++e)
+                {
+                    const float edge = (px * tri.EdgeA[e] + py * tri.EdgeB[e]) + tri.EdgeC[e];
+                    covered &= edge > 0.0f || (edge == 0.0f && ((tri.TopLeft >> e) & 1) != 0);
+                }
+
+                if (!covered)
+                    continue;
+
+                const float z = std::min(std::max((px * tri.Z[1] + py * tri.Z[2]) + tri.Z[0], 0.0f), 1.0f);
+                if (!(z < depthRow[x]))
+                    continue;
+
+                const float w = 1.0f / ((px * tri.InvW[1] + py * tri.InvW[2]) + tri.InvW[0]);
+
+                depthRow[x] = z;
+                colorRow[x] = ShadePixel(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, z, w);
+            }
+        }
+#endif
+    }
+}
+
+void SoftwareRasterizer::ReadPixels(std::vector<uint8_t>& rgba) const
+{
+    rgba.resize(size_t(m_width) * m_height * 4);
+
+    for (uint32_t y = 0; y < m_height; ++y)
+    {
+        const uint32_t* row = m_color.data() + y * m_pitch;
+        uint8_t* dest = rgba.data() + size_t(y) * m_width * 4;
+
+        for (uint32_t x = 0; x < m_width; ++x)
+        {
+            dest[x * 4 + 0] = static_cast<uint8_t>(row[x]);
+            dest[x * 4 + 1] = static_cast<uint8_t>(row[x] >> 8);
+            dest[x * 4 + 2] = static_cast<uint8_t>(row[x] >> 16);
+            dest[x * 4 + 3] = static_cast<uint8_t>(row[x] >> 24);
+        }
+    }
+}
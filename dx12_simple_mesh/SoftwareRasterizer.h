@@ -0,0 +1,86 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "MeshShaderExecutor.h"
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+// Rasterizes what the CPU mesh shader executor outputs the way the sample's pipeline state
+// does on a GPU, so frames can be rendered and checked on machines without one:
+//
+//  - Triangles are clipped to 0 <= z <= w and a guard band, and culled unless clockwise in
+//    screen space (the default rasterizer state).
+//  - Coverage is sampled at pixel centers from vertices snapped to 1/256 of a pixel, with
+//    the top-left fill rule.
+//  - Depth is tested LESS against a float buffer and written, as D3D12_DEFAULT depth does.
+//  - Covered pixels are shaded by MeshletPS.hlsl, which outputs SV_Position as the color,
+//    into an RGBA8_UNORM target.
+//
+// Triangles are set up in parallel, binned into screen tiles and the tiles rasterized in
+// parallel, four pixels at a time. Each tile takes its triangles in output order, so images
+// come out the same whatever the thread count.
+class SoftwareRasterizer
+{
+public:
+    static const uint32_t TileSize = 32; // Square tile edge in pixels; also the unit of parallel work.
+
+    SoftwareRasterizer();
+
+    // Sizes the render target and depth buffer.
+    void Init(uint32_t width, uint32_t height);
+
+    void Clear(const float color[4], float depth = 1.0f);
+
+    // Draws the triangles of 'output', whose positions are the mesh shader's SV_Position. A
+    // threadCount of 0 uses all cores.
+    void Draw(const MeshShaderOutput& output, uint32_t threadCount = 0);
+
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+
+    // The render target as tightly packed RGBA8 rows, top row first.
+    void ReadPixels(std::vector<uint8_t>& rgba) const;
+    float GetDepth(uint32_t x, uint32_t y) const { return m_depth[y * m_pitch + x]; }
+
+private:
+    // Screen-space triangle prepared for rasterization, in pixels relative to the triangle's
+    // origin: edge functions that are positive inside, and planes of depth and 1/w.
+    struct ScreenTriangle
+    {
+        float    OriginX, OriginY;
+        float    EdgeA[3];
+        float    EdgeB[3];
+        float    EdgeC[3];
+        uint32_t TopLeft;   // Bit e set when edge e is a top or left edge
+        float    Z[3];      // Plane: Z[0] + Z[1] * x + Z[2] * y
+        float    InvW[3];
+        int32_t  MinX, MinY, MaxX, MaxY;
+    };
+
+    void SetupTriangle(const DirectX::XMFLOAT4& c0, const DirectX::XMFLOAT4& c1, const DirectX::XMFLOAT4& c2, std::vector<ScreenTriangle>& triangles) const;
+    void SetupClippedTriangle(const DirectX::XMFLOAT4* clip, std::vector<ScreenTriangle>& triangles) const;
+    void RasterizeTile(uint32_t tileIndex);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_pitch;   // Pixels per row of the buffers, a whole number of tiles
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+
+    std::vector<ScreenTriangle>              m_triangles;
+    std::vector<std::vector<uint32_t>>       m_tileBins;
+
+    std::vector<uint32_t> m_color;  // RGBA8, red in the low byte
+    std::vector<float>    m_depth;
+};
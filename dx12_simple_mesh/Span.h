@@ -38,6 +38,8 @@ public:
     // Iterator interface
     T* begin() { return m_data; }
     T* end() { return m_data + m_count; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_count; }
 
     T& operator[](uint32_t i) { return *(m_data + i); }
     const T& operator[](uint32_t i) const { return *(m_data + i); }
@@ -11,10 +11,31 @@
 
 #pragma once
 
+#include "Platform.h"
+#include "FrameTimeLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
 // Helper class for animation and simulation timing.
+//
+// Time is read from std::chrono::steady_clock, so the timer behaves the same on every platform.
+// Besides the once-a-second frame rate it keeps the wall-clock time of recent frames, for
+// percentiles that show stutters an average hides, and a histogram of every frame since the
+// last reset.
 class StepTimer
 {
 public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Frames the percentiles are taken over; ten seconds at 60 fps.
+    static const UINT32 FrameTimeWindow = 600;
+
+    // Histogram buckets are a millisecond wide; the last holds every frame at least that long.
+    static const UINT32 HistogramBucketCount = 34;
+
     StepTimer() :
         m_elapsedTicks(0),
         m_totalTicks(0),
@@ -22,15 +43,17 @@ public:
         m_frameCount(0),
         m_framesPerSecond(0),
         m_framesThisSecond(0),
-        m_qpcSecondCounter(0),
+        m_secondCounter(Clock::duration::zero()),
         m_isFixedTimeStep(false),
-        m_targetElapsedTicks(TicksPerSecond / 60)
+        m_targetElapsedTicks(TicksPerSecond / 60),
+        m_frameTimes(FrameTimeWindow),
+        m_frameTimeCount(0),
+        m_histogram{}
     {
-        QueryPerformanceFrequency(&m_qpcFrequency);
-        QueryPerformanceCounter(&m_qpcLastTime);
+        m_lastTime = Clock::now();
 
         // Initialize max delta to 1/10 of a second.
-        m_qpcMaxDelta = m_qpcFrequency.QuadPart / 10;
+        m_maxDelta = std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(100));
     }
 
     // Get elapsed time since the previous Update call.
@@ -60,18 +83,38 @@ public:
     static double TicksToSeconds(UINT64 ticks)            { return static_cast<double>(ticks) / TicksPerSecond; }
     static UINT64 SecondsToTicks(double seconds)        { return static_cast<UINT64>(seconds * TicksPerSecond); }
 
+    // Wall-clock milliseconds between the last FrameTimeWindow calls to Tick(), summarized.
+    // Frames are timed as they happened, before the clamp that protects the simulation.
+    FrameTimeStats GetFrameTimeStats() const
+    {
+        const size_t count = m_frameTimeCount < FrameTimeWindow ? m_frameTimeCount : FrameTimeWindow;
+
+        std::vector<double> samples(m_frameTimes.begin(), m_frameTimes.begin() + count);
+        return ComputeFrameTimeStats(samples);
+    }
+
+    // Frames since the last reset whose time fell in each bucket.
+    const UINT32* GetFrameTimeHistogram() const         { return m_histogram; }
+    static double GetHistogramBucketMilliseconds(UINT32 bucket) { return static_cast<double>(bucket); }
+
+    void ResetFrameTimeStats()
+    {
+        m_frameTimeCount = 0;
+        std::fill(m_histogram, m_histogram + HistogramBucketCount, 0u);
+    }
+
     // After an intentional timing discontinuity (for instance a blocking IO operation)
     // call this to avoid having the fixed timestep logic attempt a set of catch-up 
     // Update calls.
 
     void ResetElapsedTime()
     {
-        QueryPerformanceCounter(&m_qpcLastTime);
+        m_lastTime = Clock::now();
 
         m_leftOverTicks = 0;
         m_framesPerSecond = 0;
         m_framesThisSecond = 0;
-        m_qpcSecondCounter = 0;
+        m_secondCounter = Clock::duration::zero();
     }
 
     typedef void(*LPUPDATEFUNC) (void);
@@ -79,25 +122,27 @@ public:
     // Update timer state, calling the specified Update function the appropriate number of times.
     void Tick(LPUPDATEFUNC update = nullptr)
     {
-        // Query the current time.
-        LARGE_INTEGER currentTime;
+        Tick(Clock::now(), update);
+    }
 
-        QueryPerformanceCounter(&currentTime);
+    // As Tick(), with the clock read as 'currentTime', which must not go backwards.
+    void Tick(Clock::time_point currentTime, LPUPDATEFUNC update = nullptr)
+    {
+        Clock::duration clockDelta = currentTime - m_lastTime;
 
-        UINT64 timeDelta = currentTime.QuadPart - m_qpcLastTime.QuadPart;
+        m_lastTime = currentTime;
+        m_secondCounter += clockDelta;
 
-        m_qpcLastTime = currentTime;
-        m_qpcSecondCounter += timeDelta;
+        RecordFrameTime(clockDelta);
 
         // Clamp excessively large time deltas (e.g. after paused in the debugger).
-        if (timeDelta > m_qpcMaxDelta)
+        if (clockDelta > m_maxDelta)
         {
-            timeDelta = m_qpcMaxDelta;
+            clockDelta = m_maxDelta;
         }
 
-        // Convert QPC units into a canonical tick format. This cannot overflow due to the previous clamp.
-        timeDelta *= TicksPerSecond;
-        timeDelta /= m_qpcFrequency.QuadPart;
+        // Convert clock units into a canonical tick format.
+        UINT64 timeDelta = static_cast<UINT64>(std::chrono::duration_cast<Ticks>(clockDelta).count());
 
         UINT32 lastFrameCount = m_frameCount;
 
@@ -152,19 +197,47 @@ public:
             m_framesThisSecond++;
         }
 
-        if (m_qpcSecondCounter >= static_cast<UINT64>(m_qpcFrequency.QuadPart))
+        if (m_secondCounter >= std::chrono::seconds(1))
         {
             m_framesPerSecond = m_framesThisSecond;
             m_framesThisSecond = 0;
-            m_qpcSecondCounter %= m_qpcFrequency.QuadPart;
+            m_secondCounter %= std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1));
+        }
+    }
+
+    // Advance by exactly one target timestep without reading the clock, so that a headless run
+    // steps through the same simulation times however long each frame takes. Such frames
+    // aren't timed; the run measures them itself.
+    void TickFixed(LPUPDATEFUNC update = nullptr)
+    {
+        m_elapsedTicks = m_targetElapsedTicks;
+        m_totalTicks += m_targetElapsedTicks;
+        m_leftOverTicks = 0;
+        m_frameCount++;
+
+        if (update)
+        {
+            update();
         }
     }
 
 private:
-    // Source timing data uses QPC units.
-    LARGE_INTEGER m_qpcFrequency;
-    LARGE_INTEGER m_qpcLastTime;
-    UINT64 m_qpcMaxDelta;
+    typedef std::chrono::duration<int64_t, std::ratio<1, TicksPerSecond>> Ticks;
+
+    void RecordFrameTime(Clock::duration frameTime)
+    {
+        const double milliseconds = std::chrono::duration<double, std::milli>(frameTime).count();
+
+        m_frameTimes[m_frameTimeCount % FrameTimeWindow] = milliseconds;
+        m_frameTimeCount++;
+
+        const UINT32 bucket = milliseconds < HistogramBucketCount - 1 ? static_cast<UINT32>(milliseconds) : HistogramBucketCount - 1;
+        m_histogram[bucket]++;
+    }
+
+    // Source timing data uses the clock's units.
+    Clock::time_point m_lastTime;
+    Clock::duration m_maxDelta;
 
     // Derived timing data uses a canonical tick format.
     UINT64 m_elapsedTicks;
@@ -175,9 +248,14 @@ private:
     UINT32 m_frameCount;
     UINT32 m_framesPerSecond;
     UINT32 m_framesThisSecond;
-    UINT64 m_qpcSecondCounter;
+    Clock::duration m_secondCounter;
 
     // Members for configuring fixed timestep mode.
     bool m_isFixedTimeStep;
     UINT64 m_targetElapsedTicks;
+
+    // Frame times of the last FrameTimeWindow frames, in milliseconds, written round robin.
+    std::vector<double> m_frameTimes;
+    UINT64 m_frameTimeCount;
+    UINT32 m_histogram[HistogramBucketCount];
 };
@@ -0,0 +1,195 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "stdafx.h"
+#include "StreamOutBuffer.h"
+
+#include "DXSampleHelper.h"
+
+namespace
+{
+    // Captured geometry is read by later passes and copied to the readback buffers.
+    const D3D12_RESOURCE_STATES c_readState =
+        D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+        D3D12_RESOURCE_STATE_INDEX_BUFFER |
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+        D3D12_RESOURCE_STATE_COPY_SOURCE;
+
+    const UINT64 c_vertexSize = sizeof(float) * 4;
+    const UINT64 c_maxIndicesPerPrimitive = 3;
+
+    UINT64 GetVertexBytes(uint32_t vertexCapacity)
+    {
+        return vertexCapacity * c_vertexSize;
+    }
+
+    UINT64 GetIndexBytes(uint32_t primitiveCapacity)
+    {
+        return primitiveCapacity * c_maxIndicesPerPrimitive * sizeof(uint32_t);
+    }
+}
+
+StreamOutBuffer::StreamOutBuffer(uint32_t vertexCapacity, uint32_t primitiveCapacity, uint32_t readbackCount)
+    : m_vertexCapacity(vertexCapacity)
+    , m_primitiveCapacity(primitiveCapacity)
+    , m_readbacks(readbackCount)
+    , m_countersState(c_readState)
+    , m_buffersState(c_readState)
+{ }
+
+void StreamOutBuffer::Create(ID3D12Device* device)
+{
+    const CD3DX12_HEAP_PROPERTIES defaultHeap(D3D12_HEAP_TYPE_DEFAULT);
+    const CD3DX12_HEAP_PROPERTIES readbackHeap(D3D12_HEAP_TYPE_READBACK);
+
+    const UINT64 sizes[] = { sizeof(StreamOutCounters), GetVertexBytes(m_vertexCapacity), GetIndexBytes(m_primitiveCapacity) };
+    ID3D12Resource** buffers[] = { &m_counters, &m_vertices, &m_indices };
+
+    for (uint32_t i = 0; i < _countof(buffers); ++i)
+    {
+        const CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(sizes[i], D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+        ThrowIfFailed(device->CreateCommittedResource(
+            &defaultHeap,
+            D3D12_HEAP_FLAG_NONE,
+            &bufferDesc,
+            c_readState,
+            nullptr,
+            IID_PPV_ARGS(buffers[i])));
+    }
+
+    NAME_D3D12_OBJECT(m_counters);
+    NAME_D3D12_OBJECT(m_vertices);
+    NAME_D3D12_OBJECT(m_indices);
+
+    const CD3DX12_RESOURCE_DESC readbackDesc = CD3DX12_RESOURCE_DESC::Buffer(sizes[0] + sizes[1] + sizes[2]);
+    for (auto& readback : m_readbacks)
+    {
+        ThrowIfFailed(device->CreateCommittedResource(
+            &readbackHeap,
+            D3D12_HEAP_FLAG_NONE,
+            &readbackDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(&readback)));
+
+        NAME_D3D12_OBJECT(readback);
+    }
+}
+
+void StreamOutBuffer::Begin(ID3D12GraphicsCommandList2* commandList)
+{
+    Transition(commandList, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+    D3D12_WRITEBUFFERIMMEDIATE_PARAMETER zeros[sizeof(StreamOutCounters) / sizeof(uint32_t)];
+    for (uint32_t i = 0; i < _countof(zeros); ++i)
+    {
+        zeros[i].Dest = m_counters->GetGPUVirtualAddress() + i * sizeof(uint32_t);
+        zeros[i].Value = 0;
+    }
+
+    commandList->WriteBufferImmediate(_countof(zeros), zeros, nullptr);
+
+    Transition(commandList, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+}
+
+void StreamOutBuffer::Bind(ID3D12GraphicsCommandList* commandList) const
+{
+    commandList->SetGraphicsRootUnorderedAccessView(c_streamOutRootIndex + 0, m_counters->GetGPUVirtualAddress());
+    commandList->SetGraphicsRootUnorderedAccessView(c_streamOutRootIndex + 1, m_vertices->GetGPUVirtualAddress());
+    commandList->SetGraphicsRootUnorderedAccessView(c_streamOutRootIndex + 2, m_indices->GetGPUVirtualAddress());
+}
+
+void StreamOutBuffer::End(ID3D12GraphicsCommandList* commandList, uint32_t readback)
+{
+    Transition(commandList, c_readState, c_readState);
+
+    // The whole capacity is copied, as the counts aren't known until the GPU is done.
+    ID3D12Resource* destination = m_readbacks[readback].Get();
+    const UINT64 vertexBytes = GetVertexBytes(m_vertexCapacity);
+
+    commandList->CopyBufferRegion(destination, 0, m_counters.Get(), 0, sizeof(StreamOutCounters));
+    commandList->CopyBufferRegion(destination, sizeof(StreamOutCounters), m_vertices.Get(), 0, vertexBytes);
+    commandList->CopyBufferRegion(destination, sizeof(StreamOutCounters) + vertexBytes, m_indices.Get(), 0, GetIndexBytes(m_primitiveCapacity));
+}
+
+void StreamOutBuffer::Read(uint32_t readback, uint32_t flags, uint32_t verticesPerPrimitive, StreamOutResults& results) const
+{
+    ID3D12Resource* source = m_readbacks[readback].Get();
+    const size_t vertexBytes = size_t(GetVertexBytes(m_vertexCapacity));
+
+    const uint8_t* data = nullptr;
+    CD3DX12_RANGE readRange(0, size_t(source->GetDesc().Width));
+    ThrowIfFailed(source->Map(0, &readRange, reinterpret_cast<void**>(const_cast<uint8_t**>(&data))));
+
+    StreamOutCounters counters;
+    memcpy(&counters, data, sizeof(counters));
+
+    results.VertexCount = counters.VerticesWritten;
+    results.PrimitivesWritten = counters.PrimitivesWritten;
+    results.PrimitivesNeeded = counters.PrimitiveCount;
+
+    const float* vertices = reinterpret_cast<const float*>(data + sizeof(StreamOutCounters));
+    results.Vertices.assign(vertices, vertices + size_t(results.VertexCount) * 4);
+
+    // Expanded captures write their vertices in primitive order and no indices.
+    results.Indices.clear();
+    if (flags & StreamOut::Indexed)
+    {
+        const uint32_t* indices = reinterpret_cast<const uint32_t*>(data + sizeof(StreamOutCounters) + vertexBytes);
+        results.Indices.assign(indices, indices + size_t(results.PrimitivesWritten) * verticesPerPrimitive);
+    }
+
+    CD3DX12_RANGE writtenRange(0, 0);
+    source->Unmap(0, &writtenRange);
+}
+
+D3D12_VERTEX_BUFFER_VIEW StreamOutBuffer::GetVertexBufferView() const
+{
+    D3D12_VERTEX_BUFFER_VIEW view;
+    view.BufferLocation = m_vertices->GetGPUVirtualAddress();
+    view.SizeInBytes = static_cast<UINT>(GetVertexBytes(m_vertexCapacity));
+    view.StrideInBytes = static_cast<UINT>(c_vertexSize);
+    return view;
+}
+
+D3D12_INDEX_BUFFER_VIEW StreamOutBuffer::GetIndexBufferView() const
+{
+    D3D12_INDEX_BUFFER_VIEW view;
+    view.BufferLocation = m_indices->GetGPUVirtualAddress();
+    view.SizeInBytes = static_cast<UINT>(GetIndexBytes(m_primitiveCapacity));
+    view.Format = DXGI_FORMAT_R32_UINT;
+    return view;
+}
+
+void StreamOutBuffer::Transition(ID3D12GraphicsCommandList* commandList, D3D12_RESOURCE_STATES countersState, D3D12_RESOURCE_STATES buffersState)
+{
+    CD3DX12_RESOURCE_BARRIER barriers[3];
+    UINT barrierCount = 0;
+
+    if (countersState != m_countersState)
+    {
+        barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(m_counters.Get(), m_countersState, countersState);
+    }
+
+    if (buffersState != m_buffersState)
+    {
+        barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(m_vertices.Get(), m_buffersState, buffersState);
+        barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(m_indices.Get(), m_buffersState, buffersState);
+    }
+
+    if (barrierCount != 0)
+    {
+        commandList->ResourceBarrier(barrierCount, barriers);
+    }
+
+    m_countersState = countersState;
+    m_buffersState = buffersState;
+}
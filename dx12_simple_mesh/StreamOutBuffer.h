@@ -0,0 +1,103 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <vector>
+
+// Root parameters of MeshletMS.hlsl a StreamOutBuffer binds: the counters (u1), vertices (u2)
+// and indices (u3), as root UAVs.
+const uint32_t c_streamOutRootIndex = 5;
+
+// Must match the STREAM_OUT_* defines in MeshletMS.hlsl.
+struct StreamOut
+{
+    enum EFlags : uint32_t
+    {
+        None       = 0,
+        Enabled    = 1 << 0, // Append every assembled primitive, culled or not, to the bound buffers.
+        Indexed    = 1 << 1, // Write each group's vertices once and index them; otherwise each primitive writes its own vertices, as D3D stream output does.
+        WorldSpace = 1 << 2, // Write positions transformed by World only, for passes with other views; otherwise clip space.
+    };
+};
+
+// Mirrors the counters MeshletMS.hlsl appends through. Groups reserve vertices and primitives
+// with one 64-bit atomic add on the first two, so the groups that fit are those reserved first.
+struct StreamOutCounters
+{
+    uint32_t VertexCount;       // Vertices reserved, including those of groups that didn't fit
+    uint32_t PrimitiveCount;    // Primitives reserved, the same way
+    uint32_t PrimitivesWritten;
+    uint32_t VerticesWritten;
+};
+
+// What one capture wrote, read back from the GPU.
+struct StreamOutResults
+{
+    uint32_t              VertexCount;       // Vertices written
+    uint32_t              PrimitivesWritten;
+    uint32_t              PrimitivesNeeded;  // Primitives assembled, dropped ones included
+    std::vector<float>    Vertices;          // Four floats per vertex
+    std::vector<uint32_t> Indices;           // Of each primitive written; empty unless StreamOut::Indexed
+};
+
+// Stream output emulation: the mesh shader appends post-transform vertices and primitives to
+// these buffers through atomic counters, one reservation per group, so groups append in the
+// order they run and primitives keep their order only within a group. Once a group doesn't
+// fit, it and every group reserved after it write nothing and are counted as dropped. Captured
+// geometry can be drawn by later passes (shadows, a depth prepass) through
+// GetVertexBufferView() and GetIndexBufferView(), or copied to readback buffers and read on
+// the CPU once the capturing frame's fence has completed.
+class StreamOutBuffer
+{
+public:
+    // 'readbackCount' readback buffers let that many captures be in flight, one per frame.
+    StreamOutBuffer(uint32_t vertexCapacity, uint32_t primitiveCapacity, uint32_t readbackCount);
+
+    void Create(ID3D12Device* device);
+
+    // Clears the counters and makes the buffers writable by the mesh shader.
+    void Begin(ID3D12GraphicsCommandList2* commandList);
+
+    // Binds the buffers at c_streamOutRootIndex. The root signature needs them bound whether or
+    // not StreamOut::Enabled is set.
+    void Bind(ID3D12GraphicsCommandList* commandList) const;
+
+    // Ends the capture started by Begin(): copies it to readback buffer 'readback' and makes the
+    // buffers readable as vertex, index and shader resource buffers.
+    void End(ID3D12GraphicsCommandList* commandList, uint32_t readback);
+
+    // Reads readback buffer 'readback'. Call once the fence of the frame that ended a capture
+    // into it has completed, with the StreamOut::EFlags and vertices per primitive it used.
+    void Read(uint32_t readback, uint32_t flags, uint32_t verticesPerPrimitive, StreamOutResults& results) const;
+
+    // Float4 positions, and R32_UINT indices for StreamOut::Indexed captures; valid between
+    // End() and the next Begin().
+    D3D12_VERTEX_BUFFER_VIEW GetVertexBufferView() const;
+    D3D12_INDEX_BUFFER_VIEW  GetIndexBufferView() const;
+
+    ID3D12Resource* GetVertexResource() const { return m_vertices.Get(); }
+    ID3D12Resource* GetIndexResource() const { return m_indices.Get(); }
+
+    uint32_t GetVertexCapacity() const { return m_vertexCapacity; }
+    uint32_t GetPrimitiveCapacity() const { return m_primitiveCapacity; }
+
+private:
+    void Transition(ID3D12GraphicsCommandList* commandList, D3D12_RESOURCE_STATES countersState, D3D12_RESOURCE_STATES buffersState);
+
+    uint32_t                                            m_vertexCapacity;
+    uint32_t                                            m_primitiveCapacity;
+    Microsoft::WRL::ComPtr<ID3D12Resource>              m_counters;
+    Microsoft::WRL::ComPtr<ID3D12Resource>              m_vertices;
+    Microsoft::WRL::ComPtr<ID3D12Resource>              m_indices;  // Room for three indices per primitive
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_readbacks; // Counters, vertices, then indices
+    D3D12_RESOURCE_STATES                               m_countersState;
+    D3D12_RESOURCE_STATES                               m_buffersState;
+};
@@ -0,0 +1,203 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "TriangleGrid.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    const int32_t c_maxGridDim = 256;
+
+    XMFLOAT3 Sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+    float Dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    XMFLOAT3 Mad(const XMFLOAT3& a, const XMFLOAT3& b, float s) { return XMFLOAT3(a.x + b.x * s, a.y + b.y * s, a.z + b.z * s); }
+
+    float DistanceSq(const XMFLOAT3& a, const XMFLOAT3& b)
+    {
+        const XMFLOAT3 d = Sub(a, b);
+        return Dot(d, d);
+    }
+}
+
+// Closest point on a triangle by Voronoi region classification (Ericson, Real-Time Collision Detection 5.1.5).
+float PointTriangleDistanceSq(const XMFLOAT3& p, const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c)
+{
+    const XMFLOAT3 ab = Sub(b, a);
+    const XMFLOAT3 ac = Sub(c, a);
+    const XMFLOAT3 ap = Sub(p, a);
+
+    const float d1 = Dot(ab, ap);
+    const float d2 = Dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return DistanceSq(p, a);
+
+    const XMFLOAT3 bp = Sub(p, b);
+    const float d3 = Dot(ab, bp);
+    const float d4 = Dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return DistanceSq(p, b);
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return DistanceSq(p, Mad(a, ab, d1 / (d1 - d3)));
+
+    const XMFLOAT3 cp = Sub(p, c);
+    const float d5 = Dot(ab, cp);
+    const float d6 = Dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return DistanceSq(p, c);
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return DistanceSq(p, Mad(a, ac, d2 / (d2 - d6)));
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return DistanceSq(p, Mad(b, Sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+
+    const float denom = 1.0f / (va + vb + vc);
+    return DistanceSq(p, Mad(Mad(a, ab, vb * denom), ac, vc * denom));
+}
+
+TriangleGrid::TriangleGrid()
+    : m_boundsMin(0, 0, 0)
+    , m_cellSize(1.0f)
+    , m_dims{ 1, 1, 1 }
+{ }
+
+void TriangleGrid::Build(const XMFLOAT3* positions, const uint32_t* indices, uint32_t triangleCount)
+{
+    m_triangles.resize(triangleCount * 3);
+
+    XMFLOAT3 mn(FLT_MAX, FLT_MAX, FLT_MAX);
+    XMFLOAT3 mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+    {
+        const XMFLOAT3& p = positions[indices[i]];
+        m_triangles[i] = p;
+
+        mn = XMFLOAT3(std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z));
+        mx = XMFLOAT3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+    }
+
+    if (triangleCount == 0)
+    {
+        mn = mx = XMFLOAT3(0, 0, 0);
+    }
+
+    // Aim for a handful of triangles per occupied cell; surfaces scale with the square of the resolution.
+    const float extent = std::max(mx.x - mn.x, std::max(mx.y - mn.y, mx.z - mn.z));
+    const float cellsPerAxis = std::min(static_cast<float>(c_maxGridDim), std::max(1.0f, std::sqrt(static_cast<float>(triangleCount) / 4.0f)));
+
+    m_boundsMin = mn;
+    m_cellSize = std::max(extent / cellsPerAxis, 1e-6f);
+    m_dims[0] = std::min(c_maxGridDim, static_cast<int32_t>((mx.x - mn.x) / m_cellSize) + 1);
+    m_dims[1] = std::min(c_maxGridDim, static_cast<int32_t>((mx.y - mn.y) / m_cellSize) + 1);
+    m_dims[2] = std::min(c_maxGridDim, static_cast<int32_t>((mx.z - mn.z) / m_cellSize) + 1);
+
+    const uint32_t cellCount = static_cast<uint32_t>(m_dims[0] * m_dims[1] * m_dims[2]);
+
+    // Counting sort of triangles into every cell overlapped by their bounds.
+    auto forEachCell = [&](uint32_t tri, auto&& func)
+    {
+        const XMFLOAT3* v = &m_triangles[tri * 3];
+
+        int32_t x0, y0, z0, x1, y1, z1;
+        GetCell(XMFLOAT3(std::min(v[0].x, std::min(v[1].x, v[2].x)), std::min(v[0].y, std::min(v[1].y, v[2].y)), std::min(v[0].z, std::min(v[1].z, v[2].z))), x0, y0, z0);
+        GetCell(XMFLOAT3(std::max(v[0].x, std::max(v[1].x, v[2].x)), std::max(v[0].y, std::max(v[1].y, v[2].y)), std::max(v[0].z, std::max(v[1].z, v[2].z))), x1, y1, z1);
+
+        for (int32_t z = z0; z <= z1; ++z)
+            for (int32_t y = y0; y <= y1; ++y)
+                for (int32_t x = x0; x <= x1; ++x)
+                    func((z * m_dims[1] + y) * m_dims[0] + x);
+    };
+
+    m_cellStart.assign(cellCount + 1, 0);
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        forEachCell(i, [&](int32_t cell) { m_cellStart[cell + 1]++; });
+    }
+
+    for (uint32_t i = 0; i < cellCount; ++i)
+    {
+        m_cellStart[i + 1] += m_cellStart[i];
+    }
+
+    std::vector<uint32_t> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+    m_cellTriangles.resize(m_cellStart.back());
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        forEachCell(i, [&](int32_t cell) { m_cellTriangles[cursor[cell]++] = i; });
+    }
+}
+
+void TriangleGrid::GetCell(const XMFLOAT3& p, int32_t& x, int32_t& y, int32_t& z) const
+{
+    x = std::min(m_dims[0] - 1, std::max(0, static_cast<int32_t>((p.x - m_boundsMin.x) / m_cellSize)));
+    y = std::min(m_dims[1] - 1, std::max(0, static_cast<int32_t>((p.y - m_boundsMin.y) / m_cellSize)));
+    z = std::min(m_dims[2] - 1, std::max(0, static_cast<int32_t>((p.z - m_boundsMin.z) / m_cellSize)));
+}
+
+float TriangleGrid::GetDistance(const XMFLOAT3& point) const
+{
+    if (m_triangles.empty())
+        return FLT_MAX;
+
+    int32_t cx, cy, cz;
+    GetCell(point, cx, cy, cz);
+
+    float bestSq = FLT_MAX;
+    const int32_t maxRing = std::max(m_dims[0], std::max(m_dims[1], m_dims[2]));
+
+    // Visit shells of cells in increasing Chebyshev distance. Anything in shell r + 1 is at
+    // least r cells away, which bounds the search once a close enough triangle is found.
+    for (int32_t r = 0; r <= maxRing; ++r)
+    {
+        for (int32_t z = cz - r; z <= cz + r; ++z)
+        {
+            if (z < 0 || z >= m_dims[2])
+                continue;
+
+            for (int32_t y = cy - r; y <= cy + r; ++y)
+            {
+                if (y < 0 || y >= m_dims[1])
+                    continue;
+
+                const bool onShell = std::abs(z - cz) == r || std::abs(y - cy) == r;
+                const int32_t step = onShell ? 1 : 2 * r;
+
+                for (int32_t x = cx - r; x <= cx + r; x += std::max(step, 1))
+                {
+                    if (x < 0 || x >= m_dims[0])
+                        continue;
+
+                    const int32_t cell = (z * m_dims[1] + y) * m_dims[0] + x;
+                    for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+                    {
+                        const XMFLOAT3* v = &m_triangles[m_cellTriangles[i] * 3];
+                        bestSq = std::min(bestSq, PointTriangleDistanceSq(point, v[0], v[1], v[2]));
+                    }
+                }
+            }
+        }
+
+        const float bound = r * m_cellSize;
+        if (bestSq <= bound * bound)
+            break;
+    }
+
+    return std::sqrt(bestSq);
+}
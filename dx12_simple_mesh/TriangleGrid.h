@@ -0,0 +1,42 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over a triangle soup for nearest-surface distance queries.
+// Used to measure how far a simplified mesh deviates from its source.
+class TriangleGrid
+{
+public:
+    TriangleGrid();
+
+    void Build(const DirectX::XMFLOAT3* positions, const uint32_t* indices, uint32_t triangleCount);
+
+    // Distance from 'point' to the closest triangle in the grid.
+    float GetDistance(const DirectX::XMFLOAT3& point) const;
+
+private:
+    void GetCell(const DirectX::XMFLOAT3& p, int32_t& x, int32_t& y, int32_t& z) const;
+
+    std::vector<DirectX::XMFLOAT3> m_triangles; // Three positions per triangle.
+    std::vector<uint32_t>          m_cellStart; // Offsets into m_cellTriangles, one past the end for the last cell.
+    std::vector<uint32_t>          m_cellTriangles;
+
+    DirectX::XMFLOAT3 m_boundsMin;
+    float             m_cellSize;
+    int32_t           m_dims[3];
+};
+
+// Returns the squared distance from p to triangle (a, b, c).
+float PointTriangleDistanceSq(const DirectX::XMFLOAT3& p, const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, const DirectX::XMFLOAT3& c);
@@ -0,0 +1,54 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "stdafx.h"
+#include "UploadRing.h"
+
+#include "DXSampleHelper.h"
+
+UploadRing::UploadRing(UINT64 size)
+    : m_allocator(size)
+    , m_data(nullptr)
+{ }
+
+void UploadRing::Create(ID3D12Device* device)
+{
+    const CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+    const CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(m_allocator.GetSize());
+
+    ThrowIfFailed(device->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &bufferDesc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&m_buffer)));
+
+    NAME_D3D12_OBJECT(m_buffer);
+
+    // Kept mapped for the buffer's lifetime.
+    CD3DX12_RANGE readRange(0, 0);
+    ThrowIfFailed(m_buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_data)));
+}
+
+UploadAllocation UploadRing::Allocate(UINT64 size, UINT64 alignment)
+{
+    const uint64_t offset = m_allocator.Allocate(size, alignment);
+    if (offset == RingAllocator::InvalidOffset)
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+
+    UploadAllocation allocation;
+    allocation.Data = m_data + offset;
+    allocation.GpuAddress = m_buffer->GetGPUVirtualAddress() + offset;
+    allocation.Offset = offset;
+    return allocation;
+}
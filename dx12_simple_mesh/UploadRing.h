@@ -0,0 +1,48 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "RingAllocator.h"
+
+struct UploadAllocation
+{
+    uint8_t*                  Data;       // Write-combined: write only, never read back
+    D3D12_GPU_VIRTUAL_ADDRESS GpuAddress;
+    UINT64                    Offset;     // Within GetResource()
+};
+
+// A persistently mapped upload buffer for data the CPU rewrites every frame, such as animated
+// or procedural vertices. Memory is handed out through a RingAllocator and stays untouched
+// until the fence value of the frame that used it completes. Buffer views can point straight
+// into it; the buffer must be registered with RhiDrawTarget like any other.
+class UploadRing
+{
+public:
+    explicit UploadRing(UINT64 size);
+
+    void Create(ID3D12Device* device);
+
+    // Throws E_OUTOFMEMORY when frames in flight leave no room.
+    UploadAllocation Allocate(UINT64 size, UINT64 alignment);
+
+    // Call once the frame's commands are submitted, with the fence value signaled after them.
+    void FinishFrame(UINT64 fenceValue) { m_allocator.FinishFrame(fenceValue); }
+
+    // Call before allocating for a frame, with the fence's completed value.
+    void Reclaim(UINT64 completedFenceValue) { m_allocator.Reclaim(completedFenceValue); }
+
+    ID3D12Resource* GetResource() const { return m_buffer.Get(); }
+
+private:
+    RingAllocator                          m_allocator;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_buffer;
+    uint8_t*                               m_data;
+};
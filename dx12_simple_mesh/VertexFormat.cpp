@@ -0,0 +1,470 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const VertexFormatInfo c_formats[] =
+    {
+        { DXGI_FORMAT_R32G32B32A32_FLOAT, "R32G32B32A32_FLOAT", 16, 4, { 32, 32, 32, 32 }, VertexEncoding::Float, false },
+        { DXGI_FORMAT_R32G32B32A32_UINT,  "R32G32B32A32_UINT",  16, 4, { 32, 32, 32, 32 }, VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R32G32B32A32_SINT,  "R32G32B32A32_SINT",  16, 4, { 32, 32, 32, 32 }, VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R32G32B32_FLOAT,    "R32G32B32_FLOAT",    12, 3, { 32, 32, 32 },     VertexEncoding::Float, false },
+        { DXGI_FORMAT_R32G32B32_UINT,     "R32G32B32_UINT",     12, 3, { 32, 32, 32 },     VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R32G32B32_SINT,     "R32G32B32_SINT",     12, 3, { 32, 32, 32 },     VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R16G16B16A16_FLOAT, "R16G16B16A16_FLOAT", 8,  4, { 16, 16, 16, 16 }, VertexEncoding::Half,  false },
+        { DXGI_FORMAT_R16G16B16A16_UNORM, "R16G16B16A16_UNORM", 8,  4, { 16, 16, 16, 16 }, VertexEncoding::Unorm, false },
+        { DXGI_FORMAT_R16G16B16A16_UINT,  "R16G16B16A16_UINT",  8,  4, { 16, 16, 16, 16 }, VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R16G16B16A16_SNORM, "R16G16B16A16_SNORM", 8,  4, { 16, 16, 16, 16 }, VertexEncoding::Snorm, false },
+        { DXGI_FORMAT_R16G16B16A16_SINT,  "R16G16B16A16_SINT",  8,  4, { 16, 16, 16, 16 }, VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R32G32_FLOAT,       "R32G32_FLOAT",       8,  2, { 32, 32 },         VertexEncoding::Float, false },
+        { DXGI_FORMAT_R32G32_UINT,        "R32G32_UINT",        8,  2, { 32, 32 },         VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R32G32_SINT,        "R32G32_SINT",        8,  2, { 32, 32 },         VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R10G10B10A2_UNORM,  "R10G10B10A2_UNORM",  4,  4, { 10, 10, 10, 2 },  VertexEncoding::Unorm, false },
+        { DXGI_FORMAT_R10G10B10A2_UINT,   "R10G10B10A2_UINT",   4,  4, { 10, 10, 10, 2 },  VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R8G8B8A8_UNORM,     "R8G8B8A8_UNORM",     4,  4, { 8, 8, 8, 8 },     VertexEncoding::Unorm, false },
+        { DXGI_FORMAT_R8G8B8A8_UINT,      "R8G8B8A8_UINT",      4,  4, { 8, 8, 8, 8 },     VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R8G8B8A8_SNORM,     "R8G8B8A8_SNORM",     4,  4, { 8, 8, 8, 8 },     VertexEncoding::Snorm, false },
+        { DXGI_FORMAT_R8G8B8A8_SINT,      "R8G8B8A8_SINT",      4,  4, { 8, 8, 8, 8 },     VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R16G16_FLOAT,       "R16G16_FLOAT",       4,  2, { 16, 16 },         VertexEncoding::Half,  false },
+        { DXGI_FORMAT_R16G16_UNORM,       "R16G16_UNORM",       4,  2, { 16, 16 },         VertexEncoding::Unorm, false },
+        { DXGI_FORMAT_R16G16_UINT,        "R16G16_UINT",        4,  2, { 16, 16 },         VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R16G16_SNORM,       "R16G16_SNORM",       4,  2, { 16, 16 },         VertexEncoding::Snorm, false },
+        { DXGI_FORMAT_R16G16_SINT,        "R16G16_SINT",        4,  2, { 16, 16 },         VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R32_FLOAT,          "R32_FLOAT",          4,  1, { 32 },             VertexEncoding::Float, false },
+        { DXGI_FORMAT_R32_UINT,           "R32_UINT",           4,  1, { 32 },             VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R32_SINT,           "R32_SINT",           4,  1, { 32 },             VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R8G8_UNORM,         "R8G8_UNORM",         2,  2, { 8, 8 },           VertexEncoding::Unorm, false },
+        { DXGI_FORMAT_R8G8_UINT,          "R8G8_UINT",          2,  2, { 8, 8 },           VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R8G8_SNORM,         "R8G8_SNORM",         2,  2, { 8, 8 },           VertexEncoding::Snorm, false },
+        { DXGI_FORMAT_R8G8_SINT,          "R8G8_SINT",          2,  2, { 8, 8 },           VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R16_FLOAT,          "R16_FLOAT",          2,  1, { 16 },             VertexEncoding::Half,  false },
+        { DXGI_FORMAT_R16_UNORM,          "R16_UNORM",          2,  1, { 16 },             VertexEncoding::Unorm, false },
+        { DXGI_FORMAT_R16_UINT,           "R16_UINT",           2,  1, { 16 },             VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R16_SNORM,          "R16_SNORM",          2,  1, { 16 },             VertexEncoding::Snorm, false },
+        { DXGI_FORMAT_R16_SINT,           "R16_SINT",           2,  1, { 16 },             VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_R8_UNORM,           "R8_UNORM",           1,  1, { 8 },              VertexEncoding::Unorm, false },
+        { DXGI_FORMAT_R8_UINT,            "R8_UINT",            1,  1, { 8 },              VertexEncoding::Uint,  false },
+        { DXGI_FORMAT_R8_SNORM,           "R8_SNORM",           1,  1, { 8 },              VertexEncoding::Snorm, false },
+        { DXGI_FORMAT_R8_SINT,            "R8_SINT",            1,  1, { 8 },              VertexEncoding::Sint,  false },
+        { DXGI_FORMAT_B8G8R8A8_UNORM,     "B8G8R8A8_UNORM",     4,  4, { 8, 8, 8, 8 },     VertexEncoding::Unorm, true  },
+    };
+
+    const uint32_t c_floatOne = 0x3f800000;
+
+    uint32_t AsUint(float f)
+    {
+        uint32_t u;
+        memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+
+    bool IsFloatEncoding(VertexEncoding::EType encoding)
+    {
+        return encoding != VertexEncoding::Uint && encoding != VertexEncoding::Sint;
+    }
+
+    uint32_t ComponentMask(uint32_t bits)
+    {
+        return bits == 32 ? ~0u : (1u << bits) - 1;
+    }
+
+    int32_t SignExtend(uint32_t value, uint32_t bits)
+    {
+        return static_cast<int32_t>(value << (32 - bits)) >> (32 - bits);
+    }
+
+    // Normalization multiplies by a rounded reciprocal rather than dividing, as an IEEE multiply
+    // is exact to half an ulp on both sides while shader division is not.
+    float NormScale(VertexEncoding::EType encoding, uint32_t bits)
+    {
+        const uint32_t maxValue = encoding == VertexEncoding::Snorm ? (1u << (bits - 1)) - 1 : (1u << bits) - 1;
+        return 1.0f / static_cast<float>(maxValue);
+    }
+
+    // Exact, including denormals, as f16tof32() is.
+    uint32_t HalfToFloatBits(uint32_t h)
+    {
+        const uint32_t sign = (h & 0x8000) << 16;
+        int32_t exponent = (h >> 10) & 0x1f;
+        uint32_t mantissa = h & 0x3ff;
+
+        // NaNs come out quiet, as with hardware conversions.
+        if (exponent == 0x1f)
+            return sign | 0x7f800000 | (mantissa != 0 ? 0x400000 : 0) | (mantissa << 13);
+
+        if (exponent == 0)
+        {
+            if (mantissa == 0)
+                return sign;
+
+            exponent = 1;
+            while ((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                --exponent;
+            }
+            mantissa &= 0x3ff;
+        }
+
+        return sign | (static_cast<uint32_t>(exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    uint32_t DecodeComponent(VertexEncoding::EType encoding, uint32_t value, uint32_t bits)
+    {
+        switch (encoding)
+        {
+        case VertexEncoding::Half:
+            return HalfToFloatBits(value);
+
+        case VertexEncoding::Unorm:
+            return AsUint(static_cast<float>(value) * NormScale(encoding, bits));
+
+        case VertexEncoding::Snorm:
+            return AsUint(std::max(static_cast<float>(SignExtend(value, bits)) * NormScale(encoding, bits), -1.0f));
+
+        case VertexEncoding::Sint:
+            return static_cast<uint32_t>(SignExtend(value, bits));
+
+        default:
+            return value;
+        }
+    }
+
+    bool SemanticEquals(const char* a, const char* b)
+    {
+        for (; *a && *b; ++a, ++b)
+        {
+            if (toupper(static_cast<unsigned char>(*a)) != toupper(static_cast<unsigned char>(*b)))
+                return false;
+        }
+        return *a == *b;
+    }
+
+    // The HLSL expression extracting one component from the raw uint4 of an element. Only ever
+    // used as a function or constructor argument, so it is not parenthesized.
+    std::string ComponentSource(const char* raw, uint32_t bitOffset, uint32_t bits)
+    {
+        static const char c_swizzle[] = "xyzw";
+
+        char buffer[64];
+        const char word = c_swizzle[bitOffset / 32];
+        const uint32_t shift = bitOffset % 32;
+
+        if (bits == 32)
+            snprintf(buffer, sizeof(buffer), "%s.%c", raw, word);
+        else if (shift == 0)
+            snprintf(buffer, sizeof(buffer), "%s.%c & 0x%xu", raw, word, ComponentMask(bits));
+        else if (shift + bits == 32)
+            snprintf(buffer, sizeof(buffer), "%s.%c >> %u", raw, word, shift);
+        else
+            snprintf(buffer, sizeof(buffer), "(%s.%c >> %u) & 0x%xu", raw, word, shift, ComponentMask(bits));
+
+        return buffer;
+    }
+
+    std::string DecodeSource(VertexEncoding::EType encoding, const std::string& source, uint32_t bits)
+    {
+        char buffer[128];
+        switch (encoding)
+        {
+        case VertexEncoding::Half:
+            snprintf(buffer, sizeof(buffer), "asuint(f16tof32(%s))", source.c_str());
+            break;
+
+        case VertexEncoding::Unorm:
+            snprintf(buffer, sizeof(buffer), "DecodeUnorm(%s, asfloat(0x%08xu))", source.c_str(), AsUint(NormScale(encoding, bits)));
+            break;
+
+        case VertexEncoding::Snorm:
+            snprintf(buffer, sizeof(buffer), "DecodeSnorm(%s, %u, asfloat(0x%08xu))", source.c_str(), bits, AsUint(NormScale(encoding, bits)));
+            break;
+
+        case VertexEncoding::Sint:
+            if (bits == 32)
+                return source;
+            snprintf(buffer, sizeof(buffer), "asuint(SignExtend(%s, %u))", source.c_str(), bits);
+            break;
+
+        default:
+            return source;
+        }
+        return buffer;
+    }
+
+    const char c_fetchHeader[] =
+        "// Generated by GenerateVertexFetchHlsl() in VertexFormat.cpp; do not edit.\n"
+        "// Keep in sync with DecodeVertexElement() there, which must match bit for bit.\n"
+        "\n";
+
+    const char c_decodeHelpers[] =
+        "int SignExtend(uint value, uint bits)\n"
+        "{\n"
+        "    return int(value << (32 - bits)) >> (32 - bits);\n"
+        "}\n"
+        "\n"
+        "uint DecodeUnorm(uint value, float scale)\n"
+        "{\n"
+        "    precise float f = float(value) * scale;\n"
+        "    return asuint(f);\n"
+        "}\n"
+        "\n"
+        "uint DecodeSnorm(uint value, uint bits, float scale)\n"
+        "{\n"
+        "    precise float f = max(float(SignExtend(value, bits)) * scale, -1.0);\n"
+        "    return asuint(f);\n"
+        "}\n";
+
+    const char c_fetchPrologue[] =
+        "\n"
+        "// Returns the element as the shader sees it: IEEE bits for float and normalized formats,\n"
+        "// integers otherwise. 'raw' holds the element's bytes in little-endian order.\n"
+        "uint4 DecodeVertexElement(uint format, uint4 raw)\n"
+        "{\n"
+        "    switch (format)\n"
+        "    {\n";
+
+    const char c_fetchEpilogue[] =
+        "    default:\n"
+        "        return uint4(0, 0, 0, 0);\n"
+        "    }\n"
+        "}\n";
+}
+
+const VertexFormatInfo* GetVertexFormatInfo(DXGI_FORMAT format)
+{
+    for (const VertexFormatInfo& info : c_formats)
+    {
+        if (info.Format == format)
+            return &info;
+    }
+    return nullptr;
+}
+
+HRESULT ResolveInputLayout(const D3D12_INPUT_LAYOUT_DESC& desc, const uint32_t* strides, uint32_t slotCount, VertexLayout& layout)
+{
+    if (desc.NumElements > c_maxVertexElements || slotCount > c_maxVertexSlots)
+        return E_INVALIDARG;
+
+    layout.Elements.resize(desc.NumElements);
+    layout.PositionElement = ~0u;
+
+    for (uint32_t i = 0; i < c_maxVertexSlots; ++i)
+    {
+        layout.Strides[i] = i < slotCount ? strides[i] : 0;
+    }
+
+    uint32_t slotEnd[c_maxVertexSlots] = {};
+    uint32_t slotClass[c_maxVertexSlots];
+    std::fill(slotClass, slotClass + c_maxVertexSlots, ~0u);
+
+    for (uint32_t i = 0; i < desc.NumElements; ++i)
+    {
+        const D3D12_INPUT_ELEMENT_DESC& elem = desc.pInputElementDescs[i];
+
+        const VertexFormatInfo* info = GetVertexFormatInfo(elem.Format);
+        if (info == nullptr || elem.InputSlot >= slotCount)
+            return E_INVALIDARG;
+
+        const bool perInstance = elem.InputSlotClass == D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA;
+        if (!perInstance && (elem.InputSlotClass != D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA || elem.InstanceDataStepRate != 0))
+            return E_INVALIDARG;
+
+        if (slotClass[elem.InputSlot] != ~0u && slotClass[elem.InputSlot] != static_cast<uint32_t>(elem.InputSlotClass))
+            return E_INVALIDARG;
+
+        slotClass[elem.InputSlot] = elem.InputSlotClass;
+
+        // Elements are aligned to their size, up to 4 bytes.
+        const uint32_t alignment = std::min(info->Size, 4u);
+
+        uint32_t offset = elem.AlignedByteOffset;
+        if (offset == D3D12_APPEND_ALIGNED_ELEMENT)
+        {
+            offset = (slotEnd[elem.InputSlot] + alignment - 1) & ~(alignment - 1);
+        }
+        else if (offset % alignment != 0)
+        {
+            return E_INVALIDARG;
+        }
+
+        // A zero stride replicates the first vertex, so anything fits.
+        const uint32_t stride = layout.Strides[elem.InputSlot];
+        if (stride != 0 && offset + info->Size > stride)
+            return E_INVALIDARG;
+
+        slotEnd[elem.InputSlot] = offset + info->Size;
+
+        // A per-instance step rate of 0 repeats the first element for every instance.
+        const uint32_t stepRate = !perInstance ? 0 : (elem.InstanceDataStepRate != 0 ? elem.InstanceDataStepRate : ~0u);
+
+        layout.Elements[i] = { elem.InputSlot, offset, elem.Format, stepRate };
+
+        if (layout.PositionElement == ~0u && elem.SemanticIndex == 0 && SemanticEquals(elem.SemanticName, "POSITION"))
+        {
+            layout.PositionElement = i;
+        }
+    }
+
+    return S_OK;
+}
+
+void PackVertexLayout(const VertexLayout& layout, VertexLayoutConstants& constants)
+{
+    memset(&constants, 0, sizeof(constants));
+
+    constants.ElementCount = static_cast<uint32_t>(layout.Elements.size());
+    constants.PositionElement = layout.PositionElement;
+    memcpy(constants.Strides, layout.Strides, sizeof(constants.Strides));
+
+    for (uint32_t i = 0; i < layout.Elements.size(); ++i)
+    {
+        constants.Elements[i][0] = layout.Elements[i].Slot;
+        constants.Elements[i][1] = layout.Elements[i].Offset;
+        constants.Elements[i][2] = layout.Elements[i].Format;
+        constants.Elements[i][3] = GetVertexFormatInfo(layout.Elements[i].Format)->Size;
+        constants.StepRates[i] = layout.Elements[i].InstanceStepRate;
+    }
+}
+
+void DecodeVertexElement(DXGI_FORMAT format, const void* data, uint32_t result[4])
+{
+    const VertexFormatInfo* info = GetVertexFormatInfo(format);
+    if (info == nullptr)
+    {
+        memset(result, 0, sizeof(uint32_t) * 4);
+        return;
+    }
+
+    uint32_t raw[4] = {};
+    memcpy(raw, data, info->Size);
+
+    result[0] = 0;
+    result[1] = 0;
+    result[2] = 0;
+    result[3] = IsFloatEncoding(info->Encoding) ? c_floatOne : 1;
+
+    uint32_t bitOffset = 0;
+    for (uint32_t c = 0; c < info->ComponentCount; ++c)
+    {
+        const uint32_t bits = info->ComponentBits[c];
+        const uint32_t value = (raw[bitOffset / 32] >> (bitOffset % 32)) & ComponentMask(bits);
+
+        result[c] = DecodeComponent(info->Encoding, value, bits);
+        bitOffset += bits;
+    }
+
+    if (info->SwapRB)
+    {
+        std::swap(result[0], result[2]);
+    }
+}
+
+uint32_t GetElementIndex(const VertexElement& element, uint32_t vertex, uint32_t instance, uint32_t startInstance)
+{
+    if (element.InstanceStepRate == 0)
+        return vertex;
+
+    return startInstance + instance / element.InstanceStepRate;
+}
+
+void FetchVertexElement(
+    const VertexLayout& layout,
+    uint32_t element,
+    const uint8_t* const* buffers,
+    uint32_t vertex,
+    uint32_t instance,
+    uint32_t startInstance,
+    uint32_t result[4])
+{
+    const VertexElement& elem = layout.Elements[element];
+    const uint32_t index = GetElementIndex(elem, vertex, instance, startInstance);
+    const uint8_t* data = buffers[elem.Slot] + size_t(index) * layout.Strides[elem.Slot] + elem.Offset;
+
+    DecodeVertexElement(elem.Format, data, result);
+}
+
+const char* GetDecodeHelpersHlsl()
+{
+    return c_decodeHelpers;
+}
+
+std::string GenerateDecodeHlsl(DXGI_FORMAT format, const char* raw, uint32_t column)
+{
+    const VertexFormatInfo* info = GetVertexFormatInfo(format);
+    if (info == nullptr)
+        return "uint4(0, 0, 0, 0)";
+
+    std::string components[4];
+
+    uint32_t bitOffset = 0;
+    for (uint32_t c = 0; c < info->ComponentCount; ++c)
+    {
+        components[c] = DecodeSource(info->Encoding, ComponentSource(raw, bitOffset, info->ComponentBits[c]), info->ComponentBits[c]);
+        bitOffset += info->ComponentBits[c];
+    }
+
+    for (uint32_t c = info->ComponentCount; c < 4; ++c)
+    {
+        components[c] = c < 3 ? "0" : (IsFloatEncoding(info->Encoding) ? "0x3f800000u" : "1");
+    }
+
+    if (info->SwapRB)
+    {
+        std::swap(components[0], components[2]);
+    }
+
+    const std::string indent(column + 6, ' '); // Aligned under the first component
+    return "uint4(" + components[0] + ",\n" +
+        indent + components[1] + ",\n" +
+        indent + components[2] + ",\n" +
+        indent + components[3] + ")";
+}
+
+std::string GenerateVertexFetchHlsl()
+{
+    std::string source = c_fetchHeader;
+    source += c_decodeHelpers;
+    source += c_fetchPrologue;
+
+    for (const VertexFormatInfo& info : c_formats)
+    {
+        char label[96];
+        snprintf(label, sizeof(label), "    case %u: // DXGI_FORMAT_%s\n", static_cast<uint32_t>(info.Format), info.Name);
+
+        source += label;
+        source += "        return " + GenerateDecodeHlsl(info.Format, "raw", 15) + ";\n";
+    }
+
+    source += c_fetchEpilogue;
+    return source;
+}
+
+HRESULT WriteVertexFetchHlsl(const wchar_t* filename)
+{
+    const std::string source = GenerateVertexFetchHlsl();
+
+    std::ofstream stream(GetStreamPath(filename), std::ios::binary);
+    if (!stream.is_open())
+    {
+        return E_INVALIDARG;
+    }
+
+    stream.write(source.data(), source.size());
+    return stream.good() ? S_OK : E_FAIL;
+}
@@ -0,0 +1,116 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "Platform.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Must match MAX_VERTEX_SLOTS and MAX_VERTEX_ELEMENTS in MeshletMS.hlsl.
+const uint32_t c_maxVertexSlots = 8;
+const uint32_t c_maxVertexElements = 16;
+
+struct VertexEncoding
+{
+    enum EType : uint32_t
+    {
+        Float, // 32-bit IEEE float, passed through
+        Half,  // 16-bit IEEE float
+        Unorm,
+        Snorm,
+        Uint,
+        Sint,
+    };
+};
+
+struct VertexFormatInfo
+{
+    DXGI_FORMAT           Format;
+    const char*           Name;
+    uint32_t              Size;             // Bytes per element
+    uint32_t              ComponentCount;
+    uint32_t              ComponentBits[4]; // In memory order, starting at the least significant bit
+    VertexEncoding::EType Encoding;
+    bool                  SwapRB;           // Stored as BGRA; the shader sees RGBA
+};
+
+// An input element with its offset resolved and its format validated.
+struct VertexElement
+{
+    uint32_t    Slot;
+    uint32_t    Offset;
+    DXGI_FORMAT Format;
+    uint32_t    InstanceStepRate; // 0 for per-vertex data, else instances per element; ~0u never advances
+};
+
+struct VertexLayout
+{
+    std::vector<VertexElement> Elements;        // In input layout order
+    uint32_t                   Strides[c_maxVertexSlots];
+    uint32_t                   PositionElement; // Element holding POSITION0, or ~0u
+};
+
+// Mirrors the VertexLayout constant buffer in MeshletMS.hlsl.
+struct VertexLayoutConstants
+{
+    uint32_t ElementCount;
+    uint32_t PositionElement;
+    uint32_t Padding[2];
+    uint32_t Strides[c_maxVertexSlots];
+    uint32_t Elements[c_maxVertexElements][4]; // Slot, Offset, Format, Size
+    uint32_t StepRates[c_maxVertexElements];   // VertexElement::InstanceStepRate
+};
+
+// Returns null if the format cannot be fetched by the mesh shader.
+const VertexFormatInfo* GetVertexFormatInfo(DXGI_FORMAT format);
+
+// Resolves D3D12_APPEND_ALIGNED_ELEMENT offsets and validates 'desc' against the vertex buffer
+// strides, following the input assembler's rules. Every element of a slot must share its
+// classification.
+HRESULT ResolveInputLayout(const D3D12_INPUT_LAYOUT_DESC& desc, const uint32_t* strides, uint32_t slotCount, VertexLayout& layout);
+
+void PackVertexLayout(const VertexLayout& layout, VertexLayoutConstants& constants);
+
+// Decodes one element into the four 32-bit values the shader sees: IEEE bits for float and
+// normalized formats, integers otherwise. Missing components default to (0, 0, 0, 1).
+// Matches DecodeVertexElement() in the generated HLSL bit for bit, NaN payloads aside.
+void DecodeVertexElement(DXGI_FORMAT format, const void* data, uint32_t result[4]);
+
+// Returns the index 'element' is fetched at for a vertex ID and instance ID, as the input
+// assembler computes it: per-instance data starts at the draw's StartInstanceLocation and
+// advances every InstanceStepRate instances.
+uint32_t GetElementIndex(const VertexElement& element, uint32_t vertex, uint32_t instance, uint32_t startInstance);
+
+// Fetches and decodes element 'element' of a vertex and instance from per-slot buffers.
+void FetchVertexElement(
+    const VertexLayout& layout,
+    uint32_t element,
+    const uint8_t* const* buffers,
+    uint32_t vertex,
+    uint32_t instance,
+    uint32_t startInstance,
+    uint32_t result[4]);
+
+// HLSL functions called by the expressions GenerateDecodeHlsl() returns.
+const char* GetDecodeHelpersHlsl();
+
+// Returns an HLSL uint4 expression decoding 'format' from the uint4 variable 'raw', the HLSL
+// counterpart of DecodeVertexElement(). 'column' is where the expression starts on its line,
+// used to align the continuation lines.
+std::string GenerateDecodeHlsl(DXGI_FORMAT format, const char* raw, uint32_t column);
+
+// Emits a DecodeVertexElement(format, raw) covering every supported format, included by
+// MeshletMS.hlsl when it fetches through the generic path.
+std::string GenerateVertexFetchHlsl();
+
+HRESULT WriteVertexFetchHlsl(const wchar_t* filename);
@@ -0,0 +1,129 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "VertexReuse.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    VertexReuseStats MakeStats(uint32_t triangleCount, uint32_t vertexCount, uint32_t transformCount)
+    {
+        VertexReuseStats stats = {};
+        stats.TriangleCount = triangleCount;
+        stats.VertexCount = vertexCount;
+        stats.TransformCount = transformCount;
+        stats.Acmr = triangleCount > 0 ? float(transformCount) / triangleCount : 0.0f;
+        stats.Atvr = vertexCount > 0 ? float(transformCount) / vertexCount : 0.0f;
+        return stats;
+    }
+
+    uint32_t CountDistinct(const uint32_t* indices, uint32_t count)
+    {
+        std::unordered_set<uint32_t> distinct(indices, indices + count);
+        return static_cast<uint32_t>(distinct.size());
+    }
+}
+
+uint32_t DedupGroupIndices(const uint32_t* indices, uint32_t count, uint32_t* vertexSlots)
+{
+    std::unordered_map<uint32_t, uint32_t> slots;
+    uint32_t slotCount = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // The shader's table can't hold 0xffffffff, so such locations aren't shared.
+        if (indices[i] == ~0u)
+        {
+            vertexSlots[i] = slotCount++;
+            continue;
+        }
+
+        auto result = slots.emplace(indices[i], slotCount);
+        if (result.second)
+        {
+            ++slotCount;
+        }
+
+        vertexSlots[i] = result.first->second;
+    }
+
+    return slotCount;
+}
+
+VertexReuseStats MeasureGroupReuse(const uint32_t* indices, uint32_t indexCount, uint32_t groupPrimitives)
+{
+    const uint32_t triangleCount = indexCount / 3;
+    const uint32_t groupLocations = groupPrimitives * 3;
+
+    std::vector<uint32_t> vertexSlots(groupLocations);
+    uint32_t transformCount = 0;
+
+    for (uint32_t first = 0; first < triangleCount * 3; first += groupLocations)
+    {
+        const uint32_t count = std::min(groupLocations, triangleCount * 3 - first);
+        transformCount += DedupGroupIndices(indices + first, count, vertexSlots.data());
+    }
+
+    return MakeStats(triangleCount, CountDistinct(indices, triangleCount * 3), transformCount);
+}
+
+VertexReuseStats MeasureFifoCacheReuse(const uint32_t* indices, uint32_t indexCount, uint32_t cacheSize)
+{
+    const uint32_t triangleCount = indexCount / 3;
+
+    // A ring of the last 'cacheSize' misses; hits don't reorder a FIFO.
+    std::vector<uint32_t> fifo(cacheSize, ~0u);
+    std::unordered_set<uint32_t> cached;
+    uint32_t next = 0;
+    uint32_t transformCount = 0;
+
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+    {
+        const uint32_t index = indices[i];
+        if (cacheSize > 0 && cached.count(index) != 0)
+            continue;
+
+        ++transformCount;
+        if (cacheSize == 0)
+            continue;
+
+        if (fifo[next] != ~0u)
+        {
+            cached.erase(fifo[next]);
+        }
+
+        fifo[next] = index;
+        cached.insert(index);
+        next = (next + 1) % cacheSize;
+    }
+
+    return MakeStats(triangleCount, CountDistinct(indices, triangleCount * 3), transformCount);
+}
+
+VertexReuseStats MeasureMeshletReuse(const Meshlet* meshlets, uint32_t meshletCount, const uint32_t* uniqueVertexIndices)
+{
+    std::unordered_set<uint32_t> distinct;
+    uint32_t triangleCount = 0;
+    uint32_t transformCount = 0;
+
+    for (uint32_t m = 0; m < meshletCount; ++m)
+    {
+        const Meshlet& meshlet = meshlets[m];
+        triangleCount += meshlet.PrimCount;
+        transformCount += meshlet.VertCount;
+        distinct.insert(uniqueVertexIndices + meshlet.VertOffset, uniqueVertexIndices + meshlet.VertOffset + meshlet.VertCount);
+    }
+
+    return MakeStats(triangleCount, static_cast<uint32_t>(distinct.size()), transformCount);
+}
@@ -0,0 +1,44 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include "MeshletTypes.h"
+
+#include <cstdint>
+
+// Models of how often an indexed triangle list's vertices are transformed: by mesh shader
+// groups that each dedupe the index values of their own window of triangles, by the
+// post-transform cache of the fixed-function pipeline, and by precomputed meshlets.
+// Kept free of D3D12 types so the tools build on any platform.
+
+struct VertexReuseStats
+{
+    uint32_t TriangleCount;
+    uint32_t VertexCount;       // Distinct index values referenced
+    uint32_t TransformCount;    // Vertices transformed
+    float    Acmr;              // Average cache miss ratio: transforms per triangle, 0.5 at best
+    float    Atvr;              // Transforms per distinct vertex, 1 at best
+};
+
+// CPU reference of FindIndexOwner() and the vertex compaction in MeshletMS.hlsl: maps each of
+// 'count' index values to the group output vertex holding it, distinct values numbered in
+// order of first occurrence. Returns the number of distinct values.
+uint32_t DedupGroupIndices(const uint32_t* indices, uint32_t count, uint32_t* vertexSlots);
+
+// Groups of 'groupPrimitives' consecutive triangles, each transforming its distinct vertices.
+// The mesh shader's windows are GROUP_PRIMS (c_groupVertexCount / 3) triangles.
+VertexReuseStats MeasureGroupReuse(const uint32_t* indices, uint32_t indexCount, uint32_t groupPrimitives);
+
+// A FIFO post-transform cache of 'cacheSize' vertices, as fixed-function hardware had.
+VertexReuseStats MeasureFifoCacheReuse(const uint32_t* indices, uint32_t indexCount, uint32_t cacheSize);
+
+// Meshlets, each transforming its unique vertices once.
+VertexReuseStats MeasureMeshletReuse(const Meshlet* meshlets, uint32_t meshletCount, const uint32_t* uniqueVertexIndices);
@@ -22,6 +22,27 @@ int Win32Application::Run(DXSample* pSample, HINSTANCE hInstance, int nCmdShow)
     pSample->ParseCommandLineArgs(argv, argc);
     LocalFree(argv);
 
+    // Offline shader builds need no window or device.
+    if (pSample->IsBuildingShaderArchive())
+    {
+        return pSample->BuildShaderArchive();
+    }
+
+    // Headless runs render a fixed number of frames offscreen, back to back.
+    if (pSample->IsHeadless())
+    {
+        pSample->OnInit();
+
+        for (UINT frame = 0; frame < pSample->GetHeadlessFrameCount(); ++frame)
+        {
+            pSample->OnUpdate();
+            pSample->OnRender();
+        }
+
+        pSample->OnDestroy();
+        return 0;
+    }
+
     // Initialize the window class.
     WNDCLASSEX windowClass = { 0 };
     windowClass.cbSize = sizeof(WNDCLASSEX);
@@ -19,6 +19,10 @@
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers.
 #endif
 
+#ifndef NOMINMAX
+#define NOMINMAX                        // Keep min/max macros from breaking std::min/std::max.
+#endif
+
 #include <windows.h>
 
 #include <d3d12.h>
@@ -26,6 +30,7 @@
 #include <DirectXMath.h>
 #include "d3dx12.h"
 
+#include <algorithm>
 #include <string>
 #include <wrl.h>
 #include <shellapi.h>
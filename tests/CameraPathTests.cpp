@@ -0,0 +1,160 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "CameraPath.h"
+
+#include <cmath>
+#include <fstream>
+
+using namespace DirectX;
+
+namespace
+{
+    // Writes 'contents' to a file under the test output directory and loads it into 'path'.
+    HRESULT LoadPath(CameraPath& path, const std::string& name, const char* contents)
+    {
+        const std::string filename = GetTestOutputPath(name);
+        {
+            std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+            stream << contents;
+        }
+
+        return path.LoadFromFile(std::wstring(filename.begin(), filename.end()).c_str());
+    }
+
+    bool IsNear(const XMFLOAT3& a, const XMFLOAT3& b, float tolerance = 1e-5f)
+    {
+        return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance && std::fabs(a.z - b.z) <= tolerance;
+    }
+
+    // Four keys a second apart; targets trail the positions by a unit along -Z.
+    CameraPath MakePath()
+    {
+        const XMFLOAT3 positions[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 2, 1, 0 }, { 4, 1, 0 } };
+
+        std::vector<CameraKey> keys;
+        for (uint32_t i = 0; i < _countof(positions); ++i)
+        {
+            const XMFLOAT3& p = positions[i];
+            keys.push_back({ float(i), p, XMFLOAT3(p.x, p.y, p.z - 1.0f), XMConvertToRadians(40.0f + 10.0f * float(i)) });
+        }
+
+        CameraPath path;
+        path.SetKeys(keys);
+        return path;
+    }
+}
+
+TEST(CameraPath, ParsesKeyframes)
+{
+    CameraPath path;
+    REQUIRE(SUCCEEDED(LoadPath(path, "CameraPath.Parses.txt",
+        "# time  position  target  [fov]\n"
+        "\n"
+        "0    0 75 150    0 0 0\r\n"
+        "  2.5  10 20 30  1 2 3  45   # narrower\n"
+        "\t \n"
+        "4 -1 -2 -3 0 0 -1 90")));
+
+    const std::vector<CameraKey>& keys = path.GetKeys();
+    REQUIRE(keys.size() == 3);
+
+    CHECK_EQ(keys[0].Time, 0.0f);
+    CHECK(IsNear(keys[0].Position, XMFLOAT3(0, 75, 150)));
+    CHECK(IsNear(keys[0].Target, XMFLOAT3(0, 0, 0)));
+    CHECK(std::fabs(keys[0].FovY - XMConvertToRadians(60.0f)) < 1e-6f);
+
+    CHECK_EQ(keys[1].Time, 2.5f);
+    CHECK(IsNear(keys[1].Position, XMFLOAT3(10, 20, 30)));
+    CHECK(IsNear(keys[1].Target, XMFLOAT3(1, 2, 3)));
+    CHECK(std::fabs(keys[1].FovY - XMConvertToRadians(45.0f)) < 1e-6f);
+
+    CHECK(IsNear(keys[2].Position, XMFLOAT3(-1, -2, -3)));
+    CHECK(std::fabs(keys[2].FovY - XMConvertToRadians(90.0f)) < 1e-6f);
+    CHECK_EQ(path.GetDuration(), 4.0f);
+
+    // A file of comments is an empty path.
+    REQUIRE(SUCCEEDED(LoadPath(path, "CameraPath.Empty.txt", "# nothing yet\n\n")));
+    CHECK(path.IsEmpty());
+    CHECK_EQ(path.GetDuration(), 0.0f);
+}
+
+TEST(CameraPath, RejectsMalformedPaths)
+{
+    CameraPath path;
+    REQUIRE(SUCCEEDED(LoadPath(path, "CameraPath.Valid.txt", "0 0 0 0 0 0 -1\n1 1 0 0 1 0 -1\n")));
+
+    CHECK_EQ(path.LoadFromFile(L"Assets/Missing.txt"), E_INVALIDARG);
+
+    const char* const malformed[] =
+    {
+        "0 0 0 0 0 0\n",                         // A coordinate short
+        "0 0 0 0 0 0 -1 wide\n",                 // Not a field of view
+        "start 0 0 0 0 0 -1\n",                  // Not a time
+        "0 0 0 0 0 0 -1\n0 1 0 0 1 0 -1\n",      // Times that don't increase
+        "1 0 0 0 0 0 -1\n0 1 0 0 1 0 -1\n",
+        "0 0 0 0 0 0 -1 0\n",                    // Fields of view out of range
+        "0 0 0 0 0 0 -1 180\n",
+    };
+
+    bool allRejected = true;
+    for (const char* contents : malformed)
+    {
+        allRejected &= LoadPath(path, "CameraPath.Malformed.txt", contents) == E_INVALIDARG;
+    }
+    CHECK(allRejected);
+
+    // A failed load keeps the path it had.
+    CHECK_EQ(path.GetKeys().size(), 2u);
+    CHECK_EQ(path.GetDuration(), 1.0f);
+
+    std::vector<CameraKey> keys = path.GetKeys();
+    keys[1].Time = keys[0].Time;
+    CHECK_EQ(path.SetKeys(keys), E_INVALIDARG);
+}
+
+TEST(CameraPath, InterpolatesWithCatmullRom)
+{
+    const CameraPath path = MakePath();
+    const std::vector<CameraKey>& keys = path.GetKeys();
+
+    // Segments pass through their keys, at either end.
+    bool throughKeys = true;
+    for (const CameraKey& key : keys)
+    {
+        const CameraKey evaluated = path.Evaluate(key.Time);
+        throughKeys &= IsNear(evaluated.Position, key.Position) && IsNear(evaluated.Target, key.Target) && std::fabs(evaluated.FovY - key.FovY) < 1e-6f;
+    }
+    CHECK(throughKeys);
+
+    // Midway the spline weights the segment's keys 9/16 and the outer ones -1/16.
+    CHECK(IsNear(path.Evaluate(1.5).Position, XMFLOAT3(23.0f / 16.0f, 0.5f, 0.0f)));
+    CHECK(IsNear(path.Evaluate(1.5).Target, XMFLOAT3(23.0f / 16.0f, 0.5f, -1.0f)));
+
+    // The first and last segments repeat their end key as the missing outer control point.
+    CHECK(IsNear(path.Evaluate(0.5).Position, XMFLOAT3(7.0f / 16.0f, -1.0f / 16.0f, 0.0f)));
+    CHECK(IsNear(path.Evaluate(2.5).Position, XMFLOAT3(49.0f / 16.0f, 17.0f / 16.0f, 0.0f)));
+
+    // The field of view is linear within a segment.
+    CHECK(std::fabs(path.Evaluate(2.25).FovY - XMConvertToRadians(62.5f)) < 1e-5f);
+
+    // The path is continuous across keys and clamped past its ends.
+    CHECK(IsNear(path.Evaluate(1.0 - 1e-4).Position, keys[1].Position, 1e-3f));
+    CHECK(IsNear(path.Evaluate(1.0 + 1e-4).Position, keys[1].Position, 1e-3f));
+    CHECK(IsNear(path.Evaluate(-1.0).Position, keys.front().Position));
+    CHECK(IsNear(path.Evaluate(10.0).Position, keys.back().Position));
+
+    // An empty path looks down -Z from the origin.
+    const CameraKey origin = CameraPath().Evaluate(1.0);
+    CHECK(IsNear(origin.Position, XMFLOAT3(0, 0, 0)));
+    CHECK(IsNear(origin.Target, XMFLOAT3(0, 0, -1)));
+}
@@ -0,0 +1,306 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "ClusterDag.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+// The DAG is built from a bumpy height field, so every level of simplification has a nonzero
+// error, and viewed down the z axis, where a point's view-space distance is plain to see.
+namespace
+{
+    const uint32_t c_gridSize = 64; // Quads per side
+    const float    c_fovY = XM_PIDIV4;
+    const float    c_viewportHeight = 1080.0f;
+
+    struct HeightField
+    {
+        std::vector<XMFLOAT3> Positions;
+        std::vector<uint32_t> Indices;
+    };
+
+    HeightField MakeHeightField()
+    {
+        HeightField field;
+        for (uint32_t y = 0; y <= c_gridSize; ++y)
+        {
+            for (uint32_t x = 0; x <= c_gridSize; ++x)
+            {
+                const float u = float(x) / c_gridSize, v = float(y) / c_gridSize;
+                field.Positions.push_back(XMFLOAT3(u, v, 0.05f * std::sin(u * 13.0f) * std::cos(v * 11.0f)));
+            }
+        }
+
+        for (uint32_t y = 0; y < c_gridSize; ++y)
+        {
+            for (uint32_t x = 0; x < c_gridSize; ++x)
+            {
+                const uint32_t i = y * (c_gridSize + 1) + x;
+                const uint32_t quad[6] = { i, i + 1, i + c_gridSize + 1, i + 1, i + c_gridSize + 2, i + c_gridSize + 1 };
+                field.Indices.insert(field.Indices.end(), quad, quad + 6);
+            }
+        }
+        return field;
+    }
+
+    const HeightField& GetHeightField()
+    {
+        static const HeightField field = MakeHeightField();
+        return field;
+    }
+
+    const ClusterDag& GetDag()
+    {
+        static ClusterDag dag;
+        if (dag.GetClusterCount() == 0)
+        {
+            const HeightField& field = GetHeightField();
+            dag.Build(field.Positions.data(), uint32_t(field.Positions.size()), field.Indices.data(), uint32_t(field.Indices.size()));
+        }
+        return dag;
+    }
+
+    // The mesh 'distance' units in front of the camera, centered on the view axis.
+    XMFLOAT4X4 ViewFrom(float distance)
+    {
+        XMFLOAT4X4 worldView;
+        XMStoreFloat4x4(&worldView, XMMatrixTranslation(-0.5f, -0.5f, distance));
+        return worldView;
+    }
+
+    // The error of a sphere at 'distance' in front of the camera, in pixels: the world-space
+    // error over the height of the view frustum at the sphere's near side, which is kept a
+    // millimetre away when the camera is inside the sphere.
+    float ProjectError(const XMFLOAT4& bounds, float error, float distance)
+    {
+        const float x = bounds.x - 0.5f, y = bounds.y - 0.5f, z = bounds.z + distance;
+        const float nearSide = std::max(std::sqrt(x * x + y * y + z * z) - bounds.w, 1e-3f);
+        return error * c_viewportHeight / (2.0f * std::tan(c_fovY * 0.5f) * nearSide);
+    }
+
+    // Edges of the given clusters' triangles that no other triangle shares, other than those
+    // between two points of the height field's outline; the simplifier slides open borders
+    // along themselves, which can cut a corner. A cut with a crack or an overlap has some.
+    uint32_t CountInteriorOpenEdges(const ClusterDag& dag, const std::vector<uint32_t>& clusters)
+    {
+        const XMFLOAT3* positions = GetHeightField().Positions.data();
+
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        for (uint32_t cluster : clusters)
+        {
+            const Meshlet& meshlet = dag.GetMeshlets()[cluster];
+            for (uint32_t p = 0; p < meshlet.PrimCount; ++p)
+            {
+                const PackedTriangle& tri = dag.GetPrimitiveIndices()[meshlet.PrimOffset + p];
+                const uint32_t* vertices = &dag.GetUniqueVertexIndices()[meshlet.VertOffset];
+                const uint32_t v[3] = { vertices[tri.i0], vertices[tri.i1], vertices[tri.i2] };
+
+                for (uint32_t e = 0; e < 3; ++e)
+                {
+                    edges.emplace_back(v[e], v[(e + 1) % 3]);
+                }
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        auto onOutline = [&](uint32_t v)
+        {
+            const XMFLOAT3& p = positions[v];
+            return p.x == 0.0f || p.x == 1.0f || p.y == 0.0f || p.y == 1.0f;
+        };
+
+        uint32_t count = 0;
+        for (const auto& edge : edges)
+        {
+            const auto twin = std::make_pair(edge.second, edge.first);
+            if (!std::binary_search(edges.begin(), edges.end(), twin) && !(onOutline(edge.first) && onOutline(edge.second)))
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    std::vector<uint32_t> ClustersAtLevel(const ClusterDag& dag, uint32_t level)
+    {
+        std::vector<uint32_t> clusters;
+        for (uint32_t i = 0; i < dag.GetClusterCount(); ++i)
+        {
+            if (dag.GetClusterLods()[i].Level == level)
+            {
+                clusters.push_back(i);
+            }
+        }
+        return clusters;
+    }
+
+    uint32_t TriangleCount(const ClusterDag& dag, const std::vector<uint32_t>& clusters)
+    {
+        uint32_t count = 0;
+        for (uint32_t cluster : clusters)
+        {
+            count += dag.GetMeshlets()[cluster].PrimCount;
+        }
+        return count;
+    }
+}
+
+TEST(ClusterDag, BuildsLevelsWithGrowingError)
+{
+    const ClusterDag& dag = GetDag();
+    REQUIRE(dag.GetLevelCount() > 2);
+
+    // Level 0 is the source mesh, at no error.
+    const std::vector<uint32_t> source = ClustersAtLevel(dag, 0);
+    CHECK_EQ(TriangleCount(dag, source), c_gridSize * c_gridSize * 2);
+
+    uint32_t roots = 0;
+    for (uint32_t i = 0; i < dag.GetClusterCount(); ++i)
+    {
+        const ClusterLod& lod = dag.GetClusterLods()[i];
+        CHECK(lod.Level < dag.GetLevelCount());
+        CHECK(lod.Level > 0 || lod.Error == 0.0f);
+        CHECK(lod.ParentError >= lod.Error);
+
+        if (lod.ParentError == FLT_MAX)
+        {
+            ++roots;
+        }
+        else
+        {
+            // The parent's bounds contain the cluster's, so its projected error is never smaller.
+            const XMVECTOR offset = XMLoadFloat4(&lod.ParentBounds) - XMLoadFloat4(&lod.Bounds);
+            CHECK(XMVectorGetX(XMVector3Length(offset)) + lod.Bounds.w <= lod.ParentBounds.w * 1.001f);
+        }
+    }
+    CHECK(roots > 0);
+
+    // Every level covers the whole surface with fewer triangles than the one below it.
+    CHECK_EQ(CountInteriorOpenEdges(dag, source), 0u);
+    for (uint32_t level = 1; level < dag.GetLevelCount(); ++level)
+    {
+        const std::vector<uint32_t> clusters = ClustersAtLevel(dag, level);
+        CHECK(TriangleCount(dag, clusters) < TriangleCount(dag, ClustersAtLevel(dag, level - 1)));
+        CHECK_EQ(CountInteriorOpenEdges(dag, clusters), 0u);
+    }
+}
+
+TEST(ClusterDag, SelectsClustersWithinThresholdUnderParent)
+{
+    const ClusterDag& dag = GetDag();
+
+    const float distances[] = { 0.5f, 2.0f, 8.0f };
+    const float thresholds[] = { 0.5f, 1.0f, 4.0f };
+    for (float distance : distances)
+    {
+        for (float threshold : thresholds)
+        {
+            std::vector<uint32_t> selected;
+            const uint32_t triangles = dag.SelectClusters(ViewFrom(distance), c_fovY, c_viewportHeight, threshold, selected);
+            CHECK_EQ(triangles, TriangleCount(dag, selected));
+
+            // Exactly the clusters fine enough for the threshold whose parent isn't.
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < dag.GetClusterCount(); ++i)
+            {
+                const ClusterLod& lod = dag.GetClusterLods()[i];
+                if (ProjectError(lod.Bounds, lod.Error, distance) <= threshold &&
+                    (lod.ParentError == FLT_MAX || ProjectError(lod.ParentBounds, lod.ParentError, distance) > threshold))
+                {
+                    expected.push_back(i);
+                }
+            }
+            CHECK(selected == expected);
+
+            // Which never leaves a hole or covers a part of the surface twice.
+            CHECK_EQ(CountInteriorOpenEdges(dag, selected), 0u);
+        }
+    }
+}
+
+TEST(ClusterDag, SelectsSourceUpCloseAndRootsFarAway)
+{
+    const ClusterDag& dag = GetDag();
+
+    // At a threshold of zero only the error-free source clusters qualify.
+    std::vector<uint32_t> selected;
+    CHECK_EQ(dag.SelectClusters(ViewFrom(1.0f), c_fovY, c_viewportHeight, 0.0f, selected), c_gridSize * c_gridSize * 2);
+    CHECK(selected == ClustersAtLevel(dag, 0));
+
+    // Far enough away that the roots' error is below a pixel.
+    dag.SelectClusters(ViewFrom(1e6f), c_fovY, c_viewportHeight, 1.0f, selected);
+    REQUIRE(!selected.empty());
+    for (uint32_t cluster : selected)
+    {
+        CHECK_EQ(dag.GetClusterLods()[cluster].ParentError, FLT_MAX);
+    }
+
+    // The cut only coarsens as the camera moves away.
+    uint32_t previous = UINT32_MAX;
+    for (float distance = 0.25f; distance < 1000.0f; distance *= 2.0f)
+    {
+        const uint32_t triangles = dag.SelectClusters(ViewFrom(distance), c_fovY, c_viewportHeight, 1.0f, selected);
+        CHECK(triangles <= previous);
+        previous = triangles;
+    }
+}
+
+TEST(ClusterDag, SelectsFinestCutWithinBudget)
+{
+    const ClusterDag& dag = GetDag();
+    const XMFLOAT4X4 worldView = ViewFrom(1.0f);
+
+    const uint32_t budgets[] = { 1000, 2500, 6000 };
+    for (uint32_t budget : budgets)
+    {
+        std::vector<uint32_t> selected;
+        const float threshold = dag.SelectClustersWithBudget(worldView, c_fovY, c_viewportHeight, budget, selected);
+        CHECK(TriangleCount(dag, selected) <= budget);
+
+        // The cut it returns is the one for its threshold, and a finer threshold is over budget.
+        std::vector<uint32_t> cut;
+        dag.SelectClusters(worldView, c_fovY, c_viewportHeight, threshold, cut);
+        CHECK(cut == selected);
+        CHECK(dag.SelectClusters(worldView, c_fovY, c_viewportHeight, threshold * 0.99f, cut) > budget);
+    }
+
+    // A budget the source fits in selects the source.
+    std::vector<uint32_t> selected;
+    dag.SelectClustersWithBudget(worldView, c_fovY, c_viewportHeight, c_gridSize * c_gridSize * 2, selected);
+    CHECK(selected == ClustersAtLevel(dag, 0));
+}
+
+TEST(ClusterDag, BuildsSameHierarchyOnAnyThreadCount)
+{
+    const HeightField& field = GetHeightField();
+    const ClusterDag& reference = GetDag();
+
+    const uint32_t threadCounts[] = { 1, 3 };
+    for (uint32_t threadCount : threadCounts)
+    {
+        ClusterDag dag;
+        dag.Build(field.Positions.data(), uint32_t(field.Positions.size()), field.Indices.data(), uint32_t(field.Indices.size()), threadCount);
+        REQUIRE(dag.GetClusterCount() == reference.GetClusterCount());
+        CHECK_EQ(dag.GetLevelCount(), reference.GetLevelCount());
+        CHECK(dag.GetUniqueVertexIndices() == reference.GetUniqueVertexIndices());
+
+        for (uint32_t i = 0; i < dag.GetClusterCount(); ++i)
+        {
+            CHECK_EQ(dag.GetMeshlets()[i].PrimCount, reference.GetMeshlets()[i].PrimCount);
+            CHECK_EQ(dag.GetClusterLods()[i].Error, reference.GetClusterLods()[i].Error);
+        }
+    }
+}
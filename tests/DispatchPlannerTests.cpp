@@ -0,0 +1,239 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "DispatchPlanner.h"
+#include "FixedFunctionContext.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // Whether a plan's grid is a legal DispatchMesh() holding its groups with fewer than one
+    // row of X spare.
+    bool IsValidPlan(const DispatchPlan& plan, uint32_t groupCount)
+    {
+        const uint64_t gridGroups = uint64_t(plan.GridSize[0]) * plan.GridSize[1] * plan.GridSize[2];
+        const uint64_t rowCount = uint64_t(plan.GridSize[1]) * plan.GridSize[2];
+
+        return plan.GroupCount == groupCount
+            && plan.GridSize[0] >= 1 && plan.GridSize[0] <= c_maxDispatchGroupsPerDimension
+            && plan.GridSize[1] >= 1 && plan.GridSize[1] <= c_maxDispatchGroupsPerDimension
+            && plan.GridSize[2] >= 1 && plan.GridSize[2] <= c_maxDispatchGroupsPerDimension
+            && gridGroups <= c_maxDispatchGroups
+            && gridGroups >= groupCount
+            && gridGroups - groupCount < plan.GridSize[0]
+            && (rowCount == 1 || gridGroups - groupCount < rowCount);
+    }
+
+    // Triangle list draws the context splits, by the dispatches it records.
+    struct RecordedDispatch
+    {
+        MeshDrawParams Params;
+        uint32_t       GroupCount[3];
+    };
+
+    std::vector<RecordedDispatch> RecordDraw(uint32_t vertexCount, uint32_t instanceCount)
+    {
+        RecordingDrawTarget target;
+        FixedFunctionContext context(target);
+
+        // No buffers bound; the translation doesn't read them.
+        VertexLayout layout = {};
+        layout.PositionElement = ~0u;
+        context.SetVertexLayout(layout);
+        context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        context.DrawInstanced(vertexCount, instanceCount, 0, 0);
+
+        std::vector<RecordedDispatch> dispatches;
+        MeshDrawParams params = {};
+        for (const RecordingDrawTarget::Command& command : target.GetCommands())
+        {
+            if (command.Type == RecordingDrawTarget::Command::SetDrawParams)
+            {
+                params = command.Params;
+            }
+            else if (command.Type == RecordingDrawTarget::Command::DispatchMesh)
+            {
+                RecordedDispatch dispatch = { params, { command.GroupCount[0], command.GroupCount[1], command.GroupCount[2] } };
+                dispatches.push_back(dispatch);
+            }
+        }
+        return dispatches;
+    }
+}
+
+TEST(DispatchPlanner, CountsGroupsRoundingUp)
+{
+    CHECK_EQ(GetDispatchGroupCount(0, 21), 0u);
+    CHECK_EQ(GetDispatchGroupCount(1, 21), 1u);
+    CHECK_EQ(GetDispatchGroupCount(21, 21), 1u);
+    CHECK_EQ(GetDispatchGroupCount(22, 21), 2u);
+    CHECK_EQ(GetDispatchGroupCount(0xffffffffu, 1), 0xffffffffu);
+    CHECK_EQ(GetDispatchGroupCount(0xffffffffu, 2), 0x80000000u);
+    CHECK_EQ(GetDispatchGroupCount(5, 0), 0u);
+}
+
+TEST(DispatchPlanner, KeepsOneRowAlongX)
+{
+    DispatchPlan plan;
+    REQUIRE(PlanDispatch(0, plan));
+    CHECK_EQ(plan.GroupCount, 0u);
+
+    const uint32_t counts[] = { 1, 2, 1000, c_maxDispatchGroupsPerDimension };
+    for (uint32_t count : counts)
+    {
+        REQUIRE(PlanDispatch(count, plan));
+        CHECK_EQ(plan.GridSize[0], count);
+        CHECK_EQ(plan.GridSize[1], 1u);
+        CHECK_EQ(plan.GridSize[2], 1u);
+    }
+}
+
+TEST(DispatchPlanner, SplitsOverYPastOneRow)
+{
+    // One past a row takes two rows of half the groups each.
+    DispatchPlan plan;
+    REQUIRE(PlanDispatch(c_maxDispatchGroupsPerDimension + 1, plan));
+    CHECK_EQ(plan.GridSize[0], 32768u);
+    CHECK_EQ(plan.GridSize[1], 2u);
+    CHECK_EQ(plan.GridSize[2], 1u);
+    CHECK(IsValidPlan(plan, c_maxDispatchGroupsPerDimension + 1));
+
+    // Exactly the total limit: 64 rows would be 65536 long, and rounding 65 to 127 rows up
+    // overshoots the limit, so the planner ends at 128 rows that divide it.
+    REQUIRE(PlanDispatch(c_maxDispatchGroups, plan));
+    CHECK_EQ(plan.GridSize[0], 32768u);
+    CHECK_EQ(plan.GridSize[1], 128u);
+    CHECK_EQ(plan.GridSize[2], 1u);
+    CHECK(IsValidPlan(plan, c_maxDispatchGroups));
+}
+
+TEST(DispatchPlanner, PlansEveryCountUpToTheLimit)
+{
+    // Primes and the counts around powers of two and of the per-dimension limit.
+    std::vector<uint32_t> counts = { 3, 65521, 65537, 131071, 1048573, 4194301 };
+    for (uint32_t bit = 1; bit <= 22; ++bit)
+    {
+        counts.push_back((1u << bit) - 1);
+        counts.push_back(1u << bit);
+        counts.push_back((1u << bit) + 1);
+    }
+    for (uint32_t rows = 1; rows <= 64; ++rows)
+    {
+        counts.push_back(rows * c_maxDispatchGroupsPerDimension - 1);
+        counts.push_back(rows * c_maxDispatchGroupsPerDimension);
+        counts.push_back(rows * c_maxDispatchGroupsPerDimension + 1);
+    }
+
+    for (uint32_t count : counts)
+    {
+        if (count > c_maxDispatchGroups)
+            continue;
+
+        DispatchPlan plan;
+        if (!CHECK(PlanDispatch(count, plan)) || !CHECK(IsValidPlan(plan, count)))
+        {
+            CHECK_EQ(count, 0u); // Names the failing count
+        }
+    }
+}
+
+TEST(DispatchPlanner, RejectsCountsPastTheLimit)
+{
+    DispatchPlan plan;
+    CHECK(!PlanDispatch(c_maxDispatchGroups + 1, plan));
+    CHECK(!PlanDispatch(0xffffffffu, plan));
+    CHECK_EQ(plan.GroupCount, 0u);
+}
+
+TEST(DispatchPlanner, NumbersEachGroupOnce)
+{
+    // A grid of a few rows, with a partial last row.
+    const uint32_t count = 3 * c_maxDispatchGroupsPerDimension + 7;
+    DispatchPlan plan;
+    REQUIRE(PlanDispatch(count, plan));
+
+    std::vector<uint8_t> seen(count);
+    uint32_t spare = 0;
+    for (uint32_t z = 0; z < plan.GridSize[2]; ++z)
+    for (uint32_t y = 0; y < plan.GridSize[1]; ++y)
+    for (uint32_t x = 0; x < plan.GridSize[0]; ++x)
+    {
+        const uint32_t id = GetLinearGroupId(plan, x, y, z);
+        if (id < count)
+        {
+            CHECK_EQ(seen[id]++, 0);
+        }
+        else
+        {
+            ++spare;
+        }
+    }
+    CHECK(spare < plan.GridSize[0]);
+    CHECK(std::find(seen.begin(), seen.end(), uint8_t(0)) == seen.end());
+}
+
+TEST(DispatchPlanner, SplitsLongDrawsAtTheLimit)
+{
+    // 21 triangles a group: a draw of exactly c_maxDispatchGroups groups goes out whole, and
+    // one more triangle starts a second dispatch at the first location past the first.
+    const uint32_t maxVertices = c_maxDispatchGroups * c_groupVertexCount;
+
+    std::vector<RecordedDispatch> dispatches = RecordDraw(maxVertices, 1);
+    REQUIRE(dispatches.size() == 1);
+    CHECK_EQ(dispatches[0].Params.GroupCount, c_maxDispatchGroups);
+    CHECK_EQ(dispatches[0].Params.VertexCount, maxVertices);
+
+    dispatches = RecordDraw(maxVertices + 3, 1);
+    REQUIRE(dispatches.size() == 2);
+    CHECK_EQ(dispatches[0].Params.GroupCount, c_maxDispatchGroups);
+    CHECK_EQ(dispatches[0].Params.StartLocation, 0u);
+    CHECK_EQ(dispatches[1].Params.GroupCount, 1u);
+    CHECK_EQ(dispatches[1].Params.StartLocation, maxVertices);
+    CHECK_EQ(dispatches[1].Params.VertexCount, 3u);
+
+    for (const RecordedDispatch& dispatch : dispatches)
+    {
+        CHECK_EQ(dispatch.Params.GridSizeX, dispatch.GroupCount[0]);
+        CHECK_EQ(dispatch.Params.GridSizeY, dispatch.GroupCount[1]);
+        CHECK(uint64_t(dispatch.GroupCount[0]) * dispatch.GroupCount[1] * dispatch.GroupCount[2] <= c_maxDispatchGroups);
+    }
+}
+
+TEST(DispatchPlanner, SplitsInstanceRowsAtTheLimit)
+{
+    // 1000 groups per instance row: 4194 rows fit a dispatch, so 10000 instances take three.
+    const uint32_t rowsPerDispatch = c_maxDispatchGroups / 1000;
+    const std::vector<RecordedDispatch> dispatches = RecordDraw(1000 * c_groupVertexCount, 10000);
+    REQUIRE(dispatches.size() == 3);
+
+    uint32_t instance = 0;
+    for (const RecordedDispatch& dispatch : dispatches)
+    {
+        const MeshDrawParams& params = dispatch.Params;
+        CHECK_EQ(params.FirstInstance, instance);
+        CHECK_EQ(params.GroupsPerRow, 1000u);
+        CHECK_EQ(params.GroupCount, params.InstanceCount * 1000);
+        CHECK(params.InstanceCount <= rowsPerDispatch);
+
+        // The last group of the dispatch is the last row's last.
+        const uint32_t last = params.GroupCount - 1;
+        uint32_t groupX, groupY;
+        REQUIRE(GetDispatchGroup(params, last % params.GridSizeX, last / params.GridSizeX % params.GridSizeY, last / params.GridSizeX / params.GridSizeY, groupX, groupY));
+        CHECK_EQ(groupX, 999u);
+        CHECK_EQ(groupY, params.InstanceCount - 1);
+
+        instance += params.InstanceCount;
+    }
+    CHECK_EQ(instance, 10000u);
+}
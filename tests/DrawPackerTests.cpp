@@ -0,0 +1,173 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "DrawPacker.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::vector<PackItem> Items(const std::vector<uint32_t>& vertexCounts)
+    {
+        std::vector<PackItem> items;
+        for (uint32_t vertexCount : vertexCounts)
+        {
+            items.push_back(PackItem{ vertexCount, vertexCount / 3 });
+        }
+        return items;
+    }
+
+    // Whether the packing places every item once, within the limits, with each group's
+    // items contiguous in 'order' and in submission order.
+    bool IsValidPacking(const std::vector<PackItem>& items, const PackLimits& limits, const std::vector<PackGroup>& groups, const std::vector<uint32_t>& order)
+    {
+        if (order.size() != items.size())
+            return false;
+
+        std::vector<uint8_t> placed(items.size());
+        uint32_t next = 0;
+        for (const PackGroup& group : groups)
+        {
+            if (group.FirstItem != next || group.ItemCount == 0)
+                return false;
+
+            uint32_t vertices = 0, primitives = 0;
+            for (uint32_t i = group.FirstItem; i < group.FirstItem + group.ItemCount; ++i)
+            {
+                if (order[i] >= items.size() || placed[order[i]]++ != 0)
+                    return false;
+                if (i > group.FirstItem && order[i] < order[i - 1])
+                    return false;
+
+                vertices += items[order[i]].VertexCount;
+                primitives += items[order[i]].PrimitiveCount;
+            }
+
+            if (vertices != group.VertexCount || primitives != group.PrimitiveCount)
+                return false;
+            if (vertices > limits.MaxVertices || primitives > limits.MaxPrimitives)
+                return false;
+
+            next += group.ItemCount;
+        }
+        return next == items.size();
+    }
+}
+
+TEST(DrawPacker, PacksInOrderByNextFit)
+{
+    // 6 | 5 4 | 3 2 within 10 vertices: each group closes when the next item doesn't fit.
+    const std::vector<PackItem> items = Items({ 6, 5, 4, 3, 2 });
+    const PackLimits limits = { 10, 10 };
+
+    std::vector<PackGroup> groups;
+    std::vector<uint32_t> order;
+    REQUIRE(PackItems(items.data(), uint32_t(items.size()), limits, PackMode::InOrder, groups, order));
+    CHECK(IsValidPacking(items, limits, groups, order));
+
+    REQUIRE(groups.size() == 3);
+    CHECK_EQ(groups[0].ItemCount, 1u);
+    CHECK_EQ(groups[1].ItemCount, 2u);
+    CHECK_EQ(groups[1].VertexCount, 9u);
+    CHECK_EQ(groups[2].ItemCount, 2u);
+    CHECK(order == std::vector<uint32_t>({ 0, 1, 2, 3, 4 }));
+}
+
+TEST(DrawPacker, PacksBestFitDecreasing)
+{
+    // 6 and 5 open a group each; 4 fills the 6's group to 10, then 3 and 2 fill the 5's.
+    const std::vector<PackItem> items = Items({ 6, 5, 4, 3, 2 });
+    const PackLimits limits = { 10, 10 };
+
+    std::vector<PackGroup> groups;
+    std::vector<uint32_t> order;
+    REQUIRE(PackItems(items.data(), uint32_t(items.size()), limits, PackMode::BestFitDecreasing, groups, order));
+    CHECK(IsValidPacking(items, limits, groups, order));
+
+    REQUIRE(groups.size() == 2);
+    CHECK_EQ(groups[0].VertexCount, 10u);
+    CHECK_EQ(groups[1].VertexCount, 10u);
+    CHECK(order == std::vector<uint32_t>({ 0, 2, 1, 3, 4 }));
+}
+
+TEST(DrawPacker, HonorsThePrimitiveLimit)
+{
+    // Points: many vertices, no primitives; then triangles that run out of primitives first.
+    std::vector<PackItem> items = { { 4, 0 }, { 4, 0 }, { 3, 5 }, { 3, 5 }, { 3, 5 } };
+    const PackLimits limits = { 64, 10 };
+
+    for (PackMode::EType mode : { PackMode::InOrder, PackMode::BestFitDecreasing })
+    {
+        std::vector<PackGroup> groups;
+        std::vector<uint32_t> order;
+        REQUIRE(PackItems(items.data(), uint32_t(items.size()), limits, mode, groups, order));
+        CHECK(IsValidPacking(items, limits, groups, order));
+        CHECK_EQ(groups.size(), 2u);
+    }
+}
+
+TEST(DrawPacker, RejectsItemsOverTheLimits)
+{
+    const PackLimits limits = { 64, 21 };
+    std::vector<PackGroup> groups = { PackGroup() };
+    std::vector<uint32_t> order = { 0 };
+
+    std::vector<PackItem> items = { { 3, 1 }, { 65, 1 } };
+    CHECK(!PackItems(items.data(), uint32_t(items.size()), limits, PackMode::InOrder, groups, order));
+    CHECK(groups.empty());
+    CHECK(order.empty());
+
+    items[1] = { 3, 22 };
+    CHECK(!PackItems(items.data(), uint32_t(items.size()), limits, PackMode::BestFitDecreasing, groups, order));
+
+    // Items exactly at the limits take a group each.
+    items[1] = { 64, 21 };
+    REQUIRE(PackItems(items.data(), uint32_t(items.size()), limits, PackMode::InOrder, groups, order));
+    CHECK_EQ(groups.size(), 2u);
+
+    CHECK(PackItems(items.data(), 0, limits, PackMode::InOrder, groups, order));
+    CHECK(groups.empty());
+}
+
+TEST(DrawPacker, PacksRandomDrawsValidly)
+{
+    std::mt19937 random(7);
+    std::uniform_int_distribution<uint32_t> triangles(1, 21);
+    const PackLimits limits = { 63, 21 };
+
+    for (uint32_t run = 0; run < 50; ++run)
+    {
+        std::vector<PackItem> items(1 + random() % 2000);
+        uint32_t totalVertices = 0;
+        for (PackItem& item : items)
+        {
+            item.PrimitiveCount = triangles(random);
+            item.VertexCount = item.PrimitiveCount * 3;
+            totalVertices += item.VertexCount;
+        }
+
+        std::vector<PackGroup> inOrder, bestFit;
+        std::vector<uint32_t> order;
+        REQUIRE(PackItems(items.data(), uint32_t(items.size()), limits, PackMode::InOrder, inOrder, order));
+        CHECK(IsValidPacking(items, limits, inOrder, order));
+        REQUIRE(PackItems(items.data(), uint32_t(items.size()), limits, PackMode::BestFitDecreasing, bestFit, order));
+        CHECK(IsValidPacking(items, limits, bestFit, order));
+
+        // Neither can beat the groups the vertices alone need, and on these draws best fit
+        // needs no more than next fit.
+        const uint32_t lowerBound = (totalVertices + limits.MaxVertices - 1) / limits.MaxVertices;
+        CHECK(inOrder.size() >= lowerBound);
+        CHECK(bestFit.size() >= lowerBound);
+        CHECK(bestFit.size() <= inOrder.size());
+    }
+}
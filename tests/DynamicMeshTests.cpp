@@ -0,0 +1,238 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "DynamicMesh.h"
+#include "RingAllocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    // As in D3D12MeshletRender: frames in flight sharing a ring of one frame more than are in
+    // flight, with allocations aligned to 16 bytes.
+    const uint32_t c_frameCount = 2;
+    const uint64_t c_alignment = 16;
+
+    // A cloth of c_clothSize x c_clothSize quads, two triangles each, filling two chunks.
+    const uint32_t c_clothSize = 32;
+    const uint32_t c_clothVertexCount = (c_clothSize + 1) * (c_clothSize + 1);
+
+    std::vector<uint32_t> MakeClothIndices()
+    {
+        std::vector<uint32_t> indices;
+        for (uint32_t y = 0; y < c_clothSize; ++y)
+        {
+            for (uint32_t x = 0; x < c_clothSize; ++x)
+            {
+                const uint32_t a = y * (c_clothSize + 1) + x;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + c_clothSize + 1;
+                const uint32_t d = c + 1;
+                indices.insert(indices.end(), { a, b, d, a, d, c });
+            }
+        }
+
+        return indices;
+    }
+
+    // The cloth waved the way the renderer waves the model, 'time' seconds in.
+    void WaveCloth(float time, XMFLOAT3* positions)
+    {
+        for (uint32_t v = 0; v < c_clothVertexCount; ++v)
+        {
+            const float x = float(v % (c_clothSize + 1)) / c_clothSize;
+            const float y = float(v / (c_clothSize + 1)) / c_clothSize;
+            positions[v] = XMFLOAT3(x, y, 0.02f * std::sin(2.0f * time + x * 20.0f));
+        }
+    }
+
+    uint64_t AlignUp(uint64_t size)
+    {
+        return (size + c_alignment - 1) & ~(c_alignment - 1);
+    }
+
+    // The bytes one frame wrote to the ring, and the fence that frees them.
+    struct FrameStream
+    {
+        uint64_t FenceValue;
+        uint64_t Offset;
+        uint64_t Size;
+        std::vector<uint8_t> Contents;
+    };
+
+    // Sub-allocates 'size' bytes for one of the frame's streams and fills them from 'data'.
+    // Returns whether the allocation fit, aligned, inside the ring.
+    bool WriteStream(RingAllocator& ring, std::vector<uint8_t>& memory, const void* data, uint64_t size, uint64_t fenceValue, std::vector<FrameStream>& streams)
+    {
+        const uint64_t offset = ring.Allocate(size, c_alignment);
+        if (offset == RingAllocator::InvalidOffset || offset % c_alignment != 0 || offset + size > memory.size())
+            return false;
+
+        memcpy(memory.data() + offset, data, size_t(size));
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        streams.push_back({ fenceValue, offset, size, std::vector<uint8_t>(bytes, bytes + size) });
+        return true;
+    }
+
+    template <typename T>
+    bool WriteStream(RingAllocator& ring, std::vector<uint8_t>& memory, const std::vector<T>& data, uint64_t fenceValue, std::vector<FrameStream>& streams)
+    {
+        return WriteStream(ring, memory, data.data(), data.size() * sizeof(T), fenceValue, streams);
+    }
+
+    bool IsSameCullData(const std::vector<CullData>& a, const std::vector<CullData>& b)
+    {
+        return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(CullData)) == 0;
+    }
+}
+
+TEST(DynamicMesh, RefreshesOnlyTheMeshletsOfMovedVertices)
+{
+    const std::vector<uint32_t> indices = MakeClothIndices();
+    std::vector<XMFLOAT3> positions(c_clothVertexCount);
+    WaveCloth(0.0f, positions.data());
+
+    DynamicMesh mesh;
+    mesh.SetTriangles(indices.data(), static_cast<uint32_t>(indices.size()), c_clothVertexCount);
+
+    DynamicMeshRefresh refresh = mesh.Refresh(positions.data());
+    const uint32_t meshletCount = static_cast<uint32_t>(mesh.GetMeshlets().size());
+    CHECK_EQ(refresh.RebuiltChunks, 2u);
+    CHECK_EQ(refresh.RefreshedMeshlets, meshletCount);
+    CHECK(refresh.LayoutChanged);
+
+    // Nothing moved, nothing to do.
+    refresh = mesh.Refresh(positions.data());
+    CHECK_EQ(refresh.RebuiltChunks, 0u);
+    CHECK_EQ(refresh.RefreshedMeshlets, 0u);
+    CHECK(!refresh.LayoutChanged);
+
+    // A corner is used by the meshlet or two holding its triangles.
+    positions[0].z = 1.0f;
+    mesh.MoveVertices(0, 1);
+    refresh = mesh.Refresh(positions.data());
+    CHECK(refresh.RefreshedMeshlets >= 1 && refresh.RefreshedMeshlets <= 2);
+    CHECK(!refresh.LayoutChanged);
+
+    // Every vertex moving refreshes every meshlet, to what a full build computes.
+    WaveCloth(1.0f, positions.data());
+    mesh.MoveVertices(0, c_clothVertexCount);
+    refresh = mesh.Refresh(positions.data());
+    CHECK_EQ(refresh.RefreshedMeshlets, meshletCount);
+
+    DynamicMesh rebuilt;
+    rebuilt.SetTriangles(indices.data(), static_cast<uint32_t>(indices.size()), c_clothVertexCount);
+    rebuilt.Refresh(positions.data());
+    CHECK(IsSameCullData(mesh.GetCullData(), rebuilt.GetCullData()));
+
+    // Rewriting a triangle rebuilds only its chunk.
+    const uint32_t flipped[] = { indices[2], indices[1], indices[0] };
+    mesh.UpdateTriangles(0, flipped, 1);
+    refresh = mesh.Refresh(positions.data());
+    CHECK_EQ(refresh.RebuiltChunks, 1u);
+    CHECK(refresh.LayoutChanged);
+}
+
+TEST(DynamicMesh, StreamsFramesThroughTheRing)
+{
+    const std::vector<uint32_t> indices = MakeClothIndices();
+    std::vector<XMFLOAT3> positions(c_clothVertexCount);
+    WaveCloth(0.0f, positions.data());
+
+    DynamicMesh mesh;
+    mesh.SetTriangles(indices.data(), static_cast<uint32_t>(indices.size()), c_clothVertexCount);
+    mesh.Refresh(positions.data());
+
+    // A frame's bytes: the positions and the meshlets' CullData, each aligned.
+    const uint64_t bytesPerFrame = AlignUp(positions.size() * sizeof(XMFLOAT3)) + AlignUp(mesh.GetCullData().size() * sizeof(CullData));
+
+    RingAllocator ring((c_frameCount + 1) * bytesPerFrame);
+    std::vector<uint8_t> memory(size_t(ring.GetSize()), 0);
+
+    uint64_t fenceValues[c_frameCount] = {};
+    uint64_t completedFenceValue = 0;
+    uint64_t nextFenceValue = 1;
+    std::vector<FrameStream> streams;
+
+    bool allocated = true;
+    bool inFlightIntact = true;
+    for (uint32_t frame = 0; frame < 100; ++frame)
+    {
+        // The GPU is as far behind as MoveToNextFrame() allows: only this slot's last frame
+        // has completed.
+        const uint32_t slot = frame % c_frameCount;
+        completedFenceValue = std::max(completedFenceValue, fenceValues[slot]);
+        ring.Reclaim(completedFenceValue);
+        streams.erase(std::remove_if(streams.begin(), streams.end(), [&](const FrameStream& s) { return s.FenceValue <= completedFenceValue; }), streams.end());
+
+        // The frame's positions and the CullData refreshed from them, each sub-allocated from
+        // the ring. Writing them must leave every frame the GPU may still read untouched.
+        WaveCloth(0.1f * float(frame), positions.data());
+        mesh.MoveVertices(0, c_clothVertexCount);
+        mesh.Refresh(positions.data());
+
+        const size_t firstStream = streams.size();
+        allocated &= WriteStream(ring, memory, positions, nextFenceValue, streams);
+        allocated &= WriteStream(ring, memory, mesh.GetCullData(), nextFenceValue, streams);
+        if (!allocated)
+            break;
+
+        for (const FrameStream& s : streams)
+        {
+            inFlightIntact &= memcmp(memory.data() + s.Offset, s.Contents.data(), size_t(s.Size)) == 0;
+        }
+        inFlightIntact &= streams[firstStream + 1].Offset >= streams[firstStream].Offset + streams[firstStream].Size;
+
+        ring.FinishFrame(nextFenceValue);
+        fenceValues[slot] = nextFenceValue++;
+    }
+
+    CHECK(allocated);
+    CHECK(inFlightIntact);
+}
+
+TEST(DynamicMesh, ReusesRingMemoryOnlyOnceItsFrameCompletes)
+{
+    const std::vector<uint32_t> indices = MakeClothIndices();
+    std::vector<XMFLOAT3> positions(c_clothVertexCount);
+    WaveCloth(0.0f, positions.data());
+
+    const uint64_t frameSize = positions.size() * sizeof(XMFLOAT3);
+    RingAllocator ring(2 * AlignUp(frameSize));
+    std::vector<uint8_t> memory(size_t(ring.GetSize()), 0);
+    std::vector<FrameStream> streams;
+
+    // Two frames fill the ring.
+    CHECK(WriteStream(ring, memory, positions, 1, streams));
+    ring.FinishFrame(1);
+    WaveCloth(1.0f, positions.data());
+    CHECK(WriteStream(ring, memory, positions, 2, streams));
+    ring.FinishFrame(2);
+
+    // A third must wait for the first, whose memory it then reuses.
+    WaveCloth(2.0f, positions.data());
+    CHECK(!WriteStream(ring, memory, positions, 3, streams));
+    ring.Reclaim(0);
+    CHECK(!WriteStream(ring, memory, positions, 3, streams));
+    CHECK(memcmp(memory.data(), streams[0].Contents.data(), size_t(frameSize)) == 0);
+
+    ring.Reclaim(1);
+    REQUIRE(WriteStream(ring, memory, positions, 3, streams));
+    CHECK_EQ(streams.back().Offset, streams[0].Offset);
+    CHECK(memcmp(memory.data() + streams[1].Offset, streams[1].Contents.data(), size_t(frameSize)) == 0);
+}
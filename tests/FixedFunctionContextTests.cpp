@@ -0,0 +1,305 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "FixedFunctionContext.h"
+
+#include <map>
+#include <utility>
+
+// Draws are translated into a RecordingDrawTarget, and their dispatches replayed through the
+// CPU references of the mesh shader, to see which (location, instance) pairs each thread reads.
+namespace
+{
+    const uint32_t c_stride = 12;
+
+    VertexLayout PositionLayout()
+    {
+        VertexLayout layout = {};
+        layout.Elements.push_back(VertexElement{ 0, 0, DXGI_FORMAT_R32G32B32_FLOAT, 0 });
+        layout.Strides[0] = c_stride;
+        layout.PositionElement = 0;
+        return layout;
+    }
+
+    D3D12_VERTEX_BUFFER_VIEW VertexBuffer(D3D12_GPU_VIRTUAL_ADDRESS location, uint32_t vertexCount = 1000)
+    {
+        return D3D12_VERTEX_BUFFER_VIEW{ location, vertexCount * c_stride, c_stride };
+    }
+
+    // Reads of (location, instance) by the threads of every dispatch, counted.
+    typedef std::map<std::pair<uint32_t, uint32_t>, uint32_t> ReadCounts;
+
+    ReadCounts ReplayDispatches(const RecordingDrawTarget& target)
+    {
+        ReadCounts reads;
+        MeshDrawParams params = {};
+
+        for (const RecordingDrawTarget::Command& command : target.GetCommands())
+        {
+            if (command.Type == RecordingDrawTarget::Command::SetDrawParams)
+            {
+                params = command.Params;
+            }
+            else if (command.Type == RecordingDrawTarget::Command::DispatchMesh)
+            {
+                for (uint32_t z = 0; z < command.GroupCount[2]; ++z)
+                for (uint32_t y = 0; y < command.GroupCount[1]; ++y)
+                for (uint32_t x = 0; x < command.GroupCount[0]; ++x)
+                {
+                    uint32_t groupX, groupY;
+                    if (!GetDispatchGroup(params, x, y, z, groupX, groupY))
+                        continue;
+
+                    for (uint32_t thread = 0; thread < c_groupVertexCount; ++thread)
+                    {
+                        uint32_t location, instance;
+                        if (GetGroupThreadInput(params, groupX, groupY, thread, location, instance))
+                        {
+                            ++reads[std::make_pair(location, instance)];
+                        }
+                    }
+                }
+            }
+        }
+        return reads;
+    }
+
+    // Whether every location of [start, start + count) is read once for every instance.
+    bool ReadsEachOnce(const ReadCounts& reads, uint32_t start, uint32_t count, uint32_t instanceCount)
+    {
+        if (reads.size() != size_t(count) * instanceCount)
+            return false;
+
+        for (uint32_t instance = 0; instance < instanceCount; ++instance)
+        {
+            for (uint32_t location = start; location < start + count; ++location)
+            {
+                auto it = reads.find(std::make_pair(location, instance));
+                if (it == reads.end() || it->second != 1)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t CountCommands(const RecordingDrawTarget& target, RecordingDrawTarget::Command::EType type)
+    {
+        uint32_t count = 0;
+        for (const RecordingDrawTarget::Command& command : target.GetCommands())
+        {
+            count += command.Type == type ? 1 : 0;
+        }
+        return count;
+    }
+
+    struct Fixture
+    {
+        RecordingDrawTarget  Target;
+        FixedFunctionContext Context;
+
+        Fixture()
+            : Context(Target)
+        {
+            const D3D12_VERTEX_BUFFER_VIEW view = VertexBuffer(0x10000);
+            Context.SetVertexLayout(PositionLayout());
+            Context.IASetVertexBuffers(0, 1, &view);
+            Context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        }
+    };
+}
+
+TEST(FixedFunctionContext, DrawsEveryVertexOfEveryInstanceOnce)
+{
+    Fixture f;
+    f.Context.DrawInstanced(300, 5, 12, 7);
+
+    // Bindings go out once, ahead of the dispatch.
+    const std::vector<RecordingDrawTarget::Command>& commands = f.Target.GetCommands();
+    REQUIRE(commands.size() == 3);
+    CHECK_EQ(commands[0].Type, RecordingDrawTarget::Command::SetBuffers);
+    CHECK_EQ(commands[0].VertexBuffers[0].BufferLocation, 0x10000u);
+    CHECK_EQ(commands[1].Type, RecordingDrawTarget::Command::SetDrawParams);
+    CHECK_EQ(commands[2].Type, RecordingDrawTarget::Command::DispatchMesh);
+
+    // 300 vertices are 100 triangles, 5 groups of 21 per instance, one row per instance.
+    const MeshDrawParams& params = commands[1].Params;
+    CHECK_EQ(params.IndexSize, 0u);
+    CHECK_EQ(params.VertexCount, 300u);
+    CHECK_EQ(params.StartLocation, 12u);
+    CHECK_EQ(params.StartInstance, 7u);
+    CHECK_EQ(params.InstanceCount, 5u);
+    CHECK_EQ(params.InstancesPerGroup, 1u);
+    CHECK_EQ(params.GroupsPerRow, 5u);
+    CHECK_EQ(params.GroupCount, 25u);
+    CHECK_EQ(commands[2].GroupCount[0] * commands[2].GroupCount[1] * commands[2].GroupCount[2], 25u);
+
+    CHECK(ReadsEachOnce(ReplayDispatches(f.Target), 12, 300, 5));
+    CHECK_EQ(f.Context.GetSkippedDrawCount(), 0u);
+}
+
+TEST(FixedFunctionContext, DropsIncompletePrimitives)
+{
+    Fixture f;
+    f.Context.DrawInstanced(8, 1, 0, 0);
+    CHECK(ReadsEachOnce(ReplayDispatches(f.Target), 0, 6, 1));
+
+    // Too few vertices for a triangle, or no instances, draw nothing.
+    f.Target.Clear();
+    f.Context.DrawInstanced(2, 1, 0, 0);
+    f.Context.DrawInstanced(30, 0, 0, 0);
+    CHECK_EQ(CountCommands(f.Target, RecordingDrawTarget::Command::DispatchMesh), 0u);
+}
+
+TEST(FixedFunctionContext, PacksInstancesOfSmallMeshes)
+{
+    Fixture f;
+    f.Context.DrawInstanced(6, 100, 0, 0);
+
+    // 63 threads hold 10 instances of 6 vertices; 100 instances take 10 groups.
+    const std::vector<RecordingDrawTarget::Command>& commands = f.Target.GetCommands();
+    REQUIRE(commands.size() == 3);
+    const MeshDrawParams& params = commands[1].Params;
+    CHECK_EQ(params.InstancesPerGroup, 10u);
+    CHECK_EQ(params.GroupsPerRow, 10u);
+    CHECK_EQ(params.GroupCount, 10u);
+
+    CHECK(ReadsEachOnce(ReplayDispatches(f.Target), 0, 6, 100));
+}
+
+TEST(FixedFunctionContext, OffsetsIndexedDrawsByIndexBufferAlignment)
+{
+    Fixture f;
+
+    // 16-bit indices bound 2 bytes past a 4 byte boundary start one index later once the
+    // buffer is bound from the boundary.
+    const D3D12_INDEX_BUFFER_VIEW indices = { 0x20002, 600, DXGI_FORMAT_R16_UINT };
+    f.Context.IASetIndexBuffer(&indices);
+    f.Context.SetIndexBufferStripCutValue(D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF);
+    f.Context.DrawIndexedInstanced(60, 2, 9, -4, 3);
+
+    const std::vector<RecordingDrawTarget::Command>& commands = f.Target.GetCommands();
+    REQUIRE(commands.size() == 3);
+    CHECK_EQ(commands[0].IndexBuffer.BufferLocation, 0x20002u);
+
+    const MeshDrawParams& params = commands[1].Params;
+    CHECK_EQ(params.IndexSize, 2u);
+    CHECK_EQ(params.StartLocation, 10u);
+    CHECK_EQ(params.BaseVertex, -4);
+    CHECK_EQ(params.StartInstance, 3u);
+    CHECK_EQ(params.CutIndex, 0xffffu);
+
+    CHECK(ReadsEachOnce(ReplayDispatches(f.Target), 10, 60, 2));
+}
+
+TEST(FixedFunctionContext, SkipsDrawsItCannotPerform)
+{
+    Fixture f;
+
+    // No topology the mesh shader assembles.
+    f.Context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED);
+    f.Context.DrawInstanced(3, 1, 0, 0);
+    f.Context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // Index formats other than 16 and 32 bits, and index buffers misaligned for theirs.
+    D3D12_INDEX_BUFFER_VIEW indices = { 0x20000, 600, DXGI_FORMAT_R8_UINT };
+    f.Context.IASetIndexBuffer(&indices);
+    f.Context.DrawIndexedInstanced(3, 1, 0, 0, 0);
+    indices = { 0x20002, 600, DXGI_FORMAT_R32_UINT };
+    f.Context.IASetIndexBuffer(&indices);
+    f.Context.DrawIndexedInstanced(3, 1, 0, 0, 0);
+
+    // A view whose stride disagrees with the layout's.
+    D3D12_VERTEX_BUFFER_VIEW view = VertexBuffer(0x10000);
+    view.StrideInBytes = 16;
+    f.Context.IASetVertexBuffers(0, 1, &view);
+    f.Context.DrawInstanced(3, 1, 0, 0);
+
+    CHECK_EQ(f.Context.GetSkippedDrawCount(), 4u);
+    CHECK(f.Target.GetCommands().empty());
+
+    // Unbound slots read as zero rather than failing the draw.
+    f.Context.IASetVertexBuffers(0, 1, nullptr);
+    f.Context.DrawInstanced(3, 1, 0, 0);
+    CHECK_EQ(f.Context.GetSkippedDrawCount(), 4u);
+    CHECK_EQ(CountCommands(f.Target, RecordingDrawTarget::Command::DispatchMesh), 1u);
+}
+
+TEST(FixedFunctionContext, RebindsBuffersOnlyWhenTheyChange)
+{
+    Fixture f;
+    f.Context.DrawInstanced(300, 1, 0, 0);
+    f.Context.DrawInstanced(300, 1, 0, 0);
+
+    const D3D12_VERTEX_BUFFER_VIEW view = VertexBuffer(0x30000);
+    f.Context.IASetVertexBuffers(0, 1, &view);
+    f.Context.DrawInstanced(300, 1, 0, 0);
+
+    CHECK_EQ(CountCommands(f.Target, RecordingDrawTarget::Command::SetBuffers), 2u);
+    CHECK_EQ(CountCommands(f.Target, RecordingDrawTarget::Command::DispatchMesh), 3u);
+}
+
+TEST(FixedFunctionContext, PacksBatchedDrawsAcrossBuffers)
+{
+    Fixture f;
+    f.Context.BeginDrawBatch(PackMode::InOrder);
+
+    // Three small draws over two buffers, then one too large to pack.
+    const D3D12_VERTEX_BUFFER_VIEW a = VertexBuffer(0x10000), b = VertexBuffer(0x40000);
+    f.Context.IASetVertexBuffers(0, 1, &a);
+    f.Context.DrawInstanced(30, 1, 0, 0);
+    f.Context.IASetVertexBuffers(0, 1, &b);
+    f.Context.DrawInstanced(12, 2, 6, 1);
+    f.Context.IASetVertexBuffers(0, 1, &a);
+    f.Context.DrawInstanced(12, 1, 30, 0);
+    f.Context.DrawInstanced(300, 1, 0, 0);
+    f.Context.EndDrawBatch();
+
+    const std::vector<RecordingDrawTarget::Command>& commands = f.Target.GetCommands();
+    REQUIRE(commands.size() >= 3);
+    REQUIRE(commands[0].Type == RecordingDrawTarget::Command::SetPackedDraws);
+    CHECK_EQ(commands[1].Type, RecordingDrawTarget::Command::SetDrawParams);
+    CHECK_EQ(commands[2].Type, RecordingDrawTarget::Command::DispatchMesh);
+
+    // The packed draws share buffer sets by binding, and fill groups in order: 30 + 24
+    // vertices fit one group of 63, and the next 12 don't.
+    const RecordingDrawTarget::Command& packed = commands[0];
+    CHECK_EQ(packed.BufferSets.size(), 2u);
+    REQUIRE(packed.Draws.size() == 3);
+    CHECK_EQ(packed.Draws[0].BufferSet, 0u);
+    CHECK_EQ(packed.Draws[1].BufferSet, 1u);
+    CHECK_EQ(packed.Draws[2].BufferSet, 0u);
+    REQUIRE(packed.Groups.size() == 2);
+    CHECK_EQ(packed.Groups[0].DrawCount, 2u);
+    CHECK_EQ(packed.Groups[0].VertexCount, 54u);
+    CHECK_EQ(packed.Groups[1].DrawCount, 1u);
+    CHECK(commands[1].Params.PackedGroups != 0);
+
+    // Every thread of the packed groups finds its draw, location and instance.
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> reads[3];
+    for (uint32_t group = 0; group < packed.Groups.size(); ++group)
+    {
+        for (uint32_t thread = 0; thread < c_groupVertexCount; ++thread)
+        {
+            uint32_t draw, location, instance;
+            if (GetPackedThreadInput(packed.Groups.data(), packed.Draws.data(), group, thread, draw, location, instance))
+            {
+                ++reads[draw][std::make_pair(location, instance)];
+            }
+        }
+    }
+    CHECK(ReadsEachOnce(reads[0], 0, 30, 1));
+    CHECK(ReadsEachOnce(reads[1], 6, 12, 2));
+    CHECK(ReadsEachOnce(reads[2], 30, 12, 1));
+
+    // The large draw follows as its own dispatch.
+    CHECK_EQ(CountCommands(f.Target, RecordingDrawTarget::Command::DispatchMesh), 2u);
+}
@@ -0,0 +1,111 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "FrameTimeLog.h"
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    bool IsNear(double a, double b)
+    {
+        return std::fabs(a - b) < 1e-9;
+    }
+
+    std::vector<std::string> ReadLines(const std::string& filename)
+    {
+        std::vector<std::string> lines;
+        std::ifstream stream(filename, std::ios::binary);
+
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+
+    std::wstring GetWidePath(const std::string& path)
+    {
+        return std::wstring(path.begin(), path.end());
+    }
+}
+
+TEST(FrameTimeLog, InterpolatesPercentilesBetweenRanks)
+{
+    const double sorted[] = { 1.0, 2.0, 3.0, 4.0, 5.0 };
+
+    CHECK_EQ(ComputePercentile(sorted, 5, 0.0), 1.0);
+    CHECK_EQ(ComputePercentile(sorted, 5, 25.0), 2.0);
+    CHECK_EQ(ComputePercentile(sorted, 5, 50.0), 3.0);
+    CHECK(IsNear(ComputePercentile(sorted, 5, 95.0), 4.8));
+    CHECK_EQ(ComputePercentile(sorted, 5, 100.0), 5.0);
+
+    // Out of range percentiles clamp; no samples give 0 and one gives itself.
+    CHECK_EQ(ComputePercentile(sorted, 5, -10.0), 1.0);
+    CHECK_EQ(ComputePercentile(sorted, 5, 150.0), 5.0);
+    CHECK_EQ(ComputePercentile(sorted, 0, 50.0), 0.0);
+    CHECK_EQ(ComputePercentile(sorted + 3, 1, 99.0), 4.0);
+
+    std::vector<double> samples = { 5.0, 1.0, 4.0, 2.0, 3.0 };
+    const FrameTimeStats stats = ComputeFrameTimeStats(samples);
+    CHECK_EQ(stats.Min, 1.0);
+    CHECK(IsNear(stats.Mean, 3.0));
+    CHECK_EQ(stats.P50, 3.0);
+    CHECK(IsNear(stats.P95, 4.8));
+    CHECK(IsNear(stats.P99, 4.96));
+    CHECK_EQ(stats.Max, 5.0);
+    CHECK(samples == std::vector<double>(sorted, sorted + 5));
+
+    std::vector<double> none;
+    CHECK_EQ(ComputeFrameTimeStats(none).Max, 0.0);
+}
+
+TEST(FrameTimeLog, WritesFramesThenTheirSummary)
+{
+    FrameTimeLog log;
+    log.Record(1.0 / 60.0, 1.5, 0.25);
+    log.Record(2.0 / 60.0, 2.5, 0.75);
+    log.Record(3.0 / 60.0, 3.5, 0.5);
+    CHECK_EQ(log.GetFrameCount(), size_t(3));
+
+    const std::string filename = GetTestOutputPath("FrameTimeLog.csv");
+    REQUIRE(SUCCEEDED(log.WriteCsv(GetWidePath(filename).c_str())));
+
+    const char* const expected[] =
+    {
+        "frame,time_s,cpu_ms,gpu_ms",
+        "0,0.016667,1.5000,0.2500",
+        "1,0.033333,2.5000,0.7500",
+        "2,0.050000,3.5000,0.5000",
+        "min,,1.5000,0.2500",
+        "mean,,2.5000,0.5000",
+        "p50,,2.5000,0.5000",
+        "p95,,3.4000,0.7250",
+        "p99,,3.4800,0.7450",
+        "max,,3.5000,0.7500",
+    };
+    CHECK(ReadLines(filename) == std::vector<std::string>(expected, expected + _countof(expected)));
+
+    // With no frames there is only the header, and summary rows of zeros.
+    log.Clear();
+    REQUIRE(SUCCEEDED(log.WriteCsv(GetWidePath(filename).c_str())));
+    const std::vector<std::string> lines = ReadLines(filename);
+    REQUIRE(lines.size() == 7);
+    CHECK_EQ(lines[1], std::string("min,,0.0000,0.0000"));
+
+    CHECK_EQ(log.WriteCsv(GetWidePath(GetTestOutputPath("Missing/FrameTimeLog.csv")).c_str()), E_INVALIDARG);
+}
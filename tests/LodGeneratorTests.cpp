@@ -0,0 +1,187 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "LodGenerator.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    // The coarsest dragon, which simplifies quickly.
+    const wchar_t* const c_sourceFilename = L"Assets/Dragon_LOD5.bin";
+
+    bool LoadBase(Model& model, std::vector<MeshData>& base)
+    {
+        if (FAILED(model.LoadFromFile(c_sourceFilename)))
+            return false;
+
+        base.resize(model.GetMeshCount());
+        for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+        {
+            ExtractMeshData(model.GetMesh(m), base[m]);
+        }
+
+        return true;
+    }
+
+    std::wstring GetWideTestOutputPath(const std::string& name)
+    {
+        const std::string path = GetTestOutputPath(name);
+        return std::wstring(path.begin(), path.end());
+    }
+
+    // Whether a loaded mesh holds the same vertices, indices and meshlets as the one written.
+    bool Matches(const Mesh& mesh, const MeshData& data)
+    {
+        if (mesh.VertexCount != data.VertexCount || mesh.IndexCount != data.Indices.size() ||
+            mesh.IndexSubsets.size() != data.IndexSubsets.size() || mesh.Meshlets.size() != data.Meshlets.size() ||
+            mesh.PrimitiveIndices.size() != data.PrimitiveIndices.size())
+            return false;
+
+        for (uint32_t v = 0; v < mesh.VertexCount; ++v)
+        {
+            if (memcmp(&mesh.GetPosition(v), &data.GetPosition(v), sizeof(DirectX::XMFLOAT3)) != 0)
+                return false;
+        }
+
+        for (uint32_t i = 0; i < mesh.IndexCount; ++i)
+        {
+            if (mesh.GetIndex(i) != data.Indices[i])
+                return false;
+        }
+
+        for (uint32_t i = 0; i < data.UniqueVertexIndices.size(); ++i)
+        {
+            if (mesh.GetVertexIndex(i) != data.UniqueVertexIndices[i])
+                return false;
+        }
+
+        return memcmp(mesh.Meshlets.data(), data.Meshlets.data(), data.Meshlets.size() * sizeof(Meshlet)) == 0 &&
+            memcmp(mesh.PrimitiveIndices.data(), data.PrimitiveIndices.data(), data.PrimitiveIndices.size() * sizeof(PackedTriangle)) == 0;
+    }
+
+    std::string ReadBytes(const std::wstring& filename)
+    {
+        std::ifstream stream(GetStreamPath(filename.c_str()), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+
+    uint32_t GetIndexCount(const std::vector<MeshData>& meshes)
+    {
+        uint32_t count = 0;
+        for (const MeshData& mesh : meshes)
+        {
+            count += static_cast<uint32_t>(mesh.Indices.size());
+        }
+
+        return count;
+    }
+}
+
+TEST(LodGenerator, GeneratesCoarserLodsWithErrorsThatNeverDecrease)
+{
+    Model model;
+    std::vector<MeshData> base;
+    REQUIRE(LoadBase(model, base));
+
+    std::vector<std::vector<MeshData>> lods;
+    std::vector<float> errors;
+    GenerateLodChain(base, 4, LodOptions(), lods, errors);
+    REQUIRE(lods.size() == 4);
+    REQUIRE(errors.size() == 4);
+
+    CHECK_EQ(errors[0], 0.0f);
+    CHECK_EQ(GetIndexCount(lods[0]), GetIndexCount(base));
+
+    bool coarser = true;
+    bool nonDecreasing = true;
+    for (uint32_t lod = 1; lod < lods.size(); ++lod)
+    {
+        coarser &= GetIndexCount(lods[lod]) < GetIndexCount(lods[lod - 1]);
+        nonDecreasing &= errors[lod] >= errors[lod - 1];
+    }
+    CHECK(coarser);
+    CHECK(nonDecreasing);
+    CHECK(errors.back() > 0.0f);
+
+    // Every LOD is rebuilt into meshlets covering its triangles, over its compacted vertices.
+    bool rebuilt = true;
+    for (uint32_t lod = 1; lod < lods.size(); ++lod)
+    {
+        for (const MeshData& mesh : lods[lod])
+        {
+            uint32_t primitiveCount = 0;
+            for (const Meshlet& meshlet : mesh.Meshlets)
+            {
+                primitiveCount += meshlet.PrimCount;
+            }
+            rebuilt &= primitiveCount * 3 == mesh.Indices.size() && mesh.Vertices.size() == size_t(mesh.VertexCount) * mesh.VertexStride;
+        }
+    }
+    CHECK(rebuilt);
+}
+
+TEST(LodGenerator, WritesFilesTheModelLoads)
+{
+    Model model;
+    std::vector<MeshData> base;
+    REQUIRE(LoadBase(model, base));
+
+    const std::wstring filenames[] =
+    {
+        GetWideTestOutputPath("LodGenerator.LOD1.bin"),
+        GetWideTestOutputPath("LodGenerator.LOD2.bin"),
+    };
+    const wchar_t* const filenamePointers[] = { filenames[0].c_str(), filenames[1].c_str() };
+
+    std::vector<float> errors;
+    REQUIRE(SUCCEEDED(GenerateLodFiles(c_sourceFilename, filenamePointers, 3, LodOptions(), &errors)));
+
+    // Generating is deterministic, so the files hold the chain generated here.
+    std::vector<std::vector<MeshData>> lods;
+    std::vector<float> expectedErrors;
+    GenerateLodChain(base, 3, LodOptions(), lods, expectedErrors);
+    CHECK(errors == expectedErrors);
+
+    for (uint32_t lod = 1; lod < 3; ++lod)
+    {
+        Model loaded;
+        REQUIRE(SUCCEEDED(loaded.LoadFromFile(filenamePointers[lod - 1])));
+        REQUIRE(loaded.GetMeshCount() == lods[lod].size());
+
+        bool matches = true;
+        for (uint32_t m = 0; m < loaded.GetMeshCount(); ++m)
+        {
+            matches &= Matches(loaded.GetMesh(m), lods[lod][m]);
+        }
+        CHECK(matches);
+
+        // Reading the loaded file back into mesh data and writing it again is lossless.
+        std::vector<MeshData> extracted(loaded.GetMeshCount());
+        for (uint32_t m = 0; m < loaded.GetMeshCount(); ++m)
+        {
+            ExtractMeshData(loaded.GetMesh(m), extracted[m]);
+        }
+
+        const std::wstring rewritten = GetWideTestOutputPath("LodGenerator.Rewritten.bin");
+        REQUIRE(SUCCEEDED(WriteMeshFile(rewritten.c_str(), extracted)));
+
+        const std::string original = ReadBytes(filenames[lod - 1]);
+        CHECK(!original.empty());
+        CHECK(original == ReadBytes(rewritten));
+    }
+
+    // A missing source fails without writing.
+    CHECK(FAILED(GenerateLodFiles(L"Assets/Missing.bin", filenamePointers, 3, LodOptions(), nullptr)));
+}
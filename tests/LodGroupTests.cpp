@@ -0,0 +1,150 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "LodGroup.h"
+
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    const wchar_t* const c_lodFilenames[] =
+    {
+        L"Assets/Dragon_LOD1.bin",
+        L"Assets/Dragon_LOD2.bin",
+        L"Assets/Dragon_LOD3.bin",
+        L"Assets/Dragon_LOD4.bin",
+        L"Assets/Dragon_LOD5.bin",
+    };
+
+    // With tan(fovY / 2) = 1/2 and a 1000 pixel viewport, a unit of error at distance d from
+    // the bounding sphere projects to 1000 / d pixels.
+    const float c_fovY = 2.0f * std::atan(0.5f);
+    const float c_viewportHeight = 1000.0f;
+
+    // Places the model straight ahead, far enough back that a unit of error projects to
+    // 'pixelsPerUnit' pixels.
+    XMFLOAT4X4 GetWorldView(const LodGroup& group, float pixelsPerUnit)
+    {
+        const BoundingSphere& bounds = group.GetLod(0).GetBoundingSphere();
+        const float distance = bounds.Radius + c_viewportHeight / pixelsPerUnit;
+
+        XMFLOAT4X4 worldView;
+        XMStoreFloat4x4(&worldView, XMMatrixTranslation(-bounds.Center.x, -bounds.Center.y, -bounds.Center.z + distance));
+        return worldView;
+    }
+
+    uint32_t SelectAt(LodGroup& group, float pixelsPerUnit)
+    {
+        return group.SelectLod(GetWorldView(group, pixelsPerUnit), c_fovY, c_viewportHeight);
+    }
+
+    // Five LODs with errors that double from LOD 1 on, so that which LODs pass is easy to read
+    // off. Selection only reads the finest LOD's bounds, so every LOD is the coarsest dragon,
+    // which is quick to estimate errors for.
+    bool LoadWithErrors(LodGroup& group)
+    {
+        const wchar_t* const filenames[] = { c_lodFilenames[4], c_lodFilenames[4], c_lodFilenames[4], c_lodFilenames[4], c_lodFilenames[4] };
+        if (FAILED(group.LoadFromFiles(filenames, _countof(filenames))))
+            return false;
+
+        for (uint32_t lod = 1; lod < group.GetLodCount(); ++lod)
+        {
+            group.SetLodError(lod, 0.001f * float(1u << (lod - 1)));
+        }
+
+        return true;
+    }
+}
+
+TEST(LodGroup, EstimatesErrorsThatNeverDecrease)
+{
+    LodGroup group;
+    REQUIRE(SUCCEEDED(group.LoadFromFiles(c_lodFilenames, _countof(c_lodFilenames))));
+    REQUIRE(group.GetLodCount() == 5);
+
+    CHECK_EQ(group.GetLodError(0), 0.0f);
+    for (uint32_t lod = 1; lod < group.GetLodCount(); ++lod)
+    {
+        CHECK(group.GetLodError(lod) >= group.GetLodError(lod - 1));
+    }
+
+    // The coarsest LOD is a visibly different surface, but still within the model's bounds.
+    const float radius = group.GetLod(0).GetBoundingSphere().Radius;
+    CHECK(group.GetLodError(4) > 0.0f);
+    CHECK(group.GetLodError(4) < radius);
+
+    CHECK_EQ(group.GetCurrentLod(), 0u);
+}
+
+TEST(LodGroup, ProjectsErrorsByDistance)
+{
+    LodGroup group;
+    REQUIRE(LoadWithErrors(group));
+
+    const float projected = group.GetProjectedError(1, GetWorldView(group, 200.0f), c_fovY, c_viewportHeight);
+    CHECK(std::fabs(projected - 0.2f) < 1e-3f);
+
+    const float farther = group.GetProjectedError(1, GetWorldView(group, 100.0f), c_fovY, c_viewportHeight);
+    CHECK(std::fabs(farther - 0.1f) < 1e-3f);
+}
+
+TEST(LodGroup, SelectsTheCoarsestLodUnderTheThreshold)
+{
+    // Without hysteresis, so that coarsening isn't held back either.
+    LodGroup group;
+    REQUIRE(LoadWithErrors(group));
+    group.SetPixelThreshold(1.0f);
+    group.SetHysteresis(0.0f);
+
+    // Errors project to 0.05 through 0.4 pixels: every LOD passes.
+    CHECK_EQ(SelectAt(group, 50.0f), 4u);
+
+    // 0.4, 0.8, 1.6 and 3.2 pixels: LOD 2 is the coarsest at most a pixel off.
+    CHECK_EQ(SelectAt(group, 400.0f), 2u);
+
+    // Nothing but the finest passes.
+    CHECK_EQ(SelectAt(group, 5000.0f), 0u);
+
+    group.SetPixelThreshold(4.0f);
+    CHECK_EQ(SelectAt(group, 400.0f), 4u);
+}
+
+TEST(LodGroup, RefinesAtOnceAndCoarsensWithHysteresis)
+{
+    LodGroup group;
+    REQUIRE(LoadWithErrors(group));
+    group.SetPixelThreshold(1.0f);
+    REQUIRE(SelectAt(group, 50.0f) == 4u);
+
+    // LOD 4 projects to 1.6 pixels: drop to LOD 3 (0.8) in the same frame.
+    CHECK_EQ(SelectAt(group, 200.0f), 3u);
+
+    // Several LODs at once: only LOD 1 (0.9 pixels) passes.
+    CHECK_EQ(SelectAt(group, 900.0f), 1u);
+
+    // Back at 200, LOD 3 is under the threshold but not by the 0.25 hysteresis, so only LOD 2
+    // (0.4) is taken until LOD 3 is under 0.75 pixels.
+    CHECK_EQ(SelectAt(group, 200.0f), 2u);
+    CHECK_EQ(SelectAt(group, 180.0f), 3u);
+
+    // Likewise for LOD 4 at 0.88 and 0.76 pixels, then 0.72.
+    CHECK_EQ(SelectAt(group, 110.0f), 3u);
+    CHECK_EQ(SelectAt(group, 95.0f), 3u);
+    CHECK_EQ(SelectAt(group, 90.0f), 4u);
+
+    // Without hysteresis the same views coarsen straight away.
+    group.SetHysteresis(0.0f);
+    CHECK_EQ(SelectAt(group, 200.0f), 3u);
+    CHECK_EQ(SelectAt(group, 110.0f), 4u);
+}
@@ -0,0 +1,209 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "MeshShaderPermutation.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <future>
+#include <string>
+
+namespace
+{
+    // Position and normal interleaved in slot 0, and a per-instance color in slot 1.
+    const D3D12_INPUT_ELEMENT_DESC c_elements[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "NORMAL",   0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 3 },
+    };
+
+    VertexLayout Resolve(const D3D12_INPUT_ELEMENT_DESC* elements, uint32_t elementCount, uint32_t stride0 = 20, uint32_t stride1 = 4)
+    {
+        const uint32_t strides[] = { stride0, stride1, 64 };
+        const D3D12_INPUT_LAYOUT_DESC desc = { elements, elementCount };
+
+        VertexLayout layout = {};
+        CHECK(SUCCEEDED(ResolveInputLayout(desc, strides, 3, layout)));
+        return layout;
+    }
+
+    VertexLayout DefaultLayout()
+    {
+        return Resolve(c_elements, _countof(c_elements));
+    }
+
+    bool Contains(const std::string& source, const char* text)
+    {
+        return source.find(text) != std::string::npos;
+    }
+
+    // Stands in for the job system: completes each compile at once, with the source as its
+    // bytecode, or fails it while 'fail' is set.
+    struct StubCompiler
+    {
+        uint32_t Calls = 0;
+        bool     Fail = false;
+
+        ShaderTask operator()(const std::string& source)
+        {
+            ++Calls;
+
+            ShaderCompileResult result;
+            result.Status = Fail ? E_FAIL : S_OK;
+            if (!Fail)
+            {
+                result.Bytecode.assign(source.begin(), source.end());
+            }
+
+            std::promise<ShaderCompileResult> promise;
+            promise.set_value(result);
+
+            ShaderTask task;
+            task.Result = promise.get_future().share();
+            return task;
+        }
+    };
+}
+
+TEST(MeshShaderPermutation, KeysIgnoreWhatDoesNotAffectFetching)
+{
+    const MeshShaderKey key(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // Semantic names, and the strides of slots nothing reads, don't change the fetch.
+    D3D12_INPUT_ELEMENT_DESC renamed[_countof(c_elements)];
+    std::copy(c_elements, c_elements + _countof(c_elements), renamed);
+    renamed[1].SemanticName = "TANGENT";
+
+    const MeshShaderKey same(Resolve(renamed, _countof(renamed)), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    CHECK(same.Words == key.Words);
+    CHECK_EQ(same.Hash, key.Hash);
+
+    // Everything else does.
+    D3D12_INPUT_ELEMENT_DESC changed[_countof(c_elements)];
+    const auto differs = [&](const VertexLayout& layout, D3D_PRIMITIVE_TOPOLOGY topology)
+    {
+        const MeshShaderKey other(layout, topology);
+        return other.Words != key.Words && other.Hash != key.Hash;
+    };
+
+    CHECK(differs(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP));
+    CHECK(differs(Resolve(c_elements, _countof(c_elements), 24), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+    CHECK(differs(Resolve(c_elements, 2), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+
+    std::copy(c_elements, c_elements + _countof(c_elements), changed);
+    changed[1].Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+    CHECK(differs(Resolve(changed, _countof(changed)), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+
+    std::copy(c_elements, c_elements + _countof(c_elements), changed);
+    changed[2].InstanceDataStepRate = 1;
+    CHECK(differs(Resolve(changed, _countof(changed)), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+
+    // Swapping the elements moves the position.
+    std::copy(c_elements, c_elements + _countof(c_elements), changed);
+    std::swap(changed[0], changed[1]);
+    CHECK(differs(Resolve(changed, _countof(changed)), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+}
+
+TEST(MeshShaderPermutation, GeneratesLiteralFetches)
+{
+    std::string source;
+    REQUIRE(SUCCEEDED(GenerateMeshShaderSource(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, source)));
+
+    // Triangle list assembly, then the shared shader.
+    CHECK(Contains(source, "#define PRIMITIVE_TOPOLOGY     4\n"));
+    CHECK(Contains(source, "#define PRIM_VERTS             3\n"));
+    CHECK(Contains(source, "#define GROUP_PRIMS            21\n"));
+    CHECK(Contains(source, "#define SPECIALIZED_VERTEX_FETCH\n#include \"MeshletMS.hlsl\"\n"));
+
+    // Dword-aligned elements load whole dwords at literal addresses; the per-instance color
+    // steps every third instance.
+    CHECK(Contains(source, "uint4 raw0 = uint4(DRAW_BUFFER(0).Load3(vertex * 20), 0);"));
+    CHECK(Contains(source, "uint4 raw1 = uint4(DRAW_BUFFER(0).Load2(vertex * 20 + 12), 0, 0);"));
+    CHECK(Contains(source, "uint4 raw2 = uint4(DRAW_BUFFER(1).Load((s_startInstance + instance / 3) * 4), 0, 0, 0);"));
+    CHECK(Contains(source, "return asfloat(element0);"));
+
+    // The layout hash is in the header, for matching a compiled permutation to its layout.
+    char hash[32];
+    snprintf(hash, sizeof(hash), "0x%016llx", static_cast<unsigned long long>(MeshShaderKey(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST).Hash));
+    CHECK(Contains(source, hash));
+}
+
+TEST(MeshShaderPermutation, LoadsUnalignedElementsBitwise)
+{
+    // Two 2-byte elements in a 6-byte stride, which isn't whole dwords.
+    const D3D12_INPUT_ELEMENT_DESC elements[] =
+    {
+        { "TEXCOORD", 0, DXGI_FORMAT_R16_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 1, DXGI_FORMAT_R8G8_UNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UINT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 0 },
+    };
+
+    std::string source;
+    REQUIRE(SUCCEEDED(GenerateMeshShaderSource(Resolve(elements, _countof(elements), 6, 0), D3D_PRIMITIVE_TOPOLOGY_POINTLIST, source)));
+    CHECK(Contains(source, "uint4 raw0 = LoadElementBits(0, vertex * 6, 2);"));
+    CHECK(Contains(source, "uint4 raw1 = LoadElementBits(0, vertex * 6 + 2, 2);"));
+
+    // A zero stride reads the first element; a step rate of 0 is the start's, too.
+    CHECK(Contains(source, "uint4 raw2 = uint4(DRAW_BUFFER(1).Load(0), 0, 0, 0);"));
+
+    // No position: vertices sit at the origin.
+    CHECK(Contains(source, "return float4(0, 0, 0, 1);"));
+}
+
+TEST(MeshShaderPermutation, RejectsTopologiesWithoutAssembly)
+{
+    std::string source;
+    CHECK_EQ(GenerateMeshShaderSource(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_UNDEFINED, source), E_NOTIMPL);
+}
+
+TEST(MeshShaderPermutation, CompilesEachPermutationOnce)
+{
+    StubCompiler compiler;
+    MeshShaderCache cache([&](const std::string& source) { return compiler(source); });
+
+    ShaderTask task;
+    REQUIRE(SUCCEEDED(cache.Compile(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, task)));
+    REQUIRE(SUCCEEDED(cache.Compile(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, task)));
+    REQUIRE(SUCCEEDED(cache.Compile(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_LINELIST, task)));
+    CHECK_EQ(cache.GetPermutationCount(), 2u);
+    CHECK_EQ(cache.GetCompileCount(), 2u);
+    CHECK_EQ(compiler.Calls, 2u);
+
+    // The bytecode is the generated source of the permutation asked for.
+    const std::vector<uint8_t>* bytecode = nullptr;
+    REQUIRE(SUCCEEDED(cache.GetBytecode(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_LINELIST, &bytecode)));
+    std::string source;
+    GenerateMeshShaderSource(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_LINELIST, source);
+    CHECK(std::string(bytecode->begin(), bytecode->end()) == source);
+    CHECK_EQ(compiler.Calls, 2u);
+
+    CHECK_EQ(cache.Compile(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_UNDEFINED, task), E_NOTIMPL);
+    CHECK_EQ(cache.GetPermutationCount(), 2u);
+}
+
+TEST(MeshShaderPermutation, RetriesFailedCompiles)
+{
+    StubCompiler compiler;
+    compiler.Fail = true;
+    MeshShaderCache cache([&](const std::string& source) { return compiler(source); });
+
+    const std::vector<uint8_t>* bytecode = nullptr;
+    CHECK_EQ(cache.GetBytecode(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, &bytecode), E_FAIL);
+    CHECK(bytecode == nullptr);
+
+    compiler.Fail = false;
+    CHECK(SUCCEEDED(cache.GetBytecode(DefaultLayout(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, &bytecode)));
+    CHECK(bytecode != nullptr);
+    CHECK_EQ(compiler.Calls, 2u);
+    CHECK_EQ(cache.GetPermutationCount(), 1u);
+}
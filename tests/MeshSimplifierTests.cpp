@@ -0,0 +1,247 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Test.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <utility>
+
+using namespace DirectX;
+
+namespace
+{
+    const uint32_t c_gridSize = 9; // Vertices along each side
+    const float c_gridExtent = float(c_gridSize - 1);
+
+    // A flat square of c_gridSize x c_gridSize vertices at unit spacing. Vertices of columns
+    // at or past 'seamColumn' are duplicated (at the end of the vertex array) for the
+    // triangles right of it, with a texture coordinate that jumps across the seam; the
+    // originals past the seam column go unused.
+    struct Grid
+    {
+        std::vector<XMFLOAT3> Positions;
+        std::vector<float>    TexCoords;
+        std::vector<uint32_t> Indices;
+        std::vector<uint32_t> Corners; // Of the outline, and where the seam meets it
+
+        explicit Grid(uint32_t seamColumn = c_gridSize)
+        {
+            for (uint32_t y = 0; y < c_gridSize; ++y)
+            {
+                for (uint32_t x = 0; x < c_gridSize; ++x)
+                {
+                    Positions.push_back(XMFLOAT3(float(x), float(y), 0.0f));
+                    TexCoords.push_back(float(x) / c_gridExtent);
+                }
+            }
+
+            std::vector<uint32_t> right(Positions.size());
+            for (uint32_t v = 0; v < right.size(); ++v)
+            {
+                right[v] = v;
+                if (v % c_gridSize >= seamColumn)
+                {
+                    right[v] = static_cast<uint32_t>(Positions.size());
+                    Positions.push_back(Positions[v]);
+                    TexCoords.push_back(TexCoords[v] + 1.0f);
+                }
+            }
+
+            for (uint32_t y = 0; y + 1 < c_gridSize; ++y)
+            {
+                for (uint32_t x = 0; x + 1 < c_gridSize; ++x)
+                {
+                    const uint32_t v = y * c_gridSize + x;
+                    const uint32_t quad[] = { v, v + 1, v + c_gridSize, v + c_gridSize + 1 };
+                    const bool isRight = x >= seamColumn;
+
+                    const uint32_t a = isRight ? right[quad[0]] : quad[0];
+                    const uint32_t b = isRight ? right[quad[1]] : quad[1];
+                    const uint32_t c = isRight ? right[quad[2]] : quad[2];
+                    const uint32_t d = isRight ? right[quad[3]] : quad[3];
+                    Indices.insert(Indices.end(), { a, b, d, a, d, c });
+                }
+            }
+
+            const uint32_t last = c_gridSize - 1;
+            Corners = { 0, right[last], last * c_gridSize, right[last * c_gridSize + last] };
+            if (seamColumn < c_gridSize)
+            {
+                Corners.insert(Corners.end(), { seamColumn, right[seamColumn], last * c_gridSize + seamColumn, right[last * c_gridSize + seamColumn] });
+            }
+        }
+
+        SimplifyDesc GetDesc(uint32_t targetIndexCount, float targetError) const
+        {
+            static const float c_weights[] = { 1.0f };
+
+            SimplifyDesc desc = {};
+            desc.Positions = Positions.data();
+            desc.VertexCount = static_cast<uint32_t>(Positions.size());
+            desc.Indices = Indices.data();
+            desc.IndexCount = static_cast<uint32_t>(Indices.size());
+            desc.Attributes = TexCoords.data();
+            desc.AttributeWeights = c_weights;
+            desc.AttributeStride = 1;
+            desc.TargetIndexCount = targetIndexCount;
+            desc.TargetError = targetError;
+            return desc;
+        }
+    };
+
+    bool IsOnOutline(const XMFLOAT3& p)
+    {
+        return p.x == 0.0f || p.y == 0.0f || p.x == c_gridExtent || p.y == c_gridExtent;
+    }
+
+    bool Contains(const std::vector<uint32_t>& indices, uint32_t vertex)
+    {
+        return std::find(indices.begin(), indices.end(), vertex) != indices.end();
+    }
+
+    float GetArea(const std::vector<XMFLOAT3>& positions, const std::vector<uint32_t>& indices)
+    {
+        float area = 0.0f;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const XMFLOAT3& a = positions[indices[i]];
+            const XMFLOAT3& b = positions[indices[i + 1]];
+            const XMFLOAT3& c = positions[indices[i + 2]];
+            area += 0.5f * std::fabs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+        }
+
+        return area;
+    }
+
+    // Whether the edges used by one triangle only, with vertices welded by position, all lie
+    // along the square's outline: the mesh has no holes and no seam has opened.
+    bool HasOnlyOutlineEdgesOpen(const std::vector<XMFLOAT3>& positions, const std::vector<uint32_t>& indices)
+    {
+        auto weld = [&](uint32_t v) { return std::make_pair(positions[v].x, positions[v].y); };
+
+        std::map<std::pair<std::pair<float, float>, std::pair<float, float>>, uint32_t> edgeUses;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                auto a = weld(indices[i + k]);
+                auto b = weld(indices[i + (k + 1) % 3]);
+                ++edgeUses[a < b ? std::make_pair(a, b) : std::make_pair(b, a)];
+            }
+        }
+
+        for (const auto& edge : edgeUses)
+        {
+            if (edge.second != 1)
+                continue;
+
+            const auto& a = edge.first.first;
+            const auto& b = edge.first.second;
+            const bool alongX = a.second == b.second && (a.second == 0.0f || a.second == c_gridExtent);
+            const bool alongY = a.first == b.first && (a.first == 0.0f || a.first == c_gridExtent);
+            if (!alongX && !alongY)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+TEST(MeshSimplifier, KeepsTheOutlineOfAnOpenBorder)
+{
+    const Grid grid;
+
+    // Down to two triangles if nothing held the outline, which moving a corner changes by a
+    // unit, far over the target error; straight runs of the border collapse at no cost.
+    std::vector<uint32_t> result;
+    const float error = SimplifyMesh(grid.GetDesc(6, 0.01f), result);
+
+    CHECK(result.size() <= grid.Indices.size() / 4);
+    CHECK(error < 1e-3f);
+
+    // Border vertices only slide along the border, so the square keeps its corners and area.
+    bool cornersKept = true;
+    for (uint32_t corner : grid.Corners)
+    {
+        cornersKept &= Contains(result, corner);
+    }
+    CHECK(cornersKept);
+    CHECK(std::fabs(GetArea(grid.Positions, result) - c_gridExtent * c_gridExtent) < 1e-3f);
+    CHECK(HasOnlyOutlineEdgesOpen(grid.Positions, result));
+}
+
+TEST(MeshSimplifier, NeverMovesLockedVertices)
+{
+    const Grid grid;
+
+    // A diagonal of interior vertices, which a flat grid would otherwise collapse first.
+    std::vector<uint8_t> locked(grid.Positions.size(), 0);
+    for (uint32_t i = 1; i + 1 < c_gridSize; ++i)
+    {
+        locked[i * c_gridSize + i] = 1;
+    }
+
+    SimplifyDesc desc = grid.GetDesc(6, FLT_MAX);
+    desc.LockedVertices = locked.data();
+
+    std::vector<uint32_t> result;
+    SimplifyMesh(desc, result);
+
+    bool lockedKept = true;
+    for (uint32_t v = 0; v < locked.size(); ++v)
+    {
+        lockedKept &= !locked[v] || Contains(result, v);
+    }
+    CHECK(lockedKept);
+    CHECK(result.size() < grid.Indices.size());
+}
+
+TEST(MeshSimplifier, KeepsSeamsClosed)
+{
+    const uint32_t seamColumn = c_gridSize / 2;
+    const Grid grid(seamColumn);
+
+    std::vector<uint32_t> result;
+    SimplifyMesh(grid.GetDesc(6, 0.01f), result);
+    CHECK(result.size() <= grid.Indices.size() / 4);
+
+    // Where the seam meets the border both sides keep their vertex.
+    bool cornersKept = true;
+    for (uint32_t corner : grid.Corners)
+    {
+        cornersKept &= Contains(result, corner);
+    }
+    CHECK(cornersKept);
+
+    // Each side stays on its side of the seam, with its own texture coordinates, and the two
+    // sides still meet along it.
+    bool sidesKept = true;
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        const uint32_t v = result[i];
+        const bool isRight = v >= c_gridSize * c_gridSize;
+        const float x = grid.Positions[v].x;
+        sidesKept &= isRight ? x >= float(seamColumn) : x <= float(seamColumn);
+    }
+    CHECK(sidesKept);
+    CHECK(std::fabs(GetArea(grid.Positions, result) - c_gridExtent * c_gridExtent) < 1e-3f);
+    CHECK(HasOnlyOutlineEdgesOpen(grid.Positions, result));
+
+    bool outlineOnly = true;
+    for (uint32_t v : result)
+    {
+        outlineOnly &= IsOnOutline(grid.Positions[v]) || grid.Positions[v].x == float(seamColumn);
+    }
+    CHECK(outlineOnly);
+}
@@ -0,0 +1,120 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "Model.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    float Distance(const XMFLOAT3& a, const XMFLOAT3& b)
+    {
+        const float x = a.x - b.x, y = a.y - b.y, z = a.z - b.z;
+        return std::sqrt(x * x + y * y + z * z);
+    }
+}
+
+TEST(Model, LoadsMeshletFile)
+{
+    Model model;
+    REQUIRE(SUCCEEDED(model.LoadFromFile(L"Assets/Dragon_LOD1.bin")));
+    REQUIRE(model.GetMeshCount() > 0);
+
+    for (uint32_t m = 0; m < model.GetMeshCount(); ++m)
+    {
+        const Mesh& mesh = model.GetMesh(m);
+
+        // Every attribute the file has is in the layout, and positions are where it says.
+        bool hasPosition = false;
+        for (uint32_t e = 0; e < mesh.LayoutDesc.NumElements; ++e)
+        {
+            const D3D12_INPUT_ELEMENT_DESC& element = mesh.LayoutElems[e];
+            if (strcmp(element.SemanticName, "POSITION") == 0)
+            {
+                hasPosition = true;
+                CHECK_EQ(element.InputSlot, mesh.PositionSlot);
+            }
+        }
+        CHECK(hasPosition);
+        REQUIRE(mesh.PositionSlot < mesh.Vertices.size());
+        CHECK(mesh.VertexCount > 0);
+
+        // Meshlets partition the mesh's triangles.
+        uint32_t primitiveCount = 0;
+        for (const Meshlet& meshlet : mesh.Meshlets)
+        {
+            primitiveCount += meshlet.PrimCount;
+        }
+        CHECK_EQ(primitiveCount, mesh.IndexCount / 3);
+        CHECK_EQ(mesh.CullingData.size(), mesh.Meshlets.size());
+
+        uint32_t outOfRange = 0;
+        for (uint32_t i = 0; i < mesh.IndexCount; ++i)
+        {
+            outOfRange += mesh.GetIndex(i) >= mesh.VertexCount;
+        }
+        CHECK_EQ(outOfRange, 0u);
+
+        // The bounds hold every vertex, and so does the model's.
+        uint32_t outside = 0;
+        for (uint32_t v = 0; v < mesh.VertexCount; ++v)
+        {
+            const XMFLOAT3& position = mesh.GetPosition(v);
+            outside += Distance(position, mesh.BoundingSphere.Center) > mesh.BoundingSphere.Radius * 1.0001f;
+            outside += Distance(position, model.GetBoundingSphere().Center) > model.GetBoundingSphere().Radius * 1.0001f;
+        }
+        CHECK_EQ(outside, 0u);
+    }
+}
+
+TEST(Model, RejectsMissingAndForeignFiles)
+{
+    Model model;
+    CHECK_EQ(model.LoadFromFile(L"Assets/NoSuchModel.bin"), E_INVALIDARG);
+
+    // A file that isn't a meshlet file fails on its prolog.
+    CHECK_EQ(model.LoadFromFile(L"Assets/DragonFlyby.path"), E_FAIL);
+}
+
+TEST(Model, CopiesVertexBuffers)
+{
+    const std::vector<XMFLOAT4> positions = { XMFLOAT4(0, 0, 0, 1), XMFLOAT4(1, 0, 0, 1), XMFLOAT4(0, 1, 0, 1) };
+
+    Model model;
+    REQUIRE(SUCCEEDED(model.LoadFromVtxBuffer(positions)));
+
+    const Prim& prim = model.GetPrims();
+    CHECK_EQ(prim.VertexCount, 3u);
+    CHECK_EQ(prim.IndexCount, 3u);
+    REQUIRE(prim.Vertices.size() == 1 && prim.Vertices[0].size() == sizeof(XMFLOAT4) * 3);
+    CHECK(memcmp(prim.Vertices[0].data(), positions.data(), prim.Vertices[0].size()) == 0);
+    CHECK(strcmp(prim.LayoutDesc.pInputElementDescs[0].SemanticName, "POSITION") == 0);
+}
+
+TEST(Model, RejectsInstanceStreams)
+{
+    const D3D12_INPUT_ELEMENT_DESC elements[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+    };
+
+    const float data[9] = {};
+    const void* buffers[] = { data, data };
+    const uint32_t strides[] = { 12, 8 };
+
+    Model model;
+    CHECK_EQ(model.LoadFromVertexBuffers({ elements, _countof(elements) }, buffers, strides, 2, 3), E_NOTIMPL);
+}
@@ -0,0 +1,242 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "NullRhi.h"
+#include "RhiDrawTarget.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+// Draws are translated onto a NullRhi command list through RhiDrawTarget, and the submitted
+// stream checked against the same draw translated into a RecordingDrawTarget.
+namespace
+{
+    const uint32_t c_stride = 12;
+    const uint32_t c_vertexCount = 1000;
+    const uint32_t c_indexCount = 3000;
+    const uint32_t c_descriptorCount = 64;
+    const uint64_t c_recordSize = 4096;
+
+    VertexLayout PositionLayout()
+    {
+        VertexLayout layout = {};
+        layout.Elements.push_back(VertexElement{ 0, 0, DXGI_FORMAT_R32G32B32_FLOAT, 0 });
+        layout.Strides[0] = c_stride;
+        layout.PositionElement = 0;
+        return layout;
+    }
+
+    std::unique_ptr<RhiBuffer> CreateBuffer(NullRhiDevice& device, uint64_t size, RhiHeapType::EType heap, RhiBufferState::EType state)
+    {
+        std::unique_ptr<RhiBuffer> buffer;
+        RhiBufferDesc desc = { size, heap, state, false };
+        if (FAILED(device.CreateBuffer(desc, buffer)))
+            throw std::runtime_error("CreateBuffer failed.");
+
+        return buffer;
+    }
+
+    void Draw(MeshDrawTarget& target, const D3D12_VERTEX_BUFFER_VIEW& vertexBuffer, const D3D12_INDEX_BUFFER_VIEW& indexBuffer)
+    {
+        FixedFunctionContext context(target);
+        context.SetVertexLayout(PositionLayout());
+        context.IASetVertexBuffers(0, 1, &vertexBuffer);
+        context.IASetIndexBuffer(&indexBuffer);
+        context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        context.DrawIndexedInstanced(c_indexCount, 2, 0, 0, 0);
+    }
+
+    // Events of the log from the one after 'first' of the given type, to the end.
+    std::vector<NullRhiEvent> GetEventsAfter(const std::vector<NullRhiEvent>& log, NullRhiEvent::EType first)
+    {
+        for (size_t i = 0; i < log.size(); ++i)
+        {
+            if (log[i].Type == first)
+                return std::vector<NullRhiEvent>(log.begin() + i + 1, log.end());
+        }
+
+        return std::vector<NullRhiEvent>();
+    }
+
+    bool IsEvent(const NullRhiEvent& event, NullRhiEvent::EType type, uint32_t object, uint64_t arg0, uint64_t arg1 = 0, uint64_t arg2 = 0)
+    {
+        return event.Type == type && event.Object == object && event.Args[0] == arg0 && event.Args[1] == arg1 && event.Args[2] == arg2;
+    }
+}
+
+TEST(NullRhi, LogsTheCommandsOfATranslatedDraw)
+{
+    NullRhiDevice device;
+
+    std::unique_ptr<RhiBuffer> vertices = CreateBuffer(device, c_vertexCount * c_stride, RhiHeapType::Default, RhiBufferState::CopyDest);
+    std::unique_ptr<RhiBuffer> indices = CreateBuffer(device, c_indexCount * 4, RhiHeapType::Default, RhiBufferState::CopyDest);
+    std::unique_ptr<RhiBuffer> staging = CreateBuffer(device, c_indexCount * 4, RhiHeapType::Upload, RhiBufferState::GenericRead);
+    std::unique_ptr<RhiBuffer> records = CreateBuffer(device, c_recordSize, RhiHeapType::Upload, RhiBufferState::GenericRead);
+
+    std::unique_ptr<RhiDescriptorHeap> heap;
+    std::unique_ptr<RhiCommandList> commandList;
+    REQUIRE(SUCCEEDED(device.CreateDescriptorHeap(c_descriptorCount, heap)));
+    REQUIRE(SUCCEEDED(device.CreateCommandList(commandList)));
+
+    // Buffers are numbered in creation order, on their own 64KB of address space.
+    CHECK(IsEvent(device.GetLog()[0], NullRhiEvent::CreateBuffer, 1, c_vertexCount * c_stride, RhiHeapType::Default, RhiBufferState::CopyDest));
+    CHECK(IsEvent(device.GetLog()[4], NullRhiEvent::CreateDescriptorHeap, 1, c_descriptorCount));
+    CHECK_EQ(indices->GetGpuAddress() - vertices->GetGpuAddress(), 64 * 1024ull);
+
+    uint32_t* indexData = static_cast<uint32_t*>(staging->Map());
+    for (uint32_t i = 0; i < c_indexCount; ++i)
+    {
+        indexData[i] = i % c_vertexCount;
+    }
+
+    const D3D12_VERTEX_BUFFER_VIEW vertexBuffer = { vertices->GetGpuAddress(), c_vertexCount * c_stride, c_stride };
+    const D3D12_INDEX_BUFFER_VIEW indexBuffer = { indices->GetGpuAddress(), c_indexCount * 4, DXGI_FORMAT_R32_UINT };
+
+    RecordingDrawTarget expected;
+    Draw(expected, vertexBuffer, indexBuffer);
+    REQUIRE(expected.GetCommands().size() >= 3);
+
+    REQUIRE(SUCCEEDED(commandList->Reset()));
+    commandList->CopyBuffer(indices.get(), 0, staging.get(), 0, c_indexCount * 4);
+    commandList->Barrier(indices.get(), RhiBufferState::CopyDest, RhiBufferState::ShaderResource);
+    commandList->SetDescriptorHeap(heap.get());
+    {
+        RhiDrawTarget target(commandList.get(), heap.get(), 8, c_descriptorCount - 8, records.get(),
+            static_cast<uint8_t*>(records->Map()), 0, c_recordSize);
+        target.RegisterBuffer(vertices.get());
+        target.RegisterBuffer(indices.get());
+
+        device.ClearLog();
+        Draw(target, vertexBuffer, indexBuffer);
+    }
+    REQUIRE(SUCCEEDED(commandList->Close()));
+
+    // Views are written as the draw is recorded: no records, the one vertex slot in use, the
+    // unused ones null, then the index buffer.
+    const std::vector<NullRhiEvent> views = device.GetLog();
+    REQUIRE(views.size() == 2 + c_maxVertexSlots);
+    CHECK(IsEvent(views[0], NullRhiEvent::CreateView, 1, 8, 0, 0));
+    CHECK(IsEvent(views[1], NullRhiEvent::CreateView, 1, 9, 1, 0) && views[1].Args[3] == c_vertexCount * c_stride / 4);
+    CHECK(IsEvent(views[2], NullRhiEvent::CreateView, 1, 10, 0, 0));
+    CHECK(IsEvent(views[1 + c_maxVertexSlots], NullRhiEvent::CreateView, 1, 9 + c_maxVertexSlots, 2, 0) && views.back().Args[3] == c_indexCount);
+
+    RhiCommandList* const lists[] = { commandList.get() };
+    device.GetQueue()->Submit(lists, 1);
+    uint64_t dispatchCount = 0;
+    for (const RecordingDrawTarget::Command& command : expected.GetCommands())
+    {
+        dispatchCount += command.Type == RecordingDrawTarget::Command::DispatchMesh ? 1 : 0;
+    }
+    CHECK_EQ(device.GetSubmittedDispatchCount(), dispatchCount);
+
+    const std::vector<NullRhiEvent> commands = GetEventsAfter(device.GetLog(), NullRhiEvent::Submit);
+    REQUIRE(commands.size() == 3 + expected.GetCommands().size());
+    CHECK(IsEvent(commands[0], NullRhiEvent::Copy, 2, 0, 3, 0) && commands[0].Args[3] == c_indexCount * 4);
+    CHECK(IsEvent(commands[1], NullRhiEvent::Barrier, 2, RhiBufferState::CopyDest, RhiBufferState::ShaderResource));
+    CHECK(IsEvent(commands[2], NullRhiEvent::SetDescriptorHeap, 1, 0));
+
+    // Then one root binding per translated command, with the draw parameters as root constants.
+    bool matches = true;
+    for (size_t i = 0; i < expected.GetCommands().size(); ++i)
+    {
+        const RecordingDrawTarget::Command& command = expected.GetCommands()[i];
+        const NullRhiEvent& event = commands[3 + i];
+
+        switch (command.Type)
+        {
+        case RecordingDrawTarget::Command::SetBuffers:
+            matches &= IsEvent(event, NullRhiEvent::SetDescriptorTable, 1, c_drawBuffersRootIndex, 8);
+            break;
+
+        case RecordingDrawTarget::Command::SetDrawParams:
+            matches &= IsEvent(event, NullRhiEvent::SetConstants, 0, c_drawParamsRootIndex, 0, sizeof(MeshDrawParams) / 4) &&
+                memcmp(&device.GetConstants()[static_cast<size_t>(event.Args[3])], &command.Params, sizeof(MeshDrawParams)) == 0;
+            break;
+
+        case RecordingDrawTarget::Command::DispatchMesh:
+            matches &= IsEvent(event, NullRhiEvent::DispatchMesh, 0, command.GroupCount[0], command.GroupCount[1], command.GroupCount[2]);
+            break;
+
+        default:
+            matches = false;
+            break;
+        }
+    }
+    CHECK(matches);
+
+    // The copy happened: read the indices back.
+    std::unique_ptr<RhiBuffer> readback = CreateBuffer(device, c_indexCount * 4, RhiHeapType::Readback, RhiBufferState::CopyDest);
+    REQUIRE(SUCCEEDED(commandList->Reset()));
+    commandList->Barrier(indices.get(), RhiBufferState::ShaderResource, RhiBufferState::CopySource);
+    commandList->CopyBuffer(readback.get(), 0, indices.get(), 0, c_indexCount * 4);
+    REQUIRE(SUCCEEDED(commandList->Close()));
+    device.GetQueue()->Submit(lists, 1);
+    CHECK(memcmp(readback->Map(), indexData, c_indexCount * 4) == 0);
+
+    // Written out, states are numbered as in RhiBufferState.
+    std::ostringstream log;
+    device.WriteLog(log);
+    CHECK(log.str().find("Barrier #2 1 3\nSetDescriptorHeap #1\n") != std::string::npos);
+    CHECK(log.str().find("Barrier #2 3 2\n") != std::string::npos);
+}
+
+TEST(NullRhi, AdvancesFencesBehindTheQueue)
+{
+    NullRhiDevice device(2);
+
+    std::unique_ptr<RhiFence> fence;
+    REQUIRE(SUCCEEDED(device.CreateFence(0, fence)));
+
+    std::unique_ptr<RhiCommandList> commandList;
+    REQUIRE(SUCCEEDED(device.CreateCommandList(commandList)));
+    RhiCommandList* const lists[] = { commandList.get() };
+
+    // Frames as the renderer submits them: the GPU runs two signals behind.
+    for (uint64_t frame = 1; frame <= 4; ++frame)
+    {
+        REQUIRE(SUCCEEDED(commandList->Reset()));
+        commandList->DispatchMesh(1, 1, 1);
+        REQUIRE(SUCCEEDED(commandList->Close()));
+
+        device.GetQueue()->Submit(lists, 1);
+        REQUIRE(SUCCEEDED(device.GetQueue()->Signal(fence.get(), frame)));
+        CHECK_EQ(fence->GetCompletedValue(), frame > 2 ? frame - 2 : 0);
+    }
+    CHECK_EQ(device.GetSubmittedDispatchCount(), 4ull);
+
+    // Waiting on a completed value doesn't stall; waiting on a pending one completes every
+    // signal up to it, but not the ones after.
+    device.ClearLog();
+    fence->Wait(2);
+    fence->Wait(3);
+    CHECK_EQ(fence->GetCompletedValue(), 3ull);
+
+    REQUIRE(device.GetLog().size() == 3);
+    CHECK(IsEvent(device.GetLog()[0], NullRhiEvent::Wait, 1, 2, 0));
+    CHECK(IsEvent(device.GetLog()[1], NullRhiEvent::Wait, 1, 3, 1));
+    CHECK(IsEvent(device.GetLog()[2], NullRhiEvent::Complete, 1, 3));
+
+    fence->Wait(4);
+    CHECK_EQ(fence->GetCompletedValue(), 4ull);
+
+    bool threw = false;
+    try
+    {
+        fence->Wait(5);
+    }
+    catch (const std::logic_error&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+}
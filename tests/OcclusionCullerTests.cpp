@@ -0,0 +1,128 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "OcclusionCuller.h"
+
+using namespace DirectX;
+
+// With an identity view-projection, positions are already clip space with w = 1, so on a
+// 64x64 buffer x lands at screen 32x + 32.
+namespace
+{
+    const uint32_t c_size = 64;
+
+    float ToClipX(float screenX)
+    {
+        return screenX / 32.0f - 1.0f;
+    }
+
+    // A clockwise quad from the left edge of the screen to 'rightX' in screen pixels, over its
+    // whole height, at depth z.
+    void AddWall(OcclusionCuller& culler, float rightX, float z)
+    {
+        const float x = ToClipX(rightX);
+        const XMFLOAT3 positions[] = { { -1, 1, z }, { x, 1, z }, { x, -1, z }, { -1, -1, z } };
+        const uint32_t indices[] = { 0, 1, 2,  0, 2, 3 };
+
+        XMFLOAT4X4 world;
+        XMStoreFloat4x4(&world, XMMatrixIdentity());
+        culler.AddOccluder(positions, 4, indices, 6, world);
+    }
+
+    void InitCuller(OcclusionCuller& culler)
+    {
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, XMMatrixIdentity());
+
+        culler.Init(c_size, c_size);
+        culler.SetViewProjection(viewProj);
+    }
+
+    float GetDepth(const OcclusionCuller& culler, uint32_t x, uint32_t y)
+    {
+        return culler.GetDepthBuffer()[y * culler.GetWidth() + x];
+    }
+}
+
+TEST(OcclusionCuller, WritesOnlyFullyCoveredPixels)
+{
+    OcclusionCuller culler;
+    InitCuller(culler);
+
+    // The wall's right edge at 20.7 covers pixel 20 (20..21) partially, center included.
+    AddWall(culler, 20.7f, 0.5f);
+    culler.RenderOccluders(1);
+
+    CHECK_EQ(GetDepth(culler, 19, 10), 0.5f);
+    CHECK_EQ(GetDepth(culler, 20, 10), 1.0f);
+    CHECK_EQ(GetDepth(culler, 40, 10), 1.0f);
+
+    // Pixels on the wall's diagonal are covered partly by each triangle and by neither fully.
+    uint32_t empty = 0;
+    for (uint32_t y = 0; y < c_size; ++y)
+    {
+        for (uint32_t x = 0; x < 20; ++x)
+        {
+            empty += GetDepth(culler, x, y) == 1.0f;
+        }
+    }
+    CHECK(empty > 0);
+    CHECK(empty < 2 * c_size);
+}
+
+TEST(OcclusionCuller, HidesSpheresBehindOccluders)
+{
+    OcclusionCuller culler;
+    InitCuller(culler);
+    AddWall(culler, 40.0f, 0.5f);
+    culler.RenderOccluders(1);
+
+    // Behind the wall, clear of its diagonal.
+    CHECK(!culler.IsSphereVisible(XMFLOAT3(ToClipX(8.0f), -0.6f, 0.8f), 0.05f));
+
+    // In front of the wall.
+    CHECK(culler.IsSphereVisible(XMFLOAT3(ToClipX(8.0f), -0.6f, 0.3f), 0.05f));
+
+    // Behind, but beside the wall.
+    CHECK(culler.IsSphereVisible(XMFLOAT3(ToClipX(56.0f), 0.0f, 0.8f), 0.05f));
+
+    // Outside the view.
+    CHECK(!culler.IsSphereVisible(XMFLOAT3(3.0f, 0.0f, 0.5f), 0.05f));
+}
+
+TEST(OcclusionCuller, KeepsSpheresSeenThroughPartlyCoveredPixels)
+{
+    OcclusionCuller culler;
+    InitCuller(culler);
+    AddWall(culler, 20.7f, 0.5f);
+    culler.RenderOccluders(1);
+
+    // A sphere behind the wall whose footprint is only pixel 20, right of the wall's edge.
+    // Sampling coverage at pixel centers would have written the wall's depth there.
+    CHECK(culler.IsSphereVisible(XMFLOAT3(ToClipX(20.85f), -0.6f, 0.8f), 0.003f));
+}
+
+TEST(OcclusionCuller, MatchesAcrossThreadCounts)
+{
+    OcclusionCuller one, many;
+    InitCuller(one);
+    InitCuller(many);
+    AddWall(one, 40.0f, 0.25f);
+    AddWall(one, 60.0f, 0.5f);
+    AddWall(many, 40.0f, 0.25f);
+    AddWall(many, 60.0f, 0.5f);
+
+    one.RenderOccluders(1);
+    many.RenderOccluders(4);
+
+    CHECK(std::equal(one.GetDepthBuffer(), one.GetDepthBuffer() + c_size * c_size, many.GetDepthBuffer()));
+}
@@ -0,0 +1,130 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Test.h"
+#include "PipelineLibraryFile.h"
+
+#include <vector>
+
+namespace
+{
+    const PipelineLibraryIdentity c_identity = { 0x10de, 0x2684, 0x16f41043, 0xa1, 0x001f000e000a1234ull };
+
+    std::vector<uint8_t> MakeLibrary(size_t size)
+    {
+        std::vector<uint8_t> library(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            library[i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+
+        return library;
+    }
+
+    PipelineLibraryFile::EStatus Read(const std::vector<uint8_t>& file, const PipelineLibraryIdentity& identity = c_identity)
+    {
+        size_t offset;
+        size_t size;
+        return ReadPipelineLibraryFile(file.data(), file.size(), identity, offset, size);
+    }
+}
+
+TEST(PipelineLibraryFile, ReadsBackWhatWasWritten)
+{
+    const std::vector<uint8_t> library = MakeLibrary(1001);
+
+    std::vector<uint8_t> file;
+    WritePipelineLibraryFile(c_identity, library.data(), library.size(), file);
+
+    size_t offset;
+    size_t size;
+    REQUIRE(ReadPipelineLibraryFile(file.data(), file.size(), c_identity, offset, size) == PipelineLibraryFile::Valid);
+    CHECK_EQ(offset % 8, 0u);
+    REQUIRE(size == library.size());
+    CHECK(std::vector<uint8_t>(file.begin() + offset, file.begin() + offset + size) == library);
+
+    // A device with nothing serialized yet still writes a file.
+    WritePipelineLibraryFile(c_identity, nullptr, 0, file);
+    CHECK_EQ(ReadPipelineLibraryFile(file.data(), file.size(), c_identity, offset, size), PipelineLibraryFile::Valid);
+    CHECK_EQ(size, 0u);
+}
+
+TEST(PipelineLibraryFile, RejectsOtherAdaptersAndDrivers)
+{
+    const std::vector<uint8_t> library = MakeLibrary(256);
+
+    std::vector<uint8_t> file;
+    WritePipelineLibraryFile(c_identity, library.data(), library.size(), file);
+
+    PipelineLibraryIdentity other = c_identity;
+    other.VendorId = 0x1002;
+    CHECK_EQ(Read(file, other), PipelineLibraryFile::IdentityMismatch);
+
+    other = c_identity;
+    other.DeviceId += 1;
+    CHECK_EQ(Read(file, other), PipelineLibraryFile::IdentityMismatch);
+
+    other = c_identity;
+    other.SubSysId += 1;
+    CHECK_EQ(Read(file, other), PipelineLibraryFile::IdentityMismatch);
+
+    other = c_identity;
+    other.Revision += 1;
+    CHECK_EQ(Read(file, other), PipelineLibraryFile::IdentityMismatch);
+
+    // A driver update is the common case.
+    other = c_identity;
+    other.DriverVersion += 1;
+    CHECK_EQ(Read(file, other), PipelineLibraryFile::IdentityMismatch);
+
+    size_t offset = 1;
+    size_t size = 1;
+    ReadPipelineLibraryFile(file.data(), file.size(), other, offset, size);
+    CHECK_EQ(offset, 0u);
+    CHECK_EQ(size, 0u);
+}
+
+TEST(PipelineLibraryFile, RejectsTruncatedAndDamagedFiles)
+{
+    const std::vector<uint8_t> library = MakeLibrary(256);
+
+    std::vector<uint8_t> file;
+    WritePipelineLibraryFile(c_identity, library.data(), library.size(), file);
+    REQUIRE(Read(file) == PipelineLibraryFile::Valid);
+
+    bool allCorrupt = true;
+    for (size_t size = 0; size < file.size(); ++size)
+    {
+        allCorrupt &= Read(std::vector<uint8_t>(file.begin(), file.begin() + size)) == PipelineLibraryFile::Corrupt;
+    }
+    CHECK(allCorrupt);
+
+    std::vector<uint8_t> extended = file;
+    extended.push_back(0);
+    CHECK_EQ(Read(extended), PipelineLibraryFile::Corrupt);
+
+    // A damaged byte anywhere reads as corrupt, in the identity as much as in the library, so
+    // a bad disk isn't mistaken for a driver update. Bytes 4 to 7 are the version.
+    bool damagedCorrupt = true;
+    for (size_t i = 0; i < file.size(); ++i)
+    {
+        if (i >= 4 && i < 8)
+            continue;
+
+        std::vector<uint8_t> damaged = file;
+        damaged[i] ^= 0x40;
+        damagedCorrupt &= Read(damaged) == PipelineLibraryFile::Corrupt;
+    }
+    CHECK(damagedCorrupt);
+
+    std::vector<uint8_t> newer = file;
+    newer[4] += 1;
+    CHECK_EQ(Read(newer), PipelineLibraryFile::OldVersion);
+}
@@ -0,0 +1,284 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "FixedFunctionContext.h"
+#include "PrimitiveAssembly.h"
+
+#include <vector>
+
+namespace
+{
+    const uint32_t c_cut = 0xffff;
+    const uint32_t c_none = ~0u;
+
+    std::vector<AssembledPrimitive> Assemble(D3D_PRIMITIVE_TOPOLOGY topology, const std::vector<uint32_t>& indices, uint32_t cutIndex = c_cut)
+    {
+        std::vector<AssembledPrimitive> primitives;
+        AssemblePrimitives(topology, indices.data(), static_cast<uint32_t>(indices.size()), cutIndex, primitives);
+        return primitives;
+    }
+
+    std::vector<AssembledPrimitive> Assemble(D3D_PRIMITIVE_TOPOLOGY topology, uint32_t count)
+    {
+        std::vector<AssembledPrimitive> primitives;
+        AssemblePrimitives(topology, nullptr, count, 0, primitives);
+        return primitives;
+    }
+
+    bool Is(const AssembledPrimitive& primitive, uint32_t l0, uint32_t l1 = c_none, uint32_t l2 = c_none)
+    {
+        return primitive.Locations[0] == l0 && primitive.Locations[1] == l1 && primitive.Locations[2] == l2;
+    }
+
+    bool Same(const std::vector<AssembledPrimitive>& a, const std::vector<AssembledPrimitive>& b)
+    {
+        if (a.size() != b.size())
+            return false;
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (!Is(a[i], b[i].Locations[0], b[i].Locations[1], b[i].Locations[2]))
+                return false;
+        }
+        return true;
+    }
+
+    // The primitives the mesh shader's groups assemble for a draw starting at 'start' of
+    // 'indices', in group and slot order, which is the order they rasterize in.
+    std::vector<AssembledPrimitive> AssembleByGroups(D3D_PRIMITIVE_TOPOLOGY topology, const std::vector<uint32_t>* indices, uint32_t start, uint32_t count, uint32_t cutIndex)
+    {
+        const PrimitiveTopologyInfo& info = *GetPrimitiveTopologyInfo(topology);
+
+        MeshDrawParams params = {};
+        params.StartLocation = start;
+        params.StripStart = start;
+        params.VertexCount = count;
+        params.CutIndex = cutIndex;
+
+        const uint32_t groupCount = GetDispatchGroupCount(GetPrimitiveSlotCount(info, count), info.GroupPrimitives);
+        const uint32_t* indexData = indices ? indices->data() : nullptr;
+
+        std::vector<uint32_t> stripStarts(groupCount);
+        GetGroupStripStarts(info, params, indexData, groupCount, stripStarts.data());
+
+        std::vector<AssembledPrimitive> primitives;
+        for (uint32_t group = 0; group < groupCount; ++group)
+        {
+            for (uint32_t slot = 0; slot < info.GroupPrimitives; ++slot)
+            {
+                AssembledPrimitive primitive;
+                if (GetGroupPrimitive(info, params, group, slot, indexData, stripStarts[group], primitive))
+                {
+                    for (uint32_t& location : primitive.Locations)
+                    {
+                        location = location == c_none ? c_none : location - start;
+                    }
+                    primitives.push_back(primitive);
+                }
+            }
+        }
+        return primitives;
+    }
+}
+
+TEST(PrimitiveAssembly, AssemblesLists)
+{
+    std::vector<AssembledPrimitive> primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_POINTLIST, 2);
+    REQUIRE(primitives.size() == 2);
+    CHECK(Is(primitives[1], 1));
+
+    // Incomplete primitives at the end are dropped.
+    primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_LINELIST, 5);
+    REQUIRE(primitives.size() == 2);
+    CHECK(Is(primitives[1], 2, 3));
+
+    primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, 8);
+    REQUIRE(primitives.size() == 2);
+    CHECK(Is(primitives[0], 0, 1, 2));
+    CHECK(Is(primitives[1], 3, 4, 5));
+}
+
+TEST(PrimitiveAssembly, KeepsStripWindingByAlternating)
+{
+    const std::vector<AssembledPrimitive> primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, 5);
+    REQUIRE(primitives.size() == 3);
+    CHECK(Is(primitives[0], 0, 1, 2));
+    CHECK(Is(primitives[1], 2, 1, 3));
+    CHECK(Is(primitives[2], 2, 3, 4));
+
+    const std::vector<AssembledPrimitive> lines = Assemble(D3D_PRIMITIVE_TOPOLOGY_LINESTRIP, 3);
+    REQUIRE(lines.size() == 2);
+    CHECK(Is(lines[1], 1, 2));
+}
+
+TEST(PrimitiveAssembly, PutsFanCenterLast)
+{
+    const std::vector<AssembledPrimitive> primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN, 5);
+    REQUIRE(primitives.size() == 3);
+    CHECK(Is(primitives[0], 1, 2, 0));
+    CHECK(Is(primitives[1], 2, 3, 0));
+    CHECK(Is(primitives[2], 3, 4, 0));
+}
+
+TEST(PrimitiveAssembly, RestartsStripsAtCutIndex)
+{
+    // Two strips around a cut at location 4; the second restarts its winding, so its first
+    // triangle isn't swapped though it's the strip's fourth location overall.
+    const std::vector<uint32_t> indices = { 10, 11, 12, 13, c_cut, 20, 21, 22, 23 };
+    std::vector<AssembledPrimitive> primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, indices);
+    REQUIRE(primitives.size() == 4);
+    CHECK(Is(primitives[0], 0, 1, 2));
+    CHECK(Is(primitives[1], 2, 1, 3));
+    CHECK(Is(primitives[2], 5, 6, 7));
+    CHECK(Is(primitives[3], 7, 6, 8));
+
+    // Fans take the first location after the cut as their center.
+    primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN, indices);
+    REQUIRE(primitives.size() == 4);
+    CHECK(Is(primitives[1], 2, 3, 0));
+    CHECK(Is(primitives[2], 6, 7, 5));
+
+    // Adjacent cuts, and strips too short for a primitive, produce nothing.
+    primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, { c_cut, 1, 2, c_cut, c_cut, 3, 4, 5 });
+    REQUIRE(primitives.size() == 1);
+    CHECK(Is(primitives[0], 5, 6, 7));
+
+    // Without restart, or in lists, the cut value is an ordinary index.
+    CHECK_EQ(Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, indices, 0).size(), 7u);
+    CHECK_EQ(Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, indices).size(), 3u);
+}
+
+TEST(PrimitiveAssembly, SkipsAdjacencyVertices)
+{
+    std::vector<AssembledPrimitive> primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_LINELIST_ADJ, 8);
+    REQUIRE(primitives.size() == 2);
+    CHECK(Is(primitives[0], 1, 2));
+    CHECK(Is(primitives[1], 5, 6));
+
+    primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ, 6);
+    REQUIRE(primitives.size() == 3);
+    CHECK(Is(primitives[2], 3, 4));
+
+    primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST_ADJ, 12);
+    REQUIRE(primitives.size() == 2);
+    CHECK(Is(primitives[0], 0, 2, 4));
+    CHECK(Is(primitives[1], 6, 8, 10));
+
+    // Strip triangles use the even locations, alternating as plain strips do.
+    primitives = Assemble(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ, 10);
+    REQUIRE(primitives.size() == 3);
+    CHECK(Is(primitives[0], 0, 2, 4));
+    CHECK(Is(primitives[1], 4, 2, 6));
+    CHECK(Is(primitives[2], 4, 6, 8));
+}
+
+TEST(PrimitiveAssembly, RejectsPatchLists)
+{
+    std::vector<AssembledPrimitive> primitives;
+    CHECK_EQ(AssemblePrimitives(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED, nullptr, 3, 0, primitives), E_NOTIMPL);
+    CHECK(GetPrimitiveTopologyInfo(D3D_PRIMITIVE_TOPOLOGY_UNDEFINED) == nullptr);
+}
+
+TEST(PrimitiveAssembly, GroupsFitTheirOutputLimit)
+{
+    const D3D_PRIMITIVE_TOPOLOGY topologies[] =
+    {
+        D3D_PRIMITIVE_TOPOLOGY_POINTLIST, D3D_PRIMITIVE_TOPOLOGY_LINELIST, D3D_PRIMITIVE_TOPOLOGY_LINESTRIP,
+        D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN,
+        D3D_PRIMITIVE_TOPOLOGY_LINELIST_ADJ, D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ,
+        D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST_ADJ, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ,
+    };
+
+    for (D3D_PRIMITIVE_TOPOLOGY topology : topologies)
+    {
+        const PrimitiveTopologyInfo* info = GetPrimitiveTopologyInfo(topology);
+        REQUIRE(info != nullptr);
+
+        // Point lists output a quad per point.
+        const uint32_t outputVertices = topology == D3D_PRIMITIVE_TOPOLOGY_POINTLIST ? info->GroupPrimitives * 4 : GetGroupLocationCount(*info);
+        CHECK(outputVertices <= 64);
+    }
+}
+
+TEST(PrimitiveAssembly, GroupsMatchTheReference)
+{
+    // Strips long enough to cross several group windows, with cuts in the first window, on
+    // a window boundary, and none for more than a window at the end.
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 400; ++i)
+    {
+        indices.push_back(i == 5 || i == 62 || i == 63 || i == 124 || i == 190 ? c_cut : i);
+    }
+
+    const D3D_PRIMITIVE_TOPOLOGY topologies[] =
+    {
+        D3D_PRIMITIVE_TOPOLOGY_LINESTRIP, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN,
+        D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ,
+        D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST_ADJ,
+    };
+
+    for (D3D_PRIMITIVE_TOPOLOGY topology : topologies)
+    {
+        // Indexed with restart, indexed without, and not indexed.
+        CHECK(Same(AssembleByGroups(topology, &indices, 0, 400, c_cut), Assemble(topology, indices)));
+        CHECK(Same(AssembleByGroups(topology, &indices, 0, 400, 0), Assemble(topology, indices, 0)));
+        CHECK(Same(AssembleByGroups(topology, nullptr, 0, 400, 0), Assemble(topology, 400)));
+
+        // A draw starting partway into the buffer assembles relative to its start.
+        const std::vector<uint32_t> tail(indices.begin() + 7, indices.end());
+        CHECK(Same(AssembleByGroups(topology, &indices, 7, 393, c_cut), Assemble(topology, tail)));
+    }
+}
+
+TEST(PrimitiveAssembly, FindsStripStartsInOnePass)
+{
+    // A dispatch split off partway into a draw: cuts before the dispatch, within one window and
+    // on window boundaries, and a run of windows with none.
+    std::vector<uint32_t> indices(1000);
+    for (uint32_t i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = i == 20 || i == 130 || i == 131 || i == 300 || i == 301 || i == 302 || i == 640 ? c_cut : i;
+    }
+
+    const D3D_PRIMITIVE_TOPOLOGY topologies[] =
+    {
+        D3D_PRIMITIVE_TOPOLOGY_LINESTRIP, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, D3D_PRIMITIVE_TOPOLOGY_TRIANGLEFAN,
+        D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ,
+    };
+
+    for (D3D_PRIMITIVE_TOPOLOGY topology : topologies)
+    {
+        const PrimitiveTopologyInfo& info = *GetPrimitiveTopologyInfo(topology);
+
+        MeshDrawParams params = {};
+        params.StripStart = 10;
+        params.StartLocation = 100;
+        params.VertexCount = 900;
+
+        const uint32_t groupCount = GetDispatchGroupCount(GetPrimitiveSlotCount(info, params.VertexCount), info.GroupPrimitives);
+        std::vector<uint32_t> stripStarts(groupCount);
+
+        for (uint32_t cutIndex : { c_cut, 0u })
+        {
+            params.CutIndex = cutIndex;
+            GetGroupStripStarts(info, params, indices.data(), groupCount, stripStarts.data());
+
+            for (uint32_t group = 0; group < groupCount; ++group)
+            {
+                CHECK_EQ(stripStarts[group], FindGroupStripStart(info, params, group, indices.data()));
+            }
+        }
+
+        // Without restart every group is in the draw's first strip.
+        CHECK_EQ(stripStarts.back(), 10u);
+    }
+}
@@ -0,0 +1,113 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "PrimitiveCulling.h"
+
+using namespace DirectX;
+
+// Triangles whose fate is worked out by hand on a 100x100 viewport, where a clip-space point
+// with w = 1 lands at screen (50x + 50, 50 - 50y).
+namespace
+{
+    const XMFLOAT2 c_viewport(100.0f, 100.0f);
+
+    // The clip-space position, at w = 1, of a point in screen pixels.
+    XMFLOAT4 Screen(float x, float y, float z = 0.5f)
+    {
+        return XMFLOAT4(x / 50.0f - 1.0f, 1.0f - y / 50.0f, z, 1.0f);
+    }
+
+    bool Culled(const XMFLOAT4& c0, const XMFLOAT4& c1, const XMFLOAT4& c2, uint32_t flags = PrimitiveCull::All)
+    {
+        return IsPrimitiveCulled(c0, c1, c2, c_viewport, flags);
+    }
+}
+
+TEST(PrimitiveCulling, KeepsClockwiseTriangle)
+{
+    // (25,25) -> (75,25) -> (75,75) turns clockwise with y down: area 50 * 50 > 0.
+    CHECK(!Culled(Screen(25, 25), Screen(75, 25), Screen(75, 75)));
+}
+
+TEST(PrimitiveCulling, CullsCounterClockwiseOnlyWhenAsked)
+{
+    CHECK(Culled(Screen(25, 25), Screen(75, 75), Screen(75, 25)));
+    CHECK(Culled(Screen(25, 25), Screen(75, 75), Screen(75, 25), PrimitiveCull::Backface));
+    CHECK(!Culled(Screen(25, 25), Screen(75, 75), Screen(75, 25), PrimitiveCull::All & ~PrimitiveCull::Backface));
+    CHECK(!Culled(Screen(25, 25), Screen(75, 75), Screen(75, 25), PrimitiveCull::None));
+}
+
+TEST(PrimitiveCulling, CullsDegenerate)
+{
+    // Three points on the line y = x have zero area.
+    CHECK(Culled(Screen(10, 10), Screen(50, 50), Screen(90, 90), PrimitiveCull::Degenerate));
+
+    // A repeated vertex too.
+    CHECK(Culled(Screen(10, 10), Screen(10, 10), Screen(90, 20), PrimitiveCull::Degenerate));
+    CHECK(!Culled(Screen(10, 10), Screen(10, 10), Screen(90, 20), PrimitiveCull::Frustum));
+}
+
+TEST(PrimitiveCulling, CullsOutsideOneFrustumPlane)
+{
+    // Every vertex right of x = w.
+    CHECK(Culled(XMFLOAT4(1.5f, 0, 0.5f, 1), XMFLOAT4(3, 0, 0.5f, 1), XMFLOAT4(2, -1, 0.5f, 1), PrimitiveCull::Frustum));
+
+    // Every vertex behind the near plane, z < 0.
+    CHECK(Culled(Screen(25, 25, -0.1f), Screen(75, 25, -0.2f), Screen(75, 75, -0.3f), PrimitiveCull::Frustum));
+
+    // Beyond the far plane, z > w.
+    CHECK(Culled(Screen(25, 25, 1.1f), Screen(75, 25, 1.2f), Screen(75, 75, 1.3f), PrimitiveCull::Frustum));
+
+    // Outside different planes isn't outside the frustum: the triangle crosses it.
+    CHECK(!Culled(XMFLOAT4(-2, 0, 0.5f, 1), XMFLOAT4(2, 0, 0.5f, 1), XMFLOAT4(0, -2, 0.5f, 1), PrimitiveCull::Frustum));
+
+    // Straddling the plane x = w is kept.
+    CHECK(!Culled(XMFLOAT4(0.5f, 0, 0.5f, 1), XMFLOAT4(3, 0, 0.5f, 1), XMFLOAT4(2, -1, 0.5f, 1), PrimitiveCull::Frustum));
+}
+
+TEST(PrimitiveCulling, CullsTrianglesMissingEveryPixelCenter)
+{
+    // Between pixel centers 9.5 and 10.5 in both axes: x and y bounds both round to 10.
+    CHECK(Culled(Screen(10.1f, 10.1f), Screen(10.4f, 10.1f), Screen(10.4f, 10.4f), PrimitiveCull::SmallPrimitive));
+
+    // Thin in x only: 10.1..10.4 holds no center, though y spans many.
+    CHECK(Culled(Screen(10.1f, 10), Screen(10.4f, 10), Screen(10.4f, 40), PrimitiveCull::SmallPrimitive));
+
+    // 10.4..10.6 straddles the center at 10.5 in both axes, so it may cover that pixel.
+    CHECK(!Culled(Screen(10.4f, 10.4f), Screen(10.6f, 10.4f), Screen(10.6f, 10.6f), PrimitiveCull::SmallPrimitive));
+}
+
+TEST(PrimitiveCulling, LeavesTrianglesCrossingTheEyeToTheClipper)
+{
+    // Counter-clockwise on screen, but one vertex has w < 0, so screen-space tests don't apply.
+    const XMFLOAT4 behind(0.5f, 0.5f, 0.5f, -1.0f);
+    CHECK(!Culled(Screen(25, 25), Screen(75, 75), behind));
+}
+
+TEST(PrimitiveCulling, ListsSurvivorsInOrder)
+{
+    const XMFLOAT4 positions[] =
+    {
+        Screen(25, 25), Screen(75, 25), Screen(75, 75),   // Kept
+        Screen(10.1f, 10.1f), Screen(10.4f, 10.1f), Screen(10.4f, 10.4f),
+    };
+
+    // Front, back, small, front again, reusing vertices.
+    const uint32_t indices[] = { 0, 1, 2,  0, 2, 1,  3, 4, 5,  2, 0, 1 };
+
+    std::vector<uint32_t> survivors;
+    CHECK_EQ(CullPrimitives(positions, indices, 4, c_viewport, PrimitiveCull::All, survivors), 2u);
+    CHECK(survivors == std::vector<uint32_t>({ 0, 3 }));
+
+    CHECK_EQ(CullPrimitives(positions, indices, 4, c_viewport, PrimitiveCull::None, survivors), 4u);
+    CHECK(survivors == std::vector<uint32_t>({ 0, 1, 2, 3 }));
+}
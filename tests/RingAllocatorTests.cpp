@@ -0,0 +1,139 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "RingAllocator.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // As in D3D12MeshletRender: frames in flight, each allocating up to a frame's bytes less
+    // the alignment, from a ring of one frame more than are in flight.
+    const uint64_t c_frameCount = 2;
+    const uint64_t c_bytesPerFrame = 64 * 1024;
+    const uint64_t c_alignment = 16;
+
+    struct LiveAllocation
+    {
+        uint64_t FenceValue;
+        uint64_t Begin;
+        uint64_t End;
+    };
+
+    // Runs frames the way the renderer does, with the GPU as far behind as MoveToNextFrame()
+    // allows: a frame's slot is only waited on when it comes around again, so the fence of
+    // every other frame in flight is still pending when the frame allocates. Returns whether
+    // every allocation succeeded without overlapping memory of a frame in flight.
+    bool RunFramesInFlight(uint64_t ringSize, const std::vector<uint64_t>& frameSizes)
+    {
+        RingAllocator ring(ringSize);
+
+        uint64_t fenceValues[c_frameCount] = {};
+        uint64_t completedFenceValue = 0;
+        uint64_t nextFenceValue = 1;
+        std::vector<LiveAllocation> live;
+
+        for (size_t frame = 0; frame < frameSizes.size(); ++frame)
+        {
+            const size_t slot = frame % c_frameCount;
+            completedFenceValue = std::max(completedFenceValue, fenceValues[slot]);
+            ring.Reclaim(completedFenceValue);
+            live.erase(std::remove_if(live.begin(), live.end(), [&](const LiveAllocation& a) { return a.FenceValue <= completedFenceValue; }), live.end());
+
+            const uint64_t offset = ring.Allocate(frameSizes[frame], c_alignment);
+            if (offset == RingAllocator::InvalidOffset || offset % c_alignment != 0 || offset + frameSizes[frame] > ringSize)
+                return false;
+
+            for (const LiveAllocation& a : live)
+            {
+                if (offset < a.End && a.Begin < offset + frameSizes[frame])
+                    return false;
+            }
+
+            live.push_back({ nextFenceValue, offset, offset + frameSizes[frame] });
+            ring.FinishFrame(nextFenceValue);
+            fenceValues[slot] = nextFenceValue++;
+        }
+
+        return true;
+    }
+}
+
+TEST(RingAllocator, AllocatesAlignedAndWrapsWithoutSplitting)
+{
+    RingAllocator ring(256);
+
+    CHECK_EQ(ring.Allocate(100, 16), 0ull);
+    CHECK_EQ(ring.Allocate(50, 16), 112ull);
+    CHECK_EQ(ring.GetUsedSize(), 162ull);
+    ring.FinishFrame(1);
+
+    // 176 + 100 runs past the end, so the allocation starts over at 0 once frame 1 is freed.
+    CHECK(ring.Allocate(100, 16) == RingAllocator::InvalidOffset);
+    ring.Reclaim(1);
+    CHECK_EQ(ring.GetUsedSize(), 0ull);
+    CHECK_EQ(ring.Allocate(100, 16), 0ull);
+
+    CHECK(ring.Allocate(0, 16) == RingAllocator::InvalidOffset);
+    CHECK(ring.Allocate(257, 16) == RingAllocator::InvalidOffset);
+}
+
+TEST(RingAllocator, FreesFramesOnlyOnceTheirFenceCompletes)
+{
+    RingAllocator ring(256);
+
+    CHECK_EQ(ring.Allocate(128, 16), 0ull);
+    ring.FinishFrame(1);
+    CHECK_EQ(ring.Allocate(128, 16), 128ull);
+    ring.FinishFrame(2);
+
+    // A frame that allocates nothing holds nothing.
+    ring.FinishFrame(3);
+
+    ring.Reclaim(0);
+    CHECK_EQ(ring.GetUsedSize(), 256ull);
+    CHECK(ring.Allocate(16, 16) == RingAllocator::InvalidOffset);
+
+    ring.Reclaim(1);
+    CHECK_EQ(ring.GetUsedSize(), 128ull);
+    CHECK_EQ(ring.Allocate(16, 16), 0ull);
+
+    ring.Reclaim(3);
+    CHECK_EQ(ring.GetUsedSize(), 16ull);
+}
+
+TEST(RingAllocator, FitsFramesInFlightWithAFrameToSpare)
+{
+    std::mt19937 random(7);
+    std::uniform_int_distribution<uint64_t> size(1, c_bytesPerFrame - c_alignment);
+
+    std::vector<uint64_t> frameSizes(10000);
+    for (uint64_t& frameSize : frameSizes)
+    {
+        frameSize = size(random);
+    }
+    CHECK(RunFramesInFlight((c_frameCount + 1) * c_bytesPerFrame, frameSizes));
+
+    // Full frames back to back.
+    CHECK(RunFramesInFlight((c_frameCount + 1) * c_bytesPerFrame, std::vector<uint64_t>(100, c_bytesPerFrame - c_alignment)));
+}
+
+TEST(RingAllocator, OverflowsOneFramePerFrameInFlightOnWrap)
+{
+    // The bytes skipped at the end of the ring when an allocation wraps are held until the
+    // frame before it retires, so frames in flight don't fit in a frame's bytes each.
+    const std::vector<uint64_t> frameSizes = { c_bytesPerFrame / 2, c_bytesPerFrame - c_alignment, 3 * c_bytesPerFrame / 4 };
+    CHECK(!RunFramesInFlight(c_frameCount * c_bytesPerFrame, frameSizes));
+    CHECK(RunFramesInFlight((c_frameCount + 1) * c_bytesPerFrame, frameSizes));
+}
@@ -0,0 +1,211 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Test.h"
+#include "ShaderArchive.h"
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+    ShaderCompileRequest MakeRequest(uint32_t i)
+    {
+        ShaderCompileRequest request;
+        request.Source = "// Permutation " + std::to_string(i);
+        request.SourceName = "MeshletMS.hlsl";
+        request.EntryPoint = "main";
+        request.Profile = "ms_6_5";
+        request.Arguments.push_back("-DPERMUTATION=" + std::to_string(i));
+        return request;
+    }
+
+    // Sizes that aren't multiples of 8, and an empty blob, exercise the padding.
+    std::vector<uint8_t> MakeBytecode(uint32_t i)
+    {
+        std::vector<uint8_t> bytecode(i * 13 % 50);
+        for (size_t j = 0; j < bytecode.size(); ++j)
+        {
+            bytecode[j] = static_cast<uint8_t>(i + j);
+        }
+
+        return bytecode;
+    }
+
+    bool FindBytecode(const ShaderArchive& archive, const ShaderCompileRequest& request, std::vector<uint8_t>& bytecode)
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        if (!archive.Find(ComputeShaderArchiveKey(request), &data, &size))
+            return false;
+
+        bytecode.assign(data, data + size);
+        return reinterpret_cast<uintptr_t>(data) % 8 == 0;
+    }
+
+    bool WriteFileContents(const std::string& path, const std::string& contents)
+    {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream.write(contents.data(), contents.size());
+        stream.close();
+        return !stream.fail();
+    }
+
+    // Counts compiles; its bytecode is a single byte.
+    class CountingCompiler : public ShaderCompiler
+    {
+    public:
+        explicit CountingCompiler(uint32_t& compileCount) : m_compileCount(compileCount) {}
+
+        void Compile(const ShaderCompileRequest&, ShaderCompileResult& result) override
+        {
+            ++m_compileCount;
+            result.Status = 0;
+            result.Bytecode.assign(1, 0xcc);
+        }
+
+    private:
+        uint32_t& m_compileCount;
+    };
+}
+
+TEST(ShaderArchive, FindsWhatWasWritten)
+{
+    const std::string path = GetTestOutputPath("ShaderArchive.FindsWhatWasWritten.bin");
+    const uint32_t entryCount = 40;
+
+    // Added out of key order, and one added twice.
+    ShaderArchiveWriter writer;
+    for (uint32_t i = 0; i < entryCount; ++i)
+    {
+        writer.Add(ComputeShaderArchiveKey(MakeRequest(i)), i == 7 ? std::vector<uint8_t>(3, 0xff) : MakeBytecode(i));
+    }
+    writer.Add(ComputeShaderArchiveKey(MakeRequest(7)), MakeBytecode(7));
+    CHECK_EQ(writer.GetEntryCount(), entryCount);
+    REQUIRE(writer.Write(path));
+
+    ShaderArchive archive;
+    REQUIRE(archive.Open(path));
+    CHECK_EQ(archive.GetEntryCount(), entryCount);
+
+    bool allFound = true;
+    for (uint32_t i = 0; i < entryCount; ++i)
+    {
+        std::vector<uint8_t> bytecode;
+        allFound &= FindBytecode(archive, MakeRequest(i), bytecode) && bytecode == MakeBytecode(i);
+    }
+    CHECK(allFound);
+
+    // Any change to a request misses.
+    ShaderCompileRequest edited = MakeRequest(3);
+    edited.Source += "\n";
+    std::vector<uint8_t> bytecode;
+    CHECK(!FindBytecode(archive, MakeRequest(entryCount), bytecode));
+    CHECK(!FindBytecode(archive, edited, bytecode));
+
+    archive.Close();
+    CHECK_EQ(archive.GetEntryCount(), 0u);
+    CHECK(!FindBytecode(archive, MakeRequest(0), bytecode));
+
+    // An empty archive opens and finds nothing.
+    REQUIRE(ShaderArchiveWriter().Write(path));
+    CHECK(archive.Open(path));
+    CHECK_EQ(archive.GetEntryCount(), 0u);
+    CHECK(!FindBytecode(archive, MakeRequest(0), bytecode));
+}
+
+TEST(ShaderArchive, RejectsTruncatedAndDamagedArchives)
+{
+    const std::string path = GetTestOutputPath("ShaderArchive.RejectsTruncatedAndDamagedArchives.bin");
+
+    ShaderArchiveWriter writer;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        writer.Add(ComputeShaderArchiveKey(MakeRequest(i)), MakeBytecode(i + 1));
+    }
+    REQUIRE(writer.Write(path));
+
+    std::string contents;
+    REQUIRE(ReadFileContents(path, contents));
+
+    ShaderArchive archive;
+    CHECK(!archive.Open(GetTestOutputPath("ShaderArchive.Missing.bin")));
+
+    // The header is 16 bytes and each record 32: cut inside the header, the index and, past
+    // its padding of at most 7 bytes, the last blob.
+    const size_t truncations[] = { 0, 8, 16 + 3 * 32, contents.size() - 8 };
+    for (size_t size : truncations)
+    {
+        REQUIRE(WriteFileContents(path, contents.substr(0, size)));
+        CHECK(!archive.Open(path));
+        CHECK_EQ(archive.GetEntryCount(), 0u);
+    }
+
+    std::string damaged = contents;
+    damaged[0] ^= 1;
+    REQUIRE(WriteFileContents(path, damaged));
+    CHECK(!archive.Open(path));
+
+    // Swapping two records' keys leaves the index unsorted, which Find() can't search.
+    damaged = contents;
+    std::swap_ranges(damaged.begin() + 16, damaged.begin() + 32, damaged.begin() + 48);
+    REQUIRE(WriteFileContents(path, damaged));
+    CHECK(!archive.Open(path));
+
+    REQUIRE(WriteFileContents(path, contents));
+    CHECK(archive.Open(path));
+    CHECK_EQ(archive.GetEntryCount(), 4u);
+}
+
+TEST(ShaderArchive, CompilesOnlyWhatTheArchiveLacks)
+{
+    const std::string path = GetTestOutputPath("ShaderArchive.CompilesOnlyWhatTheArchiveLacks.bin");
+
+    ShaderArchiveWriter writer;
+    writer.Add(ComputeShaderArchiveKey(MakeRequest(0)), MakeBytecode(1));
+    REQUIRE(writer.Write(path));
+
+    ShaderArchive archive;
+    REQUIRE(archive.Open(path));
+
+    uint32_t factoryCount = 0;
+    uint32_t compileCount = 0;
+    ArchiveShaderCompiler compiler(&archive, [&]()
+        {
+            ++factoryCount;
+            return std::unique_ptr<ShaderCompiler>(new CountingCompiler(compileCount));
+        });
+
+    // A fully archived run never creates the fallback.
+    ShaderCompileResult result;
+    compiler.Compile(MakeRequest(0), result);
+    CHECK_EQ(result.Status, 0);
+    CHECK(result.Bytecode == MakeBytecode(1));
+    CHECK_EQ(factoryCount, 0u);
+
+    compiler.Compile(MakeRequest(1), result);
+    compiler.Compile(MakeRequest(2), result);
+    CHECK_EQ(result.Status, 0);
+    CHECK(result.Bytecode == std::vector<uint8_t>(1, 0xcc));
+    CHECK_EQ(factoryCount, 1u);
+    CHECK_EQ(compileCount, 2u);
+
+    // Without a fallback, misses fail and hits still succeed.
+    ArchiveShaderCompiler archiveOnly(&archive, nullptr);
+    archiveOnly.Compile(MakeRequest(1), result);
+    CHECK_EQ(result.Status, c_shaderNotInArchive);
+    CHECK(result.Bytecode.empty());
+    CHECK(!result.Errors.empty());
+
+    archiveOnly.Compile(MakeRequest(0), result);
+    CHECK_EQ(result.Status, 0);
+    CHECK(result.Errors.empty());
+}
@@ -0,0 +1,227 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Test.h"
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <vector>
+
+namespace
+{
+    const uint32_t c_keyCount = 8;
+
+    ShaderCacheKey MakeKey(uint32_t i)
+    {
+        ShaderCacheKey key = { { 0x1000 + i, 0x2000 + i } };
+        return key;
+    }
+
+    std::vector<uint8_t> MakeBytecode(uint32_t i, size_t size)
+    {
+        std::vector<uint8_t> bytecode(size);
+        for (size_t j = 0; j < size; ++j)
+        {
+            bytecode[j] = static_cast<uint8_t>(i * 31 + j);
+        }
+
+        return bytecode;
+    }
+
+    std::string GetEntryPath(const std::string& directory, const ShaderCacheKey& key)
+    {
+        return directory + "/" + key.ToString() + ".dxil";
+    }
+
+    // Returns a cache directory for the test holding none of MakeKey()'s entries and no index,
+    // whatever an earlier run left there.
+    std::string GetEmptyCacheDirectory(const char* name)
+    {
+        const std::string directory = GetTestOutputPath(std::string("ShaderCache.") + name);
+
+        std::remove((directory + "/index.bin").c_str());
+        for (uint32_t i = 0; i < c_keyCount; ++i)
+        {
+            std::remove(GetEntryPath(directory, MakeKey(i)).c_str());
+        }
+
+        return directory;
+    }
+
+    bool FileExists(const std::string& path)
+    {
+        return static_cast<bool>(std::ifstream(path));
+    }
+
+    // Reads files from a map instead of the disk; paths it lacks don't resolve.
+    ReadFileFunction ReadFrom(const std::map<std::string, std::string>& files)
+    {
+        return [files](const std::string& path, std::string& contents)
+        {
+            auto it = files.find(path);
+            if (it == files.end())
+                return false;
+
+            contents = it->second;
+            return true;
+        };
+    }
+}
+
+TEST(ShaderCache, KeysChangeWithIncludedFiles)
+{
+    ShaderCompileInputs inputs;
+    inputs.Source = "#include \"Common.hlsli\"\nfloat4 main() : SV_Target { return Color; }\n";
+    inputs.SourceName = "Shaders/Pixel.hlsl";
+    inputs.EntryPoint = "main";
+    inputs.Profile = "ps_6_5";
+    inputs.CompilerVersion = "1.7";
+
+    std::map<std::string, std::string> files;
+    files["Shaders/Common.hlsli"] = "#include \"Lighting.hlsli\"\nstatic const float4 Color = 1;\n";
+    files["Shaders/Lighting.hlsli"] = "// Nothing yet\n";
+
+    std::vector<std::pair<std::string, std::string>> includes;
+    CollectShaderIncludes(inputs.Source, inputs.SourceName, ReadFrom(files), includes);
+    REQUIRE(includes.size() == 2);
+    CHECK_EQ(includes[0].first, std::string("Shaders/Common.hlsli"));
+    CHECK_EQ(includes[1].first, std::string("Shaders/Lighting.hlsli"));
+
+    const ShaderCacheKey key = ComputeShaderCacheKey(inputs, ReadFrom(files));
+    CHECK(ComputeShaderCacheKey(inputs, ReadFrom(files)) == key);
+
+    // A file included from an include counts as much as the source.
+    std::map<std::string, std::string> edited = files;
+    edited["Shaders/Lighting.hlsli"] = "// Nothing yet.\n";
+    CHECK(ComputeShaderCacheKey(inputs, ReadFrom(edited)) != key);
+
+    ShaderCompileInputs defined = inputs;
+    defined.Arguments.push_back("-DCHECK_VERTEX_FETCH");
+    CHECK(ComputeShaderCacheKey(defined, ReadFrom(files)) != key);
+
+    ShaderCompileInputs updated = inputs;
+    updated.CompilerVersion = "1.8";
+    CHECK(ComputeShaderCacheKey(updated, ReadFrom(files)) != key);
+}
+
+TEST(ShaderCache, HitsWhatWasStoredAndMissesTheRest)
+{
+    const std::string directory = GetEmptyCacheDirectory("Hits");
+    const std::vector<uint8_t> stored = MakeBytecode(0, 1000);
+
+    {
+        ShaderCache cache(directory, 1 << 20);
+
+        std::vector<uint8_t> bytecode;
+        CHECK(!cache.Load(MakeKey(0), bytecode));
+        CHECK(cache.Store(MakeKey(0), stored.data(), stored.size()));
+        CHECK(cache.Load(MakeKey(0), bytecode));
+        CHECK(bytecode == stored);
+        CHECK(!cache.Load(MakeKey(1), bytecode));
+
+        CHECK_EQ(cache.GetHitCount(), 1u);
+        CHECK_EQ(cache.GetMissCount(), 2u);
+        CHECK_EQ(cache.GetEntryCount(), 1u);
+    }
+
+    // The destructor flushed the index, so the next run knows the entry before loading it.
+    ShaderCache cache(directory, 1 << 20);
+    CHECK_EQ(cache.GetEntryCount(), 1u);
+
+    std::vector<uint8_t> bytecode;
+    CHECK(cache.Load(MakeKey(0), bytecode));
+    CHECK(bytecode == stored);
+}
+
+TEST(ShaderCache, DeletesCorruptEntries)
+{
+    const std::string directory = GetEmptyCacheDirectory("Corrupt");
+    const std::vector<uint8_t> stored = MakeBytecode(0, 1000);
+
+    ShaderCache cache(directory, 1 << 20);
+    REQUIRE(cache.Store(MakeKey(0), stored.data(), stored.size()));
+    REQUIRE(cache.Store(MakeKey(1), stored.data(), stored.size()));
+
+    const std::string path = GetEntryPath(directory, MakeKey(0));
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('\x5a');
+    }
+
+    // And one cut short, as a full disk or a copy of the directory might leave it.
+    std::string truncated;
+    REQUIRE(ReadFileContents(GetEntryPath(directory, MakeKey(1)), truncated));
+    {
+        std::ofstream file(GetEntryPath(directory, MakeKey(1)), std::ios::binary | std::ios::trunc);
+        file.write(truncated.data(), truncated.size() / 2);
+    }
+
+    std::vector<uint8_t> bytecode;
+    CHECK(!cache.Load(MakeKey(0), bytecode));
+    CHECK(!cache.Load(MakeKey(1), bytecode));
+    CHECK(!FileExists(path));
+    CHECK(!FileExists(GetEntryPath(directory, MakeKey(1))));
+    CHECK_EQ(cache.GetMissCount(), 2u);
+    CHECK_EQ(cache.GetEntryCount(), 0u);
+    CHECK_EQ(cache.GetSize(), 0ull);
+
+    // Storing again repairs the entry.
+    CHECK(cache.Store(MakeKey(0), stored.data(), stored.size()));
+    CHECK(cache.Load(MakeKey(0), bytecode));
+    CHECK(bytecode == stored);
+}
+
+TEST(ShaderCache, EvictsTheLeastRecentlyUsed)
+{
+    const std::string directory = GetEmptyCacheDirectory("Evicts");
+
+    // Entries cost their bytecode and a header, so the cache holds three but not four.
+    const size_t bytecodeSize = 1000;
+    const uint64_t maxSize = 3 * (bytecodeSize + bytecodeSize / 4);
+
+    ShaderCache cache(directory, maxSize);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const std::vector<uint8_t> bytecode = MakeBytecode(i, bytecodeSize);
+        CHECK(cache.Store(MakeKey(i), bytecode.data(), bytecode.size()));
+    }
+    CHECK_EQ(cache.GetEntryCount(), 3u);
+
+    // Using the oldest makes the second the least recently used.
+    std::vector<uint8_t> bytecode;
+    CHECK(cache.Load(MakeKey(0), bytecode));
+
+    const std::vector<uint8_t> fourth = MakeBytecode(3, bytecodeSize);
+    CHECK(cache.Store(MakeKey(3), fourth.data(), fourth.size()));
+    CHECK_EQ(cache.GetEntryCount(), 3u);
+    CHECK(cache.GetSize() <= maxSize);
+    CHECK(!FileExists(GetEntryPath(directory, MakeKey(1))));
+
+    CHECK(!cache.Load(MakeKey(1), bytecode));
+    CHECK(cache.Load(MakeKey(0), bytecode));
+    CHECK(cache.Load(MakeKey(2), bytecode));
+    CHECK(cache.Load(MakeKey(3), bytecode));
+    CHECK(bytecode == fourth);
+
+    // An entry bigger than the whole cache isn't stored, and evicts nothing.
+    const std::vector<uint8_t> huge = MakeBytecode(4, static_cast<size_t>(maxSize));
+    CHECK(!cache.Store(MakeKey(4), huge.data(), huge.size()));
+    CHECK_EQ(cache.GetEntryCount(), 3u);
+
+    // A smaller limit on the next run evicts down to it, oldest first.
+    cache.Flush();
+    ShaderCache smaller(directory, maxSize / 3);
+    CHECK_EQ(smaller.GetEntryCount(), 1u);
+    CHECK(smaller.Load(MakeKey(3), bytecode));
+    CHECK(!smaller.Load(MakeKey(2), bytecode));
+}
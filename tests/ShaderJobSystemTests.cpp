@@ -0,0 +1,225 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Test.h"
+#include "ShaderJobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+
+namespace
+{
+    // Stands in for DXC: the bytecode is the source's bytes. Entry points name what else to do:
+    // "fail" returns an error, "throw" throws, and "wait" blocks until 'release' is ready.
+    class StubCompiler : public ShaderCompiler
+    {
+    public:
+        StubCompiler(std::shared_future<void> release, std::atomic<uint32_t>& compileCount)
+            : m_release(release)
+            , m_compileCount(compileCount)
+        {
+        }
+
+        void Compile(const ShaderCompileRequest& request, ShaderCompileResult& result) override
+        {
+            ++m_compileCount;
+
+            if (request.EntryPoint == "wait")
+            {
+                m_release.wait();
+            }
+            else if (request.EntryPoint == "throw")
+            {
+                throw std::runtime_error("Compiler crashed");
+            }
+
+            if (request.EntryPoint == "fail")
+            {
+                result.Status = static_cast<int32_t>(0x80004005); // E_FAIL
+                result.Errors = request.SourceName + ": error: expected ';'";
+                return;
+            }
+
+            result.Status = 0;
+            result.Bytecode.assign(request.Source.begin(), request.Source.end());
+        }
+
+    private:
+        std::shared_future<void> m_release;
+        std::atomic<uint32_t>&   m_compileCount;
+    };
+
+    struct StubCompilers
+    {
+        std::promise<void>    Release;
+        std::atomic<uint32_t> CreatedCount;
+        std::atomic<uint32_t> CompileCount;
+
+        StubCompilers() : CreatedCount(0), CompileCount(0) {}
+
+        ShaderJobSystem::CompilerFactory GetFactory()
+        {
+            std::shared_future<void> release = Release.get_future().share();
+            return [this, release]()
+            {
+                ++CreatedCount;
+                return std::unique_ptr<ShaderCompiler>(new StubCompiler(release, CompileCount));
+            };
+        }
+    };
+
+    ShaderCompileRequest MakeRequest(const std::string& source, const char* entryPoint = "main")
+    {
+        ShaderCompileRequest request;
+        request.Source = source;
+        request.SourceName = "Stub.hlsl";
+        request.EntryPoint = entryPoint;
+        request.Profile = "ms_6_5";
+        return request;
+    }
+
+    bool IsReady(const std::shared_future<ShaderCompileResult>& result)
+    {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    std::string GetSource(const ShaderTask& task)
+    {
+        const std::vector<uint8_t>& bytecode = task.Result.get().Bytecode;
+        return std::string(bytecode.begin(), bytecode.end());
+    }
+}
+
+TEST(ShaderJobSystem, CompilesOnEveryWorkerWithItsOwnCompiler)
+{
+    StubCompilers compilers;
+    compilers.Release.set_value();
+
+    std::vector<ShaderTask> tasks;
+    {
+        ShaderJobSystem jobs(compilers.GetFactory(), 4);
+        CHECK_EQ(jobs.GetThreadCount(), 4u);
+
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            tasks.push_back(jobs.Compile(MakeRequest("Shader" + std::to_string(i))));
+        }
+        tasks.push_back(jobs.Compile(MakeRequest("Broken", "fail")));
+
+        jobs.WaitIdle();
+        CHECK_EQ(compilers.CompileCount.load(), 65u);
+    }
+
+    CHECK_EQ(compilers.CreatedCount.load(), 4u);
+
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        CHECK_EQ(tasks[i].Result.get().Status, 0);
+        CHECK_EQ(GetSource(tasks[i]), "Shader" + std::to_string(i));
+    }
+
+    const ShaderCompileResult& failed = tasks.back().Result.get();
+    CHECK(failed.Status < 0);
+    CHECK(failed.Bytecode.empty());
+    CHECK_EQ(failed.Errors, std::string("Stub.hlsl: error: expected ';'"));
+}
+
+TEST(ShaderJobSystem, RunsJobsOnlyOnceTheirDependenciesFinish)
+{
+    StubCompilers compilers;
+
+    ShaderJobSystem jobs(compilers.GetFactory(), 2);
+
+    // Pipeline states wait on a mesh and a pixel shader each; the mesh shader is held back, so
+    // the job that needs it must stay queued while the free worker runs everything else.
+    ShaderTask mesh = jobs.Compile(MakeRequest("Mesh", "wait"));
+    ShaderTask pixel = jobs.Compile(MakeRequest("Pixel"));
+
+    std::atomic<uint32_t> linkCount(0);
+    auto link = [&](const ShaderTask& a, const ShaderTask& b)
+    {
+        return jobs.Then<std::string>({ a.Job, b.Job }, [&linkCount, a, b]()
+            {
+                // Both have finished, so reading them doesn't block.
+                if (!IsReady(a.Result) || !IsReady(b.Result))
+                    return std::string("Not ready");
+
+                ++linkCount;
+                return GetSource(a) + "+" + GetSource(b);
+            });
+    };
+
+    ShaderJobSystem::Task<std::string> blocked = link(mesh, pixel);
+    ShaderJobSystem::Task<std::string> unblocked = link(pixel, jobs.Compile(MakeRequest("Amplification")));
+
+    CHECK_EQ(unblocked.Result.get(), std::string("Pixel+Amplification"));
+    CHECK(blocked.Result.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+    CHECK_EQ(linkCount.load(), 1u);
+
+    // A job can wait on other Then() jobs, and on ones already finished.
+    ShaderJobSystem::Task<uint32_t> all = jobs.Then<uint32_t>({ blocked.Job, unblocked.Job, pixel.Job }, [&blocked, &unblocked]()
+        {
+            return static_cast<uint32_t>(blocked.Result.get().size() + unblocked.Result.get().size());
+        });
+
+    compilers.Release.set_value();
+
+    CHECK_EQ(blocked.Result.get(), std::string("Mesh+Pixel"));
+    CHECK_EQ(all.Result.get(), 29u);
+    CHECK_EQ(linkCount.load(), 2u);
+
+    jobs.WaitIdle();
+    CHECK_EQ(compilers.CompileCount.load(), 3u);
+}
+
+TEST(ShaderJobSystem, RethrowsFromFuturesAndStillRunsDependents)
+{
+    StubCompilers compilers;
+    compilers.Release.set_value();
+
+    ShaderJobSystem jobs(compilers.GetFactory(), 2);
+
+    ShaderTask crashed = jobs.Compile(MakeRequest("Crash", "throw"));
+    ShaderJobSystem::Task<bool> checked = jobs.Then<bool>({ crashed.Job }, [crashed]()
+        {
+            try
+            {
+                crashed.Result.get();
+                return false;
+            }
+            catch (const std::runtime_error&)
+            {
+                return true;
+            }
+        });
+
+    ShaderJobSystem::Task<int> thrown = jobs.Then<int>({ checked.Job }, []() -> int
+        {
+            throw std::logic_error("Link failed");
+        });
+
+    CHECK(checked.Result.get());
+
+    bool rethrown = false;
+    try
+    {
+        thrown.Result.get();
+    }
+    catch (const std::logic_error&)
+    {
+        rethrown = true;
+    }
+    CHECK(rethrown);
+
+    // The workers survive both.
+    CHECK_EQ(GetSource(jobs.Compile(MakeRequest("After"))), std::string("After"));
+}
@@ -0,0 +1,165 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "StepTimer.h"
+
+#include <cmath>
+
+namespace
+{
+    typedef StepTimer::Clock Clock;
+
+    uint32_t s_updateCount = 0;
+
+    void CountUpdate()
+    {
+        ++s_updateCount;
+    }
+
+    // Ticks the timer at the current time and forgets that frame, so that the deltas that follow
+    // are exactly the ones fed to it.
+    Clock::time_point Start(StepTimer& timer)
+    {
+        const Clock::time_point start = Clock::now();
+        timer.Tick(start);
+        timer.ResetFrameTimeStats();
+        return start;
+    }
+
+    Clock::duration Milliseconds(double milliseconds)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(milliseconds));
+    }
+
+    bool IsNear(double a, double b)
+    {
+        return std::fabs(a - b) < 1e-6;
+    }
+
+    uint32_t GetHistogramTotal(const StepTimer& timer)
+    {
+        uint32_t total = 0;
+        for (uint32_t bucket = 0; bucket < StepTimer::HistogramBucketCount; ++bucket)
+        {
+            total += timer.GetFrameTimeHistogram()[bucket];
+        }
+
+        return total;
+    }
+}
+
+TEST(StepTimer, SummarizesTheLastWindowOfFrames)
+{
+    StepTimer timer;
+    Clock::time_point time = Start(timer);
+
+    CHECK_EQ(timer.GetFrameTimeStats().Max, 0.0);
+
+    // A partial window summarizes what it has.
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        time += Milliseconds(50);
+        timer.Tick(time);
+    }
+    CHECK(IsNear(timer.GetFrameTimeStats().Min, 50.0));
+    CHECK(IsNear(timer.GetFrameTimeStats().Max, 50.0));
+
+    // Frames of 1 through 600 ms push every 50 ms frame out of the window.
+    for (uint32_t ms = 1; ms <= StepTimer::FrameTimeWindow; ++ms)
+    {
+        time += Milliseconds(ms);
+        timer.Tick(time);
+    }
+
+    FrameTimeStats stats = timer.GetFrameTimeStats();
+    CHECK(IsNear(stats.Min, 1.0));
+    CHECK(IsNear(stats.Mean, 300.5));
+    CHECK(IsNear(stats.P50, 300.5));
+    CHECK(IsNear(stats.P95, 570.05));
+    CHECK(IsNear(stats.P99, 594.01));
+    CHECK(IsNear(stats.Max, 600.0));
+
+    // The window slides on by one.
+    time += Milliseconds(1000);
+    timer.Tick(time);
+    stats = timer.GetFrameTimeStats();
+    CHECK(IsNear(stats.Min, 2.0));
+    CHECK(IsNear(stats.Max, 1000.0));
+
+    // Frames are timed before the clamp that keeps the simulation from jumping.
+    CHECK_EQ(timer.GetElapsedTicks(), StepTimer::TicksPerSecond / 10);
+
+    timer.ResetFrameTimeStats();
+    CHECK_EQ(timer.GetFrameTimeStats().Max, 0.0);
+    CHECK_EQ(GetHistogramTotal(timer), 0u);
+}
+
+TEST(StepTimer, BucketsFramesByWholeMilliseconds)
+{
+    StepTimer timer;
+    Clock::time_point time = Start(timer);
+
+    // Each bucket holds [ms, ms + 1); the last every frame from 33 ms on.
+    const double frameTimes[] = { 0.0, 0.999, 1.0, 16.7, 32.999, 33.0, 100.0, 5000.0 };
+    for (double frameTime : frameTimes)
+    {
+        time += Milliseconds(frameTime);
+        timer.Tick(time);
+    }
+
+    const UINT32* histogram = timer.GetFrameTimeHistogram();
+    CHECK_EQ(histogram[0], 2u);
+    CHECK_EQ(histogram[1], 1u);
+    CHECK_EQ(histogram[16], 1u);
+    CHECK_EQ(histogram[32], 1u);
+    CHECK_EQ(histogram[StepTimer::HistogramBucketCount - 1], 3u);
+    CHECK_EQ(GetHistogramTotal(timer), static_cast<uint32_t>(_countof(frameTimes)));
+
+    CHECK_EQ(StepTimer::GetHistogramBucketMilliseconds(0), 0.0);
+    CHECK_EQ(StepTimer::GetHistogramBucketMilliseconds(StepTimer::HistogramBucketCount - 1), 33.0);
+}
+
+TEST(StepTimer, StepsFixedTimesteps)
+{
+    StepTimer timer;
+    timer.SetFixedTimeStep(true);
+    timer.SetTargetElapsedSeconds(1.0 / 60.0);
+    const UINT64 step = StepTimer::SecondsToTicks(1.0 / 60.0);
+
+    Clock::time_point time = Start(timer);
+    const UINT64 startTicks = timer.GetTotalTicks();
+    const UINT32 startFrame = timer.GetFrameCount();
+
+    // Two steps' worth of time runs two updates; a frame within a quarter millisecond of the
+    // step runs exactly one.
+    s_updateCount = 0;
+    time += Milliseconds(2000.0 / 60.0);
+    timer.Tick(time, CountUpdate);
+    CHECK_EQ(s_updateCount, 2u);
+    time += Milliseconds(1000.0 / 60.0 + 0.2);
+    timer.Tick(time, CountUpdate);
+    CHECK_EQ(s_updateCount, 3u);
+    CHECK_EQ(timer.GetElapsedTicks(), step);
+
+    // TickFixed() steps once without reading the clock or timing the frame.
+    const FrameTimeStats before = timer.GetFrameTimeStats();
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        timer.TickFixed(CountUpdate);
+    }
+    CHECK_EQ(s_updateCount, 6u);
+    CHECK_EQ(timer.GetFrameCount(), startFrame + 6);
+    CHECK_EQ(timer.GetTotalTicks(), startTicks + 6 * step);
+    CHECK_EQ(timer.GetElapsedTicks(), step);
+    CHECK_EQ(timer.GetFrameTimeStats().Max, before.Max);
+    CHECK_EQ(GetHistogramTotal(timer), 2u);
+}
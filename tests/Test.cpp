@@ -0,0 +1,120 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Test.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct Entry
+    {
+        const char*  Name;
+        TestFunction Function;
+    };
+
+    std::vector<Entry>& GetRegistry()
+    {
+        static std::vector<Entry> registry;
+        return registry;
+    }
+
+    uint32_t s_failureCount = 0; // Failed checks of the running test
+}
+
+TestRegistrar::TestRegistrar(const char* name, TestFunction function)
+{
+    GetRegistry().push_back({ name, function });
+}
+
+std::string GetTestOutputPath(const std::string& name)
+{
+    return std::string(MESHCORE_TEST_OUTPUT_DIR) + "/" + name;
+}
+
+bool ReportCheck(bool passed, const char* expression, const char* file, int line)
+{
+    return ReportCheck(passed, expression, std::string(), file, line);
+}
+
+bool ReportCheck(bool passed, const char* expression, const std::string& values, const char* file, int line)
+{
+    if (!passed)
+    {
+        std::cout << file << "(" << line << "): check failed: " << expression;
+        if (!values.empty())
+        {
+            std::cout << " (" << values << ")";
+        }
+        std::cout << "\n";
+
+        ++s_failureCount;
+    }
+
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = "";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Unknown option " << argv[i] << ".\nUsage: " << argv[0] << " [--filter <text>]\n";
+            return 1;
+        }
+    }
+
+    uint32_t runCount = 0;
+    std::vector<const char*> failed;
+
+    for (const Entry& entry : GetRegistry())
+    {
+        if (strstr(entry.Name, filter) == nullptr)
+            continue;
+
+        std::cout << "[ RUN    ] " << entry.Name << "\n";
+
+        s_failureCount = 0;
+        try
+        {
+            entry.Function();
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "Unexpected exception: " << e.what() << "\n";
+            ++s_failureCount;
+        }
+
+        std::cout << (s_failureCount == 0 ? "[     OK ] " : "[ FAILED ] ") << entry.Name << "\n";
+
+        ++runCount;
+        if (s_failureCount != 0)
+        {
+            failed.push_back(entry.Name);
+        }
+    }
+
+    std::cout << runCount - failed.size() << " of " << runCount << " tests passed.\n";
+    for (const char* name : failed)
+    {
+        std::cout << "  FAILED " << name << "\n";
+    }
+
+    return runCount == 0 || !failed.empty() ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// A minimal harness in the manner of GoogleTest, which this repo can't fetch: TEST() defines a
+// test and registers it, and CHECK()/CHECK_EQ() report a failed condition with its location
+// and carry on, so one run shows every broken expectation of a test. REQUIRE() also returns
+// from the test, for conditions the rest of it depends on.
+//
+// Each test executable links Test.cpp for its main(), which runs the registered tests, or
+// those whose "Suite.Name" contains --filter <text>, and exits nonzero if any failed. Tests
+// run from the directory CTest gives them, dx12_simple_mesh, so Assets/ resolves.
+// Files a test writes go under the build tree instead, at GetTestOutputPath().
+
+typedef void (*TestFunction)();
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, TestFunction function);
+};
+
+// Returns a path for a file or directory named 'name' in the build tree's test output
+// directory. Nothing is created; names should start with the suite's to stay apart.
+std::string GetTestOutputPath(const std::string& name);
+
+// Records a failure of the running test; returns 'passed'.
+bool ReportCheck(bool passed, const char* expression, const char* file, int line);
+bool ReportCheck(bool passed, const char* expression, const std::string& values, const char* file, int line);
+
+template <typename A, typename B>
+bool CheckEqual(const A& a, const B& b, const char* expression, const char* file, int line)
+{
+    if (a == b)
+        return true;
+
+    std::ostringstream values;
+    values << a << " vs " << b;
+    return ReportCheck(false, expression, values.str(), file, line);
+}
+
+#define TEST(suite, name) \
+    static void suite##_##name(); \
+    static const TestRegistrar s_##suite##_##name##Registrar(#suite "." #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(condition)    ReportCheck(!!(condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQ(a, b)      CheckEqual((a), (b), #a " == " #b, __FILE__, __LINE__)
+#define REQUIRE(condition)  if (!CHECK(condition)) return
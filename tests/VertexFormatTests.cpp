@@ -0,0 +1,195 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "MeshShaderExecutor.h"
+#include "PrimitiveCulling.h"
+#include "VertexFormat.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+// Per-instance element indexing, as the input assembler does it: per-instance data starts at
+// StartInstanceLocation and advances every InstanceDataStepRate instances.
+namespace
+{
+    VertexElement PerInstance(uint32_t stepRate)
+    {
+        return VertexElement{ 1, 0, DXGI_FORMAT_R32_UINT, stepRate };
+    }
+
+    // A per-vertex position in slot 0; a per-instance color stepping every other instance
+    // and a per-instance value that never steps, sharing slot 1.
+    const D3D12_INPUT_ELEMENT_DESC c_instancedElements[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UINT,   1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 2 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32_UINT,        1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 0 },
+    };
+}
+
+TEST(VertexFormat, IndexesPerVertexDataByVertex)
+{
+    const VertexElement element = { 0, 0, DXGI_FORMAT_R32_UINT, 0 };
+    CHECK_EQ(GetElementIndex(element, 17, 0, 0), 17u);
+    CHECK_EQ(GetElementIndex(element, 17, 9, 100), 17u);
+}
+
+TEST(VertexFormat, StepsPerInstanceDataByStepRate)
+{
+    // Every instance, from StartInstanceLocation.
+    CHECK_EQ(GetElementIndex(PerInstance(1), 5, 0, 0), 0u);
+    CHECK_EQ(GetElementIndex(PerInstance(1), 5, 3, 0), 3u);
+    CHECK_EQ(GetElementIndex(PerInstance(1), 5, 3, 10), 13u);
+
+    // Every third instance: instances 0-2 share an element, 3-5 the next.
+    const uint32_t expected[] = { 10, 10, 10, 11, 11, 11, 12 };
+    for (uint32_t instance = 0; instance < 7; ++instance)
+    {
+        CHECK_EQ(GetElementIndex(PerInstance(3), 0, instance, 10), expected[instance]);
+    }
+
+    // The start isn't divided by the step rate.
+    CHECK_EQ(GetElementIndex(PerInstance(4), 0, 7, 5), 6u);
+
+    // Step rate 0 resolves to one that never advances.
+    CHECK_EQ(GetElementIndex(PerInstance(~0u), 0, 0xfffffffe, 4), 4u);
+}
+
+TEST(VertexFormat, ResolvesInstanceStepRates)
+{
+    const uint32_t strides[] = { 12, 8 };
+    const D3D12_INPUT_LAYOUT_DESC desc = { c_instancedElements, _countof(c_instancedElements) };
+
+    VertexLayout layout;
+    REQUIRE(SUCCEEDED(ResolveInputLayout(desc, strides, 2, layout)));
+    REQUIRE(layout.Elements.size() == 3);
+    CHECK_EQ(layout.Elements[0].InstanceStepRate, 0u);
+    CHECK_EQ(layout.Elements[1].InstanceStepRate, 2u);
+    CHECK_EQ(layout.Elements[1].Offset, 0u);
+    CHECK_EQ(layout.Elements[2].InstanceStepRate, ~0u);
+    CHECK_EQ(layout.Elements[2].Offset, 4u);
+
+    VertexLayoutConstants constants;
+    PackVertexLayout(layout, constants);
+    CHECK_EQ(constants.StepRates[0], 0u);
+    CHECK_EQ(constants.StepRates[1], 2u);
+    CHECK_EQ(constants.StepRates[2], ~0u);
+}
+
+TEST(VertexFormat, RejectsInconsistentClassification)
+{
+    const uint32_t strides[] = { 12, 8 };
+
+    // A step rate on per-vertex data.
+    D3D12_INPUT_ELEMENT_DESC elements[_countof(c_instancedElements)];
+    std::memcpy(elements, c_instancedElements, sizeof(elements));
+    elements[0].InstanceDataStepRate = 1;
+
+    VertexLayout layout;
+    D3D12_INPUT_LAYOUT_DESC desc = { elements, _countof(elements) };
+    CHECK_EQ(ResolveInputLayout(desc, strides, 2, layout), E_INVALIDARG);
+
+    // Per-vertex and per-instance elements in one slot.
+    std::memcpy(elements, c_instancedElements, sizeof(elements));
+    elements[2].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+    elements[2].InstanceDataStepRate = 0;
+    CHECK_EQ(ResolveInputLayout(desc, strides, 2, layout), E_INVALIDARG);
+}
+
+TEST(VertexFormat, FetchesPerInstanceElements)
+{
+    const uint32_t strides[] = { 12, 8 };
+    const D3D12_INPUT_LAYOUT_DESC desc = { c_instancedElements, _countof(c_instancedElements) };
+
+    VertexLayout layout;
+    REQUIRE(SUCCEEDED(ResolveInputLayout(desc, strides, 2, layout)));
+
+    // Two vertices; per-instance records of a color whose channels are 4i..4i+3, and i * 100.
+    const float positions[] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t instances[8 * 8];
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        const uint8_t color[4] = { uint8_t(4 * i), uint8_t(4 * i + 1), uint8_t(4 * i + 2), uint8_t(4 * i + 3) };
+        const uint32_t value = i * 100;
+        std::memcpy(&instances[i * 8], color, 4);
+        std::memcpy(&instances[i * 8 + 4], &value, 4);
+    }
+    const uint8_t* buffers[] = { reinterpret_cast<const uint8_t*>(positions), instances };
+
+    uint32_t result[4];
+    FetchVertexElement(layout, 0, buffers, 1, 6, 3, result);
+    float position[3];
+    std::memcpy(position, result, sizeof(position));
+    CHECK_EQ(position[0], 4.0f);
+    CHECK_EQ(position[2], 6.0f);
+
+    // Instance 5 from start 3 steps every other instance to record 3 + 5 / 2 = 5.
+    FetchVertexElement(layout, 1, buffers, 1, 5, 3, result);
+    CHECK_EQ(result[0], 20u);
+    CHECK_EQ(result[3], 23u);
+
+    // The element that never steps reads the start's record whatever the instance.
+    FetchVertexElement(layout, 2, buffers, 0, 7, 3, result);
+    CHECK_EQ(result[0], 300u);
+}
+
+TEST(VertexFormat, ExecutesPerInstancePositions)
+{
+    // Instances of a 6-vertex mesh whose position is per-instance, stepping every other
+    // instance from StartInstanceLocation 5: vertex k of the output is instance k / 6's.
+    const D3D12_INPUT_ELEMENT_DESC element = { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 2 };
+    const D3D12_INPUT_LAYOUT_DESC desc = { &element, 1 };
+    const uint32_t stride = 16;
+
+    VertexLayout layout;
+    REQUIRE(SUCCEEDED(ResolveInputLayout(desc, &stride, 1, layout)));
+
+    std::vector<XMFLOAT4> instancePositions;
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        instancePositions.push_back(XMFLOAT4(float(i), 0.0f, 0.5f, 1.0f));
+    }
+
+    const D3D12_GPU_VIRTUAL_ADDRESS address = 0x10000;
+    const D3D12_VERTEX_BUFFER_VIEW view = { address, uint32_t(instancePositions.size() * stride), stride };
+
+    RecordingDrawTarget target;
+    FixedFunctionContext context(target);
+    context.SetVertexLayout(layout);
+    context.IASetVertexBuffers(0, 1, &view);
+    context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    context.DrawInstanced(6, 100, 0, 5);
+
+    MeshShaderExecutor executor;
+    XMFLOAT4X4 identity;
+    XMStoreFloat4x4(&identity, XMMatrixIdentity());
+    executor.SetVertexLayout(layout);
+    executor.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    executor.SetConstants(identity, XMFLOAT2(100.0f, 100.0f), PrimitiveCull::None);
+    executor.RegisterBuffer(address, view.SizeInBytes, instancePositions.data());
+
+    MeshShaderOutput output;
+    output.Clear();
+    REQUIRE(SUCCEEDED(executor.Execute(target.GetCommands(), output, 1)));
+    REQUIRE(output.Positions.size() == 600);
+    CHECK_EQ(output.PrimitiveCount, 200u);
+
+    uint32_t mismatches = 0;
+    for (uint32_t k = 0; k < 600; ++k)
+    {
+        const uint32_t instance = k / 6;
+        mismatches += output.Positions[k].x == float(5 + instance / 2) ? 0 : 1;
+    }
+    CHECK_EQ(mismatches, 0u);
+}
@@ -0,0 +1,193 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#include "Platform.h"
+#include "Test.h"
+#include "VertexReuse.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Must match REUSE_TABLE_SIZE and GROUP_PRIMS * 3 in MeshletMS.hlsl.
+    const uint32_t c_reuseTableSize = 128;
+    const uint32_t c_groupLocations = 63;
+
+    // The table entry FindIndexOwner() in MeshletMS.hlsl probes first for an index value.
+    uint32_t GetReuseTableEntry(uint32_t index)
+    {
+        return (index * 2654435761u) >> 25;
+    }
+
+    // FindIndexOwner() and the compaction after it, thread by thread: each location looks its
+    // value up in the open-addressed table, the lowest location with a value owns it, and
+    // owners are numbered in location order.
+    std::vector<uint32_t> RunShaderDedup(const std::vector<uint32_t>& indices, uint32_t& maxProbeCount)
+    {
+        std::vector<uint32_t> keys(c_reuseTableSize, ~0u);
+        std::vector<uint32_t> owners(c_reuseTableSize, ~0u);
+        std::vector<uint32_t> entries(indices.size(), ~0u);
+        maxProbeCount = 0;
+
+        for (uint32_t gtid = 0; gtid < indices.size(); ++gtid)
+        {
+            if (indices[gtid] == ~0u)
+                continue;
+
+            uint32_t entry = GetReuseTableEntry(indices[gtid]);
+            uint32_t probeCount = 1;
+            while (keys[entry] != ~0u && keys[entry] != indices[gtid])
+            {
+                entry = (entry + 1) % c_reuseTableSize;
+                ++probeCount;
+            }
+
+            keys[entry] = indices[gtid];
+            owners[entry] = std::min(owners[entry], gtid);
+            entries[gtid] = entry;
+            maxProbeCount = std::max(maxProbeCount, probeCount);
+        }
+
+        std::vector<uint32_t> outVertex(indices.size());
+        std::vector<uint32_t> slots(indices.size());
+        uint32_t outVertexCount = 0;
+        for (uint32_t gtid = 0; gtid < indices.size(); ++gtid)
+        {
+            const uint32_t owner = entries[gtid] == ~0u ? gtid : owners[entries[gtid]];
+            if (owner == gtid)
+            {
+                outVertex[gtid] = outVertexCount++;
+            }
+            slots[gtid] = outVertex[owner];
+        }
+
+        return slots;
+    }
+
+    // A grid of 'columns' x 'rows' quads, two triangles each, row by row.
+    std::vector<uint32_t> MakeGrid(uint32_t columns, uint32_t rows)
+    {
+        std::vector<uint32_t> indices;
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                const uint32_t a = y * (columns + 1) + x;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + columns + 1;
+                const uint32_t d = c + 1;
+                indices.insert(indices.end(), { a, b, d, a, d, c });
+            }
+        }
+
+        return indices;
+    }
+
+    bool IsNear(float a, float b)
+    {
+        return std::fabs(a - b) < 1e-6f;
+    }
+}
+
+TEST(VertexReuse, NumbersDistinctValuesInOrderOfFirstOccurrence)
+{
+    const uint32_t indices[] = { 5, 9, 5, 7, 9, ~0u, ~0u, 7, 0 };
+    const uint32_t expected[] = { 0, 1, 0, 2, 1, 3, 4, 2, 5 };
+
+    uint32_t slots[_countof(indices)];
+    CHECK_EQ(DedupGroupIndices(indices, _countof(indices), slots), 6u);
+    CHECK(std::equal(slots, slots + _countof(slots), expected));
+
+    uint32_t maxProbeCount;
+    CHECK(RunShaderDedup(std::vector<uint32_t>(indices, indices + _countof(indices)), maxProbeCount) == std::vector<uint32_t>(expected, expected + _countof(expected)));
+}
+
+TEST(VertexReuse, MatchesTheShaderTableThroughHashCollisions)
+{
+    // Values that all hash to the table's last entry, so that their probes wrap past the end
+    // of the table.
+    std::vector<uint32_t> colliding;
+    for (uint32_t value = 0; colliding.size() < 40; ++value)
+    {
+        if (GetReuseTableEntry(value) == c_reuseTableSize - 1)
+        {
+            colliding.push_back(value);
+        }
+    }
+
+    // A full window of them, each seen more than once, and the restart index.
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < c_groupLocations; ++i)
+    {
+        indices.push_back(i == 17 || i == 50 ? ~0u : colliding[(i * 7) % colliding.size()]);
+    }
+
+    uint32_t maxProbeCount;
+    const std::vector<uint32_t> expected = RunShaderDedup(indices, maxProbeCount);
+    CHECK(maxProbeCount >= colliding.size());
+
+    std::vector<uint32_t> slots(indices.size());
+    const uint32_t distinctCount = DedupGroupIndices(indices.data(), static_cast<uint32_t>(indices.size()), slots.data());
+    CHECK(slots == expected);
+    CHECK_EQ(distinctCount, static_cast<uint32_t>(colliding.size() + 2));
+
+    // Every location holds the value its owner does.
+    bool owned = true;
+    for (uint32_t i = 0; i < indices.size(); ++i)
+    {
+        const uint32_t owner = static_cast<uint32_t>(std::find(slots.begin(), slots.end(), slots[i]) - slots.begin());
+        owned &= indices[owner] == indices[i] && (indices[i] != ~0u || owner == i);
+    }
+    CHECK(owned);
+}
+
+TEST(VertexReuse, MeasuresReuseOfAnIndexedGrid)
+{
+    // 4 x 2 quads: 15 vertices, 16 triangles, 8 to a row.
+    const std::vector<uint32_t> indices = MakeGrid(4, 2);
+    const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+    // One group holds the whole grid and transforms each vertex once.
+    VertexReuseStats stats = MeasureGroupReuse(indices.data(), indexCount, c_groupLocations / 3);
+    CHECK_EQ(stats.TriangleCount, 16u);
+    CHECK_EQ(stats.VertexCount, 15u);
+    CHECK_EQ(stats.TransformCount, 15u);
+    CHECK(IsNear(stats.Acmr, 15.0f / 16.0f));
+    CHECK(IsNear(stats.Atvr, 1.0f));
+
+    // A group per row transforms the 5 vertices between the rows twice.
+    stats = MeasureGroupReuse(indices.data(), indexCount, 8);
+    CHECK_EQ(stats.TransformCount, 20u);
+    CHECK(IsNear(stats.Acmr, 1.25f));
+    CHECK(IsNear(stats.Atvr, 20.0f / 15.0f));
+
+    // A group per quad transforms its 4 corners.
+    stats = MeasureGroupReuse(indices.data(), indexCount, 2);
+    CHECK_EQ(stats.TransformCount, 32u);
+    CHECK(IsNear(stats.Acmr, 2.0f));
+
+    // A cache as large as the grid misses each vertex once, and no cache misses every index.
+    stats = MeasureFifoCacheReuse(indices.data(), indexCount, 16);
+    CHECK_EQ(stats.TransformCount, 15u);
+    stats = MeasureFifoCacheReuse(indices.data(), indexCount, 0);
+    CHECK_EQ(stats.TransformCount, 48u);
+    CHECK(IsNear(stats.Acmr, 3.0f));
+
+    // A meshlet per row, like the groups.
+    const uint32_t uniqueVertexIndices[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+    const Meshlet meshlets[] = { { 10, 0, 8, 0 }, { 10, 10, 8, 8 } };
+    stats = MeasureMeshletReuse(meshlets, _countof(meshlets), uniqueVertexIndices);
+    CHECK_EQ(stats.TriangleCount, 16u);
+    CHECK_EQ(stats.VertexCount, 15u);
+    CHECK_EQ(stats.TransformCount, 20u);
+    CHECK(IsNear(stats.Acmr, 1.25f));
+}